@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdbool.h>
+#include "db/core/db_client.h"
+#include "db/core/db_error.h"
+
+/*
+ * DB backend interface
+ *
+ * db_client builds SQL (db_post / db_patch / ...) and times every statement;
+ * the backend only executes it. Selected once at db_client_init() from
+ * ENV_DB_BACKEND:
+ *
+ * - "postgres" (default): libpq, reconnect / circuit breaker
+ * - "memory": in-process tables seeded from the seed SQL file, for load
+ *   tests and microbenchmarks without a database
+ */
+typedef struct {
+    const char *name;
+
+    db_error_t (*init)(void);
+    void (*cleanup)(void);
+
+    /**
+     * Execute one SQL string
+     *
+     * @param stmt      Statement name ("<VERB> <table>") for log lines
+     * @param out_json  Result rows as a cJSON array of objects (may be NULL)
+     * @param out_rows  Rows returned or affected
+     */
+    db_error_t (*exec)(const char *stmt, const char *sql, cJSON **out_json, int *out_rows);
+
+    bool (*is_available)(void);
+    int (*ping)(void);
+
+    /* optional: NULL if the backend never reconnects */
+    void (*on_reconnect)(db_reconnect_cb cb);
+} db_backend_t;
+
+extern const db_backend_t db_backend_pg;
+extern const db_backend_t db_backend_mem;
@@ -1,6 +1,7 @@
 #ifndef DB_CLIENT_H
 #define DB_CLIENT_H
 
+#include <stdbool.h>
 #include "db_error.h"
 
 /*
@@ -9,47 +10,84 @@
  * - Blocking HTTP (libcurl)
  * - Thread-safe (stateless)
  * - MUST NOT be called inside realtime recv loop
+ * - Backend chosen by DB_BACKEND (db_backend.h): postgres | memory
  */
 typedef struct cJSON cJSON;   // forward declaration
 
-/* init / cleanup */
+/* init / cleanup
+ *
+ * db_client_init returns DB_ERR_UNAVAILABLE if the first connect fails;
+ * the client then keeps reconnecting in the background (degraded mode).
+ */
 db_error_t db_client_init(void);
 void db_client_cleanup(void);
 
+/* true while a connection is established (circuit closed) */
+bool db_is_available(void);
+
+/* called from the reconnect thread each time the link comes back */
+typedef void (*db_reconnect_cb)(void);
+void db_client_on_reconnect(db_reconnect_cb cb);
+
+/*
+ * Every call below is counted in db_stats under its call site: the macros
+ * pass __FILE__ / __LINE__ to the *_at functions.
+ */
+
 /* GET /rest/v1/{table}?{query} */
-db_error_t db_get(
+db_error_t db_get_at(
     const char *table,
     const char *query,
-    cJSON **out_json
+    cJSON **out_json,
+    const char *file,
+    int line
 );
+#define db_get(table, query, out_json) \
+    db_get_at((table), (query), (out_json), __FILE__, __LINE__)
 
 /* POST /rest/v1/{table} */
-db_error_t db_post(
+db_error_t db_post_at(
     const char *table,
     cJSON *payload,
-    cJSON **out_json
+    cJSON **out_json,
+    const char *file,
+    int line
 );
+#define db_post(table, payload, out_json) \
+    db_post_at((table), (payload), (out_json), __FILE__, __LINE__)
 
 /* POST /rest/v1/rpc/{function} */
-db_error_t db_rpc(
+db_error_t db_rpc_at(
     const char *function,
     cJSON *payload,
-    cJSON **out_json
+    cJSON **out_json,
+    const char *file,
+    int line
 );
+#define db_rpc(function, payload, out_json) \
+    db_rpc_at((function), (payload), (out_json), __FILE__, __LINE__)
 
-db_error_t db_patch(
+db_error_t db_patch_at(
     const char *table,
     const char *filter,
     cJSON *payload,
-    cJSON **out_json
+    cJSON **out_json,
+    const char *file,
+    int line
 );
+#define db_patch(table, filter, payload, out_json) \
+    db_patch_at((table), (filter), (payload), (out_json), __FILE__, __LINE__)
 
 /* DELETE /rest/v1/{table}?{filter} */
-db_error_t db_delete(
+db_error_t db_delete_at(
     const char *table,
     const char *filter,
-    cJSON **out_json
+    cJSON **out_json,
+    const char *file,
+    int line
 );
+#define db_delete(table, filter, out_json) \
+    db_delete_at((table), (filter), (out_json), __FILE__, __LINE__)
 
 int db_ping(void);
 
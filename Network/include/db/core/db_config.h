@@ -1,5 +1,15 @@
 #pragma once
 
+/* ===== Backend selection ===== */
+// "postgres" (default) or "memory" (seeded in-process tables, no DB needed)
+#define ENV_DB_BACKEND          "DB_BACKEND"
+#define DB_BACKEND_POSTGRES     "postgres"
+#define DB_BACKEND_MEMORY       "memory"
+
+// Seed file loaded by the memory backend (INSERT statements only)
+#define ENV_DB_MEM_SEED         "DB_MEM_SEED"
+#define DB_MEM_SEED_DEFAULT     "../Database/init/02_seed.sql"
+
 /* ===== PostgreSQL ENV variable names ===== */
 #define ENV_DB_HOST     "DB_HOST"
 #define ENV_DB_PORT     "DB_PORT"
@@ -9,4 +19,29 @@
 
 /* ===== PostgreSQL connection config ===== */
 #define DB_CONN_TIMEOUT_SEC 10
-#define DB_MAX_CONN_STRING  512
+#define DB_MAX_CONN_STRING  640
+
+// Server-side cap on any one statement (query_canceled -> DB_ERR_TIMEOUT).
+// The connection is shared, so this also bounds how long the event loop's
+// synchronous calls (match start, room create) can wait behind another one.
+#define ENV_DB_STATEMENT_TIMEOUT_MS "DB_STATEMENT_TIMEOUT_MS"
+#define DB_STATEMENT_TIMEOUT_MS     5000
+
+// Unacknowledged data on a hung link fails the call instead of waiting for
+// the keepalive probes
+#define DB_TCP_USER_TIMEOUT_MS      10000
+
+/* ===== Reconnect / circuit breaker ===== */
+// While the link is down every call fails fast with DB_ERR_UNAVAILABLE and a
+// background thread reconnects with exponential backoff.
+#define DB_RECONNECT_BASE_MS    500
+#define DB_RECONNECT_MAX_MS     30000
+
+// TCP keepalive so a dead server is detected instead of blocking forever
+#define DB_KEEPALIVE_IDLE_SEC     10
+#define DB_KEEPALIVE_INTERVAL_SEC 3
+#define DB_KEEPALIVE_COUNT        3
+
+/* ===== Logging ===== */
+// Set to 1 to echo every query and its (truncated) result set
+#define ENV_DB_LOG_VERBOSE "DB_LOG_VERBOSE"
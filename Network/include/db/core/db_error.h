@@ -25,5 +25,8 @@ typedef enum {
     DB_ERROR_INVALID_PARAM,
     DB_ERROR_INTERNAL,
     DB_ERROR_NOT_IMPLEMENTED,
-    DB_ERR_UNKNOWN
+    DB_ERR_UNKNOWN,
+
+    /* Availability: connection down, circuit open (fail fast) */
+    DB_ERR_UNAVAILABLE
 } db_error_t;
\ No newline at end of file
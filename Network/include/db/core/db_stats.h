@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * DB statement instrumentation
+ *
+ * - Keyed by call site ("<VERB> <table> @<file>:<line>", e.g.
+ *   "SELECT accounts @account_repo.c:42"; SCRIPT for several statements)
+ * - Past DB_STATS_MAX_STATEMENTS keys, calls go to a separate "(other)" entry
+ * - Call count, errors, rows, latency histogram (log2 ms buckets)
+ * - Slow-query log above DB_SLOW_QUERY_MS (env, default below)
+ * - Periodic report every DB_STATS_INTERVAL_SEC (env, 0 disables)
+ */
+
+#define ENV_DB_SLOW_QUERY_MS        "DB_SLOW_QUERY_MS"
+#define ENV_DB_STATS_INTERVAL_SEC   "DB_STATS_INTERVAL_SEC"
+
+#define DB_SLOW_QUERY_MS_DEFAULT        100
+#define DB_STATS_INTERVAL_SEC_DEFAULT   300
+
+#define DB_STATS_MAX_STATEMENTS 128
+#define DB_STATS_NAME_LEN       96
+#define DB_STATS_BUCKETS        16      // <=0.25ms, <=0.5ms ... <=4096ms, overflow
+
+typedef struct {
+    char name[DB_STATS_NAME_LEN];
+    uint64_t calls;
+    uint64_t errors;
+    uint64_t rows;
+    double total_ms;
+    double max_ms;
+    uint64_t hist[DB_STATS_BUCKETS];
+} db_stmt_stats_t;
+
+/** Read env thresholds (safe to call more than once) */
+void db_stats_init(void);
+
+/**
+ * Record one executed statement
+ *
+ * @param name     Statement name (truncated to DB_STATS_NAME_LEN)
+ * @param sql      Full SQL, only used for the slow-query log
+ * @param ms       Wall time spent in the database
+ * @param rows     Rows returned or affected
+ * @param ok       false if the statement failed
+ */
+void db_stats_record(const char *name, const char *sql, double ms, int rows, bool ok);
+
+/**
+ * Copy current counters (sorted by total time, descending), "(other)"
+ * included once it has calls
+ *
+ * @return number of entries written to out
+ */
+int db_stats_snapshot(db_stmt_stats_t *out, int max);
+
+/** Estimated latency percentile (0..100) for one entry, in ms */
+double db_stats_percentile(const db_stmt_stats_t *s, double pct);
+
+/** Print the report table to stdout */
+void db_stats_report(void);
+
+/** Clear all counters */
+void db_stats_reset(void);
@@ -200,8 +200,6 @@ typedef struct {
     presence_status_t status;
     
     int32_t current_room_id;      // Non-zero if in a room
-    int32_t *friend_ids;          // Array of friend account IDs
-    int32_t friend_count;
     
     time_t last_heartbeat;
 } online_user_t;
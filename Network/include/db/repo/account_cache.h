@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "db/models/model.h"
+
+/*
+ * Account / profile read-through cache
+ *
+ * - Bounded LRU per table: accounts keyed by id and email, profiles by
+ *   account_id
+ * - Limits: entry count and approximate bytes per table (env, defaults below)
+ * - Repos consult it in *_find_* and invalidate it on every write
+ *   (account_update_password / account_update_role / profile_update_by_account)
+ * - Callers always get their own copy (free with account_free / profile_free)
+ */
+
+#define ENV_ENTITY_CACHE_MAX_ENTRIES    "ENTITY_CACHE_MAX_ENTRIES"
+#define ENV_ENTITY_CACHE_MAX_BYTES      "ENTITY_CACHE_MAX_BYTES"
+
+#define ENTITY_CACHE_MAX_ENTRIES_DEFAULT    4096
+#define ENTITY_CACHE_MAX_BYTES_DEFAULT      (4 * 1024 * 1024)
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t invalidations;
+    size_t entries;
+    size_t bytes;
+    size_t max_entries;
+    size_t max_bytes;
+} entity_cache_stats_t;
+
+// Accounts
+account_t *account_cache_get_by_id(int32_t account_id);
+account_t *account_cache_get_by_email(const char *email);
+void account_cache_put(const account_t *account);
+void account_cache_invalidate(int32_t account_id);
+
+// Profiles
+profile_t *profile_cache_get(int32_t account_id);
+void profile_cache_put(const profile_t *profile);
+void profile_cache_invalidate(int32_t account_id);
+
+/** Copy counters for one table ("accounts" or "profiles") */
+void entity_cache_stats(const char *table, entity_cache_stats_t *out);
+
+/** Print hit rate / size per table to stdout */
+void entity_cache_report(void);
+
+/** Drop every entry (counters are kept) */
+void entity_cache_clear(void);
@@ -52,6 +52,23 @@ db_error_t account_find_by_id(
     account_t **out_account
 );
 
+/**
+ * Find several accounts by ID
+ * 
+ * Cache hits are served from memory, the rest with one IN (...) query.
+ * 
+ * @param account_ids IDs to look up
+ * @param count Number of IDs
+ * @param out_accounts Array of count slots; slot i gets account_ids[i] or NULL
+ *                     when it does not exist (caller frees each)
+ * @return DB_SUCCESS unless the query itself failed
+ */
+db_error_t account_find_by_ids(
+    const int32_t *account_ids,
+    int32_t count,
+    account_t **out_accounts
+);
+
 /**
  * Update account password
  * 
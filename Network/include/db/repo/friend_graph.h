@@ -0,0 +1,55 @@
+#ifndef FRIEND_GRAPH_H
+#define FRIEND_GRAPH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "db/core/db_error.h"
+
+#define FRIEND_GRAPH_MAX_ACCOUNTS   65536
+
+/**
+ * Friend Graph - shared in-memory adjacency of ACCEPTED friendships
+ *
+ * One sorted id list per account, loaded lazily from the friends table the
+ * first time the account is looked at, then kept in sync by the repo:
+ * friend_request_accept adds the edge, friend_remove drops it.
+ *
+ * Edge updates only touch accounts that are already loaded; an account that
+ * was never loaded picks the change up from the DB when it is first read.
+ *
+ * At most FRIEND_GRAPH_MAX_ACCOUNTS accounts stay loaded: past that the
+ * least recently read one is dropped and reloaded on its next read, which
+ * the rule above keeps correct.
+ *
+ * Presence broadcast, friend list and invite / add-friend validation read
+ * from here instead of querying the DB per call.
+ */
+
+/**
+ * Get friend ids of an account
+ * Loads the account from the DB on first use.
+ * Caller must free *out_friend_ids (NULL when count is 0).
+ */
+db_error_t friend_graph_get_ids(
+    int32_t account_id,
+    int32_t **out_friend_ids,
+    int32_t *out_count
+);
+
+/** Check whether two accounts are friends (loads one side if needed) */
+db_error_t friend_graph_are_friends(
+    int32_t account_id_1,
+    int32_t account_id_2,
+    bool *out_are_friends
+);
+
+/** Record an accepted friendship (both directions) */
+void friend_graph_add_edge(int32_t account_id_1, int32_t account_id_2);
+
+/** Forget a friendship (both directions) */
+void friend_graph_remove_edge(int32_t account_id_1, int32_t account_id_2);
+
+/** Drop every loaded account; next reads go back to the DB */
+void friend_graph_clear(void);
+
+#endif // FRIEND_GRAPH_H
@@ -42,6 +42,7 @@ db_error_t friend_request_list(
  * 
  * - Updates friend_requests status to ACCEPTED
  * - Creates bidirectional friendship (both directions)
+ * - Adds the edge to the in-memory friend graph
  * - Error handling:
  *   - ERR_NOT_FOUND if request doesn't exist
  *   - ERR_INVALID if request is not PENDING
@@ -69,6 +70,8 @@ db_error_t friend_request_reject(
  * Get list of friend IDs for a user
  * 
  * Returns array of account_ids that are friends with user_id
+ * Always hits the DB; this is the friend graph's loader. Callers that just
+ * need the ids should use friend_graph_get_ids.
  * Error handling:
  * - Returns empty array if user has no friends
  */
@@ -91,6 +94,7 @@ db_error_t friend_list_get_full(
 
 /**
  * Check if two users are friends
+ * Served from the in-memory friend graph.
  */
 db_error_t friend_check_relationship(
     int32_t user_id_1,
@@ -102,6 +106,7 @@ db_error_t friend_check_relationship(
  * Remove a friendship (both directions)
  * 
  * - Deletes both (user_id_1, user_id_2) and (user_id_2, user_id_1)
+ * - Drops the edge from the in-memory friend graph
  * - Error handling:
  *   - ERR_NOT_FOUND if friendship doesn't exist
  */
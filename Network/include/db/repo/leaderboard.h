@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Leaderboard (in-memory ranking over profiles.points)
+ *
+ * Indexable skip list ordered by points (desc), then account_id (asc), so
+ * ranks are stable and unique. Every link carries the number of entries it
+ * skips, which makes rank lookup and "entry at rank k" O(log n).
+ *
+ * Loaded once at startup from profiles, then updated incrementally:
+ *   - trigger_end_game() feeds each player's result (leaderboard_record_result)
+ *   - profile_create / profile_update_by_account keep names current
+ *
+ * Pages are serialized once per version and served from a small snapshot
+ * cache until the next change, so CMD_LEAD never runs ORDER BY.
+ */
+
+#define LEADERBOARD_DEFAULT_LIMIT   10
+#define LEADERBOARD_MAX_LIMIT       50
+#define LEADERBOARD_PAGE_SLOTS      16      // cached page snapshots
+
+typedef struct {
+    int32_t rank;           // 1-based, 0 = not ranked
+    int32_t account_id;
+    int32_t points;
+    int32_t wins;
+    int32_t matches;
+} leaderboard_entry_t;
+
+/** Load every profile; returns 0 on success */
+int leaderboard_preload(void);
+
+/** True once the preload finished */
+bool leaderboard_ready(void);
+
+/** Record a new or renamed profile (rank unchanged) */
+void leaderboard_put_profile(int32_t account_id, const char *name, const char *avatar);
+
+/**
+ * Apply one finished match for a player
+ * @param points_delta  Added to points (clamped at 0)
+ * @param won           Counts toward wins; matches always goes up by one
+ */
+void leaderboard_record_result(int32_t account_id, int32_t points_delta, bool won);
+
+/** Rank / totals of one account; false if the account is not ranked */
+bool leaderboard_get(int32_t account_id, leaderboard_entry_t *out);
+
+/** Number of ranked accounts */
+int32_t leaderboard_size(void);
+
+/**
+ * Serialized page: JSON array of
+ * {rank, account_id, name, avatar, points, wins, matches}
+ *
+ * @param offset  0-based rank offset
+ * @param limit   1..LEADERBOARD_MAX_LIMIT (<= 0 = default)
+ * @return malloc'd JSON (caller frees) or NULL on OOM
+ */
+char* leaderboard_page(int32_t offset, int limit, uint64_t *out_version, size_t *out_len);
+
+/**
+ * Entries ranked around an account: up to `radius` above and below it
+ * Same format as leaderboard_page; "[]" if the account is not ranked.
+ */
+char* leaderboard_around(int32_t account_id, int radius, uint64_t *out_version, size_t *out_len);
+
+/** Free everything (shutdown) */
+void leaderboard_cleanup(void);
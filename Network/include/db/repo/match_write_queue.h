@@ -0,0 +1,144 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "db/core/db_error.h"
+
+/**
+ * Match Write Queue (write-behind persistence)
+ *
+ * Gameplay records (answers, events, bonus questions, match_players / profiles updates) are buffered
+ * per match in memory and persisted by a background worker using multi-row
+ * INSERT / UPDATE ... FROM (VALUES ...) statements, one transaction per batch.
+ *
+ * - Enqueue calls never touch the database and never block on I/O
+ * - Failed batches are retried with exponential backoff; after
+ *   MATCH_WQ_MAX_ATTEMPTS the batch SQL is appended to a dead-letter file
+ * - While the DB is unavailable (db_is_available() == false) records are
+ *   held in memory without consuming retry attempts, up to
+ *   MATCH_WQ_MAX_PENDING records
+ * - match_wq_flush() is the barrier used at match end; it never blocks,
+ *   the writer reports back through a callback
+ * - A record for a match or player without a DB row (id 0) is logged and
+ *   counted (match_wq_skipped), never queued
+ */
+
+#define MATCH_WQ_BATCH_MAX          128     // records per statement batch
+#define MATCH_WQ_LINGER_MS          250     // max time a record waits before flush
+#define MATCH_WQ_RETRY_BASE_MS      200
+#define MATCH_WQ_RETRY_MAX_MS       5000
+#define MATCH_WQ_MAX_ATTEMPTS       8
+#define MATCH_WQ_FLUSH_TIMEOUT_MS   5000    // default barrier timeout at match end
+#define MATCH_WQ_MAX_PENDING        200000  // beyond this, spill straight to dead-letter
+#define MATCH_WQ_OUTAGE_POLL_MS     500     // writer poll period while the DB is down
+
+#define ENV_MATCH_WQ_DEADLETTER     "MATCH_WQ_DEADLETTER"
+#define MATCH_WQ_DEADLETTER_DEFAULT "match_wq_deadletter.sql"
+
+// Field mask for match_wq_player_update()
+#define MWQ_SET_SCORE       0x01
+#define MWQ_SET_ELIMINATED  0x02
+#define MWQ_SET_WINNER      0x04
+
+/** Start the background writer thread */
+void match_wq_init(void);
+
+/** Drain every pending record (best effort) and stop the writer thread */
+void match_wq_shutdown(void);
+
+/**
+ * Queue a match_answer row
+ *
+ * @param db_match_id  Owning match (batching key)
+ * @param question_id  match_question.id
+ * @param player_id    match_players.id
+ * @param answer_json  Answer snapshot (copied), may be NULL
+ */
+void match_wq_answer(
+    int64_t db_match_id,
+    int64_t question_id,
+    int32_t player_id,
+    const char *answer_json,
+    int score_delta,
+    int action_idx
+);
+
+/**
+ * Queue a match_events row (FORFEIT, ELIMINATED, ...)
+ *
+ * @param player_id  accounts.id (not match_players.id)
+ */
+void match_wq_event(
+    int64_t db_match_id,
+    int32_t player_id,
+    const char *event_type,
+    int round_no,
+    int question_idx
+);
+
+/**
+ * Queue a match_question row written during play (bonus round).
+ * A row already there for (match, round_no, question_idx) is kept.
+ *
+ * @param question_json  Question snapshot (copied), may be NULL
+ */
+void match_wq_question(
+    int64_t db_match_id,
+    int round_no,
+    const char *round_type,
+    int question_idx,
+    const char *question_json
+);
+
+/**
+ * Queue a match_players update. Updates to the same row that are still
+ * pending are merged, so only the latest value of each field is written.
+ *
+ * @param fields  MWQ_SET_* mask selecting which values are applied
+ */
+void match_wq_player_update(
+    int64_t db_match_id,
+    int32_t match_player_id,
+    unsigned fields,
+    int score,
+    bool eliminated,
+    bool winner
+);
+
+/**
+ * Queue the profiles totals update for one player of a finished match
+ * (points += delta, clamped at 0; wins += winner; matches += 1).
+ * Applied only while matches.ended_at is still NULL, so queue it before
+ * match_wq_match_ended() for the same match.
+ */
+void match_wq_profile_result(
+    int64_t db_match_id,
+    int32_t account_id,
+    int points_delta,
+    bool winner
+);
+
+/** Queue matches.ended_at for the match */
+void match_wq_match_ended(int64_t db_match_id, time_t ended_at);
+
+/**
+ * Flush completion: result is DB_OK once every record queued for the match
+ * before match_wq_flush() was persisted (or dead-lettered), DB_ERR_TIMEOUT
+ * if that took longer than timeout_ms, DB_ERR_UNAVAILABLE while the DB is
+ * down. Runs on the writer thread, or on the caller when there is nothing
+ * to wait for; it must not block.
+ */
+typedef void (*match_wq_flush_cb)(int64_t db_match_id, db_error_t result, void *arg);
+
+/**
+ * Flush barrier: write this match's records now instead of after the
+ * linger, and call cb (may be NULL) once they are in. Returns right away.
+ */
+void match_wq_flush(int64_t db_match_id, int timeout_ms, match_wq_flush_cb cb, void *arg);
+
+/** Number of records still waiting to be written (all matches) */
+int match_wq_pending(void);
+
+/** Number of records refused because their match or player had no DB id */
+uint64_t match_wq_skipped(void);
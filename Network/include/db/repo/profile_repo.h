@@ -21,6 +21,14 @@ db_error_t profile_find_by_account(
     profile_t **out_profile
 );
 
+// Find profiles for several accounts: cache hits first, one query for the rest.
+// out_profiles[i] matches account_ids[i] (NULL when missing); caller frees each.
+db_error_t profile_find_by_accounts(
+    const int32_t *account_ids,
+    int32_t count,
+    profile_t **out_profiles
+);
+
 void profile_free(profile_t *profile);
 
 // Update profile fields (name, avatar, bio) by owning account
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <cjson/cJSON.h>
+#include "db/core/db_error.h"
+
+/**
+ * Question Bank (in-memory)
+ *
+ * Active rows of `questions`, indexed by type and by (type, data->>'category').
+ * Snapshots are immutable: a refresh builds a new one and swaps it in, so
+ * sampling only takes a read lock.
+ *
+ * - Sampling is without replacement and O(k + excluded): a sparse
+ *   Fisher-Yates over the index, with exclusions checked in a hash set
+ * - Refresh is incremental (rows with updated_at newer than the last seen
+ *   value, inactive rows are dropped); a full reload catches hard deletes.
+ *   Edits to `questions` must bump updated_at to be picked up early.
+ */
+
+#define QUESTION_BANK_REFRESH_SEC       60
+#define QUESTION_BANK_FULL_RELOAD_SEC   3600
+
+/**
+ * Load every active question and start the refresh thread
+ * (the thread keeps retrying if the first load fails); returns 0 if loaded.
+ */
+int question_bank_init(void);
+
+/** Stop the refresh thread and free the snapshot */
+void question_bank_shutdown(void);
+
+/** true once a snapshot is loaded */
+bool question_bank_ready(void);
+
+/**
+ * Pick `count` distinct random questions
+ *
+ * @param round_type   questions.type ("mcq", "bid", "wheel")
+ * @param category     data->>'category', NULL/empty for all
+ * @param out_json     Array of question rows (caller owns); fewer than
+ *                     `count` if not enough remain after exclusion
+ * @return DB_OK, DB_ERROR_NOT_FOUND if nothing is available, or
+ *         DB_ERR_UNAVAILABLE if the bank is not loaded (caller should
+ *         fall back to the database)
+ */
+db_error_t question_bank_sample(
+    const char *round_type,
+    const char *category,
+    int count,
+    const int32_t *excluded_ids,
+    int excluded_count,
+    cJSON **out_json
+);
+
+/** Apply changed rows now instead of waiting for the next tick */
+int question_bank_refresh(void);
+
+/** Number of questions in the current snapshot */
+int question_bank_size(void);
+
+/**
+ * Seed the sampling RNG of the calling thread (reproducible runs, e.g. the
+ * match simulator); 0 goes back to a clock-derived seed
+ */
+void question_bank_seed(uint64_t seed);
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdint.h>
+#include "db/core/db_error.h"
+
+/**
+ * Recent Questions (per account, in-memory)
+ *
+ * Each account keeps a ring of the question ids it saw in its last
+ * RECENT_Q_MATCHES matches. Rings are updated when a match ends and unioned
+ * for the players at game start, so exclusion is a memory lookup.
+ *
+ * The rings are warmed once at startup from match_question; after that the
+ * database is not read again.
+ */
+
+#define RECENT_Q_MATCHES        5       // matches remembered per account
+#define RECENT_Q_PER_MATCH      32      // question ids kept per match
+#define RECENT_Q_BUCKETS        1024    // account hash buckets
+#define RECENT_Q_PRELOAD_DAYS   14      // history scanned by the warm-up
+
+/** Warm the rings from recent match_question rows; returns 0 on success */
+int recent_questions_preload(void);
+
+/** Free every ring (shutdown) */
+void recent_questions_cleanup(void);
+
+/**
+ * Record the questions of one finished match for its players
+ *
+ * @param account_ids   Players of the match
+ * @param question_ids  Question ids asked in the match (duplicates ignored)
+ */
+void recent_questions_record_match(
+    const int32_t *account_ids,
+    int player_count,
+    const int32_t *question_ids,
+    int question_count
+);
+
+/**
+ * Union of the questions seen by the given players
+ *
+ * @param recent_match_count  Matches per player to look back (capped at
+ *                            RECENT_Q_MATCHES)
+ * @param out_ids             Distinct ids (caller frees); NULL if none
+ */
+db_error_t recent_questions_collect(
+    const int32_t *account_ids,
+    int player_count,
+    int recent_match_count,
+    int32_t **out_ids,
+    int *out_count
+);
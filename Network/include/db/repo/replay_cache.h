@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "db/core/db_error.h"
+
+/*
+ * Replay / match-detail cache
+ *
+ * - Serialized db_match_get_detail() payloads keyed by DB match id
+ * - Only finished matches are stored (they never change), so there is no
+ *   invalidation: entries leave by LRU eviction only
+ * - Bounded by entry count and payload bytes (env, defaults below)
+ * - The write-behind writer pre-warms the entry once it has committed the
+ *   match end record (REPLAY_CACHE_PREWARM=1), off the gameplay threads
+ */
+
+#define ENV_REPLAY_CACHE_MAX_ENTRIES    "REPLAY_CACHE_MAX_ENTRIES"
+#define ENV_REPLAY_CACHE_MAX_BYTES      "REPLAY_CACHE_MAX_BYTES"
+#define ENV_REPLAY_CACHE_PREWARM        "REPLAY_CACHE_PREWARM"
+
+#define REPLAY_CACHE_MAX_ENTRIES_DEFAULT    256
+#define REPLAY_CACHE_MAX_BYTES_DEFAULT      (8 * 1024 * 1024)
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t entries;
+    size_t bytes;
+    size_t max_entries;
+    size_t max_bytes;
+} replay_cache_stats_t;
+
+/**
+ * Serialized replay for a match (read-through)
+ * Cache hit: one memcpy. Miss: db_match_get_detail + print, stored if the
+ * match is finished.
+ * Caller frees *out_json.
+ */
+db_error_t replay_cache_get(uint32_t match_id, char **out_json, size_t *out_len);
+
+/** Load a finished match into the cache if prewarming is enabled */
+void replay_cache_warm(uint32_t match_id);
+
+/** Copy counters */
+void replay_cache_stats(replay_cache_stats_t *out);
+
+/** Print hit rate / size to stdout */
+void replay_cache_report(void);
+
+/** Drop every entry (counters are kept) */
+void replay_cache_clear(void);
@@ -14,6 +14,29 @@ int room_repo_create(
     uint32_t *room_id
 );
 
+// One room of room_repo_create_batch
+typedef struct {
+    uint32_t host_id;
+    const char *name;
+    uint8_t visibility;
+    uint8_t mode;
+    uint8_t max_players;
+    uint8_t wager_enabled;
+    const uint32_t *members;    // account ids, host included
+    int member_count;
+
+    uint32_t room_id;           // out: 0 if this room was not created
+    char code[9];               // out
+} room_repo_new_t;
+
+/**
+ * Create several rooms and their members in two statements (one INSERT
+ * per table, whatever the count), for the event loop's quick-play tick.
+ * A room whose generated code is already taken is skipped (room_id 0).
+ * @return rooms created, -1 on a DB error (none were)
+ */
+int room_repo_create_batch(room_repo_new_t *rooms, int count);
+
 int room_repo_close(uint32_t room_id, char *out_buf, size_t out_size);
 
 int room_repo_set_rules(
@@ -37,6 +60,14 @@ int room_repo_leave(
     size_t out_size
 );
 
+/**
+ * Add player to room_members (DB only)
+ * @param room_id Room ID
+ * @param account_id Player account ID
+ * @return 0 on success, -1 on error
+ */
+int room_repo_add_player(uint32_t room_id, uint32_t account_id);
+
 //==============================================================================
 // LEAVE ROOM OPERATIONS
 //==============================================================================
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "db/core/db_error.h"
+
+/**
+ * User Index (in-memory search over profile names and emails)
+ *
+ * Loaded once at startup from accounts + profiles, then kept current by the
+ * repos: account_create adds the email, profile_create /
+ * profile_update_by_account set name and avatar.
+ *
+ * Matching, best first:
+ *   - exact name / email
+ *   - prefix of the full name or any word of the name
+ *   - fuzzy: share of the query's trigrams found in the name, for
+ *     queries of 3+ chars (Dice coefficient breaks ties)
+ * Emails are only ever matched in full, and a hit carries its email only
+ * for that exact match, so partial queries cannot enumerate addresses.
+ *
+ * Results are top-k with their display fields copied out, so a
+ * search-as-you-type keystroke never touches the database. Name keys
+ * live in a skip list: a profile change costs O(log n).
+ */
+
+#define USER_INDEX_DEFAULT_LIMIT    10
+#define USER_INDEX_MAX_LIMIT        20
+
+typedef struct {
+    int32_t account_id;
+    int score;          // higher is better
+    char *name;         // may be NULL
+    char *email;        // NULL unless the query was this exact email
+    char *avatar;       // may be NULL
+} user_index_hit_t;
+
+/** Load every account / profile; returns 0 on success (safe to retry) */
+int user_index_preload(void);
+
+/** True once the preload finished (before that, searches return nothing) */
+bool user_index_ready(void);
+
+/** Record a new or changed account email */
+void user_index_put_account(int32_t account_id, const char *email);
+
+/** Record a new or changed profile name / avatar */
+void user_index_put_profile(int32_t account_id, const char *name, const char *avatar);
+
+/**
+ * Top-k search
+ *
+ * @param exclude_account_id  Left out of the results (the searcher), 0 = none
+ * @param limit               1..USER_INDEX_MAX_LIMIT (<= 0 = default)
+ * @param out_hits            Array of at least `limit` slots
+ * @return number of hits written; free them with user_index_hits_free
+ */
+int user_index_search(
+    const char *query,
+    int32_t exclude_account_id,
+    int limit,
+    user_index_hit_t *out_hits
+);
+
+void user_index_hits_free(user_index_hit_t *hits, int count);
+
+/** Free everything (shutdown) */
+void user_index_cleanup(void);
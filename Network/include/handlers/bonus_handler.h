@@ -79,10 +79,10 @@ void handle_bonus(int client_fd, MessageHeader *req_header, const char *payload)
 bool check_and_trigger_bonus(uint32_t match_id, int after_round);
 
 /**
- * Handle player disconnect during Bonus Round
- * @param client_fd Client socket file descriptor
+ * Handle player disconnect during Bonus Round (runs on the match's shard)
+ * @param account_id Player who disconnected
  */
-void handle_bonus_disconnect(int client_fd);
+void handle_bonus_disconnect(int32_t account_id);
 
 /**
  * Check if bonus round is currently active for a match
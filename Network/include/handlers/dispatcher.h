@@ -3,12 +3,19 @@
 
 #include "protocol/protocol.h"
 
+#define DISPATCH_HELD_MAX       1024    // commands kept while the server starts
+#define DISPATCH_HELD_POLL_MS   50      // event loop wake-up while commands are held
+
 /**
  * Dispatch parsed command to application handlers.
  *
  * - Implemented by handler layer
  * - Called by socket_server
  * - Must NOT block
+ *
+ * Until startup_is_serving() (DB connect, required startup tasks) the
+ * command is held, in arrival order, and dispatched once it is; past
+ * DISPATCH_HELD_MAX held commands the client gets ERR_SERVICE_UNAVAILABLE.
  */
 void dispatch_command(
     int client_fd,
@@ -16,4 +23,14 @@ void dispatch_command(
     const char *payload
 );
 
+/**
+ * Dispatch the held commands if the server serves now (event loop, every
+ * iteration)
+ * @return commands still held
+ */
+int dispatch_held_commands(void);
+
+/** The connection closed: drop the commands it sent while held */
+void dispatch_forget_client(int client_fd);
+
 #endif // DISPATCHER_H
@@ -79,6 +79,17 @@ void handle_replay(
     int32_t account_id
 );
 
+/**
+ * CMD_LEAD: JSON reply {success, version, total, me, entries[]}
+ * served from the in-memory leaderboard (db/repo/leaderboard.h)
+ */
+void handle_leaderboard(
+    int client_fd,
+    MessageHeader *req_header,
+    const char *payload,
+    int32_t account_id
+);
+
 
 // New Payloads for CMD_HIST
 typedef struct PACKED {
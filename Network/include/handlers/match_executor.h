@@ -0,0 +1,89 @@
+#ifndef MATCH_EXECUTOR_H
+#define MATCH_EXECUTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "protocol/protocol.h"
+
+/**
+ * match_executor.h - Shard-owned matches (actor model)
+ *
+ * Every live match is owned by exactly one executor shard
+ * (runtime_match_id % shard count). A shard is one thread with a mailbox;
+ * everything that touches a match's round / bonus state runs there:
+ *   - player commands (posted by the dispatcher, payload copied)
+ *   - timers (question / product timeouts)
+ *   - disconnects (posted by the socket server)
+ *
+ * Messages of one match run one at a time, in the order they were posted,
+ * so round handlers need no locks. Matches on different shards run in
+ * parallel. Timers are one-shot and carry a token: the callback checks it
+ * against the current state and returns if it is stale (no cancel call).
+ * Timers have millisecond precision on the match clock below.
+ */
+
+#define MATCH_EXEC_DEFAULT_SHARDS   4
+#define MATCH_EXEC_MAX_SHARDS       32
+#define MATCH_EXEC_MAX_MAILBOX      4096    // queued messages per shard before posts are refused
+
+#define ENV_MATCH_SHARDS            "MATCH_SHARDS"
+
+// Runs a client command on the owning shard (same signature as handle_roundX)
+typedef void (*match_cmd_fn)(int client_fd, MessageHeader *req, const char *payload);
+
+// Runs a timer on the owning shard; token is the value given to post_timer
+typedef void (*match_timer_fn)(uint32_t match_id, uint64_t token);
+
+// Runs a disconnect on the owning shard
+typedef void (*match_disconnect_fn)(int32_t account_id);
+
+/**
+ * Start the shard threads (MATCH_SHARDS env, default MATCH_EXEC_DEFAULT_SHARDS)
+ * @return 0 on success, -1 if no shard could be started
+ */
+int match_exec_init(void);
+
+/** Run what is already queued, drop pending timers and stop the shards */
+void match_exec_shutdown(void);
+
+/**
+ * Queue a client command for the shard owning match_id
+ * The header and payload are copied. The command is dropped if client_fd
+ * no longer belongs to account_id when it runs (client left, fd reused).
+ * @return false if the mailbox is full or the executor is not running
+ */
+bool match_exec_post_command(uint32_t match_id, int client_fd, int32_t account_id,
+                             const MessageHeader *req, const char *payload,
+                             match_cmd_fn fn);
+
+/**
+ * Arm a one-shot timer on the shard owning match_id
+ * @param delay_ms  Time until fn runs (>= 0)
+ * @return false if the executor is not running
+ */
+bool match_exec_post_timer(uint32_t match_id, int delay_ms, match_timer_fn fn, uint64_t token);
+
+/**
+ * Queue a player disconnect for the shard owning match_id
+ * Accepted even when the mailbox is full.
+ * @return false if the executor is not running
+ */
+bool match_exec_post_disconnect(uint32_t match_id, int32_t account_id, match_disconnect_fn fn);
+
+/** Shard index owning match_id */
+int match_exec_shard_of(uint32_t match_id);
+
+/** Match clock: CLOCK_MONOTONIC in milliseconds (virtual in the simulator) */
+int64_t match_exec_now_ms(void);
+
+/**
+ * When the command running on this shard was received (match clock)
+ * Stamped when the dispatcher posted it, so time spent in a busy mailbox
+ * is not charged to the player. match_exec_now_ms() outside a command.
+ */
+int64_t match_exec_received_ms(void);
+
+/** True when called from a shard thread */
+bool match_exec_on_shard(void);
+
+#endif // MATCH_EXECUTOR_H
@@ -2,14 +2,25 @@
 #define MATCH_MANAGER_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include "handlers/start_game_handler.h"
 
 /**
  * match_manager.h - Centralized management of active matches
  * Provides APIs to create, lookup, update, and destroy match instances
+ *
+ * Matches are allocated in slabs (pointers stay valid, no upper bound) and
+ * indexed by runtime id, by room id and by player account (open
+ * addressing), so lookups and the live count are O(1). Ended matches are destroyed on their executor
+ * shard MATCH_REAP_DELAY_MS after match_set_status(MATCH_ENDED). A match
+ * that makes no progress (round, question or turn) for a whole
+ * MATCH_STALL_TIMEOUT_MS is ended there too, so it is reaped as well.
  */
 
-#define MAX_ACTIVE_MATCHES 100
+#define MATCH_SLAB_SIZE         16      // matches allocated at once
+#define MATCH_INDEX_MIN_CAP     256     // initial index slots (power of two)
+#define MATCH_REAP_DELAY_MS     120000  // ended match kept for late result requests
+#define MATCH_STALL_TIMEOUT_MS  300000  // no progress for this long: the match is ended
 
 //==============================================================================
 // Match Manager API
@@ -23,11 +34,15 @@ void match_manager_init(void);
 
 /**
  * Create and register a new match
- * @param match_id - Unique match identifier
- * @param room_id - Associated room ID
+ * The runtime id is generated here: sequential, never 0 and never the id
+ * of a match that is still live. Arms the stall watchdog on its shard.
+ * @param room_id - Associated room ID (becomes the room's current match)
+ * @param account_ids - Players, copied to players[].account_id; each one
+ *                      is routed to this match from now on
+ * @param player_count - Entries in account_ids (up to MAX_MATCH_PLAYERS)
  * @return Pointer to created MatchState, or NULL on failure
  */
-MatchState* match_create(uint32_t match_id, uint32_t room_id);
+MatchState* match_create(uint32_t room_id, const int32_t *account_ids, int player_count);
 
 /**
  * Find an active match by match_id
@@ -37,7 +52,7 @@ MatchState* match_create(uint32_t match_id, uint32_t room_id);
 MatchState* match_get_by_id(uint32_t match_id);
 
 /**
- * Find an active match by room_id
+ * Find the latest match created for a room (may already be ENDED)
  * @param room_id - Room identifier
  * @return Pointer to MatchState, or NULL if not found
  */
@@ -45,21 +60,79 @@ MatchState* match_get_by_room(uint32_t room_id);
 
 /**
  * Remove and destroy a match
+ * Call it on the match's executor shard, or before the match id has been
+ * handed out to clients.
  * @param match_id - Match identifier to destroy
  */
 void match_destroy(uint32_t match_id);
 
 /**
- * Get count of active matches (for debugging/monitoring)
+ * Find the match an account is currently playing in (not ENDED)
+ * Else the match it was last eliminated from, if that one has not ended.
+ * @param account_id - Player account
+ * @return Pointer to MatchState, or NULL if not in a match
+ */
+MatchState* match_find_by_player(int32_t account_id);
+
+/**
+ * Same as match_find_by_player(), but copies the id under the manager lock
+ * For callers off the owning shard (routing, disconnects).
+ * @return Runtime match id, or 0 if not in a match
+ */
+uint32_t match_find_id_by_player(int32_t account_id);
+
+/**
+ * Same as match_get_by_room(), but copies the id under the manager lock
+ * @return Runtime match id, or 0 if the room has no match
+ */
+uint32_t match_find_id_by_room(uint32_t room_id);
+
+/**
+ * Tell the index a player is out of a match (eliminated or forfeited)
+ * It is still found there, but any match where it is in play comes first.
+ * @param match - Match the player leaves
+ * @param account_id - Player account
+ */
+void match_player_out(MatchState *match, int32_t account_id);
+
+/**
+ * Get (or create) a handler context of a match
+ * Contexts are allocated zeroed on first use and owned by the match:
+ * match_destroy() releases them with free_fn (plain free() if NULL).
+ * @param match - Owning match
+ * @param slot - Which handler the context belongs to
+ * @param size - sizeof the handler's context struct
+ * @param free_fn - Destructor, called once from match_destroy()
+ * @return Context, or NULL if match is NULL or out of memory
+ */
+void* match_context_get(MatchState *match, MatchContextSlot slot, size_t size,
+                        void (*free_fn)(void *ctx));
+
+/**
+ * Find an existing handler context by match id
+ * @return Context, or NULL if the match or its context does not exist
+ */
+void* match_context_find(uint32_t match_id, MatchContextSlot slot);
+
+/**
+ * Get count of active matches (for debugging/monitoring), O(1)
  * @return Number of active matches
  */
 int match_get_count(void);
 
 /**
  * Update match status
+ * Moving to MATCH_ENDED stamps ended_at (if unset), drops its players from
+ * the account index and schedules the match to be destroyed after
+ * MATCH_REAP_DELAY_MS.
  * @param match - Match to update
  * @param status - New status
  */
 void match_set_status(MatchState *match, MatchStatus status);
 
+/**
+ * Free every match and the indexes (shutdown, after match_exec_shutdown)
+ */
+void match_manager_cleanup(void);
+
 #endif // MATCH_MANAGER_H
@@ -0,0 +1,39 @@
+#ifndef MATCH_QUESTION_H
+#define MATCH_QUESTION_H
+
+#include <cjson/cJSON.h>
+#include "handlers/start_game_handler.h"
+
+/**
+ * match_question.h - Decode questions once at match start
+ *
+ * handle_start_game turns each question row into typed MatchQuestion fields
+ * (choices, correct index, price, image) and pre-renders the client payload.
+ * Round handlers then only compare integers and splice the payload into
+ * their per-broadcast header.
+ *
+ * Every string is allocated from the match arena, so nothing here is freed
+ * one by one: match_destroy releases the arena.
+ */
+
+/**
+ * Fill mq from a question row ({id, type, data: {...}} or flat)
+ * mq->round / mq->index are left to the caller.
+ * @param arena  Match arena holding the decoded strings
+ * @return 0 on success, -1 on allocation failure
+ */
+int match_question_decode(MatchQuestion *mq, const cJSON *question_obj, RoundType type,
+                          Arena *arena);
+
+/** Clear mq (its strings stay in the arena until the match is destroyed) */
+void match_question_reset(MatchQuestion *mq);
+
+/**
+ * Wrap mq->payload with a caller-built header into one JSON object
+ * header: members without braces, e.g. "\"success\":true,\"question_idx\":0"
+ * @param arena  Where the frame is built; rewind to a mark once it is sent
+ * @return JSON string in the arena, NULL on failure
+ */
+char* match_question_render(const MatchQuestion *mq, const char *header, Arena *arena);
+
+#endif // MATCH_QUESTION_H
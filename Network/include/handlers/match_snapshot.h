@@ -0,0 +1,72 @@
+#ifndef MATCH_SNAPSHOT_H
+#define MATCH_SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "handlers/start_game_handler.h"
+
+/**
+ * match_snapshot.h - Game state for players who reconnect mid-match
+ *
+ * Scores, eliminations and the current round / question are already kept
+ * in MatchState; MatchState.snapshot adds what only the round handlers know
+ * (question deadline, who is ready, each player's answer for the current
+ * question). Handlers update it as events happen, on the match's shard.
+ *
+ * A reconnecting player gets everything in one NTF_GAME_STATE frame built
+ * from these fields, so the cost does not grow as the match progresses.
+ * Spectators get the same frame, without the "you" part, when they attach.
+ */
+
+//==============================================================================
+// Updates (round handlers, on the match's executor shard)
+//==============================================================================
+
+/**
+ * A question / product / turn starts: every player's answer state is reset
+ * @param question_idx  Index in the current round, -1 if the round has none
+ * @param time_limit_ms Answer window, 0 if there is no deadline
+ */
+void match_snapshot_begin(MatchState *match, int question_idx, int time_limit_ms);
+
+/** The answer window is over (result on screen until the next question) */
+void match_snapshot_close(MatchState *match);
+
+/** Player is ready for the current round */
+void match_snapshot_ready(MatchState *match, int32_t account_id);
+
+/**
+ * Record a player's answer for the current question / turn
+ * value0 / value1 depend on the round: MCQ choice index, bid, the two
+ * wheel spins (0 = not spun); unused for the bonus draw.
+ */
+void match_snapshot_answer(MatchState *match, int32_t account_id, MatchAnswerState state,
+                           int64_t value0, int64_t value1);
+
+//==============================================================================
+// Reconnect / spectators
+//==============================================================================
+
+/**
+ * Build the game state JSON of match (owning shard only)
+ * Built in match->arena: take an arena_mark() first, arena_rewind() after.
+ * An account that is not a player gets the spectator view (no "you").
+ * @return JSON string, or NULL on failure
+ */
+char* match_snapshot_render(MatchState *match, int32_t account_id);
+
+/**
+ * Send the NTF_GAME_STATE frame of match to a player (owning shard only)
+ */
+void match_snapshot_send(MatchState *match, int client_fd, int32_t account_id,
+                         MessageHeader *req);
+
+/**
+ * Queue NTF_GAME_STATE for a player who just got back into a match
+ * Call it after the login / reconnect response has been sent, so the
+ * client sees the state after it knows it is logged in.
+ * @return false if the account is not in a live match or the shard is busy
+ */
+bool match_snapshot_request(int client_fd, int32_t account_id, MessageHeader *req);
+
+#endif // MATCH_SNAPSHOT_H
@@ -0,0 +1,74 @@
+#ifndef MATCHMAKING_H
+#define MATCHMAKING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "protocol/protocol.h"
+
+/**
+ * matchmaking.h - Quick-play queue
+ *
+ * Players queue by (mode, question category); each queue is split into
+ * skill buckets seeded from the profile's points. Every
+ * MATCHMAKING_TICK_MS the event loop groups compatible players, oldest
+ * first, creates a private room for them through room_manager and marks
+ * them ready, so the first player (host) only has to start the game.
+ * The groups of a tick are written in one batch (room_repo_create_batch):
+ * two statements per tick, at most MATCHMAKING_ROOMS_PER_TICK rooms;
+ * the rest wait for the next tick.
+ *
+ * A bucket is a min-heap on enqueue time and every ticket is indexed by
+ * account: enqueue, cancel and taking the oldest player are O(log n).
+ * The skill range a player accepts widens the longer they wait.
+ *
+ * Event loop only (same thread as room_manager), no locking.
+ */
+
+#define MATCHMAKING_TICK_MS             1000
+#define MATCHMAKING_MAX_TICKETS         1024
+#define MATCHMAKING_BUCKET_POINTS       100     // profile points per skill bucket
+#define MATCHMAKING_SKILL_BUCKETS       16
+#define MATCHMAKING_WIDEN_MS            10000   // one more bucket each way per 10 s waited
+#define MATCHMAKING_MAX_SPREAD          MATCHMAKING_SKILL_BUCKETS
+#define MATCHMAKING_FILL_WAIT_MS        15000   // SCORING: start with 4-5 players after this
+#define MATCHMAKING_WAIT_BUCKETS        16      // <=250ms, <=500ms ... , overflow
+#define MATCHMAKING_ROOMS_PER_TICK      64
+
+typedef struct PACKED {
+    uint8_t mode;           // MODE_ELIMINATION / MODE_SCORING
+    uint8_t reserved[3];
+    char category[32];      // "lifestyle", "electronics", "furniture", "" = all
+} QuickPlayPayload;
+
+typedef struct {
+    uint64_t matched;       // players placed in a room
+    uint64_t cancelled;     // cancel / disconnect / no longer eligible
+    int queued;
+    double wait_p50_ms;
+    double wait_p90_ms;
+    double wait_p99_ms;
+    double wait_max_ms;
+} MatchmakingStats;
+
+/** CMD_QUICK_PLAY: join the queue, replies RES_QUEUED with the wait stats */
+void handle_quick_play(int client_fd, MessageHeader *req, const char *payload);
+
+/** CMD_QUICK_PLAY_CANCEL: leave the queue, replies RES_QUEUE_LEFT */
+void handle_quick_play_cancel(int client_fd, MessageHeader *req, const char *payload);
+
+/** Drop the account's ticket, if any (disconnect, joined a room) */
+void matchmaking_cancel(int32_t account_id);
+
+/** Form rooms; call on every event loop wake-up, runs every MATCHMAKING_TICK_MS */
+void matchmaking_tick(void);
+
+/** Wait-time percentiles of the players matched so far */
+void matchmaking_get_stats(MatchmakingStats *out);
+
+/** Print the stats line */
+void matchmaking_report(void);
+
+/** Free every ticket */
+void matchmaking_cleanup(void);
+
+#endif // MATCHMAKING_H
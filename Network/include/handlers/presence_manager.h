@@ -27,7 +27,7 @@ void presence_manager_init(void);
  * Register a user as online
  * 
  * Called when user successfully logs in.
- * Loads friend list from DB and broadcasts status to all online friends.
+ * Broadcasts status to all online friends (ids from the shared friend graph).
  */
 void presence_register_online(
     int32_t account_id,
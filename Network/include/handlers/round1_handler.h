@@ -9,7 +9,8 @@ void handle_round1(
     const char *payload
 );
 
-// Called when a client disconnects to clean up player state and notify others
-void handle_round1_disconnect(int client_fd);
+// Called on the match's executor shard when a player's client disconnects,
+// to clean up player state and notify others
+void handle_round1_disconnect(int32_t account_id);
 
 #endif
\ No newline at end of file
@@ -13,7 +13,8 @@ void handle_round2(
     const char *payload
 );
 
-// Called when a client disconnects to clean up player state and notify others
-void handle_round2_disconnect(int client_fd);
+// Called on the match's executor shard when a player's client disconnects,
+// to clean up player state and notify others
+void handle_round2_disconnect(int32_t account_id);
 
 #endif
@@ -12,9 +12,9 @@
 void handle_round3(int client_fd, MessageHeader *req_header, const char *payload);
 
 /**
- * Handle player disconnect during Round 3
- * @param client_fd Client socket file descriptor
+ * Handle player disconnect during Round 3 (runs on the match's shard)
+ * @param account_id Player who disconnected
  */
-void handle_round3_disconnect(int client_fd);
+void handle_round3_disconnect(int32_t account_id);
 
 #endif // ROUND3_HANDLER_H
@@ -0,0 +1,173 @@
+#ifndef ROUND_ENGINE_H
+#define ROUND_ENGINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "protocol/protocol.h"
+#include "handlers/start_game_handler.h"
+#include "handlers/session_manager.h"
+#include <cjson/cJSON.h>
+
+/**
+ * round_engine.h - Core shared by the round handlers
+ *
+ * Round 1 (MCQ), round 2 (bid) and round 3 (wheel) keep what is specific to
+ * them (answers, bids, spins) in their context; everything else lives here:
+ *   - the roster: players of the round in join order, each bound to its slot
+ *     in MatchState.players, so player lookups do not scan the match
+ *   - sessions: the UserSession of each match slot is cached per match
+ *     (MATCH_CTX_SESSIONS) and re-checked on use instead of scanning the
+ *     session table on every send
+ *   - broadcast, the score ranking, elimination of the lowest scorer and
+ *     what happens when a round ends
+ *
+ * A round type describes itself with a RoundKind (number, log tag, result
+ * opcode, callbacks for its own fields of the round end frame) and embeds a
+ * RoundCore as the FIRST member of its context, so callbacks can cast the
+ * core back to the context.
+ *
+ * Executor shard of the match only, like the contexts themselves.
+ */
+
+typedef struct RoundCore RoundCore;
+
+typedef struct {
+    int         number;             // 1-based round number (bonus after_round)
+    const char *tag;                // log prefix, "[Round1]"
+    uint16_t    all_finished_cmd;   // round end frame
+    bool        final;              // the match ends after this round
+
+    // Optional: round specific fields of the round end frame
+    void (*end_fields)(RoundCore *core, cJSON *obj);
+    // Optional: "finished_count" of the round end frame (default: roster size)
+    int  (*finished_count)(const RoundCore *core);
+} RoundKind;
+
+typedef struct {
+    int32_t account_id;
+    int     slot;                   // index in MatchState.players, -1 = not in the match
+} RoundSeat;
+
+struct RoundCore {
+    MatchState      *match;         // owner of the context (NULL = not bound yet)
+    uint32_t         match_id;
+    int              round_index;   // 0-based
+    bool             is_active;     // round running
+    const RoundKind *kind;
+
+    RoundSeat seats[MAX_MATCH_PLAYERS];     // same index as the context's players
+    int       seat_count;
+};
+
+// Filters of round_rank()
+#define ROUND_RANK_ALL          0
+#define ROUND_RANK_IN_PLAY      1   // connected and not eliminated
+
+typedef struct {
+    int32_t account_id;
+    int32_t score;
+} RoundRank;
+
+// What the end of a round leads to (see round_finish)
+typedef enum {
+    ROUND_END_NEXT_ROUND = 0,   // advance the match, broadcast the results
+    ROUND_END_BONUS,            // tie: the bonus round takes over
+    ROUND_END_GAME_OVER,        // one player left: end the match
+    ROUND_END_FINAL,            // broadcast the results, end the match
+    ROUND_END_HOLD,             // broadcast the results, the match stays put
+    ROUND_END_STEP_COUNT
+} RoundEndStep;
+
+//==============================================================================
+// ROSTER
+//==============================================================================
+
+/** Attach the core to its match (first ready / legacy start) */
+void round_core_bind(RoundCore *core, const RoundKind *kind, MatchState *match, int round_index);
+
+/** Seat of account_id, added if new. @return seat index, -1 if the round is full */
+int round_seat_add(RoundCore *core, int32_t account_id);
+
+/** Seat index of account_id, -1 if not in the roster */
+int round_seat_find(const RoundCore *core, int32_t account_id);
+
+//==============================================================================
+// LOOKUPS
+//==============================================================================
+
+/** RoundState the core plays, NULL if unbound or out of range */
+RoundState* round_state(const RoundCore *core);
+
+/** MatchPlayerState of account_id (roster slot first, then the match) */
+MatchPlayerState* round_player(const RoundCore *core, int32_t account_id);
+
+/** Session of account_id, PLAYING_DISCONNECTED included */
+UserSession* round_session(const RoundCore *core, int32_t account_id);
+
+/** Session exists and is not PLAYING_DISCONNECTED */
+bool round_connected(const RoundCore *core, int32_t account_id);
+
+/** Socket of account_id, -1 if disconnected */
+int round_socket(const RoundCore *core, int32_t account_id);
+
+/** Roster players connected / not connected */
+int round_connected_count(const RoundCore *core);
+int round_disconnected_count(const RoundCore *core);
+
+/** Match arena for outgoing frames (arena_mark / arena_rewind), NULL if unbound */
+Arena* round_arena(const RoundCore *core);
+
+// Same lookups for callers without a roster (bonus round)
+MatchPlayerState* round_match_player(MatchState *match, int32_t account_id);
+UserSession* round_match_session(MatchState *match, int32_t account_id);
+bool round_match_connected(MatchState *match, int32_t account_id);
+int round_match_socket(MatchState *match, int32_t account_id);
+
+//==============================================================================
+// SEND
+//==============================================================================
+
+void round_send_json(int fd, MessageHeader *req, uint16_t cmd, const char *json);
+
+/** Every connected roster player, then the match's spectators */
+void round_broadcast(const RoundCore *core, MessageHeader *req, uint16_t cmd, const char *json);
+
+//==============================================================================
+// RANKING / ELIMINATION
+//==============================================================================
+
+/**
+ * Roster players passing filter, sorted by score (stable: ties keep the
+ * roster order)
+ * @return number of entries written to out (MAX_MATCH_PLAYERS at most)
+ */
+int round_rank(const RoundCore *core, int filter, bool ascending, RoundRank *out);
+
+/** Eliminate mp now: NTF_ELIMINATION, session back to LOBBY, DB events */
+void round_eliminate(RoundCore *core, MatchPlayerState *mp, const char *reason);
+
+/**
+ * MODE_ELIMINATION end of round: disconnected players are eliminated, then
+ * the lowest scorer; a tie at the lowest score goes to the bonus round
+ * @return true if the bonus round was triggered
+ */
+bool round_eliminate_lowest(RoundCore *core);
+
+/** Move the match to its next round (PENDING). false if it was the last */
+bool round_match_advance(MatchState *match, const char *tag);
+
+//==============================================================================
+// END OF ROUND
+//==============================================================================
+
+/** Round end frame (players / rankings by score), malloc'd */
+char* round_end_json(RoundCore *core);
+
+/**
+ * The round's last question / turn / player is done: mark it ENDED, then
+ * eliminate / trigger the bonus round / advance / end the match, as the
+ * transition table says for the match mode and kind->final
+ */
+RoundEndStep round_finish(RoundCore *core, MessageHeader *req);
+
+#endif // ROUND_ENGINE_H
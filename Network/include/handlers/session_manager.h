@@ -34,4 +34,15 @@ void session_destroy(UserSession *s);
 void session_touch(int socket_fd);
 void session_cleanup_dead_sessions(void);
 
+// In-memory sessions are authoritative for require_auth(); the sessions
+// table is only written on login, logout and expiry/revocation.
+#define SESSION_SWEEP_INTERVAL_SEC 30
+
+// true if socket_fd is bound to session_id and not disconnected (touches it)
+bool session_validate_socket(int socket_fd, const char *session_id);
+// Revoke: delete the DB row, drop the fd binding, free the slot
+void session_revoke(UserSession *s);
+// Revoke whatever session the account holds (e.g. after an admin action)
+void session_revoke_account(int32_t account_id);
+
 #endif // SESSION_MANAGER_H
@@ -0,0 +1,26 @@
+#ifndef SPECTATOR_HANDLER_H
+#define SPECTATOR_HANDLER_H
+
+#include <stdint.h>
+#include "protocol/protocol.h"
+
+// room_id is only read when match_id is 0 (watch a room's match).
+// room_code is required to watch a private room's match (as in join by code).
+typedef struct PACKED {
+    uint32_t match_id;
+    uint32_t room_id;
+    char     room_code[8];
+} SpectateRequest;
+
+// CMD_SPECTATE, on the shard owning the match: replies RES_SPECTATING
+// with the game state, then round broadcasts follow (see spectator_hub.h)
+void handle_spectate(int client_fd, MessageHeader *req, const char *payload);
+
+// CMD_SPECTATE_LEAVE, on the event loop (no reply: frames stop)
+void handle_spectate_leave(int client_fd, MessageHeader *req, const char *payload);
+
+// Round handlers: pass a broadcast on to the match's spectators, with a
+// coalesced NTF_SCOREBOARD. Owning shard only; no-op if nobody watches.
+void spectator_forward(uint32_t match_id, uint16_t cmd, const char *json);
+
+#endif // SPECTATOR_HANDLER_H
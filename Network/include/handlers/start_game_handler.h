@@ -5,6 +5,7 @@
 #include <time.h>
 #include "protocol/protocol.h"
 #include "transport/room_manager.h"
+#include "utils/arena.h"
 
 #define MAX_MATCH_PLAYERS 8
 #define MAX_MATCH_ROUNDS 6
@@ -50,16 +51,34 @@ typedef enum {
 // STRUCT DEFINITIONS (ordered by dependencies)
 // ============================================================================
 
+#define MAX_QUESTION_CHOICES 8
+
 // Question data (no dependencies)
+// Decoded once in handle_start_game (match_question_decode), so round
+// handlers compare integers and copy the pre-rendered payload instead of
+// re-parsing json_data on every answer / broadcast.
 typedef struct {
     int round;           // Round number (1-based)
     int index;           // Question index within round (0-based)
-    char *json_data;     // JSON string containing question data
+    char *json_data;     // JSON string containing question data (persisted as-is)
+
+    // All strings below live in MatchState.arena
+
+    char *text;                             // "question" / "content" / "product_name"
+    char *image;                            // "image" / "product_image"
+    char *choices[MAX_QUESTION_CHOICES];
+    int choice_count;
+    int correct_index;   // MCQ: index into choices, -1 if unknown
+    int64_t price;       // BID: correct price, -1 if unknown
+
+    char *payload;       // client fields as JSON members without braces
+    size_t payload_len;
 } MatchQuestion;
 
 // Question state (no dependencies)
 typedef struct {
-    int32_t question_id;     // DB id
+    int32_t question_id;     // DB id: match_question row once inserted (answers refer to it)
+    int32_t source_id;       // questions.id (recent-question exclusion)
     QuestionStatus status;
 
     int answered_count;
@@ -98,10 +117,45 @@ typedef struct {
     time_t ended_at;             // Thời điểm round kết thúc (0 nếu chưa)
 } RoundState;
 
+// Per-match handler contexts (round / bonus execution state),
+// see match_context_get() in match_manager.h
+typedef enum {
+    MATCH_CTX_ROUND1 = 0,
+    MATCH_CTX_ROUND2,
+    MATCH_CTX_ROUND3,
+    MATCH_CTX_BONUS,
+    MATCH_CTX_SESSIONS,         // round_engine: session of each player slot
+    MATCH_CTX_COUNT
+} MatchContextSlot;
+
+// Reconnect snapshot (see match_snapshot.h)
+typedef enum {
+    MATCH_ANSWER_NONE    = 0,   // nothing sent for the current question / turn
+    MATCH_ANSWER_PENDING = 1,   // has to act (wheel decision, bonus draw)
+    MATCH_ANSWER_DONE    = 2    // answered / bid / stopped spinning / drew
+} MatchAnswerState;
+
+typedef struct {
+    uint32_t answer_seq;        // == MatchSnapshot.seq if the answer is current
+    MatchAnswerState answer;
+    int64_t  value[2];          // choice / bid / spins, see match_snapshot_answer()
+    int      ready_round;       // round number (1-based) the player is ready for
+} MatchSnapshotPlayer;
+
+typedef struct {
+    uint32_t seq;               // bumped per question / turn: older answers are stale
+    int      question_idx;      // -1 if the round has no questions (wheel, bonus)
+    bool     open;              // answer window running
+    int64_t  deadline_ms;       // match_exec_now_ms(), 0 = no deadline
+    time_t   started_at;        // wall clock, what the clients' start_timestamp uses
+    MatchSnapshotPlayer players[MAX_MATCH_PLAYERS];  // same index as MatchState.players
+} MatchSnapshot;
+
 // Match state (depends on MatchPlayerState, RoundState)
 typedef struct {
     uint32_t runtime_match_id;
     int64_t  db_match_id;
+    uint32_t room_id;
 
     MatchStatus status;
     GameMode mode;
@@ -115,8 +169,20 @@ typedef struct {
     
     char question_category[32]; // "lifestyle", "electronics", "furniture", or "" for all
 
+    bool private_room;          // spectators must give room_code (rooms stay on the event loop)
+    char room_code[9];
+
     time_t created_at;
     time_t ended_at;             // Time when match ended (0 if not ended)
+
+    void *contexts[MATCH_CTX_COUNT];                  // owned, freed by match_destroy
+    void (*context_free[MATCH_CTX_COUNT])(void *ctx);
+
+    MatchSnapshot snapshot;     // what a reconnecting player is sent
+
+    // Question strings, pre-rendered payloads and per-broadcast scratch
+    // frames (arena_mark / arena_rewind). Released at once by match_destroy.
+    Arena arena;
 } MatchState;
 
 
@@ -22,6 +22,8 @@
 #define CMD_SET_RULE        0x0206
 #define CMD_CLOSE_ROOM      0x0207  // Host closes room
 #define CMD_GET_ROOM_LIST   0x0208  // Get list of waiting rooms
+#define CMD_QUICK_PLAY      0x0209  // Join the matchmaking queue
+#define CMD_QUICK_PLAY_CANCEL 0x020A // Leave the matchmaking queue
 
 // Gameplay
 #define CMD_START_GAME      0x0300
@@ -30,6 +32,8 @@
 #define CMD_SPIN            0x0303
 #define CMD_FORFEIT         0x0304
 #define CMD_BONUS           0x0305
+#define CMD_SPECTATE        0x0306  // Watch a live match {match_id} or {0, room_id}, + room_code if private
+#define CMD_SPECTATE_LEAVE  0x0307  // Stop watching {match_id}, 0 / empty = every match
 
 // Social & History
 #define CMD_CHAT            0x0500
@@ -50,6 +54,7 @@
 
 // System
 #define CMD_HEARTBEAT       0x0001
+#define CMD_PONG            0x0002  // Echo of NTF_PING {probe_id} (RTT measurement)
 
 //==============================================================================
 // RESPONSE CODES
@@ -67,7 +72,10 @@
 #define RES_MEMBER_KICKED   0x00E1  // 225
 #define RES_ROOM_LIST       0x00E4  // 228
 #define RES_GAME_STARTED    0x012D  // 301
+#define RES_SPECTATING      0x012E  // 302 Game state of the match being watched
 #define RES_READY_OK        0x00EC  // 236
+#define RES_QUEUED          0x00ED  // 237
+#define RES_QUEUE_LEFT      0x00EE  // 238
 // Profile
 #define RES_PROFILE_UPDATED 0x00E2  // 226
 #define RES_PROFILE_FOUND   0x00E3  // 227
@@ -123,6 +131,9 @@
 #define NTF_MEMBER_KICKED   0x02CA  //714
 #define NTF_ROOM_CLOSED     0x02CB  //715
 #define NTF_HOST_CHANGED    0x02D1  //721
+#define NTF_GAME_STATE      0x02D2  //722 Snapshot for a player back in a match
+#define NTF_MATCH_FOUND     0x02D3  //723 Quick play placed the player in a room
+#define NTF_PING            0x02D4  //724 RTT probe {probe_id}, answer with CMD_PONG
 // Social Notifications (71x)
 #define NTF_FRIEND_REQUEST  0x02CC  // 716 Friend request received
 #define NTF_FRIEND_ACCEPTED 0x02CD  // 717 Friend request accepted
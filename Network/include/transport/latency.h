@@ -0,0 +1,56 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include "protocol/protocol.h"
+
+/**
+ * latency.h - Round-trip time of every logged-in connection
+ *
+ * The event loop sends NTF_PING {probe_id} every LATENCY_PROBE_INTERVAL_MS
+ * and the client echoes the payload in CMD_PONG. The server keeps the id
+ * and send time of the probe in flight, so a client can only make its RTT
+ * look larger by answering late, never smaller.
+ *
+ * Round handlers subtract latency_one_way_ms() from the server-measured
+ * answer time. That credit comes from the smallest of the last
+ * LATENCY_WINDOW samples, not the smoothed RTT: holding back a pong now
+ * and then gains nothing, only delaying every pong of the window does,
+ * and that is still capped at LATENCY_MAX_CREDIT_MS. Clients that never
+ * answer probes get no credit.
+ *
+ * Probes go out through forward_response, under the fd's outbox lock, so
+ * they never split a frame a shard is writing to the same player.
+ *
+ * Probes / pongs: event loop only. latency_rtt_ms / latency_one_way_ms:
+ * any thread (lock-free read).
+ */
+
+#define LATENCY_PROBE_INTERVAL_MS   2000
+#define LATENCY_MAX_FD              4096    // fds above are not measured
+#define LATENCY_MAX_SAMPLE_MS       3000    // slower pongs are discarded
+#define LATENCY_MAX_CREDIT_MS       150     // one-way credit per answer at most
+#define LATENCY_SMOOTHING_SHIFT     3       // srtt += (sample - srtt) / 8
+#define LATENCY_WINDOW              8       // samples the answer credit is taken from
+
+// NTF_PING / CMD_PONG payload
+typedef struct PACKED {
+    uint32_t probe_id;
+} LatencyProbe;
+
+/** Send a probe to client_fd (an unanswered one is superseded) */
+void latency_send_probe(int client_fd);
+
+/** CMD_PONG: take an RTT sample if it answers the probe in flight */
+void latency_on_pong(int client_fd, const MessageHeader *req, const char *payload);
+
+/** Smoothed RTT of client_fd in ms, -1 if not measured yet */
+int latency_rtt_ms(int client_fd);
+
+/** Half the smallest recent RTT, capped at LATENCY_MAX_CREDIT_MS; 0 if not measured */
+int latency_one_way_ms(int client_fd);
+
+/** The connection closed: the fd will be reused */
+void latency_forget(int client_fd);
+
+#endif // LATENCY_H
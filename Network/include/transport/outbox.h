@@ -0,0 +1,51 @@
+#ifndef OUTBOX_H
+#define OUTBOX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * outbox.h - Serialized writes to client sockets
+ *
+ * Client sockets are written by the event loop (lobby replies, probes),
+ * by the executor shards (round broadcasts) and by the spectator writer.
+ * Every frame goes through outbox_send(), which holds the fd's lock while
+ * it writes header and payload in one sendmsg:
+ *   - frames never interleave, whichever thread sends them
+ *   - what the socket does not take right away is kept, in order, in the
+ *     fd's outbound buffer; later frames queue behind it
+ *   - the event loop owns the drain: it is asked to watch EPOLLOUT while
+ *     the buffer is not empty and calls outbox_flush() when it fires
+ * A client whose buffer grows past OUTBOX_MAX_BYTES is shut down (the
+ * disconnect path cleans it up) instead of holding the senders back.
+ *
+ * Any thread. Sends never block.
+ */
+
+#define OUTBOX_MAX_FD       4096                // same range as latency.h
+#define OUTBOX_MAX_BYTES    (256 * 1024)        // buffered per client, then it is dropped
+
+/**
+ * Install the event loop hook: want_write(fd, true) once fd has buffered
+ * bytes, want_write(fd, false) once outbox_flush() wrote them out.
+ * Called with the fd's lock held: the hook must not send.
+ */
+void outbox_init(void (*want_write)(int fd, bool on));
+
+/**
+ * Queue one frame (head + body, either may be empty) for fd
+ * @return false if fd is out of range, shut down or over OUTBOX_MAX_BYTES
+ */
+bool outbox_send(int fd, const void *head, size_t head_len, const void *body, size_t body_len);
+
+/** EPOLLOUT: write buffered bytes. @return false on a send error */
+bool outbox_flush(int fd);
+
+/** Bytes still buffered for fd (spectator back-pressure) */
+size_t outbox_pending(int fd);
+
+/** The connection closed: drop what is buffered, the fd will be reused */
+void outbox_forget(int fd);
+
+#endif // OUTBOX_H
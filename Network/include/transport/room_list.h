@@ -0,0 +1,43 @@
+#ifndef ROOM_LIST_H
+#define ROOM_LIST_H
+
+/**
+ * room_list.h - Lobby room list served from room_manager
+ *
+ * The list of waiting rooms is kept as a prebuilt snapshot (one serialized
+ * JSON object per room, newest first). It is rebuilt only when
+ * room_get_version() moved since the last build, so a lobby refresh costs
+ * a filter pass and a memcpy, no DB round trip.
+ *
+ * Paging uses the room id as cursor (ids grow with creation time), so a page
+ * boundary stays stable while rooms come and go.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define ROOM_LIST_DEFAULT_LIMIT 10
+#define ROOM_LIST_MAX_LIMIT     50
+
+typedef struct {
+    uint32_t cursor;        // only rooms with id < cursor (0 = from newest)
+    int limit;              // 1..ROOM_LIST_MAX_LIMIT
+    int mode;               // GameMode, -1 = any
+    int visibility;         // RoomVisibility, -1 = any
+    int min_free_slots;     // 0 = any
+} RoomListQuery;
+
+/** Query with defaults (no filters, ROOM_LIST_DEFAULT_LIMIT) */
+void room_list_query_init(RoomListQuery *q);
+
+/**
+ * Build one page as a JSON array
+ *
+ * @param out_next_cursor  Cursor for the next page, 0 if this is the last
+ * @param out_version      Snapshot version the page was cut from
+ * @return malloc'd JSON array (caller frees), NULL on allocation failure
+ */
+char* room_list_page(const RoomListQuery *q, uint32_t *out_next_cursor,
+                     uint64_t *out_version, size_t *out_len);
+
+#endif // ROOM_LIST_H
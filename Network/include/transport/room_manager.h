@@ -59,6 +59,7 @@ typedef struct {
     uint8_t max_players;
     RoomVisibility visibility;
     uint8_t wager_mode;
+    char category[32];      // question category, "" = all (quick play)
     
     // Player tracking
     RoomPlayerState players[MAX_ROOM_MEMBERS];
@@ -157,6 +158,19 @@ const int* room_get_members(int room_id, int *out_count);
  */
 int room_get_count(void);
 
+/**
+ * Get room by position (0..room_get_count()-1), oldest first
+ */
+const RoomState* room_at(int index);
+
+/**
+ * Change tracking for derived views (room list snapshot)
+ * room_manager bumps the version on create/destroy/membership changes;
+ * handlers that edit RoomState fields directly must call room_mark_changed()
+ */
+void room_mark_changed(void);
+uint64_t room_get_version(void);
+
 /**
  * Broadcast NTF_PLAYER_LIST to all members in a room
  */
@@ -0,0 +1,90 @@
+#ifndef SPECTATOR_HUB_H
+#define SPECTATOR_HUB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "protocol/protocol.h"
+
+/**
+ * spectator_hub.h - Fan-out of live match frames to spectators
+ *
+ * Players get round broadcasts straight from the match's shard
+ * (forward_response). Spectators are served by one writer thread instead,
+ * so a match with many observers costs its shard one publish per frame:
+ *   - the frame (header + payload) is encoded once and shared, refcounted,
+ *     by every spectator queue
+ *   - score snapshots are coalesced: only the latest one per match is kept
+ *     and it goes out at most every SPECTATOR_SCORE_INTERVAL_MS
+ *   - frames go out through the fd's outbox (outbox.h), like every other
+ *     send, and wait here while the client's outbox backlog is over
+ *     SPECTATOR_OUTBOX_MAX_BYTES
+ *   - sends never block; a spectator whose queue overflows is dropped
+ *     rather than holding back the match
+ *
+ * Publishers only take a short inbox lock; when nobody watches a match,
+ * spectator_hub_watched() is a lock-free read and nothing is encoded.
+ */
+
+#define SPECTATOR_MAX_PER_MATCH       256
+#define SPECTATOR_QUEUE_MAX_FRAMES    64             // per spectator, before it is dropped
+#define SPECTATOR_QUEUE_MAX_BYTES     (256 * 1024)   // per spectator, before it is dropped
+#define SPECTATOR_INBOX_MAX           4096           // frames waiting for the writer
+#define SPECTATOR_SCORE_INTERVAL_MS   1000
+#define SPECTATOR_OUTBOX_MAX_BYTES    (64 * 1024)    // client backlog before frames wait here
+#define SPECTATOR_RETRY_MS            50             // re-try a backed-up client after this
+#define SPECTATOR_WATCH_SLOTS         1024
+
+/**
+ * Start the writer thread
+ * @return 0 on success, -1 on failure (spectating is refused, play goes on)
+ */
+int spectator_hub_init(void);
+
+/** Stop the writer and drop every spectator */
+void spectator_hub_shutdown(void);
+
+/**
+ * True if match_id may have spectators (false positives are possible)
+ * Lock-free: publishers check it before encoding anything.
+ */
+bool spectator_hub_watched(uint32_t match_id);
+
+/**
+ * Attach client_fd as a spectator of match_id
+ * Match frames then reach client_fd from the writer thread, so the reply
+ * to the spectate request goes first in its queue rather than through
+ * forward_response: cmd / payload (copied), with the seq_num of req.
+ * @return false if the hub is not running, the match is full or
+ *         client_fd already watches it (nothing was queued)
+ */
+bool spectator_hub_subscribe(uint32_t match_id, int client_fd, int32_t account_id,
+                             const MessageHeader *req, uint16_t cmd,
+                             const char *payload, uint32_t len);
+
+/**
+ * Detach client_fd from match_id (0 = from every match)
+ * Frames already in the fd's outbox still go out; those queued here are
+ * dropped.
+ */
+void spectator_hub_leave(uint32_t match_id, int client_fd);
+
+/**
+ * Forget client_fd at once (socket about to close, the fd will be reused)
+ * Call it from the disconnect path before close().
+ */
+void spectator_hub_disconnect(int client_fd);
+
+/** Queue a frame for every spectator of match_id (payload is copied) */
+void spectator_hub_publish(uint32_t match_id, uint16_t cmd, const char *payload, uint32_t len);
+
+/**
+ * Replace the pending score snapshot of match_id (payload is copied)
+ * Sent as cmd to spectators at most every SPECTATOR_SCORE_INTERVAL_MS.
+ */
+void spectator_hub_publish_scores(uint32_t match_id, uint16_t cmd, const char *payload,
+                                  uint32_t len);
+
+/** The match is gone: flush what is queued, then detach its spectators */
+void spectator_hub_close(uint32_t match_id);
+
+#endif // SPECTATOR_HUB_H
@@ -0,0 +1,74 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/**
+ * arena.h - Chunked bump allocator
+ *
+ * Memory is carved out of large chunks and released all at once with
+ * arena_destroy(). There is no per-allocation free: short-lived buffers
+ * (serialized frames) are taken after arena_mark() and given back with
+ * arena_rewind(), which keeps the chunks for the next use.
+ *
+ * Not thread-safe: an arena belongs to one owner (a match is only touched
+ * on its executor shard).
+ */
+
+#define ARENA_CHUNK_SIZE    16384   // default chunk payload size (bytes)
+
+typedef struct ArenaChunk ArenaChunk;
+
+typedef struct {
+    ArenaChunk *head;       // chunk being filled (newest)
+    ArenaChunk *spare;      // chunks given back by arena_rewind
+    size_t chunk_size;
+    size_t reserved;        // bytes malloc'd for chunks (head list + spare)
+    size_t peak;            // highest arena_used() seen
+} Arena;
+
+// Position returned by arena_mark()
+typedef struct {
+    ArenaChunk *chunk;
+    size_t used;
+} ArenaMark;
+
+/** Prepare an empty arena (no memory is allocated until the first use) */
+void arena_init(Arena *arena, size_t chunk_size);
+
+/** Free every chunk and reset the arena */
+void arena_destroy(Arena *arena);
+
+/**
+ * Allocate size bytes (max_align_t aligned)
+ * @return pointer valid until arena_destroy / a rewind past it, NULL on OOM
+ */
+void* arena_alloc(Arena *arena, size_t size);
+
+/** Copy len bytes of s and NUL-terminate; NULL if s is NULL or on OOM */
+char* arena_strndup(Arena *arena, const char *s, size_t len);
+
+/** Copy a NUL-terminated string; NULL if s is NULL or on OOM */
+char* arena_strdup(Arena *arena, const char *s);
+
+/**
+ * Expose the free tail of the current chunk for an in-place write
+ * Starts a new chunk when fewer than min_size bytes are left.
+ * Nothing is allocated until arena_commit().
+ * @param out_avail  Bytes writable at the returned pointer
+ */
+char* arena_reserve(Arena *arena, size_t min_size, size_t *out_avail);
+
+/** Keep the first size bytes written after arena_reserve() */
+void arena_commit(Arena *arena, size_t size);
+
+/** Current position, for a later arena_rewind() */
+ArenaMark arena_mark(const Arena *arena);
+
+/** Release everything allocated since mark (chunks are kept as spares) */
+void arena_rewind(Arena *arena, ArenaMark mark);
+
+/** Bytes handed out and not rewound */
+size_t arena_used(const Arena *arena);
+
+#endif // ARENA_H
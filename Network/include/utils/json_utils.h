@@ -1,6 +1,9 @@
 #ifndef JSON_UTILS_H
 #define JSON_UTILS_H
 
+#include <cjson/cJSON.h>
+#include "utils/arena.h"
+
 /**
  * json_utils.h - JSON string escaping utilities
  * RIÊNG - Each handler can use this
@@ -15,4 +18,13 @@
  */
 const char* json_escape_string(const char *input);
 
+/**
+ * Serialize item (unformatted) into arena memory
+ * Printed in place into the current chunk when it fits, so a frame costs
+ * no malloc/free. Take an arena_mark() before and rewind after sending.
+ *
+ * @return NUL-terminated JSON in the arena, NULL on failure
+ */
+char* json_print_arena(cJSON *item, Arena *arena);
+
 #endif // JSON_UTILS_H
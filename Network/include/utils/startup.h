@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdbool.h>
+
+/**
+ * Startup Pipeline
+ *
+ * The listener is bound first; everything that needs the database runs on
+ * background workers while the event loop already accepts connections:
+ *
+ *   connect DB ─┬─ required tasks (zombie-room cleanup, ...)  -> WARMING
+ *               └─ preload tasks (cache warm-up, in parallel)  -> READY
+ *
+ * A failed STARTUP_TASK_PRELOAD_RETRY task is run again, with backoff
+ * (STARTUP_RETRY_FIRST_MS doubling up to STARTUP_RETRY_MAX_MS), until it
+ * succeeds; READY waits for it.
+ *
+ * While STARTING the dispatcher holds commands (dispatcher.h) instead of
+ * racing the cleanup and runs them once serving. WARMING already serves
+ * everything; caches still loading fall back to the database.
+ */
+
+typedef enum {
+    STARTUP_STARTING = 0,   // DB connect / required tasks still running
+    STARTUP_WARMING,        // serving; preloads still running
+    STARTUP_READY           // all tasks finished
+} startup_state_t;
+
+typedef enum {
+    STARTUP_TASK_REQUIRED,  // must finish before commands are served
+    STARTUP_TASK_PRELOAD,   // cache warm-up, runs in parallel
+    STARTUP_TASK_PRELOAD_RETRY  // same, retried until it succeeds (must be idempotent)
+} startup_task_kind_t;
+
+/** Task body; return 0 on success (failures are logged, never fatal) */
+typedef int (*startup_task_fn)(void);
+
+#define STARTUP_MAX_TASKS       16
+#define STARTUP_RETRY_FIRST_MS  1000
+#define STARTUP_RETRY_MAX_MS    60000
+
+/**
+ * Register a task (call before startup_run)
+ *
+ * @param name  Label for the [STARTUP] log lines
+ */
+void startup_add_task(const char *name, startup_task_fn fn, startup_task_kind_t kind);
+
+/**
+ * Start the pipeline on a background thread and return immediately
+ *
+ * @param db_ready_fn  Connect step run before any task (e.g. db_client_init
+ *                     wrapper); its result is passed to the tasks via
+ *                     startup_db_available()
+ */
+void startup_run(int (*db_ready_fn)(void));
+
+/** Stop retrying and wait for the pipeline to finish (shutdown path) */
+void startup_join(void);
+
+startup_state_t startup_state(void);
+const char *startup_state_name(startup_state_t state);
+
+/** true once required tasks are done (commands may be served) */
+bool startup_is_serving(void);
+
+/** true if the connect step succeeded (tasks skip DB work otherwise) */
+bool startup_db_available(void);
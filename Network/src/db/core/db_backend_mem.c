@@ -0,0 +1,2248 @@
+#include "db/core/db_backend.h"
+#include "db/core/db_config.h"
+#include "db/core/db_stats.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <cjson/cJSON.h>
+
+/*
+ * In-memory backend
+ *
+ * Executes the SQL subset the repos emit against in-process tables, so the
+ * whole server path can run without PostgreSQL:
+ *
+ * - SELECT cols | * FROM t [a] [[INNER] JOIN t2 [b] ON ...] [WHERE ...]
+ *   [ORDER BY ...] [LIMIT n] [OFFSET n] and UNION [ALL] of those;
+ *   rooms_with_counts is computed on the fly
+ * - INSERT INTO t (cols) VALUES (...), ... [ON CONFLICT ... DO NOTHING |
+ *   DO UPDATE SET ...] [RETURNING ...]
+ * - UPDATE t [a] SET c = v, ... [FROM (VALUES (...), ...) AS v(cols)]
+ *   [WHERE ...] [RETURNING ...]
+ * - DELETE FROM t [WHERE ...] [RETURNING ...]
+ * - SELECT * FROM close_room(...) / kick_member(...) / leave_room(...)
+ *
+ * WHERE supports AND / OR / NOT, parentheses, = <> < <= > >=, IN (...),
+ * IS [NOT] NULL, EXISTS (SELECT ...) and data->>'key'. Values may be
+ * a.col, COALESCE / GREATEST / LEAST, x +/- n and NOW() +/- INTERVAL.
+ * Anything else (WITH, LEFT JOIN, ...) fails with DB_ERROR_NOT_IMPLEMENTED
+ * and is logged once per statement; a multi-statement string is parsed
+ * whole first, so such a statement fails it before any of it has run.
+ * No foreign keys or cascades.
+ */
+
+#define MEM_NAME_LEN        64
+#define MEM_MAX_ORDER       4
+#define MEM_MAX_UNION       4
+#define MEM_MAX_UNIQUE      2
+#define MEM_MAX_WARNED      64
+#define MEM_MAX_JOIN        4
+
+//==============================================================================
+// SCHEMA (mirrors Database/init/01_schema.sql)
+//==============================================================================
+
+// Column types: i=int, s=text, b=bool, j=jsonb, t=timestamp
+typedef struct {
+    const char *name;
+    char type;
+    const char *def;    // default literal, "now" or NULL
+} mem_col_t;
+
+typedef struct {
+    const char *name;
+    const mem_col_t *cols;
+    int ncols;
+    int serial;                                 // id SERIAL PRIMARY KEY
+    const char *unique[MEM_MAX_UNIQUE][4];      // NULL-terminated column sets
+    cJSON *rows;
+    int next_id;
+} mem_table_t;
+
+#define COLS(a) a, (int)(sizeof(a) / sizeof(a[0]))
+
+static const mem_col_t c_accounts[] = {
+    {"id", 'i', NULL}, {"email", 's', NULL}, {"password", 's', NULL},
+    {"role", 's', "user"}, {"created_at", 't', "now"}, {"updated_at", 't', "now"},
+};
+static const mem_col_t c_sessions[] = {
+    {"account_id", 'i', NULL}, {"session_id", 's', NULL},
+    {"connected", 'b', NULL}, {"updated_at", 't', "now"},
+};
+static const mem_col_t c_profiles[] = {
+    {"id", 'i', NULL}, {"account_id", 'i', NULL}, {"name", 's', NULL},
+    {"avatar", 's', NULL}, {"bio", 's', NULL}, {"matches", 'i', "0"},
+    {"wins", 'i', "0"}, {"points", 'i', "0"}, {"badges", 'j', NULL},
+    {"created_at", 't', "now"}, {"updated_at", 't', "now"},
+};
+static const mem_col_t c_friends[] = {
+    {"id", 'i', NULL}, {"requester_id", 'i', NULL}, {"addressee_id", 'i', NULL},
+    {"status", 's', NULL}, {"created_at", 't', "now"}, {"updated_at", 't', "now"},
+};
+static const mem_col_t c_rooms[] = {
+    {"id", 'i', NULL}, {"name", 's', NULL}, {"code", 's', NULL},
+    {"visibility", 's', NULL}, {"host_id", 'i', NULL}, {"wager_mode", 'b', "false"},
+    {"max_players", 'i', NULL}, {"mode", 's', NULL}, {"status", 's', NULL},
+    {"created_at", 't', "now"}, {"updated_at", 't', "now"},
+};
+static const mem_col_t c_room_members[] = {
+    {"room_id", 'i', NULL}, {"account_id", 'i', NULL}, {"joined_at", 't', "now"},
+};
+static const mem_col_t c_matches[] = {
+    {"id", 'i', NULL}, {"room_id", 'i', NULL}, {"mode", 's', NULL},
+    {"max_players", 'i', NULL}, {"advanced", 'j', NULL},
+    {"started_at", 't', NULL}, {"ended_at", 't', NULL},
+};
+static const mem_col_t c_match_players[] = {
+    {"id", 'i', NULL}, {"match_id", 'i', NULL}, {"account_id", 'i', NULL},
+    {"score", 'i', "0"}, {"eliminated", 'b', "false"}, {"forfeited", 'b', "false"},
+    {"winner", 'b', "false"}, {"rank", 'i', NULL}, {"joined_at", 't', "now"},
+};
+static const mem_col_t c_match_question[] = {
+    {"id", 'i', NULL}, {"match_id", 'i', NULL}, {"round_no", 'i', NULL},
+    {"round_type", 's', NULL}, {"question_idx", 'i', NULL}, {"question", 'j', NULL},
+    {"created_at", 't', "now"},
+};
+static const mem_col_t c_match_answer[] = {
+    {"id", 'i', NULL}, {"question_id", 'i', NULL}, {"player_id", 'i', NULL},
+    {"answer", 'j', NULL}, {"score_delta", 'i', NULL}, {"action_idx", 'i', "1"},
+    {"created_at", 't', "now"},
+};
+static const mem_col_t c_questions[] = {
+    {"id", 'i', NULL}, {"type", 's', NULL}, {"data", 'j', NULL},
+    {"active", 'b', "true"}, {"created_at", 't', "now"}, {"updated_at", 't', "now"},
+};
+static const mem_col_t c_match_events[] = {
+    {"id", 'i', NULL}, {"match_id", 'i', NULL}, {"player_id", 'i', NULL},
+    {"event_type", 's', NULL}, {"round_no", 'i', NULL}, {"question_idx", 'i', NULL},
+    {"created_at", 't', "now"},
+};
+
+static mem_table_t g_tables[] = {
+    { "accounts",       COLS(c_accounts),       1, {{"email", NULL}}, NULL, 0 },
+    { "sessions",       COLS(c_sessions),       0, {{"account_id", NULL}}, NULL, 0 },
+    { "profiles",       COLS(c_profiles),       1, {{NULL}}, NULL, 0 },
+    { "friends",        COLS(c_friends),        1, {{"requester_id", "addressee_id", NULL}}, NULL, 0 },
+    { "rooms",          COLS(c_rooms),          1, {{"code", NULL}}, NULL, 0 },
+    { "room_members",   COLS(c_room_members),   0, {{"room_id", "account_id", NULL}}, NULL, 0 },
+    { "matches",        COLS(c_matches),        1, {{NULL}}, NULL, 0 },
+    { "match_players",  COLS(c_match_players),  1, {{NULL}}, NULL, 0 },
+    { "match_question", COLS(c_match_question), 1, {{"match_id", "round_no", "question_idx", NULL}}, NULL, 0 },
+    { "match_answer",   COLS(c_match_answer),   1, {{"question_id", "player_id", "action_idx", NULL}}, NULL, 0 },
+    { "questions",      COLS(c_questions),      1, {{NULL}}, NULL, 0 },
+    { "match_events",   COLS(c_match_events),   1, {{NULL}}, NULL, 0 },
+};
+#define MEM_TABLE_COUNT ((int)(sizeof(g_tables) / sizeof(g_tables[0])))
+
+// View: rooms + current_players (computed per query)
+static const mem_col_t c_rooms_with_counts[] = {
+    {"id", 'i', NULL}, {"name", 's', NULL}, {"status", 's', NULL},
+    {"mode", 's', NULL}, {"max_players", 'i', NULL}, {"visibility", 's', NULL},
+    {"wager_mode", 'b', NULL}, {"created_at", 't', NULL}, {"current_players", 'i', NULL},
+};
+
+static pthread_mutex_t g_mem_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_int g_mem_ready = 0;      // read without g_mem_lock by mem_is_available
+
+static char g_warned[MEM_MAX_WARNED][DB_STATS_NAME_LEN];
+static int g_warned_count = 0;
+
+//==============================================================================
+// HELPERS: time / values
+//==============================================================================
+
+static void format_ts(time_t t, char *buf, size_t n) {
+    struct tm tm;
+    localtime_r(&t, &tm);
+    strftime(buf, n, "%Y-%m-%d %H:%M:%S", &tm);
+}
+
+// "YYYY-MM-DD[ T]HH:MM:SS[.fff][Z|+HH[:MM]]"; no offset means local time
+static int parse_ts(const char *s, time_t *out) {
+    int y, mo, d, h = 0, mi = 0, n = 0;
+    double sec = 0;
+    if (!s || sscanf(s, "%d-%d-%d%n", &y, &mo, &d, &n) != 3) return 0;
+
+    const char *p = s + n;
+    if (*p == 'T' || *p == ' ') {
+        int m = 0;
+        p++;
+        if (sscanf(p, "%d:%d:%lf%n", &h, &mi, &sec, &m) >= 2 && m > 0) p += m;
+        else if (sscanf(p, "%d:%d%n", &h, &mi, &m) == 2) p += m;
+    }
+
+    struct tm tm = {0};
+    tm.tm_year = y - 1900;
+    tm.tm_mon = mo - 1;
+    tm.tm_mday = d;
+    tm.tm_hour = h;
+    tm.tm_min = mi;
+    tm.tm_sec = (int)sec;
+
+    if (*p == 'Z') {
+        *out = timegm(&tm);
+    } else if (*p == '+' || *p == '-') {
+        int sign = (*p == '-') ? -1 : 1;
+        int oh = 0, om = 0;
+        if (sscanf(p + 1, "%2d:%2d", &oh, &om) < 1) return 0;
+        *out = timegm(&tm) - sign * (oh * 3600 + om * 60);
+    } else {
+        tm.tm_isdst = -1;
+        *out = mktime(&tm);
+    }
+    return 1;
+}
+
+typedef enum { V_NULL, V_NUM, V_STR } mem_vkind_t;
+
+typedef struct {
+    mem_vkind_t kind;
+    double num;
+    const char *str;
+    char *owned;        // freed by val_release
+} mem_val_t;
+
+static void val_release(mem_val_t *v) {
+    free(v->owned);
+    v->owned = NULL;
+}
+
+static mem_val_t val_from_json(const cJSON *j) {
+    mem_val_t v = { V_NULL, 0, NULL, NULL };
+    if (!j || cJSON_IsNull(j)) return v;
+    if (cJSON_IsNumber(j)) {
+        v.kind = V_NUM;
+        v.num = j->valuedouble;
+    } else if (cJSON_IsBool(j)) {
+        v.kind = V_NUM;
+        v.num = cJSON_IsTrue(j) ? 1 : 0;
+    } else if (cJSON_IsString(j)) {
+        v.kind = V_STR;
+        v.str = j->valuestring;
+    } else {
+        v.kind = V_STR;
+        v.owned = cJSON_PrintUnformatted(j);
+        v.str = v.owned ? v.owned : "";
+    }
+    return v;
+}
+
+static int str_to_num(const char *s, double *out) {
+    if (!s || !*s) return 0;
+    char *end = NULL;
+    *out = strtod(s, &end);
+    return end && *end == '\0';
+}
+
+/* Compare two values. Returns 0 if either is NULL (SQL unknown), else 1
+ * with *cmp set to <0, 0, >0. */
+static int val_compare(const mem_val_t *a, const mem_val_t *b, int as_ts, int *cmp) {
+    if (a->kind == V_NULL || b->kind == V_NULL) return 0;
+
+    double x, y;
+    if (a->kind == V_NUM && b->kind == V_NUM) {
+        x = a->num;
+        y = b->num;
+    } else if (a->kind == V_STR && b->kind == V_STR) {
+        time_t ta, tb;
+        if (as_ts && parse_ts(a->str, &ta) && parse_ts(b->str, &tb)) {
+            *cmp = (ta > tb) - (ta < tb);
+        } else {
+            *cmp = strcmp(a->str, b->str);
+        }
+        return 1;
+    } else {
+        // Mixed: '5' = 5 and TRUE = 't'
+        const mem_val_t *s = (a->kind == V_STR) ? a : b;
+        double n;
+        if (str_to_num(s->str, &n)) {
+            // accept PG bool spellings too
+        } else if (strcmp(s->str, "t") == 0 || strcasecmp(s->str, "true") == 0) {
+            n = 1;
+        } else if (strcmp(s->str, "f") == 0 || strcasecmp(s->str, "false") == 0) {
+            n = 0;
+        } else {
+            *cmp = (a->kind == V_STR) ? 1 : -1;
+            return 1;
+        }
+        x = (a->kind == V_STR) ? n : a->num;
+        y = (b->kind == V_STR) ? n : b->num;
+    }
+    *cmp = (x > y) - (x < y);
+    return 1;
+}
+
+//==============================================================================
+// LEXER
+//==============================================================================
+
+typedef enum { TK_END, TK_IDENT, TK_NUM, TK_STR, TK_SYM } mem_tk_type_t;
+
+typedef struct {
+    mem_tk_type_t type;
+    char *text;
+} mem_tk_t;
+
+typedef struct {
+    mem_tk_t *v;
+    int n;
+    int cap;
+} mem_tklist_t;
+
+static void tk_push(mem_tklist_t *l, mem_tk_type_t type, const char *s, size_t len) {
+    if (l->n == l->cap) {
+        l->cap = l->cap ? l->cap * 2 : 64;
+        l->v = realloc(l->v, sizeof(mem_tk_t) * (size_t)l->cap);
+    }
+    char *text = malloc(len + 1);
+    memcpy(text, s, len);
+    text[len] = '\0';
+    l->v[l->n].type = type;
+    l->v[l->n].text = text;
+    l->n++;
+}
+
+static void tk_free(mem_tklist_t *l) {
+    for (int i = 0; i < l->n; i++) free(l->v[i].text);
+    free(l->v);
+    memset(l, 0, sizeof(*l));
+}
+
+static int lex(const char *sql, mem_tklist_t *out) {
+    const char *p = sql;
+    while (*p) {
+        unsigned char c = (unsigned char)*p;
+        if (isspace(c)) {
+            p++;
+        } else if (c == '-' && p[1] == '-') {
+            while (*p && *p != '\n') p++;
+        } else if (c == '\'') {
+            // String literal, '' escapes a quote
+            size_t cap = 64, len = 0;
+            char *buf = malloc(cap);
+            p++;
+            for (;;) {
+                if (!*p) {
+                    free(buf);
+                    return 0;
+                }
+                if (*p == '\'') {
+                    if (p[1] == '\'') {
+                        p++;
+                    } else {
+                        p++;
+                        break;
+                    }
+                }
+                if (len + 2 > cap) {
+                    cap *= 2;
+                    buf = realloc(buf, cap);
+                }
+                buf[len++] = *p++;
+            }
+            tk_push(out, TK_STR, buf, len);
+            free(buf);
+        } else if (c == '"') {
+            const char *s = ++p;
+            while (*p && *p != '"') p++;
+            if (!*p) return 0;
+            tk_push(out, TK_IDENT, s, (size_t)(p - s));
+            p++;
+        } else if (isdigit(c) || (c == '.' && isdigit((unsigned char)p[1]))) {
+            const char *s = p;
+            while (isdigit((unsigned char)*p) || *p == '.') p++;
+            tk_push(out, TK_NUM, s, (size_t)(p - s));
+        } else if (isalpha(c) || c == '_') {
+            const char *s = p;
+            while (isalnum((unsigned char)*p) || *p == '_') p++;
+            tk_push(out, TK_IDENT, s, (size_t)(p - s));
+            char *t = out->v[out->n - 1].text;
+            for (; *t; t++) *t = (char)tolower((unsigned char)*t);
+        } else {
+            static const char *multi[] = { "->>", "->", "::", "<=", ">=", "<>", "!=" };
+            size_t len = 0;
+            for (size_t i = 0; i < sizeof(multi) / sizeof(multi[0]); i++) {
+                if (strncmp(p, multi[i], strlen(multi[i])) == 0) {
+                    len = strlen(multi[i]);
+                    break;
+                }
+            }
+            if (!len) {
+                if (!strchr("(),*=<>;.+-", c)) return 0;
+                len = 1;
+            }
+            tk_push(out, TK_SYM, p, len);
+            p += len;
+        }
+    }
+    return 1;
+}
+
+//==============================================================================
+// PARSER STATE (all allocations tracked, freed per statement)
+//==============================================================================
+
+typedef struct {
+    mem_tk_t *t;
+    int n;
+    int pos;
+    int unsupported;
+    int dry;            // parse only: check a script before running any of it
+    void **allocs;
+    int nallocs;
+    int capallocs;
+    cJSON **jsons;
+    int njsons;
+    int capjsons;
+} mem_ps_t;
+
+static mem_tk_t g_tk_end = { TK_END, "" };
+
+static void *ps_alloc(mem_ps_t *ps, size_t size) {
+    if (ps->nallocs == ps->capallocs) {
+        ps->capallocs = ps->capallocs ? ps->capallocs * 2 : 16;
+        ps->allocs = realloc(ps->allocs, sizeof(void *) * (size_t)ps->capallocs);
+    }
+    void *p = calloc(1, size);
+    ps->allocs[ps->nallocs++] = p;
+    return p;
+}
+
+static cJSON *ps_json(mem_ps_t *ps, cJSON *j) {
+    if (ps->njsons == ps->capjsons) {
+        ps->capjsons = ps->capjsons ? ps->capjsons * 2 : 16;
+        ps->jsons = realloc(ps->jsons, sizeof(cJSON *) * (size_t)ps->capjsons);
+    }
+    ps->jsons[ps->njsons++] = j;
+    return j;
+}
+
+static void ps_free(mem_ps_t *ps) {
+    for (int i = 0; i < ps->nallocs; i++) free(ps->allocs[i]);
+    for (int i = 0; i < ps->njsons; i++) cJSON_Delete(ps->jsons[i]);
+    free(ps->allocs);
+    free(ps->jsons);
+}
+
+static mem_tk_t *peek_at(mem_ps_t *ps, int k) {
+    return (ps->pos + k < ps->n) ? &ps->t[ps->pos + k] : &g_tk_end;
+}
+
+static mem_tk_t *peek(mem_ps_t *ps) {
+    return peek_at(ps, 0);
+}
+
+static int tk_is_kw(const mem_tk_t *t, const char *kw) {
+    return t->type == TK_IDENT && strcmp(t->text, kw) == 0;
+}
+
+static int tk_is_sym(const mem_tk_t *t, const char *s) {
+    return t->type == TK_SYM && strcmp(t->text, s) == 0;
+}
+
+static int accept_kw(mem_ps_t *ps, const char *kw) {
+    if (!tk_is_kw(peek(ps), kw)) return 0;
+    ps->pos++;
+    return 1;
+}
+
+static int accept_sym(mem_ps_t *ps, const char *s) {
+    if (!tk_is_sym(peek(ps), s)) return 0;
+    ps->pos++;
+    return 1;
+}
+
+static int expect_kw(mem_ps_t *ps, const char *kw) {
+    if (accept_kw(ps, kw)) return 1;
+    ps->unsupported = 1;
+    return 0;
+}
+
+static int expect_sym(mem_ps_t *ps, const char *s) {
+    if (accept_sym(ps, s)) return 1;
+    ps->unsupported = 1;
+    return 0;
+}
+
+static const char *g_reserved[] = {
+    "where", "order", "limit", "offset", "union", "returning", "set", "on",
+    "values", "join", "left", "inner", "group", "as", "from", "and", "or",
+    "not", "in", "is", "do", "asc", "desc", NULL
+};
+
+static int is_reserved(const char *s) {
+    for (int i = 0; g_reserved[i]; i++) {
+        if (strcmp(s, g_reserved[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+// [qualifier.]name -> qual (or "") and name
+static int parse_qualified(mem_ps_t *ps, char *qual, char *out) {
+    mem_tk_t *t = peek(ps);
+    if (t->type != TK_IDENT) {
+        ps->unsupported = 1;
+        return 0;
+    }
+    ps->pos++;
+    qual[0] = '\0';
+    if (tk_is_sym(peek(ps), ".") && peek_at(ps, 1)->type == TK_IDENT) {
+        snprintf(qual, MEM_NAME_LEN, "%s", t->text);
+        ps->pos++;
+        t = peek(ps);
+        ps->pos++;
+    }
+    snprintf(out, MEM_NAME_LEN, "%s", t->text);
+    return 1;
+}
+
+// [qualifier.]name -> name
+static int parse_ident(mem_ps_t *ps, char *out) {
+    char qual[MEM_NAME_LEN];
+    return parse_qualified(ps, qual, out);
+}
+
+// [AS] alias after a table name; defaults to the table name
+static void parse_alias(mem_ps_t *ps, char *alias, const char *table) {
+    snprintf(alias, MEM_NAME_LEN, "%s", table);
+    if (accept_kw(ps, "as") || (peek(ps)->type == TK_IDENT && !is_reserved(peek(ps)->text))) {
+        if (peek(ps)->type != TK_IDENT) {
+            ps->unsupported = 1;
+            return;
+        }
+        snprintf(alias, MEM_NAME_LEN, "%s", peek(ps)->text);
+        ps->pos++;
+    }
+}
+
+//==============================================================================
+// EXPRESSIONS
+//==============================================================================
+
+typedef enum { O_LIT, O_COL, O_JSON, O_NOW, O_FUNC } mem_okind_t;
+
+typedef struct mem_operand {
+    mem_okind_t kind;
+    char qual[MEM_NAME_LEN];    // a.col -> "a", else ""
+    char col[MEM_NAME_LEN];
+    char key[MEM_NAME_LEN];
+    int json_text;      // ->> (text) vs -> (json)
+    cJSON *lit;
+    char fn;            // O_FUNC: 'c'oalesce, 'g'reatest, 'l'east
+    struct mem_operand *args;
+    int nargs;
+    char arith;         // x + n, x - n; NOW() +/- INTERVAL in seconds
+    double delta;
+} mem_operand_t;
+
+// Rows in scope while a JOIN or UPDATE ... FROM is evaluated, by alias
+typedef struct {
+    const char *alias;
+    const cJSON *row;
+} mem_frame_t;
+
+static mem_frame_t g_frame[MEM_MAX_JOIN + 1];   // used under g_mem_lock
+static int g_frame_count = 0;
+
+static void skip_cast(mem_ps_t *ps, mem_operand_t *o) {
+    while (accept_sym(ps, "::")) {
+        mem_tk_t *t = peek(ps);
+        if (t->type != TK_IDENT) {
+            ps->unsupported = 1;
+            return;
+        }
+        ps->pos++;
+        // '{...}'::jsonb -> parsed JSON literal
+        if ((strcmp(t->text, "jsonb") == 0 || strcmp(t->text, "json") == 0) &&
+            o->kind == O_LIT && cJSON_IsString(o->lit)) {
+            cJSON *parsed = cJSON_Parse(o->lit->valuestring);
+            if (parsed) o->lit = ps_json(ps, parsed);
+        }
+        if (accept_sym(ps, "(")) {
+            while (!accept_sym(ps, ")") && peek(ps)->type != TK_END) ps->pos++;
+        }
+    }
+}
+
+// INTERVAL 'N days' -> seconds
+static int parse_interval(mem_ps_t *ps, double *out) {
+    mem_tk_t *t = peek(ps);
+    char unit[16] = "";
+    double n = 0;
+    if (t->type != TK_STR || sscanf(t->text, "%lf %15s", &n, unit) != 2) {
+        ps->unsupported = 1;
+        return 0;
+    }
+    ps->pos++;
+
+    static const struct { const char *unit; double secs; } units[] = {
+        {"second", 1}, {"minute", 60}, {"hour", 3600}, {"day", 86400}, {"week", 604800},
+    };
+    for (size_t i = 0; i < sizeof(units) / sizeof(units[0]); i++) {
+        if (strncasecmp(unit, units[i].unit, strlen(units[i].unit)) == 0) {
+            *out = n * units[i].secs;
+            return 1;
+        }
+    }
+    ps->unsupported = 1;
+    return 0;
+}
+
+static int parse_operand(mem_ps_t *ps, mem_operand_t *o);
+
+// COALESCE / GREATEST / LEAST (args)
+static int parse_func(mem_ps_t *ps, mem_operand_t *o) {
+    mem_tk_t *t = peek(ps);
+    if (tk_is_kw(t, "coalesce")) o->fn = 'c';
+    else if (tk_is_kw(t, "greatest")) o->fn = 'g';
+    else if (tk_is_kw(t, "least")) o->fn = 'l';
+    else {
+        // COUNT, subqueries, ...
+        ps->unsupported = 1;
+        return 0;
+    }
+    ps->pos += 2;
+    o->kind = O_FUNC;
+
+    int cap = 4;
+    o->args = ps_alloc(ps, sizeof(mem_operand_t) * (size_t)cap);
+    do {
+        if (o->nargs == cap) {
+            mem_operand_t *bigger = ps_alloc(ps, sizeof(mem_operand_t) * (size_t)cap * 2);
+            memcpy(bigger, o->args, sizeof(mem_operand_t) * (size_t)cap);
+            o->args = bigger;
+            cap *= 2;
+        }
+        if (!parse_operand(ps, &o->args[o->nargs++])) return 0;
+    } while (accept_sym(ps, ","));
+    return expect_sym(ps, ")");
+}
+
+static int parse_operand(mem_ps_t *ps, mem_operand_t *o) {
+    memset(o, 0, sizeof(*o));
+    mem_tk_t *t = peek(ps);
+
+    if (t->type == TK_STR) {
+        ps->pos++;
+        o->kind = O_LIT;
+        o->lit = ps_json(ps, cJSON_CreateString(t->text));
+    } else if (t->type == TK_NUM || (tk_is_sym(t, "-") && peek_at(ps, 1)->type == TK_NUM)) {
+        int neg = accept_sym(ps, "-");
+        t = peek(ps);
+        ps->pos++;
+        o->kind = O_LIT;
+        o->lit = ps_json(ps, cJSON_CreateNumber(neg ? -atof(t->text) : atof(t->text)));
+    } else if (tk_is_kw(t, "true") || tk_is_kw(t, "false")) {
+        ps->pos++;
+        o->kind = O_LIT;
+        o->lit = ps_json(ps, cJSON_CreateBool(tk_is_kw(t, "true")));
+    } else if (tk_is_kw(t, "null")) {
+        ps->pos++;
+        o->kind = O_LIT;
+        o->lit = ps_json(ps, cJSON_CreateNull());
+    } else if (tk_is_kw(t, "now") && tk_is_sym(peek_at(ps, 1), "(")) {
+        ps->pos++;
+        expect_sym(ps, "(");
+        expect_sym(ps, ")");
+        o->kind = O_NOW;
+    } else if (tk_is_kw(t, "to_timestamp") && tk_is_sym(peek_at(ps, 1), "(")) {
+        ps->pos += 2;
+        mem_tk_t *num = peek(ps);
+        if (num->type != TK_NUM) {
+            ps->unsupported = 1;
+            return 0;
+        }
+        ps->pos++;
+        expect_sym(ps, ")");
+        char buf[32];
+        format_ts((time_t)atof(num->text), buf, sizeof(buf));
+        o->kind = O_LIT;
+        o->lit = ps_json(ps, cJSON_CreateString(buf));
+    } else if (t->type == TK_IDENT && !tk_is_sym(peek_at(ps, 1), "(")) {
+        o->kind = O_COL;
+        if (!parse_qualified(ps, o->qual, o->col)) return 0;
+        if (tk_is_sym(peek(ps), "->>") || tk_is_sym(peek(ps), "->")) {
+            o->json_text = tk_is_sym(peek(ps), "->>");
+            ps->pos++;
+            mem_tk_t *key = peek(ps);
+            if (key->type != TK_STR) {
+                ps->unsupported = 1;
+                return 0;
+            }
+            ps->pos++;
+            o->kind = O_JSON;
+            snprintf(o->key, sizeof(o->key), "%s", key->text);
+        }
+    } else if (t->type == TK_IDENT) {
+        if (!parse_func(ps, o)) return 0;
+    } else {
+        ps->unsupported = 1;
+        return 0;
+    }
+
+    skip_cast(ps, o);
+
+    // x + n, x - n, NOW() - INTERVAL '7 days'
+    if (tk_is_sym(peek(ps), "+") || tk_is_sym(peek(ps), "-")) {
+        o->arith = peek(ps)->text[0];
+        ps->pos++;
+        if (o->kind == O_NOW) {
+            if (!expect_kw(ps, "interval") || !parse_interval(ps, &o->delta)) return 0;
+        } else {
+            int neg = accept_sym(ps, "-");
+            if (peek(ps)->type != TK_NUM) {
+                ps->unsupported = 1;
+                return 0;
+            }
+            o->delta = neg ? -atof(peek(ps)->text) : atof(peek(ps)->text);
+            ps->pos++;
+            skip_cast(ps, o);
+        }
+    }
+    return !ps->unsupported;
+}
+
+static const mem_col_t *table_col(const mem_col_t *cols, int ncols, const char *name) {
+    for (int i = 0; i < ncols; i++) {
+        if (strcmp(cols[i].name, name) == 0) return &cols[i];
+    }
+    return NULL;
+}
+
+// a.col: the frame row of alias a, else the "a.col" key of a joined row;
+// col: the row itself, else the first frame row that has it
+static const cJSON *row_col(const cJSON *row, const char *qual, const char *col) {
+    const cJSON *v;
+    if (qual[0]) {
+        for (int i = 0; i < g_frame_count; i++) {
+            if (strcmp(g_frame[i].alias, qual) == 0) {
+                return cJSON_GetObjectItemCaseSensitive(g_frame[i].row, col);
+            }
+        }
+        char key[MEM_NAME_LEN * 2 + 2];
+        snprintf(key, sizeof(key), "%s.%s", qual, col);
+        v = cJSON_GetObjectItemCaseSensitive(row, key);
+        if (v) return v;
+    }
+    v = cJSON_GetObjectItemCaseSensitive(row, col);
+    for (int i = 0; !v && i < g_frame_count; i++) {
+        v = cJSON_GetObjectItemCaseSensitive(g_frame[i].row, col);
+    }
+    return v;
+}
+
+static mem_val_t eval_operand(const mem_operand_t *o, const cJSON *row);
+
+// GREATEST / LEAST skip NULLs, COALESCE takes the first non-NULL
+static mem_val_t eval_func(const mem_operand_t *o, const cJSON *row) {
+    mem_val_t best = { V_NULL, 0, NULL, NULL };
+    for (int i = 0; i < o->nargs; i++) {
+        mem_val_t v = eval_operand(&o->args[i], row);
+        int cmp = 0;
+        if (v.kind == V_NULL) continue;
+        if (best.kind == V_NULL) {
+            best = v;
+            if (o->fn == 'c') break;
+            continue;
+        }
+        if (val_compare(&v, &best, 0, &cmp) && (o->fn == 'g' ? cmp > 0 : cmp < 0)) {
+            val_release(&best);
+            best = v;
+        } else {
+            val_release(&v);
+        }
+    }
+    return best;
+}
+
+static mem_val_t eval_base(const mem_operand_t *o, const cJSON *row) {
+    mem_val_t v = { V_NULL, 0, NULL, NULL };
+    switch (o->kind) {
+        case O_LIT:
+            return val_from_json(o->lit);
+        case O_COL:
+            return val_from_json(row_col(row, o->qual, o->col));
+        case O_FUNC:
+            return eval_func(o, row);
+        case O_JSON: {
+            const cJSON *doc = row_col(row, o->qual, o->col);
+            const cJSON *field = cJSON_IsObject(doc) ? cJSON_GetObjectItemCaseSensitive(doc, o->key) : NULL;
+            if (!field || cJSON_IsNull(field)) return v;
+            if (o->json_text && cJSON_IsNumber(field)) {
+                // ->> renders numbers as text
+                char buf[32];
+                snprintf(buf, sizeof(buf), "%.15g", field->valuedouble);
+                v.kind = V_STR;
+                v.owned = strdup(buf);
+                v.str = v.owned;
+                return v;
+            }
+            return val_from_json(field);
+        }
+        case O_NOW: {
+            char buf[32];
+            double shift = o->arith ? (o->arith == '+' ? o->delta : -o->delta) : 0;
+            format_ts(time(NULL) + (time_t)shift, buf, sizeof(buf));
+            v.kind = V_STR;
+            v.owned = strdup(buf);
+            v.str = v.owned;
+            return v;
+        }
+    }
+    return v;
+}
+
+static mem_val_t eval_operand(const mem_operand_t *o, const cJSON *row) {
+    mem_val_t v = eval_base(o, row);
+    if (o->arith && o->kind != O_NOW && v.kind == V_NUM) {
+        v.num += (o->arith == '+') ? o->delta : -o->delta;
+    }
+    return v;
+}
+
+//==============================================================================
+// WHERE
+//==============================================================================
+
+typedef enum { C_AND, C_OR, C_NOT, C_CMP, C_IN, C_ISNULL, C_EXISTS } mem_ckind_t;
+
+struct mem_select;
+
+typedef struct mem_cond {
+    mem_ckind_t kind;
+    struct mem_cond *l, *r;
+    mem_operand_t a, b;
+    char op[3];
+    mem_operand_t *list;
+    int nlist;
+    int negate;
+    struct mem_select *sub;     // EXISTS (SELECT ...), uncorrelated
+} mem_cond_t;
+
+static mem_cond_t *parse_or(mem_ps_t *ps);
+static void parse_select_core(mem_ps_t *ps, struct mem_select *s);
+static int exists_eval(const struct mem_select *s);
+static size_t select_size(void);
+
+static mem_cond_t *parse_pred(mem_ps_t *ps) {
+    mem_cond_t *c = ps_alloc(ps, sizeof(*c));
+
+    if (accept_kw(ps, "not")) {
+        c->kind = C_NOT;
+        c->l = parse_pred(ps);
+        return c;
+    }
+    if (accept_sym(ps, "(")) {
+        mem_cond_t *inner = parse_or(ps);
+        expect_sym(ps, ")");
+        return inner;
+    }
+    if (accept_kw(ps, "exists")) {
+        c->kind = C_EXISTS;
+        if (!expect_sym(ps, "(")) return c;
+        c->sub = ps_alloc(ps, select_size());
+        parse_select_core(ps, c->sub);
+        expect_sym(ps, ")");
+        return c;
+    }
+
+    if (!parse_operand(ps, &c->a)) return c;
+
+    if (accept_kw(ps, "is")) {
+        c->kind = C_ISNULL;
+        c->negate = accept_kw(ps, "not");
+        expect_kw(ps, "null");
+        return c;
+    }
+
+    int neg_in = 0;
+    if (tk_is_kw(peek(ps), "not") && tk_is_kw(peek_at(ps, 1), "in")) {
+        ps->pos++;
+        neg_in = 1;
+    }
+    if (accept_kw(ps, "in")) {
+        c->kind = C_IN;
+        c->negate = neg_in;
+        if (!expect_sym(ps, "(")) return c;
+        if (tk_is_kw(peek(ps), "select")) {
+            ps->unsupported = 1;
+            return c;
+        }
+        int cap = 8;
+        c->list = ps_alloc(ps, sizeof(mem_operand_t) * (size_t)cap);
+        do {
+            if (c->nlist == cap) {
+                mem_operand_t *bigger = ps_alloc(ps, sizeof(mem_operand_t) * (size_t)cap * 2);
+                memcpy(bigger, c->list, sizeof(mem_operand_t) * (size_t)cap);
+                c->list = bigger;
+                cap *= 2;
+            }
+            if (!parse_operand(ps, &c->list[c->nlist++])) return c;
+        } while (accept_sym(ps, ","));
+        expect_sym(ps, ")");
+        return c;
+    }
+
+    mem_tk_t *op = peek(ps);
+    static const char *ops[] = { "=", "<>", "!=", "<", "<=", ">", ">=" };
+    int found = 0;
+    for (size_t i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+        if (tk_is_sym(op, ops[i])) found = 1;
+    }
+    if (!found) {
+        ps->unsupported = 1;
+        return c;
+    }
+    ps->pos++;
+    c->kind = C_CMP;
+    snprintf(c->op, sizeof(c->op), "%s", strcmp(op->text, "!=") == 0 ? "<>" : op->text);
+    parse_operand(ps, &c->b);
+    return c;
+}
+
+static mem_cond_t *parse_and(mem_ps_t *ps) {
+    mem_cond_t *l = parse_pred(ps);
+    while (!ps->unsupported && accept_kw(ps, "and")) {
+        mem_cond_t *c = ps_alloc(ps, sizeof(*c));
+        c->kind = C_AND;
+        c->l = l;
+        c->r = parse_pred(ps);
+        l = c;
+    }
+    return l;
+}
+
+static mem_cond_t *parse_or(mem_ps_t *ps) {
+    mem_cond_t *l = parse_and(ps);
+    while (!ps->unsupported && accept_kw(ps, "or")) {
+        mem_cond_t *c = ps_alloc(ps, sizeof(*c));
+        c->kind = C_OR;
+        c->l = l;
+        c->r = parse_and(ps);
+        l = c;
+    }
+    return l;
+}
+
+typedef struct {
+    const mem_col_t *cols;
+    int ncols;
+} mem_schema_t;
+
+static int is_ts_operand(const mem_schema_t *s, const mem_operand_t *o) {
+    if (o->kind == O_NOW) return 1;
+    if (o->kind != O_COL) return 0;
+    const mem_col_t *col = table_col(s->cols, s->ncols, o->col);
+    return col && col->type == 't';
+}
+
+static int cond_eval(const mem_schema_t *s, const mem_cond_t *c, const cJSON *row) {
+    if (!c) return 1;
+
+    switch (c->kind) {
+        case C_AND: return cond_eval(s, c->l, row) && cond_eval(s, c->r, row);
+        case C_OR:  return cond_eval(s, c->l, row) || cond_eval(s, c->r, row);
+        case C_NOT: return !cond_eval(s, c->l, row);
+        case C_EXISTS: return exists_eval(c->sub);
+        case C_ISNULL: {
+            mem_val_t v = eval_operand(&c->a, row);
+            int is_null = (v.kind == V_NULL);
+            val_release(&v);
+            return c->negate ? !is_null : is_null;
+        }
+        case C_IN: {
+            mem_val_t v = eval_operand(&c->a, row);
+            int hit = 0;
+            for (int i = 0; i < c->nlist && !hit; i++) {
+                mem_val_t w = eval_operand(&c->list[i], row);
+                int cmp;
+                if (val_compare(&v, &w, 0, &cmp) && cmp == 0) hit = 1;
+                val_release(&w);
+            }
+            int known = (v.kind != V_NULL);
+            val_release(&v);
+            return known && (c->negate ? !hit : hit);
+        }
+        case C_CMP: {
+            mem_val_t a = eval_operand(&c->a, row);
+            mem_val_t b = eval_operand(&c->b, row);
+            int as_ts = is_ts_operand(s, &c->a) || is_ts_operand(s, &c->b);
+            int cmp = 0;
+            int known = val_compare(&a, &b, as_ts, &cmp);
+            val_release(&a);
+            val_release(&b);
+            if (!known) return 0;
+            if (strcmp(c->op, "=") == 0)  return cmp == 0;
+            if (strcmp(c->op, "<>") == 0) return cmp != 0;
+            if (strcmp(c->op, "<") == 0)  return cmp < 0;
+            if (strcmp(c->op, "<=") == 0) return cmp <= 0;
+            if (strcmp(c->op, ">") == 0)  return cmp > 0;
+            if (strcmp(c->op, ">=") == 0) return cmp >= 0;
+            return 0;
+        }
+    }
+    return 0;
+}
+
+//==============================================================================
+// PROJECTION (SELECT list / RETURNING)
+//==============================================================================
+
+typedef struct {
+    mem_operand_t expr;
+    char name[MEM_NAME_LEN];
+} mem_proj_item_t;
+
+typedef struct {
+    int star;
+    mem_proj_item_t *items;
+    int count;
+} mem_proj_t;
+
+static int parse_projection(mem_ps_t *ps, mem_proj_t *p) {
+    memset(p, 0, sizeof(*p));
+    if (accept_sym(ps, "*")) {
+        p->star = 1;
+        return 1;
+    }
+
+    int cap = 8;
+    p->items = ps_alloc(ps, sizeof(mem_proj_item_t) * (size_t)cap);
+    do {
+        if (p->count == cap) {
+            mem_proj_item_t *bigger = ps_alloc(ps, sizeof(mem_proj_item_t) * (size_t)cap * 2);
+            memcpy(bigger, p->items, sizeof(mem_proj_item_t) * (size_t)cap);
+            p->items = bigger;
+            cap *= 2;
+        }
+        mem_proj_item_t *it = &p->items[p->count++];
+        if (!parse_operand(ps, &it->expr)) return 0;
+
+        if (it->expr.kind == O_COL) snprintf(it->name, sizeof(it->name), "%s", it->expr.col);
+        else if (it->expr.kind == O_JSON) snprintf(it->name, sizeof(it->name), "%s", it->expr.key);
+        else snprintf(it->name, sizeof(it->name), "%s", "?column?");
+
+        if (accept_kw(ps, "as")) {
+            if (peek(ps)->type != TK_IDENT) {
+                ps->unsupported = 1;
+                return 0;
+            }
+            snprintf(it->name, sizeof(it->name), "%s", peek(ps)->text);
+            ps->pos++;
+        } else if (peek(ps)->type == TK_IDENT && !is_reserved(peek(ps)->text)) {
+            snprintf(it->name, sizeof(it->name), "%s", peek(ps)->text);
+            ps->pos++;
+        }
+    } while (accept_sym(ps, ","));
+    return 1;
+}
+
+static cJSON *project_row(const mem_proj_t *p, const cJSON *row) {
+    if (p->star) return cJSON_Duplicate(row, 1);
+
+    cJSON *out = cJSON_CreateObject();
+    for (int i = 0; i < p->count; i++) {
+        const mem_operand_t *e = &p->items[i].expr;
+        cJSON *v = NULL;
+        if (e->kind == O_COL && !e->arith) {
+            const cJSON *src = row_col(row, e->qual, e->col);
+            v = src ? cJSON_Duplicate(src, 1) : cJSON_CreateNull();
+        } else if (e->kind == O_LIT && !e->arith) {
+            v = cJSON_Duplicate(e->lit, 1);
+        } else {
+            mem_val_t val = eval_operand(e, row);
+            if (val.kind == V_NUM) v = cJSON_CreateNumber(val.num);
+            else if (val.kind == V_STR) v = cJSON_CreateString(val.str);
+            else v = cJSON_CreateNull();
+            val_release(&val);
+        }
+        cJSON_AddItemToObject(out, p->items[i].name, v);
+    }
+    return out;
+}
+
+//==============================================================================
+// TABLES
+//==============================================================================
+
+static mem_table_t *find_table(const char *name) {
+    for (int i = 0; i < MEM_TABLE_COUNT; i++) {
+        if (strcmp(g_tables[i].name, name) == 0) return &g_tables[i];
+    }
+    return NULL;
+}
+
+static int json_int(const cJSON *row, const char *col) {
+    const cJSON *v = cJSON_GetObjectItemCaseSensitive(row, col);
+    return cJSON_IsNumber(v) ? v->valueint : 0;
+}
+
+// Coerce a value to the column type, the way PG's input functions would
+static cJSON *coerce(char type, cJSON *v) {
+    if (!v || cJSON_IsNull(v)) return v;
+
+    switch (type) {
+        case 'j':
+            if (cJSON_IsString(v)) {
+                cJSON *parsed = cJSON_Parse(v->valuestring);
+                if (parsed) {
+                    cJSON_Delete(v);
+                    return parsed;
+                }
+            }
+            return v;
+        case 'i':
+            if (cJSON_IsString(v)) {
+                double n;
+                if (str_to_num(v->valuestring, &n)) {
+                    cJSON_Delete(v);
+                    return cJSON_CreateNumber((double)(long long)n);
+                }
+            } else if (cJSON_IsBool(v)) {
+                int b = cJSON_IsTrue(v);
+                cJSON_Delete(v);
+                return cJSON_CreateNumber(b);
+            } else if (cJSON_IsNumber(v)) {
+                // int columns truncate like the libpq path (atoi)
+                double n = (double)(long long)v->valuedouble;
+                cJSON_Delete(v);
+                return cJSON_CreateNumber(n);
+            }
+            return v;
+        case 'b':
+            if (cJSON_IsString(v)) {
+                int b = (strcmp(v->valuestring, "t") == 0 || strcasecmp(v->valuestring, "true") == 0);
+                cJSON_Delete(v);
+                return cJSON_CreateBool(b);
+            } else if (cJSON_IsNumber(v)) {
+                int b = (v->valuedouble != 0);
+                cJSON_Delete(v);
+                return cJSON_CreateBool(b);
+            }
+            return v;
+        case 't':
+        case 's':
+            if (cJSON_IsNumber(v)) {
+                char buf[32];
+                if (type == 't') format_ts((time_t)v->valuedouble, buf, sizeof(buf));
+                else snprintf(buf, sizeof(buf), "%.15g", v->valuedouble);
+                cJSON_Delete(v);
+                return cJSON_CreateString(buf);
+            } else if (cJSON_IsBool(v)) {
+                int b = cJSON_IsTrue(v);
+                cJSON_Delete(v);
+                return cJSON_CreateString(b ? "true" : "false");
+            }
+            return v;
+    }
+    return v;
+}
+
+static cJSON *default_value(const mem_col_t *col) {
+    if (!col->def) return cJSON_CreateNull();
+    if (strcmp(col->def, "now") == 0) {
+        char buf[32];
+        format_ts(time(NULL), buf, sizeof(buf));
+        return cJSON_CreateString(buf);
+    }
+    return coerce(col->type, cJSON_CreateString(col->def));
+}
+
+static cJSON *operand_value(const mem_operand_t *o, const cJSON *row) {
+    cJSON *v;
+    if (o->kind == O_LIT && !o->arith) {
+        v = cJSON_Duplicate(o->lit, 1);
+    } else if (o->kind == O_COL && !o->arith) {
+        const cJSON *src = row_col(row, o->qual, o->col);
+        v = src ? cJSON_Duplicate(src, 1) : cJSON_CreateNull();
+    } else {
+        mem_val_t val = eval_operand(o, row);
+        if (val.kind == V_NUM) v = cJSON_CreateNumber(val.num);
+        else if (val.kind == V_STR) v = cJSON_CreateString(val.str);
+        else v = cJSON_CreateNull();
+        val_release(&val);
+    }
+    return v;
+}
+
+static void row_set(const mem_table_t *t, cJSON *row, const char *col_name, cJSON *v) {
+    const mem_col_t *col = table_col(t->cols, t->ncols, col_name);
+    if (col) v = coerce(col->type, v);
+    if (cJSON_GetObjectItemCaseSensitive(row, col_name)) {
+        cJSON_ReplaceItemInObject(row, col_name, v);
+    } else {
+        cJSON_AddItemToObject(row, col_name, v);
+    }
+}
+
+static int values_equal(const cJSON *a, const cJSON *b) {
+    mem_val_t x = val_from_json(a);
+    mem_val_t y = val_from_json(b);
+    int cmp = 1;
+    int known = val_compare(&x, &y, 0, &cmp);
+    val_release(&x);
+    val_release(&y);
+    return known && cmp == 0;
+}
+
+// Row in t that collides with `row` on a unique key (NULLs never collide)
+static cJSON *find_conflict(const mem_table_t *t, const cJSON *row, const cJSON *skip) {
+    for (int k = 0; k < MEM_MAX_UNIQUE && t->unique[k][0]; k++) {
+        const cJSON *other;
+        cJSON_ArrayForEach(other, t->rows) {
+            if (other == skip) continue;
+            int same = 1;
+            for (int c = 0; t->unique[k][c] && same; c++) {
+                same = values_equal(cJSON_GetObjectItemCaseSensitive(row, t->unique[k][c]),
+                                    cJSON_GetObjectItemCaseSensitive(other, t->unique[k][c]));
+            }
+            if (same) return (cJSON *)other;
+        }
+    }
+    return NULL;
+}
+
+static cJSON *materialize_rooms_with_counts(void) {
+    mem_table_t *rooms = find_table("rooms");
+    mem_table_t *members = find_table("room_members");
+    cJSON *out = cJSON_CreateArray();
+
+    const cJSON *room;
+    cJSON_ArrayForEach(room, rooms->rows) {
+        cJSON *row = cJSON_CreateObject();
+        for (int i = 0; i < (int)(sizeof(c_rooms_with_counts) / sizeof(c_rooms_with_counts[0])) - 1; i++) {
+            const cJSON *v = cJSON_GetObjectItemCaseSensitive(room, c_rooms_with_counts[i].name);
+            cJSON_AddItemToObject(row, c_rooms_with_counts[i].name,
+                                  v ? cJSON_Duplicate(v, 1) : cJSON_CreateNull());
+        }
+        int id = json_int(room, "id");
+        int count = 0;
+        const cJSON *m;
+        cJSON_ArrayForEach(m, members->rows) {
+            if (json_int(m, "room_id") == id) count++;
+        }
+        cJSON_AddNumberToObject(row, "current_players", count);
+        cJSON_AddItemToArray(out, row);
+    }
+    return out;
+}
+
+//==============================================================================
+// BUILT-IN FUNCTIONS (Database/init/03_functions.sql)
+//==============================================================================
+
+static int delete_member(int room_id, int account_id) {
+    mem_table_t *members = find_table("room_members");
+    cJSON *m = members->rows->child;
+    while (m) {
+        cJSON *next = m->next;
+        if (json_int(m, "room_id") == room_id && json_int(m, "account_id") == account_id) {
+            cJSON_Delete(cJSON_DetachItemViaPointer(members->rows, m));
+            return 1;
+        }
+        m = next;
+    }
+    return 0;
+}
+
+static cJSON *call_builtin(const char *fn, const int *args, int nargs) {
+    cJSON *res = cJSON_CreateObject();
+
+    if ((strcmp(fn, "kick_member") == 0 || strcmp(fn, "leave_room") == 0) && nargs >= 2) {
+        int kick = (strcmp(fn, "kick_member") == 0);
+        if (delete_member(args[0], args[1])) {
+            cJSON_AddTrueToObject(res, "success");
+            cJSON_AddNumberToObject(res, "room_id", args[0]);
+            cJSON_AddNumberToObject(res, kick ? "kicked_account_id" : "account_id", args[1]);
+        } else {
+            cJSON_AddFalseToObject(res, "success");
+            cJSON_AddStringToObject(res, "error", kick ? "Member not found in room" : "Not a member of this room");
+        }
+        return res;
+    }
+
+    if (strcmp(fn, "close_room") == 0 && nargs >= 1) {
+        mem_table_t *rooms = find_table("rooms");
+        cJSON *room;
+        cJSON_ArrayForEach(room, rooms->rows) {
+            if (json_int(room, "id") != args[0]) continue;
+            char buf[32];
+            format_ts(time(NULL), buf, sizeof(buf));
+            row_set(rooms, room, "status", cJSON_CreateString("closed"));
+            row_set(rooms, room, "updated_at", cJSON_CreateString(buf));
+            cJSON_AddTrueToObject(res, "success");
+            cJSON_AddNumberToObject(res, "room_id", args[0]);
+            cJSON_AddStringToObject(res, "message", "Room closed successfully");
+            return res;
+        }
+        cJSON_AddFalseToObject(res, "success");
+        cJSON_AddStringToObject(res, "error", "Room not found");
+        return res;
+    }
+
+    cJSON_Delete(res);
+    return NULL;
+}
+
+//==============================================================================
+// STATEMENTS
+//==============================================================================
+
+typedef struct {
+    mem_operand_t expr;
+    int desc;
+} mem_order_t;
+
+typedef struct {
+    char table[MEM_NAME_LEN];
+    char alias[MEM_NAME_LEN];
+    mem_cond_t *on;
+} mem_join_t;
+
+typedef struct mem_select {
+    mem_proj_t proj;
+    char table[MEM_NAME_LEN];
+    char alias[MEM_NAME_LEN];
+    int is_func;
+    int args[8];
+    int nargs;
+    mem_join_t joins[MEM_MAX_JOIN];     // [INNER] JOIN t a ON ...
+    int njoins;
+    mem_cond_t *where;
+    mem_order_t order[MEM_MAX_ORDER];
+    int norder;
+    long limit;
+    long offset;
+} mem_select_t;
+
+static size_t select_size(void) {
+    return sizeof(mem_select_t);
+}
+
+typedef struct {
+    const mem_schema_t *schema;
+    const mem_order_t *order;
+    int norder;
+} mem_sort_ctx_t;
+
+static mem_sort_ctx_t g_sort;     // qsort has no context arg; used under g_mem_lock
+
+typedef struct {
+    const cJSON *row;
+    int idx;
+} mem_sort_item_t;
+
+static int cmp_rows(const void *pa, const void *pb) {
+    const mem_sort_item_t *a = pa;
+    const mem_sort_item_t *b = pb;
+    for (int i = 0; i < g_sort.norder; i++) {
+        mem_val_t x = eval_operand(&g_sort.order[i].expr, a->row);
+        mem_val_t y = eval_operand(&g_sort.order[i].expr, b->row);
+        int cmp = 0;
+        if (!val_compare(&x, &y, is_ts_operand(g_sort.schema, &g_sort.order[i].expr), &cmp)) {
+            // NULLS LAST for ASC, FIRST for DESC (PG default)
+            cmp = (x.kind == V_NULL) - (y.kind == V_NULL);
+        }
+        val_release(&x);
+        val_release(&y);
+        if (cmp) return g_sort.order[i].desc ? -cmp : cmp;
+    }
+    return a->idx - b->idx;
+}
+
+static void parse_tail(mem_ps_t *ps, mem_select_t *s) {
+    if (accept_kw(ps, "order")) {
+        if (!expect_kw(ps, "by")) return;
+        do {
+            if (s->norder == MEM_MAX_ORDER) {
+                ps->unsupported = 1;
+                return;
+            }
+            mem_order_t *o = &s->order[s->norder++];
+            if (!parse_operand(ps, &o->expr)) return;
+            if (accept_kw(ps, "desc")) o->desc = 1;
+            else accept_kw(ps, "asc");
+        } while (accept_sym(ps, ","));
+    }
+    for (;;) {
+        if (accept_kw(ps, "limit")) {
+            if (peek(ps)->type != TK_NUM) {
+                ps->unsupported = 1;
+                return;
+            }
+            s->limit = atol(peek(ps)->text);
+            ps->pos++;
+        } else if (accept_kw(ps, "offset")) {
+            if (peek(ps)->type != TK_NUM) {
+                ps->unsupported = 1;
+                return;
+            }
+            s->offset = atol(peek(ps)->text);
+            ps->pos++;
+        } else {
+            break;
+        }
+    }
+}
+
+static void parse_select_core(mem_ps_t *ps, mem_select_t *s) {
+    memset(s, 0, sizeof(*s));
+    s->limit = -1;
+
+    if (!expect_kw(ps, "select")) return;
+    if (tk_is_kw(peek(ps), "distinct")) {
+        ps->unsupported = 1;
+        return;
+    }
+    if (!parse_projection(ps, &s->proj)) return;
+    if (!expect_kw(ps, "from")) return;
+
+    mem_tk_t *t = peek(ps);
+    if (t->type != TK_IDENT) {
+        ps->unsupported = 1;
+        return;
+    }
+    ps->pos++;
+    snprintf(s->table, sizeof(s->table), "%s", t->text);
+
+    if (accept_sym(ps, "(")) {
+        s->is_func = 1;
+        if (strcmp(s->table, "close_room") != 0 && strcmp(s->table, "kick_member") != 0 &&
+            strcmp(s->table, "leave_room") != 0) {
+            ps->unsupported = 1;
+            return;
+        }
+        if (!accept_sym(ps, ")")) {
+            do {
+                mem_operand_t a;
+                if (!parse_operand(ps, &a) || !cJSON_IsNumber(a.lit) || s->nargs == 8) {
+                    ps->unsupported = 1;
+                    return;
+                }
+                s->args[s->nargs++] = a.lit->valueint;
+            } while (accept_sym(ps, ","));
+            if (!expect_sym(ps, ")")) return;
+        }
+    }
+
+    if (!s->is_func && !find_table(s->table) && strcmp(s->table, "rooms_with_counts") != 0) {
+        ps->unsupported = 1;
+        return;
+    }
+    parse_alias(ps, s->alias, s->table);
+
+    while (tk_is_kw(peek(ps), "join") || tk_is_kw(peek(ps), "inner")) {
+        accept_kw(ps, "inner");
+        if (!expect_kw(ps, "join")) return;
+        if (s->njoins == MEM_MAX_JOIN || !find_table(s->table)) {
+            ps->unsupported = 1;
+            return;
+        }
+        mem_join_t *j = &s->joins[s->njoins++];
+        if (!parse_ident(ps, j->table)) return;
+        if (!find_table(j->table)) {
+            ps->unsupported = 1;
+            return;
+        }
+        parse_alias(ps, j->alias, j->table);
+        if (!expect_kw(ps, "on")) return;
+        j->on = parse_or(ps);
+        if (ps->unsupported) return;
+    }
+
+    if (accept_kw(ps, "where")) {
+        s->where = parse_or(ps);
+        if (ps->unsupported) return;
+    }
+    parse_tail(ps, s);
+}
+
+// Nested loops over the joined tables with each level's row in g_frame;
+// WHERE is checked at the innermost level. Matches come out as rows keyed
+// "alias.col", plus the bare col from the first table that has it.
+static void join_level(const mem_select_t *s, const mem_schema_t *schema, int level, cJSON *out) {
+    const mem_table_t *t = find_table(level == 0 ? s->table : s->joins[level - 1].table);
+    const char *alias = (level == 0) ? s->alias : s->joins[level - 1].alias;
+    const mem_cond_t *on = (level == 0) ? NULL : s->joins[level - 1].on;
+
+    const cJSON *row;
+    cJSON_ArrayForEach(row, t->rows) {
+        g_frame[level].alias = alias;
+        g_frame[level].row = row;
+        g_frame_count = level + 1;
+        if (!cond_eval(schema, on, NULL)) continue;
+        if (level < s->njoins) {
+            join_level(s, schema, level + 1, out);
+            continue;
+        }
+        if (!cond_eval(schema, s->where, NULL)) continue;
+
+        cJSON *merged = cJSON_CreateObject();
+        for (int f = 0; f <= level; f++) {
+            const cJSON *col;
+            cJSON_ArrayForEach(col, g_frame[f].row) {
+                char key[MEM_NAME_LEN * 2 + 2];
+                snprintf(key, sizeof(key), "%s.%s", g_frame[f].alias, col->string);
+                cJSON_AddItemToObject(merged, key, cJSON_Duplicate(col, 1));
+                if (!cJSON_GetObjectItemCaseSensitive(merged, col->string)) {
+                    cJSON_AddItemToObject(merged, col->string, cJSON_Duplicate(col, 1));
+                }
+            }
+        }
+        cJSON_AddItemToArray(out, merged);
+    }
+}
+
+static cJSON *materialize_join(mem_ps_t *ps, const mem_select_t *s, mem_schema_t *schema) {
+    // Column types of all tables, for timestamp comparisons
+    int ncols = 0;
+    for (int i = 0; i <= s->njoins; i++) {
+        ncols += find_table(i == 0 ? s->table : s->joins[i - 1].table)->ncols;
+    }
+    mem_col_t *cols = ps_alloc(ps, sizeof(mem_col_t) * (size_t)ncols);
+    ncols = 0;
+    for (int i = 0; i <= s->njoins; i++) {
+        const mem_table_t *t = find_table(i == 0 ? s->table : s->joins[i - 1].table);
+        memcpy(cols + ncols, t->cols, sizeof(mem_col_t) * (size_t)t->ncols);
+        ncols += t->ncols;
+    }
+    schema->cols = cols;
+    schema->ncols = ncols;
+
+    cJSON *out = cJSON_CreateArray();
+    join_level(s, schema, 0, out);
+    g_frame_count = 0;
+    return out;
+}
+
+static int exists_eval(const mem_select_t *s) {
+    const mem_table_t *t = find_table(s->table);
+    if (!t) return 0;
+
+    // Uncorrelated: the outer row is not in scope
+    int saved = g_frame_count;
+    g_frame_count = 0;
+    mem_schema_t schema = { t->cols, t->ncols };
+    int found = 0;
+    const cJSON *row;
+    cJSON_ArrayForEach(row, t->rows) {
+        if (cond_eval(&schema, s->where, row)) {
+            found = 1;
+            break;
+        }
+    }
+    g_frame_count = saved;
+    return found;
+}
+
+// Run one SELECT core; returns projected rows (new array)
+static cJSON *run_select(mem_ps_t *ps, const mem_select_t *s, const mem_order_t *order,
+                         int norder, long limit, long offset) {
+    if (s->is_func) {
+        cJSON *res = call_builtin(s->table, s->args, s->nargs);
+        if (!res) {
+            ps->unsupported = 1;
+            return NULL;
+        }
+        cJSON *row = cJSON_CreateObject();
+        cJSON_AddItemToObject(row, s->table, res);
+        cJSON *out = cJSON_CreateArray();
+        cJSON_AddItemToArray(out, project_row(&s->proj, row));
+        cJSON_Delete(row);
+        return out;
+    }
+
+    mem_schema_t schema;
+    const cJSON *rows;
+    const mem_cond_t *where = s->where;
+    cJSON *view = NULL;
+    mem_table_t *t = find_table(s->table);
+
+    if (s->njoins > 0) {
+        view = materialize_join(ps, s, &schema);
+        rows = view;
+        where = NULL;
+    } else if (t) {
+        schema.cols = t->cols;
+        schema.ncols = t->ncols;
+        rows = t->rows;
+    } else if (strcmp(s->table, "rooms_with_counts") == 0) {
+        schema.cols = c_rooms_with_counts;
+        schema.ncols = (int)(sizeof(c_rooms_with_counts) / sizeof(c_rooms_with_counts[0]));
+        view = materialize_rooms_with_counts();
+        rows = view;
+    } else {
+        ps->unsupported = 1;
+        return NULL;
+    }
+
+    int cap = cJSON_GetArraySize(rows);
+    mem_sort_item_t *hits = malloc(sizeof(mem_sort_item_t) * (size_t)(cap > 0 ? cap : 1));
+    int n = 0;
+    const cJSON *row;
+    cJSON_ArrayForEach(row, rows) {
+        if (cond_eval(&schema, where, row)) {
+            hits[n].row = row;
+            hits[n].idx = n;
+            n++;
+        }
+    }
+
+    if (norder > 0 && n > 1) {
+        g_sort.schema = &schema;
+        g_sort.order = order;
+        g_sort.norder = norder;
+        qsort(hits, (size_t)n, sizeof(mem_sort_item_t), cmp_rows);
+    }
+
+    cJSON *out = cJSON_CreateArray();
+    long emitted = 0;
+    for (long i = offset; i < n && (limit < 0 || emitted < limit); i++, emitted++) {
+        cJSON_AddItemToArray(out, project_row(&s->proj, hits[i].row));
+    }
+
+    free(hits);
+    cJSON_Delete(view);
+    return out;
+}
+
+// Rename columns positionally to the first branch's names (UNION semantics)
+static cJSON *rename_like(const cJSON *row, const cJSON *model) {
+    if (!model) return cJSON_Duplicate(row, 1);
+    cJSON *out = cJSON_CreateObject();
+    const cJSON *src = row->child;
+    const cJSON *name = model->child;
+    for (; src; src = src->next) {
+        const char *col = name ? name->string : src->string;
+        cJSON_AddItemToObject(out, col, cJSON_Duplicate(src, 1));
+        if (name) name = name->next;
+    }
+    return out;
+}
+
+static int row_in(const cJSON *rows, const cJSON *row) {
+    char *needle = cJSON_PrintUnformatted(row);
+    int found = 0;
+    const cJSON *r;
+    cJSON_ArrayForEach(r, rows) {
+        char *s = cJSON_PrintUnformatted(r);
+        found = (s && needle && strcmp(s, needle) == 0);
+        free(s);
+        if (found) break;
+    }
+    free(needle);
+    return found;
+}
+
+static cJSON *exec_select(mem_ps_t *ps) {
+    mem_select_t cores[MEM_MAX_UNION];
+    int union_all[MEM_MAX_UNION] = {0};
+    int ncores = 0;
+
+    parse_select_core(ps, &cores[ncores++]);
+    while (!ps->unsupported && accept_kw(ps, "union")) {
+        if (ncores == MEM_MAX_UNION) {
+            ps->unsupported = 1;
+            break;
+        }
+        union_all[ncores] = accept_kw(ps, "all");
+        parse_select_core(ps, &cores[ncores++]);
+    }
+    if (ps->unsupported || peek(ps)->type != TK_END) {
+        ps->unsupported = 1;
+        return NULL;
+    }
+    if (ps->dry) return NULL;
+
+    if (ncores == 1) {
+        const mem_select_t *s = &cores[0];
+        return run_select(ps, s, s->order, s->norder, s->limit, s->offset);
+    }
+
+    // ORDER BY / LIMIT after the last branch apply to the whole UNION
+    mem_select_t *last = &cores[ncores - 1];
+    cJSON *all = cJSON_CreateArray();
+    for (int i = 0; i < ncores; i++) {
+        cJSON *part = run_select(ps, &cores[i], NULL, 0, -1, 0);
+        if (!part) {
+            cJSON_Delete(all);
+            return NULL;
+        }
+        const cJSON *row;
+        cJSON_ArrayForEach(row, part) {
+            cJSON *renamed = rename_like(row, all->child);
+            if (i > 0 && !union_all[i] && row_in(all, renamed)) {
+                cJSON_Delete(renamed);
+                continue;
+            }
+            cJSON_AddItemToArray(all, renamed);
+        }
+        cJSON_Delete(part);
+    }
+
+    if (last->norder == 0 && last->limit < 0 && last->offset == 0) return all;
+
+    mem_table_t *t = find_table(cores[0].table);
+    mem_schema_t schema = { t ? t->cols : NULL, t ? t->ncols : 0 };
+    int n = cJSON_GetArraySize(all);
+    mem_sort_item_t *items = malloc(sizeof(mem_sort_item_t) * (size_t)(n > 0 ? n : 1));
+    int i = 0;
+    const cJSON *row;
+    cJSON_ArrayForEach(row, all) {
+        items[i].row = row;
+        items[i].idx = i;
+        i++;
+    }
+    if (last->norder > 0 && n > 1) {
+        g_sort.schema = &schema;
+        g_sort.order = last->order;
+        g_sort.norder = last->norder;
+        qsort(items, (size_t)n, sizeof(mem_sort_item_t), cmp_rows);
+    }
+    cJSON *out = cJSON_CreateArray();
+    long emitted = 0;
+    for (long k = last->offset; k < n && (last->limit < 0 || emitted < last->limit); k++, emitted++) {
+        cJSON_AddItemToArray(out, cJSON_Duplicate(items[k].row, 1));
+    }
+    free(items);
+    cJSON_Delete(all);
+    return out;
+}
+
+typedef struct {
+    char col[MEM_NAME_LEN];
+    mem_operand_t val;
+} mem_assign_t;
+
+static int parse_assignments(mem_ps_t *ps, mem_assign_t **out, int *count) {
+    int cap = 8;
+    *out = ps_alloc(ps, sizeof(mem_assign_t) * (size_t)cap);
+    *count = 0;
+    do {
+        if (*count == cap) {
+            mem_assign_t *bigger = ps_alloc(ps, sizeof(mem_assign_t) * (size_t)cap * 2);
+            memcpy(bigger, *out, sizeof(mem_assign_t) * (size_t)cap);
+            *out = bigger;
+            cap *= 2;
+        }
+        mem_assign_t *a = &(*out)[(*count)++];
+        if (!parse_ident(ps, a->col)) return 0;
+        if (!expect_sym(ps, "=")) return 0;
+        if (!parse_operand(ps, &a->val)) return 0;
+    } while (accept_sym(ps, ","));
+    return 1;
+}
+
+static void apply_assignments(mem_table_t *t, cJSON *row, const mem_assign_t *as, int n) {
+    // Evaluate against the old row first (SET a = b, b = a semantics)
+    cJSON **vals = malloc(sizeof(cJSON *) * (size_t)(n > 0 ? n : 1));
+    for (int i = 0; i < n; i++) vals[i] = operand_value(&as[i].val, row);
+    for (int i = 0; i < n; i++) row_set(t, row, as[i].col, vals[i]);
+    free(vals);
+}
+
+static int parse_returning(mem_ps_t *ps, mem_proj_t *ret, int *has_ret) {
+    *has_ret = 0;
+    if (accept_kw(ps, "returning")) {
+        *has_ret = 1;
+        if (!parse_projection(ps, ret)) return 0;
+    }
+    if (peek(ps)->type != TK_END) {
+        ps->unsupported = 1;
+        return 0;
+    }
+    return 1;
+}
+
+static db_error_t exec_insert(mem_ps_t *ps, cJSON **out, int *rows) {
+    char table[MEM_NAME_LEN];
+    if (!expect_kw(ps, "into") || !parse_ident(ps, table)) return DB_OK;
+
+    mem_table_t *t = find_table(table);
+    if (!t) {
+        ps->unsupported = 1;
+        return DB_OK;
+    }
+
+    char cols[32][MEM_NAME_LEN];
+    int ncols = 0;
+    if (!expect_sym(ps, "(")) return DB_OK;
+    do {
+        if (ncols == 32 || !parse_ident(ps, cols[ncols])) {
+            ps->unsupported = 1;
+            return DB_OK;
+        }
+        ncols++;
+    } while (accept_sym(ps, ","));
+    if (!expect_sym(ps, ")") || !expect_kw(ps, "values")) return DB_OK;
+
+    // Rows are built first so a parse error leaves the table untouched
+    cJSON *pending = ps_json(ps, cJSON_CreateArray());
+    do {
+        if (!expect_sym(ps, "(")) return DB_OK;
+        cJSON *row = cJSON_CreateObject();
+        cJSON_AddItemToArray(pending, row);
+        for (int i = 0; i < t->ncols; i++) {
+            cJSON_AddItemToObject(row, t->cols[i].name, default_value(&t->cols[i]));
+        }
+        for (int c = 0; c < ncols; c++) {
+            if (c > 0 && !expect_sym(ps, ",")) return DB_OK;
+            mem_operand_t v;
+            if (!parse_operand(ps, &v)) return DB_OK;
+            row_set(t, row, cols[c], operand_value(&v, NULL));
+        }
+        if (!expect_sym(ps, ")")) return DB_OK;
+    } while (accept_sym(ps, ","));
+
+    int on_conflict = 0;        // 0 = error, 1 = do nothing, 2 = do update
+    mem_assign_t *upd = NULL;
+    int nupd = 0;
+    if (accept_kw(ps, "on")) {
+        if (!expect_kw(ps, "conflict")) return DB_OK;
+        if (accept_sym(ps, "(")) {
+            while (!accept_sym(ps, ")") && peek(ps)->type != TK_END) ps->pos++;
+        }
+        if (!expect_kw(ps, "do")) return DB_OK;
+        if (accept_kw(ps, "nothing")) {
+            on_conflict = 1;
+        } else if (accept_kw(ps, "update") && expect_kw(ps, "set")) {
+            on_conflict = 2;
+            if (!parse_assignments(ps, &upd, &nupd)) return DB_OK;
+        } else {
+            ps->unsupported = 1;
+            return DB_OK;
+        }
+    }
+
+    mem_proj_t ret;
+    int has_ret;
+    if (!parse_returning(ps, &ret, &has_ret) || ps->dry) return DB_OK;
+
+    // Conflicts are checked up front: a failed INSERT changes nothing
+    if (on_conflict == 0) {
+        const cJSON *row;
+        cJSON_ArrayForEach(row, pending) {
+            if (find_conflict(t, row, NULL)) {
+                fprintf(stderr, "[DB_MEM] duplicate key value violates unique constraint on %s\n", t->name);
+                return DB_ERR_HTTP;
+            }
+        }
+    }
+
+    cJSON *result = cJSON_CreateArray();
+    int affected = 0;
+    while (pending->child) {
+        cJSON *row = cJSON_DetachItemViaPointer(pending, pending->child);
+
+        cJSON *existing = find_conflict(t, row, NULL);
+        if (existing) {
+            if (on_conflict == 2) {
+                apply_assignments(t, existing, upd, nupd);
+                if (has_ret) cJSON_AddItemToArray(result, project_row(&ret, existing));
+                affected++;
+            }
+            cJSON_Delete(row);
+            continue;
+        }
+
+        if (t->serial) {
+            const cJSON *id = cJSON_GetObjectItemCaseSensitive(row, "id");
+            if (cJSON_IsNumber(id)) {
+                if (id->valueint > t->next_id) t->next_id = id->valueint;
+            } else {
+                row_set(t, row, "id", cJSON_CreateNumber(++t->next_id));
+            }
+        }
+        cJSON_AddItemToArray(t->rows, row);
+        if (has_ret) cJSON_AddItemToArray(result, project_row(&ret, row));
+        affected++;
+    }
+
+    *rows = affected;
+    if (out) *out = result;
+    else cJSON_Delete(result);
+    return DB_OK;
+}
+
+// FROM (VALUES (...), ...) [AS] v(c1, c2, ...) -> rows keyed by the column list
+static cJSON *parse_values_from(mem_ps_t *ps, char *alias) {
+    if (!expect_sym(ps, "(") || !expect_kw(ps, "values")) return NULL;
+
+    cJSON *tuples = ps_json(ps, cJSON_CreateArray());
+    do {
+        if (!expect_sym(ps, "(")) return NULL;
+        cJSON *tuple = cJSON_CreateArray();
+        cJSON_AddItemToArray(tuples, tuple);
+        do {
+            mem_operand_t v;
+            if (!parse_operand(ps, &v)) return NULL;
+            cJSON_AddItemToArray(tuple, operand_value(&v, NULL));
+        } while (accept_sym(ps, ","));
+        if (!expect_sym(ps, ")")) return NULL;
+    } while (accept_sym(ps, ","));
+    if (!expect_sym(ps, ")")) return NULL;
+
+    accept_kw(ps, "as");
+    if (!parse_ident(ps, alias) || !expect_sym(ps, "(")) return NULL;
+    char names[16][MEM_NAME_LEN];
+    int nnames = 0;
+    do {
+        if (nnames == 16 || !parse_ident(ps, names[nnames])) {
+            ps->unsupported = 1;
+            return NULL;
+        }
+        nnames++;
+    } while (accept_sym(ps, ","));
+    if (!expect_sym(ps, ")")) return NULL;
+
+    cJSON *rows = ps_json(ps, cJSON_CreateArray());
+    const cJSON *tuple;
+    cJSON_ArrayForEach(tuple, tuples) {
+        if (cJSON_GetArraySize(tuple) != nnames) {
+            ps->unsupported = 1;
+            return NULL;
+        }
+        cJSON *row = cJSON_CreateObject();
+        int i = 0;
+        const cJSON *v;
+        cJSON_ArrayForEach(v, tuple) {
+            cJSON_AddItemToObject(row, names[i++], cJSON_Duplicate(v, 1));
+        }
+        cJSON_AddItemToArray(rows, row);
+    }
+    return rows;
+}
+
+static db_error_t exec_update(mem_ps_t *ps, cJSON **out, int *rows) {
+    char table[MEM_NAME_LEN];
+    if (!parse_ident(ps, table)) return DB_OK;
+
+    mem_table_t *t = find_table(table);
+    if (!t) {
+        ps->unsupported = 1;
+        return DB_OK;
+    }
+    char alias[MEM_NAME_LEN];
+    parse_alias(ps, alias, table);
+    if (!expect_kw(ps, "set")) return DB_OK;
+
+    mem_assign_t *as = NULL;
+    int nas = 0;
+    if (!parse_assignments(ps, &as, &nas)) return DB_OK;
+
+    char from_alias[MEM_NAME_LEN] = "";
+    cJSON *from = NULL;
+    if (accept_kw(ps, "from")) {
+        from = parse_values_from(ps, from_alias);
+        if (!from) return DB_OK;
+    }
+
+    mem_cond_t *where = NULL;
+    if (accept_kw(ps, "where")) {
+        where = parse_or(ps);
+        if (ps->unsupported) return DB_OK;
+    }
+
+    mem_proj_t ret;
+    int has_ret;
+    if (!parse_returning(ps, &ret, &has_ret) || ps->dry) return DB_OK;
+
+    // The target row is frame 0, the matching VALUES row (if any) frame 1;
+    // like PG, a target row is updated once even if several rows match
+    mem_schema_t schema = { t->cols, t->ncols };
+    cJSON *result = cJSON_CreateArray();
+    int affected = 0;
+    cJSON *row;
+    cJSON_ArrayForEach(row, t->rows) {
+        g_frame[0].alias = alias;
+        g_frame[0].row = row;
+        g_frame_count = 1;
+
+        int hit = 0;
+        if (from) {
+            const cJSON *vrow;
+            cJSON_ArrayForEach(vrow, from) {
+                g_frame[1].alias = from_alias;
+                g_frame[1].row = vrow;
+                g_frame_count = 2;
+                if (cond_eval(&schema, where, row)) {
+                    hit = 1;
+                    break;
+                }
+            }
+        } else {
+            hit = cond_eval(&schema, where, row);
+        }
+        if (!hit) continue;
+
+        apply_assignments(t, row, as, nas);
+        if (has_ret) cJSON_AddItemToArray(result, project_row(&ret, row));
+        affected++;
+    }
+    g_frame_count = 0;
+
+    *rows = affected;
+    if (out) *out = result;
+    else cJSON_Delete(result);
+    return DB_OK;
+}
+
+static db_error_t exec_delete(mem_ps_t *ps, cJSON **out, int *rows) {
+    char table[MEM_NAME_LEN];
+    if (!expect_kw(ps, "from") || !parse_ident(ps, table)) return DB_OK;
+
+    mem_table_t *t = find_table(table);
+    if (!t) {
+        ps->unsupported = 1;
+        return DB_OK;
+    }
+
+    mem_cond_t *where = NULL;
+    if (accept_kw(ps, "where")) {
+        where = parse_or(ps);
+        if (ps->unsupported) return DB_OK;
+    }
+
+    mem_proj_t ret;
+    int has_ret;
+    if (!parse_returning(ps, &ret, &has_ret) || ps->dry) return DB_OK;
+
+    mem_schema_t schema = { t->cols, t->ncols };
+    cJSON *result = cJSON_CreateArray();
+    int affected = 0;
+    cJSON *row = t->rows->child;
+    while (row) {
+        cJSON *next = row->next;
+        if (cond_eval(&schema, where, row)) {
+            if (has_ret) cJSON_AddItemToArray(result, project_row(&ret, row));
+            cJSON_Delete(cJSON_DetachItemViaPointer(t->rows, row));
+            affected++;
+        }
+        row = next;
+    }
+
+    *rows = affected;
+    if (out) *out = result;
+    else cJSON_Delete(result);
+    return DB_OK;
+}
+
+static void warn_unsupported(const char *stmt, const char *sql) {
+    for (int i = 0; i < g_warned_count; i++) {
+        if (strcmp(g_warned[i], stmt) == 0) return;
+    }
+    if (g_warned_count < MEM_MAX_WARNED) {
+        snprintf(g_warned[g_warned_count++], DB_STATS_NAME_LEN, "%s", stmt);
+    }
+    printf("[DB_MEM] Unsupported statement (%s) rejected: %.200s%s\n",
+           stmt, sql, strlen(sql) > 200 ? "..." : "");
+}
+
+// One statement (tokens [begin, end)); caller holds g_mem_lock.
+// dry: parse only, nothing is read or written.
+static db_error_t exec_one(mem_tk_t *t, int n, int dry, cJSON **out, int *rows, int *unsupported) {
+    mem_ps_t ps;
+    memset(&ps, 0, sizeof(ps));
+    ps.t = t;
+    ps.n = n;
+    ps.dry = dry;
+
+    db_error_t err = DB_OK;
+    cJSON *result = NULL;
+    *rows = 0;
+
+    if (tk_is_kw(peek(&ps), "select")) {
+        result = exec_select(&ps);
+        if (result) *rows = cJSON_GetArraySize(result);
+    } else if (accept_kw(&ps, "insert")) {
+        err = exec_insert(&ps, &result, rows);
+    } else if (accept_kw(&ps, "update")) {
+        err = exec_update(&ps, &result, rows);
+    } else if (accept_kw(&ps, "delete")) {
+        err = exec_delete(&ps, &result, rows);
+    } else {
+        ps.unsupported = 1;
+    }
+
+    if (ps.unsupported) {
+        cJSON_Delete(result);
+        result = NULL;
+        *rows = 0;
+        *unsupported = 1;
+        err = DB_ERROR_NOT_IMPLEMENTED;
+    }
+    ps_free(&ps);
+
+    if (err == DB_OK && out) {
+        *out = result ? result : cJSON_CreateArray();
+    } else {
+        cJSON_Delete(result);
+    }
+    return err;
+}
+
+// Statements of a script, one pass; stops at the first error unless keep_going
+static db_error_t run_statements(mem_tklist_t *tl, int dry, int keep_going,
+                                 cJSON **last, int *rows, int *unsupported) {
+    db_error_t first = DB_OK;
+    int start = 0;
+    for (int i = 0; i <= tl->n; i++) {
+        if (i < tl->n && !tk_is_sym(&tl->v[i], ";")) continue;
+        if (i > start) {
+            if (last) {
+                cJSON_Delete(*last);
+                *last = NULL;
+            }
+            db_error_t err = exec_one(&tl->v[start], i - start, dry, last, rows, unsupported);
+            if (err != DB_OK && first == DB_OK) first = err;
+            if (err != DB_OK && !keep_going) break;
+        }
+        start = i + 1;
+    }
+    return first;
+}
+
+/* Multi-statement strings run in order; like PQexec, the last result wins.
+ * atomic: every statement is parsed before the first one runs, so a
+ * statement this backend cannot run fails the script with nothing applied
+ * (the seed is loaded non-atomic and skips what it cannot run). */
+static db_error_t exec_script(const char *sql, int atomic, cJSON **out, int *rows, int *unsupported) {
+    mem_tklist_t tl = {0};
+    if (!lex(sql, &tl)) {
+        tk_free(&tl);
+        *unsupported = 1;
+        return DB_ERROR_NOT_IMPLEMENTED;
+    }
+
+    int nstmt = 0;
+    for (int i = 0; i < tl.n; i++) {
+        int ends = (i + 1 == tl.n) || tk_is_sym(&tl.v[i + 1], ";");
+        if (!tk_is_sym(&tl.v[i], ";") && ends) nstmt++;
+    }
+
+    db_error_t err = DB_OK;
+    if (atomic && nstmt > 1) err = run_statements(&tl, 1, 0, NULL, rows, unsupported);
+
+    cJSON *last = NULL;
+    if (err == DB_OK) err = run_statements(&tl, 0, !atomic, out ? &last : NULL, rows, unsupported);
+
+    if (out && err == DB_OK) *out = last ? last : cJSON_CreateArray();
+    else cJSON_Delete(last);
+    tk_free(&tl);
+    return err;
+}
+
+//==============================================================================
+// SEED
+//==============================================================================
+
+static char *read_file(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *buf = malloc((size_t)size + 1);
+    if (buf && fread(buf, 1, (size_t)size, f) != (size_t)size) {
+        free(buf);
+        buf = NULL;
+    }
+    if (buf) buf[size] = '\0';
+    fclose(f);
+    return buf;
+}
+
+static void load_seed(void) {
+    const char *path = getenv(ENV_DB_MEM_SEED);
+    if (!path || !*path) path = DB_MEM_SEED_DEFAULT;
+
+    char *sql = read_file(path);
+    if (!sql) {
+        printf("[DB_MEM] Seed file %s not found, starting empty\n", path);
+        return;
+    }
+
+    int rows = 0;
+    int unsupported = 0;
+    db_error_t err = exec_script(sql, 0, NULL, &rows, &unsupported);
+    free(sql);
+
+    if (err != DB_OK || unsupported) {
+        printf("[DB_MEM] Warning: seed %s partially applied (err=%d)\n", path, err);
+    }
+    for (int i = 0; i < MEM_TABLE_COUNT; i++) {
+        int n = cJSON_GetArraySize(g_tables[i].rows);
+        if (n > 0) printf("[DB_MEM] Seeded %s: %d rows\n", g_tables[i].name, n);
+    }
+}
+
+//==============================================================================
+// BACKEND
+//==============================================================================
+
+static db_error_t mem_init(void) {
+    pthread_mutex_lock(&g_mem_lock);
+    for (int i = 0; i < MEM_TABLE_COUNT; i++) {
+        cJSON_Delete(g_tables[i].rows);
+        g_tables[i].rows = cJSON_CreateArray();
+        g_tables[i].next_id = 0;
+    }
+    g_warned_count = 0;
+    load_seed();
+    g_mem_ready = 1;
+    pthread_mutex_unlock(&g_mem_lock);
+
+    printf("[DB_MEM] In-memory database ready\n");
+    return DB_OK;
+}
+
+static void mem_cleanup(void) {
+    pthread_mutex_lock(&g_mem_lock);
+    for (int i = 0; i < MEM_TABLE_COUNT; i++) {
+        cJSON_Delete(g_tables[i].rows);
+        g_tables[i].rows = NULL;
+    }
+    g_mem_ready = 0;
+    pthread_mutex_unlock(&g_mem_lock);
+}
+
+static db_error_t mem_exec(const char *stmt, const char *sql, cJSON **out_json, int *out_rows) {
+    *out_rows = 0;
+    if (!sql) return DB_ERR_INVALID_ARG;
+
+    pthread_mutex_lock(&g_mem_lock);
+    if (!g_mem_ready) {
+        pthread_mutex_unlock(&g_mem_lock);
+        return DB_ERR_UNAVAILABLE;
+    }
+
+    int unsupported = 0;
+    db_error_t err = exec_script(sql, 1, out_json, out_rows, &unsupported);
+    if (unsupported) warn_unsupported(stmt, sql);
+    pthread_mutex_unlock(&g_mem_lock);
+    return err;
+}
+
+static bool mem_is_available(void) {
+    return atomic_load(&g_mem_ready) != 0;
+}
+
+static int mem_ping(void) {
+    printf("[DB] ping OK (memory)\n");
+    return 0;
+}
+
+const db_backend_t db_backend_mem = {
+    .name = "memory",
+    .init = mem_init,
+    .cleanup = mem_cleanup,
+    .exec = mem_exec,
+    .is_available = mem_is_available,
+    .ping = mem_ping,
+    .on_reconnect = NULL,
+};
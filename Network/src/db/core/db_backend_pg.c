@@ -0,0 +1,351 @@
+#include "db/core/db_backend.h"
+#include "db/core/db_config.h"
+#include <libpq-fe.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <cjson/cJSON.h>
+#include <pthread.h>
+#include <time.h>
+#include <stdatomic.h>
+
+/*
+ * PostgreSQL backend (libpq)
+ */
+
+static PGconn *g_db_conn = NULL;
+
+// One libpq connection is shared by the event loop, round timers and the
+// match write queue worker; libpq requires callers to serialize its use.
+static pthread_mutex_t g_db_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Circuit breaker: g_db_conn == NULL means open (fail fast); the reconnect
+// thread is the half-open probe and closes it by installing a new conn.
+// g_db_up mirrors it for readers that must not wait on g_db_lock, which
+// is held for the whole PQexec of the statement in progress.
+static atomic_bool g_db_up = false;
+static char g_conninfo[DB_MAX_CONN_STRING];
+static pthread_t g_reconnect_thread;
+static int g_reconnect_joinable = 0;
+static int g_reconnecting = 0;
+static int g_shutting_down = 0;
+static time_t g_down_since = 0;
+static pthread_cond_t g_reconnect_cond = PTHREAD_COND_INITIALIZER;
+static db_reconnect_cb g_on_reconnect = NULL;
+
+/* ===============================
+ * Connection management
+ * =============================== */
+static PGconn *open_connection(void) {
+    PGconn *conn = PQconnectdb(g_conninfo);
+    if (PQstatus(conn) != CONNECTION_OK) {
+        fprintf(stderr, "[DB_CLIENT] Connection failed: %s\n",
+                PQerrorMessage(conn));
+        PQfinish(conn);
+        return NULL;
+    }
+    return conn;
+}
+
+static void *reconnect_thread(void *arg) {
+    (void)arg;
+    int backoff_ms = DB_RECONNECT_BASE_MS;
+
+    pthread_mutex_lock(&g_db_lock);
+    while (!g_shutting_down) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += backoff_ms / 1000;
+        deadline.tv_nsec += (long)(backoff_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&g_reconnect_cond, &g_db_lock, &deadline);
+        if (g_shutting_down) break;
+
+        // Connect without holding the lock: callers keep failing fast
+        pthread_mutex_unlock(&g_db_lock);
+        PGconn *conn = open_connection();
+        pthread_mutex_lock(&g_db_lock);
+
+        if (conn) {
+            if (g_shutting_down) {
+                PQfinish(conn);
+                break;
+            }
+            g_db_conn = conn;
+            atomic_store(&g_db_up, true);
+            printf("[DB_CLIENT] Reconnected after %lds\n", (long)(time(NULL) - g_down_since));
+            db_reconnect_cb cb = g_on_reconnect;
+            pthread_mutex_unlock(&g_db_lock);
+            if (cb) cb();
+            pthread_mutex_lock(&g_db_lock);
+
+            // Lost again inside the callback (mark_down skipped: we're still
+            // the reconnect thread), so keep going from here
+            if (g_db_conn || g_shutting_down) break;
+            backoff_ms = DB_RECONNECT_BASE_MS;
+            continue;
+        }
+
+        backoff_ms *= 2;
+        if (backoff_ms > DB_RECONNECT_MAX_MS) backoff_ms = DB_RECONNECT_MAX_MS;
+        printf("[DB_CLIENT] Still down, next attempt in %dms\n", backoff_ms);
+    }
+    g_reconnecting = 0;
+    pthread_mutex_unlock(&g_db_lock);
+    return NULL;
+}
+
+// Open the circuit and start the reconnect thread (caller holds g_db_lock)
+static void mark_down_locked(const char *why) {
+    atomic_store(&g_db_up, false);
+    if (g_db_conn) {
+        PQfinish(g_db_conn);
+        g_db_conn = NULL;
+    }
+    if (g_reconnecting || g_shutting_down) return;
+
+    g_down_since = time(NULL);
+    fprintf(stderr, "[DB_CLIENT] Connection lost (%s), entering degraded mode\n", why);
+
+    // Reap the previous reconnect thread (it has already finished)
+    if (g_reconnect_joinable) pthread_join(g_reconnect_thread, NULL);
+
+    g_reconnecting = 1;
+    g_reconnect_joinable = (pthread_create(&g_reconnect_thread, NULL, reconnect_thread, NULL) == 0);
+    if (!g_reconnect_joinable) {
+        fprintf(stderr, "[DB_CLIENT] Failed to start reconnect thread\n");
+        g_reconnecting = 0;
+    }
+}
+
+/* ===============================
+ * Init / Cleanup
+ * =============================== */
+static db_error_t pg_init(void) {
+    const char *host = getenv(ENV_DB_HOST);
+    const char *port = getenv(ENV_DB_PORT);
+    const char *dbname = getenv(ENV_DB_NAME);
+    const char *user = getenv(ENV_DB_USER);
+    const char *password = getenv(ENV_DB_PASSWORD);
+
+    // Default values if not set
+    if (!host) host = "localhost";
+    if (!port) port = "5432";
+    if (!dbname) dbname = "tpir";
+    if (!user) user = "postgresql";
+    if (!password) password = "password";
+
+    printf("[DB_CLIENT] Init: host=%s, port=%s, dbname=%s, user=%s\n",
+           host, port, dbname, user);
+
+    const char *timeout = getenv(ENV_DB_STATEMENT_TIMEOUT_MS);
+    int statement_timeout_ms = (timeout && *timeout) ? atoi(timeout) : DB_STATEMENT_TIMEOUT_MS;
+
+    snprintf(g_conninfo, sizeof(g_conninfo),
+             "host=%s port=%s dbname=%s user=%s password=%s connect_timeout=%d "
+             "keepalives=1 keepalives_idle=%d keepalives_interval=%d keepalives_count=%d "
+             "tcp_user_timeout=%d options='-c statement_timeout=%d'",
+             host, port, dbname, user, password, DB_CONN_TIMEOUT_SEC,
+             DB_KEEPALIVE_IDLE_SEC, DB_KEEPALIVE_INTERVAL_SEC, DB_KEEPALIVE_COUNT,
+             DB_TCP_USER_TIMEOUT_MS, statement_timeout_ms);
+
+    PGconn *conn = open_connection();
+
+    pthread_mutex_lock(&g_db_lock);
+    g_shutting_down = 0;
+    if (!conn) {
+        mark_down_locked("initial connect failed");
+        pthread_mutex_unlock(&g_db_lock);
+        return DB_ERR_UNAVAILABLE;
+    }
+    g_db_conn = conn;
+    atomic_store(&g_db_up, true);
+    pthread_mutex_unlock(&g_db_lock);
+
+    printf("[DB_CLIENT] PostgreSQL connection established\n");
+    return DB_OK;
+}
+
+static void pg_cleanup(void) {
+    pthread_mutex_lock(&g_db_lock);
+    g_shutting_down = 1;
+    int joinable = g_reconnect_joinable;
+    g_reconnect_joinable = 0;
+    pthread_cond_broadcast(&g_reconnect_cond);
+    pthread_mutex_unlock(&g_db_lock);
+
+    if (joinable) pthread_join(g_reconnect_thread, NULL);
+
+    pthread_mutex_lock(&g_db_lock);
+    atomic_store(&g_db_up, false);
+    if (g_db_conn) {
+        PQfinish(g_db_conn);
+        g_db_conn = NULL;
+        printf("[DB_CLIENT] PostgreSQL connection closed\n");
+    }
+    pthread_mutex_unlock(&g_db_lock);
+}
+
+static bool pg_is_available(void) {
+    return atomic_load(&g_db_up);
+}
+
+static void pg_on_reconnect(db_reconnect_cb cb) {
+    pthread_mutex_lock(&g_db_lock);
+    g_on_reconnect = cb;
+    pthread_mutex_unlock(&g_db_lock);
+}
+
+/* ===============================
+ * Helper: Convert PGresult to cJSON
+ * =============================== */
+static cJSON *pgresult_to_json(PGresult *res) {
+    if (!res) return NULL;
+
+    int nrows = PQntuples(res);
+    int nfields = PQnfields(res);
+
+    cJSON *array = cJSON_CreateArray();
+    if (!array) return NULL;
+
+    for (int row = 0; row < nrows; row++) {
+        cJSON *obj = cJSON_CreateObject();
+        if (!obj) {
+            cJSON_Delete(array);
+            return NULL;
+        }
+
+        for (int col = 0; col < nfields; col++) {
+            const char *field_name = PQfname(res, col);
+            const char *value = PQgetvalue(res, row, col);
+            
+            if (PQgetisnull(res, row, col)) {
+                cJSON_AddNullToObject(obj, field_name);
+            } else {
+                // Try to detect type (simplified version)
+                Oid field_type = PQftype(res, col);
+                
+                // Common PostgreSQL type OIDs
+                // 16=bool, 20=int8, 21=int2, 23=int4, 25=text, 1043=varchar
+                // 114=json, 3802=jsonb
+                if (field_type == 16) { // boolean
+                    cJSON_AddBoolToObject(obj, field_name, value[0] == 't');
+                } else if (field_type == 20 || field_type == 21 || field_type == 23) { // integers
+                    cJSON_AddNumberToObject(obj, field_name, atoi(value));
+                } else if (field_type == 114 || field_type == 3802) { // json/jsonb
+                    cJSON *json_val = cJSON_Parse(value);
+                    if (json_val) {
+                        cJSON_AddItemToObject(obj, field_name, json_val);
+                    } else {
+                        cJSON_AddStringToObject(obj, field_name, value);
+                    }
+                } else { // default to string
+                    cJSON_AddStringToObject(obj, field_name, value);
+                }
+            }
+        }
+
+        cJSON_AddItemToArray(array, obj);
+    }
+
+    return array;
+}
+
+/* ===============================
+ * Execute SQL query
+ * =============================== */
+static int result_rows(PGresult *res) {
+    if (PQresultStatus(res) == PGRES_TUPLES_OK) return PQntuples(res);
+    const char *affected = PQcmdTuples(res);
+    return (affected && *affected) ? atoi(affected) : 0;
+}
+
+static db_error_t pg_exec(const char *stmt, const char *query, cJSON **out_json, int *out_rows) {
+    *out_rows = 0;
+
+    // Circuit open: fail fast without queuing behind a statement in
+    // progress; the reconnect thread owns recovery
+    if (!atomic_load(&g_db_up)) return DB_ERR_UNAVAILABLE;
+
+    pthread_mutex_lock(&g_db_lock);
+    if (!g_db_conn) {
+        pthread_mutex_unlock(&g_db_lock);
+        return DB_ERR_UNAVAILABLE;
+    }
+
+    PGresult *res = PQexec(g_db_conn, query);
+
+    if (!res) {
+        fprintf(stderr, "[DB_EXEC] %s failed: %s\n", stmt, PQerrorMessage(g_db_conn));
+        db_error_t err = DB_ERR_HTTP;
+        if (PQstatus(g_db_conn) == CONNECTION_BAD) {
+            mark_down_locked("query on broken connection");
+            err = DB_ERR_UNAVAILABLE;
+        }
+        pthread_mutex_unlock(&g_db_lock);
+        return err;
+    }
+
+    ExecStatusType status = PQresultStatus(res);
+
+    if (status != PGRES_TUPLES_OK && status != PGRES_COMMAND_OK) {
+        fprintf(stderr, "[DB_EXEC] %s error: %s\n", stmt, PQerrorMessage(g_db_conn));
+        const char *state = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+        db_error_t err = (state && strcmp(state, "57014") == 0) ? DB_ERR_TIMEOUT : DB_ERR_HTTP;
+        PQclear(res);
+        if (PQstatus(g_db_conn) == CONNECTION_BAD) {
+            mark_down_locked("server closed the connection");
+            err = DB_ERR_UNAVAILABLE;
+        }
+        pthread_mutex_unlock(&g_db_lock);
+        return err;
+    }
+    pthread_mutex_unlock(&g_db_lock);
+
+    // PGresult is independent of the connection once returned
+    *out_rows = result_rows(res);
+    if (out_json) {
+        *out_json = pgresult_to_json(res);
+    }
+
+    PQclear(res);
+    return DB_OK;
+}
+
+static int pg_ping(void) {
+    pthread_mutex_lock(&g_db_lock);
+    if (!g_db_conn) {
+        pthread_mutex_unlock(&g_db_lock);
+        printf("[DB] ping failed: no connection\n");
+        return -1;
+    }
+
+    PGresult *res = PQexec(g_db_conn, "SELECT 1");
+    int ok = (res && PQresultStatus(res) == PGRES_TUPLES_OK);
+    if (res) PQclear(res);
+    if (!ok && PQstatus(g_db_conn) == CONNECTION_BAD) {
+        mark_down_locked("ping on broken connection");
+    }
+    pthread_mutex_unlock(&g_db_lock);
+
+    if (!ok) {
+        printf("[DB] ping failed\n");
+        return -1;
+    }
+
+    printf("[DB] ping OK\n");
+    return 0;
+}
+
+const db_backend_t db_backend_pg = {
+    .name = "postgres",
+    .init = pg_init,
+    .cleanup = pg_cleanup,
+    .exec = pg_exec,
+    .is_available = pg_is_available,
+    .ping = pg_ping,
+    .on_reconnect = pg_on_reconnect,
+};
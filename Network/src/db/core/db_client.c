@@ -1,152 +1,157 @@
 #include "db/core/db_client.h"
+#include "db/core/db_backend.h"
 #include "db/core/db_config.h"
-#include <libpq-fe.h>
+#include "db/core/db_stats.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <cjson/cJSON.h>
+#include <ctype.h>
+#include <time.h>
+#include <stdatomic.h>
 
-static PGconn *g_db_conn = NULL;
+// Selected once in db_client_init (ENV_DB_BACKEND). That runs on the
+// startup thread while the event loop, the shards and the writers may
+// already call in (db_is_available, the write-behind queue): atomic.
+static const db_backend_t *_Atomic g_backend = &db_backend_pg;
+
+// Opt-in per-query echo / result dump (ENV_DB_LOG_VERBOSE)
+static atomic_int g_log_verbose = 0;
+
+static const db_backend_t* backend(void) {
+    return atomic_load_explicit(&g_backend, memory_order_acquire);
+}
 
 /* ===============================
  * Init / Cleanup
  * =============================== */
 db_error_t db_client_init(void) {
-    const char *host = getenv(ENV_DB_HOST);
-    const char *port = getenv(ENV_DB_PORT);
-    const char *dbname = getenv(ENV_DB_NAME);
-    const char *user = getenv(ENV_DB_USER);
-    const char *password = getenv(ENV_DB_PASSWORD);
-
-    // Default values if not set
-    if (!host) host = "localhost";
-    if (!port) port = "5432";
-    if (!dbname) dbname = "tpir";
-    if (!user) user = "postgresql";
-    if (!password) password = "password";
-
-    printf("[DB_CLIENT] Init: host=%s, port=%s, dbname=%s, user=%s\n",
-           host, port, dbname, user);
-
-    char conninfo[DB_MAX_CONN_STRING];
-    snprintf(conninfo, sizeof(conninfo),
-             "host=%s port=%s dbname=%s user=%s password=%s connect_timeout=%d",
-             host, port, dbname, user, password, DB_CONN_TIMEOUT_SEC);
-
-    g_db_conn = PQconnectdb(conninfo);
-
-    if (PQstatus(g_db_conn) != CONNECTION_OK) {
-        fprintf(stderr, "[DB_CLIENT] Connection failed: %s\n", 
-                PQerrorMessage(g_db_conn));
-        PQfinish(g_db_conn);
-        g_db_conn = NULL;
-        return DB_ERR_HTTP;
+    const char *verbose = getenv(ENV_DB_LOG_VERBOSE);
+    atomic_store_explicit(&g_log_verbose, verbose && atoi(verbose) > 0, memory_order_relaxed);
+    db_stats_init();
+
+    const char *env = getenv(ENV_DB_BACKEND);
+    const db_backend_t *selected = &db_backend_pg;
+    if (env && strcmp(env, DB_BACKEND_MEMORY) == 0) {
+        selected = &db_backend_mem;
+    } else if (env && *env && strcmp(env, DB_BACKEND_POSTGRES) != 0) {
+        fprintf(stderr, "[DB_CLIENT] Unknown %s=%s, using %s\n",
+                ENV_DB_BACKEND, env, DB_BACKEND_POSTGRES);
     }
+    atomic_store_explicit(&g_backend, selected, memory_order_release);
+    printf("[DB_CLIENT] Backend: %s\n", selected->name);
 
-    printf("[DB_CLIENT] PostgreSQL connection established\n");
-    return DB_OK;
+    return selected->init();
 }
 
 void db_client_cleanup(void) {
-    if (g_db_conn) {
-        PQfinish(g_db_conn);
-        g_db_conn = NULL;
-        printf("[DB_CLIENT] PostgreSQL connection closed\n");
-    }
+    db_stats_report();
+    backend()->cleanup();
 }
 
-/* ===============================
- * Helper: Convert PGresult to cJSON
- * =============================== */
-static cJSON *pgresult_to_json(PGresult *res) {
-    if (!res) return NULL;
+bool db_is_available(void) {
+    return backend()->is_available();
+}
 
-    int nrows = PQntuples(res);
-    int nfields = PQnfields(res);
+void db_client_on_reconnect(db_reconnect_cb cb) {
+    const db_backend_t *b = backend();
+    if (b->on_reconnect) b->on_reconnect(cb);
+}
 
-    cJSON *array = cJSON_CreateArray();
-    if (!array) return NULL;
+/* ===============================
+ * Statement naming (stats key)
+ * =============================== */
+static double elapsed_ms(const struct timespec *t0) {
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (double)(t1.tv_sec - t0->tv_sec) * 1000.0 +
+           (double)(t1.tv_nsec - t0->tv_nsec) / 1e6;
+}
 
-    for (int row = 0; row < nrows; row++) {
-        cJSON *obj = cJSON_CreateObject();
-        if (!obj) {
-            cJSON_Delete(array);
-            return NULL;
+// More than one statement (write-behind batch, seed scripts): a ';'
+// outside quotes followed by anything but blanks
+static bool is_script(const char *query) {
+    bool quoted = false;
+    for (const char *p = query; *p; p++) {
+        if (*p == '\'') quoted = !quoted;
+        else if (*p == ';' && !quoted) {
+            const char *q = p + 1;
+            while (*q && isspace((unsigned char)*q)) q++;
+            if (*q) return true;
         }
+    }
+    return false;
+}
 
-        for (int col = 0; col < nfields; col++) {
-            const char *field_name = PQfname(res, col);
-            const char *value = PQgetvalue(res, row, col);
-            
-            if (PQgetisnull(res, row, col)) {
-                cJSON_AddNullToObject(obj, field_name);
-            } else {
-                // Try to detect type (simplified version)
-                Oid field_type = PQftype(res, col);
-                
-                // Common PostgreSQL type OIDs
-                // 16=bool, 20=int8, 21=int2, 23=int4, 25=text, 1043=varchar
-                // 114=json, 3802=jsonb
-                if (field_type == 16) { // boolean
-                    cJSON_AddBoolToObject(obj, field_name, value[0] == 't');
-                } else if (field_type == 20 || field_type == 21 || field_type == 23) { // integers
-                    cJSON_AddNumberToObject(obj, field_name, atoi(value));
-                } else if (field_type == 114 || field_type == 3802) { // json/jsonb
-                    cJSON *json_val = cJSON_Parse(value);
-                    if (json_val) {
-                        cJSON_AddItemToObject(obj, field_name, json_val);
-                    } else {
-                        cJSON_AddStringToObject(obj, field_name, value);
-                    }
-                } else { // default to string
-                    cJSON_AddStringToObject(obj, field_name, value);
-                }
+// "<VERB> <table> @<file>:<line>": verb is the first SQL keyword (SCRIPT
+// for several statements), table is the caller's name or, if none was
+// given, the identifier after FROM / INTO / UPDATE. The call site keeps
+// different statements on the same table apart.
+static void stmt_name(const char *table, const char *query, const char *file, int line,
+                      char *out, size_t out_size) {
+    char verb[16] = "";
+    size_t v = 0;
+    const char *p = query;
+    while (*p && isspace((unsigned char)*p)) p++;
+    while (*p && isalpha((unsigned char)*p) && v < sizeof(verb) - 1) {
+        verb[v++] = (char)toupper((unsigned char)*p++);
+    }
+    verb[v] = '\0';
+    if (is_script(query)) snprintf(verb, sizeof(verb), "SCRIPT");
+
+    char derived[48] = "";
+    if (!table || !*table) {
+        const char *kw = NULL;
+        const char *keys[] = { " FROM ", " from ", " INTO ", " into ", "UPDATE ", "update " };
+        for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]) && !kw; i++) {
+            const char *hit = strstr(query, keys[i]);
+            if (hit) kw = hit + strlen(keys[i]);
+        }
+        if (kw) {
+            size_t d = 0;
+            while (*kw == ' ') kw++;
+            while (*kw && (isalnum((unsigned char)*kw) || *kw == '_') && d < sizeof(derived) - 1) {
+                derived[d++] = *kw++;
             }
+            derived[d] = '\0';
         }
-
-        cJSON_AddItemToArray(array, obj);
+        table = derived[0] ? derived : "?";
     }
 
-    return array;
+    const char *base = file ? strrchr(file, '/') : NULL;
+    base = base ? base + 1 : (file ? file : "?");
+    snprintf(out, out_size, "%s %s @%s:%d", verb[0] ? verb : "SQL", table, base, line);
 }
 
 /* ===============================
  * Execute SQL query
  * =============================== */
-static db_error_t db_exec(const char *query, cJSON **out_json) {
-    if (!g_db_conn) {
-        fprintf(stderr, "[DB_EXEC] No database connection\n");
-        return DB_ERR_HTTP;
-    }
-
-    printf("[DB_EXEC] Query: %.200s%s\n", query, strlen(query) > 200 ? "..." : "");
-
-    PGresult *res = PQexec(g_db_conn, query);
-    if (!res) {
-        fprintf(stderr, "[DB_EXEC] Query failed: %s\n", PQerrorMessage(g_db_conn));
-        return DB_ERR_HTTP;
+static db_error_t db_exec(const char *table, const char *query, cJSON **out_json,
+                          const char *file, int line) {
+    char name[DB_STATS_NAME_LEN];
+    stmt_name(table, query, file, line, name, sizeof(name));
+
+    bool verbose = atomic_load_explicit(&g_log_verbose, memory_order_relaxed);
+    if (verbose) {
+        printf("[DB_EXEC] Query: %.200s%s\n", query, strlen(query) > 200 ? "..." : "");
     }
 
-    ExecStatusType status = PQresultStatus(res);
-
-    if (status != PGRES_TUPLES_OK && status != PGRES_COMMAND_OK) {
-        fprintf(stderr, "[DB_EXEC] Query error: %s\n", PQerrorMessage(g_db_conn));
-        PQclear(res);
-        return DB_ERR_HTTP;
-    }
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int rows = 0;
+    db_error_t err = backend()->exec(name, query, out_json, &rows);
+    db_stats_record(name, query, elapsed_ms(&t0), rows, err == DB_OK);
 
-    if (out_json) {
-        *out_json = pgresult_to_json(res);
-        if (*out_json) {
-            char *json_str = cJSON_PrintUnformatted(*out_json);
-            printf("[DB_EXEC] Result: %.200s%s\n", json_str, 
+    if (err == DB_OK && out_json && *out_json && verbose) {
+        char *json_str = cJSON_PrintUnformatted(*out_json);
+        if (json_str) {
+            printf("[DB_EXEC] Result: %.200s%s\n", json_str,
                    strlen(json_str) > 200 ? "..." : "");
             free(json_str);
         }
     }
 
-    PQclear(res);
-    return DB_OK;
+    return err;
 }
 
 /* ===============================
@@ -154,16 +159,16 @@ static db_error_t db_exec(const char *query, cJSON **out_json) {
  * =============================== */
 
 // GET: Execute SQL SELECT query  
-db_error_t db_get(const char *table, const char *query, cJSON **out_json) {
+db_error_t db_get_at(const char *table, const char *query, cJSON **out_json,
+                     const char *file, int line) {
     // Query now contains full SQL statement
-    // table parameter kept for API compatibility but not used in SQL mode
-    (void)table; // Unused in SQL mode
-    
-    return db_exec(query, out_json);
+    // table parameter only names the statement for db_stats
+    return db_exec(table, query, out_json, file, line);
 }
 
 // POST: INSERT and return inserted row
-db_error_t db_post(const char *table, cJSON *payload, cJSON **out_json) {
+db_error_t db_post_at(const char *table, cJSON *payload, cJSON **out_json,
+                      const char *file, int line) {
     if (!payload) return DB_ERR_INVALID_ARG;
 
     // Build INSERT statement
@@ -224,11 +229,12 @@ db_error_t db_post(const char *table, cJSON *payload, cJSON **out_json) {
              "INSERT INTO %s (%s) VALUES (%s) RETURNING *",
              table, columns, values);
     
-    return db_exec(sql, out_json);
+    return db_exec(table, sql, out_json, file, line);
 }
 
 // RPC: Call PostgreSQL function
-db_error_t db_rpc(const char *function, cJSON *payload, cJSON **out_json) {
+db_error_t db_rpc_at(const char *function, cJSON *payload, cJSON **out_json,
+                     const char *file, int line) {
     char sql[2048];
     
     // Build function call
@@ -259,11 +265,12 @@ db_error_t db_rpc(const char *function, cJSON *payload, cJSON **out_json) {
     
     snprintf(sql, sizeof(sql), "SELECT * FROM %s(%s)", function, params);
     
-    return db_exec(sql, out_json);
+    return db_exec(function, sql, out_json, file, line);
 }
 
 // PATCH: UPDATE and return updated rows
-db_error_t db_patch(const char *table, const char *filter, cJSON *payload, cJSON **out_json) {
+db_error_t db_patch_at(const char *table, const char *filter, cJSON *payload, cJSON **out_json,
+                       const char *file, int line) {
     if (!payload ||!filter) return DB_ERR_INVALID_ARG;
 
     char sql[4096];
@@ -303,11 +310,12 @@ db_error_t db_patch(const char *table, const char *filter, cJSON *payload, cJSON
              "UPDATE %s SET %s WHERE %s RETURNING *",
              table, set_clause, filter);
     
-    return db_exec(sql, out_json);
+    return db_exec(table, sql, out_json, file, line);
 }
 
 // DELETE: Delete rows
-db_error_t db_delete(const char *table, const char *filter, cJSON **out_json) {
+db_error_t db_delete_at(const char *table, const char *filter, cJSON **out_json,
+                        const char *file, int line) {
     if (!filter) return DB_ERR_INVALID_ARG;
 
     char sql[1024];
@@ -317,24 +325,10 @@ db_error_t db_delete(const char *table, const char *filter, cJSON **out_json) {
              "DELETE FROM %s WHERE %s RETURNING *",
              table, filter);
     
-    return db_exec(sql, out_json);
+    return db_exec(table, sql, out_json, file, line);
 }
 
 // Ping: Test connection
 int db_ping(void) {
-    if (!g_db_conn) {
-        printf("[DB] ping failed: no connection\n");
-        return -1;
-    }
-
-    PGresult *res = PQexec(g_db_conn, "SELECT 1");
-    if (!res || PQresultStatus(res) != PGRES_TUPLES_OK) {
-        printf("[DB] ping failed\n");
-        if (res) PQclear(res);
-        return -1;
-    }
-
-    printf("[DB] ping OK\n");
-    PQclear(res);
-    return 0;
+    return backend()->ping();
 }
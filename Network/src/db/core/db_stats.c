@@ -0,0 +1,153 @@
+#include "db/core/db_stats.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+static db_stmt_stats_t g_stmts[DB_STATS_MAX_STATEMENTS];
+static int g_stmt_count = 0;
+static db_stmt_stats_t g_other = { .name = "(other)" };    // keys past the table
+static pthread_mutex_t g_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static double g_slow_ms = DB_SLOW_QUERY_MS_DEFAULT;
+static int g_interval_sec = DB_STATS_INTERVAL_SEC_DEFAULT;
+static time_t g_last_report = 0;
+
+// Upper bound (ms) of each histogram bucket; last bucket is overflow
+static double bucket_bound(int i) {
+    return 0.25 * (double)(1u << i);
+}
+
+static int bucket_for(double ms) {
+    for (int i = 0; i < DB_STATS_BUCKETS - 1; i++) {
+        if (ms <= bucket_bound(i)) return i;
+    }
+    return DB_STATS_BUCKETS - 1;
+}
+
+static db_stmt_stats_t *find_or_add(const char *name) {
+    for (int i = 0; i < g_stmt_count; i++) {
+        if (strcmp(g_stmts[i].name, name) == 0) return &g_stmts[i];
+    }
+    // Table full: fold everything else into "(other)", keep the real keys
+    if (g_stmt_count >= DB_STATS_MAX_STATEMENTS) return &g_other;
+    db_stmt_stats_t *s = &g_stmts[g_stmt_count++];
+    memset(s, 0, sizeof(*s));
+    snprintf(s->name, sizeof(s->name), "%s", name);
+    return s;
+}
+
+static int cmp_total_desc(const void *a, const void *b) {
+    const db_stmt_stats_t *x = a;
+    const db_stmt_stats_t *y = b;
+    if (x->total_ms < y->total_ms) return 1;
+    if (x->total_ms > y->total_ms) return -1;
+    return 0;
+}
+
+void db_stats_init(void) {
+    const char *slow = getenv(ENV_DB_SLOW_QUERY_MS);
+    const char *interval = getenv(ENV_DB_STATS_INTERVAL_SEC);
+
+    pthread_mutex_lock(&g_stats_lock);
+    if (slow && *slow) g_slow_ms = atof(slow);
+    if (interval && *interval) g_interval_sec = atoi(interval);
+    g_last_report = time(NULL);
+    pthread_mutex_unlock(&g_stats_lock);
+
+    printf("[DB_STATS] slow-query threshold=%.1fms, report interval=%ds\n",
+           g_slow_ms, g_interval_sec);
+}
+
+void db_stats_record(const char *name, const char *sql, double ms, int rows, bool ok) {
+    if (!name || !*name) name = "(unnamed)";
+
+    pthread_mutex_lock(&g_stats_lock);
+    db_stmt_stats_t *s = find_or_add(name);
+    s->calls++;
+    if (!ok) s->errors++;
+    if (rows > 0) s->rows += (uint64_t)rows;
+    s->total_ms += ms;
+    if (ms > s->max_ms) s->max_ms = ms;
+    s->hist[bucket_for(ms)]++;
+
+    int report_due = 0;
+    time_t now = time(NULL);
+    if (g_interval_sec > 0 && now - g_last_report >= g_interval_sec) {
+        g_last_report = now;
+        report_due = 1;
+    }
+    double slow_ms = g_slow_ms;
+    pthread_mutex_unlock(&g_stats_lock);
+
+    if (slow_ms > 0 && ms >= slow_ms) {
+        printf("[DB_SLOW] %.1fms %s rows=%d: %.300s%s\n", ms, name, rows,
+               sql ? sql : "", (sql && strlen(sql) > 300) ? "..." : "");
+    }
+
+    if (report_due) db_stats_report();
+}
+
+int db_stats_snapshot(db_stmt_stats_t *out, int max) {
+    if (!out || max <= 0) return 0;
+
+    pthread_mutex_lock(&g_stats_lock);
+    int n = g_stmt_count < max ? g_stmt_count : max;
+    memcpy(out, g_stmts, sizeof(db_stmt_stats_t) * (size_t)n);
+    if (g_other.calls > 0 && n < max) out[n++] = g_other;
+    pthread_mutex_unlock(&g_stats_lock);
+
+    qsort(out, (size_t)n, sizeof(db_stmt_stats_t), cmp_total_desc);
+    return n;
+}
+
+double db_stats_percentile(const db_stmt_stats_t *s, double pct) {
+    if (!s || s->calls == 0) return 0.0;
+
+    uint64_t target = (uint64_t)((double)s->calls * pct / 100.0 + 0.5);
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < DB_STATS_BUCKETS - 1; i++) {
+        seen += s->hist[i];
+        if (seen >= target) {
+            double bound = bucket_bound(i);
+            return bound < s->max_ms ? bound : s->max_ms;
+        }
+    }
+    return s->max_ms;
+}
+
+void db_stats_report(void) {
+    db_stmt_stats_t snap[DB_STATS_MAX_STATEMENTS + 1];
+    int n = db_stats_snapshot(snap, DB_STATS_MAX_STATEMENTS + 1);
+
+    printf("[DB_STATS] ===== %d statements =====\n", n);
+    printf("[DB_STATS] %-56s %8s %6s %9s %9s %8s %8s %8s %8s\n",
+           "statement", "calls", "errs", "rows", "total_ms", "avg_ms", "p50", "p99", "max");
+    for (int i = 0; i < n; i++) {
+        db_stmt_stats_t *s = &snap[i];
+        printf("[DB_STATS] %-56.56s %8llu %6llu %9llu %9.1f %8.2f %8.2f %8.2f %8.2f\n",
+               s->name,
+               (unsigned long long)s->calls,
+               (unsigned long long)s->errors,
+               (unsigned long long)s->rows,
+               s->total_ms,
+               s->calls ? s->total_ms / (double)s->calls : 0.0,
+               db_stats_percentile(s, 50.0),
+               db_stats_percentile(s, 99.0),
+               s->max_ms);
+    }
+}
+
+void db_stats_reset(void) {
+    pthread_mutex_lock(&g_stats_lock);
+    memset(g_stmts, 0, sizeof(g_stmts));
+    g_stmt_count = 0;
+    memset(&g_other, 0, sizeof(g_other));
+    snprintf(g_other.name, sizeof(g_other.name), "%s", "(other)");
+    g_last_report = time(NULL);
+    pthread_mutex_unlock(&g_stats_lock);
+}
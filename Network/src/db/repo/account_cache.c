@@ -0,0 +1,330 @@
+#include "db/repo/account_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "db/repo/account_repo.h"
+#include "db/repo/profile_repo.h"
+
+#define EC_BUCKETS 4096
+
+typedef struct ec_node {
+    int32_t key;                // account id
+    char *email;                // accounts only (secondary index)
+    void *value;                // account_t / profile_t (owned)
+    size_t bytes;
+
+    struct ec_node *prev;       // LRU list, head = most recent
+    struct ec_node *next;
+    struct ec_node *id_next;    // hash chains
+    struct ec_node *email_next;
+} ec_node_t;
+
+typedef struct {
+    const char *name;
+    pthread_mutex_t lock;
+    ec_node_t *by_id[EC_BUCKETS];
+    ec_node_t *by_email[EC_BUCKETS];
+    ec_node_t *head;
+    ec_node_t *tail;
+    void (*free_value)(void *);
+    entity_cache_stats_t stats;
+} ec_table_t;
+
+static void free_account_value(void *v) { account_free(v); }
+static void free_profile_value(void *v) { profile_free(v); }
+
+static ec_table_t g_accounts = {
+    .name = "accounts",
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .free_value = free_account_value,
+};
+static ec_table_t g_profiles = {
+    .name = "profiles",
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .free_value = free_profile_value,
+};
+
+static pthread_once_t g_limits_once = PTHREAD_ONCE_INIT;
+
+//==============================================================================
+// HELPERS
+//==============================================================================
+
+static void load_limits(void) {
+    const char *entries = getenv(ENV_ENTITY_CACHE_MAX_ENTRIES);
+    const char *bytes = getenv(ENV_ENTITY_CACHE_MAX_BYTES);
+    size_t max_entries = (entries && *entries) ? (size_t)atol(entries) : ENTITY_CACHE_MAX_ENTRIES_DEFAULT;
+    size_t max_bytes = (bytes && *bytes) ? (size_t)atol(bytes) : ENTITY_CACHE_MAX_BYTES_DEFAULT;
+
+    g_accounts.stats.max_entries = g_profiles.stats.max_entries = max_entries;
+    g_accounts.stats.max_bytes = g_profiles.stats.max_bytes = max_bytes;
+    printf("[ENTITY_CACHE] max %zu entries / %zu bytes per table\n", max_entries, max_bytes);
+}
+
+static unsigned hash_id(int32_t id) {
+    return ((uint32_t)id * 2654435761u) % EC_BUCKETS;
+}
+
+static unsigned hash_str(const char *s) {
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h % EC_BUCKETS;
+}
+
+static size_t str_bytes(const char *s) {
+    return s ? strlen(s) + 1 : 0;
+}
+
+static char *dup_str(const char *s) {
+    return s ? strdup(s) : NULL;
+}
+
+static account_t *account_dup(const account_t *a) {
+    account_t *c = calloc(1, sizeof(*c));
+    if (!c) return NULL;
+    *c = *a;
+    c->email = dup_str(a->email);
+    c->password = dup_str(a->password);
+    c->role = dup_str(a->role);
+    return c;
+}
+
+static profile_t *profile_dup(const profile_t *p) {
+    profile_t *c = calloc(1, sizeof(*c));
+    if (!c) return NULL;
+    *c = *p;
+    c->name = dup_str(p->name);
+    c->avatar = dup_str(p->avatar);
+    c->bio = dup_str(p->bio);
+    c->badges = dup_str(p->badges);
+    return c;
+}
+
+//==============================================================================
+// LRU TABLE (caller holds t->lock)
+//==============================================================================
+
+static void lru_unlink(ec_table_t *t, ec_node_t *n) {
+    if (n->prev) n->prev->next = n->next; else t->head = n->next;
+    if (n->next) n->next->prev = n->prev; else t->tail = n->prev;
+    n->prev = n->next = NULL;
+}
+
+static void lru_push_front(ec_table_t *t, ec_node_t *n) {
+    n->prev = NULL;
+    n->next = t->head;
+    if (t->head) t->head->prev = n;
+    t->head = n;
+    if (!t->tail) t->tail = n;
+}
+
+static ec_node_t *find_id(ec_table_t *t, int32_t key) {
+    for (ec_node_t *n = t->by_id[hash_id(key)]; n; n = n->id_next) {
+        if (n->key == key) return n;
+    }
+    return NULL;
+}
+
+static ec_node_t *find_email(ec_table_t *t, const char *email) {
+    for (ec_node_t *n = t->by_email[hash_str(email)]; n; n = n->email_next) {
+        if (n->email && strcmp(n->email, email) == 0) return n;
+    }
+    return NULL;
+}
+
+static void node_remove(ec_table_t *t, ec_node_t *n) {
+    ec_node_t **pp = &t->by_id[hash_id(n->key)];
+    while (*pp && *pp != n) pp = &(*pp)->id_next;
+    if (*pp) *pp = n->id_next;
+
+    if (n->email) {
+        pp = &t->by_email[hash_str(n->email)];
+        while (*pp && *pp != n) pp = &(*pp)->email_next;
+        if (*pp) *pp = n->email_next;
+    }
+
+    lru_unlink(t, n);
+    t->stats.entries--;
+    t->stats.bytes -= n->bytes;
+
+    t->free_value(n->value);
+    free(n->email);
+    free(n);
+}
+
+static void table_insert(ec_table_t *t, int32_t key, const char *email, void *value, size_t bytes) {
+    ec_node_t *old = find_id(t, key);
+    if (old) node_remove(t, old);
+    if (email) {
+        old = find_email(t, email);
+        if (old) node_remove(t, old);
+    }
+
+    ec_node_t *n = calloc(1, sizeof(*n));
+    if (!n) {
+        t->free_value(value);
+        return;
+    }
+    n->key = key;
+    n->email = dup_str(email);
+    n->value = value;
+    n->bytes = bytes + sizeof(*n) + str_bytes(email);
+
+    unsigned b = hash_id(key);
+    n->id_next = t->by_id[b];
+    t->by_id[b] = n;
+    if (n->email) {
+        b = hash_str(n->email);
+        n->email_next = t->by_email[b];
+        t->by_email[b] = n;
+    }
+    lru_push_front(t, n);
+    t->stats.entries++;
+    t->stats.bytes += n->bytes;
+
+    // Evict from the cold end, never the entry just added
+    while (t->tail && t->tail != n &&
+           (t->stats.entries > t->stats.max_entries || t->stats.bytes > t->stats.max_bytes)) {
+        node_remove(t, t->tail);
+        t->stats.evictions++;
+    }
+}
+
+static void *table_get(ec_table_t *t, ec_node_t *n, void *(*dup)(const void *)) {
+    if (!n) {
+        t->stats.misses++;
+        return NULL;
+    }
+    t->stats.hits++;
+    lru_unlink(t, n);
+    lru_push_front(t, n);
+    return dup(n->value);
+}
+
+static void table_invalidate(ec_table_t *t, int32_t key) {
+    pthread_mutex_lock(&t->lock);
+    ec_node_t *n = find_id(t, key);
+    if (n) {
+        node_remove(t, n);
+        t->stats.invalidations++;
+    }
+    pthread_mutex_unlock(&t->lock);
+}
+
+static void table_clear(ec_table_t *t) {
+    pthread_mutex_lock(&t->lock);
+    while (t->head) node_remove(t, t->head);
+    pthread_mutex_unlock(&t->lock);
+}
+
+static void *dup_account_value(const void *v) { return account_dup(v); }
+static void *dup_profile_value(const void *v) { return profile_dup(v); }
+
+//==============================================================================
+// ACCOUNTS
+//==============================================================================
+
+account_t *account_cache_get_by_id(int32_t account_id) {
+    pthread_once(&g_limits_once, load_limits);
+    pthread_mutex_lock(&g_accounts.lock);
+    account_t *a = table_get(&g_accounts, find_id(&g_accounts, account_id), dup_account_value);
+    pthread_mutex_unlock(&g_accounts.lock);
+    return a;
+}
+
+account_t *account_cache_get_by_email(const char *email) {
+    if (!email) return NULL;
+    pthread_once(&g_limits_once, load_limits);
+    pthread_mutex_lock(&g_accounts.lock);
+    account_t *a = table_get(&g_accounts, find_email(&g_accounts, email), dup_account_value);
+    pthread_mutex_unlock(&g_accounts.lock);
+    return a;
+}
+
+void account_cache_put(const account_t *account) {
+    if (!account || account->id <= 0) return;
+    pthread_once(&g_limits_once, load_limits);
+
+    account_t *copy = account_dup(account);
+    if (!copy) return;
+    size_t bytes = sizeof(*copy) + str_bytes(copy->email) +
+                   str_bytes(copy->password) + str_bytes(copy->role);
+
+    pthread_mutex_lock(&g_accounts.lock);
+    table_insert(&g_accounts, copy->id, copy->email, copy, bytes);
+    pthread_mutex_unlock(&g_accounts.lock);
+}
+
+void account_cache_invalidate(int32_t account_id) {
+    table_invalidate(&g_accounts, account_id);
+}
+
+//==============================================================================
+// PROFILES
+//==============================================================================
+
+profile_t *profile_cache_get(int32_t account_id) {
+    pthread_once(&g_limits_once, load_limits);
+    pthread_mutex_lock(&g_profiles.lock);
+    profile_t *p = table_get(&g_profiles, find_id(&g_profiles, account_id), dup_profile_value);
+    pthread_mutex_unlock(&g_profiles.lock);
+    return p;
+}
+
+void profile_cache_put(const profile_t *profile) {
+    if (!profile || profile->account_id <= 0) return;
+    pthread_once(&g_limits_once, load_limits);
+
+    profile_t *copy = profile_dup(profile);
+    if (!copy) return;
+    size_t bytes = sizeof(*copy) + str_bytes(copy->name) + str_bytes(copy->avatar) +
+                   str_bytes(copy->bio) + str_bytes(copy->badges);
+
+    pthread_mutex_lock(&g_profiles.lock);
+    table_insert(&g_profiles, copy->account_id, NULL, copy, bytes);
+    pthread_mutex_unlock(&g_profiles.lock);
+}
+
+void profile_cache_invalidate(int32_t account_id) {
+    table_invalidate(&g_profiles, account_id);
+}
+
+//==============================================================================
+// STATS
+//==============================================================================
+
+void entity_cache_stats(const char *table, entity_cache_stats_t *out) {
+    if (!out) return;
+    ec_table_t *t = (table && strcmp(table, "profiles") == 0) ? &g_profiles : &g_accounts;
+    pthread_once(&g_limits_once, load_limits);
+    pthread_mutex_lock(&t->lock);
+    *out = t->stats;
+    pthread_mutex_unlock(&t->lock);
+}
+
+void entity_cache_report(void) {
+    ec_table_t *tables[] = { &g_accounts, &g_profiles };
+    for (int i = 0; i < 2; i++) {
+        entity_cache_stats_t s;
+        entity_cache_stats(tables[i]->name, &s);
+        uint64_t lookups = s.hits + s.misses;
+        printf("[ENTITY_CACHE] %-8s hit=%.1f%% (%llu/%llu) entries=%zu/%zu bytes=%zu/%zu "
+               "evicted=%llu invalidated=%llu\n",
+               tables[i]->name,
+               lookups ? 100.0 * (double)s.hits / (double)lookups : 0.0,
+               (unsigned long long)s.hits, (unsigned long long)lookups,
+               s.entries, s.max_entries, s.bytes, s.max_bytes,
+               (unsigned long long)s.evictions, (unsigned long long)s.invalidations);
+    }
+}
+
+void entity_cache_clear(void) {
+    table_clear(&g_accounts);
+    table_clear(&g_profiles);
+}
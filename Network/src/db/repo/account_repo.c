@@ -6,6 +6,8 @@
 
 #include "db/repo/account_repo.h"
 #include "db/core/db_client.h"
+#include "db/repo/account_cache.h"
+#include "db/repo/user_index.h"
 
 // Helper function to parse account from JSON
 static account_t* parse_account_from_json(cJSON *json) {
@@ -94,6 +96,8 @@ db_error_t account_create(
         cJSON *item = cJSON_GetArrayItem(response, 0);
         *out_account = parse_account_from_json(item);
         cJSON_Delete(response);
+        account_cache_put(*out_account);
+        if (*out_account) user_index_put_account((*out_account)->id, (*out_account)->email);
         return *out_account ? DB_SUCCESS : DB_ERROR_PARSE;
     }
 
@@ -110,6 +114,9 @@ db_error_t account_find_by_email(
         return DB_ERROR_INVALID_PARAM;
     }
 
+    *out_account = account_cache_get_by_email(email);
+    if (*out_account) return DB_SUCCESS;
+
     printf("[AUTH] Finding account by email: %s\n", email);
 
     // Build SQL query instead of REST query
@@ -143,6 +150,7 @@ db_error_t account_find_by_email(
         
         if (*out_account) {
             printf("[AUTH] Account found: id=%d, email=%s\n", (*out_account)->id, (*out_account)->email);
+            account_cache_put(*out_account);
         }
         
         cJSON_Delete(response);
@@ -162,6 +170,9 @@ db_error_t account_find_by_id(
         return DB_ERROR_INVALID_PARAM;
     }
 
+    *out_account = account_cache_get_by_id(account_id);
+    if (*out_account) return DB_SUCCESS;
+
     // Build SQL query
     char query[256];
     snprintf(query, sizeof(query), "SELECT * FROM accounts WHERE id = %d LIMIT 1", account_id);
@@ -185,6 +196,7 @@ db_error_t account_find_by_id(
         cJSON *item = cJSON_GetArrayItem(response, 0);
         *out_account = parse_account_from_json(item);
         cJSON_Delete(response);
+        account_cache_put(*out_account);
         return *out_account ? DB_SUCCESS : DB_ERROR_PARSE;
     }
 
@@ -192,6 +204,68 @@ db_error_t account_find_by_id(
     return DB_ERROR_PARSE;
 }
 
+db_error_t account_find_by_ids(
+    const int32_t *account_ids,
+    int32_t count,
+    account_t **out_accounts
+) {
+    if (count < 0 || (count > 0 && (!account_ids || !out_accounts))) {
+        return DB_ERROR_INVALID_PARAM;
+    }
+
+    // Cache hits first; misses go into a single IN (...) query
+    size_t cap = 64 + (size_t)count * 12;
+    char *query = malloc(cap);
+    if (!query) return DB_ERROR_INTERNAL;
+    size_t len = (size_t)snprintf(query, cap, "SELECT * FROM accounts WHERE id IN (");
+    int32_t misses = 0;
+
+    for (int32_t i = 0; i < count; i++) {
+        out_accounts[i] = account_ids[i] > 0 ? account_cache_get_by_id(account_ids[i]) : NULL;
+        if (out_accounts[i] || account_ids[i] <= 0) continue;
+        len += (size_t)snprintf(query + len, cap - len, "%s%d", misses ? "," : "", account_ids[i]);
+        misses++;
+    }
+
+    if (misses == 0) {
+        free(query);
+        return DB_SUCCESS;
+    }
+    snprintf(query + len, cap - len, ")");
+
+    cJSON *response = NULL;
+    db_error_t err = db_get("accounts", query, &response);
+    free(query);
+
+    if (err != DB_SUCCESS || !cJSON_IsArray(response)) {
+        if (response) cJSON_Delete(response);
+        for (int32_t i = 0; i < count; i++) {
+            account_free(out_accounts[i]);
+            out_accounts[i] = NULL;
+        }
+        return err != DB_SUCCESS ? err : DB_ERROR_PARSE;
+    }
+
+    cJSON *item = NULL;
+    cJSON_ArrayForEach(item, response) {
+        account_t *account = parse_account_from_json(item);
+        if (!account) continue;
+        account_cache_put(account);
+
+        // Hand a copy to every slot asking for this account
+        for (int32_t i = 0; i < count; i++) {
+            if (account_ids[i] != account->id || out_accounts[i]) continue;
+            out_accounts[i] = account;
+            account = account_cache_get_by_id(account_ids[i]);
+            if (!account) break;
+        }
+        account_free(account);
+    }
+
+    cJSON_Delete(response);
+    return DB_SUCCESS;
+}
+
 db_error_t account_update_password(
     int32_t account_id,
     const char *new_password_hash
@@ -210,6 +284,7 @@ db_error_t account_update_password(
 
     cJSON *response = NULL;
     db_error_t err = db_patch("accounts", filter, payload, &response);
+    account_cache_invalidate(account_id);
     
     cJSON_Delete(payload);
     if (response) cJSON_Delete(response);
@@ -235,6 +310,7 @@ db_error_t account_update_role(
 
     cJSON *response = NULL;
     db_error_t err = db_patch("accounts", filter, payload, &response);
+    account_cache_invalidate(account_id);
     
     cJSON_Delete(payload);
     if (response) cJSON_Delete(response);
@@ -0,0 +1,326 @@
+#include "db/repo/friend_graph.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "db/repo/friend_repo.h"
+
+#define FG_BUCKETS      4096
+#define FG_LOAD_RETRIES 3
+
+typedef struct fg_node {
+    int32_t account_id;
+    int32_t *ids;               // sorted, unique
+    int32_t count;
+    int32_t cap;
+    struct fg_node *next;       // hash chain
+    struct fg_node *lru_prev;   // toward most recently used
+    struct fg_node *lru_next;
+} fg_node_t;
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static fg_node_t *g_buckets[FG_BUCKETS];
+static uint64_t g_generation;   // bumped on every edge change
+static int32_t g_loaded;
+static fg_node_t *g_lru_head;   // most recently used
+static fg_node_t *g_lru_tail;
+static uint64_t g_evicted;
+
+// ============================================================================
+// HELPERS (caller holds g_lock)
+// ============================================================================
+
+static unsigned hash_id(int32_t id) {
+    return ((uint32_t)id * 2654435761u) % FG_BUCKETS;
+}
+
+static fg_node_t* find_node(int32_t account_id) {
+    for (fg_node_t *n = g_buckets[hash_id(account_id)]; n; n = n->next) {
+        if (n->account_id == account_id) return n;
+    }
+    return NULL;
+}
+
+static void lru_unlink(fg_node_t *n) {
+    if (n->lru_prev) n->lru_prev->lru_next = n->lru_next;
+    else g_lru_head = n->lru_next;
+    if (n->lru_next) n->lru_next->lru_prev = n->lru_prev;
+    else g_lru_tail = n->lru_prev;
+    n->lru_prev = n->lru_next = NULL;
+}
+
+static void lru_push_front(fg_node_t *n) {
+    n->lru_next = g_lru_head;
+    if (g_lru_head) g_lru_head->lru_prev = n;
+    g_lru_head = n;
+    if (!g_lru_tail) g_lru_tail = n;
+}
+
+static void touch(fg_node_t *n) {
+    if (g_lru_head == n) return;
+    lru_unlink(n);
+    lru_push_front(n);
+}
+
+// Drop the least recently read account; it reloads from the DB when next
+// read, and edge updates skip it meanwhile, so nothing goes stale
+static void evict_lru(void) {
+    fg_node_t *victim = g_lru_tail;
+    if (!victim) return;
+    lru_unlink(victim);
+
+    fg_node_t **pp = &g_buckets[hash_id(victim->account_id)];
+    while (*pp && *pp != victim) pp = &(*pp)->next;
+    if (*pp) *pp = victim->next;
+
+    free(victim->ids);
+    free(victim);
+    g_loaded--;
+    g_evicted++;
+}
+
+// Index of id in n->ids, or -(insert position) - 1 if absent
+static int32_t node_search(const fg_node_t *n, int32_t id) {
+    int32_t lo = 0, hi = n->count - 1;
+    while (lo <= hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        if (n->ids[mid] == id) return mid;
+        if (n->ids[mid] < id) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -lo - 1;
+}
+
+static void node_add(fg_node_t *n, int32_t id) {
+    int32_t pos = node_search(n, id);
+    if (pos >= 0) return;
+    pos = -pos - 1;
+
+    if (n->count == n->cap) {
+        int32_t cap = n->cap ? n->cap * 2 : 8;
+        int32_t *ids = realloc(n->ids, sizeof(int32_t) * (size_t)cap);
+        if (!ids) {
+            printf("[FRIEND_GRAPH] ERROR: out of memory growing account %d\n", n->account_id);
+            return;
+        }
+        n->ids = ids;
+        n->cap = cap;
+    }
+    memmove(&n->ids[pos + 1], &n->ids[pos], sizeof(int32_t) * (size_t)(n->count - pos));
+    n->ids[pos] = id;
+    n->count++;
+}
+
+static void node_del(fg_node_t *n, int32_t id) {
+    int32_t pos = node_search(n, id);
+    if (pos < 0) return;
+    memmove(&n->ids[pos], &n->ids[pos + 1], sizeof(int32_t) * (size_t)(n->count - pos - 1));
+    n->count--;
+}
+
+static int cmp_id(const void *a, const void *b) {
+    int32_t x = *(const int32_t *)a;
+    int32_t y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Takes ownership of ids
+static fg_node_t* insert_node(int32_t account_id, int32_t *ids, int32_t count) {
+    fg_node_t *n = calloc(1, sizeof(*n));
+    if (!n) {
+        free(ids);
+        return NULL;
+    }
+
+    if (count > 0) {
+        qsort(ids, (size_t)count, sizeof(int32_t), cmp_id);
+        int32_t w = 0;
+        for (int32_t i = 0; i < count; i++) {
+            if (ids[i] <= 0 || ids[i] == account_id) continue;
+            if (w > 0 && ids[w - 1] == ids[i]) continue;
+            ids[w++] = ids[i];
+        }
+        count = w;
+    }
+
+    n->account_id = account_id;
+    n->ids = ids;
+    n->count = count;
+    n->cap = count;
+
+    if (g_loaded >= FRIEND_GRAPH_MAX_ACCOUNTS) evict_lru();
+
+    unsigned b = hash_id(account_id);
+    n->next = g_buckets[b];
+    g_buckets[b] = n;
+    lru_push_front(n);
+    g_loaded++;
+    return n;
+}
+
+// ============================================================================
+// LOADING
+// ============================================================================
+
+/**
+ * Return the node for account_id with g_lock held, loading it from the DB
+ * if needed. The query runs without the lock; if an edge changed meanwhile
+ * the result may be stale, so it is thrown away and fetched again.
+ */
+static db_error_t lock_loaded(int32_t account_id, fg_node_t **out_node) {
+    for (int attempt = 0; attempt < FG_LOAD_RETRIES; attempt++) {
+        pthread_mutex_lock(&g_lock);
+        fg_node_t *n = find_node(account_id);
+        if (n) {
+            touch(n);
+            *out_node = n;
+            return DB_SUCCESS;
+        }
+        uint64_t gen = g_generation;
+        pthread_mutex_unlock(&g_lock);
+
+        int32_t *ids = NULL;
+        int32_t count = 0;
+        db_error_t err = friend_list_get_ids(account_id, &ids, &count);
+        if (err != DB_SUCCESS) {
+            free(ids);
+            return err;
+        }
+
+        pthread_mutex_lock(&g_lock);
+        n = find_node(account_id);
+        if (n) {
+            free(ids);
+            touch(n);
+            *out_node = n;
+            return DB_SUCCESS;
+        }
+        if (g_generation == gen) {
+            n = insert_node(account_id, ids, count);
+            if (!n) {
+                pthread_mutex_unlock(&g_lock);
+                return DB_ERROR_INTERNAL;
+            }
+            *out_node = n;
+            return DB_SUCCESS;
+        }
+        pthread_mutex_unlock(&g_lock);
+        free(ids);
+    }
+
+    printf("[FRIEND_GRAPH] Account %d kept changing while loading\n", account_id);
+    return DB_ERROR_INTERNAL;
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+db_error_t friend_graph_get_ids(
+    int32_t account_id,
+    int32_t **out_friend_ids,
+    int32_t *out_count
+) {
+    if (account_id <= 0 || !out_friend_ids || !out_count) {
+        return DB_ERROR_INVALID_PARAM;
+    }
+
+    fg_node_t *n = NULL;
+    db_error_t err = lock_loaded(account_id, &n);
+    if (err != DB_SUCCESS) return err;
+
+    int32_t *ids = NULL;
+    if (n->count > 0) {
+        ids = malloc(sizeof(int32_t) * (size_t)n->count);
+        if (!ids) {
+            pthread_mutex_unlock(&g_lock);
+            return DB_ERROR_INTERNAL;
+        }
+        memcpy(ids, n->ids, sizeof(int32_t) * (size_t)n->count);
+    }
+    *out_friend_ids = ids;
+    *out_count = ids ? n->count : 0;
+    pthread_mutex_unlock(&g_lock);
+    return DB_SUCCESS;
+}
+
+db_error_t friend_graph_are_friends(
+    int32_t account_id_1,
+    int32_t account_id_2,
+    bool *out_are_friends
+) {
+    if (account_id_1 <= 0 || account_id_2 <= 0 || !out_are_friends) {
+        return DB_ERROR_INVALID_PARAM;
+    }
+
+    // Prefer whichever side is already in memory
+    pthread_mutex_lock(&g_lock);
+    fg_node_t *n = find_node(account_id_1);
+    int32_t other = account_id_2;
+    if (!n) {
+        n = find_node(account_id_2);
+        other = account_id_1;
+    }
+    if (n) {
+        touch(n);
+        *out_are_friends = node_search(n, other) >= 0;
+        pthread_mutex_unlock(&g_lock);
+        return DB_SUCCESS;
+    }
+    pthread_mutex_unlock(&g_lock);
+
+    db_error_t err = lock_loaded(account_id_1, &n);
+    if (err != DB_SUCCESS) return err;
+    *out_are_friends = node_search(n, account_id_2) >= 0;
+    pthread_mutex_unlock(&g_lock);
+    return DB_SUCCESS;
+}
+
+void friend_graph_add_edge(int32_t account_id_1, int32_t account_id_2) {
+    if (account_id_1 <= 0 || account_id_2 <= 0 || account_id_1 == account_id_2) return;
+
+    pthread_mutex_lock(&g_lock);
+    fg_node_t *a = find_node(account_id_1);
+    fg_node_t *b = find_node(account_id_2);
+    if (a) node_add(a, account_id_2);
+    if (b) node_add(b, account_id_1);
+    g_generation++;
+    pthread_mutex_unlock(&g_lock);
+}
+
+void friend_graph_remove_edge(int32_t account_id_1, int32_t account_id_2) {
+    if (account_id_1 <= 0 || account_id_2 <= 0) return;
+
+    pthread_mutex_lock(&g_lock);
+    fg_node_t *a = find_node(account_id_1);
+    fg_node_t *b = find_node(account_id_2);
+    if (a) node_del(a, account_id_2);
+    if (b) node_del(b, account_id_1);
+    g_generation++;
+    pthread_mutex_unlock(&g_lock);
+}
+
+void friend_graph_clear(void) {
+    pthread_mutex_lock(&g_lock);
+    for (int i = 0; i < FG_BUCKETS; i++) {
+        fg_node_t *n = g_buckets[i];
+        while (n) {
+            fg_node_t *next = n->next;
+            free(n->ids);
+            free(n);
+            n = next;
+        }
+        g_buckets[i] = NULL;
+    }
+    if (g_loaded > 0 || g_evicted > 0) {
+        printf("[FRIEND_GRAPH] Dropped %d loaded accounts (%llu evicted before)\n",
+               g_loaded, (unsigned long long)g_evicted);
+    }
+    g_loaded = 0;
+    g_evicted = 0;
+    g_lru_head = g_lru_tail = NULL;
+    g_generation++;
+    pthread_mutex_unlock(&g_lock);
+}
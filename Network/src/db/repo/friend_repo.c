@@ -5,6 +5,7 @@
 #include <cjson/cJSON.h>
 
 #include "db/repo/friend_repo.h"
+#include "db/repo/friend_graph.h"
 #include "db/core/db_client.h"
 
 // ============================================================================
@@ -262,8 +263,15 @@ db_error_t friend_request_accept(
     cJSON *insert_response = NULL;
     err = db_get(NULL, insert_query, &insert_response);
     if (insert_response) cJSON_Delete(insert_response);
+    if (err != DB_SUCCESS) {
+        printf("[FRIEND] WARN: Reverse friendship %d -> %d not written: %d\n",
+               addressee_id, requester_id, err);
+    }
 
     if (cJSON_IsArray(update_response) && cJSON_GetArraySize(update_response) > 0) {
+        // The request row is ACCEPTED: the friendship exists
+        friend_graph_add_edge(requester_id, addressee_id);
+
         cJSON *item = cJSON_GetArrayItem(update_response, 0);
         *out_request = parse_friend_request_from_json(item);
         cJSON_Delete(update_response);
@@ -444,24 +452,12 @@ db_error_t friend_check_relationship(
         return DB_ERROR_INVALID_PARAM;
     }
 
-    char query[256];
-    snprintf(query, sizeof(query), 
-        "SELECT id FROM friends WHERE requester_id = %d AND addressee_id = %d AND status = 'accepted' LIMIT 1",
-        user_id_1, user_id_2);
-
-    cJSON *response = NULL;
-    db_error_t err = db_get("friends", query, &response);
-
+    // Served from the in-memory friend graph (loads one side on first use)
+    db_error_t err = friend_graph_are_friends(user_id_1, user_id_2, out_are_friends);
     if (err != DB_SUCCESS) {
         *out_are_friends = false;
-        if (response) cJSON_Delete(response);
         return DB_SUCCESS; // Treat as "not friends" rather than error
     }
-
-    bool is_friends = cJSON_IsArray(response) && cJSON_GetArraySize(response) > 0;
-    cJSON_Delete(response);
-
-    *out_are_friends = is_friends;
     return DB_SUCCESS;
 }
 
@@ -493,6 +489,7 @@ db_error_t friend_remove(
                    (err2 == DB_SUCCESS || err2 == DB_ERROR_NOT_FOUND);
     
     if (both_ok) {
+        friend_graph_remove_edge(user_id_1, user_id_2);
         printf("[FRIEND] Successfully removed friendship both directions: %d <-> %d\n", user_id_1, user_id_2);
         return DB_SUCCESS;
     }
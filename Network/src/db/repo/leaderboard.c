@@ -0,0 +1,473 @@
+#include "db/repo/leaderboard.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <cjson/cJSON.h>
+
+#include "db/core/db_client.h"
+
+#define LB_MAX_LEVEL    24
+#define LB_BUCKETS      4096
+
+typedef struct lb_node lb_node_t;
+
+typedef struct {
+    lb_node_t *next;
+    int32_t span;               // entries skipped by this link (level-0 distance)
+} lb_link_t;
+
+struct lb_node {
+    int32_t account_id;
+    int32_t points;
+    int32_t wins;
+    int32_t matches;
+    char *name;
+    char *avatar;
+    lb_node_t *hash_next;       // account map chain
+    int level;
+    lb_link_t links[];          // `level` links
+};
+
+typedef struct {
+    uint64_t version;           // 0 = empty slot
+    int32_t offset;
+    int limit;
+    char *json;
+    size_t len;
+} lb_page_t;
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool g_ready;
+
+static lb_node_t *g_head;       // sentinel with LB_MAX_LEVEL links
+static int g_level = 1;
+static int32_t g_length;
+static uint32_t g_rng = 2463534242u;
+
+static lb_node_t *g_buckets[LB_BUCKETS];
+
+static uint64_t g_version = 1;  // bumped on every visible change
+static lb_page_t g_pages[LEADERBOARD_PAGE_SLOTS];
+static int g_page_next;
+
+//==============================================================================
+// SKIP LIST (caller holds g_lock)
+//==============================================================================
+
+static unsigned hash_id(int32_t id) {
+    return ((uint32_t)id * 2654435761u) % LB_BUCKETS;
+}
+
+static lb_node_t *find_node(int32_t account_id) {
+    for (lb_node_t *n = g_buckets[hash_id(account_id)]; n; n = n->hash_next) {
+        if (n->account_id == account_id) return n;
+    }
+    return NULL;
+}
+
+// Rank order: more points first, lower account id breaks ties
+static bool ranks_before(const lb_node_t *a, const lb_node_t *b) {
+    if (a->points != b->points) return a->points > b->points;
+    return a->account_id < b->account_id;
+}
+
+static int random_level(void) {
+    int level = 1;
+    for (;;) {
+        g_rng ^= g_rng << 13;
+        g_rng ^= g_rng >> 17;
+        g_rng ^= g_rng << 5;
+        if ((g_rng & 3) != 0 || level >= LB_MAX_LEVEL) break;  // p = 1/4
+        level++;
+    }
+    return level;
+}
+
+static bool ensure_head(void) {
+    if (g_head) return true;
+    g_head = calloc(1, sizeof(lb_node_t) + sizeof(lb_link_t) * LB_MAX_LEVEL);
+    if (!g_head) return false;
+    g_head->level = LB_MAX_LEVEL;
+    return true;
+}
+
+// Link a node whose level is already set
+static void list_insert(lb_node_t *node) {
+    lb_node_t *update[LB_MAX_LEVEL];
+    int32_t rank[LB_MAX_LEVEL];
+
+    lb_node_t *x = g_head;
+    for (int i = g_level - 1; i >= 0; i--) {
+        rank[i] = (i == g_level - 1) ? 0 : rank[i + 1];
+        while (x->links[i].next && ranks_before(x->links[i].next, node)) {
+            rank[i] += x->links[i].span;
+            x = x->links[i].next;
+        }
+        update[i] = x;
+    }
+
+    if (node->level > g_level) {
+        for (int i = g_level; i < node->level; i++) {
+            rank[i] = 0;
+            update[i] = g_head;
+            g_head->links[i].span = g_length;
+        }
+        g_level = node->level;
+    }
+
+    for (int i = 0; i < node->level; i++) {
+        node->links[i].next = update[i]->links[i].next;
+        update[i]->links[i].next = node;
+        node->links[i].span = update[i]->links[i].span - (rank[0] - rank[i]);
+        update[i]->links[i].span = (rank[0] - rank[i]) + 1;
+    }
+    for (int i = node->level; i < g_level; i++) {
+        update[i]->links[i].span++;
+    }
+    g_length++;
+}
+
+static void list_remove(lb_node_t *node) {
+    lb_node_t *update[LB_MAX_LEVEL];
+
+    lb_node_t *x = g_head;
+    for (int i = g_level - 1; i >= 0; i--) {
+        while (x->links[i].next && ranks_before(x->links[i].next, node)) {
+            x = x->links[i].next;
+        }
+        update[i] = x;
+    }
+
+    for (int i = 0; i < g_level; i++) {
+        if (update[i]->links[i].next == node) {
+            update[i]->links[i].span += node->links[i].span - 1;
+            update[i]->links[i].next = node->links[i].next;
+        } else {
+            update[i]->links[i].span--;
+        }
+    }
+    while (g_level > 1 && !g_head->links[g_level - 1].next) {
+        g_level--;
+    }
+    g_length--;
+}
+
+static int32_t list_rank(const lb_node_t *node) {
+    int32_t rank = 0;
+    lb_node_t *x = g_head;
+    for (int i = g_level - 1; i >= 0; i--) {
+        while (x->links[i].next &&
+               (x->links[i].next == node || ranks_before(x->links[i].next, node))) {
+            rank += x->links[i].span;
+            x = x->links[i].next;
+        }
+        if (x == node) return rank;
+    }
+    return 0;
+}
+
+// Node at 1-based rank, NULL if out of range
+static lb_node_t *list_at(int32_t rank) {
+    if (rank <= 0 || rank > g_length) return NULL;
+    int32_t traversed = 0;
+    lb_node_t *x = g_head;
+    for (int i = g_level - 1; i >= 0; i--) {
+        while (x->links[i].next && traversed + x->links[i].span <= rank) {
+            traversed += x->links[i].span;
+            x = x->links[i].next;
+        }
+        if (traversed == rank) return x;
+    }
+    return NULL;
+}
+
+static void set_str(char **dst, const char *src) {
+    if (src && *dst && strcmp(*dst, src) == 0) return;
+    free(*dst);
+    *dst = (src && *src) ? strdup(src) : NULL;
+}
+
+static lb_node_t *node_new(int32_t account_id) {
+    if (!ensure_head()) return NULL;
+    int level = random_level();
+    lb_node_t *n = calloc(1, sizeof(lb_node_t) + sizeof(lb_link_t) * (size_t)level);
+    if (!n) {
+        printf("[LEADERBOARD] ERROR: out of memory adding account %d\n", account_id);
+        return NULL;
+    }
+    n->account_id = account_id;
+    n->level = level;
+
+    unsigned b = hash_id(account_id);
+    n->hash_next = g_buckets[b];
+    g_buckets[b] = n;
+    list_insert(n);
+    return n;
+}
+
+// Re-rank after a points change (the node keeps its level)
+static void node_set_points(lb_node_t *n, int32_t points) {
+    if (points == n->points) return;
+    list_remove(n);
+    n->points = points;
+    list_insert(n);
+}
+
+//==============================================================================
+// SERIALIZATION (caller holds g_lock)
+//==============================================================================
+
+static char *render_range(lb_node_t *first, int32_t first_rank, int count, size_t *out_len) {
+    cJSON *arr = cJSON_CreateArray();
+    if (!arr) return NULL;
+
+    lb_node_t *n = first;
+    for (int i = 0; n && i < count; i++, n = n->links[0].next) {
+        cJSON *o = cJSON_CreateObject();
+        if (!o) break;
+        cJSON_AddNumberToObject(o, "rank", first_rank + i);
+        cJSON_AddNumberToObject(o, "account_id", n->account_id);
+        if (n->name) cJSON_AddStringToObject(o, "name", n->name);
+        else cJSON_AddNullToObject(o, "name");
+        if (n->avatar) cJSON_AddStringToObject(o, "avatar", n->avatar);
+        else cJSON_AddNullToObject(o, "avatar");
+        cJSON_AddNumberToObject(o, "points", n->points);
+        cJSON_AddNumberToObject(o, "wins", n->wins);
+        cJSON_AddNumberToObject(o, "matches", n->matches);
+        cJSON_AddItemToArray(arr, o);
+    }
+
+    char *json = cJSON_PrintUnformatted(arr);
+    cJSON_Delete(arr);
+    if (json && out_len) *out_len = strlen(json);
+    return json;
+}
+
+static char *dup_buf(const char *src, size_t len) {
+    char *out = malloc(len + 1);
+    if (!out) return NULL;
+    memcpy(out, src, len);
+    out[len] = '\0';
+    return out;
+}
+
+//==============================================================================
+// LOADING
+//==============================================================================
+
+static int row_int(cJSON *row, const char *key) {
+    cJSON *v = cJSON_GetObjectItem(row, key);
+    return cJSON_IsNumber(v) ? v->valueint : 0;
+}
+
+static const char *row_string(cJSON *row, const char *key) {
+    cJSON *v = cJSON_GetObjectItem(row, key);
+    return cJSON_IsString(v) ? v->valuestring : NULL;
+}
+
+int leaderboard_preload(void) {
+    cJSON *profiles = NULL;
+    db_error_t err = db_get("profiles",
+        "SELECT account_id, name, avatar, points, wins, matches FROM profiles", &profiles);
+    if (err != DB_OK || !cJSON_IsArray(profiles)) {
+        printf("[LEADERBOARD] Preload failed (rc=%d), leaderboard empty\n", err);
+        if (profiles) cJSON_Delete(profiles);
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_lock);
+    cJSON *row = NULL;
+    cJSON_ArrayForEach(row, profiles) {
+        int id = row_int(row, "account_id");
+        if (id <= 0) continue;
+        lb_node_t *n = find_node(id);
+        if (!n && !(n = node_new(id))) continue;
+        set_str(&n->name, row_string(row, "name"));
+        set_str(&n->avatar, row_string(row, "avatar"));
+        n->wins = row_int(row, "wins");
+        n->matches = row_int(row, "matches");
+        node_set_points(n, row_int(row, "points"));
+    }
+    g_version++;
+    g_ready = true;
+    printf("[LEADERBOARD] Loaded %d players (skip list level %d)\n", g_length, g_level);
+    pthread_mutex_unlock(&g_lock);
+
+    cJSON_Delete(profiles);
+    return 0;
+}
+
+bool leaderboard_ready(void) {
+    pthread_mutex_lock(&g_lock);
+    bool ready = g_ready;
+    pthread_mutex_unlock(&g_lock);
+    return ready;
+}
+
+//==============================================================================
+// UPDATES
+//==============================================================================
+
+// Before the preload lands, updates are dropped: the preload reads the
+// totals the write queue has already persisted.
+
+void leaderboard_put_profile(int32_t account_id, const char *name, const char *avatar) {
+    if (account_id <= 0) return;
+    pthread_mutex_lock(&g_lock);
+    if (g_ready) {
+        lb_node_t *n = find_node(account_id);
+        if (!n) n = node_new(account_id);
+        if (n) {
+            set_str(&n->name, name);
+            set_str(&n->avatar, avatar);
+            g_version++;
+        }
+    }
+    pthread_mutex_unlock(&g_lock);
+}
+
+void leaderboard_record_result(int32_t account_id, int32_t points_delta, bool won) {
+    if (account_id <= 0) return;
+    pthread_mutex_lock(&g_lock);
+    if (g_ready) {
+        lb_node_t *n = find_node(account_id);
+        if (!n) n = node_new(account_id);
+        if (n) {
+            int64_t points = (int64_t)n->points + points_delta;
+            if (points < 0) points = 0;
+            if (points > INT32_MAX) points = INT32_MAX;
+            n->matches++;
+            if (won) n->wins++;
+            node_set_points(n, (int32_t)points);
+            g_version++;
+        }
+    }
+    pthread_mutex_unlock(&g_lock);
+}
+
+//==============================================================================
+// QUERIES
+//==============================================================================
+
+bool leaderboard_get(int32_t account_id, leaderboard_entry_t *out) {
+    if (account_id <= 0 || !out) return false;
+    pthread_mutex_lock(&g_lock);
+    lb_node_t *n = find_node(account_id);
+    if (n) {
+        out->rank = list_rank(n);
+        out->account_id = n->account_id;
+        out->points = n->points;
+        out->wins = n->wins;
+        out->matches = n->matches;
+    }
+    pthread_mutex_unlock(&g_lock);
+    return n != NULL;
+}
+
+int32_t leaderboard_size(void) {
+    pthread_mutex_lock(&g_lock);
+    int32_t size = g_length;
+    pthread_mutex_unlock(&g_lock);
+    return size;
+}
+
+char* leaderboard_page(int32_t offset, int limit, uint64_t *out_version, size_t *out_len) {
+    if (offset < 0) offset = 0;
+    if (limit <= 0) limit = LEADERBOARD_DEFAULT_LIMIT;
+    if (limit > LEADERBOARD_MAX_LIMIT) limit = LEADERBOARD_MAX_LIMIT;
+
+    pthread_mutex_lock(&g_lock);
+    uint64_t version = g_version;
+    // Every offset past the end is the same empty page (and offset + 1 stays in range)
+    if (offset > g_length) offset = g_length;
+
+    lb_page_t *slot = NULL;
+    for (int i = 0; i < LEADERBOARD_PAGE_SLOTS; i++) {
+        lb_page_t *p = &g_pages[i];
+        if (p->version == version && p->offset == offset && p->limit == limit) {
+            slot = p;
+            break;
+        }
+    }
+
+    if (!slot) {
+        size_t len = 0;
+        char *json = render_range(list_at(offset + 1), offset + 1, limit, &len);
+        if (!json) {
+            pthread_mutex_unlock(&g_lock);
+            return NULL;
+        }
+
+        // Prefer a stale slot, otherwise round-robin
+        for (int i = 0; i < LEADERBOARD_PAGE_SLOTS && !slot; i++) {
+            if (g_pages[i].version != version) slot = &g_pages[i];
+        }
+        if (!slot) {
+            slot = &g_pages[g_page_next];
+            g_page_next = (g_page_next + 1) % LEADERBOARD_PAGE_SLOTS;
+        }
+        free(slot->json);
+        slot->version = version;
+        slot->offset = offset;
+        slot->limit = limit;
+        slot->json = json;
+        slot->len = len;
+    }
+
+    char *out = dup_buf(slot->json, slot->len);
+    if (out) {
+        if (out_version) *out_version = version;
+        if (out_len) *out_len = slot->len;
+    }
+    pthread_mutex_unlock(&g_lock);
+    return out;
+}
+
+char* leaderboard_around(int32_t account_id, int radius, uint64_t *out_version, size_t *out_len) {
+    if (radius < 0) radius = 0;
+    if (radius > LEADERBOARD_MAX_LIMIT / 2) radius = LEADERBOARD_MAX_LIMIT / 2;
+
+    pthread_mutex_lock(&g_lock);
+    lb_node_t *n = account_id > 0 ? find_node(account_id) : NULL;
+    char *json = NULL;
+    if (n) {
+        int32_t rank = list_rank(n);
+        int32_t first = rank - radius;
+        if (first < 1) first = 1;
+        json = render_range(list_at(first), first, (int)(rank - first) + radius + 1, out_len);
+    } else {
+        json = render_range(NULL, 0, 0, out_len);
+    }
+    if (json && out_version) *out_version = g_version;
+    pthread_mutex_unlock(&g_lock);
+    return json;
+}
+
+void leaderboard_cleanup(void) {
+    pthread_mutex_lock(&g_lock);
+    for (int i = 0; i < LB_BUCKETS; i++) {
+        lb_node_t *n = g_buckets[i];
+        while (n) {
+            lb_node_t *next = n->hash_next;
+            free(n->name);
+            free(n->avatar);
+            free(n);
+            n = next;
+        }
+        g_buckets[i] = NULL;
+    }
+    for (int i = 0; i < LEADERBOARD_PAGE_SLOTS; i++) {
+        free(g_pages[i].json);
+        g_pages[i].json = NULL;
+        g_pages[i].version = 0;
+    }
+    free(g_head);
+    g_head = NULL;
+    g_level = 1;
+    g_length = 0;
+    g_ready = false;
+    g_version++;
+    pthread_mutex_unlock(&g_lock);
+}
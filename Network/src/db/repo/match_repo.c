@@ -357,7 +357,7 @@ db_error_t db_match_get_detail(
     // Note: This is simplified - full implementation would need multiple queries or CTEs
     char query[2048];
     snprintf(query, sizeof(query), 
-        "SELECT m.id, m.mode, m.max_players as player_count "
+        "SELECT m.id, m.mode, m.max_players as player_count, m.ended_at "
         "FROM matches m "
         "WHERE m.id = %u",
         match_id
@@ -396,6 +396,10 @@ db_error_t db_match_get_detail(
     cJSON *player_count = cJSON_GetObjectItem(match_obj, "player_count");
     cJSON_AddNumberToObject(root, "playerCount", player_count ? player_count->valueint : 0);
 
+    // Finished matches never change again (replay_cache relies on this)
+    cJSON *ended_at = cJSON_GetObjectItem(match_obj, "ended_at");
+    cJSON_AddBoolToObject(root, "finished", ended_at && !cJSON_IsNull(ended_at));
+
     // 1. Build Player Map (All participants)
     typedef struct {
         int id; // match_players.id
@@ -0,0 +1,878 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "db/repo/match_write_queue.h"
+#include "db/core/db_client.h"
+#include "db/repo/replay_cache.h"
+
+//==============================================================================
+// TYPES
+//==============================================================================
+
+typedef enum {
+    MWQ_ANSWER = 0,
+    MWQ_EVENT,
+    MWQ_PLAYER,
+    MWQ_PROFILE,
+    MWQ_MATCH_END,
+    MWQ_QUESTION
+} mwq_kind_t;
+
+typedef struct mwq_record {
+    mwq_kind_t kind;
+    struct mwq_record *next;
+
+    double created_at;      // wall clock (epoch seconds, ms precision)
+    int64_t ref_id;         // question_id | match_player_id | match id
+    int32_t player_id;      // ANSWER: match_players.id, EVENT / PROFILE: accounts.id
+    int value;              // ANSWER: score_delta, PLAYER: score, PROFILE: points delta
+    int round_no;           // EVENT, QUESTION
+    int index;              // ANSWER: action_idx, EVENT / QUESTION: question_idx
+    unsigned fields;        // PLAYER: MWQ_SET_* mask
+    bool eliminated;
+    bool winner;            // PLAYER, PROFILE
+    char *text;             // ANSWER: answer json, EVENT: event_type, QUESTION: question json
+    char label[16];         // QUESTION: round_type
+} mwq_record_t;
+
+// One match_wq_flush() call waiting for its barrier
+typedef struct mwq_flush {
+    struct mwq_flush *next;
+    int64_t db_match_id;
+    uint64_t target;        // bucket->completed to reach
+    int64_t deadline_ms;
+    db_error_t result;
+    int left;               // records still pending when it fired
+    match_wq_flush_cb cb;
+    void *arg;
+} mwq_flush_t;
+
+typedef struct mwq_bucket {
+    int64_t db_match_id;
+    mwq_record_t *head;
+    mwq_record_t *tail;
+    int count;
+
+    uint64_t enqueued;      // records accepted (merged updates not counted)
+    uint64_t completed;     // records persisted or dead-lettered
+
+    int attempts;
+    int inflight;
+    mwq_flush_t *flushes;   // barriers not reached yet
+    int flush_requested;
+    int64_t first_at_ms;
+    int64_t retry_at_ms;
+
+    struct mwq_bucket *next;
+} mwq_bucket_t;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;
+    pthread_t thread;
+    int started;
+    int running;
+    int pending;
+    uint64_t skipped;       // records refused for lack of a DB id
+    mwq_bucket_t *buckets;
+} g_wq = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+//==============================================================================
+// HELPERS: skipped records
+//==============================================================================
+
+// A record whose match or player row was never created cannot be written
+static void skip_record(const char *what, int64_t db_match_id, int64_t id) {
+    pthread_mutex_lock(&g_wq.lock);
+    uint64_t n = ++g_wq.skipped;
+    pthread_mutex_unlock(&g_wq.lock);
+    printf("[MATCH_WQ] WARN: Skipped %s: match=%lld id=%lld (no DB row, %llu skipped)\n",
+           what, (long long)db_match_id, (long long)id, (unsigned long long)n);
+}
+
+//==============================================================================
+// HELPERS: time
+//==============================================================================
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static double wall_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (double)ts.tv_sec + (double)(ts.tv_nsec / 1000000) / 1000.0;
+}
+
+// Wait on a CLOCK_MONOTONIC condition variable until deadline_ms
+static int cond_wait_until(pthread_cond_t *cond, int64_t deadline_ms) {
+    struct timespec ts;
+    ts.tv_sec = deadline_ms / 1000;
+    ts.tv_nsec = (deadline_ms % 1000) * 1000000;
+    return pthread_cond_timedwait(cond, &g_wq.lock, &ts);
+}
+
+//==============================================================================
+// HELPERS: string builder
+//==============================================================================
+
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t cap;
+    int oom;
+} sql_buf_t;
+
+static void sb_reserve(sql_buf_t *sb, size_t extra) {
+    if (sb->oom || sb->len + extra + 1 <= sb->cap) return;
+    size_t cap = sb->cap ? sb->cap : 1024;
+    while (sb->len + extra + 1 > cap) cap *= 2;
+    char *p = realloc(sb->buf, cap);
+    if (!p) {
+        sb->oom = 1;
+        return;
+    }
+    sb->buf = p;
+    sb->cap = cap;
+}
+
+static void sb_appendf(sql_buf_t *sb, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(NULL, 0, fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+
+    sb_reserve(sb, (size_t)n);
+    if (sb->oom) return;
+
+    va_start(ap, fmt);
+    vsnprintf(sb->buf + sb->len, sb->cap - sb->len, fmt, ap);
+    va_end(ap);
+    sb->len += (size_t)n;
+}
+
+// Append a single-quoted SQL literal, doubling embedded quotes
+static void sb_append_literal(sql_buf_t *sb, const char *s) {
+    size_t n = strlen(s);
+    sb_reserve(sb, n * 2 + 2);
+    if (sb->oom) return;
+
+    sb->buf[sb->len++] = '\'';
+    for (size_t i = 0; i < n; i++) {
+        if (s[i] == '\'') sb->buf[sb->len++] = '\'';
+        sb->buf[sb->len++] = s[i];
+    }
+    sb->buf[sb->len++] = '\'';
+    sb->buf[sb->len] = '\0';
+}
+
+//==============================================================================
+// HELPERS: records / buckets (caller holds g_wq.lock)
+//==============================================================================
+
+static void record_free(mwq_record_t *r) {
+    if (!r) return;
+    free(r->text);
+    free(r);
+}
+
+static void record_list_free(mwq_record_t *r) {
+    while (r) {
+        mwq_record_t *next = r->next;
+        record_free(r);
+        r = next;
+    }
+}
+
+static mwq_bucket_t *find_bucket(int64_t db_match_id) {
+    for (mwq_bucket_t *b = g_wq.buckets; b; b = b->next) {
+        if (b->db_match_id == db_match_id) return b;
+    }
+    return NULL;
+}
+
+static mwq_bucket_t *get_or_create_bucket(int64_t db_match_id) {
+    mwq_bucket_t *b = find_bucket(db_match_id);
+    if (b) return b;
+
+    b = calloc(1, sizeof(*b));
+    if (!b) return NULL;
+    b->db_match_id = db_match_id;
+    b->next = g_wq.buckets;
+    g_wq.buckets = b;
+    return b;
+}
+
+// Free bucket once nothing references it anymore
+static void release_bucket_if_idle(mwq_bucket_t *b) {
+    if (b->count > 0 || b->inflight || b->flushes) return;
+
+    mwq_bucket_t **pp = &g_wq.buckets;
+    while (*pp && *pp != b) pp = &(*pp)->next;
+    if (*pp) *pp = b->next;
+    free(b);
+}
+
+//==============================================================================
+// SQL BUILDING
+//==============================================================================
+
+// Build one multi-statement batch. libpq runs a multi-statement PQexec
+// string as a single implicit transaction, so a batch lands all-or-nothing.
+static char *build_batch_sql(mwq_record_t *list) {
+    sql_buf_t sb = {0};
+    int n;
+
+    // --- match_question (bonus rounds; the regular ones are written at start) ---
+    n = 0;
+    for (mwq_record_t *r = list; r; r = r->next) {
+        if (r->kind != MWQ_QUESTION) continue;
+        sb_appendf(&sb, n == 0
+            ? "INSERT INTO match_question (match_id, round_no, round_type, question_idx, question, created_at) VALUES "
+            : ", ");
+        sb_appendf(&sb, "(%lld, %d, ", (long long)r->ref_id, r->round_no);
+        sb_append_literal(&sb, r->label);
+        sb_appendf(&sb, ", %d, ", r->index);
+        sb_append_literal(&sb, r->text ? r->text : "{}");
+        sb_appendf(&sb, "::jsonb, to_timestamp(%.3f)::timestamp)", r->created_at);
+        n++;
+    }
+    if (n > 0) sb_appendf(&sb, " ON CONFLICT (match_id, round_no, question_idx) DO NOTHING;");
+
+    // --- match_answer ---
+    n = 0;
+    for (mwq_record_t *r = list; r; r = r->next) {
+        if (r->kind != MWQ_ANSWER) continue;
+        sb_appendf(&sb, n == 0
+            ? "INSERT INTO match_answer (question_id, player_id, answer, score_delta, action_idx, created_at) VALUES "
+            : ", ");
+        sb_appendf(&sb, "(%lld, %d, ", (long long)r->ref_id, r->player_id);
+        if (r->text) {
+            sb_append_literal(&sb, r->text);
+            sb_appendf(&sb, "::jsonb");
+        } else {
+            sb_appendf(&sb, "NULL");
+        }
+        sb_appendf(&sb, ", %d, %d, to_timestamp(%.3f)::timestamp)",
+                   r->value, r->index > 0 ? r->index : 1, r->created_at);
+        n++;
+    }
+    // Retries after an ambiguous commit must not trip the unique key
+    if (n > 0) sb_appendf(&sb, " ON CONFLICT (question_id, player_id, action_idx) DO NOTHING;");
+
+    // --- match_events ---
+    n = 0;
+    for (mwq_record_t *r = list; r; r = r->next) {
+        if (r->kind != MWQ_EVENT) continue;
+        sb_appendf(&sb, n == 0
+            ? "INSERT INTO match_events (match_id, player_id, event_type, round_no, question_idx, created_at) VALUES "
+            : ", ");
+        sb_appendf(&sb, "(%lld, ", (long long)r->ref_id);
+        if (r->player_id > 0) sb_appendf(&sb, "%d, ", r->player_id);
+        else sb_appendf(&sb, "NULL, ");
+        sb_append_literal(&sb, r->text ? r->text : "");
+        if (r->round_no > 0) sb_appendf(&sb, ", %d", r->round_no);
+        else sb_appendf(&sb, ", NULL");
+        if (r->index >= 0) sb_appendf(&sb, ", %d", r->index);
+        else sb_appendf(&sb, ", NULL");
+        sb_appendf(&sb, ", to_timestamp(%.3f)::timestamp)", r->created_at);
+        n++;
+    }
+    if (n > 0) sb_appendf(&sb, ";");
+
+    // --- match_players (merge duplicates: later values win) ---
+    mwq_record_t *merged[MATCH_WQ_BATCH_MAX];
+    mwq_record_t slots[MATCH_WQ_BATCH_MAX];
+    int m = 0;
+    for (mwq_record_t *r = list; r; r = r->next) {
+        if (r->kind != MWQ_PLAYER) continue;
+        int j;
+        for (j = 0; j < m; j++) {
+            if (merged[j]->ref_id == r->ref_id) break;
+        }
+        if (j == m) {
+            if (m >= (int)(sizeof(slots) / sizeof(slots[0]))) break;
+            slots[m] = *r;
+            slots[m].fields = 0;
+            merged[m] = &slots[m];
+            m++;
+        }
+        if (r->fields & MWQ_SET_SCORE) merged[j]->value = r->value;
+        if (r->fields & MWQ_SET_ELIMINATED) merged[j]->eliminated = r->eliminated;
+        if (r->fields & MWQ_SET_WINNER) merged[j]->winner = r->winner;
+        merged[j]->fields |= r->fields;
+    }
+    for (int j = 0; j < m; j++) {
+        mwq_record_t *r = merged[j];
+        sb_appendf(&sb, j == 0
+            ? "UPDATE match_players AS mp SET "
+              "score = COALESCE(v.score, mp.score), "
+              "eliminated = COALESCE(v.eliminated, mp.eliminated), "
+              "winner = COALESCE(v.winner, mp.winner) FROM (VALUES "
+            : ", ");
+        sb_appendf(&sb, "(%lld", (long long)r->ref_id);
+        if (r->fields & MWQ_SET_SCORE) sb_appendf(&sb, ", %d::int", r->value);
+        else sb_appendf(&sb, ", NULL::int");
+        if (r->fields & MWQ_SET_ELIMINATED) sb_appendf(&sb, ", %s::boolean", r->eliminated ? "TRUE" : "FALSE");
+        else sb_appendf(&sb, ", NULL::boolean");
+        if (r->fields & MWQ_SET_WINNER) sb_appendf(&sb, ", %s::boolean)", r->winner ? "TRUE" : "FALSE");
+        else sb_appendf(&sb, ", NULL::boolean)");
+    }
+    if (m > 0) sb_appendf(&sb, ") AS v(id, score, eliminated, winner) WHERE mp.id = v.id;");
+
+    // --- profiles totals ---
+    // Must stay ahead of matches.ended_at: the guard makes a retry of a batch
+    // that already committed a no-op instead of counting the match twice
+    for (mwq_record_t *r = list; r; r = r->next) {
+        if (r->kind != MWQ_PROFILE) continue;
+        sb_appendf(&sb, "UPDATE profiles SET points = GREATEST(points + %d, 0), "
+                        "wins = wins + %d, matches = matches + 1, updated_at = NOW() "
+                        "WHERE account_id = %d AND EXISTS "
+                        "(SELECT 1 FROM matches WHERE id = %lld AND ended_at IS NULL);",
+                   r->value, r->winner ? 1 : 0, r->player_id, (long long)r->ref_id);
+    }
+
+    // --- matches.ended_at ---
+    for (mwq_record_t *r = list; r; r = r->next) {
+        if (r->kind != MWQ_MATCH_END) continue;
+        sb_appendf(&sb, "UPDATE matches SET ended_at = to_timestamp(%.3f)::timestamp WHERE id = %lld;",
+                   r->created_at, (long long)r->ref_id);
+    }
+
+    if (sb.oom) {
+        free(sb.buf);
+        return NULL;
+    }
+    return sb.buf;
+}
+
+static void write_deadletter(int64_t db_match_id, int count, const char *sql) {
+    const char *path = getenv(ENV_MATCH_WQ_DEADLETTER);
+    if (!path || !*path) path = MATCH_WQ_DEADLETTER_DEFAULT;
+
+    FILE *f = fopen(path, "a");
+    if (!f) {
+        printf("[MATCH_WQ] Dead-letter open failed (%s): %d records of match %lld LOST\n",
+               path, count, (long long)db_match_id);
+        return;
+    }
+    fprintf(f, "-- match %lld, %d records\n%s\n", (long long)db_match_id, count, sql ? sql : "");
+    fclose(f);
+    printf("[MATCH_WQ] Dead-lettered %d records of match %lld to %s\n",
+           count, (long long)db_match_id, path);
+}
+
+// Persist a record list inline (queue not started)
+static void persist_now(int64_t db_match_id, mwq_record_t *list) {
+    char *sql = build_batch_sql(list);
+    if (!sql || !*sql || db_get("match_write_queue", sql, NULL) != DB_OK) {
+        printf("[MATCH_WQ] Inline write failed for match %lld\n", (long long)db_match_id);
+    }
+    free(sql);
+    record_list_free(list);
+}
+
+//==============================================================================
+// WORKER
+//==============================================================================
+
+static mwq_bucket_t *pick_ready_bucket(int64_t now, int64_t *next_wake) {
+    for (mwq_bucket_t *b = g_wq.buckets; b; b = b->next) {
+        if (b->count == 0 || b->inflight) continue;
+
+        if (b->retry_at_ms > now) {
+            if (b->retry_at_ms < *next_wake) *next_wake = b->retry_at_ms;
+            continue;
+        }
+
+        int64_t due = b->first_at_ms + MATCH_WQ_LINGER_MS;
+        if (!g_wq.running || b->flush_requested ||
+            b->count >= MATCH_WQ_BATCH_MAX || due <= now) {
+            return b;
+        }
+        if (due < *next_wake) *next_wake = due;
+    }
+    return NULL;
+}
+
+// Unlink the barriers that were reached or ran out of time into *done
+static void take_due_flushes(int64_t now, int64_t *next_wake, mwq_flush_t **done) {
+    mwq_bucket_t *b = g_wq.buckets;
+    while (b) {
+        mwq_bucket_t *next_bucket = b->next;
+        mwq_flush_t **pp = &b->flushes;
+        while (*pp) {
+            mwq_flush_t *f = *pp;
+            if (b->completed >= f->target) {
+                f->result = DB_OK;
+            } else if (f->deadline_ms <= now) {
+                f->result = DB_ERR_TIMEOUT;
+            } else {
+                if (f->deadline_ms < *next_wake) *next_wake = f->deadline_ms;
+                pp = &f->next;
+                continue;
+            }
+            f->left = (int)(b->enqueued - b->completed);
+            *pp = f->next;
+            f->next = *done;
+            *done = f;
+        }
+        release_bucket_if_idle(b);
+        b = next_bucket;
+    }
+}
+
+// A match is final once its end record is committed: cache the replay
+// here, off the gameplay threads (called without g_wq.lock)
+static void warm_finished_matches(const mwq_record_t *batch) {
+    for (const mwq_record_t *r = batch; r; r = r->next) {
+        if (r->kind == MWQ_MATCH_END) replay_cache_warm((uint32_t)r->ref_id);
+    }
+}
+
+// Called without g_wq.lock
+static void run_flush_callbacks(mwq_flush_t *done) {
+    while (done) {
+        mwq_flush_t *next = done->next;
+        if (done->result == DB_OK) {
+            printf("[MATCH_WQ] Flush barrier reached for match %lld\n", (long long)done->db_match_id);
+        } else {
+            printf("[MATCH_WQ] Flush barrier timed out for match %lld (%d records pending)\n",
+                   (long long)done->db_match_id, done->left);
+        }
+        if (done->cb) done->cb(done->db_match_id, done->result, done->arg);
+        free(done);
+        done = next;
+    }
+}
+
+static void *writer_thread(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&g_wq.lock);
+    for (;;) {
+        // Read outside g_wq.lock: a backend stuck in a query must not hold
+        // up the shards enqueuing records
+        pthread_mutex_unlock(&g_wq.lock);
+        bool db_up = db_is_available();
+        pthread_mutex_lock(&g_wq.lock);
+
+        int64_t now = now_ms();
+        int64_t next_wake = now + MATCH_WQ_LINGER_MS;
+
+        mwq_flush_t *done = NULL;
+        take_due_flushes(now, &next_wake, &done);
+        if (done) {
+            pthread_mutex_unlock(&g_wq.lock);
+            run_flush_callbacks(done);
+            pthread_mutex_lock(&g_wq.lock);
+            continue;
+        }
+
+        mwq_bucket_t *b = pick_ready_bucket(now, &next_wake);
+
+        if (!b) {
+            if (!g_wq.running && g_wq.pending == 0) break;
+            cond_wait_until(&g_wq.work_cond, next_wake);
+            continue;
+        }
+
+        // Degraded mode: hold everything in memory until the link is back
+        // (on shutdown, fall through so the batch ends up dead-lettered)
+        if (g_wq.running && !db_up) {
+            cond_wait_until(&g_wq.work_cond, now + MATCH_WQ_OUTAGE_POLL_MS);
+            continue;
+        }
+
+        // Detach up to one batch
+        mwq_record_t *batch = b->head;
+        mwq_record_t *last = batch;
+        int n = 1;
+        while (last->next && n < MATCH_WQ_BATCH_MAX) {
+            last = last->next;
+            n++;
+        }
+        b->head = last->next;
+        if (!b->head) b->tail = NULL;
+        last->next = NULL;
+        b->count -= n;
+        b->inflight = 1;
+        if (b->count == 0) b->flush_requested = 0;
+        int64_t db_match_id = b->db_match_id;
+
+        pthread_mutex_unlock(&g_wq.lock);
+
+        char *sql = build_batch_sql(batch);
+        db_error_t err = sql ? db_get("match_write_queue", sql, NULL) : DB_ERROR_INTERNAL;
+        if (err == DB_OK) warm_finished_matches(batch);
+
+        pthread_mutex_lock(&g_wq.lock);
+        b->inflight = 0;
+
+        if (err == DB_OK) {
+            b->attempts = 0;
+            b->retry_at_ms = 0;
+            b->completed += (uint64_t)n;
+            g_wq.pending -= n;
+            record_list_free(batch);
+        } else {
+            // An outage is not the batch's fault: keep it without burning attempts
+            if (err != DB_ERR_UNAVAILABLE || !g_wq.running) b->attempts++;
+            int max_attempts = g_wq.running ? MATCH_WQ_MAX_ATTEMPTS : 2;
+
+            if (b->attempts >= max_attempts) {
+                write_deadletter(db_match_id, n, sql);
+                b->attempts = 0;
+                b->retry_at_ms = 0;
+                b->completed += (uint64_t)n;
+                g_wq.pending -= n;
+                record_list_free(batch);
+            } else {
+                // Put the batch back in front to keep ordering
+                last->next = b->head;
+                b->head = batch;
+                if (!b->tail) b->tail = last;
+                b->count += n;
+
+                int shift = b->attempts > 0 ? b->attempts - 1 : 0;
+                int64_t backoff = (int64_t)MATCH_WQ_RETRY_BASE_MS << shift;
+                if (backoff > MATCH_WQ_RETRY_MAX_MS) backoff = MATCH_WQ_RETRY_MAX_MS;
+                b->retry_at_ms = now_ms() + backoff;
+                printf("[MATCH_WQ] Batch for match %lld failed (err=%d, attempt %d), retry in %lldms\n",
+                       (long long)db_match_id, err, b->attempts, (long long)backoff);
+            }
+        }
+        free(sql);
+
+        release_bucket_if_idle(b);
+    }
+    pthread_mutex_unlock(&g_wq.lock);
+
+    printf("[MATCH_WQ] Writer stopped\n");
+    return NULL;
+}
+
+//==============================================================================
+// ENQUEUE
+//==============================================================================
+
+static void enqueue(int64_t db_match_id, mwq_record_t *rec) {
+    pthread_mutex_lock(&g_wq.lock);
+
+    if (!g_wq.started) {
+        pthread_mutex_unlock(&g_wq.lock);
+        persist_now(db_match_id, rec);
+        return;
+    }
+
+    // Long outage: bound memory by spilling to the dead-letter file
+    if (g_wq.pending >= MATCH_WQ_MAX_PENDING) {
+        pthread_mutex_unlock(&g_wq.lock);
+        char *sql = build_batch_sql(rec);
+        write_deadletter(db_match_id, 1, sql);
+        free(sql);
+        record_free(rec);
+        return;
+    }
+
+    mwq_bucket_t *b = get_or_create_bucket(db_match_id);
+    if (!b) {
+        pthread_mutex_unlock(&g_wq.lock);
+        printf("[MATCH_WQ] Out of memory, writing match %lld inline\n", (long long)db_match_id);
+        persist_now(db_match_id, rec);
+        return;
+    }
+
+    // Coalesce with a pending (not in-flight) update of the same row
+    if (rec->kind == MWQ_PLAYER) {
+        for (mwq_record_t *r = b->head; r; r = r->next) {
+            if (r->kind != MWQ_PLAYER || r->ref_id != rec->ref_id) continue;
+            if (rec->fields & MWQ_SET_SCORE) r->value = rec->value;
+            if (rec->fields & MWQ_SET_ELIMINATED) r->eliminated = rec->eliminated;
+            if (rec->fields & MWQ_SET_WINNER) r->winner = rec->winner;
+            r->fields |= rec->fields;
+            pthread_mutex_unlock(&g_wq.lock);
+            record_free(rec);
+            return;
+        }
+    }
+
+    if (b->tail) b->tail->next = rec;
+    else b->head = rec;
+    b->tail = rec;
+
+    if (b->count++ == 0) b->first_at_ms = now_ms();
+    b->enqueued++;
+    g_wq.pending++;
+
+    if (b->count >= MATCH_WQ_BATCH_MAX) {
+        pthread_cond_signal(&g_wq.work_cond);
+    }
+    pthread_mutex_unlock(&g_wq.lock);
+}
+
+static mwq_record_t *record_new(mwq_kind_t kind) {
+    mwq_record_t *r = calloc(1, sizeof(*r));
+    if (!r) {
+        printf("[MATCH_WQ] Out of memory, record dropped\n");
+        return NULL;
+    }
+    r->kind = kind;
+    r->created_at = wall_now();
+    return r;
+}
+
+//==============================================================================
+// PUBLIC API
+//==============================================================================
+
+void match_wq_init(void) {
+    pthread_mutex_lock(&g_wq.lock);
+    if (g_wq.started) {
+        pthread_mutex_unlock(&g_wq.lock);
+        return;
+    }
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_wq.work_cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    g_wq.running = 1;
+    if (pthread_create(&g_wq.thread, NULL, writer_thread, NULL) != 0) {
+        printf("[MATCH_WQ] Failed to start writer, falling back to inline writes\n");
+        g_wq.running = 0;
+        pthread_mutex_unlock(&g_wq.lock);
+        return;
+    }
+    g_wq.started = 1;
+    pthread_mutex_unlock(&g_wq.lock);
+
+    printf("[MATCH_WQ] Writer started (batch=%d, linger=%dms)\n",
+           MATCH_WQ_BATCH_MAX, MATCH_WQ_LINGER_MS);
+}
+
+void match_wq_shutdown(void) {
+    pthread_mutex_lock(&g_wq.lock);
+    if (!g_wq.started) {
+        pthread_mutex_unlock(&g_wq.lock);
+        return;
+    }
+    printf("[MATCH_WQ] Draining %d pending records (%llu skipped)...\n",
+           g_wq.pending, (unsigned long long)g_wq.skipped);
+    g_wq.running = 0;
+    pthread_cond_signal(&g_wq.work_cond);
+    pthread_mutex_unlock(&g_wq.lock);
+
+    pthread_join(g_wq.thread, NULL);
+
+    pthread_mutex_lock(&g_wq.lock);
+    g_wq.started = 0;
+    pthread_mutex_unlock(&g_wq.lock);
+}
+
+void match_wq_answer(
+    int64_t db_match_id,
+    int64_t question_id,
+    int32_t player_id,
+    const char *answer_json,
+    int score_delta,
+    int action_idx
+) {
+    if (db_match_id <= 0 || question_id <= 0 || player_id <= 0) {
+        skip_record("answer", db_match_id, player_id);
+        return;
+    }
+
+    mwq_record_t *r = record_new(MWQ_ANSWER);
+    if (!r) return;
+    r->ref_id = question_id;
+    r->player_id = player_id;
+    r->value = score_delta;
+    r->index = action_idx;
+    r->text = answer_json ? strdup(answer_json) : NULL;
+
+    enqueue(db_match_id, r);
+}
+
+void match_wq_event(
+    int64_t db_match_id,
+    int32_t player_id,
+    const char *event_type,
+    int round_no,
+    int question_idx
+) {
+    if (!event_type) return;
+    if (db_match_id <= 0) {
+        skip_record(event_type, db_match_id, player_id);
+        return;
+    }
+
+    mwq_record_t *r = record_new(MWQ_EVENT);
+    if (!r) return;
+    r->ref_id = db_match_id;
+    r->player_id = player_id;
+    r->round_no = round_no;
+    r->index = question_idx;
+    r->text = strdup(event_type);
+
+    enqueue(db_match_id, r);
+}
+
+void match_wq_question(
+    int64_t db_match_id,
+    int round_no,
+    const char *round_type,
+    int question_idx,
+    const char *question_json
+) {
+    if (!round_type) return;
+    if (db_match_id <= 0) {
+        skip_record("question", db_match_id, round_no);
+        return;
+    }
+
+    mwq_record_t *r = record_new(MWQ_QUESTION);
+    if (!r) return;
+    r->ref_id = db_match_id;
+    r->round_no = round_no;
+    r->index = question_idx;
+    snprintf(r->label, sizeof(r->label), "%s", round_type);
+    r->text = question_json ? strdup(question_json) : NULL;
+
+    enqueue(db_match_id, r);
+}
+
+void match_wq_player_update(
+    int64_t db_match_id,
+    int32_t match_player_id,
+    unsigned fields,
+    int score,
+    bool eliminated,
+    bool winner
+) {
+    if (fields == 0) return;
+    if (db_match_id <= 0 || match_player_id <= 0) {
+        skip_record("player update", db_match_id, match_player_id);
+        return;
+    }
+
+    mwq_record_t *r = record_new(MWQ_PLAYER);
+    if (!r) return;
+    r->ref_id = match_player_id;
+    r->fields = fields;
+    r->value = score;
+    r->eliminated = eliminated;
+    r->winner = winner;
+
+    enqueue(db_match_id, r);
+}
+
+void match_wq_profile_result(
+    int64_t db_match_id,
+    int32_t account_id,
+    int points_delta,
+    bool winner
+) {
+    if (account_id <= 0) return;
+    if (db_match_id <= 0) {
+        skip_record("profile result", db_match_id, account_id);
+        return;
+    }
+
+    mwq_record_t *r = record_new(MWQ_PROFILE);
+    if (!r) return;
+    r->ref_id = db_match_id;
+    r->player_id = account_id;
+    r->value = points_delta;
+    r->winner = winner;
+
+    enqueue(db_match_id, r);
+}
+
+void match_wq_match_ended(int64_t db_match_id, time_t ended_at) {
+    if (db_match_id <= 0) {
+        skip_record("match end", db_match_id, 0);
+        return;
+    }
+
+    mwq_record_t *r = record_new(MWQ_MATCH_END);
+    if (!r) return;
+    r->ref_id = db_match_id;
+    if (ended_at > 0) r->created_at = (double)ended_at;
+
+    enqueue(db_match_id, r);
+}
+
+void match_wq_flush(int64_t db_match_id, int timeout_ms, match_wq_flush_cb cb, void *arg) {
+    if (db_match_id <= 0) {
+        if (cb) cb(db_match_id, DB_ERROR_INVALID_PARAM, arg);
+        return;
+    }
+
+    // Read before taking g_wq.lock, see writer_thread
+    bool db_up = db_is_available();
+
+    pthread_mutex_lock(&g_wq.lock);
+
+    // Nothing queued for it (or written inline): the barrier is already reached
+    mwq_bucket_t *b = find_bucket(db_match_id);
+    if (!b || b->completed >= b->enqueued) {
+        pthread_mutex_unlock(&g_wq.lock);
+        if (cb) cb(db_match_id, DB_OK, arg);
+        return;
+    }
+
+    // Don't hold the caller's follow-up on an outage; records stay queued
+    if (!db_up) {
+        int left = b->count;
+        pthread_mutex_unlock(&g_wq.lock);
+        printf("[MATCH_WQ] DB unavailable, %d records of match %lld stay queued\n",
+               left, (long long)db_match_id);
+        if (cb) cb(db_match_id, DB_ERR_UNAVAILABLE, arg);
+        return;
+    }
+
+    mwq_flush_t *f = calloc(1, sizeof(*f));
+    if (!f) {
+        pthread_mutex_unlock(&g_wq.lock);
+        if (cb) cb(db_match_id, DB_ERROR_INTERNAL, arg);
+        return;
+    }
+    f->db_match_id = db_match_id;
+    f->target = b->enqueued;
+    f->deadline_ms = now_ms() + (timeout_ms > 0 ? timeout_ms : MATCH_WQ_FLUSH_TIMEOUT_MS);
+    f->cb = cb;
+    f->arg = arg;
+    f->next = b->flushes;
+    b->flushes = f;
+
+    b->flush_requested = 1;
+    pthread_cond_signal(&g_wq.work_cond);
+    pthread_mutex_unlock(&g_wq.lock);
+}
+
+int match_wq_pending(void) {
+    pthread_mutex_lock(&g_wq.lock);
+    int n = g_wq.pending;
+    pthread_mutex_unlock(&g_wq.lock);
+    return n;
+}
+
+uint64_t match_wq_skipped(void) {
+    pthread_mutex_lock(&g_wq.lock);
+    uint64_t n = g_wq.skipped;
+    pthread_mutex_unlock(&g_wq.lock);
+    return n;
+}
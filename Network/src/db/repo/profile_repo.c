@@ -7,6 +7,9 @@
 
 #include "db/repo/profile_repo.h"
 #include "db/core/db_client.h"
+#include "db/repo/account_cache.h"
+#include "db/repo/user_index.h"
+#include "db/repo/leaderboard.h"
 
 static profile_t* parse_profile_from_json(cJSON *json) {
 	if (!json) return NULL;
@@ -75,6 +78,11 @@ db_error_t profile_create(
 		cJSON *item = cJSON_GetArrayItem(response, 0);
 		*out_profile = parse_profile_from_json(item);
 		cJSON_Delete(response);
+		profile_cache_put(*out_profile);
+		if (*out_profile) {
+			user_index_put_profile(account_id, (*out_profile)->name, (*out_profile)->avatar);
+			leaderboard_put_profile(account_id, (*out_profile)->name, (*out_profile)->avatar);
+		}
 		return *out_profile ? DB_SUCCESS : DB_ERROR_PARSE;
 	}
 
@@ -90,6 +98,9 @@ db_error_t profile_find_by_account(
 		return DB_ERROR_INVALID_PARAM;
 	}
 
+	*out_profile = profile_cache_get(account_id);
+	if (*out_profile) return DB_SUCCESS;
+
 	char query[256];
 	snprintf(query, sizeof(query), "SELECT * FROM profiles WHERE account_id = %d LIMIT 1", account_id);
 
@@ -109,6 +120,7 @@ db_error_t profile_find_by_account(
 		cJSON *item = cJSON_GetArrayItem(response, 0);
 		*out_profile = parse_profile_from_json(item);
 		cJSON_Delete(response);
+		profile_cache_put(*out_profile);
 		return *out_profile ? DB_SUCCESS : DB_ERROR_PARSE;
 	}
 
@@ -116,6 +128,68 @@ db_error_t profile_find_by_account(
 	return DB_ERROR_PARSE;
 }
 
+db_error_t profile_find_by_accounts(
+	const int32_t *account_ids,
+	int32_t count,
+	profile_t **out_profiles
+) {
+	if (count < 0 || (count > 0 && (!account_ids || !out_profiles))) {
+		return DB_ERROR_INVALID_PARAM;
+	}
+
+	// Cache hits first; misses go into a single IN (...) query
+	size_t cap = 64 + (size_t)count * 12;
+	char *query = malloc(cap);
+	if (!query) return DB_ERROR_INTERNAL;
+	size_t len = (size_t)snprintf(query, cap, "SELECT * FROM profiles WHERE account_id IN (");
+	int32_t misses = 0;
+
+	for (int32_t i = 0; i < count; i++) {
+		out_profiles[i] = account_ids[i] > 0 ? profile_cache_get(account_ids[i]) : NULL;
+		if (out_profiles[i] || account_ids[i] <= 0) continue;
+		len += (size_t)snprintf(query + len, cap - len, "%s%d", misses ? "," : "", account_ids[i]);
+		misses++;
+	}
+
+	if (misses == 0) {
+		free(query);
+		return DB_SUCCESS;
+	}
+	snprintf(query + len, cap - len, ")");
+
+	cJSON *response = NULL;
+	db_error_t err = db_get("profiles", query, &response);
+	free(query);
+
+	if (err != DB_SUCCESS || !cJSON_IsArray(response)) {
+		if (response) cJSON_Delete(response);
+		for (int32_t i = 0; i < count; i++) {
+			profile_free(out_profiles[i]);
+			out_profiles[i] = NULL;
+		}
+		return err != DB_SUCCESS ? err : DB_ERROR_PARSE;
+	}
+
+	cJSON *item = NULL;
+	cJSON_ArrayForEach(item, response) {
+		profile_t *profile = parse_profile_from_json(item);
+		if (!profile) continue;
+		profile_cache_put(profile);
+
+		// Hand a copy to every slot asking for this account
+		for (int32_t i = 0; i < count; i++) {
+			if (account_ids[i] != profile->account_id || out_profiles[i]) continue;
+			out_profiles[i] = profile;
+			profile = profile_cache_get(account_ids[i]);
+			if (!profile) break;
+		}
+		profile_free(profile);
+	}
+
+	cJSON_Delete(response);
+	return DB_SUCCESS;
+}
+
 void profile_free(profile_t *profile) {
 	if (!profile) return;
 	free(profile->name);
@@ -148,6 +222,7 @@ db_error_t profile_update_by_account(
 	cJSON *response = NULL;
 	db_error_t err = db_patch("profiles", filter, payload, &response);
 	cJSON_Delete(payload);
+	profile_cache_invalidate(account_id);
 
 	if (err != DB_SUCCESS) {
 		if (response) cJSON_Delete(response);
@@ -158,6 +233,10 @@ db_error_t profile_update_by_account(
 		cJSON *item = cJSON_GetArrayItem(response, 0);
 		*out_profile = parse_profile_from_json(item);
 		cJSON_Delete(response);
+		if (*out_profile) {
+			user_index_put_profile(account_id, (*out_profile)->name, (*out_profile)->avatar);
+			leaderboard_put_profile(account_id, (*out_profile)->name, (*out_profile)->avatar);
+		}
 		return *out_profile ? DB_SUCCESS : DB_ERROR_PARSE;
 	}
 
@@ -0,0 +1,537 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "db/repo/question_bank.h"
+#include "db/core/db_client.h"
+
+//==============================================================================
+// TYPES
+//==============================================================================
+
+typedef struct {
+    int32_t id;
+    cJSON *row;                 // owned
+} qb_entry_t;
+
+typedef struct {
+    char *key;                  // "type\x1f" or "type\x1fcategory"
+    uint32_t hash;
+    int *idx;                   // entry indices
+    int count;
+    int cap;
+} qb_bucket_t;
+
+typedef struct {
+    qb_entry_t *entries;
+    int count;
+
+    qb_bucket_t *buckets;       // open addressing, power of two
+    int bucket_cap;
+
+    char max_updated[40];       // newest updated_at seen (refresh cursor)
+} qb_snapshot_t;
+
+// Small open-addressing int map (sampling swap map / exclusion set)
+typedef struct {
+    int32_t *keys;
+    int32_t *vals;
+    unsigned char *used;
+    uint32_t mask;
+} qb_intmap_t;
+
+static struct {
+    pthread_rwlock_t lock;              // guards snap pointer
+    qb_snapshot_t *snap;
+
+    pthread_mutex_t refresh_lock;       // one refresh at a time
+    pthread_mutex_t thread_lock;
+    pthread_cond_t stop_cond;
+    pthread_t thread;
+    int thread_started;
+    int running;
+    time_t last_full;
+} g_qb = {
+    .lock = PTHREAD_RWLOCK_INITIALIZER,
+    .refresh_lock = PTHREAD_MUTEX_INITIALIZER,
+    .thread_lock = PTHREAD_MUTEX_INITIALIZER,
+    .stop_cond = PTHREAD_COND_INITIALIZER,
+};
+
+//==============================================================================
+// HELPERS
+//==============================================================================
+
+static uint32_t fnv1a(const char *s) {
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static uint32_t hash_int(int32_t v) {
+    uint32_t x = (uint32_t)v;
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+// Per-thread xorshift; seeded lazily so callers never touch srand()
+static _Thread_local uint64_t t_rng = 0;
+
+static uint32_t rng_below(uint32_t n) {
+    if (t_rng == 0) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        t_rng = ((uint64_t)ts.tv_nsec << 20) ^ (uint64_t)ts.tv_sec ^
+                (uint64_t)(uintptr_t)&t_rng;
+        if (t_rng == 0) t_rng = 0x9e3779b97f4a7c15ULL;
+    }
+    t_rng ^= t_rng << 13;
+    t_rng ^= t_rng >> 7;
+    t_rng ^= t_rng << 17;
+    return (uint32_t)(((t_rng >> 32) * (uint64_t)n) >> 32);
+}
+
+static int intmap_init(qb_intmap_t *m, int expected) {
+    uint32_t cap = 8;
+    while (cap < (uint32_t)expected * 2) cap <<= 1;
+    m->keys = malloc(cap * sizeof(int32_t));
+    m->vals = malloc(cap * sizeof(int32_t));
+    m->used = calloc(cap, 1);
+    m->mask = cap - 1;
+    return (m->keys && m->vals && m->used) ? 0 : -1;
+}
+
+static void intmap_free(qb_intmap_t *m) {
+    free(m->keys);
+    free(m->vals);
+    free(m->used);
+}
+
+static int32_t *intmap_slot(qb_intmap_t *m, int32_t key, int insert) {
+    uint32_t i = hash_int(key) & m->mask;
+    while (m->used[i]) {
+        if (m->keys[i] == key) return &m->vals[i];
+        i = (i + 1) & m->mask;
+    }
+    if (!insert) return NULL;
+    m->used[i] = 1;
+    m->keys[i] = key;
+    return &m->vals[i];
+}
+
+static const char *row_str(const cJSON *row, const char *field) {
+    cJSON *v = cJSON_GetObjectItem(row, field);
+    return (v && cJSON_IsString(v)) ? v->valuestring : NULL;
+}
+
+// data->>'category' (jsonb columns come back parsed)
+static const char *row_category(const cJSON *row) {
+    cJSON *data = cJSON_GetObjectItem(row, "data");
+    if (!data || !cJSON_IsObject(data)) return NULL;
+    return row_str(data, "category");
+}
+
+static int row_active(const cJSON *row) {
+    cJSON *a = cJSON_GetObjectItem(row, "active");
+    if (!a || cJSON_IsNull(a)) return 1;     // column defaults to TRUE
+    if (cJSON_IsBool(a)) return cJSON_IsTrue(a);
+    if (cJSON_IsString(a)) return a->valuestring[0] == 't';
+    return 1;
+}
+
+//==============================================================================
+// SNAPSHOT
+//==============================================================================
+
+static void snapshot_free(qb_snapshot_t *s) {
+    if (!s) return;
+    for (int i = 0; i < s->count; i++) cJSON_Delete(s->entries[i].row);
+    for (int i = 0; i < s->bucket_cap; i++) {
+        free(s->buckets[i].key);
+        free(s->buckets[i].idx);
+    }
+    free(s->entries);
+    free(s->buckets);
+    free(s);
+}
+
+static qb_bucket_t *bucket_find(const qb_snapshot_t *s, const char *key, uint32_t h, int insert) {
+    uint32_t mask = (uint32_t)s->bucket_cap - 1;
+    uint32_t i = h & mask;
+    while (s->buckets[i].key) {
+        if (s->buckets[i].hash == h && strcmp(s->buckets[i].key, key) == 0) {
+            return &s->buckets[i];
+        }
+        i = (i + 1) & mask;
+    }
+    if (!insert) return NULL;
+    s->buckets[i].key = strdup(key);
+    s->buckets[i].hash = h;
+    return s->buckets[i].key ? &s->buckets[i] : NULL;
+}
+
+static int bucket_add(qb_snapshot_t *s, const char *key, int entry) {
+    qb_bucket_t *b = bucket_find(s, key, fnv1a(key), 1);
+    if (!b) return -1;
+    if (b->count == b->cap) {
+        int cap = b->cap ? b->cap * 2 : 16;
+        int *idx = realloc(b->idx, (size_t)cap * sizeof(int));
+        if (!idx) return -1;
+        b->idx = idx;
+        b->cap = cap;
+    }
+    b->idx[b->count++] = entry;
+    return 0;
+}
+
+static void make_key(char *buf, size_t size, const char *type, const char *category) {
+    snprintf(buf, size, "%s\x1f%s", type, category ? category : "");
+}
+
+/**
+ * Build a snapshot from `rows` (ownership of each row moves to the snapshot;
+ * rows that are inactive or malformed are freed here)
+ */
+static qb_snapshot_t *snapshot_build(cJSON **rows, int n) {
+    qb_snapshot_t *s = calloc(1, sizeof(*s));
+    if (!s) goto fail;
+
+    s->entries = calloc((size_t)(n > 0 ? n : 1), sizeof(qb_entry_t));
+    s->bucket_cap = 16;
+    while (s->bucket_cap < n * 2 + 16) s->bucket_cap <<= 1;
+    s->buckets = calloc((size_t)s->bucket_cap, sizeof(qb_bucket_t));
+    if (!s->entries || !s->buckets) goto fail;
+
+    char key[256];
+    for (int i = 0; i < n; i++) {
+        cJSON *row = rows[i];
+        rows[i] = NULL;
+
+        const char *updated = row_str(row, "updated_at");
+        if (updated && strcmp(updated, s->max_updated) > 0) {
+            snprintf(s->max_updated, sizeof(s->max_updated), "%s", updated);
+        }
+
+        cJSON *id = cJSON_GetObjectItem(row, "id");
+        const char *type = row_str(row, "type");
+        if (!id || !cJSON_IsNumber(id) || !type || !row_active(row)) {
+            cJSON_Delete(row);
+            continue;
+        }
+
+        int e = s->count++;
+        s->entries[e].id = (int32_t)id->valueint;
+        s->entries[e].row = row;
+
+        make_key(key, sizeof(key), type, NULL);
+        if (bucket_add(s, key, e) != 0) goto fail;
+
+        const char *category = row_category(row);
+        if (category && category[0]) {
+            make_key(key, sizeof(key), type, category);
+            if (bucket_add(s, key, e) != 0) goto fail;
+        }
+    }
+    return s;
+
+fail:
+    for (int i = 0; i < n; i++) cJSON_Delete(rows[i]);
+    snapshot_free(s);
+    return NULL;
+}
+
+static void snapshot_swap(qb_snapshot_t *next) {
+    pthread_rwlock_wrlock(&g_qb.lock);
+    qb_snapshot_t *old = g_qb.snap;
+    g_qb.snap = next;
+    pthread_rwlock_unlock(&g_qb.lock);
+    snapshot_free(old);
+}
+
+//==============================================================================
+// LOADING
+//==============================================================================
+
+static int load_full(void) {
+    cJSON *result = NULL;
+    db_error_t rc = db_get("questions", "SELECT * FROM questions WHERE active = true", &result);
+    if (rc != DB_OK || !result || !cJSON_IsArray(result)) {
+        printf("[QUESTION_BANK] Full load failed: rc=%d\n", rc);
+        if (result) cJSON_Delete(result);
+        return -1;
+    }
+
+    int n = cJSON_GetArraySize(result);
+    cJSON **rows = calloc((size_t)(n > 0 ? n : 1), sizeof(cJSON *));
+    if (!rows) {
+        cJSON_Delete(result);
+        return -1;
+    }
+    for (int i = 0; i < n; i++) rows[i] = cJSON_DetachItemFromArray(result, 0);
+    cJSON_Delete(result);
+
+    qb_snapshot_t *next = snapshot_build(rows, n);
+    free(rows);
+    if (!next) return -1;
+
+    // An empty table has no cursor; keep reloading fully until it has rows
+    int loaded = next->count;
+    snapshot_swap(next);
+    g_qb.last_full = time(NULL);
+    printf("[QUESTION_BANK] Loaded %d questions\n", loaded);
+    return 0;
+}
+
+/**
+ * Apply rows changed since the snapshot cursor. Unchanged rows are copied
+ * into the new snapshot, so nothing is rebuilt when the delta is empty.
+ */
+static int load_delta(void) {
+    char cursor[40];
+    pthread_rwlock_rdlock(&g_qb.lock);
+    int have = g_qb.snap && g_qb.snap->max_updated[0];
+    if (have) snprintf(cursor, sizeof(cursor), "%s", g_qb.snap->max_updated);
+    pthread_rwlock_unlock(&g_qb.lock);
+
+    if (!have) return load_full();
+
+    char query[160];
+    snprintf(query, sizeof(query),
+             "SELECT * FROM questions WHERE updated_at > '%s'", cursor);
+
+    cJSON *delta = NULL;
+    db_error_t rc = db_get("questions", query, &delta);
+    if (rc != DB_OK || !delta || !cJSON_IsArray(delta)) {
+        if (delta) cJSON_Delete(delta);
+        return -1;
+    }
+
+    int changed = cJSON_GetArraySize(delta);
+    if (changed == 0) {
+        cJSON_Delete(delta);
+        return 0;
+    }
+
+    qb_intmap_t touched = {0};
+    if (intmap_init(&touched, changed) != 0) {
+        intmap_free(&touched);
+        cJSON_Delete(delta);
+        return -1;
+    }
+    cJSON *row;
+    cJSON_ArrayForEach(row, delta) {
+        cJSON *id = cJSON_GetObjectItem(row, "id");
+        if (id && cJSON_IsNumber(id)) *intmap_slot(&touched, (int32_t)id->valueint, 1) = 1;
+    }
+
+    // Only refreshers swap snapshots and refresh_lock is held, so the current
+    // one stays valid without the rwlock
+    qb_snapshot_t *old = g_qb.snap;
+    int n = 0;
+    cJSON **rows = calloc((size_t)(old->count + changed), sizeof(cJSON *));
+    if (!rows) {
+        intmap_free(&touched);
+        cJSON_Delete(delta);
+        return -1;
+    }
+    for (int i = 0; i < old->count; i++) {
+        if (intmap_slot(&touched, old->entries[i].id, 0)) continue;
+        rows[n++] = cJSON_Duplicate(old->entries[i].row, 1);
+    }
+    for (int i = 0; i < changed; i++) rows[n++] = cJSON_DetachItemFromArray(delta, 0);
+    intmap_free(&touched);
+    cJSON_Delete(delta);
+
+    qb_snapshot_t *next = snapshot_build(rows, n);
+    free(rows);
+    if (!next) return -1;
+
+    // Rows that went inactive or disappeared don't carry the cursor forward
+    if (strcmp(next->max_updated, cursor) < 0) {
+        snprintf(next->max_updated, sizeof(next->max_updated), "%s", cursor);
+    }
+
+    int total = next->count;
+    snapshot_swap(next);
+    printf("[QUESTION_BANK] Applied %d changed questions (%d active)\n", changed, total);
+    return 0;
+}
+
+static int refresh_locked(int full) {
+    if (!db_is_available()) return -1;
+    return full ? load_full() : load_delta();
+}
+
+//==============================================================================
+// REFRESH THREAD
+//==============================================================================
+
+static void *refresh_thread(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&g_qb.thread_lock);
+    while (g_qb.running) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += QUESTION_BANK_REFRESH_SEC;
+        pthread_cond_timedwait(&g_qb.stop_cond, &g_qb.thread_lock, &ts);
+        if (!g_qb.running) break;
+        pthread_mutex_unlock(&g_qb.thread_lock);
+
+        pthread_mutex_lock(&g_qb.refresh_lock);
+        int full = !question_bank_ready() ||
+                   time(NULL) - g_qb.last_full >= QUESTION_BANK_FULL_RELOAD_SEC;
+        refresh_locked(full);
+        pthread_mutex_unlock(&g_qb.refresh_lock);
+
+        pthread_mutex_lock(&g_qb.thread_lock);
+    }
+    pthread_mutex_unlock(&g_qb.thread_lock);
+    return NULL;
+}
+
+//==============================================================================
+// PUBLIC API
+//==============================================================================
+
+int question_bank_init(void) {
+    pthread_mutex_lock(&g_qb.refresh_lock);
+    int rc = refresh_locked(1);
+    pthread_mutex_unlock(&g_qb.refresh_lock);
+
+    pthread_mutex_lock(&g_qb.thread_lock);
+    if (!g_qb.thread_started) {
+        g_qb.running = 1;
+        g_qb.thread_started = (pthread_create(&g_qb.thread, NULL, refresh_thread, NULL) == 0);
+        if (!g_qb.thread_started) {
+            g_qb.running = 0;
+            printf("[QUESTION_BANK] Failed to start refresh thread\n");
+        }
+    }
+    pthread_mutex_unlock(&g_qb.thread_lock);
+
+    return rc;
+}
+
+void question_bank_shutdown(void) {
+    pthread_mutex_lock(&g_qb.thread_lock);
+    int started = g_qb.thread_started;
+    g_qb.running = 0;
+    g_qb.thread_started = 0;
+    pthread_cond_broadcast(&g_qb.stop_cond);
+    pthread_mutex_unlock(&g_qb.thread_lock);
+
+    if (started) pthread_join(g_qb.thread, NULL);
+
+    pthread_mutex_lock(&g_qb.refresh_lock);
+    snapshot_swap(NULL);
+    pthread_mutex_unlock(&g_qb.refresh_lock);
+}
+
+bool question_bank_ready(void) {
+    pthread_rwlock_rdlock(&g_qb.lock);
+    bool ready = g_qb.snap != NULL;
+    pthread_rwlock_unlock(&g_qb.lock);
+    return ready;
+}
+
+int question_bank_size(void) {
+    pthread_rwlock_rdlock(&g_qb.lock);
+    int n = g_qb.snap ? g_qb.snap->count : 0;
+    pthread_rwlock_unlock(&g_qb.lock);
+    return n;
+}
+
+void question_bank_seed(uint64_t seed) {
+    // splitmix64 step: small seeds still give a well-mixed xorshift state
+    uint64_t z = seed + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    t_rng = seed ? (z ^ (z >> 31)) : 0;
+    if (seed && t_rng == 0) t_rng = 0x9e3779b97f4a7c15ULL;
+}
+
+int question_bank_refresh(void) {
+    pthread_mutex_lock(&g_qb.refresh_lock);
+    int rc = refresh_locked(!question_bank_ready());
+    pthread_mutex_unlock(&g_qb.refresh_lock);
+    return rc;
+}
+
+db_error_t question_bank_sample(
+    const char *round_type,
+    const char *category,
+    int count,
+    const int32_t *excluded_ids,
+    int excluded_count,
+    cJSON **out_json
+) {
+    if (!out_json || !round_type || count <= 0) return DB_ERROR_INVALID_PARAM;
+    *out_json = NULL;
+    if (!excluded_ids) excluded_count = 0;
+    if (excluded_count < 0) excluded_count = 0;
+
+    char key[256];
+    make_key(key, sizeof(key), round_type, (category && category[0]) ? category : NULL);
+
+    // Each draw adds at most one swap, and there are at most count + excluded draws
+    qb_intmap_t excluded = {0}, swaps = {0};
+    if (intmap_init(&excluded, excluded_count) != 0 ||
+        intmap_init(&swaps, count + excluded_count + 1) != 0) {
+        intmap_free(&excluded);
+        intmap_free(&swaps);
+        return DB_ERROR_INTERNAL;
+    }
+    for (int i = 0; i < excluded_count; i++) *intmap_slot(&excluded, excluded_ids[i], 1) = 1;
+
+    pthread_rwlock_rdlock(&g_qb.lock);
+    qb_snapshot_t *s = g_qb.snap;
+    if (!s) {
+        pthread_rwlock_unlock(&g_qb.lock);
+        intmap_free(&excluded);
+        intmap_free(&swaps);
+        return DB_ERR_UNAVAILABLE;
+    }
+
+    qb_bucket_t *b = bucket_find(s, key, fnv1a(key), 0);
+    int n = b ? b->count : 0;
+    cJSON *picked = cJSON_CreateArray();
+
+    // Sparse Fisher-Yates: position p holds swaps[p] if set, else p.
+    // Excluded ids are drawn and dropped, so they cost one step each at most.
+    int got = 0;
+    for (int i = 0; i < n && got < count; i++) {
+        int j = i + (int)rng_below((uint32_t)(n - i));
+        int32_t *sj = intmap_slot(&swaps, j, 0);
+        int32_t *si = intmap_slot(&swaps, i, 0);
+        int vj = sj ? *sj : j;
+        int vi = si ? *si : i;
+        *intmap_slot(&swaps, j, 1) = vi;
+
+        const qb_entry_t *e = &s->entries[b->idx[vj]];
+        if (intmap_slot(&excluded, e->id, 0)) continue;
+
+        cJSON_AddItemToArray(picked, cJSON_Duplicate(e->row, 1));
+        got++;
+    }
+    pthread_rwlock_unlock(&g_qb.lock);
+
+    intmap_free(&excluded);
+    intmap_free(&swaps);
+
+    if (got == 0) {
+        cJSON_Delete(picked);
+        return DB_ERROR_NOT_FOUND;
+    }
+    *out_json = picked;
+    return DB_OK;
+}
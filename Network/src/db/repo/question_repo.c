@@ -8,6 +8,8 @@
 #include <stdbool.h>
 #include <time.h>
 #include "db/core/db_client.h"
+#include "db/repo/question_bank.h"
+#include "db/repo/recent_questions.h"
 int history_repo_get(
    int32_t account_id,
     cJSON **out_json
@@ -65,6 +67,7 @@ int history_repo_get(
 }
 
 // Get question IDs that appeared in recent N matches of given players
+// (served from the per-account rings, no DB round-trip)
 db_error_t question_get_excluded_ids(
     const int32_t *account_ids,
     int player_count,
@@ -76,84 +79,12 @@ db_error_t question_get_excluded_ids(
         return DB_ERROR_INVALID_PARAM;
     }
 
-    *out_excluded_ids = NULL;
-    *out_excluded_count = 0;
-
-    // Build query to get question IDs from recent matches
-    // For each player, get their N most recent matches, then get all question IDs from those matches
-    char query[2048];
-    int offset = 0;
-    
-    // Build list of account IDs for SQL IN clause
-    char account_list[256] = "";
-    for (int i = 0; i < player_count; i++) {
-        char buf[32];
-        snprintf(buf, sizeof(buf), "%d%s", account_ids[i], (i < player_count - 1) ? "," : "");
-        strcat(account_list, buf);
-    }
-
-    // SQL query: Get distinct question IDs from match_question table
-    // Join with match_players to filter by account_ids
-    snprintf(query, sizeof(query),
-        "SELECT DISTINCT mq.question->>'id' as question_id "
-        "FROM match_question mq "
-        "JOIN matches m ON mq.match_id = m.id "
-        "JOIN match_players mp ON mp.match_id = m.id "
-        "WHERE mp.account_id IN (%s) "
-        "ORDER BY m.started_at DESC "
-        "LIMIT %d",
-        account_list, recent_match_count * 10);  // Get more to ensure coverage
-
-    cJSON *result = NULL;
-    db_error_t rc = db_get("match_question", query, &result);
-
-    if (rc != DB_OK || !result) {
-        printf("[QUESTION_REPO] No recent matches found or query failed\n");
-        return DB_OK; // Not an error, just no exclusions
-    }
-
-    if (!cJSON_IsArray(result)) {
-        cJSON_Delete(result);
-        return DB_OK;
-    }
-
-    int count = cJSON_GetArraySize(result);
-    if (count == 0) {
-        cJSON_Delete(result);
-        return DB_OK;
+    db_error_t rc = recent_questions_collect(account_ids, player_count, recent_match_count,
+                                             out_excluded_ids, out_excluded_count);
+    if (rc == DB_OK) {
+        printf("[QUESTION_REPO] Excluding %d question IDs from selection\n", *out_excluded_count);
     }
-
-    // Allocate array for excluded IDs
-    int32_t *excluded = malloc(count * sizeof(int32_t));
-    if (!excluded) {
-        cJSON_Delete(result);
-        return DB_ERROR_INTERNAL;
-    }
-
-    // Extract question IDs from result
-    int valid_count = 0;
-    for (int i = 0; i < count; i++) {
-        cJSON *item = cJSON_GetArrayItem(result, i);
-        if (!item) continue;
-        
-        // Result should have question_id field from our SQL
-        cJSON *id_field = cJSON_GetObjectItem(item, "question_id");
-        if (id_field) {
-            if (cJSON_IsNumber(id_field)) {
-                excluded[valid_count++] = id_field->valueint;
-            } else if (cJSON_IsString(id_field)) {
-                excluded[valid_count++] = atoi(id_field->valuestring);
-            }
-        }
-    }
-
-    cJSON_Delete(result);
-
-    *out_excluded_ids = excluded;
-    *out_excluded_count = valid_count;
-
-    printf("[QUESTION_REPO] Excluding %d question IDs from selection\n", valid_count);
-    return DB_OK;
+    return rc;
 }
 
 // Fetch random questions from database filtered by round type
@@ -164,6 +95,16 @@ db_error_t question_get_random(const char *round_type, int count, const int32_t
 
     *out_json = NULL;
 
+    // Served from the in-memory bank once it is loaded
+    db_error_t bank_rc = question_bank_sample(round_type, category, count,
+                                              excluded_ids, excluded_count, out_json);
+    if (bank_rc != DB_ERR_UNAVAILABLE) {
+        if (bank_rc == DB_ERROR_NOT_FOUND) {
+            printf("[QUESTION_REPO] WARNING: No questions available for type='%s' after filtering!\n", round_type);
+        }
+        return bank_rc;
+    }
+
     // Build SQL query with JSONB operators
     char query[512];
     
@@ -242,7 +183,6 @@ db_error_t question_get_random(const char *round_type, int count, const int32_t
 
     // Pick 'count' random items
     cJSON *final_array = cJSON_CreateArray();
-    srand(time(NULL));
 
     for (int i = 0; i < count; i++) {
         int remaining = cJSON_GetArraySize(filtered);
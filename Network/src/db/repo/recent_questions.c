@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <cjson/cJSON.h>
+
+#include "db/repo/recent_questions.h"
+#include "db/core/db_client.h"
+
+//==============================================================================
+// TYPES
+//==============================================================================
+
+typedef struct {
+    int count;
+    int32_t ids[RECENT_Q_PER_MATCH];
+} rq_match_t;
+
+typedef struct rq_account {
+    int32_t account_id;
+    int head;                           // next slot to overwrite
+    int used;
+    rq_match_t matches[RECENT_Q_MATCHES];
+    struct rq_account *next;
+} rq_account_t;
+
+static rq_account_t *g_buckets[RECENT_Q_BUCKETS];
+static pthread_mutex_t g_rq_lock = PTHREAD_MUTEX_INITIALIZER;
+
+//==============================================================================
+// HELPERS
+//==============================================================================
+
+static unsigned bucket_of(int32_t account_id) {
+    uint32_t x = (uint32_t)account_id * 2654435761u;
+    return (x >> 16) % RECENT_Q_BUCKETS;
+}
+
+// Caller holds g_rq_lock
+static rq_account_t *account_find(int32_t account_id, int create) {
+    unsigned b = bucket_of(account_id);
+    for (rq_account_t *a = g_buckets[b]; a; a = a->next) {
+        if (a->account_id == account_id) return a;
+    }
+    if (!create) return NULL;
+
+    rq_account_t *a = calloc(1, sizeof(*a));
+    if (!a) return NULL;
+    a->account_id = account_id;
+    a->next = g_buckets[b];
+    g_buckets[b] = a;
+    return a;
+}
+
+// Caller holds g_rq_lock
+static void account_push(int32_t account_id, const int32_t *ids, int n) {
+    rq_account_t *a = account_find(account_id, 1);
+    if (!a) return;
+
+    rq_match_t *m = &a->matches[a->head];
+    m->count = 0;
+    for (int i = 0; i < n && m->count < RECENT_Q_PER_MATCH; i++) {
+        int dup = 0;
+        for (int j = 0; j < m->count; j++) {
+            if (m->ids[j] == ids[i]) { dup = 1; break; }
+        }
+        if (!dup && ids[i] > 0) m->ids[m->count++] = ids[i];
+    }
+
+    a->head = (a->head + 1) % RECENT_Q_MATCHES;
+    if (a->used < RECENT_Q_MATCHES) a->used++;
+}
+
+static int cmp_int32(const void *a, const void *b) {
+    int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int32_t row_int(const cJSON *row, const char *field) {
+    cJSON *v = cJSON_GetObjectItem(row, field);
+    if (!v) return 0;
+    if (cJSON_IsNumber(v)) return (int32_t)v->valueint;
+    if (cJSON_IsString(v)) return (int32_t)atoi(v->valuestring);
+    return 0;
+}
+
+//==============================================================================
+// PUBLIC API
+//==============================================================================
+
+int recent_questions_preload(void) {
+    char query[512];
+    snprintf(query, sizeof(query),
+        "SELECT mp.account_id, mq.match_id, mq.question->>'id' AS question_id "
+        "FROM match_question mq "
+        "JOIN matches m ON mq.match_id = m.id "
+        "JOIN match_players mp ON mp.match_id = m.id "
+        "WHERE m.started_at > NOW() - INTERVAL '%d days' "
+        "ORDER BY mp.account_id, m.started_at, mq.match_id",
+        RECENT_Q_PRELOAD_DAYS);
+
+    cJSON *result = NULL;
+    db_error_t rc = db_get("match_question", query, &result);
+    if (rc != DB_OK || !result || !cJSON_IsArray(result)) {
+        printf("[RECENT_Q] Preload failed: rc=%d\n", rc);
+        if (result) cJSON_Delete(result);
+        return -1;
+    }
+
+    // Rows are grouped by (account, match) in play order; each group is one
+    // ring slot, oldest first
+    int32_t ids[RECENT_Q_PER_MATCH];
+    int n = 0;
+    int32_t cur_account = 0, cur_match = 0;
+    int groups = 0;
+
+    pthread_mutex_lock(&g_rq_lock);
+    cJSON *row;
+    cJSON_ArrayForEach(row, result) {
+        int32_t account_id = row_int(row, "account_id");
+        int32_t match_id = row_int(row, "match_id");
+        int32_t question_id = row_int(row, "question_id");
+
+        if (account_id != cur_account || match_id != cur_match) {
+            if (n > 0) {
+                account_push(cur_account, ids, n);
+                groups++;
+            }
+            cur_account = account_id;
+            cur_match = match_id;
+            n = 0;
+        }
+        if (n < RECENT_Q_PER_MATCH) ids[n++] = question_id;
+    }
+    if (n > 0) {
+        account_push(cur_account, ids, n);
+        groups++;
+    }
+    pthread_mutex_unlock(&g_rq_lock);
+
+    cJSON_Delete(result);
+    printf("[RECENT_Q] Loaded %d account-match entries\n", groups);
+    return 0;
+}
+
+void recent_questions_cleanup(void) {
+    pthread_mutex_lock(&g_rq_lock);
+    for (int b = 0; b < RECENT_Q_BUCKETS; b++) {
+        rq_account_t *a = g_buckets[b];
+        while (a) {
+            rq_account_t *next = a->next;
+            free(a);
+            a = next;
+        }
+        g_buckets[b] = NULL;
+    }
+    pthread_mutex_unlock(&g_rq_lock);
+}
+
+void recent_questions_record_match(
+    const int32_t *account_ids,
+    int player_count,
+    const int32_t *question_ids,
+    int question_count
+) {
+    if (!account_ids || !question_ids || player_count <= 0 || question_count <= 0) return;
+
+    pthread_mutex_lock(&g_rq_lock);
+    for (int i = 0; i < player_count; i++) {
+        if (account_ids[i] > 0) account_push(account_ids[i], question_ids, question_count);
+    }
+    pthread_mutex_unlock(&g_rq_lock);
+}
+
+db_error_t recent_questions_collect(
+    const int32_t *account_ids,
+    int player_count,
+    int recent_match_count,
+    int32_t **out_ids,
+    int *out_count
+) {
+    if (!account_ids || player_count <= 0 || !out_ids || !out_count) {
+        return DB_ERROR_INVALID_PARAM;
+    }
+    *out_ids = NULL;
+    *out_count = 0;
+
+    if (recent_match_count <= 0) return DB_OK;
+    if (recent_match_count > RECENT_Q_MATCHES) recent_match_count = RECENT_Q_MATCHES;
+
+    int32_t *ids = malloc((size_t)player_count * recent_match_count * RECENT_Q_PER_MATCH * sizeof(int32_t));
+    if (!ids) return DB_ERROR_INTERNAL;
+    int n = 0;
+
+    pthread_mutex_lock(&g_rq_lock);
+    for (int p = 0; p < player_count; p++) {
+        rq_account_t *a = account_find(account_ids[p], 0);
+        if (!a) continue;
+
+        int take = a->used < recent_match_count ? a->used : recent_match_count;
+        for (int k = 1; k <= take; k++) {
+            const rq_match_t *m = &a->matches[(a->head - k + RECENT_Q_MATCHES) % RECENT_Q_MATCHES];
+            memcpy(&ids[n], m->ids, (size_t)m->count * sizeof(int32_t));
+            n += m->count;
+        }
+    }
+    pthread_mutex_unlock(&g_rq_lock);
+
+    if (n == 0) {
+        free(ids);
+        return DB_OK;
+    }
+
+    // Players overlap on the same matches: dedup
+    qsort(ids, (size_t)n, sizeof(int32_t), cmp_int32);
+    int unique = 1;
+    for (int i = 1; i < n; i++) {
+        if (ids[i] != ids[unique - 1]) ids[unique++] = ids[i];
+    }
+
+    *out_ids = ids;
+    *out_count = unique;
+    return DB_OK;
+}
@@ -0,0 +1,248 @@
+#include "db/repo/replay_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <cjson/cJSON.h>
+
+#include "db/repo/match_repo.h"
+
+#define RC_BUCKETS 1024
+
+typedef struct rc_node {
+    uint32_t match_id;
+    char *json;
+    size_t len;
+
+    struct rc_node *prev;       // LRU list, head = most recent
+    struct rc_node *next;
+    struct rc_node *hash_next;
+} rc_node_t;
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static rc_node_t *g_buckets[RC_BUCKETS];
+static rc_node_t *g_head;
+static rc_node_t *g_tail;
+static replay_cache_stats_t g_stats;
+static bool g_prewarm;
+
+static pthread_once_t g_limits_once = PTHREAD_ONCE_INIT;
+
+//==============================================================================
+// HELPERS
+//==============================================================================
+
+static void load_limits(void) {
+    const char *entries = getenv(ENV_REPLAY_CACHE_MAX_ENTRIES);
+    const char *bytes = getenv(ENV_REPLAY_CACHE_MAX_BYTES);
+    const char *prewarm = getenv(ENV_REPLAY_CACHE_PREWARM);
+
+    g_stats.max_entries = (entries && *entries) ? (size_t)atol(entries) : REPLAY_CACHE_MAX_ENTRIES_DEFAULT;
+    g_stats.max_bytes = (bytes && *bytes) ? (size_t)atol(bytes) : REPLAY_CACHE_MAX_BYTES_DEFAULT;
+    g_prewarm = prewarm && atoi(prewarm) != 0;
+
+    printf("[REPLAY_CACHE] max %zu entries / %zu bytes, prewarm %s\n",
+           g_stats.max_entries, g_stats.max_bytes, g_prewarm ? "on" : "off");
+}
+
+static unsigned hash_id(uint32_t id) {
+    return (id * 2654435761u) % RC_BUCKETS;
+}
+
+//==============================================================================
+// LRU (caller holds g_lock)
+//==============================================================================
+
+static void lru_unlink(rc_node_t *n) {
+    if (n->prev) n->prev->next = n->next; else g_head = n->next;
+    if (n->next) n->next->prev = n->prev; else g_tail = n->prev;
+    n->prev = n->next = NULL;
+}
+
+static void lru_push_front(rc_node_t *n) {
+    n->prev = NULL;
+    n->next = g_head;
+    if (g_head) g_head->prev = n;
+    g_head = n;
+    if (!g_tail) g_tail = n;
+}
+
+static rc_node_t *find_node(uint32_t match_id) {
+    for (rc_node_t *n = g_buckets[hash_id(match_id)]; n; n = n->hash_next) {
+        if (n->match_id == match_id) return n;
+    }
+    return NULL;
+}
+
+static void node_remove(rc_node_t *n) {
+    rc_node_t **pp = &g_buckets[hash_id(n->match_id)];
+    while (*pp && *pp != n) pp = &(*pp)->hash_next;
+    if (*pp) *pp = n->hash_next;
+
+    lru_unlink(n);
+    g_stats.entries--;
+    g_stats.bytes -= n->len;
+
+    free(n->json);
+    free(n);
+}
+
+// Takes ownership of json
+static void cache_insert(uint32_t match_id, char *json, size_t len) {
+    if (len > g_stats.max_bytes) {
+        free(json);
+        return;
+    }
+
+    rc_node_t *old = find_node(match_id);
+    if (old) node_remove(old);
+
+    rc_node_t *n = calloc(1, sizeof(*n));
+    if (!n) {
+        free(json);
+        return;
+    }
+    n->match_id = match_id;
+    n->json = json;
+    n->len = len;
+
+    unsigned b = hash_id(match_id);
+    n->hash_next = g_buckets[b];
+    g_buckets[b] = n;
+    lru_push_front(n);
+    g_stats.entries++;
+    g_stats.bytes += len;
+
+    while (g_tail && g_tail != n &&
+           (g_stats.entries > g_stats.max_entries || g_stats.bytes > g_stats.max_bytes)) {
+        node_remove(g_tail);
+        g_stats.evictions++;
+    }
+}
+
+//==============================================================================
+// LOADING
+//==============================================================================
+
+/**
+ * Build the payload from the DB and store it when the match is finished.
+ * Returns a private copy for the caller when out_json is set.
+ */
+static db_error_t load_detail(uint32_t match_id, char **out_json, size_t *out_len) {
+    cJSON *detail = NULL;
+    db_error_t err = db_match_get_detail(match_id, &detail);
+    if (err != DB_SUCCESS || !detail) {
+        if (detail) cJSON_Delete(detail);
+        return err != DB_SUCCESS ? err : DB_ERROR_NOT_FOUND;
+    }
+
+    bool finished = cJSON_IsTrue(cJSON_GetObjectItem(detail, "finished"));
+    char *json = cJSON_PrintUnformatted(detail);
+    cJSON_Delete(detail);
+    if (!json) return DB_ERROR_INTERNAL;
+
+    size_t len = strlen(json);
+
+    // Still running: hand it out, don't keep it
+    if (!finished) {
+        if (out_json) {
+            *out_json = json;
+            if (out_len) *out_len = len;
+        } else {
+            free(json);
+        }
+        return DB_SUCCESS;
+    }
+
+    if (out_json) {
+        char *copy = malloc(len + 1);
+        if (!copy) {
+            free(json);
+            return DB_ERROR_INTERNAL;
+        }
+        memcpy(copy, json, len + 1);
+        *out_json = copy;
+        if (out_len) *out_len = len;
+    }
+
+    pthread_mutex_lock(&g_lock);
+    cache_insert(match_id, json, len);
+    pthread_mutex_unlock(&g_lock);
+    return DB_SUCCESS;
+}
+
+//==============================================================================
+// PUBLIC API
+//==============================================================================
+
+db_error_t replay_cache_get(uint32_t match_id, char **out_json, size_t *out_len) {
+    if (match_id == 0 || !out_json) return DB_ERROR_INVALID_PARAM;
+    pthread_once(&g_limits_once, load_limits);
+
+    pthread_mutex_lock(&g_lock);
+    rc_node_t *n = find_node(match_id);
+    if (n) {
+        char *copy = malloc(n->len + 1);
+        if (!copy) {
+            pthread_mutex_unlock(&g_lock);
+            return DB_ERROR_INTERNAL;
+        }
+        memcpy(copy, n->json, n->len + 1);
+        size_t len = n->len;
+        lru_unlink(n);
+        lru_push_front(n);
+        g_stats.hits++;
+        pthread_mutex_unlock(&g_lock);
+
+        *out_json = copy;
+        if (out_len) *out_len = len;
+        return DB_SUCCESS;
+    }
+    g_stats.misses++;
+    pthread_mutex_unlock(&g_lock);
+
+    return load_detail(match_id, out_json, out_len);
+}
+
+void replay_cache_warm(uint32_t match_id) {
+    if (match_id == 0) return;
+    pthread_once(&g_limits_once, load_limits);
+    if (!g_prewarm) return;
+
+    pthread_mutex_lock(&g_lock);
+    bool cached = find_node(match_id) != NULL;
+    pthread_mutex_unlock(&g_lock);
+    if (cached) return;
+
+    db_error_t err = load_detail(match_id, NULL, NULL);
+    if (err != DB_SUCCESS) {
+        printf("[REPLAY_CACHE] Prewarm of match %u failed: %d\n", match_id, err);
+    }
+}
+
+void replay_cache_stats(replay_cache_stats_t *out) {
+    if (!out) return;
+    pthread_once(&g_limits_once, load_limits);
+    pthread_mutex_lock(&g_lock);
+    *out = g_stats;
+    pthread_mutex_unlock(&g_lock);
+}
+
+void replay_cache_report(void) {
+    replay_cache_stats_t s;
+    replay_cache_stats(&s);
+    uint64_t lookups = s.hits + s.misses;
+    printf("[REPLAY_CACHE] hit=%.1f%% (%llu/%llu) entries=%zu/%zu bytes=%zu/%zu evicted=%llu\n",
+           lookups ? 100.0 * (double)s.hits / (double)lookups : 0.0,
+           (unsigned long long)s.hits, (unsigned long long)lookups,
+           s.entries, s.max_entries, s.bytes, s.max_bytes,
+           (unsigned long long)s.evictions);
+}
+
+void replay_cache_clear(void) {
+    pthread_mutex_lock(&g_lock);
+    while (g_head) node_remove(g_head);
+    pthread_mutex_unlock(&g_lock);
+}
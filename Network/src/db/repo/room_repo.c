@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <time.h>                 // time()
 #include <stdbool.h>
+#include <stdarg.h>
 
 //==============================================================================
 // HELPER: Generate random 6-char room code
@@ -109,6 +110,115 @@ int room_repo_create(
     return 0;
 }
 
+//==============================================================================
+// CREATE ROOMS (BATCH)
+//==============================================================================
+
+// Append to a buffer sized by the caller; false once it would not fit
+static bool sql_appendf(char *buf, size_t cap, size_t *len, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf + *len, cap - *len, fmt, ap);
+    va_end(ap);
+    if (n < 0 || (size_t)n >= cap - *len) return false;
+    *len += (size_t)n;
+    return true;
+}
+
+// Single-quoted SQL literal, embedded quotes doubled
+static bool sql_append_literal(char *buf, size_t cap, size_t *len, const char *s) {
+    if (*len + strlen(s) * 2 + 3 > cap) return false;
+    buf[(*len)++] = '\'';
+    for (; *s; s++) {
+        if (*s == '\'') buf[(*len)++] = '\'';
+        buf[(*len)++] = *s;
+    }
+    buf[(*len)++] = '\'';
+    buf[*len] = '\0';
+    return true;
+}
+
+int room_repo_create_batch(room_repo_new_t *rooms, int count) {
+    if (!rooms || count <= 0) return 0;
+
+    size_t cap = 256;
+    int members = 0;
+    for (int i = 0; i < count; i++) {
+        rooms[i].room_id = 0;
+        // Codes are unique in the table: also within the batch
+        bool taken;
+        do {
+            generate_room_code(rooms[i].code);
+            taken = false;
+            for (int j = 0; j < i; j++) taken |= strcmp(rooms[j].code, rooms[i].code) == 0;
+        } while (taken);
+        cap += 128 + strlen(rooms[i].name) * 2;
+        members += rooms[i].member_count;
+    }
+    cap += (size_t)members * 32;
+
+    char *sql = malloc(cap);
+    if (!sql) return -1;
+    size_t len = 0;
+    bool ok = sql_appendf(sql, cap, &len, "INSERT INTO rooms (name, code, visibility, host_id, status, "
+                                          "mode, max_players, wager_mode) VALUES ");
+    for (int i = 0; ok && i < count; i++) {
+        const room_repo_new_t *r = &rooms[i];
+        ok = sql_appendf(sql, cap, &len, "%s(", i ? ", " : "") &&
+             sql_append_literal(sql, cap, &len, r->name) &&
+             sql_appendf(sql, cap, &len, ", '%s', '%s', %u, 'waiting', '%s', %u, %s)",
+                         r->code, r->visibility ? "private" : "public", r->host_id,
+                         r->mode ? "scoring" : "elimination", r->max_players,
+                         r->wager_enabled ? "TRUE" : "FALSE");
+    }
+    ok = ok && sql_appendf(sql, cap, &len, " ON CONFLICT (code) DO NOTHING RETURNING id, code");
+
+    cJSON *rows = NULL;
+    if (!ok || db_get("rooms", sql, &rows) != DB_OK) {
+        printf("[ROOM_REPO] ERROR: Creating %d room(s) failed\n", count);
+        cJSON_Delete(rows);
+        free(sql);
+        return -1;
+    }
+
+    // Returned rows are matched by code, not by position
+    int created = 0;
+    cJSON *row = NULL;
+    cJSON_ArrayForEach(row, rows) {
+        const cJSON *id = cJSON_GetObjectItem(row, "id");
+        const cJSON *code = cJSON_GetObjectItem(row, "code");
+        if (!cJSON_IsNumber(id) || !cJSON_IsString(code)) continue;
+        for (int i = 0; i < count; i++) {
+            if (rooms[i].room_id == 0 && strcmp(rooms[i].code, code->valuestring) == 0) {
+                rooms[i].room_id = (uint32_t)id->valueint;
+                created++;
+                break;
+            }
+        }
+    }
+    cJSON_Delete(rows);
+
+    len = 0;
+    int rows_out = 0;
+    ok = sql_appendf(sql, cap, &len, "INSERT INTO room_members (room_id, account_id) VALUES ");
+    for (int i = 0; ok && i < count; i++) {
+        if (rooms[i].room_id == 0) continue;
+        for (int m = 0; ok && m < rooms[i].member_count; m++) {
+            ok = sql_appendf(sql, cap, &len, "%s(%u, %u)", rows_out++ ? ", " : "",
+                             rooms[i].room_id, rooms[i].members[m]);
+        }
+    }
+    ok = ok && sql_appendf(sql, cap, &len, " ON CONFLICT DO NOTHING");
+    // Best-effort, like a join
+    if (rows_out > 0 && (!ok || db_get("room_members", sql, NULL) != DB_OK)) {
+        printf("[ROOM_REPO] WARN: Adding %d member(s) to %d new room(s) failed\n", rows_out, created);
+    }
+    free(sql);
+
+    printf("[ROOM_REPO] Created %d/%d room(s), %d member(s)\n", created, count, rows_out);
+    return created;
+}
+
 //==============================================================================
 // CLOSE ROOM (UPDATE status to 'closed')
 //==============================================================================
@@ -278,6 +388,27 @@ int room_repo_get_by_code(const char *code, room_t *out_room) {
     cJSON_Delete(json);
     return 0;
 }//==============================================================================
+// JOIN ROOM OPERATIONS
+//==============================================================================
+
+int room_repo_add_player(uint32_t room_id, uint32_t account_id) {
+    cJSON *payload = cJSON_CreateObject();
+    cJSON_AddNumberToObject(payload, "room_id", room_id);
+    cJSON_AddNumberToObject(payload, "account_id", account_id);
+
+    cJSON *response = NULL;
+    db_error_t rc = db_post("room_members", payload, &response);
+    cJSON_Delete(payload);
+    if (response) cJSON_Delete(response);
+
+    if (rc != DB_OK) {
+        printf("[ROOM_REPO] Failed to add player %u to room %u\n", account_id, room_id);
+        return -1;
+    }
+    return 0;
+}
+
+//==============================================================================
 // LEAVE ROOM OPERATIONS
 //==============================================================================
 
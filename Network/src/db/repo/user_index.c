@@ -0,0 +1,708 @@
+#include "db/repo/user_index.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <cjson/cJSON.h>
+
+#include "db/core/db_client.h"
+
+#define UI_TRI_BUCKETS      8192
+#define UI_MAIL_BUCKETS     8192
+#define UI_KEY_MAX_LEVEL    24
+#define UI_MAX_QUERY        128
+
+#define UI_SCORE_EXACT      1000
+#define UI_SCORE_PREFIX     800     // full name starts with query
+#define UI_SCORE_WORD       600     // a later word of the name starts with query
+#define UI_SCORE_FUZZY      500     // scaled by trigram overlap
+#define UI_FUZZY_MIN_SHARE  0.5     // share of the query's trigrams that must match
+
+typedef struct {
+    int32_t account_id;
+    char *email;
+    char *name;
+    char *avatar;
+    char *email_lc;
+    char *name_lc;
+    uint32_t *tris;             // sorted, unique (name only)
+    int ntris;
+    int32_t mail_next;          // email bucket chain: entry index + 1, 0 = end
+    bool profile_live;          // written after startup, preload must not override
+} ui_entry_t;
+
+// Name prefix keys: skip list ordered by (key, entry)
+typedef struct ui_key ui_key_t;
+struct ui_key {
+    const char *key;            // points into the entry's name_lc
+    int32_t entry;
+    bool word;                  // true = later word of the name
+    int level;
+    ui_key_t *next[];           // `level` links
+};
+
+typedef struct ui_post {
+    uint32_t tri;
+    int32_t *entries;
+    int count;
+    int cap;
+    struct ui_post *next;
+} ui_post_t;
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool g_ready;
+
+static ui_entry_t *g_entries;
+static int32_t g_count;
+static int32_t g_cap;
+
+// account_id -> entry index (open addressing, ids are never removed)
+static int32_t *g_slot_ids;
+static int32_t *g_slot_entries;
+static int32_t g_slot_cap;
+
+// Prefix keys (names only: emails are never prefix-matched)
+static ui_key_t *g_key_head;    // sentinel with UI_KEY_MAX_LEVEL links
+static int g_key_level = 1;
+static int32_t g_key_count;
+static uint32_t g_key_rng = 2463534242u;
+
+// Exact email lookup: email_lc hash -> entry chain (entry index + 1, 0 = empty)
+static int32_t g_mail_heads[UI_MAIL_BUCKETS];
+
+static ui_post_t *g_posts[UI_TRI_BUCKETS];
+
+// Search scratch, one slot per entry
+static int *g_scores;
+static int32_t g_scores_cap;
+
+//==============================================================================
+// HELPERS
+//==============================================================================
+
+static char *dup_or_null(const char *s) {
+    return (s && *s) ? strdup(s) : NULL;
+}
+
+static char *lower_dup(const char *s) {
+    if (!s || !*s) return NULL;
+    char *out = strdup(s);
+    if (!out) return NULL;
+    for (char *p = out; *p; p++) *p = (char)tolower((unsigned char)*p);
+    return out;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t hash_str(const char *s) {
+    uint32_t h = 2166136261u;     // FNV-1a
+    for (; *s; s++) h = (h ^ (unsigned char)*s) * 16777619u;
+    return h;
+}
+
+// Distinct trigrams of up to two strings, sorted; caller frees
+static uint32_t *make_trigrams(const char *a, const char *b, int *out_n) {
+    size_t la = a ? strlen(a) : 0;
+    size_t lb = b ? strlen(b) : 0;
+    size_t cap = (la >= 3 ? la - 2 : 0) + (lb >= 3 ? lb - 2 : 0);
+    *out_n = 0;
+    if (cap == 0) return NULL;
+
+    uint32_t *tris = malloc(sizeof(uint32_t) * cap);
+    if (!tris) return NULL;
+
+    int n = 0;
+    const char *strs[2] = { a, b };
+    size_t lens[2] = { la, lb };
+    for (int s = 0; s < 2; s++) {
+        const unsigned char *p = (const unsigned char *)strs[s];
+        for (size_t i = 0; i + 2 < lens[s]; i++) {
+            tris[n++] = ((uint32_t)p[i] << 16) | ((uint32_t)p[i + 1] << 8) | p[i + 2];
+        }
+    }
+
+    qsort(tris, (size_t)n, sizeof(uint32_t), cmp_u32);
+    int w = 0;
+    for (int i = 0; i < n; i++) {
+        if (w == 0 || tris[w - 1] != tris[i]) tris[w++] = tris[i];
+    }
+    *out_n = w;
+    return tris;
+}
+
+//==============================================================================
+// ACCOUNT MAP (caller holds g_lock)
+//==============================================================================
+
+static uint32_t slot_hash(int32_t id, int32_t cap) {
+    return ((uint32_t)id * 2654435761u) & (uint32_t)(cap - 1);
+}
+
+static bool slots_grow(void) {
+    int32_t cap = g_slot_cap ? g_slot_cap * 2 : 1024;
+    int32_t *ids = calloc((size_t)cap, sizeof(int32_t));
+    int32_t *entries = calloc((size_t)cap, sizeof(int32_t));
+    if (!ids || !entries) {
+        free(ids);
+        free(entries);
+        return false;
+    }
+
+    for (int32_t i = 0; i < g_slot_cap; i++) {
+        if (g_slot_ids[i] == 0) continue;
+        uint32_t h = slot_hash(g_slot_ids[i], cap);
+        while (ids[h] != 0) h = (h + 1) & (uint32_t)(cap - 1);
+        ids[h] = g_slot_ids[i];
+        entries[h] = g_slot_entries[i];
+    }
+
+    free(g_slot_ids);
+    free(g_slot_entries);
+    g_slot_ids = ids;
+    g_slot_entries = entries;
+    g_slot_cap = cap;
+    return true;
+}
+
+static int32_t find_entry(int32_t account_id) {
+    if (g_slot_cap == 0) return -1;
+    uint32_t h = slot_hash(account_id, g_slot_cap);
+    while (g_slot_ids[h] != 0) {
+        if (g_slot_ids[h] == account_id) return g_slot_entries[h];
+        h = (h + 1) & (uint32_t)(g_slot_cap - 1);
+    }
+    return -1;
+}
+
+static int32_t get_or_add_entry(int32_t account_id) {
+    int32_t idx = find_entry(account_id);
+    if (idx >= 0) return idx;
+
+    // Keep the map at most half full
+    if ((g_count + 1) * 2 > g_slot_cap && !slots_grow()) return -1;
+    if (g_count == g_cap) {
+        int32_t cap = g_cap ? g_cap * 2 : 256;
+        ui_entry_t *entries = realloc(g_entries, sizeof(ui_entry_t) * (size_t)cap);
+        if (!entries) return -1;
+        g_entries = entries;
+        g_cap = cap;
+    }
+
+    idx = g_count++;
+    memset(&g_entries[idx], 0, sizeof(ui_entry_t));
+    g_entries[idx].account_id = account_id;
+
+    uint32_t h = slot_hash(account_id, g_slot_cap);
+    while (g_slot_ids[h] != 0) h = (h + 1) & (uint32_t)(g_slot_cap - 1);
+    g_slot_ids[h] = account_id;
+    g_slot_entries[h] = idx;
+    return idx;
+}
+
+//==============================================================================
+// POSTINGS / KEYS (caller holds g_lock)
+//==============================================================================
+
+static ui_post_t *find_post(uint32_t tri, bool create) {
+    uint32_t b = (tri * 2654435761u) % UI_TRI_BUCKETS;
+    for (ui_post_t *p = g_posts[b]; p; p = p->next) {
+        if (p->tri == tri) return p;
+    }
+    if (!create) return NULL;
+
+    ui_post_t *p = calloc(1, sizeof(*p));
+    if (!p) return NULL;
+    p->tri = tri;
+    p->next = g_posts[b];
+    g_posts[b] = p;
+    return p;
+}
+
+static void post_add(uint32_t tri, int32_t entry) {
+    ui_post_t *p = find_post(tri, true);
+    if (!p) return;
+    if (p->count == p->cap) {
+        int cap = p->cap ? p->cap * 2 : 4;
+        int32_t *entries = realloc(p->entries, sizeof(int32_t) * (size_t)cap);
+        if (!entries) return;
+        p->entries = entries;
+        p->cap = cap;
+    }
+    p->entries[p->count++] = entry;
+}
+
+static void post_remove(uint32_t tri, int32_t entry) {
+    ui_post_t *p = find_post(tri, false);
+    if (!p) return;
+    for (int i = 0; i < p->count; i++) {
+        if (p->entries[i] == entry) {
+            p->entries[i] = p->entries[--p->count];
+            return;
+        }
+    }
+}
+
+// Key order: string, then entry (two users may share a name)
+static int key_cmp(const ui_key_t *k, const char *key, int32_t entry) {
+    int c = strcmp(k->key, key);
+    if (c != 0) return c;
+    return (k->entry > entry) - (k->entry < entry);
+}
+
+static int key_random_level(void) {
+    int level = 1;
+    for (;;) {
+        g_key_rng ^= g_key_rng << 13;
+        g_key_rng ^= g_key_rng >> 17;
+        g_key_rng ^= g_key_rng << 5;
+        if ((g_key_rng & 3) != 0 || level >= UI_KEY_MAX_LEVEL) break;  // p = 1/4
+        level++;
+    }
+    return level;
+}
+
+// Last node before (key, entry) on every level
+static void key_path(const char *key, int32_t entry, ui_key_t **update) {
+    ui_key_t *x = g_key_head;
+    for (int i = g_key_level - 1; i >= 0; i--) {
+        while (x->next[i] && key_cmp(x->next[i], key, entry) < 0) x = x->next[i];
+        update[i] = x;
+    }
+}
+
+static void key_add(const char *key, int32_t entry, bool word) {
+    if (!g_key_head) {
+        g_key_head = calloc(1, sizeof(ui_key_t) + sizeof(ui_key_t *) * UI_KEY_MAX_LEVEL);
+        if (!g_key_head) return;
+        g_key_head->level = UI_KEY_MAX_LEVEL;
+    }
+
+    int level = key_random_level();
+    ui_key_t *k = malloc(sizeof(ui_key_t) + sizeof(ui_key_t *) * (size_t)level);
+    if (!k) return;
+    k->key = key;
+    k->entry = entry;
+    k->word = word;
+    k->level = level;
+
+    ui_key_t *update[UI_KEY_MAX_LEVEL];
+    key_path(key, entry, update);
+    for (int i = g_key_level; i < level; i++) update[i] = g_key_head;
+    if (level > g_key_level) g_key_level = level;
+
+    for (int i = 0; i < level; i++) {
+        k->next[i] = update[i]->next[i];
+        update[i]->next[i] = k;
+    }
+    g_key_count++;
+}
+
+static void key_remove(const char *key, int32_t entry) {
+    if (!g_key_head) return;
+
+    ui_key_t *update[UI_KEY_MAX_LEVEL];
+    key_path(key, entry, update);
+    ui_key_t *k = update[0]->next[0];
+    if (!k || key_cmp(k, key, entry) != 0) return;
+
+    for (int i = 0; i < k->level; i++) update[i]->next[i] = k->next[i];
+    while (g_key_level > 1 && !g_key_head->next[g_key_level - 1]) g_key_level--;
+    free(k);
+    g_key_count--;
+}
+
+// Full name, then every later word of it
+static void name_keys(int32_t idx, bool add) {
+    const char *name = g_entries[idx].name_lc;
+    if (!name) return;
+
+    for (const char *p = name; *p; p++) {
+        bool word = p != name;
+        if (word && !(p[-1] == ' ' && *p != ' ')) continue;
+        if (add) key_add(p, idx, word);
+        else key_remove(p, idx);
+    }
+}
+
+static void mail_add(int32_t idx) {
+    uint32_t b = hash_str(g_entries[idx].email_lc) % UI_MAIL_BUCKETS;
+    g_entries[idx].mail_next = g_mail_heads[b];
+    g_mail_heads[b] = idx + 1;
+}
+
+static void mail_remove(int32_t idx) {
+    uint32_t b = hash_str(g_entries[idx].email_lc) % UI_MAIL_BUCKETS;
+    for (int32_t *link = &g_mail_heads[b]; *link; link = &g_entries[*link - 1].mail_next) {
+        if (*link == idx + 1) {
+            *link = g_entries[idx].mail_next;
+            g_entries[idx].mail_next = 0;
+            return;
+        }
+    }
+}
+
+static int32_t mail_find(const char *email_lc) {
+    uint32_t b = hash_str(email_lc) % UI_MAIL_BUCKETS;
+    for (int32_t i = g_mail_heads[b]; i; i = g_entries[i - 1].mail_next) {
+        if (strcmp(g_entries[i - 1].email_lc, email_lc) == 0) return i - 1;
+    }
+    return -1;
+}
+
+// O(log n) per key: the entry's own keys are looked up, nothing is scanned
+static void entry_unindex(int32_t idx) {
+    ui_entry_t *e = &g_entries[idx];
+
+    if (e->email_lc) mail_remove(idx);
+    name_keys(idx, false);
+
+    for (int i = 0; i < e->ntris; i++) post_remove(e->tris[i], idx);
+    free(e->tris);
+    e->tris = NULL;
+    e->ntris = 0;
+}
+
+static void entry_index(int32_t idx) {
+    ui_entry_t *e = &g_entries[idx];
+
+    if (e->email_lc) mail_add(idx);
+    name_keys(idx, true);
+
+    e->tris = make_trigrams(e->name_lc, NULL, &e->ntris);
+    for (int i = 0; i < e->ntris; i++) post_add(e->tris[i], idx);
+}
+
+static void set_account_locked(int32_t account_id, const char *email, bool from_load) {
+    int32_t idx = get_or_add_entry(account_id);
+    if (idx < 0) return;
+    ui_entry_t *e = &g_entries[idx];
+    if (from_load && e->email) return;
+
+    entry_unindex(idx);
+    free(e->email);
+    free(e->email_lc);
+    e->email = dup_or_null(email);
+    e->email_lc = lower_dup(email);
+    entry_index(idx);
+}
+
+static void set_profile_locked(int32_t account_id, const char *name, const char *avatar, bool from_load) {
+    int32_t idx = get_or_add_entry(account_id);
+    if (idx < 0) return;
+    ui_entry_t *e = &g_entries[idx];
+    if (from_load && e->profile_live) return;
+    if (!from_load) e->profile_live = true;
+
+    entry_unindex(idx);
+    free(e->name);
+    free(e->name_lc);
+    free(e->avatar);
+    e->name = dup_or_null(name);
+    e->name_lc = lower_dup(name);
+    e->avatar = dup_or_null(avatar);
+    entry_index(idx);
+}
+
+//==============================================================================
+// PRELOAD
+//==============================================================================
+
+static const char *row_string(cJSON *row, const char *key) {
+    cJSON *item = cJSON_GetObjectItem(row, key);
+    return (item && cJSON_IsString(item)) ? item->valuestring : NULL;
+}
+
+static int row_int(cJSON *row, const char *key) {
+    cJSON *item = cJSON_GetObjectItem(row, key);
+    return (item && cJSON_IsNumber(item)) ? item->valueint : 0;
+}
+
+int user_index_preload(void) {
+    cJSON *accounts = NULL;
+    cJSON *profiles = NULL;
+
+    db_error_t err = db_get("accounts", "SELECT id, email FROM accounts", &accounts);
+    if (err == DB_OK) {
+        err = db_get("profiles", "SELECT account_id, name, avatar FROM profiles", &profiles);
+    }
+    if (err != DB_OK || !cJSON_IsArray(accounts) || !cJSON_IsArray(profiles)) {
+        printf("[USER_INDEX] Preload failed (rc=%d), search limited to exact lookups\n", err);
+        if (accounts) cJSON_Delete(accounts);
+        if (profiles) cJSON_Delete(profiles);
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_lock);
+    cJSON *row = NULL;
+    cJSON_ArrayForEach(row, accounts) {
+        int id = row_int(row, "id");
+        if (id > 0) set_account_locked(id, row_string(row, "email"), true);
+    }
+    cJSON_ArrayForEach(row, profiles) {
+        int id = row_int(row, "account_id");
+        if (id > 0) set_profile_locked(id, row_string(row, "name"), row_string(row, "avatar"), true);
+    }
+
+    g_ready = true;
+    printf("[USER_INDEX] Loaded %d users (%d prefix keys)\n", g_count, g_key_count);
+    pthread_mutex_unlock(&g_lock);
+
+    cJSON_Delete(accounts);
+    cJSON_Delete(profiles);
+    return 0;
+}
+
+bool user_index_ready(void) {
+    pthread_mutex_lock(&g_lock);
+    bool ready = g_ready;
+    pthread_mutex_unlock(&g_lock);
+    return ready;
+}
+
+//==============================================================================
+// UPDATES
+//==============================================================================
+
+void user_index_put_account(int32_t account_id, const char *email) {
+    if (account_id <= 0) return;
+    pthread_mutex_lock(&g_lock);
+    set_account_locked(account_id, email, false);
+    pthread_mutex_unlock(&g_lock);
+}
+
+void user_index_put_profile(int32_t account_id, const char *name, const char *avatar) {
+    if (account_id <= 0) return;
+    pthread_mutex_lock(&g_lock);
+    set_profile_locked(account_id, name, avatar, false);
+    pthread_mutex_unlock(&g_lock);
+}
+
+//==============================================================================
+// SEARCH (caller holds g_lock)
+//==============================================================================
+
+static int32_t *g_touched;
+static int32_t g_touched_count;
+
+static void bump(int32_t entry, int score) {
+    if (g_scores[entry] == 0) g_touched[g_touched_count++] = entry;
+    if (score > g_scores[entry]) g_scores[entry] = score;
+}
+
+static bool scratch_reserve(void) {
+    if (g_scores_cap >= g_count) return true;
+    int32_t cap = g_count + 256;
+    int *scores = realloc(g_scores, sizeof(int) * (size_t)cap);
+    if (!scores) return false;
+    g_scores = scores;
+    int32_t *touched = realloc(g_touched, sizeof(int32_t) * (size_t)cap);
+    if (!touched) return false;
+    g_touched = touched;
+    memset(g_scores + g_scores_cap, 0, sizeof(int) * (size_t)(cap - g_scores_cap));
+    g_scores_cap = cap;
+    return true;
+}
+
+static void match_exact_email(const char *q) {
+    if (!strchr(q, '@')) return;
+    int32_t entry = mail_find(q);
+    if (entry >= 0) bump(entry, UI_SCORE_EXACT);
+}
+
+static void match_prefix(const char *q, size_t qlen) {
+    if (!g_key_head) return;
+
+    // First key >= q, then every key starting with it
+    ui_key_t *x = g_key_head;
+    for (int i = g_key_level - 1; i >= 0; i--) {
+        while (x->next[i] && strcmp(x->next[i]->key, q) < 0) x = x->next[i];
+    }
+
+    for (const ui_key_t *k = x->next[0]; k && strncmp(k->key, q, qlen) == 0; k = k->next[0]) {
+        const ui_entry_t *e = &g_entries[k->entry];
+
+        int score;
+        if (!k->word && strcmp(e->name_lc, q) == 0) {
+            score = UI_SCORE_EXACT;
+        } else {
+            // Shorter completions rank higher
+            size_t rest = strlen(k->key) - qlen;
+            score = (k->word ? UI_SCORE_WORD : UI_SCORE_PREFIX) - (int)(rest > 100 ? 100 : rest);
+        }
+        bump(k->entry, score);
+    }
+}
+
+static void match_fuzzy(const char *q) {
+    int qn = 0;
+    uint32_t *qtris = make_trigrams(q, NULL, &qn);
+    if (!qtris) return;
+
+    // Shared-trigram counts, kept in g_scores as negatives until scored.
+    // Entries that already have a prefix score keep it (always higher).
+    int32_t first_new = g_touched_count;
+    for (int i = 0; i < qn; i++) {
+        ui_post_t *p = find_post(qtris[i], false);
+        if (!p) continue;
+        for (int j = 0; j < p->count; j++) {
+            int32_t entry = p->entries[j];
+            if (g_scores[entry] == 0) g_touched[g_touched_count++] = entry;
+            if (g_scores[entry] <= 0) g_scores[entry]--;
+        }
+    }
+
+    for (int32_t i = first_new; i < g_touched_count; i++) {
+        int32_t entry = g_touched[i];
+        if (g_scores[entry] >= 0) continue;
+        int shared = -g_scores[entry];
+        double share = (double)shared / (double)qn;
+        double dice = 2.0 * shared / (double)(qn + g_entries[entry].ntris);
+        // Mostly "how much of the query is there", Dice breaks ties by length
+        g_scores[entry] = share >= UI_FUZZY_MIN_SHARE
+            ? (int)((0.8 * share + 0.2 * dice) * UI_SCORE_FUZZY) : 0;
+    }
+    free(qtris);
+}
+
+static bool hit_better(int score, int32_t id, const user_index_hit_t *h) {
+    return score > h->score || (score == h->score && id < h->account_id);
+}
+
+int user_index_search(
+    const char *query,
+    int32_t exclude_account_id,
+    int limit,
+    user_index_hit_t *out_hits
+) {
+    if (!query || !out_hits) return 0;
+    if (limit <= 0) limit = USER_INDEX_DEFAULT_LIMIT;
+    if (limit > USER_INDEX_MAX_LIMIT) limit = USER_INDEX_MAX_LIMIT;
+
+    // Lowercase, trimmed copy of the query
+    while (*query == ' ') query++;
+    char q[UI_MAX_QUERY];
+    size_t qlen = 0;
+    for (; query[qlen] && qlen < sizeof(q) - 1; qlen++) {
+        q[qlen] = (char)tolower((unsigned char)query[qlen]);
+    }
+    while (qlen > 0 && q[qlen - 1] == ' ') qlen--;
+    q[qlen] = '\0';
+    if (qlen == 0) return 0;
+
+    pthread_mutex_lock(&g_lock);
+    if (!g_ready || !scratch_reserve()) {
+        pthread_mutex_unlock(&g_lock);
+        return 0;
+    }
+
+    g_touched_count = 0;
+    match_exact_email(q);
+    match_prefix(q, qlen);
+    if (qlen >= 3) match_fuzzy(q);
+
+    // Top-k by insertion into the (small) output array
+    int n = 0;
+    for (int32_t i = 0; i < g_touched_count; i++) {
+        int32_t entry = g_touched[i];
+        int score = g_scores[entry];
+        g_scores[entry] = 0;
+
+        int32_t id = g_entries[entry].account_id;
+        if (score <= 0 || id == exclude_account_id) continue;
+        if (n == limit && !hit_better(score, id, &out_hits[n - 1])) continue;
+
+        int pos = n < limit ? n++ : n - 1;
+        while (pos > 0 && hit_better(score, id, &out_hits[pos - 1])) {
+            out_hits[pos] = out_hits[pos - 1];
+            pos--;
+        }
+        out_hits[pos].account_id = id;
+        out_hits[pos].score = score;
+        out_hits[pos].name = NULL;
+        out_hits[pos].email = NULL;
+        out_hits[pos].avatar = NULL;
+    }
+
+    // Copy display fields only for the winners; the email only to whoever
+    // typed it in full
+    for (int i = 0; i < n; i++) {
+        const ui_entry_t *e = &g_entries[find_entry(out_hits[i].account_id)];
+        bool email_hit = e->email_lc && strcmp(e->email_lc, q) == 0;
+        out_hits[i].name = dup_or_null(e->name);
+        out_hits[i].email = email_hit ? dup_or_null(e->email) : NULL;
+        out_hits[i].avatar = dup_or_null(e->avatar);
+    }
+    pthread_mutex_unlock(&g_lock);
+    return n;
+}
+
+void user_index_hits_free(user_index_hit_t *hits, int count) {
+    if (!hits) return;
+    for (int i = 0; i < count; i++) {
+        free(hits[i].name);
+        free(hits[i].email);
+        free(hits[i].avatar);
+        hits[i].name = hits[i].email = hits[i].avatar = NULL;
+    }
+}
+
+//==============================================================================
+// CLEANUP
+//==============================================================================
+
+void user_index_cleanup(void) {
+    pthread_mutex_lock(&g_lock);
+    for (int32_t i = 0; i < g_count; i++) {
+        ui_entry_t *e = &g_entries[i];
+        free(e->email);
+        free(e->name);
+        free(e->avatar);
+        free(e->email_lc);
+        free(e->name_lc);
+        free(e->tris);
+    }
+    free(g_entries);
+    g_entries = NULL;
+    g_count = g_cap = 0;
+
+    free(g_slot_ids);
+    free(g_slot_entries);
+    g_slot_ids = g_slot_entries = NULL;
+    g_slot_cap = 0;
+
+    ui_key_t *k = g_key_head;
+    while (k) {
+        ui_key_t *next = k->next[0];
+        free(k);
+        k = next;
+    }
+    g_key_head = NULL;
+    g_key_level = 1;
+    g_key_count = 0;
+    memset(g_mail_heads, 0, sizeof(g_mail_heads));
+
+    for (int b = 0; b < UI_TRI_BUCKETS; b++) {
+        ui_post_t *p = g_posts[b];
+        while (p) {
+            ui_post_t *next = p->next;
+            free(p->entries);
+            free(p);
+            p = next;
+        }
+        g_posts[b] = NULL;
+    }
+
+    free(g_scores);
+    free(g_touched);
+    g_scores = NULL;
+    g_touched = NULL;
+    g_scores_cap = 0;
+    g_ready = false;
+    pthread_mutex_unlock(&g_lock);
+}
@@ -1,6 +1,6 @@
 #include "handlers/auth_guard.h"
 #include "handlers/session_context.h"
-#include "db/repo/session_repo.h"
+#include "handlers/session_manager.h"
 #include "protocol/opcode.h"
 #include <string.h>
 
@@ -12,8 +12,9 @@ bool require_auth(int client_fd, MessageHeader *req) {
         return false;
     }
 
-    // Validate session still active in DB/cache
-    if (!session_is_valid(sid)) {
+    // In-memory session state is authoritative (no DB round-trip per
+    // command); logout, expiry and revocation drop it explicitly
+    if (!session_validate_socket(client_fd, sid)) {
         clear_client_session(client_fd);
         const char *msg = "Session invalid";
         forward_response(client_fd, req, ERR_NOT_LOGGED_IN, msg, strlen(msg));
@@ -9,6 +9,7 @@
 #include "db/repo/profile_repo.h"
 #include "handlers/session_context.h"
 #include "handlers/presence_manager.h"
+#include "handlers/match_snapshot.h"
 #include "transport/room_manager.h"
 #include "handlers/session_manager.h"
 #include "protocol/protocol.h"
@@ -220,6 +221,11 @@ void handle_login(
 
     send_response(client_fd, header, RES_LOGIN_OK, response);
 
+    // Back into a running match: one game-state frame from its shard
+    if (bound->state == SESSION_PLAYING) {
+        match_snapshot_request(client_fd, account->id, header);
+    }
+
     printf("[AUTH] Login successful: account_id=%d, session_id=%s\n", 
            account->id, session->session_id);
 
@@ -594,6 +600,11 @@ void handle_reconnect(
 
     send_response(client_fd, header, RES_LOGIN_OK, response);
 
+    // Back into a running match: one game-state frame from its shard
+    if (bound->state == SESSION_PLAYING) {
+        match_snapshot_request(client_fd, account->id, header);
+    }
+
     printf("[AUTH] Reconnect successful: account_id=%d, session_id=%s\n", 
            account->id, session->session_id);
 
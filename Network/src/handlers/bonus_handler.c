@@ -6,9 +6,9 @@
  * Uses a card-drawing mechanism to randomly select one player.
  * 
  * STATE USAGE:
- * - Score: MatchPlayerState.score - READ via get_match_player()
+ * - Score: MatchPlayerState.score - READ via round_match_player()
  * - Eliminated: MatchPlayerState.eliminated - READ/UPDATE
- * - Connected: UserSession.state - READ via session_get_by_account()
+ * - Connected: UserSession.state - READ via round_match_socket()
  * 
  * LOCAL TRACKING (Bonus-specific):
  * - participants[]: Players who are tied and must draw
@@ -32,15 +32,17 @@
 #include <arpa/inet.h>
 #include <time.h>
 #include <unistd.h>
-#include <pthread.h>
 
 #include "handlers/bonus_handler.h"
 #include "handlers/session_manager.h"
 #include "handlers/match_manager.h"
 #include "handlers/start_game_handler.h"
+#include "handlers/match_snapshot.h"
 #include "handlers/end_game_handler.h"
-#include "db/core/db_client.h"
-#include "db/repo/match_repo.h"         // For db_match_event_insert, db_match_question_insert
+#include "handlers/match_executor.h"
+#include "handlers/spectator_handler.h"
+#include "handlers/round_engine.h"
+#include "db/repo/match_write_queue.h"  // For match_wq_question, match_wq_event, match_wq_player_update
 #include "protocol/opcode.h"
 #include "protocol/protocol.h"
 #include <cjson/cJSON.h>
@@ -97,80 +99,56 @@ typedef struct {
     
     time_t started_at;
     time_t reveal_at;
+    uint32_t step_seq;             // Token of the armed reveal / apply timer
 } BonusContext;
 
-static BonusContext g_bonus = {0};
-static pthread_mutex_t g_bonus_mutex = PTHREAD_MUTEX_INITIALIZER;
+// Context of each match lives in MatchState (created when a bonus triggers)
+// and is only touched from the match's executor shard
 
 // Forward declarations
-static MatchState* get_match(void);
-static MatchPlayerState* get_match_player(int32_t account_id);
-static bool is_connected(int32_t account_id);
-static int get_socket(int32_t account_id);
-static BonusParticipant* find_participant(int32_t account_id);
-static void send_json(int fd, MessageHeader *req, uint16_t cmd, const char *json);
-static void broadcast_to_all(MessageHeader *req, uint16_t cmd, const char *json);
-static void broadcast_to_participants(MessageHeader *req, uint16_t cmd, const char *json);
-static void shuffle_cards(void);
-static void initialize_bonus(uint32_t match_id, int after_round, BonusType type,
+static MatchState* get_match(BonusContext *ctx);
+static BonusParticipant* find_participant(BonusContext *ctx, int32_t account_id);
+static void broadcast_to_all(BonusContext *ctx, MessageHeader *req, uint16_t cmd, const char *json);
+static void broadcast_to_participants(BonusContext *ctx, MessageHeader *req, uint16_t cmd, const char *json);
+static void shuffle_cards(BonusContext *ctx);
+static void initialize_bonus(BonusContext *ctx, uint32_t match_id, int after_round, BonusType type,
                             int32_t *tied_players, int tied_count);
-static void notify_participants(MessageHeader *req);
-static void notify_spectators(MessageHeader *req);
-static void process_card_draw(int32_t account_id, MessageHeader *req);
-static void check_all_drawn(MessageHeader *req);
-static void reveal_results(MessageHeader *req);
-static void apply_results(MessageHeader *req);
-static void transition_to_next_phase(MessageHeader *req);
-static void reset_context(void);
+static void notify_participants(BonusContext *ctx, MessageHeader *req);
+static void notify_spectators(BonusContext *ctx, MessageHeader *req);
+static void process_card_draw(BonusContext *ctx, int32_t account_id, MessageHeader *req);
+static void check_all_drawn(BonusContext *ctx, MessageHeader *req);
+static void reveal_results(BonusContext *ctx, MessageHeader *req);
+static void apply_results(BonusContext *ctx, MessageHeader *req);
+static void transition_to_next_phase(BonusContext *ctx, MessageHeader *req);
+static void reset_context(BonusContext *ctx);
+static BonusContext* find_context(uint32_t match_id);
 
 //==============================================================================
 // HELPER: Get states from other PICs (READ ONLY)
 //==============================================================================
-static MatchState* get_match(void) {
-    if (g_bonus.match_id == 0) return NULL;
-    return match_get_by_id(g_bonus.match_id);
+static MatchState* get_match(BonusContext *ctx) {
+    if (ctx->match_id == 0) return NULL;
+    return match_get_by_id(ctx->match_id);
 }
 
-static MatchPlayerState* get_match_player(int32_t account_id) {
-    MatchState *match = get_match();
-    if (!match) return NULL;
-    for (int i = 0; i < match->player_count; i++) {
-        if (match->players[i].account_id == account_id) {
-            return &match->players[i];
-        }
-    }
-    return NULL;
-}
-
-static bool is_connected(int32_t account_id) {
-    UserSession *session = session_get_by_account(account_id);
-    if (!session) return false;
-    return session->state != SESSION_PLAYING_DISCONNECTED;
-}
-
-static int get_socket(int32_t account_id) {
-    UserSession *session = session_get_by_account(account_id);
-    if (session && session->state != SESSION_PLAYING_DISCONNECTED) {
-        return session->socket_fd;
-    }
-    return -1;
-}
+// Players, sessions and sockets: round_match_player() / round_match_socket()
+// (round_engine, session cache shared with the rounds)
 
 //==============================================================================
 // HELPER: Local tracking
 //==============================================================================
-static BonusParticipant* find_participant(int32_t account_id) {
-    for (int i = 0; i < g_bonus.participant_count; i++) {
-        if (g_bonus.participants[i].account_id == account_id) {
-            return &g_bonus.participants[i];
+static BonusParticipant* find_participant(BonusContext *ctx, int32_t account_id) {
+    for (int i = 0; i < ctx->participant_count; i++) {
+        if (ctx->participants[i].account_id == account_id) {
+            return &ctx->participants[i];
         }
     }
     return NULL;
 }
 
-static bool is_spectator(int32_t account_id) {
-    for (int i = 0; i < g_bonus.spectator_count; i++) {
-        if (g_bonus.spectators[i] == account_id) {
+static bool is_spectator(BonusContext *ctx, int32_t account_id) {
+    for (int i = 0; i < ctx->spectator_count; i++) {
+        if (ctx->spectators[i] == account_id) {
             return true;
         }
     }
@@ -180,85 +158,82 @@ static bool is_spectator(int32_t account_id) {
 //==============================================================================
 // HELPER: Response/Broadcast
 //==============================================================================
-static void send_json(int fd, MessageHeader *req, uint16_t cmd, const char *json) {
-    if (fd <= 0 || !json) return;
-    forward_response(fd, req, cmd, json, (uint32_t)strlen(json));
-}
-
-static void broadcast_to_all(MessageHeader *req, uint16_t cmd, const char *json) {
+static void broadcast_to_all(BonusContext *ctx, MessageHeader *req, uint16_t cmd, const char *json) {
     if (!json) return;
     
     // Send to participants
-    for (int i = 0; i < g_bonus.participant_count; i++) {
-        int fd = get_socket(g_bonus.participants[i].account_id);
-        if (fd > 0) {
-            forward_response(fd, req, cmd, json, (uint32_t)strlen(json));
-        }
-    }
+    broadcast_to_participants(ctx, req, cmd, json);
     
     // Send to spectators
-    for (int i = 0; i < g_bonus.spectator_count; i++) {
-        int fd = get_socket(g_bonus.spectators[i]);
-        if (fd > 0) {
-            forward_response(fd, req, cmd, json, (uint32_t)strlen(json));
-        }
+    MatchState *match = get_match(ctx);
+    for (int i = 0; i < ctx->spectator_count; i++) {
+        round_send_json(round_match_socket(match, ctx->spectators[i]), req, cmd, json);
     }
+
+    // And to the match's observers (spectator hub)
+    spectator_forward(ctx->match_id, cmd, json);
 }
 
-static void broadcast_to_participants(MessageHeader *req, uint16_t cmd, const char *json) {
+static void broadcast_to_participants(BonusContext *ctx, MessageHeader *req, uint16_t cmd, const char *json) {
     if (!json) return;
-    for (int i = 0; i < g_bonus.participant_count; i++) {
-        int fd = get_socket(g_bonus.participants[i].account_id);
-        if (fd > 0) {
-            forward_response(fd, req, cmd, json, (uint32_t)strlen(json));
-        }
+    MatchState *match = get_match(ctx);
+    for (int i = 0; i < ctx->participant_count; i++) {
+        round_send_json(round_match_socket(match, ctx->participants[i].account_id), req, cmd, json);
     }
 }
 
 //==============================================================================
 // HELPER: Shuffle cards (Fisher-Yates)
 //==============================================================================
-static void shuffle_cards(void) {
-    for (int i = g_bonus.total_cards - 1; i > 0; i--) {
+static void shuffle_cards(BonusContext *ctx) {
+    for (int i = ctx->total_cards - 1; i > 0; i--) {
         int j = rand() % (i + 1);
-        CardType tmp = g_bonus.card_stack[i];
-        g_bonus.card_stack[i] = g_bonus.card_stack[j];
-        g_bonus.card_stack[j] = tmp;
+        CardType tmp = ctx->card_stack[i];
+        ctx->card_stack[i] = ctx->card_stack[j];
+        ctx->card_stack[j] = tmp;
     }
 }
 
 //==============================================================================
 // HELPER: Reset context
 //==============================================================================
-static void reset_context(void) {
-    pthread_mutex_lock(&g_bonus_mutex);
-    memset(&g_bonus, 0, sizeof(g_bonus));
-    pthread_mutex_unlock(&g_bonus_mutex);
+static void reset_context(BonusContext *ctx) {
+    // Keep the step sequence so a pending timer stays stale
+    uint32_t step_seq = ctx->step_seq;
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->step_seq = step_seq + 1;
     printf("[Bonus] Context reset\n");
 }
 
+//==============================================================================
+// HELPER: Context of a match (NULL if no bonus was ever triggered there)
+//==============================================================================
+static BonusContext* find_context(uint32_t match_id) {
+    return match_context_find(match_id, MATCH_CTX_BONUS);
+}
+
 //==============================================================================
 // INITIALIZE BONUS ROUND
 //==============================================================================
-static void initialize_bonus(uint32_t match_id, int after_round, BonusType type,
+static void initialize_bonus(BonusContext *ctx, uint32_t match_id, int after_round, BonusType type,
                             int32_t *tied_players, int tied_count) {
-    pthread_mutex_lock(&g_bonus_mutex);
-    
     // Reset and setup
-    memset(&g_bonus, 0, sizeof(g_bonus));
-    g_bonus.match_id = match_id;
-    g_bonus.after_round = after_round;
-    g_bonus.type = type;
-    g_bonus.state = BONUS_STATE_INITIALIZING;
-    g_bonus.started_at = time(NULL);
+    uint32_t step_seq = ctx->step_seq;
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->step_seq = step_seq + 1;
+    ctx->match_id = match_id;
+    ctx->after_round = after_round;
+    ctx->type = type;
+    ctx->state = BONUS_STATE_INITIALIZING;
+    ctx->started_at = time(NULL);
     
     // Setup participants (tied players)
-    g_bonus.participant_count = tied_count;
+    ctx->participant_count = tied_count;
     for (int i = 0; i < tied_count; i++) {
-        g_bonus.participants[i].account_id = tied_players[i];
-        g_bonus.participants[i].state = PLAYER_BONUS_WAITING_TO_DRAW;
-        g_bonus.participants[i].drawn_card = CARD_TYPE_SAFE;
-        g_bonus.participants[i].drawn_at = 0;
+        ctx->participants[i].account_id = tied_players[i];
+        ctx->participants[i].state = PLAYER_BONUS_WAITING_TO_DRAW;
+        ctx->participants[i].drawn_card = CARD_TYPE_SAFE;
+        ctx->participants[i].drawn_at = 0;
     }
     
     // Setup spectators (other players in match)
@@ -274,25 +249,29 @@ static void initialize_bonus(uint32_t match_id, int after_round, BonusType type,
                 }
             }
             if (!is_participant) {
-                g_bonus.spectators[g_bonus.spectator_count++] = acc_id;
+                ctx->spectators[ctx->spectator_count++] = acc_id;
             }
         }
+
+        // Participants owe a draw, spectators have nothing to do
+        match_snapshot_begin(match, -1, 0);
+        for (int i = 0; i < tied_count; i++) {
+            match_snapshot_answer(match, tied_players[i], MATCH_ANSWER_PENDING, 0, 0);
+        }
     }
     
     // Create card stack: 1 ELIMINATED, rest SAFE
-    g_bonus.total_cards = tied_count;
-    g_bonus.cards_remaining = tied_count;
-    g_bonus.card_stack[0] = CARD_TYPE_ELIMINATED;
+    ctx->total_cards = tied_count;
+    ctx->cards_remaining = tied_count;
+    ctx->card_stack[0] = CARD_TYPE_ELIMINATED;
     for (int i = 1; i < tied_count; i++) {
-        g_bonus.card_stack[i] = CARD_TYPE_SAFE;
+        ctx->card_stack[i] = CARD_TYPE_SAFE;
     }
     
     // Shuffle cards
-    shuffle_cards();
-    
-    g_bonus.state = BONUS_STATE_DRAWING;
+    shuffle_cards(ctx);
     
-    pthread_mutex_unlock(&g_bonus_mutex);
+    ctx->state = BONUS_STATE_DRAWING;
     
     printf("[Bonus] Initialized: match=%u after_round=%d type=%s participants=%d\n",
            match_id, after_round,
@@ -303,39 +282,39 @@ static void initialize_bonus(uint32_t match_id, int after_round, BonusType type,
 //==============================================================================
 // NOTIFY PARTICIPANTS
 //==============================================================================
-static void notify_participants(MessageHeader *req) {
+static void notify_participants(BonusContext *ctx, MessageHeader *req) {
     cJSON *obj = cJSON_CreateObject();
     cJSON_AddStringToObject(obj, "role", "participant");
     cJSON_AddStringToObject(obj, "bonus_type", 
-        g_bonus.type == BONUS_TYPE_ELIMINATION ? "elimination" : "winner_selection");
-    cJSON_AddNumberToObject(obj, "after_round", g_bonus.after_round);
+        ctx->type == BONUS_TYPE_ELIMINATION ? "elimination" : "winner_selection");
+    cJSON_AddNumberToObject(obj, "after_round", ctx->after_round);
     
-    const char *reason = g_bonus.type == BONUS_TYPE_ELIMINATION 
+    const char *reason = ctx->type == BONUS_TYPE_ELIMINATION 
         ? "Tie at lowest score - one player will be eliminated"
         : "Tie at highest score - winner will be decided";
     cJSON_AddStringToObject(obj, "reason", reason);
     
     // List other participants
     cJSON *others = cJSON_CreateArray();
-    for (int i = 0; i < g_bonus.participant_count; i++) {
+    for (int i = 0; i < ctx->participant_count; i++) {
         cJSON *p = cJSON_CreateObject();
-        cJSON_AddNumberToObject(p, "account_id", g_bonus.participants[i].account_id);
+        cJSON_AddNumberToObject(p, "account_id", ctx->participants[i].account_id);
         
         char name[32];
-        snprintf(name, sizeof(name), "Player%d", g_bonus.participants[i].account_id);
+        snprintf(name, sizeof(name), "Player%d", ctx->participants[i].account_id);
         cJSON_AddStringToObject(p, "name", name);
         cJSON_AddItemToArray(others, p);
     }
     cJSON_AddItemToObject(obj, "participants", others);
     
-    cJSON_AddNumberToObject(obj, "total_cards", g_bonus.total_cards);
+    cJSON_AddNumberToObject(obj, "total_cards", ctx->total_cards);
     cJSON_AddStringToObject(obj, "instruction", "Click DRAW to draw a card from the stack");
     
     char *json = cJSON_PrintUnformatted(obj);
     cJSON_Delete(obj);
     
     if (json) {
-        broadcast_to_participants(req, OP_S2C_BONUS_PARTICIPANT, json);
+        broadcast_to_participants(ctx, req, OP_S2C_BONUS_PARTICIPANT, json);
         free(json);
     }
 }
@@ -343,22 +322,22 @@ static void notify_participants(MessageHeader *req) {
 //==============================================================================
 // NOTIFY SPECTATORS
 //==============================================================================
-static void notify_spectators(MessageHeader *req) {
+static void notify_spectators(BonusContext *ctx, MessageHeader *req) {
     cJSON *obj = cJSON_CreateObject();
     cJSON_AddStringToObject(obj, "role", "spectator");
     cJSON_AddStringToObject(obj, "bonus_type",
-        g_bonus.type == BONUS_TYPE_ELIMINATION ? "elimination" : "winner_selection");
-    cJSON_AddNumberToObject(obj, "after_round", g_bonus.after_round);
+        ctx->type == BONUS_TYPE_ELIMINATION ? "elimination" : "winner_selection");
+    cJSON_AddNumberToObject(obj, "after_round", ctx->after_round);
     cJSON_AddStringToObject(obj, "message", "Waiting for bonus round to complete");
     
     // List participants
     cJSON *participants = cJSON_CreateArray();
-    for (int i = 0; i < g_bonus.participant_count; i++) {
+    for (int i = 0; i < ctx->participant_count; i++) {
         cJSON *p = cJSON_CreateObject();
-        cJSON_AddNumberToObject(p, "account_id", g_bonus.participants[i].account_id);
+        cJSON_AddNumberToObject(p, "account_id", ctx->participants[i].account_id);
         
         char name[32];
-        snprintf(name, sizeof(name), "Player%d", g_bonus.participants[i].account_id);
+        snprintf(name, sizeof(name), "Player%d", ctx->participants[i].account_id);
         cJSON_AddStringToObject(p, "name", name);
         cJSON_AddItemToArray(participants, p);
     }
@@ -368,11 +347,10 @@ static void notify_spectators(MessageHeader *req) {
     cJSON_Delete(obj);
     
     if (json) {
-        for (int i = 0; i < g_bonus.spectator_count; i++) {
-            int fd = get_socket(g_bonus.spectators[i]);
-            if (fd > 0) {
-                forward_response(fd, req, OP_S2C_BONUS_SPECTATOR, json, (uint32_t)strlen(json));
-            }
+        MatchState *match = get_match(ctx);
+        for (int i = 0; i < ctx->spectator_count; i++) {
+            round_send_json(round_match_socket(match, ctx->spectators[i]), req,
+                            OP_S2C_BONUS_SPECTATOR, json);
         }
         free(json);
     }
@@ -432,7 +410,12 @@ bool check_and_trigger_bonus(uint32_t match_id, int after_round) {
            tied_count, bonus_type == BONUS_TYPE_ELIMINATION ? "ELIMINATION" : "WINNER_SELECTION");
     
     // Initialize bonus context
-    initialize_bonus(match_id, after_round, bonus_type, tied_players, tied_count);
+    BonusContext *ctx = match_context_get(match, MATCH_CTX_BONUS, sizeof(BonusContext), NULL);
+    if (!ctx) {
+        printf("[Bonus] Out of memory for bonus context\n");
+        return false;
+    }
+    initialize_bonus(ctx, match_id, after_round, bonus_type, tied_players, tied_count);
     
     // Create a dummy header for notifications
     MessageHeader dummy_hdr = {0};
@@ -440,8 +423,8 @@ bool check_and_trigger_bonus(uint32_t match_id, int after_round) {
     dummy_hdr.version = PROTOCOL_VERSION;
     
     // Notify all players
-    notify_participants(&dummy_hdr);
-    notify_spectators(&dummy_hdr);
+    notify_participants(ctx, &dummy_hdr);
+    notify_spectators(ctx, &dummy_hdr);
     
     return true;
 #endif
@@ -501,7 +484,12 @@ bool check_and_trigger_bonus(uint32_t match_id, int after_round) {
     printf("[Bonus] TRIGGERING BONUS ROUND for %d tied players\n", tied_count_prod);
     
     // Initialize bonus context
-    initialize_bonus(match_id, after_round, bonus_type_prod, tied_players_prod, tied_count_prod);
+    BonusContext *ctx = match_context_get(match, MATCH_CTX_BONUS, sizeof(BonusContext), NULL);
+    if (!ctx) {
+        printf("[Bonus] Out of memory for bonus context\n");
+        return false;
+    }
+    initialize_bonus(ctx, match_id, after_round, bonus_type_prod, tied_players_prod, tied_count_prod);
     
     // Create a dummy header for notifications
     MessageHeader dummy_hdr_prod = {0};
@@ -509,32 +497,19 @@ bool check_and_trigger_bonus(uint32_t match_id, int after_round) {
     dummy_hdr_prod.version = PROTOCOL_VERSION;
     
     // Notify all players
-    notify_participants(&dummy_hdr_prod);
-    notify_spectators(&dummy_hdr_prod);
-    
-    // Save to database
-    if (match->db_match_id > 0) {
-        cJSON *bonus_payload = cJSON_CreateObject();
-        cJSON_AddNumberToObject(bonus_payload, "match_id", match->db_match_id);
-        cJSON_AddNumberToObject(bonus_payload, "round_no", 4);  // Bonus is round 4
-        cJSON_AddStringToObject(bonus_payload, "round_type", "BONUS");
-        cJSON_AddNumberToObject(bonus_payload, "question_idx", 0);
-        
-        cJSON *question_data = cJSON_CreateObject();
-        cJSON_AddStringToObject(question_data, "type", 
-            bonus_type_prod == BONUS_TYPE_ELIMINATION ? "elimination" : "winner_selection");
-        cJSON_AddNumberToObject(question_data, "after_round", after_round);
-        cJSON_AddNumberToObject(question_data, "participant_count", tied_count_prod);
-        cJSON_AddItemToObject(bonus_payload, "question", question_data);
-        
-        cJSON *db_result = NULL;
-        db_error_t db_err = db_post("match_question", bonus_payload, &db_result);
-        if (db_err == DB_OK) {
-            printf("[Bonus] Saved bonus round to DB\n");
-        }
-        cJSON_Delete(bonus_payload);
-        if (db_result) cJSON_Delete(db_result);
-    }
+    notify_participants(ctx, &dummy_hdr_prod);
+    notify_spectators(ctx, &dummy_hdr_prod);
+    
+    // Save to database (write-behind, like the other gameplay records)
+    cJSON *question_data = cJSON_CreateObject();
+    cJSON_AddStringToObject(question_data, "type", 
+        bonus_type_prod == BONUS_TYPE_ELIMINATION ? "elimination" : "winner_selection");
+    cJSON_AddNumberToObject(question_data, "after_round", after_round);
+    cJSON_AddNumberToObject(question_data, "participant_count", tied_count_prod);
+    char *question_json = cJSON_PrintUnformatted(question_data);
+    cJSON_Delete(question_data);
+    match_wq_question(match->db_match_id, 4, "BONUS", 0, question_json);  // Bonus is round 4
+    free(question_json);
     
     return true;
 }
@@ -542,8 +517,8 @@ bool check_and_trigger_bonus(uint32_t match_id, int after_round) {
 //==============================================================================
 // PROCESS CARD DRAW
 //==============================================================================
-static void process_card_draw(int32_t account_id, MessageHeader *req) {
-    BonusParticipant *p = find_participant(account_id);
+static void process_card_draw(BonusContext *ctx, int32_t account_id, MessageHeader *req) {
+    BonusParticipant *p = find_participant(ctx, account_id);
     if (!p) {
         printf("[Bonus] Player %d not a participant\n", account_id);
         return;
@@ -554,30 +529,29 @@ static void process_card_draw(int32_t account_id, MessageHeader *req) {
         return;
     }
     
-    if (g_bonus.cards_remaining <= 0) {
+    if (ctx->cards_remaining <= 0) {
         printf("[Bonus] No cards remaining!\n");
         return;
     }
     
-    pthread_mutex_lock(&g_bonus_mutex);
-    
     // Draw card from top of stack
-    CardType drawn = g_bonus.card_stack[g_bonus.total_cards - g_bonus.cards_remaining];
-    g_bonus.cards_remaining--;
+    CardType drawn = ctx->card_stack[ctx->total_cards - ctx->cards_remaining];
+    ctx->cards_remaining--;
     
     p->drawn_card = drawn;
     p->state = PLAYER_BONUS_CARD_DRAWN;
     p->drawn_at = time(NULL);
-    g_bonus.drawn_count++;
-    
-    pthread_mutex_unlock(&g_bonus_mutex);
+    ctx->drawn_count++;
+    // The card stays hidden until the reveal
+    MatchState *match = get_match(ctx);
+    match_snapshot_answer(match, account_id, MATCH_ANSWER_DONE, 0, 0);
     
     printf("[Bonus] Player %d drew card: %s (remaining: %d)\n",
            account_id, drawn == CARD_TYPE_ELIMINATED ? "ELIMINATED" : "SAFE",
-           g_bonus.cards_remaining);
+           ctx->cards_remaining);
     
     // Send confirmation to drawer (don't reveal card type yet!)
-    int fd = get_socket(account_id);
+    int fd = round_match_socket(match, account_id);
     if (fd > 0) {
         cJSON *obj = cJSON_CreateObject();
         cJSON_AddTrueToObject(obj, "success");
@@ -588,7 +562,7 @@ static void process_card_draw(int32_t account_id, MessageHeader *req) {
         cJSON_Delete(obj);
         
         if (json) {
-            send_json(fd, req, OP_S2C_BONUS_CARD_DRAWN, json);
+            round_send_json(fd, req, OP_S2C_BONUS_CARD_DRAWN, json);
             free(json);
         }
     }
@@ -601,14 +575,14 @@ static void process_card_draw(int32_t account_id, MessageHeader *req) {
     snprintf(name, sizeof(name), "Player%d", account_id);
     cJSON_AddStringToObject(broadcast, "player_name", name);
     cJSON_AddNumberToObject(broadcast, "drawn_at", (int)p->drawn_at);
-    cJSON_AddNumberToObject(broadcast, "cards_remaining", g_bonus.cards_remaining);
+    cJSON_AddNumberToObject(broadcast, "cards_remaining", ctx->cards_remaining);
     
     // List who hasn't drawn yet
     cJSON *remaining = cJSON_CreateArray();
-    for (int i = 0; i < g_bonus.participant_count; i++) {
-        if (g_bonus.participants[i].state == PLAYER_BONUS_WAITING_TO_DRAW) {
+    for (int i = 0; i < ctx->participant_count; i++) {
+        if (ctx->participants[i].state == PLAYER_BONUS_WAITING_TO_DRAW) {
             cJSON *r = cJSON_CreateObject();
-            cJSON_AddNumberToObject(r, "account_id", g_bonus.participants[i].account_id);
+            cJSON_AddNumberToObject(r, "account_id", ctx->participants[i].account_id);
             cJSON_AddItemToArray(remaining, r);
         }
     }
@@ -618,58 +592,76 @@ static void process_card_draw(int32_t account_id, MessageHeader *req) {
     cJSON_Delete(broadcast);
     
     if (bcast_json) {
-        broadcast_to_all(req, OP_S2C_BONUS_PLAYER_DREW, bcast_json);
+        broadcast_to_all(ctx, req, OP_S2C_BONUS_PLAYER_DREW, bcast_json);
         free(bcast_json);
     }
     
-    // Save to database
-    MatchState *match = get_match();
-    MatchPlayerState *mp = get_match_player(account_id);
-    if (match && mp && match->db_match_id > 0 && mp->match_player_id > 0) {
-        cJSON *ans_payload = cJSON_CreateObject();
-        // We need to find the bonus question ID... for simplicity, skip for now
-        // In production, you'd query or store the question_id from initialize_bonus
-        cJSON_Delete(ans_payload);
-    }
-    
     // Check if all have drawn
-    check_all_drawn(req);
+    check_all_drawn(ctx, req);
+}
+
+//==============================================================================
+// TIMERS: reveal / apply delays
+// Run on the match's executor shard instead of sleeping on it. The token is
+// the step_seq the timer was armed with; a reset or re-trigger makes it stale.
+//==============================================================================
+static void reveal_timeout(uint32_t match_id, uint64_t token) {
+    BonusContext *ctx = find_context(match_id);
+    if (!ctx || ctx->step_seq != (uint32_t)token || ctx->state != BONUS_STATE_REVEALING) return;
+    
+    MessageHeader dummy = {0};
+    reveal_results(ctx, &dummy);
+}
+
+static void apply_timeout(uint32_t match_id, uint64_t token) {
+    BonusContext *ctx = find_context(match_id);
+    if (!ctx || ctx->step_seq != (uint32_t)token || ctx->state != BONUS_STATE_REVEALING) return;
+    
+    MessageHeader dummy = {0};
+    apply_results(ctx, &dummy);
+}
+
+static void schedule_step(BonusContext *ctx, int delay_ms, match_timer_fn fn) {
+    ctx->step_seq++;
+    if (!match_exec_post_timer(ctx->match_id, delay_ms, fn, ctx->step_seq)) {
+        // Executor not running: no delay
+        fn(ctx->match_id, ctx->step_seq);
+    }
 }
 
 //==============================================================================
 // CHECK IF ALL DRAWN
 //==============================================================================
-static void check_all_drawn(MessageHeader *req) {
-    if (g_bonus.drawn_count >= g_bonus.participant_count) {
+static void check_all_drawn(BonusContext *ctx, MessageHeader *req) {
+    (void)req;  // reveal runs from a timer
+    if (ctx->drawn_count >= ctx->participant_count) {
         printf("[Bonus] All participants have drawn - preparing reveal\n");
         
-        g_bonus.state = BONUS_STATE_REVEALING;
-        g_bonus.reveal_at = time(NULL) + (REVEAL_DELAY_MS / 1000);
+        ctx->state = BONUS_STATE_REVEALING;
+        ctx->reveal_at = time(NULL) + (REVEAL_DELAY_MS / 1000);
         
         // Wait 2 seconds then reveal
-        usleep(REVEAL_DELAY_MS * 1000);
-        
-        reveal_results(req);
+        schedule_step(ctx, REVEAL_DELAY_MS, reveal_timeout);
     }
 }
 
 //==============================================================================
 // REVEAL RESULTS
 //==============================================================================
-static void reveal_results(MessageHeader *req) {
+static void reveal_results(BonusContext *ctx, MessageHeader *req) {
     printf("[Bonus] Revealing results...\n");
     
     cJSON *obj = cJSON_CreateObject();
     cJSON_AddTrueToObject(obj, "success");
     cJSON_AddStringToObject(obj, "bonus_type",
-        g_bonus.type == BONUS_TYPE_ELIMINATION ? "elimination" : "winner_selection");
+        ctx->type == BONUS_TYPE_ELIMINATION ? "elimination" : "winner_selection");
     
     // Build results array
     cJSON *results = cJSON_CreateArray();
     int32_t eliminated_id = 0;
     
-    for (int i = 0; i < g_bonus.participant_count; i++) {
-        BonusParticipant *p = &g_bonus.participants[i];
+    for (int i = 0; i < ctx->participant_count; i++) {
+        BonusParticipant *p = &ctx->participants[i];
         
         cJSON *r = cJSON_CreateObject();
         cJSON_AddNumberToObject(r, "player_id", p->account_id);
@@ -701,21 +693,21 @@ static void reveal_results(MessageHeader *req) {
     cJSON_AddStringToObject(elim_info, "name", elim_name);
     cJSON_AddItemToObject(obj, "eliminated_player", elim_info);
     
-    g_bonus.eliminated_player_id = eliminated_id;
+    ctx->eliminated_player_id = eliminated_id;
     
     // Determine winner for WINNER_SELECTION type
-    if (g_bonus.type == BONUS_TYPE_WINNER_SELECTION) {
-        for (int i = 0; i < g_bonus.participant_count; i++) {
-            if (g_bonus.participants[i].drawn_card == CARD_TYPE_SAFE) {
-                g_bonus.winner_player_id = g_bonus.participants[i].account_id;
+    if (ctx->type == BONUS_TYPE_WINNER_SELECTION) {
+        for (int i = 0; i < ctx->participant_count; i++) {
+            if (ctx->participants[i].drawn_card == CARD_TYPE_SAFE) {
+                ctx->winner_player_id = ctx->participants[i].account_id;
                 break;
             }
         }
         
         cJSON *winner_info = cJSON_CreateObject();
-        cJSON_AddNumberToObject(winner_info, "id", g_bonus.winner_player_id);
+        cJSON_AddNumberToObject(winner_info, "id", ctx->winner_player_id);
         char winner_name[32];
-        snprintf(winner_name, sizeof(winner_name), "Player%d", g_bonus.winner_player_id);
+        snprintf(winner_name, sizeof(winner_name), "Player%d", ctx->winner_player_id);
         cJSON_AddStringToObject(winner_info, "name", winner_name);
         cJSON_AddItemToObject(obj, "winner", winner_info);
     }
@@ -724,133 +716,112 @@ static void reveal_results(MessageHeader *req) {
     cJSON_Delete(obj);
     
     if (json) {
-        broadcast_to_all(req, OP_S2C_BONUS_REVEAL, json);
+        broadcast_to_all(ctx, req, OP_S2C_BONUS_REVEAL, json);
         free(json);
     }
     
     // Wait for display, then apply results
-    usleep(RESULT_DISPLAY_MS * 1000);
-    
-    apply_results(req);
+    schedule_step(ctx, RESULT_DISPLAY_MS, apply_timeout);
 }
 
 //==============================================================================
 // APPLY RESULTS
 //==============================================================================
-static void apply_results(MessageHeader *req) {
+static void apply_results(BonusContext *ctx, MessageHeader *req) {
     printf("[Bonus] Applying results...\n");
     
-    g_bonus.state = BONUS_STATE_APPLYING;
+    ctx->state = BONUS_STATE_APPLYING;
     
-    MatchState *match = get_match();
+    MatchState *match = get_match(ctx);
     if (!match) return;
     
-    if (g_bonus.type == BONUS_TYPE_ELIMINATION) {
+    if (ctx->type == BONUS_TYPE_ELIMINATION) {
         // Eliminate the player who drew ELIMINATED card
-        MatchPlayerState *mp = get_match_player(g_bonus.eliminated_player_id);
+        MatchPlayerState *mp = round_match_player(match, ctx->eliminated_player_id);
         if (mp) {
             mp->eliminated = 1;
-            mp->eliminated_at_round = g_bonus.after_round;
+            mp->eliminated_at_round = ctx->after_round;
+            match_player_out(match, mp->account_id);
             
             printf("[Bonus] Player %d ELIMINATED via bonus round\n", 
-                   g_bonus.eliminated_player_id);
+                   ctx->eliminated_player_id);
             
-            // Update database
+            // Update database (write-behind queue)
             if (mp->match_player_id > 0) {
-                cJSON *update = cJSON_CreateObject();
-                cJSON_AddBoolToObject(update, "eliminated", true);
-                
-                char filter[64];
-                snprintf(filter, sizeof(filter), "id=eq.%d", mp->match_player_id);
-                
-                cJSON *result = NULL;
-                db_patch("match_players", filter, update, &result);
-                cJSON_Delete(update);
-                if (result) cJSON_Delete(result);
+                match_wq_player_update(match->db_match_id, mp->match_player_id,
+                                       MWQ_SET_ELIMINATED, 0, true, false);
             }
             
             // Save elimination event
             // Note: player_id in match_events refers to accounts.id, not match_players.id
             if (match->db_match_id > 0) {
-                db_error_t event_err = db_match_event_insert(
+                match_wq_event(
                     match->db_match_id,
                     mp->account_id,  // Use account_id, not match_player_id
                     "BONUS_ELIMINATED",
                     4,  // Bonus round
                     0
                 );
-                if (event_err == DB_SUCCESS) {
-                    printf("[Bonus] Saved elimination event to DB\n");
-                } else {
-                    printf("[Bonus] Failed to save elimination event: err=%d\n", event_err);
-                }
+                printf("[Bonus] Queued elimination event for DB\n");
             }
             
             // Send elimination notification to the player
-            int fd = get_socket(g_bonus.eliminated_player_id);
+            int fd = round_match_socket(match, ctx->eliminated_player_id);
             if (fd > 0) {
                 cJSON *ntf = cJSON_CreateObject();
-                cJSON_AddNumberToObject(ntf, "player_id", g_bonus.eliminated_player_id);
+                cJSON_AddNumberToObject(ntf, "player_id", ctx->eliminated_player_id);
                 cJSON_AddStringToObject(ntf, "reason", "BONUS_ROUND");
-                cJSON_AddNumberToObject(ntf, "round", g_bonus.after_round);
+                cJSON_AddNumberToObject(ntf, "round", ctx->after_round);
                 cJSON_AddStringToObject(ntf, "message", "You were eliminated in the bonus round!");
                 
                 char *ntf_json = cJSON_PrintUnformatted(ntf);
                 cJSON_Delete(ntf);
                 
                 if (ntf_json) {
-                    send_json(fd, req, NTF_ELIMINATION, ntf_json);
+                    round_send_json(fd, req, NTF_ELIMINATION, ntf_json);
                     free(ntf_json);
                 }
             }
         }
     } else {
         // WINNER_SELECTION - mark the winner
-        MatchPlayerState *winner = get_match_player(g_bonus.winner_player_id);
+        MatchPlayerState *winner = round_match_player(match, ctx->winner_player_id);
         if (winner) {
             // Mark all other tied players as not winner
-            for (int i = 0; i < g_bonus.participant_count; i++) {
-                MatchPlayerState *mp = get_match_player(g_bonus.participants[i].account_id);
+            for (int i = 0; i < ctx->participant_count; i++) {
+                MatchPlayerState *mp = round_match_player(match, ctx->participants[i].account_id);
                 if (mp && mp->match_player_id > 0) {
-                    bool is_winner = (mp->account_id == g_bonus.winner_player_id);
-                    
-                    cJSON *update = cJSON_CreateObject();
-                    cJSON_AddBoolToObject(update, "winner", is_winner);
-                    
-                    char filter[64];
-                    snprintf(filter, sizeof(filter), "id=eq.%d", mp->match_player_id);
+                    bool is_winner = (mp->account_id == ctx->winner_player_id);
                     
-                    cJSON *result = NULL;
-                    db_patch("match_players", filter, update, &result);
-                    cJSON_Delete(update);
-                    if (result) cJSON_Delete(result);
+                    match_wq_player_update(match->db_match_id, mp->match_player_id,
+                                           MWQ_SET_WINNER, 0, false, is_winner);
                 }
             }
             
             printf("[Bonus] Player %d declared WINNER via bonus round\n",
-                   g_bonus.winner_player_id);
+                   ctx->winner_player_id);
         }
     }
     
-    g_bonus.state = BONUS_STATE_COMPLETED;
+    ctx->state = BONUS_STATE_COMPLETED;
     
     // Transition to next phase
-    transition_to_next_phase(req);
+    transition_to_next_phase(ctx, req);
 }
 
 //==============================================================================
 // TRANSITION TO NEXT PHASE
 //==============================================================================
-static void transition_to_next_phase(MessageHeader *req) {
+static void transition_to_next_phase(BonusContext *ctx, MessageHeader *req) {
     printf("[Bonus] Transitioning to next phase...\n");
     
-    MatchState *match = get_match();
+    MatchState *match = get_match(ctx);
     if (!match) return;
     
-    int after_round = g_bonus.after_round;
-    BonusType bonus_type = g_bonus.type;
-    int32_t eliminated_id = g_bonus.eliminated_player_id;
-    int32_t winner_id = g_bonus.winner_player_id;
+    int after_round = ctx->after_round;
+    BonusType bonus_type = ctx->type;
+    int32_t eliminated_id = ctx->eliminated_player_id;
+    int32_t winner_id = ctx->winner_player_id;
     
     cJSON *obj = cJSON_CreateObject();
     cJSON_AddTrueToObject(obj, "success");
@@ -861,16 +832,7 @@ static void transition_to_next_phase(MessageHeader *req) {
         
         if (next_round <= 3) {
             // ⭐ IMPORTANT: Advance match state to next round
-            if (match->current_round_idx < match->round_count - 1) {
-                match->current_round_idx++;
-                printf("[Bonus] Advanced match to round %d (idx=%d)\n", 
-                       next_round, match->current_round_idx);
-                
-                // Initialize next round state
-                RoundState *next_round_state = &match->rounds[match->current_round_idx];
-                next_round_state->status = ROUND_PENDING;
-                next_round_state->current_question_idx = 0;
-            }
+            round_match_advance(match, "[Bonus]");
             
             cJSON_AddStringToObject(obj, "next_phase", "NEXT_ROUND");
             cJSON_AddNumberToObject(obj, "next_round", next_round);
@@ -942,7 +904,7 @@ static void transition_to_next_phase(MessageHeader *req) {
         snprintf(winner_name, sizeof(winner_name), "Player%d", winner_id);
         cJSON_AddStringToObject(winner, "name", winner_name);
         
-        MatchPlayerState *winner_mp = get_match_player(winner_id);
+        MatchPlayerState *winner_mp = round_match_player(match, winner_id);
         if (winner_mp) {
             cJSON_AddNumberToObject(winner, "final_score", winner_mp->score);
         }
@@ -957,16 +919,16 @@ static void transition_to_next_phase(MessageHeader *req) {
     
     if (json) {
         printf("[Bonus] Sending transition: %s\n", json);
-        broadcast_to_all(req, OP_S2C_BONUS_TRANSITION, json);
+        broadcast_to_all(ctx, req, OP_S2C_BONUS_TRANSITION, json);
         free(json);
     }
     
     // Store winner_id before reset for end game trigger
     int32_t bonus_winner = winner_id;
-    uint32_t match_id_copy = g_bonus.match_id;
+    uint32_t match_id_copy = ctx->match_id;
     
     // Reset bonus context
-    reset_context();
+    reset_context(ctx);
     
     // Trigger end game if this was WINNER_SELECTION (after Round 3)
     if (bonus_type == BONUS_TYPE_WINNER_SELECTION && bonus_winner > 0) {
@@ -980,7 +942,7 @@ static void transition_to_next_phase(MessageHeader *req) {
 //==============================================================================
 static void handle_draw_card(int fd, MessageHeader *req, const char *payload) {
     if (req->length < 4) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
         return;
     }
     
@@ -988,34 +950,35 @@ static void handle_draw_card(int fd, MessageHeader *req, const char *payload) {
     memcpy(&match_id, payload, 4);
     match_id = ntohl(match_id);
     
-    if (match_id != g_bonus.match_id) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid match\"}");
+    BonusContext *ctx = find_context(match_id);
+    if (!ctx || match_id != ctx->match_id) {
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid match\"}");
         return;
     }
     
-    if (g_bonus.state != BONUS_STATE_DRAWING) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Not in drawing phase\"}");
+    if (ctx->state != BONUS_STATE_DRAWING) {
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Not in drawing phase\"}");
         return;
     }
     
     UserSession *session = session_get_by_socket(fd);
     if (!session) {
-        send_json(fd, req, ERR_NOT_LOGGED_IN, "{\"success\":false,\"error\":\"Not logged in\"}");
+        round_send_json(fd, req, ERR_NOT_LOGGED_IN, "{\"success\":false,\"error\":\"Not logged in\"}");
         return;
     }
     
-    BonusParticipant *p = find_participant(session->account_id);
+    BonusParticipant *p = find_participant(ctx, session->account_id);
     if (!p) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Not a participant\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Not a participant\"}");
         return;
     }
     
     if (p->state != PLAYER_BONUS_WAITING_TO_DRAW) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Already drew card\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Already drew card\"}");
         return;
     }
     
-    process_card_draw(session->account_id, req);
+    process_card_draw(ctx, session->account_id, req);
 }
 
 //==============================================================================
@@ -1023,7 +986,7 @@ static void handle_draw_card(int fd, MessageHeader *req, const char *payload) {
 //==============================================================================
 static void handle_bonus_ready(int fd, MessageHeader *req, const char *payload) {
     if (req->length < 4) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
         return;
     }
     
@@ -1033,33 +996,34 @@ static void handle_bonus_ready(int fd, MessageHeader *req, const char *payload)
     
     UserSession *session = session_get_by_socket(fd);
     if (!session) {
-        send_json(fd, req, ERR_NOT_LOGGED_IN, "{\"success\":false,\"error\":\"Not logged in\"}");
+        round_send_json(fd, req, ERR_NOT_LOGGED_IN, "{\"success\":false,\"error\":\"Not logged in\"}");
         return;
     }
     
     // Check if this player is in bonus
-    if (match_id != g_bonus.match_id || g_bonus.state == BONUS_STATE_NONE) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"No active bonus\"}");
+    BonusContext *ctx = find_context(match_id);
+    if (!ctx || match_id != ctx->match_id || ctx->state == BONUS_STATE_NONE) {
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"No active bonus\"}");
         return;
     }
     
     // Send current state
     cJSON *obj = cJSON_CreateObject();
     cJSON_AddTrueToObject(obj, "success");
-    cJSON_AddNumberToObject(obj, "match_id", g_bonus.match_id);
-    cJSON_AddNumberToObject(obj, "state", g_bonus.state);
+    cJSON_AddNumberToObject(obj, "match_id", ctx->match_id);
+    cJSON_AddNumberToObject(obj, "state", ctx->state);
     cJSON_AddStringToObject(obj, "bonus_type",
-        g_bonus.type == BONUS_TYPE_ELIMINATION ? "elimination" : "winner_selection");
-    cJSON_AddNumberToObject(obj, "after_round", g_bonus.after_round);
-    cJSON_AddNumberToObject(obj, "participant_count", g_bonus.participant_count);
-    cJSON_AddNumberToObject(obj, "drawn_count", g_bonus.drawn_count);
-    cJSON_AddNumberToObject(obj, "cards_remaining", g_bonus.cards_remaining);
+        ctx->type == BONUS_TYPE_ELIMINATION ? "elimination" : "winner_selection");
+    cJSON_AddNumberToObject(obj, "after_round", ctx->after_round);
+    cJSON_AddNumberToObject(obj, "participant_count", ctx->participant_count);
+    cJSON_AddNumberToObject(obj, "drawn_count", ctx->drawn_count);
+    cJSON_AddNumberToObject(obj, "cards_remaining", ctx->cards_remaining);
     
-    BonusParticipant *p = find_participant(session->account_id);
+    BonusParticipant *p = find_participant(ctx, session->account_id);
     if (p) {
         cJSON_AddStringToObject(obj, "role", "participant");
         cJSON_AddNumberToObject(obj, "player_state", p->state);
-    } else if (is_spectator(session->account_id)) {
+    } else if (is_spectator(ctx, session->account_id)) {
         cJSON_AddStringToObject(obj, "role", "spectator");
     }
     
@@ -1067,7 +1031,7 @@ static void handle_bonus_ready(int fd, MessageHeader *req, const char *payload)
     cJSON_Delete(obj);
     
     if (json) {
-        send_json(fd, req, OP_S2C_BONUS_INIT, json);
+        round_send_json(fd, req, OP_S2C_BONUS_INIT, json);
         free(json);
     }
 }
@@ -1075,23 +1039,21 @@ static void handle_bonus_ready(int fd, MessageHeader *req, const char *payload)
 //==============================================================================
 // DISCONNECT HANDLER
 //==============================================================================
-void handle_bonus_disconnect(int client_fd) {
-    if (g_bonus.state == BONUS_STATE_NONE) return;
-    
-    UserSession *session = session_get_by_socket(client_fd);
-    if (!session) return;
+void handle_bonus_disconnect(int32_t account_id) {
+    MatchState *match = match_find_by_player(account_id);
+    BonusContext *ctx = match ? find_context(match->runtime_match_id) : NULL;
+    if (!ctx || ctx->state == BONUS_STATE_NONE) return;
     
-    int32_t account_id = session->account_id;
-    BonusParticipant *p = find_participant(account_id);
+    BonusParticipant *p = find_participant(ctx, account_id);
     
     if (!p) return;
     
     printf("[Bonus] Player %d disconnected during bonus\n", account_id);
     
     // If player hasn't drawn yet, auto-draw for them
-    if (p->state == PLAYER_BONUS_WAITING_TO_DRAW && g_bonus.state == BONUS_STATE_DRAWING) {
+    if (p->state == PLAYER_BONUS_WAITING_TO_DRAW && ctx->state == BONUS_STATE_DRAWING) {
         printf("[Bonus] Auto-drawing for disconnected player %d\n", account_id);
-        process_card_draw(account_id, NULL);
+        process_card_draw(ctx, account_id, NULL);
     }
 }
 
@@ -1099,17 +1061,19 @@ void handle_bonus_disconnect(int client_fd) {
 // API: Check if bonus is active
 //==============================================================================
 bool is_bonus_active(uint32_t match_id) {
-    return (g_bonus.match_id == match_id && 
-            g_bonus.state != BONUS_STATE_NONE &&
-            g_bonus.state != BONUS_STATE_COMPLETED);
+    BonusContext *ctx = find_context(match_id);
+    return (ctx && ctx->match_id == match_id && 
+            ctx->state != BONUS_STATE_NONE &&
+            ctx->state != BONUS_STATE_COMPLETED);
 }
 
 //==============================================================================
 // API: Get bonus state
 //==============================================================================
 BonusState get_bonus_state(uint32_t match_id) {
-    if (g_bonus.match_id != match_id) return BONUS_STATE_NONE;
-    return g_bonus.state;
+    BonusContext *ctx = find_context(match_id);
+    if (!ctx || ctx->match_id != match_id) return BONUS_STATE_NONE;
+    return ctx->state;
 }
 
 //==============================================================================
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <arpa/inet.h>
 
 #include "handlers/dispatcher.h"
@@ -16,14 +17,149 @@
 #include "handlers/friend_handler.h"
 #include "handlers/start_game_handler.h"
 #include "handlers/forfeit_handler.h"
+#include "handlers/spectator_handler.h"
+#include "handlers/matchmaking.h"
 #include "handlers/session_context.h"
 #include "handlers/auth_guard.h"
 #include "handlers/invite_player_handler.h"
+#include "handlers/match_manager.h"
+#include "handlers/match_executor.h"
 #include "protocol/opcode.h"
 #include "protocol/protocol.h"
+#include "utils/startup.h"
 
 #include <string.h>
 
+//==============================================================================
+// GAMEPLAY ROUTING
+// Round / bonus / end-game / forfeit commands run on the executor shard that
+// owns the match (see match_executor.h), never on the event loop.
+//==============================================================================
+
+// Match a gameplay command targets: from the payload, else the sender's match
+static uint32_t command_match_id(
+    const MessageHeader *header,
+    const char *payload,
+    int32_t account_id
+) {
+    uint32_t match_id = 0;
+    uint16_t cmd = header->command;
+
+    // Spectate is {match_id} or {0, room_id}; never the sender's own match
+    if (cmd == CMD_SPECTATE) {
+        SpectateRequest request = {0};
+        if (!payload || header->length < sizeof(request.match_id)) return 0;
+        memcpy(&request, payload, header->length < sizeof(request) ? header->length
+                                                                   : sizeof(request));
+        match_id = ntohl(request.match_id);
+        if (match_id == 0) match_id = match_find_id_by_room(ntohl(request.room_id));
+        return match_id;
+    }
+
+    // Legacy round 1 ready is {room_id, match_id}; round 1 end carries none
+    uint32_t offset = (cmd == OP_C2S_ROUND1_READY) ? 4 : 0;
+    bool has_id = (cmd != OP_C2S_ROUND1_END && cmd != OP_C2S_ROUND1_FINISHED);
+
+    if (has_id && payload && header->length >= offset + 4) {
+        memcpy(&match_id, payload + offset, 4);
+        match_id = ntohl(match_id);
+    }
+    if (match_id == 0) {
+        match_id = match_find_id_by_player(account_id);
+    }
+    return match_id;
+}
+
+static void route_to_match(
+    int client_fd,
+    MessageHeader *header,
+    const char *payload,
+    int32_t account_id,
+    match_cmd_fn handler
+) {
+    uint32_t match_id = command_match_id(header, payload, account_id);
+    if (match_id == 0) {
+        // No match to own it: the handler only answers with an error
+        handler(client_fd, header, payload);
+        return;
+    }
+
+    if (!match_exec_post_command(match_id, client_fd, account_id, header, payload, handler)) {
+        const char *msg = "Server busy, please retry";
+        forward_response(client_fd, header, ERR_SERVICE_UNAVAILABLE, msg, strlen(msg));
+    }
+}
+
+//==============================================================================
+// STARTUP HOLD
+// The listener is up before the DB connect: commands are kept here, event
+// loop only, and dispatched in arrival order once the server serves.
+//==============================================================================
+
+typedef struct held_cmd {
+    struct held_cmd *next;
+    int client_fd;
+    MessageHeader header;
+    char payload[];         // header.length bytes + '\0'
+} held_cmd_t;
+
+static struct {
+    held_cmd_t *head;
+    held_cmd_t *tail;
+    int count;
+} g_held;
+
+static bool hold_command(int client_fd, const MessageHeader *header, const char *payload) {
+    if (g_held.count >= DISPATCH_HELD_MAX) return false;
+
+    uint32_t len = payload ? header->length : 0;
+    held_cmd_t *h = malloc(sizeof(*h) + len + 1);
+    if (!h) return false;
+    h->next = NULL;
+    h->client_fd = client_fd;
+    h->header = *header;
+    if (len > 0) memcpy(h->payload, payload, len);
+    h->payload[len] = '\0';    // some handlers read the payload as a C string
+
+    if (g_held.tail) g_held.tail->next = h; else g_held.head = h;
+    g_held.tail = h;
+    g_held.count++;
+    return true;
+}
+
+int dispatch_held_commands(void) {
+    if (!g_held.head || !startup_is_serving()) return g_held.count;
+
+    held_cmd_t *h = g_held.head;
+    int count = g_held.count;
+    memset(&g_held, 0, sizeof(g_held));
+    printf("[DISPATCH] Serving: dispatching %d command(s) held during startup\n", count);
+
+    while (h) {
+        held_cmd_t *next = h->next;
+        dispatch_command(h->client_fd, &h->header, h->header.length > 0 ? h->payload : NULL);
+        free(h);
+        h = next;
+    }
+    return g_held.count;
+}
+
+void dispatch_forget_client(int client_fd) {
+    held_cmd_t **pp = &g_held.head;
+    g_held.tail = NULL;
+    while (*pp) {
+        held_cmd_t *h = *pp;
+        if (h->client_fd == client_fd) {
+            *pp = h->next;
+            free(h);
+            g_held.count--;
+        } else {
+            g_held.tail = h;
+            pp = &h->next;
+        }
+    }
+}
+
 void dispatch_command(
     int client_fd,
     MessageHeader *header,
@@ -34,6 +170,17 @@ void dispatch_command(
 
     printf("[DISPATCH] Receiving: cmd=0x%04x len=%u\n", cmd, header->length);
     bool is_auth_cmd = (cmd == CMD_LOGIN_REQ || cmd == CMD_REGISTER_REQ || cmd == CMD_RECONNECT || cmd == CMD_LOGOUT_REQ);
+
+    // Listener is up before the DB / zombie cleanup: hold the command
+    if (!startup_is_serving()) {
+        if (!hold_command(client_fd, header, payload)) {
+            const char *msg = "Server is starting, please retry";
+            forward_response(client_fd, header, ERR_SERVICE_UNAVAILABLE, msg, strlen(msg));
+        }
+        return;
+    }
+    // Held ones first: a client's commands keep their order
+    if (g_held.head) dispatch_held_commands();
     
     if (!is_auth_cmd) {
         if (!require_auth(client_fd, header)) return;
@@ -97,6 +244,12 @@ void dispatch_command(
     case CMD_KICK:
         handle_kick_member(client_fd, header, payload);
         break;
+    case CMD_QUICK_PLAY:
+        handle_quick_play(client_fd, header, payload);
+        break;
+    case CMD_QUICK_PLAY_CANCEL:
+        handle_quick_play_cancel(client_fd, header, payload);
+        break;
     case CMD_INVITE_FRIEND:
         handle_invite_player(client_fd, header, payload);
         break;
@@ -109,7 +262,13 @@ void dispatch_command(
         handle_start_game(client_fd, header, payload);
         break;
     case CMD_FORFEIT:
-        handle_forfeit(client_fd, header, payload);
+        route_to_match(client_fd, header, payload, account_id, handle_forfeit);
+        break;
+    case CMD_SPECTATE:
+        route_to_match(client_fd, header, payload, account_id, handle_spectate);
+        break;
+    case CMD_SPECTATE_LEAVE:
+        handle_spectate_leave(client_fd, header, payload);
         break;
 
     // History
@@ -128,7 +287,7 @@ void dispatch_command(
     case OP_C2S_ROUND1_END:
     case OP_C2S_ROUND1_PLAYER_READY:
     case OP_C2S_ROUND1_FINISHED:
-        handle_round1(client_fd, header, payload);
+        route_to_match(client_fd, header, payload, account_id, handle_round1);
         break;
 
     // Round 2 - Bid
@@ -136,7 +295,7 @@ void dispatch_command(
     case OP_C2S_ROUND2_PLAYER_READY:
     case OP_C2S_ROUND2_GET_PRODUCT:
     case OP_C2S_ROUND2_BID:
-        handle_round2(client_fd, header, payload);
+        route_to_match(client_fd, header, payload, account_id, handle_round2);
         break;
 
     // Round 3 - Bonus Wheel
@@ -144,25 +303,29 @@ void dispatch_command(
     case OP_C2S_ROUND3_PLAYER_READY:
     case OP_C2S_ROUND3_SPIN:
     case OP_C2S_ROUND3_DECISION:
-        handle_round3(client_fd, header, payload);
+        route_to_match(client_fd, header, payload, account_id, handle_round3);
         break;
 
     // Bonus Round - Tiebreaker
     case OP_C2S_BONUS_READY:
     case OP_C2S_BONUS_DRAW_CARD:
-        handle_bonus(client_fd, header, payload);
+        route_to_match(client_fd, header, payload, account_id, handle_bonus);
         break;
     
     // End Game
     case OP_C2S_END_GAME_READY:
     case OP_C2S_END_GAME_BACK_LOBBY:
-        handle_end_game(client_fd, header, payload);
+        route_to_match(client_fd, header, payload, account_id, handle_end_game);
         break;
     
     case CMD_REPLAY:
         printf("[DISPATCH] Parsing to replayHandler\n");       
         handle_replay(client_fd, header, payload, account_id);
         break;
+    case CMD_LEAD:
+        printf("[DISPATCH] Parsing to leaderboardHandler\n");
+        handle_leaderboard(client_fd, header, payload, account_id);
+        break;
 
     // Social - Friend Management
     case CMD_FRIEND_ADD:
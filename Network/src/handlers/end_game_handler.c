@@ -34,9 +34,14 @@
 #include "handlers/end_game_handler.h"
 #include "handlers/session_manager.h"
 #include "handlers/match_manager.h"
+#include "handlers/spectator_handler.h"
 #include "transport/room_manager.h"  // For GameMode, MODE_SCORING, MODE_ELIMINATION
 #include "db/core/db_client.h"
 #include "db/repo/match_repo.h"
+#include "db/repo/match_write_queue.h"
+#include "db/repo/recent_questions.h"
+#include "db/repo/leaderboard.h"
+#include "db/repo/account_cache.h"
 #include "protocol/opcode.h"
 #include "protocol/protocol.h"
 #include <cjson/cJSON.h>
@@ -76,13 +81,19 @@ static int compare_by_elimination(const void *a, const void *b) {
     const EndGamePlayerRanking *pa = (const EndGamePlayerRanking *)a;
     const EndGamePlayerRanking *pb = (const EndGamePlayerRanking *)b;
     
-    // Non-eliminated (winner) comes first
+    // Winner first (the bonus round picks one of the survivors on a tie)
+    if (pa->is_winner != pb->is_winner) return pa->is_winner ? -1 : 1;
+
+    // Non-eliminated comes first
     if (!pa->eliminated && pb->eliminated) return -1;
     if (pa->eliminated && !pb->eliminated) return 1;
     
     // Both eliminated: later round = higher rank (lower rank number)
     // Round 3 > Round 2 > Round 1
-    return pb->eliminated_at_round - pa->eliminated_at_round;
+    if (pa->eliminated_at_round != pb->eliminated_at_round) {
+        return pb->eliminated_at_round - pa->eliminated_at_round;
+    }
+    return pb->score - pa->score;   // out together (final round): by score
 }
 
 //==============================================================================
@@ -210,12 +221,13 @@ static bool build_scoring_mode_result(MatchState *match, int32_t bonus_winner_id
 //==============================================================================
 // BUILD END GAME RESULT - ELIMINATION MODE
 //==============================================================================
-static bool build_elimination_mode_result(MatchState *match, EndGameResult *result) {
+static bool build_elimination_mode_result(MatchState *match, int32_t bonus_winner_id, EndGameResult *result) {
     result->mode = MODE_ELIMINATION;
     result->player_count = match->player_count;
-    result->bonus_round_played = false;  // Never bonus in elimination
+    // Survivors tied at the top after the last round: bonus round
+    result->bonus_round_played = bonus_winner_id > 0;
     result->ranking_type = RANKING_BY_ELIMINATION;
-    result->reason = END_GAME_REASON_ELIMINATION_WINNER;
+    result->reason = bonus_winner_id > 0 ? END_GAME_REASON_BONUS_WINNER : END_GAME_REASON_ELIMINATION_WINNER;
     result->has_tie_at_top = false;
     
     // Collect all players
@@ -228,8 +240,8 @@ static bool build_elimination_mode_result(MatchState *match, EndGameResult *resu
         r->score = mp->score;
         r->eliminated = mp->eliminated != 0;
         r->eliminated_at_round = mp->eliminated_at_round;
-        r->is_winner = !mp->eliminated;  // Survivor is winner
-        r->bonus_winner = false;
+        r->bonus_winner = bonus_winner_id > 0 && mp->account_id == bonus_winner_id;
+        r->is_winner = bonus_winner_id > 0 ? r->bonus_winner : !mp->eliminated;  // Survivor is winner
         r->rank = 0;
     }
     
@@ -272,7 +284,7 @@ bool build_end_game_result(uint32_t match_id, int32_t bonus_winner_id, EndGameRe
            match_id, match->mode, bonus_winner_id);
     
     if (match->mode == MODE_ELIMINATION) {
-        return build_elimination_mode_result(match, result);
+        return build_elimination_mode_result(match, bonus_winner_id, result);
     } else {
         return build_scoring_mode_result(match, bonus_winner_id, result);
     }
@@ -393,11 +405,87 @@ void broadcast_end_game_result(EndGameResult *result, MessageHeader *req) {
                 forward_response(fd, req, OP_S2C_END_GAME_RESULT, json, (uint32_t)strlen(json));
             }
         }
+        spectator_forward(result->match_id, OP_S2C_END_GAME_RESULT, json);
     }
     
     free(json);
 }
 
+//==============================================================================
+// RECENT QUESTIONS
+//==============================================================================
+// Feed the per-account rings used to exclude repeats at the next game start
+// (questions.id: question_id holds the match_question row by now)
+static void record_recent_questions(MatchState *match) {
+    int32_t account_ids[MAX_MATCH_PLAYERS];
+    int32_t question_ids[MAX_MATCH_ROUNDS * MAX_QUESTIONS_PER_ROUND];
+    int players = 0, questions = 0;
+
+    for (int i = 0; i < match->player_count && i < MAX_MATCH_PLAYERS; i++) {
+        account_ids[players++] = match->players[i].account_id;
+    }
+    for (int r = 0; r < match->round_count && r < MAX_MATCH_ROUNDS; r++) {
+        RoundState *round = &match->rounds[r];
+        for (int q = 0; q < round->question_count && q < MAX_QUESTIONS_PER_ROUND; q++) {
+            if (round->questions[q].source_id > 0) {
+                question_ids[questions++] = round->questions[q].source_id;
+            }
+        }
+    }
+
+    recent_questions_record_match(account_ids, players, question_ids, questions);
+}
+
+//==============================================================================
+// PROFILE TOTALS
+//==============================================================================
+// points / wins / matches of each player: queued for the DB (ahead of the
+// match end record) and applied to the in-memory leaderboard right away
+static void record_profile_results(MatchState *match, const EndGameResult *result) {
+    for (int i = 0; i < result->player_count && i < MAX_MATCH_PLAYERS; i++) {
+        const EndGamePlayerRanking *r = &result->rankings[i];
+        if (r->account_id <= 0) continue;
+
+        int points = r->score > 0 ? r->score : 0;
+        match_wq_profile_result(match->db_match_id, r->account_id, points, r->is_winner);
+        leaderboard_record_result(r->account_id, points, r->is_winner);
+    }
+}
+
+//==============================================================================
+// AFTER THE FLUSH
+//==============================================================================
+// What still has to happen once the match's rows are in. The completion
+// runs on the write-behind thread: it only touches the (locked) caches,
+// never match state, so the shard is not involved. The writer warms the
+// replay by itself when it commits the match end record.
+typedef struct {
+    int count;
+    int32_t account_ids[MAX_MATCH_PLAYERS];
+} EndGameFlush;
+
+static void on_match_flushed(int64_t db_match_id, db_error_t result, void *arg) {
+    EndGameFlush *job = arg;
+    (void)db_match_id;
+    (void)result;
+
+    // Cached profiles carry the old totals either way
+    for (int i = 0; job && i < job->count; i++) {
+        profile_cache_invalidate(job->account_ids[i]);
+    }
+    free(job);
+}
+
+static void flush_match(MatchState *match, const EndGameResult *result) {
+    EndGameFlush *job = calloc(1, sizeof(*job));
+    for (int i = 0; job && i < result->player_count && i < MAX_MATCH_PLAYERS; i++) {
+        if (result->rankings[i].account_id > 0) {
+            job->account_ids[job->count++] = result->rankings[i].account_id;
+        }
+    }
+    match_wq_flush(match->db_match_id, MATCH_WQ_FLUSH_TIMEOUT_MS, on_match_flushed, job);
+}
+
 //==============================================================================
 // TRIGGER END GAME
 //==============================================================================
@@ -422,42 +510,30 @@ bool trigger_end_game(uint32_t match_id, int32_t bonus_winner_id) {
     // Update match status
     MatchState *match = match_get_by_id(match_id);
     if (match) {
-        match->status = MATCH_ENDED;
-        match->ended_at = time(NULL);
+        match_set_status(match, MATCH_ENDED);   // stamps ended_at, schedules the reap
+        
+        record_recent_questions(match);
         
-        // Update winner in database
-        if (match->db_match_id > 0 && result.winner_id > 0) {
-            // Find winner's match_player_id
-            for (int i = 0; i < match->player_count; i++) {
-                if (match->players[i].account_id == result.winner_id) {
-                    cJSON *update = cJSON_CreateObject();
-                    cJSON_AddBoolToObject(update, "winner", true);
-                    
-                    char filter[64];
-                    snprintf(filter, sizeof(filter), "id=eq.%d", match->players[i].match_player_id);
-                    
-                    cJSON *db_result = NULL;
-                    db_patch("match_players", filter, update, &db_result);
-                    cJSON_Delete(update);
-                    if (db_result) cJSON_Delete(db_result);
-                    break;
+        // Update winner in database (write-behind queue)
+        if (match->db_match_id > 0) {
+            if (result.winner_id > 0) {
+                for (int i = 0; i < match->player_count; i++) {
+                    if (match->players[i].account_id == result.winner_id) {
+                        match_wq_player_update(match->db_match_id,
+                                               match->players[i].match_player_id,
+                                               MWQ_SET_WINNER, 0, false, true);
+                        break;
+                    }
                 }
             }
             
+            record_profile_results(match, &result);
+
             // Update match end time
-            cJSON *match_update = cJSON_CreateObject();
-            char end_time[32];
-            time_t now = time(NULL);
-            strftime(end_time, sizeof(end_time), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
-            cJSON_AddStringToObject(match_update, "ended_at", end_time);
-            
-            char match_filter[64];
-            snprintf(match_filter, sizeof(match_filter), "id=eq.%lld", (long long)match->db_match_id);
+            match_wq_match_ended(match->db_match_id, match->ended_at);
             
-            cJSON *match_result = NULL;
-            db_patch("matches", match_filter, match_update, &match_result);
-            cJSON_Delete(match_update);
-            if (match_result) cJSON_Delete(match_result);
+            // Flush barrier; the shard moves on, the writer calls back
+            flush_match(match, &result);
         }
     }
     
@@ -7,7 +7,7 @@
 #include "handlers/match_manager.h"
 #include "handlers/session_manager.h"
 #include "handlers/start_game_handler.h"
-#include "db/repo/match_repo.h"
+#include "db/repo/match_write_queue.h"
 
 void handle_forfeit(int client_fd, MessageHeader *req, const char *payload) {
     if (req->length < sizeof(ForfeitRequest)) {
@@ -54,6 +54,7 @@ void handle_forfeit(int client_fd, MessageHeader *req, const char *payload) {
     // "Đổi trạng thái forfeit và eliminiated thành true"
     player->forfeited = 1;
     player->eliminated = 1;
+    match_player_out(match, account_id);
 
     // Get current context for logging
     int r_idx = match->current_round_idx;
@@ -65,8 +66,8 @@ void handle_forfeit(int client_fd, MessageHeader *req, const char *payload) {
     printf("[HANDLER] <forfeit> Player %d forfeited match %u at Round %d, Question %d. Status updated.\n", 
            account_id, match_id, r_idx + 1, q_idx + 1);
 
-    // 6. Persist Event to Database
-    db_error_t db_err = db_match_event_insert(
+    // 6. Persist Event to Database (write-behind; memory state is authoritative)
+    match_wq_event(
         match->db_match_id,
         account_id,
         "FORFEIT",
@@ -74,11 +75,6 @@ void handle_forfeit(int client_fd, MessageHeader *req, const char *payload) {
         q_idx       // Question 0-indexed (as stored)
     );
 
-    if (db_err != DB_SUCCESS) {
-        printf("[FORFEIT] Warning: Failed to persist event to DB (err=%d). Continuing...\n", db_err);
-        // Don't fail the forfeit if DB insert fails - memory state is already updated
-    }
-
     // 7. Send Success Response
     // Empty JSON success
     const char *resp = "{}"; 
@@ -8,8 +8,10 @@
 #include "handlers/session_manager.h"
 #include "handlers/session_context.h"
 #include "db/repo/friend_repo.h"
+#include "db/repo/friend_graph.h"
 #include "db/repo/account_repo.h"
 #include "db/repo/profile_repo.h"
+#include "db/repo/user_index.h"
 #include "protocol/protocol.h"
 #include "protocol/opcode.h"
 
@@ -355,34 +357,44 @@ void handle_friend_list(
     }
     int32_t user_id = get_client_account(client_fd);
 
-    // Get friend IDs
+    // Get friend IDs from the shared friend graph
     int32_t *friend_ids = NULL;
     int32_t count = 0;
-    db_error_t err = friend_list_get_ids(user_id, &friend_ids, &count);
+    db_error_t err = friend_graph_get_ids(user_id, &friend_ids, &count);
 
     if (err != DB_SUCCESS) {
         send_error(client_fd, header, ERR_SERVER_ERROR, "Failed to fetch friends");
         return;
     }
 
+    // Batch-load profiles and accounts (cache first, one query each for misses)
+    profile_t **profiles = count > 0 ? calloc(count, sizeof(profile_t*)) : NULL;
+    account_t **accounts = count > 0 ? calloc(count, sizeof(account_t*)) : NULL;
+    if (count > 0 && (!profiles || !accounts)) {
+        free(profiles);
+        free(accounts);
+        free(friend_ids);
+        send_error(client_fd, header, ERR_SERVER_ERROR, "Failed to fetch friends");
+        return;
+    }
+    if (profile_find_by_accounts(friend_ids, count, profiles) != DB_SUCCESS) {
+        printf("[FRIEND] Failed to load friend profiles for user=%d\n", user_id);
+    }
+    account_find_by_ids(friend_ids, count, accounts);
+
     // Build friends array with details
     cJSON *friends_array = cJSON_CreateArray();
 
     for (int32_t i = 0; i < count; i++) {
         int32_t friend_id = friend_ids[i];
+        profile_t *profile = profiles[i];
+        account_t *account = accounts[i];
 
-        // Get friend's profile
-        profile_t *profile = NULL;
-        db_error_t profile_err = profile_find_by_account(friend_id, &profile);
-
-        if (profile_err != DB_SUCCESS || !profile) {
+        if (!profile) {
+            if (account) account_free(account);
             continue;
         }
 
-        // Get friend's account for email
-        account_t *account = NULL;
-        account_find_by_id(friend_id, &account);
-
         // Check if friend is online
         UserSession *friend_session = session_get_by_account(friend_id);
         bool is_online = (friend_session != NULL && friend_session->state != SESSION_UNAUTHENTICATED);
@@ -404,6 +416,8 @@ void handle_friend_list(
         profile_free(profile);
         if (account) account_free(account);
     }
+    free(profiles);
+    free(accounts);
 
     // Build response
     cJSON *response = cJSON_CreateObject();
@@ -502,6 +516,31 @@ void handle_friend_requests(
     friend_request_free_array(requests, count);
 }
 
+static void add_search_result(
+    cJSON *users_array,
+    int32_t user_id,
+    int32_t account_id,
+    const char *name,
+    const char *email,
+    const char *avatar
+) {
+    // Check if already friends (friend graph, no DB round trip once loaded)
+    bool is_friend = false;
+    friend_check_relationship(user_id, account_id, &is_friend);
+
+    // TODO: Check if friend request pending
+
+    cJSON *user_obj = cJSON_CreateObject();
+    cJSON_AddNumberToObject(user_obj, "id", account_id);
+    cJSON_AddStringToObject(user_obj, "name", name ? name : "Unknown");
+    if (email) cJSON_AddStringToObject(user_obj, "email", email);
+    if (avatar) cJSON_AddStringToObject(user_obj, "avatar", avatar);
+    cJSON_AddBoolToObject(user_obj, "is_friend", is_friend);
+    cJSON_AddBoolToObject(user_obj, "request_pending", false); // TODO
+
+    cJSON_AddItemToArray(users_array, user_obj);
+}
+
 void handle_search_user(
     int client_fd,
     MessageHeader *header,
@@ -516,7 +555,7 @@ void handle_search_user(
     int32_t user_id = get_client_account(client_fd);
 
     // Parse JSON payload
-    cJSON *json = cJSON_Parse(payload);
+    cJSON *json = cJSON_ParseWithLength(payload, header->length);
     if (!json) {
         send_error(client_fd, header, ERR_BAD_REQUEST, "Invalid JSON");
         return;
@@ -530,73 +569,56 @@ void handle_search_user(
     }
 
     const char *search_query = query_json->valuestring;
+    cJSON *limit_json = cJSON_GetObjectItem(json, "limit");
+    int limit = (limit_json && cJSON_IsNumber(limit_json)) ? limit_json->valueint : USER_INDEX_DEFAULT_LIMIT;
+    if (limit <= 0) limit = USER_INDEX_DEFAULT_LIMIT;
+    if (limit > USER_INDEX_MAX_LIMIT) limit = USER_INDEX_MAX_LIMIT;
 
-    // Parse query as account ID (numeric)
+    cJSON *users_array = cJSON_CreateArray();
+
+    // 1. Numeric query: exact account id first (cache-backed lookup)
     char *endptr;
     int32_t search_account_id = (int32_t)strtol(search_query, &endptr, 10);
-    
-    // If not a valid number, treat as error
-    if (*endptr != '\0' || search_account_id <= 0) {
-        cJSON_Delete(json);
-        cJSON *response = cJSON_CreateObject();
-        cJSON_AddBoolToObject(response, "success", true);
-        cJSON_AddItemToObject(response, "users", cJSON_CreateArray());
-        cJSON_AddNumberToObject(response, "count", 0);
-        send_response(client_fd, header, RES_SUCCESS, response);
-        cJSON_Delete(response);
-        printf("[FRIEND] Invalid search query (not a number): query='%s'\n", search_query);
-        return;
-    }
+    bool by_id = (*endptr == '\0' && search_account_id > 0 && search_account_id != user_id);
 
-    // Search for user by account ID
-    account_t *account = NULL;
-    db_error_t err = account_find_by_id(search_account_id, &account);
-
-    cJSON *users_array = cJSON_CreateArray();
-
-    if (err == DB_SUCCESS && account) {
-        // Don't show self in search results
-        if (account->id == user_id) {
-            cJSON *response = cJSON_CreateObject();
-            cJSON_AddBoolToObject(response, "success", true);
-            cJSON_AddItemToObject(response, "users", cJSON_CreateArray());
-            cJSON_AddNumberToObject(response, "count", 0);
-            send_response(client_fd, header, RES_SUCCESS, response);
-            cJSON_Delete(response);
-            cJSON_Delete(json);
+    if (by_id) {
+        account_t *account = NULL;
+        if (account_find_by_id(search_account_id, &account) == DB_SUCCESS && account) {
+            profile_t *profile = NULL;
+            profile_find_by_account(account->id, &profile);
+            add_search_result(users_array, user_id, account->id,
+                              profile ? profile->name : NULL, account->email,
+                              profile ? profile->avatar : NULL);
+            if (profile) profile_free(profile);
             account_free(account);
-            printf("[FRIEND] Search result is self, returning empty results\n");
-            return;
+        } else {
+            by_id = false;
         }
+    }
 
-        // Found user by exact email match
-        profile_t *profile = NULL;
-        profile_find_by_account(account->id, &profile);
-
-        // Check if already friends
-        bool is_friend = false;
-        friend_check_relationship(user_id, account->id, &is_friend);
-
-        // TODO: Check if friend request pending
-
-        cJSON *user_obj = cJSON_CreateObject();
-        cJSON_AddNumberToObject(user_obj, "id", account->id);
-        if (profile && profile->name) {
-            cJSON_AddStringToObject(user_obj, "name", profile->name);
-        } else {
-            cJSON_AddStringToObject(user_obj, "name", "Unknown");
+    // 2. Prefix / fuzzy matches over names, exact emails, from the in-memory index
+    if (user_index_ready()) {
+        user_index_hit_t hits[USER_INDEX_MAX_LIMIT];
+        int hit_count = user_index_search(search_query, user_id, limit, hits);
+        for (int i = 0; i < hit_count && cJSON_GetArraySize(users_array) < limit; i++) {
+            if (by_id && hits[i].account_id == search_account_id) continue;
+            add_search_result(users_array, user_id, hits[i].account_id,
+                              hits[i].name, hits[i].email, hits[i].avatar);
         }
-        cJSON_AddStringToObject(user_obj, "email", account->email);
-        if (profile && profile->avatar) {
-            cJSON_AddStringToObject(user_obj, "avatar", profile->avatar);
+        user_index_hits_free(hits, hit_count);
+    } else if (strchr(search_query, '@')) {
+        // Index not loaded (degraded start): exact email only
+        account_t *account = NULL;
+        if (account_find_by_email(search_query, &account) == DB_SUCCESS && account &&
+            account->id != user_id) {
+            profile_t *profile = NULL;
+            profile_find_by_account(account->id, &profile);
+            add_search_result(users_array, user_id, account->id,
+                              profile ? profile->name : NULL, account->email,
+                              profile ? profile->avatar : NULL);
+            if (profile) profile_free(profile);
         }
-        cJSON_AddBoolToObject(user_obj, "is_friend", is_friend);
-        cJSON_AddBoolToObject(user_obj, "request_pending", false); // TODO
-
-        cJSON_AddItemToArray(users_array, user_obj);
-
-        if (profile) profile_free(profile);
-        account_free(account);
+        if (account) account_free(account);
     }
 
     // Build response
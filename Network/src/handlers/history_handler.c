@@ -6,7 +6,10 @@
 #include "protocol/opcode.h"
 #include "db/repo/question_repo.h"
 #include "db/repo/match_repo.h"
+#include "db/repo/replay_cache.h"
+#include "db/repo/leaderboard.h"
 #include "protocol/protocol.h"
+#include <cjson/cJSON.h>
 
 void handle_history(
     int client_fd,
@@ -77,23 +80,88 @@ void handle_replay(
     uint32_t match_id = *(uint32_t *)payload; 
     printf("[HANDLER] <handle_replay> match_id=%u\n", match_id);
 
-    cJSON *json_res = NULL;
-    db_error_t err = db_match_get_detail(match_id, &json_res);
+    // Finished matches are served from the replay cache (memcpy, no joins)
+    char *json_str = NULL;
+    size_t len = 0;
+    db_error_t err = replay_cache_get(match_id, &json_str, &len);
 
-    if (err != DB_SUCCESS || !json_res) {
+    if (err != DB_SUCCESS || !json_str) {
         forward_response(client_fd, req_header, CMD_REPLAY, "{}", 2);
         return;
     }
 
-    char *json_str = cJSON_PrintUnformatted(json_res);
-    cJSON_Delete(json_res);
+    forward_response(client_fd, req_header, CMD_REPLAY, json_str, len);
+    free(json_str);
+}
 
-    if (!json_str) {
-        forward_response(client_fd, req_header, CMD_REPLAY, "{}", 2);
+void handle_leaderboard(
+    int client_fd,
+    MessageHeader *req_header,
+    const char *payload,
+    int32_t account_id
+) {
+    // Empty payload = top page. JSON {offset, limit} pages the ranking,
+    // {around: true, radius} returns the entries next to the caller.
+    int32_t offset = 0;
+    int limit = LEADERBOARD_DEFAULT_LIMIT;
+    bool around = false;
+
+    if (payload && req_header->length > 0) {
+        cJSON *json = cJSON_ParseWithLength(payload, req_header->length);
+        if (json && cJSON_IsObject(json)) {
+            cJSON *item;
+            if ((item = cJSON_GetObjectItem(json, "offset")) && cJSON_IsNumber(item) && item->valuedouble > 0) {
+                offset = item->valueint;
+            }
+            if ((item = cJSON_GetObjectItem(json, "limit")) && cJSON_IsNumber(item)) {
+                limit = item->valueint;
+            }
+            if ((item = cJSON_GetObjectItem(json, "around")) && cJSON_IsTrue(item)) {
+                around = true;
+                limit = LEADERBOARD_DEFAULT_LIMIT / 2;
+            }
+            if (around && (item = cJSON_GetObjectItem(json, "radius")) && cJSON_IsNumber(item)) {
+                limit = item->valueint;
+            }
+        }
+        if (json) cJSON_Delete(json);
+    }
+
+    uint64_t version = 0;
+    size_t entries_len = 0;
+    char *entries = around
+        ? leaderboard_around(account_id, limit, &version, &entries_len)
+        : leaderboard_page(offset, limit, &version, &entries_len);
+    if (!entries) {
+        forward_response(client_fd, req_header, CMD_LEAD, "{}", 2);
         return;
     }
 
-    size_t len = strlen(json_str);
-    forward_response(client_fd, req_header, CMD_REPLAY, json_str, len);
-    free(json_str);
-}
\ No newline at end of file
+    leaderboard_entry_t me;
+    char me_json[160];
+    if (leaderboard_get(account_id, &me)) {
+        snprintf(me_json, sizeof(me_json),
+                 "{\"rank\":%d,\"points\":%d,\"wins\":%d,\"matches\":%d}",
+                 me.rank, me.points, me.wins, me.matches);
+    } else {
+        snprintf(me_json, sizeof(me_json), "null");
+    }
+
+    size_t cap = entries_len + strlen(me_json) + 128;
+    char *body = malloc(cap);
+    if (!body) {
+        free(entries);
+        forward_response(client_fd, req_header, CMD_LEAD, "{}", 2);
+        return;
+    }
+    int len = snprintf(body, cap,
+                       "{\"success\":true,\"version\":%llu,\"total\":%d,\"me\":%s,\"entries\":%s}",
+                       (unsigned long long)version, leaderboard_size(), me_json, entries);
+
+    printf("[HANDLER] <leaderboard> account=%d %s=%d, %d bytes\n",
+           account_id, around ? "around" : "offset", around ? limit : offset, len);
+    forward_response(client_fd, req_header, CMD_LEAD, body, (uint32_t)len);
+
+    free(body);
+    free(entries);
+}
@@ -9,6 +9,8 @@
 #include "handlers/session_manager.h"
 #include "transport/room_manager.h"
 #include "db/core/db_client.h"
+#include "db/repo/profile_repo.h"
+#include "db/repo/friend_graph.h"
 
 #if defined(__GNUC__) || defined(__clang__)
     #define PACKED __attribute__((packed))
@@ -35,17 +37,8 @@ static void send_error(int client_fd, MessageHeader *req, uint16_t error_code, c
  */
 static void send_notification_to_fd(int client_fd, uint16_t command, const char *payload, uint32_t payload_len) {
     MessageHeader header;
-    memset(&header, 0, sizeof(header));
-    header.magic = htons(MAGIC_NUMBER);
-    header.version = PROTOCOL_VERSION;
-    header.command = htons(command);
-    header.seq_num = 0;
-    header.length = htonl(payload_len);
-    
-    send(client_fd, &header, sizeof(header), 0);
-    if (payload_len > 0 && payload) {
-        send(client_fd, payload, payload_len, 0);
-    }
+    memset(&header, 0, sizeof(header));     // seq 0
+    forward_response(client_fd, &header, command, payload, payload ? payload_len : 0);
 }
 
 void handle_invite_player(int client_fd, MessageHeader *req, const char *payload) {
@@ -83,10 +76,23 @@ void handle_invite_player(int client_fd, MessageHeader *req, const char *payload
         return;
     }
 
-    // 5. Check target player session
+    // 5. Invitations go to friends only (in-memory friend graph)
+    bool are_friends = false;
+    if (friend_graph_are_friends((int32_t)sender_session->account_id, target_id, &are_friends) != DB_OK) {
+        printf("[SERVER] [INVITE_PLAYER] Error: Could not load friends of %d\n", sender_session->account_id);
+        send_error(client_fd, req, ERR_SERVER_ERROR, "Failed to check friendship");
+        return;
+    }
+    if (!are_friends) {
+        printf("[SERVER] [INVITE_PLAYER] Error: %d and %d are not friends\n", sender_session->account_id, target_id);
+        send_error(client_fd, req, ERR_BAD_REQUEST, "You can only invite friends.");
+        return;
+    }
+
+    // 6. Check target player session
     UserSession *target_session = session_get_by_account(target_id);
 
-    if (!target_session) {
+    if (!target_session || target_session->socket_fd <= 0) {
         printf("[SERVER] [INVITE_PLAYER] Error: Target %d not found or disconnected\n", target_id);
         send_error(client_fd, req, ERR_BAD_REQUEST, "The requested user is currently disconnected or does not exist.");
         return;
@@ -99,27 +105,17 @@ void handle_invite_player(int client_fd, MessageHeader *req, const char *payload
         return;
     }
 
-    // 6. Fetch sender profile to get name
+    // 7. Fetch sender profile to get name
     char sender_name[64] = "Unknown Player";
-    char query[128];
-    snprintf(query, sizeof(query), "SELECT name FROM profiles WHERE account_id = %u LIMIT 1", sender_session->account_id);
-    
-    cJSON *profile_response = NULL;
-    db_error_t profile_rc = db_get("profiles", query, &profile_response);
-    
-    if (profile_rc == DB_OK && profile_response) {
-        cJSON *first = cJSON_GetArrayItem(profile_response, 0);
-        if (first) {
-            cJSON *name_item = cJSON_GetObjectItem(first, "name");
-            if (name_item && cJSON_IsString(name_item)) {
-                strncpy(sender_name, name_item->valuestring, sizeof(sender_name) - 1);
-                sender_name[sizeof(sender_name) - 1] = '\0';
-            }
-        }
-        cJSON_Delete(profile_response);
+    profile_t *profile = NULL;
+    if (profile_find_by_account((int32_t)sender_session->account_id, &profile) == DB_OK &&
+        profile && profile->name) {
+        strncpy(sender_name, profile->name, sizeof(sender_name) - 1);
+        sender_name[sizeof(sender_name) - 1] = '\0';
     }
+    profile_free(profile);
 
-    // 7. Construct invitation notification
+    // 8. Construct invitation notification
     cJSON *notif_json = cJSON_CreateObject();
     cJSON_AddNumberToObject(notif_json, "sender_id", sender_session->account_id);
     cJSON_AddStringToObject(notif_json, "sender_name", sender_name);
@@ -129,12 +125,12 @@ void handle_invite_player(int client_fd, MessageHeader *req, const char *payload
     char *json_str = cJSON_PrintUnformatted(notif_json);
     uint32_t json_len = strlen(json_str);
 
-    // 8. Send notification to target
+    // 9. Send notification to target
     send_notification_to_fd(target_session->socket_fd, NTF_INVITATION, json_str, json_len);
     printf("[SERVER] [INVITE_PLAYER] Notification (NTF_INVITATION) sent to account %d (fd=%d) from %s\n", 
            target_id, target_session->socket_fd, sender_name);
 
-    // 8. Respond to sender (success)
+    // 10. Respond to sender (success)
     forward_response(client_fd, req, RES_SUCCESS, "Invitation sent", 15);
 
     // Cleanup
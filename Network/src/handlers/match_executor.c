@@ -0,0 +1,358 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "handlers/match_executor.h"
+#include "handlers/session_context.h"
+
+//==============================================================================
+// TYPES
+//==============================================================================
+
+typedef enum {
+    MX_COMMAND = 0,
+    MX_DISCONNECT
+} mx_kind_t;
+
+typedef struct mx_msg {
+    mx_kind_t kind;
+    struct mx_msg *next;
+
+    uint32_t match_id;
+    int client_fd;
+    int32_t account_id;
+    int64_t received_ms;    // now_ms() at post (COMMAND)
+    MessageHeader req;
+    match_cmd_fn cmd_fn;
+    match_disconnect_fn disconnect_fn;
+    char payload[];         // req.length bytes (COMMAND)
+} mx_msg_t;
+
+typedef struct mx_timer {
+    struct mx_timer *next;
+    int64_t due_ms;
+    uint32_t match_id;
+    uint64_t token;
+    match_timer_fn fn;
+} mx_timer_t;
+
+typedef struct {
+    int index;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int running;
+
+    // Mailbox (FIFO): many producers, this shard is the only consumer
+    mx_msg_t *head;
+    mx_msg_t *tail;
+    int queued;
+
+    // Pending timers, sorted by due_ms
+    mx_timer_t *timers;
+
+    uint64_t processed;
+} mx_shard_t;
+
+static struct {
+    mx_shard_t *shards;
+    int count;
+    int started;
+} g_mx;
+
+static _Thread_local mx_shard_t *t_shard = NULL;
+static _Thread_local int64_t t_received_ms = 0;     // command running on this shard, 0 = none
+
+//==============================================================================
+// HELPERS
+//==============================================================================
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Wait on the shard's CLOCK_MONOTONIC condition variable until deadline_ms
+static void cond_wait_until(mx_shard_t *sh, int64_t deadline_ms) {
+    struct timespec ts;
+    ts.tv_sec = deadline_ms / 1000;
+    ts.tv_nsec = (deadline_ms % 1000) * 1000000;
+    pthread_cond_timedwait(&sh->cond, &sh->lock, &ts);
+}
+
+static mx_shard_t* owner_of(uint32_t match_id) {
+    if (!g_mx.started || g_mx.count <= 0) return NULL;
+    return &g_mx.shards[match_id % (uint32_t)g_mx.count];
+}
+
+// bounded: refuse once MATCH_EXEC_MAX_MAILBOX messages are waiting
+static bool enqueue(mx_shard_t *sh, mx_msg_t *m, bool bounded) {
+    pthread_mutex_lock(&sh->lock);
+    if (!sh->running || (bounded && sh->queued >= MATCH_EXEC_MAX_MAILBOX)) {
+        pthread_mutex_unlock(&sh->lock);
+        return false;
+    }
+    if (sh->tail) sh->tail->next = m; else sh->head = m;
+    sh->tail = m;
+    sh->queued++;
+    pthread_cond_signal(&sh->cond);
+    pthread_mutex_unlock(&sh->lock);
+    return true;
+}
+
+//==============================================================================
+// SHARD THREAD
+//==============================================================================
+
+static void run_message(mx_msg_t *m) {
+    if (m->kind == MX_DISCONNECT) {
+        m->disconnect_fn(m->account_id);
+        return;
+    }
+
+    // The client may have gone (and its fd been reused) since the post
+    if (m->account_id != 0 && get_client_account(m->client_fd) != m->account_id) {
+        printf("[MATCH_EXEC] Dropping cmd=0x%04x for match %u: fd=%d no longer account %d\n",
+               m->req.command, m->match_id, m->client_fd, m->account_id);
+        return;
+    }
+    t_received_ms = m->received_ms;
+    m->cmd_fn(m->client_fd, &m->req, m->req.length > 0 ? m->payload : NULL);
+    t_received_ms = 0;
+}
+
+static void* shard_thread(void *arg) {
+    mx_shard_t *sh = arg;
+    t_shard = sh;
+
+    pthread_mutex_lock(&sh->lock);
+    for (;;) {
+        // Take the whole mailbox and every due timer in one go
+        mx_msg_t *batch = sh->head;
+        sh->head = sh->tail = NULL;
+        sh->queued = 0;
+
+        int64_t now = now_ms();
+        mx_timer_t *due = NULL;
+        mx_timer_t **tp = &sh->timers;
+        while (*tp && (*tp)->due_ms <= now) tp = &(*tp)->next;
+        if (tp != &sh->timers) {
+            due = sh->timers;
+            sh->timers = *tp;
+            *tp = NULL;
+        }
+
+        if (!batch && !due) {
+            if (!sh->running) break;
+            if (sh->timers) {
+                cond_wait_until(sh, sh->timers->due_ms);
+            } else {
+                pthread_cond_wait(&sh->cond, &sh->lock);
+            }
+            continue;
+        }
+        pthread_mutex_unlock(&sh->lock);
+
+        while (batch) {
+            mx_msg_t *next = batch->next;
+            run_message(batch);
+            free(batch);
+            batch = next;
+            sh->processed++;
+        }
+        while (due) {
+            mx_timer_t *next = due->next;
+            due->fn(due->match_id, due->token);
+            free(due);
+            due = next;
+            sh->processed++;
+        }
+
+        pthread_mutex_lock(&sh->lock);
+    }
+
+    // Shutdown: pending timers are dropped
+    mx_timer_t *t = sh->timers;
+    sh->timers = NULL;
+    pthread_mutex_unlock(&sh->lock);
+    while (t) {
+        mx_timer_t *next = t->next;
+        free(t);
+        t = next;
+    }
+    return NULL;
+}
+
+//==============================================================================
+// PUBLIC API
+//==============================================================================
+
+int match_exec_init(void) {
+    if (g_mx.started) return 0;
+
+    const char *env = getenv(ENV_MATCH_SHARDS);
+    int count = (env && *env) ? atoi(env) : MATCH_EXEC_DEFAULT_SHARDS;
+    if (count < 1) count = 1;
+    if (count > MATCH_EXEC_MAX_SHARDS) count = MATCH_EXEC_MAX_SHARDS;
+
+    g_mx.shards = calloc((size_t)count, sizeof(mx_shard_t));
+    if (!g_mx.shards) return -1;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+
+    int started = 0;
+    for (int i = 0; i < count; i++) {
+        mx_shard_t *sh = &g_mx.shards[i];
+        sh->index = i;
+        sh->running = 1;
+        pthread_mutex_init(&sh->lock, NULL);
+        pthread_cond_init(&sh->cond, &attr);
+        if (pthread_create(&sh->thread, NULL, shard_thread, sh) != 0) {
+            printf("[MATCH_EXEC] Failed to start shard %d\n", i);
+            pthread_cond_destroy(&sh->cond);
+            pthread_mutex_destroy(&sh->lock);
+            break;
+        }
+        started++;
+    }
+    pthread_condattr_destroy(&attr);
+
+    if (started == 0) {
+        free(g_mx.shards);
+        g_mx.shards = NULL;
+        return -1;
+    }
+
+    // Fewer shards than asked: matches are spread over the ones that started
+    g_mx.count = started;
+    g_mx.started = 1;
+    printf("[MATCH_EXEC] %d shard(s) started\n", started);
+    return 0;
+}
+
+void match_exec_shutdown(void) {
+    if (!g_mx.started) return;
+
+    for (int i = 0; i < g_mx.count; i++) {
+        mx_shard_t *sh = &g_mx.shards[i];
+        pthread_mutex_lock(&sh->lock);
+        sh->running = 0;
+        pthread_cond_signal(&sh->cond);
+        pthread_mutex_unlock(&sh->lock);
+    }
+
+    uint64_t processed = 0;
+    for (int i = 0; i < g_mx.count; i++) {
+        mx_shard_t *sh = &g_mx.shards[i];
+        pthread_join(sh->thread, NULL);
+        processed += sh->processed;
+        pthread_cond_destroy(&sh->cond);
+        pthread_mutex_destroy(&sh->lock);
+    }
+
+    printf("[MATCH_EXEC] Stopped %d shard(s), %llu message(s) processed\n",
+           g_mx.count, (unsigned long long)processed);
+    free(g_mx.shards);
+    g_mx.shards = NULL;
+    g_mx.count = 0;
+    g_mx.started = 0;
+}
+
+bool match_exec_post_command(uint32_t match_id, int client_fd, int32_t account_id,
+                             const MessageHeader *req, const char *payload,
+                             match_cmd_fn fn) {
+    mx_shard_t *sh = owner_of(match_id);
+    if (!sh || !req || !fn) return false;
+
+    uint32_t len = payload ? req->length : 0;
+    mx_msg_t *m = malloc(sizeof(*m) + len);
+    if (!m) return false;
+
+    m->kind = MX_COMMAND;
+    m->next = NULL;
+    m->match_id = match_id;
+    m->client_fd = client_fd;
+    m->account_id = account_id;
+    m->received_ms = now_ms();
+    m->req = *req;
+    m->req.length = len;
+    m->cmd_fn = fn;
+    m->disconnect_fn = NULL;
+    if (len > 0) memcpy(m->payload, payload, len);
+
+    if (!enqueue(sh, m, true)) {
+        printf("[MATCH_EXEC] Shard %d mailbox full, refusing cmd=0x%04x for match %u\n",
+               sh->index, req->command, match_id);
+        free(m);
+        return false;
+    }
+    return true;
+}
+
+bool match_exec_post_timer(uint32_t match_id, int delay_ms, match_timer_fn fn, uint64_t token) {
+    mx_shard_t *sh = owner_of(match_id);
+    if (!sh || !fn) return false;
+
+    mx_timer_t *t = calloc(1, sizeof(*t));
+    if (!t) return false;
+    t->due_ms = now_ms() + (delay_ms > 0 ? delay_ms : 0);
+    t->match_id = match_id;
+    t->token = token;
+    t->fn = fn;
+
+    pthread_mutex_lock(&sh->lock);
+    if (!sh->running) {
+        pthread_mutex_unlock(&sh->lock);
+        free(t);
+        return false;
+    }
+    // Equal deadlines fire in the order they were armed
+    mx_timer_t **pp = &sh->timers;
+    while (*pp && (*pp)->due_ms <= t->due_ms) pp = &(*pp)->next;
+    t->next = *pp;
+    *pp = t;
+    if (sh->timers == t) pthread_cond_signal(&sh->cond);
+    pthread_mutex_unlock(&sh->lock);
+    return true;
+}
+
+bool match_exec_post_disconnect(uint32_t match_id, int32_t account_id, match_disconnect_fn fn) {
+    mx_shard_t *sh = owner_of(match_id);
+    if (!sh || !fn) return false;
+
+    mx_msg_t *m = calloc(1, sizeof(*m));
+    if (!m) return false;
+    m->kind = MX_DISCONNECT;
+    m->match_id = match_id;
+    m->account_id = account_id;
+    m->disconnect_fn = fn;
+
+    // Never refused for a full mailbox: the player's state must be updated
+    if (!enqueue(sh, m, false)) {
+        free(m);
+        return false;
+    }
+    return true;
+}
+
+int match_exec_shard_of(uint32_t match_id) {
+    mx_shard_t *sh = owner_of(match_id);
+    return sh ? sh->index : -1;
+}
+
+int64_t match_exec_now_ms(void) {
+    return now_ms();
+}
+
+int64_t match_exec_received_ms(void) {
+    return t_received_ms > 0 ? t_received_ms : now_ms();
+}
+
+bool match_exec_on_shard(void) {
+    return t_shard != NULL;
+}
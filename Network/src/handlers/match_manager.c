@@ -1,122 +1,498 @@
 #include "handlers/match_manager.h"
+#include "handlers/match_executor.h"
+#include "handlers/end_game_handler.h"
+#include "transport/spectator_hub.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdbool.h>
 #include <string.h>
+#include <pthread.h>
 #include <time.h>
 
-// Storage for active matches
-static MatchState g_matches[MAX_ACTIVE_MATCHES];
+//==============================================================================
+// STORAGE
+// Matches live in slabs that are never moved or freed before shutdown, so a
+// MatchState* stays valid memory for the life of the process. Destroyed
+// slots are zeroed and recycled through a free list.
+//==============================================================================
+
+typedef struct match_slab {
+    struct match_slab *next;
+    MatchState matches[MATCH_SLAB_SIZE];
+} match_slab_t;
+
+// Open addressing (linear probing, backward-shift delete), key 0 = empty
+typedef struct {
+    uint32_t key;
+    MatchState *match;
+} index_entry_t;
+
+typedef struct {
+    index_entry_t *slots;
+    uint32_t cap;           // power of two
+    uint32_t used;
+} match_index_t;
+
+static pthread_rwlock_t g_lock = PTHREAD_RWLOCK_INITIALIZER;
+static match_slab_t *g_slabs = NULL;
+static MatchState **g_free = NULL;     // recyclable slots (stack)
+static int g_free_count = 0;
+static int g_free_cap = 0;
+static int g_slot_count = 0;           // slots in all slabs
+static match_index_t g_by_id;
+static match_index_t g_by_room;        // room -> latest match created for it
+static match_index_t g_by_player;      // account -> match it is in play in
+static match_index_t g_by_player_out;  // account -> match it was eliminated from
+static int g_live = 0;
+static uint32_t g_next_id = 0;
 static int g_initialized = 0;
 
-void match_manager_init(void) {
-    memset(g_matches, 0, sizeof(g_matches));
-    g_initialized = 1;
-    printf("[HANDLER] <matchManager> Initialized (max capacity: %d)\n", MAX_ACTIVE_MATCHES);
+//==============================================================================
+// INDEX (caller holds g_lock)
+//==============================================================================
+
+static uint32_t hash_key(uint32_t k) {
+    k ^= k >> 16;
+    k *= 0x85ebca6bu;
+    k ^= k >> 13;
+    k *= 0xc2b2ae35u;
+    k ^= k >> 16;
+    return k;
+}
+
+static int index_init(match_index_t *ix, uint32_t cap) {
+    ix->slots = calloc(cap, sizeof(index_entry_t));
+    if (!ix->slots) return -1;
+    ix->cap = cap;
+    ix->used = 0;
+    return 0;
+}
+
+static MatchState* index_get(const match_index_t *ix, uint32_t key) {
+    if (key == 0 || !ix->slots) return NULL;
+    uint32_t mask = ix->cap - 1;
+    for (uint32_t i = hash_key(key) & mask; ix->slots[i].key != 0; i = (i + 1) & mask) {
+        if (ix->slots[i].key == key) return ix->slots[i].match;
+    }
+    return NULL;
+}
+
+static void index_set_slot(match_index_t *ix, uint32_t key, MatchState *match) {
+    uint32_t mask = ix->cap - 1;
+    uint32_t i = hash_key(key) & mask;
+    while (ix->slots[i].key != 0 && ix->slots[i].key != key) i = (i + 1) & mask;
+    if (ix->slots[i].key == 0) ix->used++;
+    ix->slots[i].key = key;
+    ix->slots[i].match = match;
 }
 
-/**
- * Find empty/available slot in match array
- */
+// Insert or replace; grows at 50% load
+static int index_put(match_index_t *ix, uint32_t key, MatchState *match) {
+    if ((ix->used + 1) * 2 > ix->cap) {
+        match_index_t bigger;
+        if (index_init(&bigger, ix->cap * 2) != 0) return -1;
+        for (uint32_t i = 0; i < ix->cap; i++) {
+            if (ix->slots[i].key != 0) {
+                index_set_slot(&bigger, ix->slots[i].key, ix->slots[i].match);
+            }
+        }
+        free(ix->slots);
+        *ix = bigger;
+    }
+    index_set_slot(ix, key, match);
+    return 0;
+}
+
+// Remove key if it maps to match (NULL = whatever it maps to)
+static void index_del(match_index_t *ix, uint32_t key, const MatchState *match) {
+    if (key == 0 || !ix->slots) return;
+    uint32_t mask = ix->cap - 1;
+    uint32_t i = hash_key(key) & mask;
+    while (ix->slots[i].key != key) {
+        if (ix->slots[i].key == 0) return;
+        i = (i + 1) & mask;
+    }
+    if (match && ix->slots[i].match != match) return;
+
+    // Shift back the following entries that probed past the hole
+    uint32_t hole = i;
+    for (uint32_t j = (i + 1) & mask; ix->slots[j].key != 0; j = (j + 1) & mask) {
+        uint32_t home = hash_key(ix->slots[j].key) & mask;
+        bool movable = (hole <= j) ? (home <= hole || home > j)
+                                   : (home <= hole && home > j);
+        if (movable) {
+            ix->slots[hole] = ix->slots[j];
+            hole = j;
+        }
+    }
+    ix->slots[hole].key = 0;
+    ix->slots[hole].match = NULL;
+    ix->used--;
+}
+
+//==============================================================================
+// SLOTS (caller holds g_lock)
+//==============================================================================
+
 static MatchState* alloc_slot(void) {
-    for (int i = 0; i < MAX_ACTIVE_MATCHES; i++) {
-        if (g_matches[i].runtime_match_id == 0) {
-            return &g_matches[i];
+    if (g_free_count > 0) return g_free[--g_free_count];
+
+    match_slab_t *slab = calloc(1, sizeof(match_slab_t));
+    if (!slab) return NULL;
+
+    // The free list can end up holding every slot
+    int need = g_slot_count + MATCH_SLAB_SIZE;
+    if (need > g_free_cap) {
+        int cap = g_free_cap ? g_free_cap * 2 : MATCH_SLAB_SIZE * 4;
+        while (cap < need) cap *= 2;
+        MatchState **grown = realloc(g_free, (size_t)cap * sizeof(*grown));
+        if (!grown) {
+            free(slab);
+            return NULL;
         }
+        g_free = grown;
+        g_free_cap = cap;
+    }
+
+    slab->next = g_slabs;
+    g_slabs = slab;
+    g_slot_count += MATCH_SLAB_SIZE;
+    // Hand out the first slot, keep the rest (lowest address on top)
+    for (int i = MATCH_SLAB_SIZE - 1; i >= 1; i--) {
+        g_free[g_free_count++] = &slab->matches[i];
+    }
+    return &slab->matches[0];
+}
+
+// Collision-free runtime id: sequential, never 0, never one still live
+static uint32_t next_match_id(void) {
+    for (;;) {
+        uint32_t id = g_next_id++;
+        if (id != 0 && !index_get(&g_by_id, id)) return id;
+    }
+}
+
+static void release_match(MatchState *match) {
+
+    // Round / bonus contexts: detach first so lookups stop finding them
+    for (int c = 0; c < MATCH_CTX_COUNT; c++) {
+        void *ctx = match->contexts[c];
+        void (*free_fn)(void *) = match->context_free[c];
+        match->contexts[c] = NULL;
+        if (!ctx) continue;
+        if (free_fn) free_fn(ctx);
+        else free(ctx);
+    }
+
+    // Question data, payloads and scratch frames go in one step
+    arena_destroy(&match->arena);
+}
+
+// Drop the accounts of a match that ends or goes away (caller holds g_lock)
+static void unindex_players_locked(const MatchState *match) {
+    for (int p = 0; p < match->player_count; p++) {
+        uint32_t key = (uint32_t)match->players[p].account_id;
+        index_del(&g_by_player, key, match);
+        index_del(&g_by_player_out, key, match);
+    }
+}
+
+//==============================================================================
+// PUBLIC API
+//==============================================================================
+
+void match_manager_init(void) {
+    pthread_rwlock_wrlock(&g_lock);
+    if (!g_initialized) {
+        if (index_init(&g_by_id, MATCH_INDEX_MIN_CAP) != 0 ||
+            index_init(&g_by_room, MATCH_INDEX_MIN_CAP) != 0 ||
+            index_init(&g_by_player, MATCH_INDEX_MIN_CAP) != 0 ||
+            index_init(&g_by_player_out, MATCH_INDEX_MIN_CAP) != 0) {
+            printf("[HANDLER] <matchManager> ERROR: Out of memory for match index\n");
+            pthread_rwlock_unlock(&g_lock);
+            return;
+        }
+        // Start from the clock (as the old now*1000+room ids did) so ids
+        // from a previous run are unlikely to be reused soon
+        g_next_id = (uint32_t)time(NULL) * 1000u;
+        g_initialized = 1;
+    }
+    pthread_rwlock_unlock(&g_lock);
+    printf("[HANDLER] <matchManager> Initialized (slab size: %d)\n", MATCH_SLAB_SIZE);
+}
+
+// Where the match is: round, its status and the question / turn seq
+static uint64_t match_progress(const MatchState *match) {
+    int idx = match->current_round_idx;
+    int round_status = idx >= 0 && idx < match->round_count ? (int)match->rounds[idx].status : -1;
+    return ((uint64_t)match->snapshot.seq << 32) | ((uint64_t)(idx & 0xffff) << 16) |
+           (uint64_t)(round_status & 0xffff);
+}
+
+// Timer on the match's shard every MATCH_STALL_TIMEOUT_MS until it ends;
+// token is the progress seen last time. A match left waiting on nothing
+// (no timer, no player to act) is ended, which schedules its reap.
+static void watch_match(uint32_t match_id, uint64_t token) {
+    MatchState *match = match_get_by_id(match_id);
+    if (!match || match->status == MATCH_ENDED) return;
+
+    uint64_t progress = match_progress(match);
+    if (progress != token) {
+        match_exec_post_timer(match_id, MATCH_STALL_TIMEOUT_MS, watch_match, progress);
+        return;
     }
-    return NULL; // No free slots
+
+    printf("[HANDLER] <matchManager> WARN: Match ID=%u made no progress for %d ms, ending it\n",
+           match_id, MATCH_STALL_TIMEOUT_MS);
+    trigger_end_game(match_id, -1);
+    match = match_get_by_id(match_id);
+    if (match && match->status != MATCH_ENDED) match_set_status(match, MATCH_ENDED);
 }
 
-MatchState* match_create(uint32_t match_id, uint32_t room_id) {
+MatchState* match_create(uint32_t room_id, const int32_t *account_ids, int player_count) {
+    pthread_rwlock_wrlock(&g_lock);
     if (!g_initialized) {
+        pthread_rwlock_unlock(&g_lock);
         printf("[HANDLER] <matchManager> ERROR: Not initialized\n");
         return NULL;
     }
-
-    // Check if match already exists
-    if (match_get_by_id(match_id) != NULL) {
-        printf("[HANDLER] <matchManager> ERROR: Match ID %u already exists\n", match_id);
+    if (player_count < 0 || player_count > MAX_MATCH_PLAYERS ||
+        (player_count > 0 && !account_ids)) {
+        pthread_rwlock_unlock(&g_lock);
+        printf("[HANDLER] <matchManager> ERROR: Bad player list (%d players)\n", player_count);
         return NULL;
     }
 
-    // Note: No longer checking room_id since MatchState doesn't store it
-    (void)room_id; // Suppress unused warning
-
     MatchState *slot = alloc_slot();
     if (!slot) {
-        printf("[HANDLER] <matchManager> ERROR: No free slots available\n");
+        pthread_rwlock_unlock(&g_lock);
+        printf("[HANDLER] <matchManager> ERROR: Out of memory for match\n");
         return NULL;
     }
 
     // Initialize match state
     memset(slot, 0, sizeof(MatchState));
-    slot->runtime_match_id = match_id;
+    slot->runtime_match_id = next_match_id();
+    slot->room_id = room_id;
     slot->db_match_id = 0; // Will be set when saved to DB
     slot->status = MATCH_WAITING; // Match is waiting to start
     slot->current_round_idx = 0;
     slot->created_at = time(NULL);
-    slot->player_count = 0;
+    slot->player_count = player_count;
     slot->round_count = 0;
+    arena_init(&slot->arena, ARENA_CHUNK_SIZE);
+
+    // A newer match takes over its players' routing (an eliminated player
+    // may join another game while the old one is still running)
+    bool indexed = index_put(&g_by_id, slot->runtime_match_id, slot) == 0 &&
+                   (room_id == 0 || index_put(&g_by_room, room_id, slot) == 0);
+    for (int p = 0; indexed && p < player_count; p++) {
+        slot->players[p].account_id = account_ids[p];
+        if (account_ids[p] > 0 &&
+            index_put(&g_by_player, (uint32_t)account_ids[p], slot) != 0) {
+            indexed = false;
+        }
+    }
+    if (!indexed) {
+        index_del(&g_by_id, slot->runtime_match_id, slot);
+        index_del(&g_by_room, room_id, slot);
+        unindex_players_locked(slot);
+        memset(slot, 0, sizeof(MatchState));
+        g_free[g_free_count++] = slot;
+        pthread_rwlock_unlock(&g_lock);
+        printf("[HANDLER] <matchManager> ERROR: Out of memory for match index\n");
+        return NULL;
+    }
+    g_live++;
+    int live = g_live;
+    pthread_rwlock_unlock(&g_lock);
 
-    printf("[HANDLER] <matchManager> Created match ID=%u (active: %d)\n", 
-           match_id, match_get_count());
+    printf("[HANDLER] <matchManager> Created match ID=%u room=%u (active: %d)\n",
+           slot->runtime_match_id, room_id, live);
 
+    match_exec_post_timer(slot->runtime_match_id, MATCH_STALL_TIMEOUT_MS, watch_match,
+                          match_progress(slot));
     return slot;
 }
 
 MatchState* match_get_by_id(uint32_t match_id) {
     if (match_id == 0) return NULL;
-    
-    for (int i = 0; i < MAX_ACTIVE_MATCHES; i++) {
-        if (g_matches[i].runtime_match_id == match_id) {
-            return &g_matches[i];
+
+    pthread_rwlock_rdlock(&g_lock);
+    MatchState *match = index_get(&g_by_id, match_id);
+    pthread_rwlock_unlock(&g_lock);
+    return match;
+}
+
+MatchState* match_get_by_room(uint32_t room_id) {
+    if (room_id == 0) return NULL;
+
+    pthread_rwlock_rdlock(&g_lock);
+    MatchState *match = index_get(&g_by_room, room_id);
+    pthread_rwlock_unlock(&g_lock);
+    return match;
+}
+
+// Caller holds g_lock (read). Ended matches are no longer indexed.
+static MatchState* find_by_player_locked(int32_t account_id) {
+    // Prefer the match where the player is still in play
+    MatchState *match = index_get(&g_by_player, (uint32_t)account_id);
+    return match ? match : index_get(&g_by_player_out, (uint32_t)account_id);
+}
+
+MatchState* match_find_by_player(int32_t account_id) {
+    if (account_id <= 0) return NULL;
+
+    pthread_rwlock_rdlock(&g_lock);
+    MatchState *match = find_by_player_locked(account_id);
+    pthread_rwlock_unlock(&g_lock);
+    return match;
+}
+
+uint32_t match_find_id_by_player(int32_t account_id) {
+    if (account_id <= 0) return 0;
+
+    pthread_rwlock_rdlock(&g_lock);
+    MatchState *match = find_by_player_locked(account_id);
+    uint32_t match_id = match ? match->runtime_match_id : 0;
+    pthread_rwlock_unlock(&g_lock);
+    return match_id;
+}
+
+uint32_t match_find_id_by_room(uint32_t room_id) {
+    if (room_id == 0) return 0;
+
+    pthread_rwlock_rdlock(&g_lock);
+    MatchState *match = index_get(&g_by_room, room_id);
+    uint32_t match_id = match ? match->runtime_match_id : 0;
+    pthread_rwlock_unlock(&g_lock);
+    return match_id;
+}
+
+void match_player_out(MatchState *match, int32_t account_id) {
+    if (!match || account_id <= 0) return;
+
+    pthread_rwlock_wrlock(&g_lock);
+    uint32_t key = (uint32_t)account_id;
+    if (index_get(&g_by_player, key) == match) {
+        index_del(&g_by_player, key, match);
+        if (index_put(&g_by_player_out, key, match) != 0) {
+            printf("[HANDLER] <matchManager> WARN: Out of memory indexing player %d out of match %u\n",
+                   account_id, match->runtime_match_id);
         }
     }
-    return NULL;
+    pthread_rwlock_unlock(&g_lock);
 }
 
-MatchState* match_get_by_room(uint32_t room_id) {
-    // Room ID is no longer stored in MatchState
-    // This function should not be used - kept for API compatibility
-    (void)room_id;
-    printf("[HANDLER] <matchManager> WARN: match_get_by_room() deprecated - room_id not stored\n");
-    return NULL;
+void* match_context_get(MatchState *match, MatchContextSlot slot, size_t size,
+                        void (*free_fn)(void *ctx)) {
+    if (!match || slot < 0 || slot >= MATCH_CTX_COUNT || size == 0) return NULL;
+
+    if (!match->contexts[slot]) {
+        void *ctx = calloc(1, size);
+        if (!ctx) {
+            printf("[HANDLER] <matchManager> ERROR: Out of memory for context %d of match %u\n",
+                   slot, match->runtime_match_id);
+            return NULL;
+        }
+        match->contexts[slot] = ctx;
+        match->context_free[slot] = free_fn;
+    }
+    return match->contexts[slot];
 }
 
-void match_destroy(uint32_t match_id) {
+void* match_context_find(uint32_t match_id, MatchContextSlot slot) {
+    if (slot < 0 || slot >= MATCH_CTX_COUNT) return NULL;
     MatchState *match = match_get_by_id(match_id);
+    return match ? match->contexts[slot] : NULL;
+}
+
+void match_destroy(uint32_t match_id) {
+    pthread_rwlock_wrlock(&g_lock);
+    MatchState *match = index_get(&g_by_id, match_id);
     if (!match) {
+        pthread_rwlock_unlock(&g_lock);
         printf("[HANDLER] <matchManager> WARN: Match ID %u not found for destroy\n", match_id);
         return;
     }
 
-    // Free allocated json_data strings in all rounds
-    for (int r = 0; r < match->round_count && r < MAX_MATCH_ROUNDS; r++) {
-        RoundState *round = &match->rounds[r];
-        for (int q = 0; q < round->question_count && q < MAX_QUESTIONS_PER_ROUND; q++) {
-            if (round->question_data[q].json_data) {
-                free(round->question_data[q].json_data);
-            }
-        }
-    }
-
-    printf("[HANDLER] <matchManager> Destroying match ID=%u\n", match_id);
+    index_del(&g_by_id, match_id, match);
+    index_del(&g_by_room, match->room_id, match);
+    unindex_players_locked(match);
+    size_t arena_peak = match->arena.peak;
+    size_t arena_reserved = match->arena.reserved;
+    release_match(match);
     memset(match, 0, sizeof(MatchState));
+    g_free[g_free_count++] = match;     // capacity reserved when its slab was added
+    g_live--;
+    int live = g_live;
+    pthread_rwlock_unlock(&g_lock);
+
+    // Spectators get what is still queued, then are detached
+    spectator_hub_close(match_id);
+
+    printf("[HANDLER] <matchManager> Destroyed match ID=%u (active: %d, arena peak %zu / %zu bytes)\n",
+           match_id, live, arena_peak, arena_reserved);
 }
 
 int match_get_count(void) {
-    int count = 0;
-    for (int i = 0; i < MAX_ACTIVE_MATCHES; i++) {
-        if (g_matches[i].runtime_match_id != 0) {
-            count++;
-        }
-    }
+    pthread_rwlock_rdlock(&g_lock);
+    int count = g_live;
+    pthread_rwlock_unlock(&g_lock);
     return count;
 }
 
+// Timer on the match's shard, MATCH_REAP_DELAY_MS after it ended
+static void reap_match(uint32_t match_id, uint64_t token) {
+    (void)token;
+    MatchState *match = match_get_by_id(match_id);
+    if (match && match->status == MATCH_ENDED) {
+        match_destroy(match_id);
+    }
+}
+
 void match_set_status(MatchState *match, MatchStatus status) {
     if (!match) return;
-    
+
+    MatchStatus previous = match->status;
     match->status = status;
-    printf("[HANDLER] <matchManager> Match ID=%u status updated to %d\n", 
+    printf("[HANDLER] <matchManager> Match ID=%u status updated to %d\n",
            match->runtime_match_id, status);
+
+    if (status == MATCH_ENDED && previous != MATCH_ENDED) {
+        if (match->ended_at == 0) match->ended_at = time(NULL);
+        pthread_rwlock_wrlock(&g_lock);
+        unindex_players_locked(match);
+        pthread_rwlock_unlock(&g_lock);
+        // Clients still fetch the result for a while; the replay covers later
+        match_exec_post_timer(match->runtime_match_id, MATCH_REAP_DELAY_MS, reap_match, 0);
+    }
+}
+
+void match_manager_cleanup(void) {
+    pthread_rwlock_wrlock(&g_lock);
+    int live = g_live;
+    while (g_slabs) {
+        match_slab_t *slab = g_slabs;
+        g_slabs = slab->next;
+        for (int i = 0; i < MATCH_SLAB_SIZE; i++) {
+            if (slab->matches[i].runtime_match_id != 0) release_match(&slab->matches[i]);
+        }
+        free(slab);
+    }
+    free(g_free);
+    free(g_by_id.slots);
+    free(g_by_room.slots);
+    free(g_by_player.slots);
+    free(g_by_player_out.slots);
+    g_free = NULL;
+    g_free_count = g_free_cap = g_slot_count = 0;
+    memset(&g_by_id, 0, sizeof(g_by_id));
+    memset(&g_by_room, 0, sizeof(g_by_room));
+    memset(&g_by_player, 0, sizeof(g_by_player));
+    memset(&g_by_player_out, 0, sizeof(g_by_player_out));
+    g_live = 0;
+    g_initialized = 0;
+    pthread_rwlock_unlock(&g_lock);
+    printf("[HANDLER] <matchManager> Cleaned up (%d match(es) still active)\n", live);
 }
@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "handlers/match_question.h"
+#include "utils/json_utils.h"
+
+//==============================================================================
+// HELPERS
+//==============================================================================
+
+static const char* get_string(const cJSON *obj, const char *key) {
+    const cJSON *item = cJSON_GetObjectItem(obj, key);
+    return (item && cJSON_IsString(item)) ? item->valuestring : NULL;
+}
+
+static const cJSON* get_number(const cJSON *obj, const char *key) {
+    const cJSON *item = cJSON_GetObjectItem(obj, key);
+    return (item && cJSON_IsNumber(item)) ? item : NULL;
+}
+
+// Same precedence the round 1 handler used: answer, correct_index,
+// correct_answer (number, or string matched against choices)
+static int decode_correct_index(const MatchQuestion *mq, const cJSON *data) {
+    const cJSON *num = get_number(data, "answer");
+    if (!num) num = get_number(data, "correct_index");
+    if (!num) num = get_number(data, "correct_answer");
+    if (num) return num->valueint;
+
+    const char *cans = get_string(data, "correct_answer");
+    if (cans) {
+        for (int i = 0; i < mq->choice_count; i++) {
+            if (mq->choices[i] && strcmp(mq->choices[i], cans) == 0) return i;
+        }
+    }
+    return -1;
+}
+
+// Same precedence the round 2 handler used: correct_answer, answer, price
+static int64_t decode_price(const cJSON *data) {
+    const cJSON *num = get_number(data, "correct_answer");
+    if (!num) num = get_number(data, "answer");
+    if (!num) num = get_number(data, "price");
+    return num ? (int64_t)num->valuedouble : -1;
+}
+
+// Client-facing members, rendered once and stored without the outer braces
+static int render_payload(MatchQuestion *mq, RoundType type, Arena *arena) {
+    cJSON *obj = cJSON_CreateObject();
+    if (!obj) return -1;
+
+    if (mq->text) cJSON_AddStringToObject(obj, "question", mq->text);
+    if (type != ROUND_BID && mq->choice_count > 0) {
+        cJSON *choices = cJSON_AddArrayToObject(obj, "choices");
+        for (int i = 0; choices && i < mq->choice_count; i++) {
+            cJSON_AddItemToArray(choices, cJSON_CreateString(mq->choices[i]));
+        }
+    }
+    if (mq->image) cJSON_AddStringToObject(obj, "product_image", mq->image);
+
+    char *json = json_print_arena(obj, arena);
+    cJSON_Delete(obj);
+    if (!json) return -1;
+
+    // "{...}" -> "..." by skipping the braces
+    size_t len = strlen(json);
+    if (len >= 2) {
+        json[len - 1] = '\0';
+        json++;
+        len -= 2;
+    }
+
+    mq->payload = json;
+    mq->payload_len = len;
+    return 0;
+}
+
+//==============================================================================
+// PUBLIC API
+//==============================================================================
+
+int match_question_decode(MatchQuestion *mq, const cJSON *question_obj, RoundType type,
+                          Arena *arena) {
+    if (!mq || !question_obj || !arena) return -1;
+
+    mq->correct_index = -1;
+    mq->price = -1;
+
+    // Question data is nested inside "data" field from DB
+    const cJSON *data = cJSON_GetObjectItem(question_obj, "data");
+    if (!data || !cJSON_IsObject(data)) data = question_obj;
+
+    const char *text = get_string(data, "question");
+    if (!text) text = get_string(data, "content");
+    if (!text && type == ROUND_BID) text = get_string(data, "product_name");
+
+    const char *image = get_string(data, "image");
+    if (!image) image = get_string(data, "product_image");
+
+    mq->text = arena_strdup(arena, text);
+    mq->image = arena_strdup(arena, image);
+    if ((text && !mq->text) || (image && !mq->image)) goto fail;
+
+    const cJSON *choices = cJSON_GetObjectItem(data, "choices");
+    if (choices && cJSON_IsArray(choices)) {
+        const cJSON *c = NULL;
+        cJSON_ArrayForEach(c, choices) {
+            if (mq->choice_count >= MAX_QUESTION_CHOICES) break;
+            // Keep positions stable: non-string choices become ""
+            const char *s = cJSON_IsString(c) ? c->valuestring : "";
+            mq->choices[mq->choice_count] = arena_strdup(arena, s);
+            if (!mq->choices[mq->choice_count]) goto fail;
+            mq->choice_count++;
+        }
+    }
+
+    if (type == ROUND_MCQ) mq->correct_index = decode_correct_index(mq, data);
+    if (type == ROUND_BID) mq->price = decode_price(data);
+
+    if (render_payload(mq, type, arena) != 0) goto fail;
+    return 0;
+
+fail:
+    printf("[MATCH_Q] ERROR: out of memory decoding round %d question %d\n", mq->round, mq->index);
+    match_question_reset(mq);
+    return -1;
+}
+
+void match_question_reset(MatchQuestion *mq) {
+    if (!mq) return;
+
+    int round = mq->round;
+    int index = mq->index;
+    memset(mq, 0, sizeof(*mq));
+    mq->round = round;
+    mq->index = index;
+    mq->correct_index = -1;
+    mq->price = -1;
+}
+
+char* match_question_render(const MatchQuestion *mq, const char *header, Arena *arena) {
+    if (!mq || !header || !arena) return NULL;
+
+    size_t header_len = strlen(header);
+    size_t payload_len = mq->payload ? mq->payload_len : 0;
+    bool comma = header_len > 0 && payload_len > 0;
+
+    char *json = arena_alloc(arena, header_len + payload_len + 4);
+    if (!json) return NULL;
+
+    size_t off = 0;
+    json[off++] = '{';
+    memcpy(json + off, header, header_len);
+    off += header_len;
+    if (comma) json[off++] = ',';
+    if (payload_len > 0) {
+        memcpy(json + off, mq->payload, payload_len);
+        off += payload_len;
+    }
+    json[off++] = '}';
+    json[off] = '\0';
+    return json;
+}
@@ -0,0 +1,286 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <cjson/cJSON.h>
+
+#include "handlers/match_snapshot.h"
+#include "handlers/match_manager.h"
+#include "handlers/match_executor.h"
+#include "handlers/match_question.h"
+#include "handlers/bonus_handler.h"
+#include "utils/json_utils.h"
+#include "protocol/opcode.h"
+
+//==============================================================================
+// HELPERS
+//==============================================================================
+
+static int player_index(const MatchState *match, int32_t account_id) {
+    for (int i = 0; i < match->player_count; i++) {
+        if (match->players[i].account_id == account_id) return i;
+    }
+    return -1;
+}
+
+static const char* round_type_name(RoundType type) {
+    switch (type) {
+        case ROUND_MCQ:   return "mcq";
+        case ROUND_BID:   return "bid";
+        case ROUND_WHEEL: return "wheel";
+        case ROUND_BONUS: return "bonus";
+    }
+    return "unknown";
+}
+
+static const char* bonus_state_name(BonusState state) {
+    switch (state) {
+        case BONUS_STATE_NONE:         return "none";
+        case BONUS_STATE_INITIALIZING: return "initializing";
+        case BONUS_STATE_DRAWING:      return "drawing";
+        case BONUS_STATE_REVEALING:    return "revealing";
+        case BONUS_STATE_APPLYING:     return "applying";
+        case BONUS_STATE_COMPLETED:    return "completed";
+    }
+    return "unknown";
+}
+
+static const char* answer_state_name(MatchAnswerState state) {
+    switch (state) {
+        case MATCH_ANSWER_NONE:    return "none";
+        case MATCH_ANSWER_PENDING: return "pending";
+        case MATCH_ANSWER_DONE:    return "done";
+    }
+    return "none";
+}
+
+// Where the match is, from the state the handlers already keep
+static const char* match_phase(const MatchState *match, const RoundState *round) {
+    if (match->status == MATCH_ENDED) return "ended";
+    if (is_bonus_active(match->runtime_match_id)) return "bonus";
+    if (!round || round->status == ROUND_PENDING) return "waiting_ready";
+    if (round->status == ROUND_ENDED) return "round_results";
+    return match->snapshot.open ? "playing" : "turn_results";
+}
+
+//==============================================================================
+// UPDATES
+//==============================================================================
+
+void match_snapshot_begin(MatchState *match, int question_idx, int time_limit_ms) {
+    if (!match) return;
+    MatchSnapshot *snap = &match->snapshot;
+
+    // Answers recorded under the previous seq become stale at once
+    snap->seq++;
+    snap->question_idx = question_idx;
+    snap->open = true;
+    snap->started_at = time(NULL);
+    snap->deadline_ms = time_limit_ms > 0 ? match_exec_now_ms() + time_limit_ms : 0;
+}
+
+void match_snapshot_close(MatchState *match) {
+    if (!match) return;
+    match->snapshot.open = false;
+    match->snapshot.deadline_ms = 0;
+}
+
+void match_snapshot_ready(MatchState *match, int32_t account_id) {
+    if (!match) return;
+    int idx = player_index(match, account_id);
+    if (idx < 0) return;
+    match->snapshot.players[idx].ready_round = match->current_round_idx + 1;
+}
+
+void match_snapshot_answer(MatchState *match, int32_t account_id, MatchAnswerState state,
+                           int64_t value0, int64_t value1) {
+    if (!match) return;
+    int idx = player_index(match, account_id);
+    if (idx < 0) return;
+
+    MatchSnapshotPlayer *sp = &match->snapshot.players[idx];
+    sp->answer_seq = match->snapshot.seq;
+    sp->answer = state;
+    sp->value[0] = value0;
+    sp->value[1] = value1;
+}
+
+//==============================================================================
+// GAME STATE FRAME
+//==============================================================================
+
+static void add_question(cJSON *obj, MatchState *match, const RoundState *round) {
+    const MatchSnapshot *snap = &match->snapshot;
+    int q_idx = snap->question_idx;
+    if (q_idx < 0 || q_idx >= round->question_count) return;
+
+    // Same fields as the round's question broadcast, from the pre-rendered payload
+    char header[96];
+    snprintf(header, sizeof(header), "\"question_idx\":%d,\"total_questions\":%d",
+             q_idx, round->question_count);
+
+    ArenaMark mark = arena_mark(&match->arena);
+    char *json = match_question_render(&round->question_data[q_idx], header, &match->arena);
+    if (json) cJSON_AddRawToObject(obj, "question", json);
+    arena_rewind(&match->arena, mark);
+}
+
+// Answer for the question / turn in progress, NONE between rounds
+static MatchAnswerState current_answer(const MatchState *match, const MatchSnapshotPlayer *sp,
+                                       bool in_turn) {
+    if (!in_turn || sp->answer_seq != match->snapshot.seq) return MATCH_ANSWER_NONE;
+    return sp->answer;
+}
+
+static void add_you(cJSON *obj, const MatchState *match, int idx, int round_no, bool in_turn) {
+    cJSON *you = cJSON_AddObjectToObject(obj, "you");
+    if (!you || idx < 0) return;
+
+    const MatchSnapshotPlayer *sp = &match->snapshot.players[idx];
+    const MatchPlayerState *mp = &match->players[idx];
+    MatchAnswerState state = current_answer(match, sp, in_turn);
+
+    cJSON_AddNumberToObject(you, "id", mp->account_id);
+    cJSON_AddBoolToObject(you, "eliminated", mp->eliminated);
+    cJSON_AddBoolToObject(you, "ready", sp->ready_round == round_no);
+    cJSON_AddStringToObject(you, "answer_state", answer_state_name(state));
+    if (state != MATCH_ANSWER_NONE) {
+        cJSON *values = cJSON_AddArrayToObject(you, "answer");
+        cJSON_AddItemToArray(values, cJSON_CreateNumber((double)sp->value[0]));
+        cJSON_AddItemToArray(values, cJSON_CreateNumber((double)sp->value[1]));
+    }
+}
+
+char* match_snapshot_render(MatchState *match, int32_t account_id) {
+    if (!match) return NULL;
+
+    // Not a player: spectator view, everything but "you"
+    int idx = player_index(match, account_id);
+
+    const MatchSnapshot *snap = &match->snapshot;
+    RoundState *round = NULL;
+    if (match->current_round_idx >= 0 && match->current_round_idx < match->round_count) {
+        round = &match->rounds[match->current_round_idx];
+    }
+    const char *phase = match_phase(match, round);
+    bool in_turn = strcmp(phase, "playing") == 0 || strcmp(phase, "turn_results") == 0 ||
+                   strcmp(phase, "bonus") == 0;
+
+    cJSON *obj = cJSON_CreateObject();
+    cJSON_AddTrueToObject(obj, "success");
+    cJSON_AddNumberToObject(obj, "match_id", match->runtime_match_id);
+    cJSON_AddNumberToObject(obj, "room_id", match->room_id);
+    cJSON_AddStringToObject(obj, "mode", match->mode == MODE_ELIMINATION ? "elimination" : "scoring");
+    cJSON_AddStringToObject(obj, "phase", phase);
+
+    int round_no = match->current_round_idx + 1;
+    if (round) {
+        cJSON_AddNumberToObject(obj, "round", round_no);
+        cJSON_AddNumberToObject(obj, "round_count", match->round_count);
+        cJSON_AddStringToObject(obj, "round_type", round_type_name(round->type));
+        cJSON_AddNumberToObject(obj, "question_idx", round->current_question_idx);
+        cJSON_AddNumberToObject(obj, "total_questions", round->question_count);
+    }
+
+    if (round && strcmp(phase, "playing") == 0) {
+        if (snap->deadline_ms > 0) {
+            int64_t remaining = snap->deadline_ms - match_exec_now_ms();
+            cJSON_AddNumberToObject(obj, "remaining_ms", (double)(remaining > 0 ? remaining : 0));
+        }
+        cJSON_AddNumberToObject(obj, "start_timestamp", (double)snap->started_at);
+        add_question(obj, match, round);
+    }
+
+    if (strcmp(phase, "bonus") == 0) {
+        cJSON_AddStringToObject(obj, "bonus_state",
+                                bonus_state_name(get_bonus_state(match->runtime_match_id)));
+    }
+
+    cJSON *players = cJSON_AddArrayToObject(obj, "players");
+    for (int i = 0; i < match->player_count; i++) {
+        const MatchPlayerState *mp = &match->players[i];
+        const MatchSnapshotPlayer *sp = &snap->players[i];
+        cJSON *p = cJSON_CreateObject();
+        cJSON_AddNumberToObject(p, "id", mp->account_id);
+        cJSON_AddStringToObject(p, "name", mp->name);
+        cJSON_AddNumberToObject(p, "score", mp->score);
+        cJSON_AddBoolToObject(p, "connected", mp->connected);
+        cJSON_AddBoolToObject(p, "eliminated", mp->eliminated);
+        cJSON_AddNumberToObject(p, "eliminated_at_round", mp->eliminated_at_round);
+        cJSON_AddBoolToObject(p, "forfeited", mp->forfeited);
+        cJSON_AddBoolToObject(p, "ready", sp->ready_round == round_no);
+        cJSON_AddBoolToObject(p, "answered",
+                              current_answer(match, sp, in_turn) == MATCH_ANSWER_DONE);
+        cJSON_AddItemToArray(players, p);
+    }
+
+    if (idx >= 0) {
+        add_you(obj, match, idx, round_no, in_turn);
+    } else {
+        cJSON_AddTrueToObject(obj, "spectator");
+    }
+
+    char *json = json_print_arena(obj, &match->arena);
+    cJSON_Delete(obj);
+    return json;
+}
+
+void match_snapshot_send(MatchState *match, int client_fd, int32_t account_id,
+                         MessageHeader *req) {
+    if (!match || client_fd <= 0) return;
+
+    if (player_index(match, account_id) < 0) {
+        printf("[SNAPSHOT] Account %d is not in match %u\n", account_id, match->runtime_match_id);
+        return;
+    }
+
+    ArenaMark mark = arena_mark(&match->arena);
+    char *json = match_snapshot_render(match, account_id);
+    if (json) {
+        forward_response(client_fd, req, NTF_GAME_STATE, json, (uint32_t)strlen(json));
+        printf("[SNAPSHOT] Sent game state of match %u to account %d (%zu bytes)\n",
+               match->runtime_match_id, account_id, strlen(json));
+    }
+    arena_rewind(&match->arena, mark);
+}
+
+//==============================================================================
+// RECONNECT
+//==============================================================================
+
+// Runs on the match's shard; the payload is the account id (host order)
+static void handle_game_state(int client_fd, MessageHeader *req, const char *payload) {
+    if (!payload || req->length < sizeof(int32_t)) return;
+
+    int32_t account_id;
+    memcpy(&account_id, payload, sizeof(account_id));
+
+    MatchState *match = match_find_by_player(account_id);
+    if (!match) {
+        printf("[SNAPSHOT] Account %d is no longer in a match\n", account_id);
+        return;
+    }
+
+    int idx = player_index(match, account_id);
+    if (idx >= 0) match->players[idx].connected = 1;
+    match_snapshot_send(match, client_fd, account_id, req);
+}
+
+bool match_snapshot_request(int client_fd, int32_t account_id, MessageHeader *req) {
+    uint32_t match_id = match_find_id_by_player(account_id);
+    if (match_id == 0) return false;
+
+    MessageHeader header = req ? *req : (MessageHeader){0};
+    header.length = sizeof(account_id);
+
+    char payload[sizeof(account_id)];
+    memcpy(payload, &account_id, sizeof(account_id));
+
+    if (!match_exec_post_command(match_id, client_fd, account_id, &header, payload,
+                                 handle_game_state)) {
+        printf("[SNAPSHOT] Could not queue game state of match %u for account %d\n",
+               match_id, account_id);
+        return false;
+    }
+    return true;
+}
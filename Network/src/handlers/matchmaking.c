@@ -0,0 +1,634 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <cjson/cJSON.h>
+
+#include "handlers/matchmaking.h"
+#include "handlers/session_manager.h"
+#include "handlers/session_context.h"
+#include "transport/room_manager.h"
+#include "db/repo/room_repo.h"
+#include "db/repo/profile_repo.h"
+#include "db/core/db_client.h"
+#include "protocol/opcode.h"
+
+//==============================================================================
+// TYPES
+//==============================================================================
+
+#define MM_MODES        2       // MODE_ELIMINATION, MODE_SCORING
+#define MM_CATEGORIES   4
+
+static const char *k_categories[MM_CATEGORIES] = { "", "lifestyle", "electronics", "furniture" };
+
+typedef struct {
+    int32_t account_id;
+    int client_fd;
+    uint8_t mode;
+    int category;           // index in k_categories
+    int bucket;             // skill bucket
+    int64_t enqueued_ms;
+    int heap_pos;           // position in its bucket heap, -1 when taken out
+    char name[64];
+    char avatar[256];
+} mm_ticket_t;
+
+// Min-heap on enqueue time (oldest first)
+typedef struct {
+    mm_ticket_t **items;
+    int count;
+    int cap;
+} mm_heap_t;
+
+// Open addressing on account_id (linear probing, backward-shift delete), key 0 = empty
+#define MM_INDEX_CAP    (MATCHMAKING_MAX_TICKETS * 2)
+
+typedef struct {
+    int32_t key;
+    mm_ticket_t *ticket;
+} mm_index_entry_t;
+
+static mm_heap_t g_buckets[MM_MODES][MM_CATEGORIES][MATCHMAKING_SKILL_BUCKETS];
+static mm_index_entry_t g_index[MM_INDEX_CAP];
+static int g_queued = 0;
+static int64_t g_last_tick_ms = 0;
+
+// Wait time of matched players, log2 buckets from 250 ms
+static uint64_t g_wait_hist[MATCHMAKING_WAIT_BUCKETS];
+static double g_wait_max_ms = 0.0;
+static uint64_t g_matched = 0;
+static uint64_t g_cancelled = 0;
+
+// Groups taken out of the queue this tick, seated together by seat_pending
+typedef struct {
+    mm_ticket_t *players[MAX_ROOM_MEMBERS];
+    int n;
+    uint8_t mode;
+    int category;
+} mm_group_t;
+
+static mm_group_t g_pending[MATCHMAKING_ROOMS_PER_TICK];
+static int g_pending_count = 0;
+
+//==============================================================================
+// HELPERS
+//==============================================================================
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void send_error(int client_fd, MessageHeader *req, uint16_t code, const char *message) {
+    forward_response(client_fd, req, code, message, strlen(message));
+}
+
+static void send_json(int client_fd, MessageHeader *req, uint16_t cmd, cJSON *obj) {
+    char *json = cJSON_PrintUnformatted(obj);
+    if (json) {
+        forward_response(client_fd, req, cmd, json, (uint32_t)strlen(json));
+        free(json);
+    }
+}
+
+static int category_index(const char *category) {
+    for (int i = 0; i < MM_CATEGORIES; i++) {
+        if (strcmp(category, k_categories[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static int skill_bucket(int32_t points) {
+    if (points <= 0) return 0;
+    int bucket = points / MATCHMAKING_BUCKET_POINTS;
+    return bucket < MATCHMAKING_SKILL_BUCKETS ? bucket : MATCHMAKING_SKILL_BUCKETS - 1;
+}
+
+static const char* mode_name(uint8_t mode) {
+    return mode == MODE_ELIMINATION ? "elimination" : "scoring";
+}
+
+//==============================================================================
+// INDEX
+//==============================================================================
+
+static uint32_t hash_key(uint32_t k) {
+    k ^= k >> 16;
+    k *= 0x85ebca6bu;
+    k ^= k >> 13;
+    k *= 0xc2b2ae35u;
+    k ^= k >> 16;
+    return k;
+}
+
+static mm_ticket_t* index_get(int32_t account_id) {
+    uint32_t mask = MM_INDEX_CAP - 1;
+    for (uint32_t i = hash_key((uint32_t)account_id) & mask; g_index[i].key != 0; i = (i + 1) & mask) {
+        if (g_index[i].key == account_id) return g_index[i].ticket;
+    }
+    return NULL;
+}
+
+// Caller checked the key is absent and g_queued < MATCHMAKING_MAX_TICKETS
+static void index_put(mm_ticket_t *t) {
+    uint32_t mask = MM_INDEX_CAP - 1;
+    uint32_t i = hash_key((uint32_t)t->account_id) & mask;
+    while (g_index[i].key != 0) i = (i + 1) & mask;
+    g_index[i].key = t->account_id;
+    g_index[i].ticket = t;
+}
+
+static void index_del(int32_t account_id) {
+    uint32_t mask = MM_INDEX_CAP - 1;
+    uint32_t i = hash_key((uint32_t)account_id) & mask;
+    while (g_index[i].key != account_id) {
+        if (g_index[i].key == 0) return;
+        i = (i + 1) & mask;
+    }
+
+    // Shift back the following entries that probed past the hole
+    uint32_t hole = i;
+    for (uint32_t j = (i + 1) & mask; g_index[j].key != 0; j = (j + 1) & mask) {
+        uint32_t home = hash_key((uint32_t)g_index[j].key) & mask;
+        bool movable = (hole <= j) ? (home <= hole || home > j)
+                                   : (home <= hole && home > j);
+        if (movable) {
+            g_index[hole] = g_index[j];
+            hole = j;
+        }
+    }
+    g_index[hole].key = 0;
+    g_index[hole].ticket = NULL;
+}
+
+//==============================================================================
+// BUCKET HEAPS
+//==============================================================================
+
+static bool older(const mm_ticket_t *a, const mm_ticket_t *b) {
+    if (a->enqueued_ms != b->enqueued_ms) return a->enqueued_ms < b->enqueued_ms;
+    return a->account_id < b->account_id;
+}
+
+static void heap_set(mm_heap_t *h, int pos, mm_ticket_t *t) {
+    h->items[pos] = t;
+    t->heap_pos = pos;
+}
+
+static void sift_up(mm_heap_t *h, int pos) {
+    mm_ticket_t *t = h->items[pos];
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (!older(t, h->items[parent])) break;
+        heap_set(h, pos, h->items[parent]);
+        pos = parent;
+    }
+    heap_set(h, pos, t);
+}
+
+static void sift_down(mm_heap_t *h, int pos) {
+    mm_ticket_t *t = h->items[pos];
+    for (;;) {
+        int child = pos * 2 + 1;
+        if (child >= h->count) break;
+        if (child + 1 < h->count && older(h->items[child + 1], h->items[child])) child++;
+        if (!older(h->items[child], t)) break;
+        heap_set(h, pos, h->items[child]);
+        pos = child;
+    }
+    heap_set(h, pos, t);
+}
+
+static bool heap_push(mm_heap_t *h, mm_ticket_t *t) {
+    if (h->count == h->cap) {
+        int cap = h->cap ? h->cap * 2 : 16;
+        mm_ticket_t **items = realloc(h->items, (size_t)cap * sizeof(*items));
+        if (!items) return false;
+        h->items = items;
+        h->cap = cap;
+    }
+    h->items[h->count++] = t;
+    sift_up(h, h->count - 1);
+    return true;
+}
+
+static void heap_remove(mm_heap_t *h, int pos) {
+    mm_ticket_t *t = h->items[pos];
+    h->count--;
+    if (pos != h->count) {
+        mm_ticket_t *moved = h->items[h->count];
+        heap_set(h, pos, moved);
+        sift_down(h, pos);
+        sift_up(h, moved->heap_pos);
+    }
+    t->heap_pos = -1;
+}
+
+static mm_heap_t* bucket_of(const mm_ticket_t *t) {
+    return &g_buckets[t->mode][t->category][t->bucket];
+}
+
+// Oldest ticket's bucket in [lo, hi], skipping `skip` (may be NULL); -1 if all empty
+static int oldest_bucket(mm_heap_t *buckets, int lo, int hi, const bool *skip) {
+    int best = -1;
+    for (int b = lo; b <= hi; b++) {
+        if (buckets[b].count == 0 || (skip && skip[b])) continue;
+        if (best < 0 || older(buckets[b].items[0], buckets[best].items[0])) best = b;
+    }
+    return best;
+}
+
+//==============================================================================
+// TICKETS
+//==============================================================================
+
+// Ticket leaves the queue for good (matched or cancelled)
+static void ticket_free(mm_ticket_t *t) {
+    if (t->heap_pos >= 0) heap_remove(bucket_of(t), t->heap_pos);
+    index_del(t->account_id);
+    g_queued--;
+    free(t);
+}
+
+// Still a lobby player on the socket that queued, outside any room
+static bool ticket_eligible(const mm_ticket_t *t) {
+    if (get_client_account(t->client_fd) != t->account_id) return false;
+    UserSession *s = session_get_by_account(t->account_id);
+    if (!s || s->state != SESSION_LOBBY || s->socket_fd != t->client_fd) return false;
+    return !room_user_in_any_room((uint32_t)t->account_id);
+}
+
+static void record_wait(int64_t waited_ms) {
+    double ms = (double)(waited_ms > 0 ? waited_ms : 0);
+    int b = 0;
+    double bound = 250.0;
+    while (b < MATCHMAKING_WAIT_BUCKETS - 1 && ms > bound) {
+        bound *= 2.0;
+        b++;
+    }
+    g_wait_hist[b]++;
+    if (ms > g_wait_max_ms) g_wait_max_ms = ms;
+    g_matched++;
+}
+
+static double wait_percentile(double pct) {
+    if (g_matched == 0) return 0.0;
+
+    uint64_t target = (uint64_t)((double)g_matched * pct / 100.0 + 0.5);
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    double bound = 250.0;
+    for (int b = 0; b < MATCHMAKING_WAIT_BUCKETS - 1; b++, bound *= 2.0) {
+        seen += g_wait_hist[b];
+        if (seen >= target) return bound < g_wait_max_ms ? bound : g_wait_max_ms;
+    }
+    return g_wait_max_ms;
+}
+
+static int pool_size(uint8_t mode, int category) {
+    int n = 0;
+    for (int b = 0; b < MATCHMAKING_SKILL_BUCKETS; b++) n += g_buckets[mode][category][b].count;
+    return n;
+}
+
+//==============================================================================
+// ROOM FORMATION
+//==============================================================================
+
+// Players to take out of `available` compatible ones, 0 = keep waiting
+static int group_size(uint8_t mode, int available, int64_t waited_ms) {
+    if (mode == MODE_ELIMINATION) return available >= 4 ? 4 : 0;
+    if (available >= MAX_ROOM_MEMBERS) return MAX_ROOM_MEMBERS;
+    return (available >= 4 && waited_ms >= MATCHMAKING_FILL_WAIT_MS) ? available : 0;
+}
+
+static void notify_match_found(const RoomState *room, const mm_ticket_t *t, int64_t now) {
+    cJSON *obj = cJSON_CreateObject();
+    cJSON_AddNumberToObject(obj, "roomId", room->id);
+    cJSON_AddStringToObject(obj, "roomCode", room->code);
+    cJSON_AddStringToObject(obj, "roomName", room->name);
+    cJSON_AddNumberToObject(obj, "hostId", room->host_id);
+    cJSON_AddBoolToObject(obj, "isHost", room->host_id == (uint32_t)t->account_id);
+    cJSON_AddStringToObject(obj, "category", room->category);
+    cJSON_AddNumberToObject(obj, "waitedMs", (double)(now - t->enqueued_ms));
+
+    cJSON *rules = cJSON_CreateObject();
+    cJSON_AddStringToObject(rules, "mode", mode_name(room->mode));
+    cJSON_AddNumberToObject(rules, "maxPlayers", room->max_players);
+    cJSON_AddBoolToObject(rules, "wagerMode", room->wager_mode);
+    cJSON_AddStringToObject(rules, "visibility", "private");
+    cJSON_AddItemToObject(obj, "gameRules", rules);
+
+    MessageHeader hdr = {0};
+    send_json(t->client_fd, &hdr, NTF_MATCH_FOUND, obj);
+    cJSON_Delete(obj);
+}
+
+// Private room, oldest player hosts, everyone ready; the DB rows exist already
+static bool seat_room(mm_ticket_t **group, int n, uint8_t mode, int category,
+                      const room_repo_new_t *row, int64_t now) {
+    const mm_ticket_t *host = group[0];
+
+    RoomState *room = room_create();
+    if (!room) {
+        printf("[MATCHMAKING] Cannot create room: room limit reached\n");
+        room_repo_close_room(row->room_id);
+        return false;
+    }
+    room->id = row->room_id;
+    snprintf(room->code, sizeof(room->code), "%s", row->code);
+    snprintf(room->name, sizeof(room->name), "%s", row->name);
+    room->host_id = (uint32_t)host->account_id;
+    room->status = ROOM_WAITING;
+    room->mode = (GameMode)mode;
+    room->max_players = row->max_players;
+    room->visibility = ROOM_PRIVATE;
+    room->wager_mode = 0;
+    snprintf(room->category, sizeof(room->category), "%s", k_categories[category]);
+
+    for (int i = 0; i < n; i++) {
+        const mm_ticket_t *t = group[i];
+        room_add_player(room->id, (uint32_t)t->account_id, t->name, t->avatar, t->client_fd);
+        room->players[i].is_host = (i == 0);
+        room->players[i].is_ready = true;
+    }
+    room_mark_changed();
+
+    printf("[MATCHMAKING] Room %u (%s): %d player(s), mode=%s, category='%s', host=%d\n",
+           room->id, room->code, n, mode_name(mode), room->category, host->account_id);
+
+    for (int i = 0; i < n; i++) notify_match_found(room, group[i], now);
+    broadcast_player_list(room->id);
+    return true;
+}
+
+// Back in the queue with their original enqueue time
+static void requeue(mm_ticket_t **group, int n) {
+    for (int i = 0; i < n; i++) {
+        if (!heap_push(bucket_of(group[i]), group[i])) ticket_free(group[i]);
+    }
+}
+
+// Take `want` players from buckets [lo, hi], oldest first, for this tick's batch
+static bool form_group(uint8_t mode, int category, int lo, int hi, int want) {
+    mm_heap_t *buckets = g_buckets[mode][category];
+    mm_group_t *g = &g_pending[g_pending_count];
+    g->n = 0;
+
+    while (g->n < want) {
+        int b = oldest_bucket(buckets, lo, hi, NULL);
+        if (b < 0) break;
+        mm_ticket_t *t = buckets[b].items[0];
+        heap_remove(&buckets[b], 0);
+        if (!ticket_eligible(t)) {
+            printf("[MATCHMAKING] Dropping account %d: no longer eligible\n", t->account_id);
+            ticket_free(t);
+            g_cancelled++;
+            continue;
+        }
+        g->players[g->n++] = t;
+    }
+
+    if (g->n < want) {
+        requeue(g->players, g->n);
+        return false;
+    }
+    g->mode = mode;
+    g->category = category;
+    g_pending_count++;
+    return true;
+}
+
+// Create this tick's rooms: one INSERT for the rooms, one for their members
+static void seat_pending(int64_t now) {
+    if (g_pending_count == 0) return;
+
+    room_repo_new_t rows[MATCHMAKING_ROOMS_PER_TICK];
+    uint32_t members[MATCHMAKING_ROOMS_PER_TICK][MAX_ROOM_MEMBERS];
+    for (int r = 0; r < g_pending_count; r++) {
+        const mm_group_t *g = &g_pending[r];
+        for (int i = 0; i < g->n; i++) members[r][i] = (uint32_t)g->players[i]->account_id;
+        rows[r] = (room_repo_new_t){
+            .host_id = members[r][0],
+            .name = "Quick Play",
+            .visibility = ROOM_PRIVATE,
+            .mode = g->mode,
+            .max_players = (uint8_t)(g->mode == MODE_ELIMINATION ? 4 : g->n),
+            .wager_enabled = 0,
+            .members = members[r],
+            .member_count = g->n,
+        };
+    }
+
+    if (room_repo_create_batch(rows, g_pending_count) < 0) {
+        printf("[MATCHMAKING] Cannot create %d room(s): DB error\n", g_pending_count);
+    }
+
+    for (int r = 0; r < g_pending_count; r++) {
+        mm_group_t *g = &g_pending[r];
+        if (rows[r].room_id == 0 || !seat_room(g->players, g->n, g->mode, g->category, &rows[r], now)) {
+            requeue(g->players, g->n);
+            continue;
+        }
+        for (int i = 0; i < g->n; i++) {
+            record_wait(now - g->players[i]->enqueued_ms);
+            ticket_free(g->players[i]);
+        }
+    }
+    g_pending_count = 0;
+}
+
+static void match_pool(uint8_t mode, int category, int64_t now) {
+    mm_heap_t *buckets = g_buckets[mode][category];
+    bool tried[MATCHMAKING_SKILL_BUCKETS] = {false};
+
+    while (g_pending_count < MATCHMAKING_ROOMS_PER_TICK) {
+        // The longest waiting player picks the skill range
+        int anchor = oldest_bucket(buckets, 0, MATCHMAKING_SKILL_BUCKETS - 1, tried);
+        if (anchor < 0) return;
+
+        int64_t waited = now - buckets[anchor].items[0]->enqueued_ms;
+        int spread = (int)(waited / MATCHMAKING_WIDEN_MS);
+        if (spread > MATCHMAKING_MAX_SPREAD) spread = MATCHMAKING_MAX_SPREAD;
+        int lo = anchor - spread < 0 ? 0 : anchor - spread;
+        int hi = anchor + spread >= MATCHMAKING_SKILL_BUCKETS ? MATCHMAKING_SKILL_BUCKETS - 1
+                                                              : anchor + spread;
+
+        int available = 0;
+        for (int b = lo; b <= hi; b++) available += buckets[b].count;
+
+        int want = group_size(mode, available, waited);
+        if (want == 0 || !form_group(mode, category, lo, hi, want)) tried[anchor] = true;
+    }
+}
+
+//==============================================================================
+// PUBLIC API
+//==============================================================================
+
+void matchmaking_tick(void) {
+    if (g_queued == 0) return;
+
+    int64_t now = now_ms();
+    if (now - g_last_tick_ms < MATCHMAKING_TICK_MS) return;
+    g_last_tick_ms = now;
+
+    for (uint8_t mode = 0; mode < MM_MODES; mode++) {
+        for (int c = 0; c < MM_CATEGORIES; c++) {
+            match_pool(mode, c, now);
+        }
+    }
+    seat_pending(now);
+}
+
+void matchmaking_cancel(int32_t account_id) {
+    if (account_id <= 0) return;
+    mm_ticket_t *t = index_get(account_id);
+    if (!t) return;
+
+    printf("[MATCHMAKING] Account %d left the queue\n", account_id);
+    ticket_free(t);
+    g_cancelled++;
+}
+
+void matchmaking_get_stats(MatchmakingStats *out) {
+    if (!out) return;
+    out->matched = g_matched;
+    out->cancelled = g_cancelled;
+    out->queued = g_queued;
+    out->wait_p50_ms = wait_percentile(50.0);
+    out->wait_p90_ms = wait_percentile(90.0);
+    out->wait_p99_ms = wait_percentile(99.0);
+    out->wait_max_ms = g_wait_max_ms;
+}
+
+void matchmaking_report(void) {
+    MatchmakingStats st;
+    matchmaking_get_stats(&st);
+    printf("[MATCHMAKING] queued=%d matched=%llu cancelled=%llu wait p50=%.0fms p90=%.0fms p99=%.0fms max=%.0fms\n",
+           st.queued, (unsigned long long)st.matched, (unsigned long long)st.cancelled,
+           st.wait_p50_ms, st.wait_p90_ms, st.wait_p99_ms, st.wait_max_ms);
+}
+
+void matchmaking_cleanup(void) {
+    for (int m = 0; m < MM_MODES; m++) {
+        for (int c = 0; c < MM_CATEGORIES; c++) {
+            for (int b = 0; b < MATCHMAKING_SKILL_BUCKETS; b++) {
+                mm_heap_t *h = &g_buckets[m][c][b];
+                for (int i = 0; i < h->count; i++) free(h->items[i]);
+                free(h->items);
+                memset(h, 0, sizeof(*h));
+            }
+        }
+    }
+    memset(g_index, 0, sizeof(g_index));
+    g_queued = 0;
+}
+
+//==============================================================================
+// HANDLERS
+//==============================================================================
+
+void handle_quick_play(int client_fd, MessageHeader *req, const char *payload) {
+    UserSession *session = session_get_by_socket(client_fd);
+    if (!session || session->state != SESSION_LOBBY) {
+        send_error(client_fd, req, ERR_NOT_LOGGED_IN, "Not logged in or not in lobby");
+        return;
+    }
+    int32_t account_id = session->account_id;
+
+    if (!payload || req->length != sizeof(QuickPlayPayload)) {
+        send_error(client_fd, req, ERR_BAD_REQUEST, "Invalid payload size");
+        return;
+    }
+    QuickPlayPayload data;
+    memcpy(&data, payload, sizeof(data));
+    char category[33];
+    memcpy(category, data.category, 32);
+    category[32] = '\0';
+
+    int cat = category_index(category);
+    if (data.mode != MODE_ELIMINATION && data.mode != MODE_SCORING) {
+        send_error(client_fd, req, ERR_BAD_REQUEST, "Invalid mode");
+        return;
+    }
+    if (cat < 0) {
+        send_error(client_fd, req, ERR_BAD_REQUEST, "Invalid category");
+        return;
+    }
+    if (room_user_in_any_room((uint32_t)account_id)) {
+        send_error(client_fd, req, ERR_BAD_REQUEST, "Already in a room");
+        return;
+    }
+    if (index_get(account_id)) {
+        send_error(client_fd, req, ERR_CONFLICT, "Already in queue");
+        return;
+    }
+    if (g_queued >= MATCHMAKING_MAX_TICKETS) {
+        send_error(client_fd, req, ERR_SERVICE_UNAVAILABLE, "Queue is full, please retry");
+        return;
+    }
+
+    mm_ticket_t *t = calloc(1, sizeof(*t));
+    if (!t) {
+        send_error(client_fd, req, ERR_SERVER_ERROR, "Server error");
+        return;
+    }
+    t->account_id = account_id;
+    t->client_fd = client_fd;
+    t->mode = data.mode;
+    t->category = cat;
+    t->enqueued_ms = now_ms();
+    snprintf(t->name, sizeof(t->name), "Player");
+
+    // Skill bucket and room display fields from the (cached) profile
+    int32_t points = 0;
+    profile_t *profile = NULL;
+    if (profile_find_by_account(account_id, &profile) == DB_OK && profile) {
+        points = profile->points;
+        if (profile->name) snprintf(t->name, sizeof(t->name), "%s", profile->name);
+        if (profile->avatar) snprintf(t->avatar, sizeof(t->avatar), "%s", profile->avatar);
+    }
+    profile_free(profile);
+    t->bucket = skill_bucket(points);
+
+    if (!heap_push(bucket_of(t), t)) {
+        free(t);
+        send_error(client_fd, req, ERR_SERVER_ERROR, "Server error");
+        return;
+    }
+    index_put(t);
+    g_queued++;
+
+    printf("[MATCHMAKING] Account %d queued: mode=%s, category='%s', points=%d (bucket %d)\n",
+           account_id, mode_name(t->mode), category, points, t->bucket);
+
+    MatchmakingStats st;
+    matchmaking_get_stats(&st);
+    cJSON *obj = cJSON_CreateObject();
+    cJSON_AddTrueToObject(obj, "queued");
+    cJSON_AddStringToObject(obj, "mode", mode_name(t->mode));
+    cJSON_AddStringToObject(obj, "category", category);
+    cJSON_AddNumberToObject(obj, "bucket", t->bucket);
+    cJSON_AddNumberToObject(obj, "queueSize", pool_size(t->mode, cat));
+    cJSON_AddNumberToObject(obj, "waitP50Ms", st.wait_p50_ms);
+    cJSON_AddNumberToObject(obj, "waitP90Ms", st.wait_p90_ms);
+    cJSON_AddNumberToObject(obj, "waitP99Ms", st.wait_p99_ms);
+    send_json(client_fd, req, RES_QUEUED, obj);
+    cJSON_Delete(obj);
+}
+
+void handle_quick_play_cancel(int client_fd, MessageHeader *req, const char *payload) {
+    (void)payload;
+    int32_t account_id = get_client_account(client_fd);
+    if (account_id <= 0 || !index_get(account_id)) {
+        send_error(client_fd, req, ERR_BAD_REQUEST, "Not in queue");
+        return;
+    }
+    matchmaking_cancel(account_id);
+    forward_response(client_fd, req, RES_QUEUE_LEFT, "", 0);
+}
@@ -6,7 +6,7 @@
 #include <cjson/cJSON.h>
 
 #include "handlers/presence_manager.h"
-#include "db/repo/friend_repo.h"
+#include "db/repo/friend_graph.h"
 #include "protocol/protocol.h"
 #include "protocol/opcode.h"
 
@@ -125,21 +125,6 @@ void presence_register_online(
     user->current_room_id = 0;
     user->last_heartbeat = time(NULL);
 
-    // Load friend list from DB
-    int32_t *friend_ids = NULL;
-    int32_t friend_count = 0;
-
-    db_error_t err = friend_list_get_ids(account_id, &friend_ids, &friend_count);
-    if (err == DB_SUCCESS && friend_count > 0) {
-        user->friend_ids = friend_ids;
-        user->friend_count = friend_count;
-        printf("[PRESENCE] Loaded %d friends for user %d\n", friend_count, account_id);
-    } else {
-        user->friend_ids = NULL;
-        user->friend_count = 0;
-        printf("[PRESENCE] User %d has no friends\n", account_id);
-    }
-
     printf("[PRESENCE] User %d now online (total: %d)\n", account_id, g_online_count);
 
     // Notify all online friends
@@ -183,12 +168,6 @@ void presence_unregister_offline(int32_t account_id) {
     // Notify all online friends before removing
     presence_broadcast_status_change(account_id, PRESENCE_OFFLINE, 0);
 
-    // Free friend list
-    if (user->friend_ids) {
-        free(user->friend_ids);
-        user->friend_ids = NULL;
-    }
-
     // Remove from array by shifting
     for (int32_t i = 0; i < g_online_count - 1; i++) {
         if (g_online_users[i].account_id == account_id) {
@@ -216,22 +195,29 @@ friend_presence_t* presence_get_friends_status(
 ) {
     if (!out_count) return NULL;
 
-    online_user_t *user = find_online_user(account_id);
-    if (!user || user->friend_count == 0) {
-        *out_count = 0;
+    *out_count = 0;
+    if (!find_online_user(account_id)) {
+        return NULL;
+    }
+
+    int32_t *friend_ids = NULL;
+    int32_t friend_count = 0;
+    if (friend_graph_get_ids(account_id, &friend_ids, &friend_count) != DB_SUCCESS ||
+        friend_count == 0) {
+        free(friend_ids);
         return NULL;
     }
 
     // Allocate result array
-    friend_presence_t *result = calloc(user->friend_count, sizeof(friend_presence_t));
+    friend_presence_t *result = calloc(friend_count, sizeof(friend_presence_t));
     if (!result) {
-        *out_count = 0;
+        free(friend_ids);
         return NULL;
     }
 
     int32_t filled = 0;
-    for (int32_t i = 0; i < user->friend_count; i++) {
-        int32_t friend_id = user->friend_ids[i];
+    for (int32_t i = 0; i < friend_count; i++) {
+        int32_t friend_id = friend_ids[i];
         online_user_t *friend = find_online_user(friend_id);
 
         result[filled].friend_id = friend_id;
@@ -247,6 +233,7 @@ friend_presence_t* presence_get_friends_status(
         filled++;
     }
 
+    free(friend_ids);
     *out_count = filled;
     return result;
 }
@@ -270,16 +257,22 @@ void presence_broadcast_status_change(
 ) {
     printf("[PRESENCE] Broadcasting status change for user %d\n", account_id);
 
-    // Find the user to get their friend list
-    online_user_t *user = find_online_user(account_id);
-    if (!user) {
+    if (!find_online_user(account_id)) {
         printf("[PRESENCE] User %d not found (probably offline), skipping broadcast\n", account_id);
         return;
     }
 
+    // Friend ids come from the shared friend graph (DB only on first use)
+    int32_t *friend_ids = NULL;
+    int32_t friend_count = 0;
+    if (friend_graph_get_ids(account_id, &friend_ids, &friend_count) != DB_SUCCESS) {
+        printf("[PRESENCE] Could not load friends of user %d, skipping broadcast\n", account_id);
+        return;
+    }
+
     // Notify each online friend
-    for (int32_t i = 0; i < user->friend_count; i++) {
-        int32_t friend_id = user->friend_ids[i];
+    for (int32_t i = 0; i < friend_count; i++) {
+        int32_t friend_id = friend_ids[i];
         online_user_t *friend = find_online_user(friend_id);
 
         if (friend && friend->client_fd > 0) {
@@ -287,17 +280,12 @@ void presence_broadcast_status_change(
             notify_friend_status(friend->client_fd, account_id, new_status, room_id);
         }
     }
+
+    free(friend_ids);
 }
 
 void presence_cleanup(void) {
     printf("[PRESENCE] Cleaning up presence manager\n");
-    
-    for (int32_t i = 0; i < g_online_count; i++) {
-        if (g_online_users[i].friend_ids) {
-            free(g_online_users[i].friend_ids);
-            g_online_users[i].friend_ids = NULL;
-        }
-    }
 
     memset(g_online_users, 0, sizeof(g_online_users));
     g_online_count = 0;
@@ -5,8 +5,11 @@
 #include "protocol/opcode.h"
 #include "protocol/protocol.h"
 #include "transport/room_manager.h"
+#include "transport/room_list.h"
 #include "db/repo/room_repo.h"
+#include "db/repo/profile_repo.h"
 #include "handlers/session_manager.h"
+#include "handlers/matchmaking.h"
 #include "db/core/db_client.h"
 #include <cjson/cJSON.h>
 #include <limits.h>
@@ -194,38 +197,30 @@ void handle_create_room(int client_fd, MessageHeader *req, const char *payload)
     // Update room with DB values
     room->id = db_room_id;
     strncpy(room->code, db_room_code, 8);
+    room_mark_changed();
     
     printf("[SERVER] [CREATE_ROOM] DB persisted: id=%u, code=%s\n", room->id, room->code);
     
     // STEP 8: Fetch host profile to get name & avatar
     char profile_name[64] = "Host";
     char profile_avatar[256] = "";
-    char query[128];
-    snprintf(query, sizeof(query), "SELECT * FROM profiles WHERE account_id = %u LIMIT 1", session->account_id);
-    
-    cJSON *profile_response = NULL;
-    db_error_t profile_rc = db_get("profiles", query, &profile_response);
-    
-    if (profile_rc == DB_OK && profile_response) {
-        cJSON *first = cJSON_GetArrayItem(profile_response, 0);
-        if (first) {
-            cJSON *name_item = cJSON_GetObjectItem(first, "name");
-            if (name_item && cJSON_IsString(name_item)) {
-                strncpy(profile_name, name_item->valuestring, sizeof(profile_name) - 1);
-                profile_name[sizeof(profile_name) - 1] = '\0';
-            }
-            cJSON *avatar_item = cJSON_GetObjectItem(first, "avatar");
-            if (avatar_item && cJSON_IsString(avatar_item)) {
-                strncpy(profile_avatar, avatar_item->valuestring, sizeof(profile_avatar) - 1);
-                profile_avatar[sizeof(profile_avatar) - 1] = '\0';
-            }
+    profile_t *profile = NULL;
+    if (profile_find_by_account((int32_t)session->account_id, &profile) == DB_OK && profile) {
+        if (profile->name) {
+            strncpy(profile_name, profile->name, sizeof(profile_name) - 1);
+            profile_name[sizeof(profile_name) - 1] = '\0';
+        }
+        if (profile->avatar) {
+            strncpy(profile_avatar, profile->avatar, sizeof(profile_avatar) - 1);
+            profile_avatar[sizeof(profile_avatar) - 1] = '\0';
         }
-        cJSON_Delete(profile_response);
     }
+    profile_free(profile);
     
     // STEP 9: Add host as player with name and avatar
     room_add_player(room->id, session->account_id, profile_name, profile_avatar, client_fd);
     room->players[0].is_host = true;
+    matchmaking_cancel(session->account_id);
     
     printf("[SERVER] [CREATE_ROOM] Host added as player (account_id=%u, name=%s)\n", 
            session->account_id, profile_name);
@@ -363,28 +358,18 @@ void handle_join_room(int client_fd, MessageHeader *req, const char *payload) {
     // STEP 7: Get player name & avatar from DB
     char profile_name[64] = "Player";  // fallback default
     char profile_avatar[256] = "";     // fallback empty
-    char query[128];
-    snprintf(query, sizeof(query), "SELECT * FROM profiles WHERE account_id = %u LIMIT 1", session->account_id);
-    
-    cJSON *profile_response = NULL;
-    db_error_t profile_rc = db_get("profiles", query, &profile_response);
-    
-    if (profile_rc == DB_OK && profile_response) {
-        cJSON *first = cJSON_GetArrayItem(profile_response, 0);
-        if (first) {
-            cJSON *name_item = cJSON_GetObjectItem(first, "name");
-            if (name_item && cJSON_IsString(name_item)) {
-                strncpy(profile_name, name_item->valuestring, sizeof(profile_name) - 1);
-                profile_name[sizeof(profile_name) - 1] = '\0';
-            }
-            cJSON *avatar_item = cJSON_GetObjectItem(first, "avatar");
-            if (avatar_item && cJSON_IsString(avatar_item)) {
-                strncpy(profile_avatar, avatar_item->valuestring, sizeof(profile_avatar) - 1);
-                profile_avatar[sizeof(profile_avatar) - 1] = '\0';
-            }
+    profile_t *profile = NULL;
+    if (profile_find_by_account((int32_t)session->account_id, &profile) == DB_OK && profile) {
+        if (profile->name) {
+            strncpy(profile_name, profile->name, sizeof(profile_name) - 1);
+            profile_name[sizeof(profile_name) - 1] = '\0';
+        }
+        if (profile->avatar) {
+            strncpy(profile_avatar, profile->avatar, sizeof(profile_avatar) - 1);
+            profile_avatar[sizeof(profile_avatar) - 1] = '\0';
         }
-        cJSON_Delete(profile_response);
     }
+    profile_free(profile);
     
     printf("[SERVER] [JOIN_ROOM] Player name: %s\n", profile_name);
     
@@ -399,26 +384,15 @@ void handle_join_room(int client_fd, MessageHeader *req, const char *payload) {
     
     printf("[SERVER] [JOIN_ROOM] Player %u (%s) added to room %u\n",
            session->account_id, profile_name, room->id);
+    matchmaking_cancel(session->account_id);
     
     // STEP 9: Save to database (best-effort)
-    cJSON *member_payload = cJSON_CreateObject();
-    cJSON_AddNumberToObject(member_payload, "room_id", room->id);
-    cJSON_AddNumberToObject(member_payload, "account_id", session->account_id);
-    
-    cJSON *db_response = NULL;
-    db_error_t db_rc = db_post("room_members", member_payload, &db_response);
-    cJSON_Delete(member_payload);
-    
-    if (db_rc != DB_OK) {
+    if (room_repo_add_player(room->id, session->account_id) != 0) {
         printf("[SERVER] [JOIN_ROOM] ⚠️ DB insert failed (non-critical)\n");
         printf("[SERVER] [JOIN_ROOM] Player already in memory, game can proceed\n");
         // Continue anyway - eventual consistency model
     }
     
-    if (db_response) {
-        cJSON_Delete(db_response);
-    }
-    
     // STEP 10: Send response to joiner with Room Info (JSON)
     cJSON *resp = cJSON_CreateObject();
     cJSON_AddNumberToObject(resp, "roomId", room->id);
@@ -712,22 +686,15 @@ void handle_kick_member(int client_fd, MessageHeader *req, const char *payload)
     printf("[Kick Member] Sent RES_MEMBER_KICKED to host (fd=%d)\n", client_fd);
     
     // ========== BƯỚC 14: GỬI NTF_MEMBER_KICKED CHO NGƯỜI BỊ KICK (UNICAST) ==========
-    if (target_fd >= 0) {
+    if (target_fd > 0) {
         cJSON *kick_json = cJSON_CreateObject();
         cJSON_AddNumberToObject(kick_json, "room_id", room_id);
         char *kick_str = cJSON_PrintUnformatted(kick_json);
         
-        // Manual send (vì không có helper function cho unicast)
+        // Unicast notification (seq 0)
         MessageHeader ntf;
         memset(&ntf, 0, sizeof(ntf));
-        ntf.magic = htons(MAGIC_NUMBER);
-        ntf.version = PROTOCOL_VERSION;
-        ntf.command = htons(NTF_MEMBER_KICKED);
-        ntf.seq_num = 0;
-        ntf.length = htonl(strlen(kick_str));
-        
-        send(target_fd, &ntf, sizeof(ntf), 0);
-        send(target_fd, kick_str, strlen(kick_str), 0);
+        forward_response(target_fd, &ntf, NTF_MEMBER_KICKED, kick_str, (uint32_t)strlen(kick_str));
         
         free(kick_str);
         cJSON_Delete(kick_json);
@@ -864,6 +831,7 @@ void handle_leave_room(int client_fd, MessageHeader *req, const char *payload) {
         for (int i = 0; i < room->player_count; i++) {
             room->players[i].is_host = (room->players[i].account_id == new_host_id);
         }
+        room_mark_changed();
         
         // Update DB
         rc = room_repo_update_host(room_id, new_host_id);
@@ -954,42 +922,69 @@ void handle_leave_room(int client_fd, MessageHeader *req, const char *payload) {
 // GET ROOM LIST
 //==============================================================================
 void handle_get_room_list(int client_fd, MessageHeader *req, const char *payload) {
-    (void)payload; // Request payload is empty/ignored
-    
-    // 1. Query DB for recent waiting rooms
-    // NEW: Query from view 'rooms_with_counts' to get 'current_players'
-    
-    char query[256];
-    snprintf(query, sizeof(query), 
-             "SELECT id, name, status, mode, max_players, visibility, wager_mode, current_players FROM rooms_with_counts WHERE status = 'waiting' ORDER BY created_at DESC LIMIT 10");
-    
-    cJSON *response = NULL;
-    // Update target table to 'rooms_with_counts'
-    db_error_t rc = db_get("rooms_with_counts", query, &response);
+    // Served from the in-memory room snapshot (see transport/room_list.h).
+    // Empty payload: legacy reply, a bare array of the newest waiting rooms.
+    // JSON payload {cursor, limit, mode, visibility, min_free}: paged reply
+    // {"version", "rooms", "next_cursor"}.
+    RoomListQuery query;
+    room_list_query_init(&query);
+    
+    bool paged = false;
+    if (payload && req->length > 0) {
+        cJSON *json = cJSON_ParseWithLength(payload, req->length);
+        if (json && cJSON_IsObject(json)) {
+            paged = true;
+            cJSON *item;
+            if ((item = cJSON_GetObjectItem(json, "cursor")) && cJSON_IsNumber(item) && item->valuedouble > 0) {
+                query.cursor = (uint32_t)item->valuedouble;
+            }
+            if ((item = cJSON_GetObjectItem(json, "limit")) && cJSON_IsNumber(item)) {
+                query.limit = item->valueint;
+            }
+            if ((item = cJSON_GetObjectItem(json, "mode")) && cJSON_IsString(item)) {
+                query.mode = strcmp(item->valuestring, "scoring") == 0 ? MODE_SCORING : MODE_ELIMINATION;
+            }
+            if ((item = cJSON_GetObjectItem(json, "visibility")) && cJSON_IsString(item)) {
+                query.visibility = strcmp(item->valuestring, "private") == 0 ? ROOM_PRIVATE : ROOM_PUBLIC;
+            }
+            if ((item = cJSON_GetObjectItem(json, "min_free")) && cJSON_IsNumber(item)) {
+                query.min_free_slots = item->valueint;
+            }
+        }
+        if (json) cJSON_Delete(json);
+    }
     
-    if (rc != DB_OK || !response) {
-        printf("[SERVER] [GET_ROOM_LIST] DB query failed\n");
-        forward_response(client_fd, req, RES_ROOM_LIST, "[]", 2);
+    uint32_t next_cursor = 0;
+    uint64_t version = 0;
+    size_t rooms_len = 0;
+    char *rooms = room_list_page(&query, &next_cursor, &version, &rooms_len);
+    if (!rooms) {
+        send_error(client_fd, req, ERR_SERVER_ERROR, "JSON error");
         return;
     }
     
-    // 2. Convert to JSON string
-    char *json_str = cJSON_PrintUnformatted(response);
+    if (!paged) {
+        forward_response(client_fd, req, RES_ROOM_LIST, rooms, (uint32_t)rooms_len);
+        free(rooms);
+        return;
+    }
     
-    if (!json_str) {
-        cJSON_Delete(response);
+    size_t cap = rooms_len + 96;
+    char *body = malloc(cap);
+    if (!body) {
+        free(rooms);
         send_error(client_fd, req, ERR_SERVER_ERROR, "JSON error");
         return;
     }
+    int len = snprintf(body, cap, "{\"version\":%llu,\"next_cursor\":%u,\"rooms\":%s}",
+                       (unsigned long long)version, next_cursor, rooms);
     
-    printf("[SERVER] [GET_ROOM_LIST] Sending %zu bytes\n", strlen(json_str));
-    
-    // 3. Send response
-    forward_response(client_fd, req, RES_ROOM_LIST, json_str, strlen(json_str));
+    printf("[SERVER] [GET_ROOM_LIST] Sending %d bytes (v%llu, next_cursor=%u)\n",
+           len, (unsigned long long)version, next_cursor);
+    forward_response(client_fd, req, RES_ROOM_LIST, body, (uint32_t)len);
     
-    // Cleanup
-    free(json_str);
-    cJSON_Delete(response);
+    free(body);
+    free(rooms);
 }
 //==============================================================================
 // SET GAME RULE
@@ -1078,6 +1073,7 @@ void handle_set_rule(int client_fd, MessageHeader *req, const char *payload) {
     room->max_players = max_players;
     room->visibility = visibility;
     room->wager_mode = wager_mode;
+    room_mark_changed();
     
     // Log AFTER state
     printf("[SetGameRule] AFTER changes:\n");
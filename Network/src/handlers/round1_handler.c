@@ -3,9 +3,9 @@
  * Manages round execution flow for the quiz round.
  * 
  * STATE USAGE:
- * - Score: MatchPlayerState.score - READ/UPDATE via get_match_player()
+ * - Score: MatchPlayerState.score - READ/UPDATE via round_player()
  * - Eliminated: MatchPlayerState.eliminated - READ/UPDATE
- * - Connected: UserSession.state - READ via session_get_by_account()
+ * - Connected: UserSession.state - READ via round_connected()
  * - Current question: RoundState.current_question_idx - READ/UPDATE
  * - Question data: RoundState.question_data[] - READ only
  * 
@@ -27,19 +27,24 @@
 #include <stdbool.h>
 #include <arpa/inet.h>
 #include <time.h>
-#include <unistd.h>                     // For sleep()
 
 #include "handlers/round1_handler.h"
 #include "handlers/session_manager.h"   // UserSession management
 #include "handlers/match_manager.h"     // MatchState management
 #include "handlers/start_game_handler.h" // State definitions
+#include "handlers/match_question.h"     // Pre-rendered question payloads
+#include "handlers/match_snapshot.h"     // Reconnect game state
 #include "handlers/bonus_handler.h"     // Bonus round for ties
+#include "handlers/match_executor.h"    // Question timeout timer
+#include "handlers/round_engine.h"      // Roster, ranking, elimination, round end
+#include "transport/latency.h"          // RTT credit on answer times
+#include "utils/json_utils.h"            // Frames printed into the match arena
 #include "db/core/db_client.h"          // Direct DB access
-#include "db/repo/match_repo.h"         // For db_match_event_insert, db_match_answer_insert
+#include "db/repo/match_repo.h"
+#include "db/repo/match_write_queue.h"  // For match_wq_event, match_wq_answer
 #include "protocol/opcode.h"
 #include "protocol/protocol.h"
 #include <cjson/cJSON.h>
-#include <pthread.h>                    // For timeout timer
 
 //==============================================================================
 // CONSTANTS
@@ -61,6 +66,7 @@
 // - score → MatchPlayerState.score
 // - eliminated → MatchPlayerState.eliminated
 // - connected → UserSession.state
+// - match, roster, elimination → RoundCore (round_engine.h)
 //==============================================================================
 
 typedef struct {
@@ -70,210 +76,111 @@ typedef struct {
 } R1_PlayerAnswer;
 
 typedef struct {
-    uint32_t match_id;          // Links to MatchState
-    int      round_index;       // Which round (0-based)
-    bool     is_active;         // Is round currently running
+    RoundCore core;             // Match, roster, round index, is_active (first member)
     
-    R1_PlayerAnswer players[MAX_MATCH_PLAYERS];
-    int      player_count;
+    R1_PlayerAnswer players[MAX_MATCH_PLAYERS];  // Same index as core.seats
     int      ready_count;
     
     // Timer for question timeout
-    time_t   question_start_time;  // When current question started
+    time_t   question_start_time;  // Wall clock, sent as start_timestamp
+    int64_t  question_start_ms;    // Match clock (match_exec_now_ms) answers are timed from
     int      current_timer_q_idx;  // Question index for timer
-    pthread_t timer_thread;        // Timer thread handle
+    uint32_t timer_seq;            // Token of the armed timer (bumped on start/stop)
     bool     timer_running;        // Is timer active
 } R1_Context;
 
-// Global round 1 context (in-memory only)
-static R1_Context g_r1 = {0};
-static pthread_mutex_t g_r1_mutex = PTHREAD_MUTEX_INITIALIZER;
+// One context per match (MatchState.contexts[MATCH_CTX_ROUND1]), created
+// on the first ready and freed by match_destroy(). Every access runs on the
+// executor shard owning the match (commands, timeouts, disconnects), so
+// contexts need no locking.
 
-// Forward declaration for timer thread
-void advance_to_next_question(MessageHeader *req);
+// Forward declaration for timer
+static void advance_to_next_question(R1_Context *ctx, MessageHeader *req);
 
 //==============================================================================
-// HELPER: Reset context
+// HELPER: Context lifetime
 //==============================================================================
 
-static void reset_context(void) {
-    pthread_mutex_lock(&g_r1_mutex);
-    g_r1.timer_running = false;
-    pthread_mutex_unlock(&g_r1_mutex);
-    
-    memset(&g_r1, 0, sizeof(g_r1));
+static R1_Context* find_context(uint32_t match_id) {
+    return match_context_find(match_id, MATCH_CTX_ROUND1);
+}
+
+static void reset_context(R1_Context *ctx) {
+    // Keep the timer sequence so a timer armed before the reset stays stale
+    uint32_t timer_seq = ctx->timer_seq;
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->timer_seq = timer_seq + 1;
     printf("[Round1] Context reset\n");
 }
 
 //==============================================================================
 // TIMER: Question timeout handler
-// Runs in separate thread, auto-advances after TIME_PER_QUESTION
-//==============================================================================
-
-static void* question_timer_thread(void *arg) {
-    (void)arg;
-    
-    int target_q_idx = g_r1.current_timer_q_idx;
-    uint32_t target_match = g_r1.match_id;
-    
-    printf("[Round1-Timer] Started for question %d (timeout: %dms)\n", 
-           target_q_idx, TIME_PER_QUESTION);
-    
-    // Sleep for question duration (convert ms to seconds)
-    int sleep_time = TIME_PER_QUESTION / 1000;
-    for (int i = 0; i < sleep_time; i++) {
-        sleep(1);
-        
-        pthread_mutex_lock(&g_r1_mutex);
-        bool still_running = g_r1.timer_running;
-        bool same_question = (g_r1.current_timer_q_idx == target_q_idx && 
-                             g_r1.match_id == target_match);
-        pthread_mutex_unlock(&g_r1_mutex);
-        
-        if (!still_running || !same_question) {
-            printf("[Round1-Timer] Cancelled (question already advanced)\n");
-            return NULL;
-}
-    }
-    
-    // Check if we should still advance
-    pthread_mutex_lock(&g_r1_mutex);
-    bool should_advance = g_r1.timer_running && 
-                         g_r1.current_timer_q_idx == target_q_idx &&
-                         g_r1.match_id == target_match &&
-                         g_r1.is_active;
-    pthread_mutex_unlock(&g_r1_mutex);
-    
-    if (should_advance) {
-        printf("[Round1-Timer] ⏰ TIMEOUT! Auto-advancing from question %d\n", target_q_idx);
-  
-        // Mark all non-answered players as having answered (with 0 score)
-        for (int i = 0; i < g_r1.player_count; i++) {
-            if (!g_r1.players[i].answered_current) {
-                g_r1.players[i].answered_current = true;
-                printf("[Round1-Timer] Player %d did not answer in time\n", 
-                       g_r1.players[i].account_id);
-            }
+// Runs on the match's shard TIME_PER_QUESTION after the question started and
+// auto-advances. The token is the timer_seq it was armed with: any later
+// start / stop makes it stale, and a destroyed match has no context left.
+//==============================================================================
+
+static void question_timeout(uint32_t match_id, uint64_t token) {
+    R1_Context *ctx = find_context(match_id);
+    bool should_advance = ctx && ctx->timer_running &&
+                         ctx->timer_seq == (uint32_t)token &&
+                         ctx->core.is_active;
+    if (!should_advance) return;
+    
+    printf("[Round1-Timer] ⏰ TIMEOUT! Auto-advancing from question %d\n", ctx->current_timer_q_idx);
+    
+    // Mark all non-answered players as having answered (with 0 score)
+    for (int i = 0; i < ctx->core.seat_count; i++) {
+        if (!ctx->players[i].answered_current) {
+            ctx->players[i].answered_current = true;
+            printf("[Round1-Timer] Player %d did not answer in time\n", 
+                   ctx->players[i].account_id);
         }
-        
-        // Advance to next question (using a dummy header)
-        MessageHeader dummy = {0};
-        advance_to_next_question(&dummy);
     }
     
-    return NULL;
-    }
+    // Advance to next question (using a dummy header)
+    MessageHeader dummy = {0};
+    advance_to_next_question(ctx, &dummy);
+}
 
-static void start_question_timer(int q_idx) {
-    pthread_mutex_lock(&g_r1_mutex);
-    
-    // Stop previous timer if running
-    g_r1.timer_running = false;
-    
-    // Set up new timer
-    g_r1.question_start_time = time(NULL);
-    g_r1.current_timer_q_idx = q_idx;
-    g_r1.timer_running = true;
+static void start_question_timer(R1_Context *ctx, int q_idx) {
+    // Supersedes the previous timer (if any)
+    ctx->timer_seq++;
+    ctx->question_start_time = time(NULL);
+    ctx->question_start_ms = match_exec_now_ms();
+    ctx->current_timer_q_idx = q_idx;
+    ctx->timer_running = true;
     
-    pthread_mutex_unlock(&g_r1_mutex);
+    printf("[Round1-Timer] Started for match %u question %d (timeout: %dms)\n", 
+           ctx->core.match_id, q_idx, TIME_PER_QUESTION);
     
-    // Create timer thread (detached - don't need to join)
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
-    
-    if (pthread_create(&g_r1.timer_thread, &attr, question_timer_thread, NULL) != 0) {
-        printf("[Round1-Timer] Warning: Failed to create timer thread\n");
+    if (!match_exec_post_timer(ctx->core.match_id, TIME_PER_QUESTION, question_timeout, ctx->timer_seq)) {
+        printf("[Round1-Timer] Warning: Failed to arm timer\n");
     }
-    
-    pthread_attr_destroy(&attr);
 }
 
-static void stop_question_timer(void) {
-    pthread_mutex_lock(&g_r1_mutex);
-    g_r1.timer_running = false;
-    pthread_mutex_unlock(&g_r1_mutex);
+static void stop_question_timer(R1_Context *ctx) {
+    ctx->timer_running = false;
+    ctx->timer_seq++;
 }
 
-//==============================================================================
-// HELPER: Get states from other PICs
-//==============================================================================
-
-/**
- * Get MatchState from match_manager
- */
-static MatchState* get_match(void) {
-    if (g_r1.match_id == 0) return NULL;
-    return match_get_by_id(g_r1.match_id);
-}
-
-/**
- * Get current RoundState from MatchState
- */
-static RoundState* get_round(void) {
-    MatchState *match = get_match();
-    if (!match) return NULL;
-    if (g_r1.round_index < 0 || g_r1.round_index >= match->round_count) {
-        return NULL;
-    }
-    return &match->rounds[g_r1.round_index];
-}
-
-/**
- * Get MatchPlayerState by account_id
- */
-static MatchPlayerState* get_match_player(int32_t account_id) {
-    MatchState *match = get_match();
-    if (!match) return NULL;
-  
-    for (int i = 0; i < match->player_count; i++) {
-        if (match->players[i].account_id == account_id) {
-            return &match->players[i];
-        }
-    }
-    return NULL;
-}
-
-/**
- * Check if player is connected using UserSession
- */
-static bool is_connected(int32_t account_id) {
-    UserSession *session = session_get_by_account(account_id);
-    if (!session) return false;
-    return session->state != SESSION_PLAYING_DISCONNECTED;
-}
-
-/**
- * Get socket_fd for player from UserSession
- */
-static int get_socket(int32_t account_id) {
-    UserSession *session = session_get_by_account(account_id);
-    if (!session || session->state == SESSION_PLAYING_DISCONNECTED) {
-        return -1;
-    }
-    return session->socket_fd;
-    }
-    
 //==============================================================================
 // HELPER: Local answer tracking
 //==============================================================================
 
-static R1_PlayerAnswer* find_player(int32_t account_id) {
-    for (int i = 0; i < g_r1.player_count; i++) {
-        if (g_r1.players[i].account_id == account_id) {
-            return &g_r1.players[i];
-        }
-    }
-    return NULL;
+static R1_PlayerAnswer* find_player(R1_Context *ctx, int32_t account_id) {
+    int seat = round_seat_find(&ctx->core, account_id);
+    return seat >= 0 ? &ctx->players[seat] : NULL;
 }
 
-static R1_PlayerAnswer* add_player(int32_t account_id) {
-    R1_PlayerAnswer *existing = find_player(account_id);
+static R1_PlayerAnswer* add_player(R1_Context *ctx, int32_t account_id) {
+    R1_PlayerAnswer *existing = find_player(ctx, account_id);
     if (existing) return existing;
     
-    if (g_r1.player_count >= MAX_MATCH_PLAYERS) return NULL;
+    int seat = round_seat_add(&ctx->core, account_id);
+    if (seat < 0) return NULL;
     
-    R1_PlayerAnswer *p = &g_r1.players[g_r1.player_count++];
+    R1_PlayerAnswer *p = &ctx->players[seat];
     p->account_id = account_id;
     p->answered_current = false;
     p->ready = false;
@@ -283,45 +190,25 @@ static R1_PlayerAnswer* add_player(int32_t account_id) {
 /**
  * Reset answered_current for all players (called when moving to next question)
  */
-static void reset_answered_flags(void) {
-    for (int i = 0; i < g_r1.player_count; i++) {
-        g_r1.players[i].answered_current = false;
+static void reset_answered_flags(R1_Context *ctx) {
+    for (int i = 0; i < ctx->core.seat_count; i++) {
+        ctx->players[i].answered_current = false;
     }
 }
 
 /**
  * Count how many have answered current question
  */
-static int count_answered(void) {
+static int count_answered(R1_Context *ctx) {
     int count = 0;
-    for (int i = 0; i < g_r1.player_count; i++) {
-        if (g_r1.players[i].answered_current) {
+    for (int i = 0; i < ctx->core.seat_count; i++) {
+        if (ctx->players[i].answered_current) {
                 count++;
         }
     }
   return count;
 }
 
-/**
- * Count connected players (using UserSession)
- */
-static int count_connected(void) {
-    int count = 0;
-    for (int i = 0; i < g_r1.player_count; i++) {
-        if (is_connected(g_r1.players[i].account_id)) {
-                count++;
-        }
-    }
-    return count;
-}
-
-/**
- * Count disconnected players
- */
-static int count_disconnected(void) {
-    return g_r1.player_count - count_connected();
-}
-
 //==============================================================================
 // HELPER: Score calculation
 //==============================================================================
@@ -340,512 +227,99 @@ static int calc_score(bool correct, uint32_t time_ms) {
 // HELPER: Get correct answer from question data
 //==============================================================================
 
-static int get_correct_index(int q_idx) {
-    RoundState *round = get_round();
+static int get_correct_index(R1_Context *ctx, int q_idx) {
+    RoundState *round = round_state(&ctx->core);
     if (!round || q_idx < 0 || q_idx >= round->question_count) return -1;
-    
-    MatchQuestion *mq = &round->question_data[q_idx];
-    if (!mq->json_data) return -1;
-    
-    cJSON *root = cJSON_Parse(mq->json_data);
-    if (!root) return -1;
-    
-    // Question data is nested inside "data" field from DB
-    cJSON *data = cJSON_GetObjectItem(root, "data");
-    if (!data) {
-        // Fallback: maybe data is at root level
-        data = root;
-    }
-    
-    int correct = -1;
-    
-    // 1. Check "answer" field (most common in DB)
-    cJSON *ans = cJSON_GetObjectItem(data, "answer");
-    if (ans && cJSON_IsNumber(ans)) {
-        correct = ans->valueint;
-        printf("[Round1] Q%d: answer = %d\n", q_idx, correct);
-    }
-    // 2. Check "correct_index" field (number)
-    else {
-        cJSON *cidx = cJSON_GetObjectItem(data, "correct_index");
-        if (cidx && cJSON_IsNumber(cidx)) {
-            correct = cidx->valueint;
-            printf("[Round1] Q%d: correct_index = %d\n", q_idx, correct);
-        } 
-        // 3. Check "correct_answer" field - can be NUMBER or STRING
-        else {
-            cJSON *cans = cJSON_GetObjectItem(data, "correct_answer");
-            if (cans) {
-                if (cJSON_IsNumber(cans)) {
-                    correct = cans->valueint;
-                    printf("[Round1] Q%d: correct_answer (number) = %d\n", q_idx, correct);
-                } 
-                else if (cJSON_IsString(cans)) {
-                    // correct_answer is a STRING - search in choices
-                    cJSON *choices = cJSON_GetObjectItem(data, "choices");
-                    if (choices && cJSON_IsArray(choices)) {
-                        for (int j = 0; j < cJSON_GetArraySize(choices); j++) {
-                            cJSON *c = cJSON_GetArrayItem(choices, j);
-                            if (c && cJSON_IsString(c) && strcmp(c->valuestring, cans->valuestring) == 0) {
-                                correct = j;
-                                printf("[Round1] Q%d: correct_answer (string match) = %d\n", q_idx, correct);
-                                break;
-    }
-  }
-                    }
-                }
-            }
-        }
-    }
-    
-    cJSON_Delete(root);
-    return correct;
-}
-
-//==============================================================================
-// HELPER: Response/Broadcast
-//==============================================================================
 
-static void send_json(int fd, MessageHeader *req, uint16_t cmd, const char *json) {
-    if (fd <= 0 || !json) return;
-    forward_response(fd, req, cmd, json, (uint32_t)strlen(json));
-}
-
-static void broadcast_json(MessageHeader *req, uint16_t cmd, const char *json) {
-    if (!json) return;
-    for (int i = 0; i < g_r1.player_count; i++) {
-        int fd = get_socket(g_r1.players[i].account_id);
-        if (fd > 0) {
-            forward_response(fd, req, cmd, json, (uint32_t)strlen(json));
-        }
-    }
+    // Decoded once in handle_start_game
+    return round->question_data[q_idx].correct_index;
 }
 
 //==============================================================================
 // HELPER: Build question payload from RoundState.question_data
 //==============================================================================
 
-static char* build_question_json(int q_idx) {
-    RoundState *round = get_round();
+static char* build_question_json(R1_Context *ctx, int q_idx, Arena *arena) {
+    RoundState *round = round_state(&ctx->core);
     if (!round || q_idx < 0 || q_idx >= round->question_count) return NULL;
-    
-    MatchQuestion *mq = &round->question_data[q_idx];
-    if (!mq->json_data) return NULL;
-  
-    cJSON *root = cJSON_Parse(mq->json_data);
-    if (!root) return NULL;
-    
-    // Question data is nested inside "data" field from DB
-    // Structure: {id, type, data: {content, choices, answer, image}}
-    cJSON *data = cJSON_GetObjectItem(root, "data");
-    if (!data) {
-        // Fallback: maybe data is at root level
-        data = root;
-    }
-    
-    cJSON *obj = cJSON_CreateObject();
-    cJSON_AddTrueToObject(obj, "success");  // Frontend checks this
-    cJSON_AddNumberToObject(obj, "question_idx", q_idx);
-    cJSON_AddNumberToObject(obj, "total_questions", round->question_count);
-    cJSON_AddNumberToObject(obj, "time_limit_ms", TIME_PER_QUESTION);
-    
-    // ⭐ Option 3: Send server timestamp for client-side time sync
-    // Client uses this to calculate accurate time_left
-    cJSON_AddNumberToObject(obj, "start_timestamp", (double)g_r1.question_start_time);
-      
-    // Copy from question data - try both "question" and "content"
-    cJSON *text = cJSON_GetObjectItem(data, "question");
-    if (!text) text = cJSON_GetObjectItem(data, "content");
-    if (text && cJSON_IsString(text)) {
-        cJSON_AddStringToObject(obj, "question", text->valuestring);
-    }
-    
-    cJSON *choices = cJSON_GetObjectItem(data, "choices");
-    if (choices && cJSON_IsArray(choices)) {
-        cJSON_AddItemToObject(obj, "choices", cJSON_Duplicate(choices, 1));
-    }
-    
-    cJSON *img = cJSON_GetObjectItem(data, "image");
-    if (!img) img = cJSON_GetObjectItem(data, "product_image");
-    if (img && cJSON_IsString(img)) {
-        cJSON_AddStringToObject(obj, "product_image", img->valuestring);
-    }
-  
-    char *json = cJSON_PrintUnformatted(obj);
-    cJSON_Delete(obj);
-    cJSON_Delete(root);
-  return json;
-}
-
-//==============================================================================
-// ELIMINATION LOGIC
-// Updates MatchPlayerState.eliminated
-// Only runs for MODE_ELIMINATION, skips for MODE_SCORING
-//==============================================================================
 
-typedef struct {
-    int32_t account_id;
-    int32_t score;
-} ScoreEntry;
+    // Per-broadcast fields; question / choices / product_image are pre-rendered
+    // ⭐ Option 3: start_timestamp lets the client compute an accurate time_left
+    char header[192];
+    snprintf(header, sizeof(header),
+             "\"success\":true,\"question_idx\":%d,\"total_questions\":%d,"
+             "\"time_limit_ms\":%d,\"start_timestamp\":%lld",
+             q_idx, round->question_count, TIME_PER_QUESTION,
+             (long long)ctx->question_start_time);
 
-/**
- * Helper: Mark player as eliminated, notify them, and redirect to lobby
- */
-static void eliminate_player(MatchPlayerState *mp, const char *reason) {
-    if (!mp) return;
-    
-    mp->eliminated = 1;
-    mp->eliminated_at_round = g_r1.round_index + 1;
-
-    printf("[Round1] Player %d ELIMINATED at round %d (reason: %s, score=%d)\n", 
-           mp->account_id, g_r1.round_index + 1, reason, mp->score);
-    
-    // =========================================================================
-    // SEND NTF_ELIMINATION to the eliminated player
-    // =========================================================================
-    UserSession *elim_session = session_get_by_account(mp->account_id);
-    int elim_fd = elim_session ? elim_session->socket_fd : -1;
-    
-    if (elim_fd > 0) {
-        cJSON *ntf = cJSON_CreateObject();
-        cJSON_AddNumberToObject(ntf, "player_id", mp->account_id);
-        cJSON_AddStringToObject(ntf, "reason", reason);
-        cJSON_AddNumberToObject(ntf, "round", g_r1.round_index + 1);
-        cJSON_AddNumberToObject(ntf, "final_score", mp->score);
-        cJSON_AddStringToObject(ntf, "message", "You have been eliminated!");
-        
-        char *ntf_json = cJSON_PrintUnformatted(ntf);
-        cJSON_Delete(ntf);
-        
-        if (ntf_json) {
-            MessageHeader hdr = {0};
-            hdr.magic = htons(MAGIC_NUMBER);
-            hdr.version = PROTOCOL_VERSION;
-            hdr.command = htons(NTF_ELIMINATION);
-            hdr.length = htonl((uint32_t)strlen(ntf_json));
-            
-            send(elim_fd, &hdr, sizeof(hdr), 0);
-            send(elim_fd, ntf_json, strlen(ntf_json), 0);
-            printf("[Round1] Sent NTF_ELIMINATION to player %d\n", mp->account_id);
-            free(ntf_json);
-    }
-        
-        // Change session state back to LOBBY so player can join new games
-        session_mark_lobby(elim_session);
-        printf("[Round1] Changed player %d session state to LOBBY\n", mp->account_id);
-  }
-
-    // =========================================================================
-    // Save elimination event to database
-    // =========================================================================
-    MatchState *match = get_match();
-    if (mp->account_id > 0 && match && match->db_match_id > 0) {
-        // Use db_match_event_insert from match_repo
-        // Note: player_id in match_events refers to accounts.id, not match_players.id
-        db_error_t event_err = db_match_event_insert(
-            match->db_match_id,
-            mp->account_id,  // Use account_id, not match_player_id
-            "ELIMINATED",
-            g_r1.round_index + 1,
-            0
-        );
-        if (event_err == DB_SUCCESS) {
-            printf("[Round1] Saved elimination event to DB\n");
-        } else {
-            printf("[Round1] Failed to save elimination event: err=%d\n", event_err);
-        }
-        
-        // Update player record
-        cJSON *player_payload = cJSON_CreateObject();
-        cJSON_AddNumberToObject(player_payload, "score", mp->score);
-        cJSON_AddBoolToObject(player_payload, "eliminated", true);
-        
-        char filter[64];
-        snprintf(filter, sizeof(filter), "id=eq.%d", mp->match_player_id);
-        
-        cJSON *player_result = NULL;
-        db_patch("match_players", filter, player_payload, &player_result);
-        cJSON_Delete(player_payload);
-        if (player_result) cJSON_Delete(player_result);
-    }
-}
-
-// NOTE: forfeited field is reserved for player-initiated forfeit (FORFEIT button)
-// Disconnect handling uses eliminated for BOTH modes
-
-// Returns true if bonus round was triggered (caller should NOT advance to next round)
-static bool perform_elimination(void) {
-    MatchState *match = get_match();
-    if (!match) return false;
-    
-    //==========================================================================
-    // MODE_SCORING: Disconnected players → 0 điểm round này, KHÔNG eliminated
-    // - Block đến cuối ROUND (không phải cuối game)
-    // - Không có event ELIMINATED
-    // - Round sau có thể reconnect và chơi tiếp
-    // NOTE: Logic block trong round được xử lý bởi is_connected() check
-    //==========================================================================
-    if (match->mode == MODE_SCORING) {
-        printf("[Round1] Scoring mode - disconnected players get 0 points this round\n");
-        
-        // Chỉ log, không set eliminated
-        // Disconnected players đã nhận 0 điểm vì timeout tự động
-        // Họ có thể reconnect và chơi round tiếp theo
-        for (int i = 0; i < g_r1.player_count; i++) {
-            int32_t acc_id = g_r1.players[i].account_id;
-            if (!is_connected(acc_id)) {
-                printf("[Round1] Player %d disconnected - 0 points for this round (can rejoin next round)\n", acc_id);
-            }
-        }
-        
-        printf("[Round1] Scoring mode - no elimination (ranking only)\n");
-        return false;
-    }
-    
-    //==========================================================================
-    // MODE_ELIMINATION: Disconnected players → bị loại NGAY LẬP TỨC
-    //==========================================================================
-    printf("[Round1] Elimination mode - processing disconnected players...\n");
-    
-    // STEP 1: Loại tất cả disconnected players trước
-    for (int i = 0; i < g_r1.player_count; i++) {
-        int32_t acc_id = g_r1.players[i].account_id;
-        MatchPlayerState *mp = get_match_player(acc_id);
-        
-        // Check UserSession để xác định connected hay không
-        if (mp && !mp->eliminated && !is_connected(acc_id)) {
-            // Disconnect trong elimination mode → bị loại luôn
-            eliminate_player(mp, "DISCONNECT");
-        }
-    }
-    
-    // STEP 2: Đếm connected players còn lại chưa bị eliminated
-    ScoreEntry scores[MAX_MATCH_PLAYERS];
-    int count = 0;
-    
-    for (int i = 0; i < g_r1.player_count; i++) {
-        MatchPlayerState *mp = get_match_player(g_r1.players[i].account_id);
-        // Chỉ tính players: connected AND chưa eliminated
-        if (mp && !mp->eliminated && is_connected(mp->account_id)) {
-            scores[count].account_id = mp->account_id;
-            scores[count].score = mp->score;
-            count++;
-        }
-    }
-    
-    // Nếu còn < 2 connected players → không elimination thêm
-    if (count < 2) {
-        printf("[Round1] Only %d connected players remaining, no further elimination\n", count);
-        return false;
-    }
-    
-    // STEP 3: Sort ascending by score
-    for (int i = 0; i < count - 1; i++) {
-        for (int j = 0; j < count - i - 1; j++) {
-            if (scores[j].score > scores[j+1].score) {
-                ScoreEntry tmp = scores[j];
-                scores[j] = scores[j+1];
-                scores[j+1] = tmp;
-            }
-        }
-    }
-    
-    // STEP 4: Check ties at lowest
-    int lowest = scores[0].score;
-    int tie_count = 0;
-    for (int i = 0; i < count; i++) {
-        if (scores[i].score == lowest) tie_count++;
-    }
-    
-    // Rule: >=2 tied at lowest → bonus round (no elimination)
-    if (tie_count >= 2) {
-        printf("[Round1] %d players tied at lowest (%d), triggering bonus round\n", tie_count, lowest);
-        
-        // Collect tied players
-        int32_t tied_players[MAX_MATCH_PLAYERS];
-        int tied_count = 0;
-        for (int i = 0; i < count && tied_count < MAX_MATCH_PLAYERS; i++) {
-            if (scores[i].score == lowest) {
-                tied_players[tied_count++] = scores[i].account_id;
-            }
-        }
-        
-        // Trigger bonus round
-        if (match && tied_count >= 2) {
-            check_and_trigger_bonus(match->runtime_match_id, 1);
-            return true;  // Bonus triggered - don't advance to next round
-        }
-        return false;
-    }
-
-    // STEP 5: Eliminate lowest scorer
-    MatchPlayerState *elim_player = get_match_player(scores[0].account_id);
-    if (elim_player) {
-        eliminate_player(elim_player, "LOWEST_SCORE");
-    }
-    
-    return false;  // Normal elimination, continue to next round
+    return match_question_render(&round->question_data[q_idx], header, arena);
 }
 
 //==============================================================================
-// HELPER: Build round end result
-// Format matches Frontend expectations:
-// - players[] instead of rankings[]
-// - id instead of account_id  
-// - name field included
-// - finished_count, player_count for progress
+// ROUND END
+// Elimination, ranking and the ALL_FINISHED frame come from round_engine;
+// round 1 only adds need_bonus_round to the frame
 //==============================================================================
 
-static char* build_round_end_json(void) {
-    MatchState *match = get_match();
-    if (!match) return NULL;
-    
-    cJSON *obj = cJSON_CreateObject();
-    cJSON_AddTrueToObject(obj, "success");
-    cJSON_AddNumberToObject(obj, "match_id", g_r1.match_id);
-    cJSON_AddNumberToObject(obj, "round", 1);
-    
-    int connected = count_connected();
-    int disconnected = count_disconnected();
-    
-    // Frontend expects these names
-    cJSON_AddNumberToObject(obj, "connected_count", connected);
-    cJSON_AddNumberToObject(obj, "disconnected_count", disconnected);
-    cJSON_AddNumberToObject(obj, "finished_count", g_r1.player_count);
-    cJSON_AddNumberToObject(obj, "player_count", g_r1.player_count);
-    
-    bool can_continue = (disconnected < 2);
-    cJSON_AddBoolToObject(obj, "can_continue", can_continue);
-    
-    if (disconnected >= 2) {
-        cJSON_AddStringToObject(obj, "status_message", "Game ended - too many disconnections");
-    } else if (disconnected == 1) {
-        cJSON_AddStringToObject(obj, "status_message", "1 disconnected - no elimination");
-      } else {
-        cJSON_AddStringToObject(obj, "status_message", "Round completed");
-    }
-    
-    // Check for bonus round
-    ScoreEntry scores[MAX_MATCH_PLAYERS];
-    int count = 0;
-    for (int i = 0; i < g_r1.player_count; i++) {
-        MatchPlayerState *mp = get_match_player(g_r1.players[i].account_id);
-        if (mp) {
-            scores[count].account_id = mp->account_id;
-            scores[count].score = mp->score;
-            count++;
-      }
-    }
-    
-    // Sort ascending to find lowest
-    for (int i = 0; i < count - 1; i++) {
-        for (int j = 0; j < count - i - 1; j++) {
-            if (scores[j].score > scores[j+1].score) {
-                ScoreEntry tmp = scores[j];
-                scores[j] = scores[j+1];
-                scores[j+1] = tmp;
-            }
-        }
-    }
-    
-    bool need_bonus = false;
-    if (can_continue && count >= 2 && disconnected == 0) {
-        int lowest = scores[0].score;
-        int tie = 0;
-        for (int i = 0; i < count; i++) {
-            if (scores[i].score == lowest) tie++;
-        }
-        if (tie >= 2) need_bonus = true;
-    }
+// Tie at the lowest score with everybody still connected
+static void add_end_fields(RoundCore *core, cJSON *obj) {
+    RoundRank ranks[MAX_MATCH_PLAYERS];
+    int count = round_rank(core, ROUND_RANK_ALL, true, ranks);
+
+    bool need_bonus = round_disconnected_count(core) == 0 && count >= 2 &&
+                      ranks[1].score == ranks[0].score;
     cJSON_AddBoolToObject(obj, "need_bonus_round", need_bonus);
-    
-    // Add next round info (match was already retrieved at start of function)
-    int next_round = match->current_round_idx + 1; // 1-based for frontend
-    if (next_round > match->round_count) {
-        next_round = 0; // No more rounds
-    }
-    cJSON_AddNumberToObject(obj, "next_round", next_round);
-    cJSON_AddNumberToObject(obj, "current_round", 1);
-    
-    // Sort descending for display (highest first)
-    for (int i = 0; i < count - 1; i++) {
-        for (int j = 0; j < count - i - 1; j++) {
-            if (scores[j].score < scores[j+1].score) {
-                ScoreEntry tmp = scores[j];
-                scores[j] = scores[j+1];
-                scores[j+1] = tmp;
-            }
-        }
-    }
-    
-    // Build players array (Frontend expects "players" not "rankings")
-    cJSON *players = cJSON_CreateArray();
-    for (int i = 0; i < count; i++) {
-        MatchPlayerState *mp = get_match_player(scores[i].account_id);
-        if (!mp) continue;
-        
-        cJSON *p = cJSON_CreateObject();
-        // Frontend expects "id" not "account_id"
-        cJSON_AddNumberToObject(p, "id", mp->account_id);
-        cJSON_AddNumberToObject(p, "rank", i + 1);
-        cJSON_AddNumberToObject(p, "score", mp->score);
-        cJSON_AddBoolToObject(p, "connected", is_connected(mp->account_id));
-        cJSON_AddBoolToObject(p, "eliminated", mp->eliminated != 0);
-        
-        // Add player name (format: "Player{id}")
-        // Add player name
-        cJSON_AddStringToObject(p, "name", mp->name);
-        
-        cJSON_AddItemToArray(players, p);
-    }
-    cJSON_AddItemToObject(obj, "players", players);
-    
-    // Also add rankings for backwards compatibility
-    cJSON_AddItemToObject(obj, "rankings", cJSON_Duplicate(players, 1));
-    
-    char *json = cJSON_PrintUnformatted(obj);
-    cJSON_Delete(obj);
-    return json;
 }
 
+static const RoundKind k_round1 = {
+    .number           = 1,
+    .tag              = "[Round1]",
+    .all_finished_cmd = OP_S2C_ROUND1_ALL_FINISHED,
+    .final            = false,
+    .end_fields       = add_end_fields,
+};
+
 //==============================================================================
 // HELPER: Send current question to all, move round to next question
 //==============================================================================
 
-static void broadcast_current_question(MessageHeader *req) {
-    RoundState *round = get_round();
+static void broadcast_current_question(R1_Context *ctx, MessageHeader *req) {
+    RoundState *round = round_state(&ctx->core);
     if (!round) return;
     
     int q_idx = round->current_question_idx;
     printf("[Round1] Broadcasting question %d/%d\n", q_idx + 1, round->question_count);
     
     // Reset answered flags for new question
-    reset_answered_flags();
+    reset_answered_flags(ctx);
     
     // Update QuestionState status
     if (q_idx < round->question_count) {
         round->questions[q_idx].status = QUESTION_ACTIVE;
     }
     
-    char *json = build_question_json(q_idx);
+    // ⭐ Start the question clock and timeout timer; the frame carries the start
+    start_question_timer(ctx, q_idx);
+
+    Arena *arena = round_arena(&ctx->core);
+    ArenaMark mark = arena_mark(arena);
+    char *json = build_question_json(ctx, q_idx, arena);
     if (json) {
         printf("[Round1] Question data: %s\n", json);
-        broadcast_json(req, OP_S2C_ROUND1_QUESTION, json);
-        free(json);
+        round_broadcast(&ctx->core, req, OP_S2C_ROUND1_QUESTION, json);
+        arena_rewind(arena, mark);
         
-        // ⭐ Start timeout timer for this question
-        start_question_timer(q_idx);
+        match_snapshot_begin(ctx->core.match, q_idx, TIME_PER_QUESTION);
     } else {
         printf("[Round1] ERROR: Failed to build question JSON for idx=%d\n", q_idx);
     }
 }
 
-// Note: non-static so timer thread can call it via extern
-void advance_to_next_question(MessageHeader *req) {
+static void advance_to_next_question(R1_Context *ctx, MessageHeader *req) {
     // ⭐ Stop current timer first
-    stop_question_timer();
+    stop_question_timer(ctx);
     
-    RoundState *round = get_round();
+    RoundState *round = round_state(&ctx->core);
     if (!round) return;
     
     // Mark current question as ended
@@ -858,48 +332,12 @@ void advance_to_next_question(MessageHeader *req) {
     round->current_question_idx++;
     
     if (round->current_question_idx >= round->question_count) {
-        // Round finished
+        // Round finished: elimination / bonus / next round (round_engine)
         printf("[Round1] All questions completed\n");
-        round->status = ROUND_ENDED;
-        round->ended_at = time(NULL);
-        g_r1.is_active = false;
-        
-        // Perform elimination - UPDATE MatchPlayerState.eliminated
-        // Returns true if bonus round was triggered
-        bool bonus_triggered = perform_elimination();
-        
-        if (bonus_triggered) {
-            printf("[Round1] Bonus round active - waiting for bonus to complete\n");
-            // Don't advance to next round or broadcast ALL_FINISHED
-            // Bonus handler will handle the transition
-            return;
-        }
-
-        // Advance to next round in MatchState
-        MatchState *match = get_match();
-        if (match && match->current_round_idx < match->round_count - 1) {
-            match->current_round_idx++;
-            printf("[Round1] Advanced to round %d\n", match->current_round_idx + 1);
-            
-            // Initialize next round state
-            RoundState *next_round = &match->rounds[match->current_round_idx];
-            next_round->status = ROUND_PENDING;
-            next_round->current_question_idx = 0;
-        }
-        
-        // Broadcast results with next_round info
-        char *end_json = build_round_end_json();
-        if (end_json) {
-            printf("[Round1] ALL_FINISHED JSON: %s\n", end_json);
-            broadcast_json(req, OP_S2C_ROUND1_ALL_FINISHED, end_json);
-            printf("[Round1] ALL_FINISHED broadcast complete\n");
-            free(end_json);
-        } else {
-            printf("[Round1] ERROR: build_round_end_json returned NULL!\n");
-        }
+        round_finish(&ctx->core, req);
     } else {
         // Send next question
-        broadcast_current_question(req);
+        broadcast_current_question(ctx, req);
     }
 }
 
@@ -909,7 +347,7 @@ void advance_to_next_question(MessageHeader *req) {
 
 static void handle_player_ready(int fd, MessageHeader *req, const char *payload) {
   if (req->length < 8) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
     return;
   }
 
@@ -928,7 +366,7 @@ static void handle_player_ready(int fd, MessageHeader *req, const char *payload)
     // Verify match exists
     MatchState *match = match_get_by_id(match_id);
     if (!match) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Match not found\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Match not found\"}");
         return;
   }
 
@@ -942,32 +380,35 @@ static void handle_player_ready(int fd, MessageHeader *req, const char *payload)
   }
 
     if (!mp) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Not in match\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Not in match\"}");
     return;
   }
 
     // Block eliminated players (includes disconnect in both modes)
     if (mp->eliminated) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Player eliminated\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Player eliminated\"}");
         return;
     }
     
-    // Initialize context if new match
-    if (match_id != g_r1.match_id) {
-        reset_context();
-        g_r1.match_id = match_id;
-        g_r1.round_index = match->current_round_idx;
+    // Context of this match (created on the first ready)
+    R1_Context *ctx = match_context_get(match, MATCH_CTX_ROUND1, sizeof(R1_Context), NULL);
+    if (!ctx) {
+        round_send_json(fd, req, ERR_SERVER_ERROR, "{\"success\":false,\"error\":\"Server error\"}");
+        return;
+    }
+    if (!ctx->core.match) {
+        round_core_bind(&ctx->core, &k_round1, match, match->current_round_idx);
     }
     
     // Add to local tracking
-    R1_PlayerAnswer *pa = add_player(account_id);
+    R1_PlayerAnswer *pa = add_player(ctx, account_id);
     if (!pa) {
-        send_json(fd, req, ERR_ROOM_FULL, "{\"success\":false,\"error\":\"Round full\"}");
+        round_send_json(fd, req, ERR_ROOM_FULL, "{\"success\":false,\"error\":\"Round full\"}");
         return;
     }
     
     // Check for reconnection during active round
-    RoundState *round = get_round();
+    RoundState *round = round_state(&ctx->core);
     if (round && round->status == ROUND_PLAYING) {
         // Send current question
         cJSON *obj = cJSON_CreateObject();
@@ -978,12 +419,12 @@ static void handle_player_ready(int fd, MessageHeader *req, const char *payload)
         
         // Add full player list for leaderboard
         cJSON *players = cJSON_CreateArray();
-        for (int i = 0; i < g_r1.player_count; i++) {
+        for (int i = 0; i < ctx->core.seat_count; i++) {
             cJSON *p = cJSON_CreateObject();
-            cJSON_AddNumberToObject(p, "account_id", g_r1.players[i].account_id);
-            cJSON_AddBoolToObject(p, "ready", g_r1.players[i].ready); // or connected status
+            cJSON_AddNumberToObject(p, "account_id", ctx->players[i].account_id);
+            cJSON_AddBoolToObject(p, "ready", ctx->players[i].ready); // or connected status
             
-            MatchPlayerState *mp_state = get_match_player(g_r1.players[i].account_id);
+            MatchPlayerState *mp_state = round_player(&ctx->core, ctx->players[i].account_id);
             if (mp_state) {
                 cJSON_AddStringToObject(p, "name", mp_state->name);
                 cJSON_AddNumberToObject(p, "score", mp_state->score);
@@ -992,40 +433,42 @@ static void handle_player_ready(int fd, MessageHeader *req, const char *payload)
         }
         cJSON_AddItemToObject(obj, "players", players);
 
-        char *json = cJSON_PrintUnformatted(obj);
+        Arena *arena = round_arena(&ctx->core);
+        ArenaMark mark = arena_mark(arena);
+        char *json = json_print_arena(obj, arena);
         cJSON_Delete(obj);
-        send_json(fd, req, OP_S2C_ROUND1_READY_STATUS, json);
-        free(json);
+        round_send_json(fd, req, OP_S2C_ROUND1_READY_STATUS, json);
       
         // Also send current question
-        char *q_json = build_question_json(round->current_question_idx);
+        char *q_json = build_question_json(ctx, round->current_question_idx, arena);
         if (q_json) {
-            send_json(fd, req, OP_S2C_ROUND1_QUESTION, q_json);
-            free(q_json);
+            round_send_json(fd, req, OP_S2C_ROUND1_QUESTION, q_json);
         }
+        arena_rewind(arena, mark);
         return;
     }
     
     // Mark ready
     if (!pa->ready) {
         pa->ready = true;
-        g_r1.ready_count++;
+        ctx->ready_count++;
+        match_snapshot_ready(match, account_id);
     }
     
     // Broadcast ready status
     cJSON *status = cJSON_CreateObject();
     cJSON_AddTrueToObject(status, "success");
-    cJSON_AddNumberToObject(status, "ready_count", g_r1.ready_count);
-    cJSON_AddNumberToObject(status, "player_count", g_r1.player_count);
+    cJSON_AddNumberToObject(status, "ready_count", ctx->ready_count);
+    cJSON_AddNumberToObject(status, "player_count", ctx->core.seat_count);
     cJSON_AddNumberToObject(status, "required_players", match->player_count);
     
     cJSON *players = cJSON_CreateArray();
-    for (int i = 0; i < g_r1.player_count; i++) {
+    for (int i = 0; i < ctx->core.seat_count; i++) {
         cJSON *p = cJSON_CreateObject();
-        cJSON_AddNumberToObject(p, "account_id", g_r1.players[i].account_id);
-        cJSON_AddBoolToObject(p, "ready", g_r1.players[i].ready);
+        cJSON_AddNumberToObject(p, "account_id", ctx->players[i].account_id);
+        cJSON_AddBoolToObject(p, "ready", ctx->players[i].ready);
         
-        MatchPlayerState *mp_state = get_match_player(g_r1.players[i].account_id);
+        MatchPlayerState *mp_state = round_player(&ctx->core, ctx->players[i].account_id);
         if (mp_state) {
             cJSON_AddStringToObject(p, "name", mp_state->name);
         }
@@ -1034,10 +477,12 @@ static void handle_player_ready(int fd, MessageHeader *req, const char *payload)
     }
     cJSON_AddItemToObject(status, "players", players);
     
-    char *json = cJSON_PrintUnformatted(status);
+    Arena *arena = round_arena(&ctx->core);
+    ArenaMark mark = arena_mark(arena);
+    char *json = json_print_arena(status, arena);
     cJSON_Delete(status);
-    broadcast_json(req, OP_S2C_ROUND1_READY_STATUS, json);
-    free(json);
+    round_broadcast(&ctx->core, req, OP_S2C_ROUND1_READY_STATUS, json);
+    arena_rewind(arena, mark);
 
     // All ready → start round
 //     // ⭐ HARDCODE FOR TESTING: Start with 1+ player ready
@@ -1052,17 +497,17 @@ static void handle_player_ready(int fd, MessageHeader *req, const char *payload)
     }
     
     printf("[Round1] Check start: ready=%d, expected=%d, match_players=%d, round_status=%d\n",
-           g_r1.ready_count, expected, match->player_count, round ? round->status : -1);
+           ctx->ready_count, expected, match->player_count, round ? round->status : -1);
     
     // Start when all non-eliminated players are ready
-    if (g_r1.ready_count >= expected && expected > 0 && round && round->status == ROUND_PENDING) {
+    if (ctx->ready_count >= expected && expected > 0 && round && round->status == ROUND_PENDING) {
         printf("[Round1] All ready, starting round\n");
         
         // Update RoundState
         round->status = ROUND_PLAYING;
         round->started_at = time(NULL);
         round->current_question_idx = 0;
-        g_r1.is_active = true;
+        ctx->core.is_active = true;
     
         // Build start message
         cJSON *start = cJSON_CreateObject();
@@ -1070,15 +515,16 @@ static void handle_player_ready(int fd, MessageHeader *req, const char *payload)
         cJSON_AddNumberToObject(start, "match_id", match_id);
         cJSON_AddNumberToObject(start, "total_questions", round->question_count);
         cJSON_AddNumberToObject(start, "time_per_question_ms", TIME_PER_QUESTION);
-        cJSON_AddNumberToObject(start, "player_count", g_r1.player_count);
+        cJSON_AddNumberToObject(start, "player_count", ctx->core.seat_count);
         
-        char *start_json = cJSON_PrintUnformatted(start);
+        mark = arena_mark(arena);
+        char *start_json = json_print_arena(start, arena);
         cJSON_Delete(start);
-        broadcast_json(req, OP_S2C_ROUND1_ALL_READY, start_json);
-        free(start_json);
+        round_broadcast(&ctx->core, req, OP_S2C_ROUND1_ALL_READY, start_json);
+        arena_rewind(arena, mark);
         
         // Send first question
-        broadcast_current_question(req);
+        broadcast_current_question(ctx, req);
   }
 }
 
@@ -1088,7 +534,7 @@ static void handle_player_ready(int fd, MessageHeader *req, const char *payload)
 
 static void handle_get_question(int fd, MessageHeader *req, const char *payload) {
     if (req->length < 8) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
     return;
   }
 
@@ -1097,14 +543,15 @@ static void handle_get_question(int fd, MessageHeader *req, const char *payload)
     memcpy(&q_idx, payload + 4, 4);
     match_id = ntohl(match_id);
     
-    if (match_id != g_r1.match_id) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid match\"}");
+    R1_Context *ctx = find_context(match_id);
+    if (!ctx) {
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid match\"}");
         return;
   }
   
-    RoundState *round = get_round();
+    RoundState *round = round_state(&ctx->core);
     if (!round || round->status != ROUND_PLAYING) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Round not active\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Round not active\"}");
     return;
   }
 
@@ -1112,22 +559,24 @@ static void handle_get_question(int fd, MessageHeader *req, const char *payload)
     // Check if player is eliminated (includes disconnect in both modes)
     UserSession *session = session_get_by_socket(fd);
     if (session) {
-        MatchPlayerState *mp = get_match_player(session->account_id);
+        MatchPlayerState *mp = round_player(&ctx->core, session->account_id);
         if (mp && mp->eliminated) {
-            send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Player eliminated\"}");
+            round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Player eliminated\"}");
     return;
   }
     }
     
     // Send current question (use RoundState.current_question_idx)
-    char *json = build_question_json(round->current_question_idx);
+    Arena *arena = round_arena(&ctx->core);
+    ArenaMark mark = arena_mark(arena);
+    char *json = build_question_json(ctx, round->current_question_idx, arena);
     if (!json) {
-        send_json(fd, req, ERR_SERVER_ERROR, "{\"success\":false,\"error\":\"Question not found\"}");
+        round_send_json(fd, req, ERR_SERVER_ERROR, "{\"success\":false,\"error\":\"Question not found\"}");
     return;
   }
 
-    send_json(fd, req, OP_S2C_ROUND1_QUESTION, json);
-    free(json);
+    round_send_json(fd, req, OP_S2C_ROUND1_QUESTION, json);
+    arena_rewind(arena, mark);
 }
 
 //==============================================================================
@@ -1141,7 +590,7 @@ static void handle_get_question(int fd, MessageHeader *req, const char *payload)
 
 static void handle_submit_answer(int fd, MessageHeader *req, const char *payload) {
   if (req->length < 13) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
     return;
   }
 
@@ -1157,29 +606,34 @@ static void handle_submit_answer(int fd, MessageHeader *req, const char *payload
     q_idx = ntohl(q_idx);
     time_ms = ntohl(time_ms);
     
-    printf("[Round1] Answer: q=%u choice=%u time=%ums\n", q_idx, choice, time_ms);
     
-    if (match_id != g_r1.match_id) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid match\"}");
+    R1_Context *ctx = find_context(match_id);
+    if (!ctx) {
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid match\"}");
         return;
     }
     
-    RoundState *round = get_round();
+    RoundState *round = round_state(&ctx->core);
     if (!round || round->status != ROUND_PLAYING) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Round not active\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Round not active\"}");
         return;
     }
     
-    // ⭐ Option 1: Server-side time validation (anti-cheat)
-    // Calculate actual elapsed time from server's perspective
-    time_t current_time = time(NULL);
-    uint32_t actual_time_ms = (uint32_t)((current_time - g_r1.question_start_time) * 1000);
+    // ⭐ Option 1: Answer time is measured by the server (anti-cheat): from the
+    // question broadcast to the answer's arrival, less half the connection's
+    // best recent RTT for the trip back. The client's time_ms is only logged.
+    int rtt_credit_ms = latency_one_way_ms(fd);
+    int64_t elapsed_ms = match_exec_received_ms() - ctx->question_start_ms - rtt_credit_ms;
+    uint32_t actual_time_ms = elapsed_ms > 0 ? (uint32_t)elapsed_ms : 0;
+
+    printf("[Round1] Answer: q=%u choice=%u time=%ums (client %ums, rtt credit %dms)\n",
+           q_idx, choice, actual_time_ms, time_ms, rtt_credit_ms);
     
     // Check if answer arrived too late (beyond time limit + buffer)
     if (actual_time_ms > TIME_PER_QUESTION + NETWORK_BUFFER_MS) {
         printf("[Round1] Answer too late: actual=%ums limit=%d buffer=%d\n",
                actual_time_ms, TIME_PER_QUESTION, NETWORK_BUFFER_MS);
-        send_json(fd, req, ERR_BAD_REQUEST, 
+        round_send_json(fd, req, ERR_BAD_REQUEST, 
                   "{\"success\":false,\"error\":\"Answer received too late\"}");
         return;
     }
@@ -1187,33 +641,33 @@ static void handle_submit_answer(int fd, MessageHeader *req, const char *payload
     // Get player session
     UserSession *session = session_get_by_socket(fd);
     if (!session) {
-        send_json(fd, req, ERR_NOT_LOGGED_IN, "{\"success\":false,\"error\":\"Not logged in\"}");
+        round_send_json(fd, req, ERR_NOT_LOGGED_IN, "{\"success\":false,\"error\":\"Not logged in\"}");
         return;
     }
     
     // Get MatchPlayerState
-    MatchPlayerState *mp = get_match_player(session->account_id);
+    MatchPlayerState *mp = round_player(&ctx->core, session->account_id);
     if (!mp) {
-        send_json(fd, req, ERR_SERVER_ERROR, "{\"success\":false,\"error\":\"Player not in match\"}");
+        round_send_json(fd, req, ERR_SERVER_ERROR, "{\"success\":false,\"error\":\"Player not in match\"}");
         return;
   }
 
     // Block eliminated players (includes disconnect in both modes)
     if (mp->eliminated) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Player eliminated\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Player eliminated\"}");
         return;
     }
     
     // Get local tracking
-    R1_PlayerAnswer *pa = find_player(session->account_id);
+    R1_PlayerAnswer *pa = find_player(ctx, session->account_id);
     if (!pa) {
-        send_json(fd, req, ERR_SERVER_ERROR, "{\"success\":false,\"error\":\"Player not in round\"}");
+        round_send_json(fd, req, ERR_SERVER_ERROR, "{\"success\":false,\"error\":\"Player not in round\"}");
         return;
     }
     
     // Verify answering current question (use RoundState.current_question_idx)
     if ((int)q_idx != round->current_question_idx) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Wrong question\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Wrong question\"}");
         return;
     }
     
@@ -1226,22 +680,23 @@ static void handle_submit_answer(int fd, MessageHeader *req, const char *payload
             // The timeout already marked player as answered, so just acknowledge
             printf("[Round1] Answer arrived after timeout but within buffer - race condition\n");
         }
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Already answered\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Already answered\"}");
         return;
     }
     
     // Mark as answered (local tracking)
     pa->answered_current = true;
+    match_snapshot_answer(ctx->core.match, pa->account_id, MATCH_ANSWER_DONE, choice, 0);
     
     // ⭐ Option 1: Use server-calculated time for scoring (anti-cheat)
     // Clamp to TIME_PER_QUESTION if slightly over due to network latency
-    uint32_t scoring_time_ms = time_ms;
+    uint32_t scoring_time_ms = actual_time_ms;
     if (actual_time_ms > TIME_PER_QUESTION) {
         scoring_time_ms = TIME_PER_QUESTION;  // Cap at max time
     }
     
     // Calculate score using correct_index from question data
-    int correct_idx = get_correct_index((int)q_idx);
+    int correct_idx = get_correct_index(ctx, (int)q_idx);
     bool correct = (choice <= 3) && ((int)choice == correct_idx);
     int delta = calc_score(correct, scoring_time_ms);
     
@@ -1260,31 +715,28 @@ static void handle_submit_answer(int fd, MessageHeader *req, const char *payload
     printf("[Round1] Player %d: correct=%d delta=%d total=%d\n",
            mp->account_id, correct, delta, mp->score);
     
-    // ⭐ SAVE ANSWER TO DATABASE using db_match_answer_insert
+    // ⭐ SAVE ANSWER TO DATABASE (write-behind queue)
     if (mp->match_player_id > 0 && round->questions[q_idx].question_id > 0) {
         // Build answer JSON string
         cJSON *ans_obj = cJSON_CreateObject();
         cJSON_AddNumberToObject(ans_obj, "answer", choice);
         cJSON_AddBoolToObject(ans_obj, "is_correct", correct);
-        cJSON_AddNumberToObject(ans_obj, "time_ms", time_ms);
+        cJSON_AddNumberToObject(ans_obj, "time_ms", actual_time_ms);
         char *ans_json = cJSON_PrintUnformatted(ans_obj);
         cJSON_Delete(ans_obj);
 
-        // Use db_match_answer_insert from match_repo
-        db_error_t db_err = db_match_answer_insert(
+        // Queued for write-behind; the reply below does not wait on the DB
+        MatchState *match = ctx->core.match;
+        match_wq_answer(
+            match ? match->db_match_id : 0,
             round->questions[q_idx].question_id,
             mp->match_player_id,
             ans_json,
             delta,
             1  // action_idx = 1
         );
-        
-        if (db_err == DB_SUCCESS) {
-            printf("[Round1] Saved answer to DB: q=%d p=%d delta=%d\n",
-                   round->questions[q_idx].question_id, mp->match_player_id, delta);
-        } else {
-            printf("[Round1] Failed to save answer: %d\n", db_err);
-        }
+        printf("[Round1] Queued answer for DB: q=%d p=%d delta=%d\n",
+               round->questions[q_idx].question_id, mp->match_player_id, delta);
         
         if (ans_json) free(ans_json);
     }
@@ -1298,25 +750,28 @@ static void handle_submit_answer(int fd, MessageHeader *req, const char *payload
     cJSON_AddNumberToObject(result, "score_delta", delta);     // Also include score_delta for new clients
     cJSON_AddNumberToObject(result, "current_score", mp->score);
     cJSON_AddNumberToObject(result, "correct_index", correct_idx);
+    cJSON_AddNumberToObject(result, "time_ms", scoring_time_ms);   // Server-measured, as scored
     
-    int answered = count_answered();
-    int connected = count_connected();
+    int answered = count_answered(ctx);
+    int connected = round_connected_count(&ctx->core);
     cJSON_AddNumberToObject(result, "answered_count", answered);
     cJSON_AddNumberToObject(result, "player_count", connected);
     
     bool all_answered = (answered >= connected);
     cJSON_AddBoolToObject(result, "all_answered", all_answered);
         
-    char *json = cJSON_PrintUnformatted(result);
+    Arena *arena = round_arena(&ctx->core);
+    ArenaMark mark = arena_mark(arena);
+    char *json = json_print_arena(result, arena);
     cJSON_Delete(result);
-    printf("[Round1] Result JSON: %s\n", json);
-    send_json(fd, req, OP_S2C_ROUND1_RESULT, json);
-    free(json);
+    printf("[Round1] Result JSON: %s\n", json ? json : "(null)");
+    round_send_json(fd, req, OP_S2C_ROUND1_RESULT, json);
+    arena_rewind(arena, mark);
         
     // If all answered, advance to next question
     if (all_answered) {
         printf("[Round1] All %d players answered question %d\n", connected, q_idx);
-        advance_to_next_question(req);
+        advance_to_next_question(ctx, req);
     }
 }
 
@@ -1328,7 +783,9 @@ static void handle_end_round(int fd, MessageHeader *req, const char *payload) {
     (void)payload;
     
     UserSession *session = session_get_by_socket(fd);
-    MatchPlayerState *mp = session ? get_match_player(session->account_id) : NULL;
+    MatchState *match = session ? match_find_by_player(session->account_id) : NULL;
+    R1_Context *ctx = match ? find_context(match->runtime_match_id) : NULL;
+    MatchPlayerState *mp = ctx ? round_player(&ctx->core, session->account_id) : NULL;
     
     // Send waiting status
     cJSON *wait = cJSON_CreateObject();
@@ -1338,7 +795,7 @@ static void handle_end_round(int fd, MessageHeader *req, const char *payload) {
     
     char *json = cJSON_PrintUnformatted(wait);
     cJSON_Delete(wait);
-    send_json(fd, req, OP_S2C_ROUND1_WAITING, json);
+    round_send_json(fd, req, OP_S2C_ROUND1_WAITING, json);
     free(json);
 }
 
@@ -1348,7 +805,7 @@ static void handle_end_round(int fd, MessageHeader *req, const char *payload) {
 
 static void handle_legacy_ready(int fd, MessageHeader *req, const char *payload) {
     if (req->length < 8) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
     return;
   }
 
@@ -1360,20 +817,24 @@ static void handle_legacy_ready(int fd, MessageHeader *req, const char *payload)
   
     MatchState *match = match_get_by_id(match_id);
     if (!match) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Match not found\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Match not found\"}");
         return;
     }
     
     RoundState *round = (match->round_count > 0) ? &match->rounds[0] : NULL;
     if (!round || round->question_count == 0) {
-        send_json(fd, req, ERR_SERVER_ERROR, "{\"success\":false,\"error\":\"No questions\"}");
+        round_send_json(fd, req, ERR_SERVER_ERROR, "{\"success\":false,\"error\":\"No questions\"}");
         return;
     }
     
-    reset_context();
-    g_r1.match_id = match_id;
-    g_r1.round_index = 0;
-    g_r1.is_active = true;
+    R1_Context *ctx = match_context_get(match, MATCH_CTX_ROUND1, sizeof(R1_Context), NULL);
+    if (!ctx) {
+        round_send_json(fd, req, ERR_SERVER_ERROR, "{\"success\":false,\"error\":\"Server error\"}");
+        return;
+    }
+    reset_context(ctx);
+    round_core_bind(&ctx->core, &k_round1, match, 0);
+    ctx->core.is_active = true;
     
     round->status = ROUND_PLAYING;
     round->started_at = time(NULL);
@@ -1389,7 +850,7 @@ static void handle_legacy_ready(int fd, MessageHeader *req, const char *payload)
     
     char *json = cJSON_PrintUnformatted(resp);
     cJSON_Delete(resp);
-    send_json(fd, req, OP_S2C_ROUND1_START, json);
+    round_send_json(fd, req, OP_S2C_ROUND1_START, json);
     free(json);
 }
 
@@ -1397,24 +858,24 @@ static void handle_legacy_ready(int fd, MessageHeader *req, const char *payload)
 // DISCONNECT HANDLER
 //==============================================================================
 
-void handle_round1_disconnect(int client_fd) {
-    UserSession *session = session_get_by_socket(client_fd);
-    if (!session) return;
+void handle_round1_disconnect(int32_t account_id) {
+    MatchState *match = match_find_by_player(account_id);
+    R1_Context *ctx = match ? find_context(match->runtime_match_id) : NULL;
+    if (!ctx) return;
     
-    int32_t account_id = session->account_id;
-    R1_PlayerAnswer *pa = find_player(account_id);
+    R1_PlayerAnswer *pa = find_player(ctx, account_id);
     if (!pa) return;
     
     printf("[Round1] Player %d disconnected\n", account_id);
     
     // Update MatchPlayerState.connected
-    MatchPlayerState *mp = get_match_player(account_id);
+    MatchPlayerState *mp = round_player(&ctx->core, account_id);
     if (mp) {
         mp->connected = 0;
     }
     
-    int connected = count_connected();
-    int disconnected = count_disconnected();
+    int connected = round_connected_count(&ctx->core);
+    int disconnected = round_disconnected_count(&ctx->core);
     
     // Notify others
     cJSON *ntf = cJSON_CreateObject();
@@ -1431,35 +892,30 @@ void handle_round1_disconnect(int client_fd) {
     char *json = cJSON_PrintUnformatted(ntf);
     cJSON_Delete(ntf);
     
-    MessageHeader hdr = {0};
-    hdr.magic = htons(MAGIC_NUMBER);
-    hdr.version = PROTOCOL_VERSION;
-    hdr.command = htons(NTF_PLAYER_LEFT);
-    hdr.length = htonl((uint32_t)strlen(json));
+    MessageHeader hdr = {0};    // notifications carry seq_num 0
 
-    for (int i = 0; i < g_r1.player_count; i++) {
-        if (g_r1.players[i].account_id != account_id) {
-            int fd = get_socket(g_r1.players[i].account_id);
+    for (int i = 0; i < ctx->core.seat_count; i++) {
+        if (ctx->players[i].account_id != account_id) {
+            int fd = round_socket(&ctx->core, ctx->players[i].account_id);
             if (fd > 0) {
-                send(fd, &hdr, sizeof(hdr), 0);
-                send(fd, json, strlen(json), 0);
+                round_send_json(fd, &hdr, NTF_PLAYER_LEFT, json);
             }
         }
     }
     free(json);
     
     // Check if should end game
-    RoundState *round = get_round();
+    RoundState *round = round_state(&ctx->core);
     if (round && round->status == ROUND_PLAYING && disconnected >= 2) {
         printf("[Round1] Too many disconnections, ending game\n");
         
         round->status = ROUND_ENDED;
         round->ended_at = time(NULL);
-        g_r1.is_active = false;
+        ctx->core.is_active = false;
         
-        MatchState *match = get_match();
+        MatchState *match = ctx->core.match;
         if (match) {
-            match->status = MATCH_ENDED;
+            match_set_status(match, MATCH_ENDED);
         }
         
         cJSON *end = cJSON_CreateObject();
@@ -1469,14 +925,10 @@ void handle_round1_disconnect(int client_fd) {
         char *ejson = cJSON_PrintUnformatted(end);
         cJSON_Delete(end);
         
-        hdr.command = htons(OP_S2C_ROUND1_ALL_FINISHED);
-        hdr.length = htonl((uint32_t)strlen(ejson));
-        
-        for (int i = 0; i < g_r1.player_count; i++) {
-            int fd = get_socket(g_r1.players[i].account_id);
+        for (int i = 0; i < ctx->core.seat_count; i++) {
+            int fd = round_socket(&ctx->core, ctx->players[i].account_id);
             if (fd > 0) {
-                send(fd, &hdr, sizeof(hdr), 0);
-                send(fd, ejson, strlen(ejson), 0);
+                round_send_json(fd, &hdr, OP_S2C_ROUND1_ALL_FINISHED, ejson);
             }
         }
         free(ejson);
@@ -1484,11 +936,11 @@ void handle_round1_disconnect(int client_fd) {
     
     // Check if all remaining answered → advance
     if (round && round->status == ROUND_PLAYING) {
-        int answered = count_answered();
+        int answered = count_answered(ctx);
         if (answered >= connected && connected > 0) {
             printf("[Round1] All remaining players answered, advancing\n");
             MessageHeader dummy = {0};
-            advance_to_next_question(&dummy);
+            advance_to_next_question(ctx, &dummy);
         }
   }
 }
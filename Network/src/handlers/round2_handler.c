@@ -3,9 +3,9 @@
  * Players bid on product prices, closest without going over wins.
  * 
  * STATE USAGE:
- * - Score: MatchPlayerState.score - READ/UPDATE via get_match_player()
+ * - Score: MatchPlayerState.score - READ/UPDATE via round_player()
  * - Eliminated: MatchPlayerState.eliminated - READ
- * - Connected: UserSession.state - READ via session_get_by_account()
+ * - Connected: UserSession.state - READ via round_connected()
  * - Current product: RoundState.current_question_idx - READ/UPDATE
  * - Product data: RoundState.question_data[] - READ only
  * 
@@ -29,17 +29,21 @@
 #include <arpa/inet.h>
 #include <time.h>
 #include <unistd.h>
-#include <pthread.h>
 #include <math.h>
-#include <stdint.h>
 
 #include "handlers/round2_handler.h"
 #include "handlers/session_manager.h"
 #include "handlers/match_manager.h"
 #include "handlers/start_game_handler.h"
+#include "handlers/match_question.h"
+#include "handlers/match_snapshot.h"
 #include "handlers/bonus_handler.h"
+#include "handlers/match_executor.h"
+#include "handlers/round_engine.h"
+#include "utils/json_utils.h"
 #include "db/core/db_client.h"
-#include "db/repo/match_repo.h"         // For db_match_event_insert, db_match_answer_insert
+#include "db/repo/match_repo.h"
+#include "db/repo/match_write_queue.h"  // For match_wq_event, match_wq_answer
 #include "protocol/opcode.h"
 #include "protocol/protocol.h"
 #include <cjson/cJSON.h>
@@ -61,6 +65,7 @@
 #define SCORE_CLOSEST       100    // Score for closest bid without going over
 #define SCORE_OVERBID       50     // Score if all overbid (closest overbid wins)
 #define MAX_PRODUCTS        5      // 5 products per round
+#define RESULT_DISPLAY_MS   3000   // Turn result shown before the next product
 
 //==============================================================================
 // ROUND 2 EXECUTION CONTEXT
@@ -74,106 +79,51 @@ typedef struct {
 } R2_PlayerBid;
 
 typedef struct {
-    uint32_t match_id;
-    int      round_index;
-    bool     is_active;
+    RoundCore core;         // Match, roster, round index, is_active (first member)
     
-    R2_PlayerBid players[MAX_MATCH_PLAYERS];
-    int      player_count;
+    R2_PlayerBid players[MAX_MATCH_PLAYERS];     // Same index as core.seats
     int      ready_count;
     
     // Timer for product timeout
     time_t   product_start_time;
     int      current_timer_idx;
-    pthread_t timer_thread;
+    uint32_t timer_seq;     // Token of the armed timer (bumped on start/stop)
     bool     timer_running;
 } R2_Context;
 
-static R2_Context g_r2 = {0};
-static pthread_mutex_t g_r2_mutex = PTHREAD_MUTEX_INITIALIZER;
+// One context per match (MatchState.contexts[MATCH_CTX_ROUND2]), only
+// touched from the match's executor shard, see round1
 
 // Forward declarations
-static void process_turn_results(MessageHeader *req);
-static void advance_to_next_product(MessageHeader *req);
-static void broadcast_current_product(MessageHeader *req);
+static void process_turn_results(R2_Context *ctx, MessageHeader *req);
+static void advance_to_next_product(R2_Context *ctx, MessageHeader *req);
+static void broadcast_current_product(R2_Context *ctx, MessageHeader *req);
 
 //==============================================================================
-// HELPER: Reset context
+// HELPER: Context lifetime
 //==============================================================================
 
-static void reset_context(void) {
-    pthread_mutex_lock(&g_r2_mutex);
-    g_r2.timer_running = false;
-    pthread_mutex_unlock(&g_r2_mutex);
-    
-    memset(&g_r2, 0, sizeof(g_r2));
-    printf("[Round2] Context reset\n");
-}
-
-//==============================================================================
-// HELPER: Get states from other PICs
-//==============================================================================
-
-static MatchState* get_match(void) {
-    if (g_r2.match_id == 0) return NULL;
-    return match_get_by_id(g_r2.match_id);
-}
-
-static RoundState* get_round(void) {
-    MatchState *match = get_match();
-    if (!match) return NULL;
-    if (g_r2.round_index < 0 || g_r2.round_index >= match->round_count) {
-        return NULL;
-    }
-    return &match->rounds[g_r2.round_index];
-}
-
-static MatchPlayerState* get_match_player(int32_t account_id) {
-    MatchState *match = get_match();
-    if (!match) return NULL;
-    
-    for (int i = 0; i < match->player_count; i++) {
-        if (match->players[i].account_id == account_id) {
-            return &match->players[i];
-        }
-    }
-    return NULL;
-}
-
-static bool is_connected(int32_t account_id) {
-    UserSession *session = session_get_by_account(account_id);
-    if (!session) return false;
-    return session->state != SESSION_PLAYING_DISCONNECTED;
-}
-
-static int get_socket(int32_t account_id) {
-    UserSession *session = session_get_by_account(account_id);
-    if (!session || session->state == SESSION_PLAYING_DISCONNECTED) {
-        return -1;
-    }
-    return session->socket_fd;
+static R2_Context* find_context(uint32_t match_id) {
+    return match_context_find(match_id, MATCH_CTX_ROUND2);
 }
 
 //==============================================================================
 // HELPER: Local bid tracking
 //==============================================================================
 
-static R2_PlayerBid* find_player(int32_t account_id) {
-    for (int i = 0; i < g_r2.player_count; i++) {
-        if (g_r2.players[i].account_id == account_id) {
-            return &g_r2.players[i];
-        }
-    }
-    return NULL;
+static R2_PlayerBid* find_player(R2_Context *ctx, int32_t account_id) {
+    int seat = round_seat_find(&ctx->core, account_id);
+    return seat >= 0 ? &ctx->players[seat] : NULL;
 }
 
-static R2_PlayerBid* add_player(int32_t account_id) {
-    R2_PlayerBid *existing = find_player(account_id);
+static R2_PlayerBid* add_player(R2_Context *ctx, int32_t account_id) {
+    R2_PlayerBid *existing = find_player(ctx, account_id);
     if (existing) return existing;
     
-    if (g_r2.player_count >= MAX_MATCH_PLAYERS) return NULL;
+    int seat = round_seat_add(&ctx->core, account_id);
+    if (seat < 0) return NULL;
     
-    R2_PlayerBid *p = &g_r2.players[g_r2.player_count++];
+    R2_PlayerBid *p = &ctx->players[seat];
     p->account_id = account_id;
     p->bid_value = -1;
     p->has_bid = false;
@@ -181,151 +131,53 @@ static R2_PlayerBid* add_player(int32_t account_id) {
     return p;
 }
 
-static void reset_bids(void) {
-    for (int i = 0; i < g_r2.player_count; i++) {
-        g_r2.players[i].bid_value = -1;
-        g_r2.players[i].has_bid = false;
+static void reset_bids(R2_Context *ctx) {
+    for (int i = 0; i < ctx->core.seat_count; i++) {
+        ctx->players[i].bid_value = -1;
+        ctx->players[i].has_bid = false;
     }
 }
 
-static int count_bid(void) {
+static int count_bid(R2_Context *ctx) {
     int count = 0;
-    for (int i = 0; i < g_r2.player_count; i++) {
-        if (g_r2.players[i].has_bid) {
+    for (int i = 0; i < ctx->core.seat_count; i++) {
+        if (ctx->players[i].has_bid) {
             count++;
         }
     }
     return count;
 }
 
-static int count_connected(void) {
-    int count = 0;
-    for (int i = 0; i < g_r2.player_count; i++) {
-        if (is_connected(g_r2.players[i].account_id)) {
-            count++;
-        }
-    }
-    return count;
-}
-
-static int count_disconnected(void) {
-    return g_r2.player_count - count_connected();
-}
-
 //==============================================================================
 // HELPER: Get correct price from product data
 //==============================================================================
 
-static int64_t get_correct_price(int product_idx) {
-    RoundState *round = get_round();
+static int64_t get_correct_price(R2_Context *ctx, int product_idx) {
+    RoundState *round = round_state(&ctx->core);
     if (!round || product_idx < 0 || product_idx >= round->question_count) return -1;
-    
-    MatchQuestion *mq = &round->question_data[product_idx];
-    if (!mq->json_data) return -1;
-    
-    cJSON *root = cJSON_Parse(mq->json_data);
-    if (!root) return -1;
-    
-    // Product data may be nested inside "data" field from DB
-    cJSON *data = cJSON_GetObjectItem(root, "data");
-    if (!data) {
-        data = root;  // Fallback: data at root level
-    }
-    
-    int64_t price = -1;
-    
-    // Look for "correct_answer" field (number)
-    cJSON *cans = cJSON_GetObjectItem(data, "correct_answer");
-    if (cans && cJSON_IsNumber(cans)) {
-        price = (int64_t)cans->valuedouble;
-        printf("[Round2] Product %d: correct_price = %lld\n", product_idx, (long long)price);
-    } else {
-        // Try "answer" field
-        cJSON *ans = cJSON_GetObjectItem(data, "answer");
-        if (ans && cJSON_IsNumber(ans)) {
-            price = (int64_t)ans->valuedouble;
-            printf("[Round2] Product %d: answer = %lld\n", product_idx, (long long)price);
-        } else {
-            // Try "price" field
-            cJSON *prc = cJSON_GetObjectItem(data, "price");
-            if (prc && cJSON_IsNumber(prc)) {
-                price = (int64_t)prc->valuedouble;
-                printf("[Round2] Product %d: price = %lld\n", product_idx, (long long)price);
-            }
-        }
-    }
-    
-    cJSON_Delete(root);
-    return price;
-}
 
-//==============================================================================
-// HELPER: Response/Broadcast
-//==============================================================================
-
-static void send_json(int fd, MessageHeader *req, uint16_t cmd, const char *json) {
-    if (fd <= 0 || !json) return;
-    forward_response(fd, req, cmd, json, (uint32_t)strlen(json));
-}
-
-static void broadcast_json(MessageHeader *req, uint16_t cmd, const char *json) {
-    if (!json) return;
-    for (int i = 0; i < g_r2.player_count; i++) {
-        int fd = get_socket(g_r2.players[i].account_id);
-        if (fd > 0) {
-            forward_response(fd, req, cmd, json, (uint32_t)strlen(json));
-        }
-    }
+    // Decoded once in handle_start_game
+    return round->question_data[product_idx].price;
 }
 
 //==============================================================================
 // HELPER: Build product payload
 //==============================================================================
 
-static char* build_product_json(int product_idx) {
-    RoundState *round = get_round();
+static char* build_product_json(R2_Context *ctx, int product_idx, Arena *arena) {
+    RoundState *round = round_state(&ctx->core);
     if (!round || product_idx < 0 || product_idx >= round->question_count) return NULL;
-    
-    MatchQuestion *mq = &round->question_data[product_idx];
-    if (!mq->json_data) return NULL;
-    
-    cJSON *root = cJSON_Parse(mq->json_data);
-    if (!root) return NULL;
-    
-    // Product data may be nested inside "data" field from DB
-    cJSON *data = cJSON_GetObjectItem(root, "data");
-    if (!data) {
-        data = root;  // Fallback: data at root level
-    }
-    
-    cJSON *obj = cJSON_CreateObject();
-    cJSON_AddTrueToObject(obj, "success");
-    cJSON_AddNumberToObject(obj, "product_idx", product_idx);
-    cJSON_AddNumberToObject(obj, "total_products", round->question_count);
-    cJSON_AddNumberToObject(obj, "time_limit_ms", TIME_PER_PRODUCT);
-    
-    // ⭐ Option 3: Send server timestamp for client-side time sync
-    cJSON_AddNumberToObject(obj, "start_timestamp", (double)g_r2.product_start_time);
-    
-    // Copy question text - try multiple field names
-    cJSON *text = cJSON_GetObjectItem(data, "question");
-    if (!text) text = cJSON_GetObjectItem(data, "content");
-    if (!text) text = cJSON_GetObjectItem(data, "product_name");
-    if (text && cJSON_IsString(text)) {
-        cJSON_AddStringToObject(obj, "question", text->valuestring);
-    }
-    
-    // Copy product image
-    cJSON *img = cJSON_GetObjectItem(data, "image");
-    if (!img) img = cJSON_GetObjectItem(data, "product_image");
-    if (img && cJSON_IsString(img)) {
-        cJSON_AddStringToObject(obj, "product_image", img->valuestring);
-    }
-    
-    char *json = cJSON_PrintUnformatted(obj);
-    cJSON_Delete(obj);
-    cJSON_Delete(root);
-    return json;
+
+    // Per-broadcast fields; question / product_image are pre-rendered
+    // ⭐ Option 3: start_timestamp lets the client compute an accurate time_left
+    char header[192];
+    snprintf(header, sizeof(header),
+             "\"success\":true,\"product_idx\":%d,\"total_products\":%d,"
+             "\"time_limit_ms\":%d,\"start_timestamp\":%lld",
+             product_idx, round->question_count, TIME_PER_PRODUCT,
+             (long long)ctx->product_start_time);
+
+    return match_question_render(&round->question_data[product_idx], header, arena);
 }
 
 //==============================================================================
@@ -428,373 +280,88 @@ static void calculate_turn_scores(int64_t correct_price, BidResult *results, int
 // TIMER: Product timeout handler
 //==============================================================================
 
-static void* product_timer_thread(void *arg) {
-    (void)arg;
-    
-    int target_idx = g_r2.current_timer_idx;
-    uint32_t target_match = g_r2.match_id;
-    
-    printf("[Round2-Timer] Started for product %d (timeout: %dms)\n", 
-           target_idx, TIME_PER_PRODUCT);
-    
-    int sleep_time = TIME_PER_PRODUCT / 1000;
-    for (int i = 0; i < sleep_time; i++) {
-        sleep(1);
-        
-        pthread_mutex_lock(&g_r2_mutex);
-        bool still_running = g_r2.timer_running;
-        bool same_product = (g_r2.current_timer_idx == target_idx && 
-                            g_r2.match_id == target_match);
-        pthread_mutex_unlock(&g_r2_mutex);
-        
-        if (!still_running || !same_product) {
-            printf("[Round2-Timer] Cancelled (product already advanced)\n");
-            return NULL;
-        }
-    }
+// Runs on the match's shard; token is the timer_seq it was armed with
+static void product_timeout(uint32_t match_id, uint64_t token) {
+    R2_Context *ctx = find_context(match_id);
+    bool should_advance = ctx && ctx->timer_running && 
+                         ctx->timer_seq == (uint32_t)token &&
+                         ctx->core.is_active;
+    if (!should_advance) return;
     
-    pthread_mutex_lock(&g_r2_mutex);
-    bool should_advance = g_r2.timer_running && 
-                         g_r2.current_timer_idx == target_idx &&
-                         g_r2.match_id == target_match &&
-                         g_r2.is_active;
-    pthread_mutex_unlock(&g_r2_mutex);
+    printf("[Round2-Timer] ⏰ TIMEOUT! Processing product %d\n", ctx->current_timer_idx);
     
-    if (should_advance) {
-        printf("[Round2-Timer] ⏰ TIMEOUT! Processing product %d\n", target_idx);
-        
-        // Mark non-bidding players as bid = -1 (no bid)
-        for (int i = 0; i < g_r2.player_count; i++) {
-            if (!g_r2.players[i].has_bid) {
-                g_r2.players[i].has_bid = true;
-                g_r2.players[i].bid_value = -1;  // No bid
-                printf("[Round2-Timer] Player %d did not bid in time\n", 
-                       g_r2.players[i].account_id);
-            }
+    // Mark non-bidding players as bid = -1 (no bid)
+    for (int i = 0; i < ctx->core.seat_count; i++) {
+        if (!ctx->players[i].has_bid) {
+            ctx->players[i].has_bid = true;
+            ctx->players[i].bid_value = -1;  // No bid
+            printf("[Round2-Timer] Player %d did not bid in time\n", 
+                   ctx->players[i].account_id);
         }
-        
-        // Process results and advance
-        MessageHeader dummy = {0};
-        process_turn_results(&dummy);
     }
     
-    return NULL;
+    // Process results and advance
+    MessageHeader dummy = {0};
+    process_turn_results(ctx, &dummy);
 }
 
-static void start_product_timer(int product_idx) {
-    pthread_mutex_lock(&g_r2_mutex);
+static void start_product_timer(R2_Context *ctx, int product_idx) {
+    // Supersedes the previous timer (if any)
+    ctx->timer_seq++;
+    ctx->product_start_time = time(NULL);
+    ctx->current_timer_idx = product_idx;
+    ctx->timer_running = true;
     
-    g_r2.timer_running = false;
-    g_r2.product_start_time = time(NULL);
-    g_r2.current_timer_idx = product_idx;
-    g_r2.timer_running = true;
+    printf("[Round2-Timer] Started for match %u product %d (timeout: %dms)\n", 
+           ctx->core.match_id, product_idx, TIME_PER_PRODUCT);
     
-    pthread_mutex_unlock(&g_r2_mutex);
-    
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
-    
-    if (pthread_create(&g_r2.timer_thread, &attr, product_timer_thread, NULL) != 0) {
-        printf("[Round2-Timer] Warning: Failed to create timer thread\n");
+    if (!match_exec_post_timer(ctx->core.match_id, TIME_PER_PRODUCT, product_timeout, ctx->timer_seq)) {
+        printf("[Round2-Timer] Warning: Failed to arm timer\n");
     }
-    
-    pthread_attr_destroy(&attr);
-}
-
-static void stop_product_timer(void) {
-    pthread_mutex_lock(&g_r2_mutex);
-    g_r2.timer_running = false;
-    pthread_mutex_unlock(&g_r2_mutex);
 }
 
-//==============================================================================
-// ELIMINATION LOGIC (same as Round 1)
-//==============================================================================
-
-typedef struct {
-    int32_t account_id;
-    int32_t score;
-} ScoreEntry;
-
-static void eliminate_player(MatchPlayerState *mp, const char *reason) {
-    if (!mp) return;
-    
-    mp->eliminated = 1;
-    mp->eliminated_at_round = g_r2.round_index + 1;
-    
-    printf("[Round2] Player %d ELIMINATED at round %d (reason: %s, score=%d)\n", 
-           mp->account_id, g_r2.round_index + 1, reason, mp->score);
-    
-    // =========================================================================
-    // SEND NTF_ELIMINATION to the eliminated player
-    // =========================================================================
-    UserSession *elim_session = session_get_by_account(mp->account_id);
-    int elim_fd = elim_session ? elim_session->socket_fd : -1;
-    
-    if (elim_fd > 0) {
-        cJSON *ntf = cJSON_CreateObject();
-        cJSON_AddNumberToObject(ntf, "player_id", mp->account_id);
-        cJSON_AddStringToObject(ntf, "reason", reason);
-        cJSON_AddNumberToObject(ntf, "round", g_r2.round_index + 1);
-        cJSON_AddNumberToObject(ntf, "final_score", mp->score);
-        cJSON_AddStringToObject(ntf, "message", "You have been eliminated!");
-        
-        char *ntf_json = cJSON_PrintUnformatted(ntf);
-        cJSON_Delete(ntf);
-        
-        if (ntf_json) {
-            MessageHeader hdr = {0};
-            hdr.magic = htons(MAGIC_NUMBER);
-            hdr.version = PROTOCOL_VERSION;
-            hdr.command = htons(NTF_ELIMINATION);
-            hdr.length = htonl((uint32_t)strlen(ntf_json));
-            
-            send(elim_fd, &hdr, sizeof(hdr), 0);
-            send(elim_fd, ntf_json, strlen(ntf_json), 0);
-            printf("[Round2] Sent NTF_ELIMINATION to player %d\n", mp->account_id);
-            free(ntf_json);
-        }
-        
-        // Change session state back to LOBBY so player can join new games
-        session_mark_lobby(elim_session);
-        printf("[Round2] Changed player %d session state to LOBBY\n", mp->account_id);
-    }
-    
-    // =========================================================================
-    // Save elimination event to database
-    // =========================================================================
-    MatchState *match = get_match();
-    if (mp->account_id > 0 && match && match->db_match_id > 0) {
-        // Use db_match_event_insert from match_repo
-        // Note: player_id in match_events refers to accounts.id, not match_players.id
-        db_error_t event_err = db_match_event_insert(
-            match->db_match_id,
-            mp->account_id,  // Use account_id, not match_player_id
-            "ELIMINATED",
-            g_r2.round_index + 1,
-            0
-        );
-        if (event_err == DB_SUCCESS) {
-            printf("[Round2] Saved elimination event to DB\n");
-        } else {
-            printf("[Round2] Failed to save elimination event: err=%d\n", event_err);
-        }
-        
-        cJSON *player_payload = cJSON_CreateObject();
-        cJSON_AddNumberToObject(player_payload, "score", mp->score);
-        cJSON_AddBoolToObject(player_payload, "eliminated", true);
-        
-        char filter[64];
-        snprintf(filter, sizeof(filter), "id=eq.%d", mp->match_player_id);
-        
-        cJSON *player_result = NULL;
-        db_patch("match_players", filter, player_payload, &player_result);
-        cJSON_Delete(player_payload);
-        if (player_result) cJSON_Delete(player_result);
-    }
+static void stop_product_timer(R2_Context *ctx) {
+    ctx->timer_running = false;
+    ctx->timer_seq++;
 }
 
-// Returns true if bonus round was triggered
-static bool perform_elimination(void) {
-    MatchState *match = get_match();
-    if (!match) return false;
-    
-    // MODE_SCORING: No elimination
-    if (match->mode == MODE_SCORING) {
-        printf("[Round2] Scoring mode - disconnected players get 0 points\n");
-        for (int i = 0; i < g_r2.player_count; i++) {
-            int32_t acc_id = g_r2.players[i].account_id;
-            if (!is_connected(acc_id)) {
-                printf("[Round2] Player %d disconnected - 0 points (can rejoin next round)\n", acc_id);
-            }
-        }
-        printf("[Round2] Scoring mode - no elimination\n");
-        return false;
-    }
-    
-    // MODE_ELIMINATION: Eliminate disconnected + lowest scorer
-    printf("[Round2] Elimination mode - processing...\n");
+// Turn result has been on screen for RESULT_DISPLAY_MS: next product
+static void result_display_done(uint32_t match_id, uint64_t token) {
+    R2_Context *ctx = find_context(match_id);
+    if (!ctx || !ctx->core.is_active || ctx->timer_seq != (uint32_t)token) return;
     
-    // Step 1: Eliminate all disconnected players
-    for (int i = 0; i < g_r2.player_count; i++) {
-        int32_t acc_id = g_r2.players[i].account_id;
-        MatchPlayerState *mp = get_match_player(acc_id);
-        
-        if (mp && !mp->eliminated && !is_connected(acc_id)) {
-            eliminate_player(mp, "DISCONNECT");
-        }
-    }
-    
-    // Step 2: Find lowest scorer among connected players
-    ScoreEntry scores[MAX_MATCH_PLAYERS];
-    int count = 0;
-    
-    for (int i = 0; i < g_r2.player_count; i++) {
-        MatchPlayerState *mp = get_match_player(g_r2.players[i].account_id);
-        if (mp && !mp->eliminated && is_connected(mp->account_id)) {
-            scores[count].account_id = mp->account_id;
-            scores[count].score = mp->score;
-            count++;
-        }
-    }
-    
-    if (count < 2) {
-        printf("[Round2] Only %d connected players remaining, no further elimination\n", count);
-        return false;
-    }
-    
-    // Sort ascending
-    for (int i = 0; i < count - 1; i++) {
-        for (int j = 0; j < count - i - 1; j++) {
-            if (scores[j].score > scores[j+1].score) {
-                ScoreEntry tmp = scores[j];
-                scores[j] = scores[j+1];
-                scores[j+1] = tmp;
-            }
-        }
-    }
-    
-    // Check ties at lowest
-    int lowest = scores[0].score;
-    int tie_count = 0;
-    for (int i = 0; i < count; i++) {
-        if (scores[i].score == lowest) tie_count++;
-    }
-    
-    if (tie_count >= 2) {
-        printf("[Round2] %d players tied at lowest (%d), triggering bonus round\n", tie_count, lowest);
-        
-        // Collect tied players
-        int32_t tied_players[MAX_MATCH_PLAYERS];
-        int tied_count = 0;
-        for (int i = 0; i < count && tied_count < MAX_MATCH_PLAYERS; i++) {
-            if (scores[i].score == lowest) {
-                tied_players[tied_count++] = scores[i].account_id;
-            }
-        }
-        
-        // Trigger bonus round
-        if (match && tied_count >= 2) {
-            check_and_trigger_bonus(match->runtime_match_id, 2);
-            return true;  // Bonus triggered
-        }
-        return false;
-    }
-    
-    // Eliminate lowest scorer
-    MatchPlayerState *elim_player = get_match_player(scores[0].account_id);
-    if (elim_player) {
-        eliminate_player(elim_player, "LOWEST_SCORE");
-    }
-    
-    return false;
+    MessageHeader dummy = {0};
+    advance_to_next_product(ctx, &dummy);
 }
 
 //==============================================================================
-// HELPER: Build round end result
+// ROUND END
+// Elimination, ranking and the ALL_FINISHED frame come from round_engine
+// (same rules as Round 1)
 //==============================================================================
 
-static char* build_round_end_json(void) {
-    MatchState *match = get_match();
-    if (!match) return NULL;
-    
-    cJSON *obj = cJSON_CreateObject();
-    cJSON_AddTrueToObject(obj, "success");
-    cJSON_AddNumberToObject(obj, "match_id", g_r2.match_id);
-    cJSON_AddNumberToObject(obj, "round", 2);
-    
-    int connected = count_connected();
-    int disconnected = count_disconnected();
-    
-    cJSON_AddNumberToObject(obj, "connected_count", connected);
-    cJSON_AddNumberToObject(obj, "disconnected_count", disconnected);
-    cJSON_AddNumberToObject(obj, "finished_count", g_r2.player_count);
-    cJSON_AddNumberToObject(obj, "player_count", g_r2.player_count);
-    
-    bool can_continue = (disconnected < 2);
-    cJSON_AddBoolToObject(obj, "can_continue", can_continue);
-    
-    if (disconnected >= 2) {
-        cJSON_AddStringToObject(obj, "status_message", "Game ended - too many disconnections");
-    } else if (disconnected == 1) {
-        cJSON_AddStringToObject(obj, "status_message", "1 disconnected - no elimination");
-    } else {
-        cJSON_AddStringToObject(obj, "status_message", "Round completed");
-    }
-    
-    // Build rankings (sorted by score descending)
-    ScoreEntry scores[MAX_MATCH_PLAYERS];
-    int count = 0;
-    for (int i = 0; i < g_r2.player_count; i++) {
-        MatchPlayerState *mp = get_match_player(g_r2.players[i].account_id);
-        if (mp) {
-            scores[count].account_id = mp->account_id;
-            scores[count].score = mp->score;
-            count++;
-        }
-    }
-    
-    // Sort descending
-    for (int i = 0; i < count - 1; i++) {
-        for (int j = 0; j < count - i - 1; j++) {
-            if (scores[j].score < scores[j+1].score) {
-                ScoreEntry tmp = scores[j];
-                scores[j] = scores[j+1];
-                scores[j+1] = tmp;
-            }
-        }
-    }
-    
-    cJSON *players = cJSON_CreateArray();
-    for (int i = 0; i < count; i++) {
-        MatchPlayerState *mp = get_match_player(scores[i].account_id);
-        if (!mp) continue;
-        
-        cJSON *p = cJSON_CreateObject();
-        cJSON_AddNumberToObject(p, "id", mp->account_id);
-        cJSON_AddNumberToObject(p, "rank", i + 1);
-        cJSON_AddNumberToObject(p, "score", mp->score);
-        cJSON_AddBoolToObject(p, "connected", is_connected(mp->account_id));
-        cJSON_AddBoolToObject(p, "eliminated", mp->eliminated != 0);
-        
-        // Add player name
-        cJSON_AddStringToObject(p, "name", mp->name);
-        
-        cJSON_AddItemToArray(players, p);
-    }
-    cJSON_AddItemToObject(obj, "players", players);
-    cJSON_AddItemToObject(obj, "rankings", cJSON_Duplicate(players, 1));
-    
-    // Add next round info
-    // current_round_idx was already advanced to the next round
-    // For frontend, we need 1-based index
-    int next_round = 0;
-    if (match->current_round_idx < match->round_count) {
-        next_round = match->current_round_idx + 1; // 1-based for frontend
-    }
-    cJSON_AddNumberToObject(obj, "next_round", next_round);
-    cJSON_AddNumberToObject(obj, "current_round", 2);
-    printf("[Round2] Build end JSON: current_round_idx=%d, round_count=%d, next_round=%d\n",
-           match->current_round_idx, match->round_count, next_round);
-    
-    char *json = cJSON_PrintUnformatted(obj);
-    cJSON_Delete(obj);
-    return json;
-}
+static const RoundKind k_round2 = {
+    .number           = 2,
+    .tag              = "[Round2]",
+    .all_finished_cmd = OP_S2C_ROUND2_ALL_FINISHED,
+    .final            = false,
+};
 
 //==============================================================================
 // PROCESS: Turn results (after all bids received)
 //==============================================================================
 
-static void process_turn_results(MessageHeader *req) {
-    stop_product_timer();
+static void process_turn_results(R2_Context *ctx, MessageHeader *req) {
+    // Already scored: the result is on screen until the next product
+    if (!ctx->timer_running) return;
+    stop_product_timer(ctx);
+    match_snapshot_close(ctx->core.match);
     
-    RoundState *round = get_round();
+    RoundState *round = round_state(&ctx->core);
     if (!round) return;
     
     int product_idx = round->current_question_idx;
-    int64_t correct_price = get_correct_price(product_idx);
+    int64_t correct_price = get_correct_price(ctx, product_idx);
     
     printf("[Round2] Processing turn %d results (correct_price=%lld)\n", 
            product_idx, (long long)correct_price);
@@ -803,12 +370,12 @@ static void process_turn_results(MessageHeader *req) {
     BidResult results[MAX_MATCH_PLAYERS];
     int result_count = 0;
     
-    for (int i = 0; i < g_r2.player_count; i++) {
-        MatchPlayerState *mp = get_match_player(g_r2.players[i].account_id);
+    for (int i = 0; i < ctx->core.seat_count; i++) {
+        MatchPlayerState *mp = round_player(&ctx->core, ctx->players[i].account_id);
         if (!mp || mp->eliminated) continue;
         
-        results[result_count].account_id = g_r2.players[i].account_id;
-        results[result_count].bid = g_r2.players[i].bid_value;
+        results[result_count].account_id = ctx->players[i].account_id;
+        results[result_count].bid = ctx->players[i].bid_value;
         result_count++;
     }
     
@@ -819,7 +386,7 @@ static void process_turn_results(MessageHeader *req) {
     cJSON *bids_array = cJSON_CreateArray();
     
     for (int i = 0; i < result_count; i++) {
-        MatchPlayerState *mp = get_match_player(results[i].account_id);
+        MatchPlayerState *mp = round_player(&ctx->core, results[i].account_id);
         if (!mp) continue;
         
         mp->score += results[i].score;
@@ -829,7 +396,7 @@ static void process_turn_results(MessageHeader *req) {
                results[i].account_id, (long long)results[i].bid, 
                results[i].score, mp->score);
         
-        // Save to match_answer using db_match_answer_insert
+        // Save to match_answer (write-behind queue)
         if (mp->match_player_id > 0 && round->questions[product_idx].question_id > 0) {
             // Build answer JSON string
             cJSON *ans_obj = cJSON_CreateObject();
@@ -839,17 +406,17 @@ static void process_turn_results(MessageHeader *req) {
             char *ans_json = cJSON_PrintUnformatted(ans_obj);
             cJSON_Delete(ans_obj);
             
-            db_error_t db_err = db_match_answer_insert(
+            MatchState *match = ctx->core.match;
+            match_wq_answer(
+                match ? match->db_match_id : 0,
                 round->questions[product_idx].question_id,
                 mp->match_player_id,
                 ans_json,
                 results[i].score,
                 1  // action_idx = 1
             );
-            if (db_err == DB_SUCCESS) {
-                printf("[Round2] Saved bid to DB: p=%d bid=%lld\n", 
-                       mp->match_player_id, (long long)results[i].bid);
-            }
+            printf("[Round2] Queued bid for DB: p=%d bid=%lld\n", 
+                   mp->match_player_id, (long long)results[i].bid);
             if (ans_json) free(ans_json);
         }
         
@@ -873,73 +440,45 @@ static void process_turn_results(MessageHeader *req) {
     cJSON_AddNumberToObject(result, "correct_price", correct_price);
     cJSON_AddItemToObject(result, "bids", bids_array);
     
-    char *json = cJSON_PrintUnformatted(result);
+    Arena *arena = round_arena(&ctx->core);
+    ArenaMark mark = arena_mark(arena);
+    char *json = json_print_arena(result, arena);
     cJSON_Delete(result);
     
-    printf("[Round2] Turn result JSON: %s\n", json);
-    broadcast_json(req, OP_S2C_ROUND2_TURN_RESULT, json);
-    free(json);
+    printf("[Round2] Turn result JSON: %s\n", json ? json : "(null)");
+    round_broadcast(&ctx->core, req, OP_S2C_ROUND2_TURN_RESULT, json);
+    arena_rewind(arena, mark);
     
     // Mark question as ended
     if (product_idx < round->question_count) {
         round->questions[product_idx].status = QUESTION_ENDED;
     }
     
-    // Wait a bit for clients to see result, then advance
-    // Wait for clients to see result (match frontend's 3-second display)
-    sleep(3);
-    
-    advance_to_next_product(req);
+    // Wait for clients to see result (match frontend's 3-second display),
+    // then advance from a shard timer instead of blocking the shard
+    if (!match_exec_post_timer(ctx->core.match_id, RESULT_DISPLAY_MS, result_display_done, ctx->timer_seq)) {
+        advance_to_next_product(ctx, req);
+    }
 }
 
 //==============================================================================
 // ADVANCE: Move to next product or end round
 //==============================================================================
 
-static void advance_to_next_product(MessageHeader *req) {
-    RoundState *round = get_round();
+static void advance_to_next_product(R2_Context *ctx, MessageHeader *req) {
+    RoundState *round = round_state(&ctx->core);
     if (!round) return;
     
     round->current_question_idx++;
     
     if (round->current_question_idx >= round->question_count) {
-        // Round finished
+        // Round finished: elimination / bonus / next round (round_engine)
         printf("[Round2] All products completed\n");
-        round->status = ROUND_ENDED;
-        round->ended_at = time(NULL);
-        g_r2.is_active = false;
-        
-        // Perform elimination - returns true if bonus triggered
-        bool bonus_triggered = perform_elimination();
-        
-        if (bonus_triggered) {
-            printf("[Round2] Bonus round active - waiting for bonus to complete\n");
-            return;
-        }
-        
-        // Advance match to next round
-        MatchState *match = get_match();
-        if (match && match->current_round_idx < match->round_count - 1) {
-            match->current_round_idx++;
-            printf("[Round2] Advanced to round %d\n", match->current_round_idx + 1);
-            
-            // Initialize next round state
-            RoundState *next_round = &match->rounds[match->current_round_idx];
-            next_round->status = ROUND_PENDING;
-            next_round->current_question_idx = 0;
-        }
-        
-        // Broadcast final results
-        char *end_json = build_round_end_json();
-        if (end_json) {
-            printf("[Round2] Round end JSON: %s\n", end_json);
-            broadcast_json(req, OP_S2C_ROUND2_ALL_FINISHED, end_json);
-            free(end_json);
-        }
+        round_finish(&ctx->core, req);
     } else {
         // Send next product
-        reset_bids();
-        broadcast_current_product(req);
+        reset_bids(ctx);
+        broadcast_current_product(ctx, req);
     }
 }
 
@@ -947,26 +486,29 @@ static void advance_to_next_product(MessageHeader *req) {
 // BROADCAST: Send current product to all players
 //==============================================================================
 
-static void broadcast_current_product(MessageHeader *req) {
-    RoundState *round = get_round();
+static void broadcast_current_product(R2_Context *ctx, MessageHeader *req) {
+    RoundState *round = round_state(&ctx->core);
     if (!round) return;
     
     int product_idx = round->current_question_idx;
     printf("[Round2] Broadcasting product %d/%d\n", product_idx + 1, round->question_count);
     
-    reset_bids();
+    reset_bids(ctx);
     
     if (product_idx < round->question_count) {
         round->questions[product_idx].status = QUESTION_ACTIVE;
     }
     
-    char *json = build_product_json(product_idx);
+    Arena *arena = round_arena(&ctx->core);
+    ArenaMark mark = arena_mark(arena);
+    char *json = build_product_json(ctx, product_idx, arena);
     if (json) {
         printf("[Round2] Product data: %s\n", json);
-        broadcast_json(req, OP_S2C_ROUND2_PRODUCT, json);
-        free(json);
+        round_broadcast(&ctx->core, req, OP_S2C_ROUND2_PRODUCT, json);
+        arena_rewind(arena, mark);
         
-        start_product_timer(product_idx);
+        start_product_timer(ctx, product_idx);
+        match_snapshot_begin(ctx->core.match, product_idx, TIME_PER_PRODUCT);
     } else {
         printf("[Round2] ERROR: Failed to build product JSON for idx=%d\n", product_idx);
     }
@@ -978,7 +520,7 @@ static void broadcast_current_product(MessageHeader *req) {
 
 static void handle_player_ready(int fd, MessageHeader *req, const char *payload) {
     if (req->length < 8) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
         return;
     }
     
@@ -995,7 +537,7 @@ static void handle_player_ready(int fd, MessageHeader *req, const char *payload)
     
     MatchState *match = match_get_by_id(match_id);
     if (!match) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Match not found\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Match not found\"}");
         return;
     }
     
@@ -1009,30 +551,33 @@ static void handle_player_ready(int fd, MessageHeader *req, const char *payload)
     }
     
     if (!mp) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Not in match\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Not in match\"}");
         return;
     }
     
     if (mp->eliminated) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Player eliminated\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Player eliminated\"}");
         return;
     }
     
-    // Initialize context if new match/round
-    if (match_id != g_r2.match_id) {
-        reset_context();
-        g_r2.match_id = match_id;
-        g_r2.round_index = match->current_round_idx;
+    // Context of this match (created on the first ready)
+    R2_Context *ctx = match_context_get(match, MATCH_CTX_ROUND2, sizeof(R2_Context), NULL);
+    if (!ctx) {
+        round_send_json(fd, req, ERR_SERVER_ERROR, "{\"success\":false,\"error\":\"Server error\"}");
+        return;
+    }
+    if (!ctx->core.match) {
+        round_core_bind(&ctx->core, &k_round2, match, match->current_round_idx);
     }
     
-    R2_PlayerBid *pb = add_player(account_id);
+    R2_PlayerBid *pb = add_player(ctx, account_id);
     if (!pb) {
-        send_json(fd, req, ERR_ROOM_FULL, "{\"success\":false,\"error\":\"Round full\"}");
+        round_send_json(fd, req, ERR_ROOM_FULL, "{\"success\":false,\"error\":\"Round full\"}");
         return;
     }
     
     // Check for reconnection during active round
-    RoundState *round = get_round();
+    RoundState *round = round_state(&ctx->core);
     if (round && round->status == ROUND_PLAYING) {
         cJSON *obj = cJSON_CreateObject();
         cJSON_AddTrueToObject(obj, "success");
@@ -1042,12 +587,12 @@ static void handle_player_ready(int fd, MessageHeader *req, const char *payload)
         
         // Add full player list for leaderboard
         cJSON *players = cJSON_CreateArray();
-        for (int i = 0; i < g_r2.player_count; i++) {
+        for (int i = 0; i < ctx->core.seat_count; i++) {
             cJSON *p = cJSON_CreateObject();
-            cJSON_AddNumberToObject(p, "account_id", g_r2.players[i].account_id);
-            cJSON_AddBoolToObject(p, "ready", g_r2.players[i].ready);
+            cJSON_AddNumberToObject(p, "account_id", ctx->players[i].account_id);
+            cJSON_AddBoolToObject(p, "ready", ctx->players[i].ready);
             
-            MatchPlayerState *mp_state = get_match_player(g_r2.players[i].account_id);
+            MatchPlayerState *mp_state = round_player(&ctx->core, ctx->players[i].account_id);
             if (mp_state) {
                 cJSON_AddStringToObject(p, "name", mp_state->name);
                 cJSON_AddNumberToObject(p, "score", mp_state->score);
@@ -1056,39 +601,41 @@ static void handle_player_ready(int fd, MessageHeader *req, const char *payload)
         }
         cJSON_AddItemToObject(obj, "players", players);
         
-        char *json = cJSON_PrintUnformatted(obj);
+        Arena *arena = round_arena(&ctx->core);
+        ArenaMark mark = arena_mark(arena);
+        char *json = json_print_arena(obj, arena);
         cJSON_Delete(obj);
-        send_json(fd, req, OP_S2C_ROUND2_READY_STATUS, json);
-        free(json);
+        round_send_json(fd, req, OP_S2C_ROUND2_READY_STATUS, json);
         
-        char *p_json = build_product_json(round->current_question_idx);
+        char *p_json = build_product_json(ctx, round->current_question_idx, arena);
         if (p_json) {
-            send_json(fd, req, OP_S2C_ROUND2_PRODUCT, p_json);
-            free(p_json);
+            round_send_json(fd, req, OP_S2C_ROUND2_PRODUCT, p_json);
         }
+        arena_rewind(arena, mark);
         return;
     }
     
     // Mark ready
     if (!pb->ready) {
         pb->ready = true;
-        g_r2.ready_count++;
+        ctx->ready_count++;
+        match_snapshot_ready(match, account_id);
     }
     
     // Broadcast ready status
     cJSON *status = cJSON_CreateObject();
     cJSON_AddTrueToObject(status, "success");
-    cJSON_AddNumberToObject(status, "ready_count", g_r2.ready_count);
-    cJSON_AddNumberToObject(status, "player_count", g_r2.player_count);
+    cJSON_AddNumberToObject(status, "ready_count", ctx->ready_count);
+    cJSON_AddNumberToObject(status, "player_count", ctx->core.seat_count);
     cJSON_AddNumberToObject(status, "required_players", match->player_count);
     
     cJSON *players = cJSON_CreateArray();
-    for (int i = 0; i < g_r2.player_count; i++) {
+    for (int i = 0; i < ctx->core.seat_count; i++) {
         cJSON *p = cJSON_CreateObject();
-        cJSON_AddNumberToObject(p, "account_id", g_r2.players[i].account_id);
-        cJSON_AddBoolToObject(p, "ready", g_r2.players[i].ready);
+        cJSON_AddNumberToObject(p, "account_id", ctx->players[i].account_id);
+        cJSON_AddBoolToObject(p, "ready", ctx->players[i].ready);
         
-        MatchPlayerState *mp_state = get_match_player(g_r2.players[i].account_id);
+        MatchPlayerState *mp_state = round_player(&ctx->core, ctx->players[i].account_id);
         if (mp_state) {
             cJSON_AddStringToObject(p, "name", mp_state->name);
         }
@@ -1097,10 +644,12 @@ static void handle_player_ready(int fd, MessageHeader *req, const char *payload)
     }
     cJSON_AddItemToObject(status, "players", players);
     
-    char *json = cJSON_PrintUnformatted(status);
+    Arena *arena = round_arena(&ctx->core);
+    ArenaMark mark = arena_mark(arena);
+    char *json = json_print_arena(status, arena);
     cJSON_Delete(status);
-    broadcast_json(req, OP_S2C_ROUND2_READY_STATUS, json);
-    free(json);
+    round_broadcast(&ctx->core, req, OP_S2C_ROUND2_READY_STATUS, json);
+    arena_rewind(arena, mark);
     
     // Check if all ready
     // Calculate expected players (non-eliminated)
@@ -1110,16 +659,16 @@ static void handle_player_ready(int fd, MessageHeader *req, const char *payload)
     }
     
     printf("[Round2] Check start: ready=%d, expected=%d, round_status=%d\n",
-           g_r2.ready_count, expected, round ? round->status : -1);
+           ctx->ready_count, expected, round ? round->status : -1);
            
     // Start when all non-eliminated players are ready
-    if (g_r2.ready_count >= expected && expected > 0 && round && round->status == ROUND_PENDING) {
+    if (ctx->ready_count >= expected && expected > 0 && round && round->status == ROUND_PENDING) {
         printf("[Round2] All ready, starting round\n");
         
         round->status = ROUND_PLAYING;
         round->started_at = time(NULL);
         round->current_question_idx = 0;
-        g_r2.is_active = true;
+        ctx->core.is_active = true;
         
         cJSON *start = cJSON_CreateObject();
         cJSON_AddTrueToObject(start, "success");
@@ -1127,15 +676,16 @@ static void handle_player_ready(int fd, MessageHeader *req, const char *payload)
         cJSON_AddNumberToObject(start, "round", 2);
         cJSON_AddNumberToObject(start, "total_products", round->question_count);
         cJSON_AddNumberToObject(start, "time_per_product_ms", TIME_PER_PRODUCT);
-        cJSON_AddNumberToObject(start, "player_count", g_r2.player_count);
+        cJSON_AddNumberToObject(start, "player_count", ctx->core.seat_count);
         
-        char *start_json = cJSON_PrintUnformatted(start);
+        mark = arena_mark(arena);
+        char *start_json = json_print_arena(start, arena);
         cJSON_Delete(start);
-        broadcast_json(req, OP_S2C_ROUND2_ALL_READY, start_json);
-        free(start_json);
+        round_broadcast(&ctx->core, req, OP_S2C_ROUND2_ALL_READY, start_json);
+        arena_rewind(arena, mark);
         
         // Send first product
-        broadcast_current_product(req);
+        broadcast_current_product(ctx, req);
     }
 }
 
@@ -1145,7 +695,7 @@ static void handle_player_ready(int fd, MessageHeader *req, const char *payload)
 
 static void handle_get_product(int fd, MessageHeader *req, const char *payload) {
     if (req->length < 8) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
         return;
     }
     
@@ -1155,34 +705,37 @@ static void handle_get_product(int fd, MessageHeader *req, const char *payload)
     match_id = ntohl(match_id);
     product_idx = ntohl(product_idx);
     
-    if (match_id != g_r2.match_id) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid match\"}");
+    R2_Context *ctx = find_context(match_id);
+    if (!ctx) {
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid match\"}");
         return;
     }
     
-    RoundState *round = get_round();
+    RoundState *round = round_state(&ctx->core);
     if (!round || round->status != ROUND_PLAYING) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Round not active\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Round not active\"}");
         return;
     }
     
     UserSession *session = session_get_by_socket(fd);
     if (session) {
-        MatchPlayerState *mp = get_match_player(session->account_id);
+        MatchPlayerState *mp = round_player(&ctx->core, session->account_id);
         if (mp && mp->eliminated) {
-            send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Player eliminated\"}");
+            round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Player eliminated\"}");
             return;
         }
     }
     
-    char *json = build_product_json(round->current_question_idx);
+    Arena *arena = round_arena(&ctx->core);
+    ArenaMark mark = arena_mark(arena);
+    char *json = build_product_json(ctx, round->current_question_idx, arena);
     if (!json) {
-        send_json(fd, req, ERR_SERVER_ERROR, "{\"success\":false,\"error\":\"Product not found\"}");
+        round_send_json(fd, req, ERR_SERVER_ERROR, "{\"success\":false,\"error\":\"Product not found\"}");
         return;
     }
     
-    send_json(fd, req, OP_S2C_ROUND2_PRODUCT, json);
-    free(json);
+    round_send_json(fd, req, OP_S2C_ROUND2_PRODUCT, json);
+    arena_rewind(arena, mark);
 }
 
 //==============================================================================
@@ -1192,7 +745,7 @@ static void handle_get_product(int fd, MessageHeader *req, const char *payload)
 
 static void handle_submit_bid(int fd, MessageHeader *req, const char *payload) {
     if (req->length < 16) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid payload\"}");
         return;
     }
     
@@ -1209,53 +762,55 @@ static void handle_submit_bid(int fd, MessageHeader *req, const char *payload) {
     
     printf("[Round2] Bid: product=%u bid=%lld\n", product_idx, (long long)bid_value);
     
-    if (match_id != g_r2.match_id) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid match\"}");
+    R2_Context *ctx = find_context(match_id);
+    if (!ctx) {
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Invalid match\"}");
         return;
     }
     
-    RoundState *round = get_round();
+    RoundState *round = round_state(&ctx->core);
     if (!round || round->status != ROUND_PLAYING) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Round not active\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Round not active\"}");
         return;
     }
     
     UserSession *session = session_get_by_socket(fd);
     if (!session) {
-        send_json(fd, req, ERR_NOT_LOGGED_IN, "{\"success\":false,\"error\":\"Not logged in\"}");
+        round_send_json(fd, req, ERR_NOT_LOGGED_IN, "{\"success\":false,\"error\":\"Not logged in\"}");
         return;
     }
     
-    MatchPlayerState *mp = get_match_player(session->account_id);
+    MatchPlayerState *mp = round_player(&ctx->core, session->account_id);
     if (!mp) {
-        send_json(fd, req, ERR_SERVER_ERROR, "{\"success\":false,\"error\":\"Player not in match\"}");
+        round_send_json(fd, req, ERR_SERVER_ERROR, "{\"success\":false,\"error\":\"Player not in match\"}");
         return;
     }
     
     if (mp->eliminated) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Player eliminated\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Player eliminated\"}");
         return;
     }
     
-    R2_PlayerBid *pb = find_player(session->account_id);
+    R2_PlayerBid *pb = find_player(ctx, session->account_id);
     if (!pb) {
-        send_json(fd, req, ERR_SERVER_ERROR, "{\"success\":false,\"error\":\"Player not in round\"}");
+        round_send_json(fd, req, ERR_SERVER_ERROR, "{\"success\":false,\"error\":\"Player not in round\"}");
         return;
     }
     
     if ((int)product_idx != round->current_question_idx) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Wrong product\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Wrong product\"}");
         return;
     }
     
     if (pb->has_bid) {
-        send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Already bid\"}");
+        round_send_json(fd, req, ERR_BAD_REQUEST, "{\"success\":false,\"error\":\"Already bid\"}");
         return;
     }
     
     // Store bid
     pb->bid_value = bid_value;
     pb->has_bid = true;
+    match_snapshot_answer(ctx->core.match, pb->account_id, MATCH_ANSWER_DONE, bid_value, 0);
     
     printf("[Round2] Player %d bid %lld for product %d\n", 
            session->account_id, (long long)bid_value, product_idx);
@@ -1266,8 +821,8 @@ static void handle_submit_bid(int fd, MessageHeader *req, const char *payload) {
     cJSON_AddNumberToObject(ack, "product_idx", product_idx);
     cJSON_AddNumberToObject(ack, "bid", bid_value);
     
-    int bid_count = count_bid();
-    int connected = count_connected();
+    int bid_count = count_bid(ctx);
+    int connected = round_connected_count(&ctx->core);
     cJSON_AddNumberToObject(ack, "bid_count", bid_count);
     cJSON_AddNumberToObject(ack, "player_count", connected);
     
@@ -1276,13 +831,13 @@ static void handle_submit_bid(int fd, MessageHeader *req, const char *payload) {
     
     char *json = cJSON_PrintUnformatted(ack);
     cJSON_Delete(ack);
-    send_json(fd, req, OP_S2C_ROUND2_BID_ACK, json);
+    round_send_json(fd, req, OP_S2C_ROUND2_BID_ACK, json);
     free(json);
     
     // If all bid, process results
     if (all_bid) {
         printf("[Round2] All %d players bid for product %d\n", connected, product_idx);
-        process_turn_results(req);
+        process_turn_results(ctx, req);
     }
 }
 
@@ -1290,23 +845,23 @@ static void handle_submit_bid(int fd, MessageHeader *req, const char *payload) {
 // DISCONNECT HANDLER
 //==============================================================================
 
-void handle_round2_disconnect(int client_fd) {
-    UserSession *session = session_get_by_socket(client_fd);
-    if (!session) return;
+void handle_round2_disconnect(int32_t account_id) {
+    MatchState *match = match_find_by_player(account_id);
+    R2_Context *ctx = match ? find_context(match->runtime_match_id) : NULL;
+    if (!ctx) return;
     
-    int32_t account_id = session->account_id;
-    R2_PlayerBid *pb = find_player(account_id);
+    R2_PlayerBid *pb = find_player(ctx, account_id);
     if (!pb) return;
     
     printf("[Round2] Player %d disconnected\n", account_id);
     
-    MatchPlayerState *mp = get_match_player(account_id);
+    MatchPlayerState *mp = round_player(&ctx->core, account_id);
     if (mp) {
         mp->connected = 0;
     }
     
-    int connected = count_connected();
-    int disconnected = count_disconnected();
+    int connected = round_connected_count(&ctx->core);
+    int disconnected = round_disconnected_count(&ctx->core);
     
     // Notify others
     cJSON *ntf = cJSON_CreateObject();
@@ -1323,35 +878,30 @@ void handle_round2_disconnect(int client_fd) {
     char *json = cJSON_PrintUnformatted(ntf);
     cJSON_Delete(ntf);
     
-    MessageHeader hdr = {0};
-    hdr.magic = htons(MAGIC_NUMBER);
-    hdr.version = PROTOCOL_VERSION;
-    hdr.command = htons(NTF_PLAYER_LEFT);
-    hdr.length = htonl((uint32_t)strlen(json));
+    MessageHeader hdr = {0};    // notifications carry seq_num 0
     
-    for (int i = 0; i < g_r2.player_count; i++) {
-        if (g_r2.players[i].account_id != account_id) {
-            int fd = get_socket(g_r2.players[i].account_id);
+    for (int i = 0; i < ctx->core.seat_count; i++) {
+        if (ctx->players[i].account_id != account_id) {
+            int fd = round_socket(&ctx->core, ctx->players[i].account_id);
             if (fd > 0) {
-                send(fd, &hdr, sizeof(hdr), 0);
-                send(fd, json, strlen(json), 0);
+                round_send_json(fd, &hdr, NTF_PLAYER_LEFT, json);
             }
         }
     }
     free(json);
     
     // Check if should end game
-    RoundState *round = get_round();
+    RoundState *round = round_state(&ctx->core);
     if (round && round->status == ROUND_PLAYING && disconnected >= 2) {
         printf("[Round2] Too many disconnections, ending game\n");
         
         round->status = ROUND_ENDED;
         round->ended_at = time(NULL);
-        g_r2.is_active = false;
+        ctx->core.is_active = false;
         
-        MatchState *match = get_match();
+        MatchState *match = ctx->core.match;
         if (match) {
-            match->status = MATCH_ENDED;
+            match_set_status(match, MATCH_ENDED);
         }
         
         cJSON *end = cJSON_CreateObject();
@@ -1361,14 +911,10 @@ void handle_round2_disconnect(int client_fd) {
         char *ejson = cJSON_PrintUnformatted(end);
         cJSON_Delete(end);
         
-        hdr.command = htons(OP_S2C_ROUND2_ALL_FINISHED);
-        hdr.length = htonl((uint32_t)strlen(ejson));
-        
-        for (int i = 0; i < g_r2.player_count; i++) {
-            int fd = get_socket(g_r2.players[i].account_id);
+        for (int i = 0; i < ctx->core.seat_count; i++) {
+            int fd = round_socket(&ctx->core, ctx->players[i].account_id);
             if (fd > 0) {
-                send(fd, &hdr, sizeof(hdr), 0);
-                send(fd, ejson, strlen(ejson), 0);
+                round_send_json(fd, &hdr, OP_S2C_ROUND2_ALL_FINISHED, ejson);
             }
         }
         free(ejson);
@@ -1376,11 +922,11 @@ void handle_round2_disconnect(int client_fd) {
     
     // Check if all remaining players have bid → process
     if (round && round->status == ROUND_PLAYING) {
-        int bid_count = count_bid();
+        int bid_count = count_bid(ctx);
         if (bid_count >= connected && connected > 0) {
             printf("[Round2] All remaining players bid, processing\n");
             MessageHeader dummy = {0};
-            process_turn_results(&dummy);
+            process_turn_results(ctx, &dummy);
         }
     }
 }
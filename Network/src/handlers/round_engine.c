@@ -0,0 +1,521 @@
+/**
+ * round_engine.c - Roster, session cache, ranking, elimination and the
+ * end-of-round transitions shared by round 1 / 2 / 3 (see round_engine.h)
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "handlers/round_engine.h"
+#include "handlers/match_manager.h"
+#include "handlers/bonus_handler.h"
+#include "handlers/end_game_handler.h"
+#include "handlers/spectator_handler.h"
+#include "db/repo/match_write_queue.h"
+#include "protocol/opcode.h"
+
+//==============================================================================
+// SESSION CACHE
+// One per match (MATCH_CTX_SESSIONS), indexed like MatchState.players.
+// An account holds at most one session slot and slots never move, so a
+// cached pointer is still right as long as the slot holds the same account;
+// otherwise the session table is scanned again.
+//==============================================================================
+
+typedef struct {
+    UserSession *session[MAX_MATCH_PLAYERS];
+} SessionCache;
+
+static UserSession* slot_session(MatchState *match, int slot) {
+    MatchPlayerState *mp = &match->players[slot];
+    if (mp->account_id <= 0) return NULL;
+
+    SessionCache *cache = match_context_get(match, MATCH_CTX_SESSIONS, sizeof(SessionCache), NULL);
+    if (!cache) return session_get_by_account(mp->account_id);
+
+    UserSession *s = cache->session[slot];
+    if (s && s->account_id == mp->account_id) return s;
+
+    s = session_get_by_account(mp->account_id);
+    cache->session[slot] = s;
+    return s;
+}
+
+static int slot_of(const MatchState *match, int32_t account_id) {
+    for (int i = 0; i < match->player_count; i++) {
+        if (match->players[i].account_id == account_id) return i;
+    }
+    return -1;
+}
+
+// Slot of account_id: roster first, then the match
+static int core_slot(const RoundCore *core, int32_t account_id) {
+    int seat = round_seat_find(core, account_id);
+    if (seat >= 0 && core->seats[seat].slot >= 0) return core->seats[seat].slot;
+    return core->match ? slot_of(core->match, account_id) : -1;
+}
+
+static bool session_connected(const UserSession *s) {
+    return s && s->state != SESSION_PLAYING_DISCONNECTED;
+}
+
+//==============================================================================
+// ROSTER
+//==============================================================================
+
+void round_core_bind(RoundCore *core, const RoundKind *kind, MatchState *match, int round_index) {
+    core->match = match;
+    core->match_id = match ? match->runtime_match_id : 0;
+    core->round_index = round_index;
+    core->kind = kind;
+}
+
+int round_seat_find(const RoundCore *core, int32_t account_id) {
+    for (int i = 0; i < core->seat_count; i++) {
+        if (core->seats[i].account_id == account_id) return i;
+    }
+    return -1;
+}
+
+int round_seat_add(RoundCore *core, int32_t account_id) {
+    int seat = round_seat_find(core, account_id);
+    if (seat >= 0) return seat;
+    if (core->seat_count >= MAX_MATCH_PLAYERS) return -1;
+
+    seat = core->seat_count++;
+    core->seats[seat].account_id = account_id;
+    core->seats[seat].slot = core->match ? slot_of(core->match, account_id) : -1;
+    return seat;
+}
+
+//==============================================================================
+// LOOKUPS
+//==============================================================================
+
+RoundState* round_state(const RoundCore *core) {
+    MatchState *match = core->match;
+    if (!match) return NULL;
+    if (core->round_index < 0 || core->round_index >= match->round_count) return NULL;
+    return &match->rounds[core->round_index];
+}
+
+MatchPlayerState* round_player(const RoundCore *core, int32_t account_id) {
+    int slot = core_slot(core, account_id);
+    return slot >= 0 ? &core->match->players[slot] : NULL;
+}
+
+UserSession* round_session(const RoundCore *core, int32_t account_id) {
+    int slot = core_slot(core, account_id);
+    return slot >= 0 ? slot_session(core->match, slot) : session_get_by_account(account_id);
+}
+
+bool round_connected(const RoundCore *core, int32_t account_id) {
+    return session_connected(round_session(core, account_id));
+}
+
+int round_socket(const RoundCore *core, int32_t account_id) {
+    UserSession *s = round_session(core, account_id);
+    return session_connected(s) ? s->socket_fd : -1;
+}
+
+int round_connected_count(const RoundCore *core) {
+    int count = 0;
+    for (int i = 0; i < core->seat_count; i++) {
+        if (round_connected(core, core->seats[i].account_id)) count++;
+    }
+    return count;
+}
+
+int round_disconnected_count(const RoundCore *core) {
+    return core->seat_count - round_connected_count(core);
+}
+
+Arena* round_arena(const RoundCore *core) {
+    return core->match ? &core->match->arena : NULL;
+}
+
+MatchPlayerState* round_match_player(MatchState *match, int32_t account_id) {
+    if (!match) return NULL;
+    int slot = slot_of(match, account_id);
+    return slot >= 0 ? &match->players[slot] : NULL;
+}
+
+UserSession* round_match_session(MatchState *match, int32_t account_id) {
+    int slot = match ? slot_of(match, account_id) : -1;
+    return slot >= 0 ? slot_session(match, slot) : session_get_by_account(account_id);
+}
+
+bool round_match_connected(MatchState *match, int32_t account_id) {
+    return session_connected(round_match_session(match, account_id));
+}
+
+int round_match_socket(MatchState *match, int32_t account_id) {
+    UserSession *s = round_match_session(match, account_id);
+    return session_connected(s) ? s->socket_fd : -1;
+}
+
+//==============================================================================
+// SEND
+//==============================================================================
+
+void round_send_json(int fd, MessageHeader *req, uint16_t cmd, const char *json) {
+    if (fd <= 0 || !json) return;
+    forward_response(fd, req, cmd, json, (uint32_t)strlen(json));
+}
+
+void round_broadcast(const RoundCore *core, MessageHeader *req, uint16_t cmd, const char *json) {
+    if (!json) return;
+    uint32_t len = (uint32_t)strlen(json);
+    for (int i = 0; i < core->seat_count; i++) {
+        int fd = round_socket(core, core->seats[i].account_id);
+        if (fd > 0) {
+            forward_response(fd, req, cmd, json, len);
+        }
+    }
+    spectator_forward(core->match_id, cmd, json);
+}
+
+//==============================================================================
+// RANKING
+//==============================================================================
+
+int round_rank(const RoundCore *core, int filter, bool ascending, RoundRank *out) {
+    int count = 0;
+    for (int i = 0; i < core->seat_count; i++) {
+        int32_t account_id = core->seats[i].account_id;
+        MatchPlayerState *mp = round_player(core, account_id);
+        if (!mp) continue;
+        if (filter == ROUND_RANK_IN_PLAY && (mp->eliminated || !round_connected(core, account_id))) {
+            continue;
+        }
+
+        // Insertion sort: stable, and the roster is MAX_MATCH_PLAYERS at most
+        RoundRank entry = { mp->account_id, mp->score };
+        int j = count++;
+        while (j > 0 && (ascending ? out[j - 1].score > entry.score
+                                   : out[j - 1].score < entry.score)) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = entry;
+    }
+    return count;
+}
+
+//==============================================================================
+// ELIMINATION
+//==============================================================================
+
+void round_eliminate(RoundCore *core, MatchPlayerState *mp, const char *reason) {
+    if (!mp) return;
+    const char *tag = core->kind->tag;
+    int round_no = core->round_index + 1;
+
+    mp->eliminated = 1;
+    mp->eliminated_at_round = round_no;
+    match_player_out(core->match, mp->account_id);
+
+    printf("%s Player %d ELIMINATED at round %d (reason: %s, score=%d)\n",
+           tag, mp->account_id, round_no, reason, mp->score);
+
+    // Notify the player (even if the session is marked disconnected) and
+    // send them back to the lobby so they can join another game
+    UserSession *session = round_session(core, mp->account_id);
+    int fd = session ? session->socket_fd : -1;
+    if (fd > 0) {
+        cJSON *ntf = cJSON_CreateObject();
+        cJSON_AddNumberToObject(ntf, "player_id", mp->account_id);
+        cJSON_AddStringToObject(ntf, "reason", reason);
+        cJSON_AddNumberToObject(ntf, "round", round_no);
+        cJSON_AddNumberToObject(ntf, "final_score", mp->score);
+        cJSON_AddStringToObject(ntf, "message", "You have been eliminated!");
+
+        char *json = cJSON_PrintUnformatted(ntf);
+        cJSON_Delete(ntf);
+        if (json) {
+            MessageHeader hdr = {0};
+            round_send_json(fd, &hdr, NTF_ELIMINATION, json);
+            printf("%s Sent NTF_ELIMINATION to player %d\n", tag, mp->account_id);
+            free(json);
+        }
+
+        session_mark_lobby(session);
+        printf("%s Changed player %d session state to LOBBY\n", tag, mp->account_id);
+    }
+
+    MatchState *match = core->match;
+    if (mp->account_id > 0 && match && match->db_match_id > 0) {
+        // Queued for write-behind; the round never waits on the DB
+        // Note: player_id in match_events refers to accounts.id, not match_players.id
+        match_wq_event(match->db_match_id, mp->account_id, "ELIMINATED", round_no, 0);
+        match_wq_player_update(match->db_match_id, mp->match_player_id,
+                               MWQ_SET_SCORE | MWQ_SET_ELIMINATED, mp->score, true, false);
+        printf("%s Queued elimination event for DB\n", tag);
+    }
+}
+
+bool round_eliminate_lowest(RoundCore *core) {
+    MatchState *match = core->match;
+    if (!match) return false;
+    const char *tag = core->kind->tag;
+
+    printf("%s Elimination mode - processing...\n", tag);
+
+    // Disconnected players are out first
+    for (int i = 0; i < core->seat_count; i++) {
+        int32_t account_id = core->seats[i].account_id;
+        MatchPlayerState *mp = round_player(core, account_id);
+        if (mp && !mp->eliminated && !round_connected(core, account_id)) {
+            round_eliminate(core, mp, "DISCONNECT");
+        }
+    }
+
+    RoundRank ranks[MAX_MATCH_PLAYERS];
+    int count = round_rank(core, ROUND_RANK_IN_PLAY, true, ranks);
+    if (count < 2) {
+        printf("%s Only %d connected players remaining, no further elimination\n", tag, count);
+        return false;
+    }
+
+    // >= 2 tied at the lowest score: the bonus round picks who goes
+    int lowest = ranks[0].score;
+    int tie_count = 1;
+    while (tie_count < count && ranks[tie_count].score == lowest) tie_count++;
+    if (tie_count >= 2) {
+        printf("%s %d players tied at lowest (%d), triggering bonus round\n", tag, tie_count, lowest);
+        return check_and_trigger_bonus(match->runtime_match_id, core->kind->number);
+    }
+
+    round_eliminate(core, round_player(core, ranks[0].account_id), "LOWEST_SCORE");
+    return false;
+}
+
+bool round_match_advance(MatchState *match, const char *tag) {
+    if (!match || match->current_round_idx >= match->round_count - 1) return false;
+
+    match->current_round_idx++;
+    printf("%s Advanced to round %d\n", tag, match->current_round_idx + 1);
+
+    RoundState *next = &match->rounds[match->current_round_idx];
+    next->status = ROUND_PENDING;
+    next->current_question_idx = 0;
+    return true;
+}
+
+//==============================================================================
+// ROUND END FRAME
+// Format matches Frontend expectations: players[] (rankings[] kept for
+// older clients), "id" not "account_id", name, progress counters
+//==============================================================================
+
+char* round_end_json(RoundCore *core) {
+    MatchState *match = core->match;
+    if (!match) return NULL;
+    const RoundKind *kind = core->kind;
+
+    cJSON *obj = cJSON_CreateObject();
+    cJSON_AddTrueToObject(obj, "success");
+    cJSON_AddNumberToObject(obj, "match_id", core->match_id);
+    cJSON_AddNumberToObject(obj, "round", kind->number);
+
+    int connected = round_connected_count(core);
+    int disconnected = core->seat_count - connected;
+    int finished = kind->finished_count ? kind->finished_count(core) : core->seat_count;
+
+    cJSON_AddNumberToObject(obj, "connected_count", connected);
+    cJSON_AddNumberToObject(obj, "disconnected_count", disconnected);
+    cJSON_AddNumberToObject(obj, "finished_count", finished);
+    cJSON_AddNumberToObject(obj, "player_count", core->seat_count);
+
+    bool can_continue = (disconnected < 2);
+    cJSON_AddBoolToObject(obj, "can_continue", can_continue);
+
+    if (disconnected >= 2) {
+        cJSON_AddStringToObject(obj, "status_message", "Game ended - too many disconnections");
+    } else if (disconnected == 1) {
+        cJSON_AddStringToObject(obj, "status_message", "1 disconnected - no elimination");
+    } else {
+        cJSON_AddStringToObject(obj, "status_message", "Round completed");
+    }
+
+    if (kind->end_fields) kind->end_fields(core, obj);
+
+    // current_round_idx was already advanced to the next round (1-based here)
+    int next_round = 0;
+    if (!kind->final && match->current_round_idx < match->round_count) {
+        next_round = match->current_round_idx + 1;
+    }
+    cJSON_AddNumberToObject(obj, "next_round", next_round);
+    cJSON_AddNumberToObject(obj, "current_round", kind->number);
+
+    RoundRank ranks[MAX_MATCH_PLAYERS];
+    int count = round_rank(core, ROUND_RANK_ALL, false, ranks);
+
+    cJSON *players = cJSON_CreateArray();
+    for (int i = 0; i < count; i++) {
+        MatchPlayerState *mp = round_player(core, ranks[i].account_id);
+        if (!mp) continue;
+
+        cJSON *p = cJSON_CreateObject();
+        cJSON_AddNumberToObject(p, "id", mp->account_id);
+        cJSON_AddNumberToObject(p, "rank", i + 1);
+        cJSON_AddNumberToObject(p, "score", mp->score);
+        cJSON_AddBoolToObject(p, "connected", round_connected(core, mp->account_id));
+        cJSON_AddBoolToObject(p, "eliminated", mp->eliminated != 0);
+        cJSON_AddStringToObject(p, "name", mp->name);
+        cJSON_AddItemToArray(players, p);
+    }
+    cJSON_AddItemToObject(obj, "players", players);
+    cJSON_AddItemToObject(obj, "rankings", cJSON_Duplicate(players, 1));
+
+    char *json = cJSON_PrintUnformatted(obj);
+    cJSON_Delete(obj);
+    return json;
+}
+
+//==============================================================================
+// END OF ROUND: TRANSITION TABLE
+// settle: decides the step for (kind->final, match mode), eliminating /
+// triggering the bonus round on the way. k_steps: what each step does.
+//==============================================================================
+
+static int active_players(const MatchState *match, int32_t *last_active) {
+    int count = 0;
+    for (int i = 0; i < match->player_count; i++) {
+        if (!match->players[i].eliminated && !match->players[i].forfeited) {
+            count++;
+            *last_active = match->players[i].account_id;
+        }
+    }
+    return count;
+}
+
+// MODE_SCORING, rounds 1-2: disconnected players scored 0 this round but
+// are not eliminated, they can rejoin for the next one
+static RoundEndStep settle_scoring(RoundCore *core) {
+    const char *tag = core->kind->tag;
+    printf("%s Scoring mode - disconnected players get 0 points this round\n", tag);
+    for (int i = 0; i < core->seat_count; i++) {
+        int32_t account_id = core->seats[i].account_id;
+        if (!round_connected(core, account_id)) {
+            printf("%s Player %d disconnected - 0 points (can rejoin next round)\n", tag, account_id);
+        }
+    }
+    printf("%s Scoring mode - no elimination\n", tag);
+    return ROUND_END_NEXT_ROUND;
+}
+
+// MODE_ELIMINATION, rounds 1-2: lowest scorer out (or bonus round on a tie)
+static RoundEndStep settle_elimination(RoundCore *core) {
+    return round_eliminate_lowest(core) ? ROUND_END_BONUS : ROUND_END_NEXT_ROUND;
+}
+
+// MODE_SCORING, last round: a tie at the top goes to the bonus round
+static RoundEndStep settle_final_scoring(RoundCore *core) {
+    if (check_and_trigger_bonus(core->match_id, core->kind->number)) {
+        printf("%s Bonus round triggered for scoring mode tie\n", core->kind->tag);
+        return ROUND_END_BONUS;
+    }
+    printf("%s GAME OVER - No tie, ending game\n", core->kind->tag);
+    return ROUND_END_FINAL;
+}
+
+// MODE_ELIMINATION, last round: the lowest scorer goes as in rounds 1-2.
+// There is no round left to play the others out, so the score decides
+// between whoever is still in: a tie at the top goes to the bonus round
+// (its winner ends the match), everyone below the top is eliminated.
+static RoundEndStep settle_final_elimination(RoundCore *core) {
+    const char *tag = core->kind->tag;
+    int32_t last_active = -1;
+    int active = active_players(core->match, &last_active);
+    printf("%s Elimination mode: %d active players remaining\n", tag, active);
+
+    if (active <= 1) {
+        printf("%s GAME OVER - Player %d is the winner!\n", tag, last_active);
+        return ROUND_END_GAME_OVER;
+    }
+
+    if (round_eliminate_lowest(core)) return ROUND_END_BONUS;
+
+    if (active_players(core->match, &last_active) <= 1) {
+        printf("%s GAME OVER after elimination - Player %d wins!\n", tag, last_active);
+        return ROUND_END_GAME_OVER;
+    }
+
+    if (check_and_trigger_bonus(core->match_id, core->kind->number)) {
+        printf("%s Tie at the top, bonus round picks the winner\n", tag);
+        return ROUND_END_BONUS;
+    }
+
+    RoundRank ranks[MAX_MATCH_PLAYERS];
+    int count = round_rank(core, ROUND_RANK_IN_PLAY, false, ranks);
+    for (int i = 1; i < count; i++) {
+        round_eliminate(core, round_player(core, ranks[i].account_id), "FINAL_SCORE");
+    }
+    printf("%s GAME OVER on score - Player %d wins with %d\n", tag,
+           count > 0 ? ranks[0].account_id : -1, count > 0 ? ranks[0].score : 0);
+    return ROUND_END_GAME_OVER;
+}
+
+typedef RoundEndStep (*round_settle_fn)(RoundCore *core);
+
+static const round_settle_fn k_settle[2][2] = {     // [final][mode]
+    [false] = { [MODE_ELIMINATION] = settle_elimination,
+                [MODE_SCORING]     = settle_scoring },
+    [true]  = { [MODE_ELIMINATION] = settle_final_elimination,
+                [MODE_SCORING]     = settle_final_scoring },
+};
+
+static const struct {
+    bool advance;       // next round becomes PENDING
+    bool broadcast;     // round end frame to players and spectators
+    bool end_game;      // trigger_end_game, no bonus winner
+} k_steps[ROUND_END_STEP_COUNT] = {
+    [ROUND_END_NEXT_ROUND] = { true,  true,  false },
+    [ROUND_END_BONUS]      = { false, false, false },
+    [ROUND_END_GAME_OVER]  = { false, false, true  },
+    [ROUND_END_FINAL]      = { false, true,  true  },
+    [ROUND_END_HOLD]       = { false, true,  false },
+};
+
+RoundEndStep round_finish(RoundCore *core, MessageHeader *req) {
+    MatchState *match = core->match;
+    if (!match) return ROUND_END_HOLD;
+    const RoundKind *kind = core->kind;
+
+    RoundState *round = round_state(core);
+    if (round) {
+        round->status = ROUND_ENDED;
+        round->ended_at = time(NULL);
+    }
+    core->is_active = false;
+
+    int mode = match->mode == MODE_SCORING ? MODE_SCORING : MODE_ELIMINATION;
+    RoundEndStep step = k_settle[kind->final ? 1 : 0][mode](core);
+
+    if (step == ROUND_END_BONUS) {
+        // The bonus handler moves the match on once the cards are drawn
+        printf("%s Bonus round active - waiting for bonus to complete\n", kind->tag);
+        return step;
+    }
+
+    if (k_steps[step].advance) {
+        round_match_advance(match, kind->tag);
+    }
+    if (k_steps[step].broadcast) {
+        char *json = round_end_json(core);
+        if (json) {
+            printf("%s Round end JSON: %s\n", kind->tag, json);
+            round_broadcast(core, req, kind->all_finished_cmd, json);
+            free(json);
+        } else {
+            printf("%s ERROR: round_end_json returned NULL!\n", kind->tag);
+        }
+    }
+    if (k_steps[step].end_game) {
+        trigger_end_game(core->match_id, -1);
+    }
+    return step;
+}
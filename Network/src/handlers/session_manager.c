@@ -99,7 +99,8 @@ UserSession* session_bind_after_login(int socket_fd, int32_t account_id, const c
         case SESSION_UNAUTHENTICATED: {
             // Force logout old (not in match) per workflow: only one active session when idle
             // Only kick if it's a DIFFERENT socket (avoid kicking ourselves on FD reuse)
-            if (existing->socket_fd != socket_fd) {
+            // that is still open (a disconnect zeroes socket_fd)
+            if (existing->socket_fd > 0 && existing->socket_fd != socket_fd) {
                 force_logout_old_socket(existing, req);
             }
             // Rebind to new socket
@@ -122,7 +123,8 @@ UserSession* session_bind_after_login(int socket_fd, int32_t account_id, const c
             existing->state = SESSION_PLAYING;
             existing->last_active = now;
             existing->grace_deadline = 0;
-            // TODO: send GAME_STATE here
+            // The caller queues NTF_GAME_STATE (match_snapshot_request) once
+            // its login / reconnect response is out
             return existing;
         }
         default:
@@ -144,6 +146,9 @@ void session_mark_lobby(UserSession *s) {
 
 void session_mark_disconnected(UserSession *s) {
     if (!s) return;
+    // The fd number is free for the next client from now on: a stale slot
+    // must not answer for it (session_get_by_socket / session_validate_socket)
+    s->socket_fd = 0;
     if (s->state == SESSION_PLAYING) {
         s->state = SESSION_PLAYING_DISCONNECTED;
         s->grace_deadline = time(NULL) + RECONNECT_GRACE_SEC;
@@ -160,6 +165,45 @@ void session_touch(int socket_fd) {
     if (s) s->last_active = time(NULL);
 }
 
+bool session_validate_socket(int socket_fd, const char *session_id) {
+    if (socket_fd <= 0 || !session_id) return false;
+    for (int i = 0; i < MAX_SESSIONS; i++) {
+        UserSession *s = &g_sessions[i];
+        // fd and session id together: another slot may still hold this fd
+        if (s->socket_fd != socket_fd || strcmp(s->session_id, session_id) != 0) continue;
+        if (s->state != SESSION_LOBBY && s->state != SESSION_PLAYING) return false;
+        s->last_active = time(NULL);
+        return true;
+    }
+    return false;
+}
+
+void session_revoke(UserSession *s) {
+    if (!s || s->account_id == 0) return;
+    printf("[SESSION] Revoking session account_id=%d\n", s->account_id);
+
+    // Write-through: the DB row goes away with the in-memory one
+    if (strlen(s->session_id) > 0) {
+        session_delete(s->session_id);
+    }
+
+    // The fd may have been reused by another client: only drop our binding
+    const char *bound = get_client_session(s->socket_fd);
+    if (bound && strcmp(bound, s->session_id) == 0) {
+        clear_client_session(s->socket_fd);
+    }
+    session_destroy(s);
+}
+
+void session_revoke_account(int32_t account_id) {
+    UserSession *s = session_get_by_account(account_id);
+    if (s) {
+        session_revoke(s);
+    } else if (account_id > 0) {
+        session_delete_by_account(account_id);
+    }
+}
+
 void session_cleanup_dead_sessions(void) {
     time_t now = time(NULL);
     for (int i = 0; i < MAX_SESSIONS; i++) {
@@ -167,13 +211,13 @@ void session_cleanup_dead_sessions(void) {
         if (s->account_id == 0) continue;
 
         if (s->state == SESSION_LOBBY || s->state == SESSION_UNAUTHENTICATED) {
-            // Only cleanup sessions idle for more than 6 minutes
-            if (s->last_active && now - s->last_active > IDLE_SESSION_TIMEOUT_SEC) {
+            // Only cleanup sessions idle for more than 6 minutes whose socket
+            // is gone (disconnect drops the fd binding)
+            const char *bound = get_client_session(s->socket_fd);
+            bool connected = bound && strcmp(bound, s->session_id) == 0;
+            if (!connected && s->last_active && now - s->last_active > IDLE_SESSION_TIMEOUT_SEC) {
                 // remove idle dead session
-                if (strlen(s->session_id) > 0) {
-                    session_delete(s->session_id);
-                }
-                session_destroy(s);
+                session_revoke(s);
             }
         } else if (s->state == SESSION_PLAYING_DISCONNECTED) {
             if (s->grace_deadline && now > s->grace_deadline) {
@@ -181,10 +225,7 @@ void session_cleanup_dead_sessions(void) {
                 printf("[SESSION] Grace timeout → forfeit account_id=%d\n", s->account_id);
                 // Remove from any rooms and notify members
                 room_remove_member_all(s->socket_fd);
-                if (strlen(s->session_id) > 0) {
-                    session_delete(s->session_id);
-                }
-                session_destroy(s);
+                session_revoke(s);
             }
         }
     }
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <cjson/cJSON.h>
+
+#include "handlers/spectator_handler.h"
+#include "handlers/match_manager.h"
+#include "handlers/match_executor.h"
+#include "handlers/match_snapshot.h"
+#include "handlers/session_context.h"
+#include "transport/spectator_hub.h"
+#include "utils/json_utils.h"
+#include "protocol/opcode.h"
+
+//==============================================================================
+// HELPERS
+//==============================================================================
+
+static void send_error(int fd, MessageHeader *req, uint16_t code, const char *error) {
+    char json[128];
+    snprintf(json, sizeof(json), "{\"success\":false,\"error\":\"%s\"}", error);
+    forward_response(fd, req, code, json, (uint32_t)strlen(json));
+}
+
+static bool is_player(const MatchState *match, int32_t account_id) {
+    for (int i = 0; i < match->player_count; i++) {
+        if (match->players[i].account_id == account_id) return true;
+    }
+    return false;
+}
+
+// Public room, or the caller gave the private room's code
+static bool may_watch(const MatchState *match, const char code[8]) {
+    if (!match->private_room) return true;
+    return match->room_code[0] != '\0' && strncmp(code, match->room_code, 8) == 0;
+}
+
+// Scores of every player, built in the match arena
+static char* build_scoreboard_json(MatchState *match) {
+    cJSON *obj = cJSON_CreateObject();
+    cJSON_AddNumberToObject(obj, "match_id", match->runtime_match_id);
+    cJSON_AddNumberToObject(obj, "round", match->current_round_idx + 1);
+
+    cJSON *players = cJSON_AddArrayToObject(obj, "players");
+    for (int i = 0; i < match->player_count; i++) {
+        const MatchPlayerState *mp = &match->players[i];
+        cJSON *p = cJSON_CreateObject();
+        cJSON_AddNumberToObject(p, "id", mp->account_id);
+        cJSON_AddStringToObject(p, "name", mp->name);
+        cJSON_AddNumberToObject(p, "score", mp->score);
+        cJSON_AddBoolToObject(p, "eliminated", mp->eliminated);
+        cJSON_AddItemToArray(players, p);
+    }
+
+    char *json = json_print_arena(obj, &match->arena);
+    cJSON_Delete(obj);
+    return json;
+}
+
+//==============================================================================
+// BROADCASTS
+//==============================================================================
+
+void spectator_forward(uint32_t match_id, uint16_t cmd, const char *json) {
+    if (!json || !spectator_hub_watched(match_id)) return;
+
+    spectator_hub_publish(match_id, cmd, json, (uint32_t)strlen(json));
+
+    MatchState *match = match_get_by_id(match_id);
+    if (!match) return;
+
+    ArenaMark mark = arena_mark(&match->arena);
+    char *scores = build_scoreboard_json(match);
+    if (scores) {
+        spectator_hub_publish_scores(match_id, NTF_SCOREBOARD, scores, (uint32_t)strlen(scores));
+    }
+    arena_rewind(&match->arena, mark);
+}
+
+//==============================================================================
+// COMMANDS
+//==============================================================================
+
+void handle_spectate(int client_fd, MessageHeader *req, const char *payload) {
+    if (!payload || req->length < sizeof(uint32_t)) {
+        send_error(client_fd, req, ERR_BAD_REQUEST, "Invalid payload");
+        return;
+    }
+
+    SpectateRequest request = {0};
+    memcpy(&request, payload, req->length < sizeof(request) ? req->length : sizeof(request));
+    uint32_t match_id = ntohl(request.match_id);
+    uint32_t room_id = ntohl(request.room_id);
+
+    MatchState *match = match_id ? match_get_by_id(match_id) : match_get_by_room(room_id);
+    // Routed here only when a live match owns the request (see dispatcher)
+    if (!match || match->status == MATCH_ENDED || !match_exec_on_shard()) {
+        send_error(client_fd, req, ERR_NOT_FOUND, "Match not found");
+        return;
+    }
+
+    int32_t account_id = get_client_account(client_fd);
+    if (is_player(match, account_id)) {
+        send_error(client_fd, req, ERR_BAD_REQUEST, "Players cannot spectate their own match");
+        return;
+    }
+    if (!may_watch(match, request.room_code)) {
+        printf("[SPECTATOR] Account %d refused on private match %u: wrong room code\n",
+               account_id, match->runtime_match_id);
+        send_error(client_fd, req, ERR_FORBIDDEN, "Private room: room code required");
+        return;
+    }
+
+    ArenaMark mark = arena_mark(&match->arena);
+    char *json = match_snapshot_render(match, account_id);
+    bool ok = json && spectator_hub_subscribe(match->runtime_match_id, client_fd, account_id,
+                                              req, RES_SPECTATING, json, (uint32_t)strlen(json));
+    arena_rewind(&match->arena, mark);
+
+    if (!ok) {
+        printf("[SPECTATOR] Account %d could not watch match %u\n",
+               account_id, match->runtime_match_id);
+        send_error(client_fd, req, ERR_SERVICE_UNAVAILABLE, "Cannot spectate this match now");
+        return;
+    }
+    printf("[SPECTATOR] Account %d (fd=%d) watches match %u\n",
+           account_id, client_fd, match->runtime_match_id);
+}
+
+void handle_spectate_leave(int client_fd, MessageHeader *req, const char *payload) {
+    uint32_t match_id = 0;
+    if (payload && req->length >= sizeof(match_id)) {
+        memcpy(&match_id, payload, sizeof(match_id));
+        match_id = ntohl(match_id);
+    }
+
+    spectator_hub_leave(match_id, client_fd);
+    if (match_id) {
+        printf("[SPECTATOR] fd=%d stopped watching match %u\n", client_fd, match_id);
+    } else {
+        printf("[SPECTATOR] fd=%d stopped watching every match\n", client_fd);
+    }
+}
@@ -6,11 +6,29 @@
 #include "handlers/start_game_handler.h"
 #include "handlers/session_manager.h"
 #include "handlers/match_manager.h"
+#include "handlers/match_question.h"
+#include "utils/json_utils.h"
 #include "transport/socket_server.h"
 #include "transport/room_manager.h"
 #include "protocol/opcode.h"
 #include "db/repo/match_repo.h"
 #include "db/repo/question_repo.h"
+#include "db/repo/match_write_queue.h"
+
+// A start that fails after the match exists: tell the host, put the
+// players back in the lobby, close the matches row and drop the match
+static void abort_start(int client_fd, MessageHeader *req, MatchState *match) {
+    printf("[HANDLER] <startgame> Aborting start of match %u\n", match->runtime_match_id);
+    forward_response(client_fd, req, ERR_SERVER_ERROR, "Failed to start game", 20);
+
+    for (int i = 0; i < match->player_count; i++) {
+        UserSession *session = session_get_by_account(match->players[i].account_id);
+        if (session && session->state == SESSION_PLAYING) session_mark_lobby(session);
+    }
+
+    match_wq_match_ended(match->db_match_id, time(NULL));
+    match_destroy(match->runtime_match_id);
+}
 
 void handle_start_game(int client_fd, MessageHeader *req, const char *payload) {
     if (req->length != sizeof(StartGameRequest)) {
@@ -117,46 +135,52 @@ void handle_start_game(int client_fd, MessageHeader *req, const char *payload) {
     }
 
     // =========================================================================
-    // STEP 1: CREATE MATCH REALTIME (In-memory MatchState)
+    // STEP 1: CREATE MATCH (DB row first, then in-memory MatchState)
     // =========================================================================
-    // Generate temporary match ID
-    time_t now = time(NULL);
-    uint32_t match_id = (uint32_t)(now * 1000 + room_id);
-    
-    // Create match via match manager
-    MatchState *match = match_create(match_id, room_id);
+    // Without its matches row none of the match could be persisted (answers,
+    // scores, points): refuse the start instead, e.g. while the DB is down.
+    // This and the match_players / match_question inserts below run on the
+    // event loop; DB_STATEMENT_TIMEOUT_MS bounds each of them.
+    int64_t db_match_id = 0;
+    const char *mode_str = (room->mode == MODE_ELIMINATION) ? "elimination" : "scoring";
+
+    db_error_t db_rc = db_match_insert(room_id, mode_str, player_count, &db_match_id);
+    if (db_rc != DB_OK || db_match_id <= 0) {
+        printf("[HANDLER] <startgame> Error: Failed to insert match into DB (rc=%d)\n", db_rc);
+        forward_response(client_fd, req, ERR_SERVICE_UNAVAILABLE, "Database unavailable, try again", 31);
+        return;
+    }
+    printf("[HANDLER] <startgame> Match saved to database (db_match_id=%lld, mode=%s)\n",
+           (long long)db_match_id, mode_str);
+
+    // Create match via match manager (runtime ID is generated there); from
+    // here on its players are routed to it
+    int32_t player_ids[MAX_ROOM_MEMBERS];
+    for (int i = 0; i < player_count; i++) {
+        player_ids[i] = room->players[i].account_id;
+    }
+    MatchState *match = match_create(room_id, player_ids, player_count);
     if (!match) {
         printf("[HANDLER] <startgame> Failed to create match\n");
+        forward_response(client_fd, req, ERR_SERVER_ERROR, "Failed to start game", 20);
+        match_wq_match_ended(db_match_id, time(NULL));
         return;
     }
+    match->db_match_id = db_match_id;
 
     // ⭐ IMPORTANT: Copy game mode from room to match
     match->mode = room->mode;
+    match->private_room = room->visibility == ROOM_PRIVATE;
+    snprintf(match->room_code, sizeof(match->room_code), "%.*s", (int)sizeof(room->code), room->code);
 
     printf("[HANDLER] <startgame> Step 1: Match created via manager (ID: %u, mode=%s)\n", 
            match->runtime_match_id, room->mode == MODE_ELIMINATION ? "elimination" : "scoring");
 
-    // Insert match into database
-    int64_t db_match_id = 0;
-    const char *mode_str = (room->mode == MODE_ELIMINATION) ? "elimination" : "scoring";
-    
-    db_error_t db_rc = db_match_insert(room_id, mode_str, player_count, &db_match_id);
-    if (db_rc != DB_OK) {
-        printf("[HANDLER] <startgame> WARN: Failed to insert match into DB (rc=%d), continuing...\n", db_rc);
-        // Continue anyway - match exists in memory
-    } else {
-        match->db_match_id = db_match_id;
-        printf("[HANDLER] <startgame> Match saved to database (db_match_id=%lld, mode=%s)\n", 
-               (long long)db_match_id, mode_str);
-    }
-
     // =========================================================================
     // STEP 2: ADD PLAYERS to MatchState
     // =========================================================================
-    match->player_count = room->player_count; // Use actual room player count
-    
+    // match_create() already set player_count and the account ids
     for (int i = 0; i < match->player_count; i++) {
-        match->players[i].account_id = room->players[i].account_id;
         match->players[i].score = 0;
         match->players[i].connected = room->players[i].connected ? 1 : 0;
         
@@ -173,12 +197,6 @@ void handle_start_game(int client_fd, MessageHeader *req, const char *payload) {
 
     // Insert match_players into database
     if (match->db_match_id > 0) {
-        // Collect account IDs into array for DB call
-        int32_t player_ids[MAX_ROOM_MEMBERS];
-        for(int i=0; i<match->player_count; i++) {
-            player_ids[i] = match->players[i].account_id;
-        }
-    
         db_error_t player_rc = db_match_players_insert(match->db_match_id, player_ids, match->player_count);
         if (player_rc != DB_OK) {
             printf("[HANDLER] <startgame> WARN: Failed to insert match_players (rc=%d)\n", player_rc);
@@ -303,7 +321,7 @@ void handle_start_game(int client_fd, MessageHeader *req, const char *payload) {
             printf("[HANDLER] <startgame> ERROR: Failed to load questions for round %d (rc=%d)\n", 
                    r + 1, db_rc);
             if (excluded_ids) free(excluded_ids);
-            match_destroy(match->runtime_match_id);
+            abort_start(client_fd, req, match);
             return;
         }
         
@@ -325,12 +343,24 @@ void handle_start_game(int client_fd, MessageHeader *req, const char *payload) {
                 cJSON_DeleteItemFromObject(question_obj, "content");
             }
 
-            mq->json_data = cJSON_PrintUnformatted(question_obj);
+            mq->json_data = json_print_arena(question_obj, &match->arena);
+
+            // Decode once: typed answer fields + pre-rendered client payload
+            if (!mq->json_data ||
+                match_question_decode(mq, question_obj, round->type, &match->arena) != 0) {
+                printf("[HANDLER] <startgame> ERROR: Failed to decode question %d of round %d\n",
+                       q + 1, r + 1);
+                cJSON_Delete(questions_json);
+                if (excluded_ids) free(excluded_ids);
+                abort_start(client_fd, req, match);
+                return;
+            }
             
             // Initialize question state
             QuestionState *qs = &round->questions[q];
             cJSON *id_field = cJSON_GetObjectItem(question_obj, "id");
             qs->question_id = id_field ? id_field->valueint : 0;
+            qs->source_id = qs->question_id;    // question_id is replaced in step 6
             qs->status = QUESTION_PENDING;
             qs->answered_count = 0;
             qs->correct_count = 0;
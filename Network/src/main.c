@@ -7,6 +7,19 @@
 
 #include "transport/socket_server.h"
 #include "db/core/db_client.h"   // 🔹 THÊM
+#include "db/repo/match_write_queue.h"
+#include "db/repo/question_bank.h"
+#include "db/repo/recent_questions.h"
+#include "db/repo/account_cache.h"
+#include "db/repo/friend_graph.h"
+#include "db/repo/replay_cache.h"
+#include "db/repo/user_index.h"
+#include "db/repo/leaderboard.h"
+#include "handlers/match_executor.h"
+#include "handlers/match_manager.h"
+#include "handlers/matchmaking.h"
+#include "transport/spectator_hub.h"
+#include "utils/startup.h"
 
 //==============================================================================
 // USAGE
@@ -20,50 +33,10 @@ static void print_usage(const char *prog_name) {
 }
 
 //==============================================================================
-// MAIN
+// ZOMBIE ROOM CLEANUP
 //==============================================================================
 
-int main(int argc, char *argv[]) {
-    setvbuf(stdout, NULL, _IONBF, 0);
-
-    for (int i = 1; i < argc; i++) {
-        if ((strcmp(argv[i], "-h") == 0) || (strcmp(argv[i], "--help") == 0)) {
-            print_usage(argv[0]);
-            return 0;
-        } else {
-            fprintf(stderr, "Unknown option: %s\n", argv[i]);
-            print_usage(argv[0]);
-            return 1;
-        }
-    }
-
-    printf("=============================================\n");
-    printf("        NETWORK SOCKET SERVER START           \n");
-    printf("=============================================\n");
-    printf("Press Ctrl+C to stop\n\n");
-
-    // Initialize random seed once
-    srand(time(NULL));
-
-    // =====================================================
-    // 🔹 INIT DB CLIENT (CHỈ 1 LẦN)
-    // =====================================================
-    printf("[DB] init...\n");
-    if (db_client_init() != DB_OK) {
-        fprintf(stderr, "[DB] init FAILED\n");
-        return 1;
-    }
-    printf("[DB] init OK\n");
-    
-    if (db_ping() == 0) {
-        printf("[DB] Supabase reachable\n");
-    } else {
-        printf("[DB] Supabase NOT reachable\n");
-    }
-
-    // =====================================================
-    // 🔹 CLEANUP ZOMBIE ROOMS FROM PREVIOUS RUN
-    // =====================================================
+static int cleanup_zombie_rooms(void) {
     printf("[DB] Cleaning zombie rooms from previous run...\n");
     
     // Close all rooms that were waiting or playing
@@ -72,6 +45,7 @@ int main(int argc, char *argv[]) {
     cJSON *response = NULL;
     
     db_error_t rc = db_patch("rooms", "status IN ('waiting', 'playing')", payload, &response);
+    int ok = (rc == DB_OK);
     
     if (rc == DB_OK) {
         printf("[DB] Closed zombie rooms\n");
@@ -85,6 +59,7 @@ int main(int argc, char *argv[]) {
     // Clear all room members
     response = NULL;
     rc = db_delete("room_members", "room_id > 0", &response);
+    ok = ok && (rc == DB_OK);
     
     if (rc == DB_OK) {
         printf("[DB] Cleared room members\n");
@@ -94,14 +69,137 @@ int main(int argc, char *argv[]) {
     
     if (response) cJSON_Delete(response);
     printf("[DB] Cleanup complete\n");
+    return ok ? 0 : -1;
+}
+
+// Deferred variant for a degraded start: run once, on the first reconnect
+static void cleanup_zombie_rooms_on_reconnect(void) {
+    db_client_on_reconnect(NULL);
+    cleanup_zombie_rooms();
+}
+
+//==============================================================================
+// STARTUP STEPS (run on the startup pipeline, see utils/startup.h)
+//==============================================================================
+
+static int connect_db(void) {
+    printf("[DB] init...\n");
+    db_error_t db_rc = db_client_init();
+    if (db_rc != DB_OK) {
+        // Degraded start: serve from memory, reconnect in the background
+        printf("[DB] Warning: database unavailable (rc=%d), starting in degraded mode\n", db_rc);
+        db_client_on_reconnect(cleanup_zombie_rooms_on_reconnect);
+        return -1;
+    }
+    printf("[DB] init OK\n");
+
+    if (db_ping() == 0) {
+        printf("[DB] Supabase reachable\n");
+    } else {
+        printf("[DB] Supabase NOT reachable\n");
+    }
+    return 0;
+}
+
+static int zombie_cleanup_task(void) {
+    // Degraded start: deferred to the first reconnect
+    if (!startup_db_available()) return 0;
+    return cleanup_zombie_rooms();
+}
+
+static int recent_questions_task(void) {
+    if (!startup_db_available()) return 0;
+    return recent_questions_preload();
+}
+
+// Retried by the pipeline until it loads (degraded start included)
+static int user_index_task(void) {
+    return user_index_preload();
+}
+
+static int leaderboard_task(void) {
+    if (!startup_db_available()) return 0;
+    return leaderboard_preload();
+}
+
+// Loads even if the DB is down now: the refresh thread retries the load
+static int question_bank_task(void) {
+    return question_bank_init();
+}
+
+//==============================================================================
+// MAIN
+//==============================================================================
+
+int main(int argc, char *argv[]) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-h") == 0) || (strcmp(argv[i], "--help") == 0)) {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
 
+    printf("=============================================\n");
+    printf("        NETWORK SOCKET SERVER START           \n");
+    printf("=============================================\n");
+    printf("Press Ctrl+C to stop\n\n");
+
+    // Initialize random seed once
+    srand(time(NULL));
+
+    // Background writer for answers / events / match_players updates
+    match_wq_init();
+
+    // Shard threads owning the live matches (rounds, timers, disconnects)
+    if (match_exec_init() != 0) {
+        fprintf(stderr, "Failed to start match executor\n");
+        return 1;
+    }
+
+    // Writer fanning match frames out to spectators (off the shards)
+    if (spectator_hub_init() != 0) {
+        printf("[SPECTATOR] Spectating disabled\n");
+    }
+
+    // Bind the listener first; DB connect, cleanup and cache warm-up run
+    // on the startup pipeline while the event loop is already accepting
     initialize_server();
+
+    startup_add_task("zombie-room cleanup", zombie_cleanup_task, STARTUP_TASK_REQUIRED);
+    startup_add_task("question bank", question_bank_task, STARTUP_TASK_PRELOAD);
+    startup_add_task("recent questions", recent_questions_task, STARTUP_TASK_PRELOAD);
+    startup_add_task("user index", user_index_task, STARTUP_TASK_PRELOAD_RETRY);
+    startup_add_task("leaderboard", leaderboard_task, STARTUP_TASK_PRELOAD);
+    startup_run(connect_db);
+
     main_loop();
+    spectator_hub_shutdown();   // before the sockets close under the writer
     shutdown_server();
+    startup_join();
 
     // =====================================================
     // 🔹 CLEANUP DB CLIENT
     // =====================================================
+    match_exec_shutdown();
+    match_manager_cleanup();
+    matchmaking_report();
+    matchmaking_cleanup();
+    match_wq_shutdown();
+    question_bank_shutdown();
+    recent_questions_cleanup();
+    user_index_cleanup();
+    leaderboard_cleanup();
+    entity_cache_report();
+    entity_cache_clear();
+    friend_graph_clear();
+    replay_cache_report();
+    replay_cache_clear();
     db_client_cleanup();
 
     printf("\nServer stopped gracefully\n");
@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#include "transport/latency.h"
+#include "protocol/opcode.h"
+
+//==============================================================================
+// STATE
+// Indexed by fd. probe_id / sent_us / window are event-loop only; srtt_us
+// and min_us are also read by the executor shards.
+//==============================================================================
+
+typedef struct {
+    uint32_t probe_id;          // probe in flight, 0 = none
+    int64_t sent_us;            // when the probe in flight went out
+    int64_t window[LATENCY_WINDOW];     // last samples, 0 = empty
+    int window_pos;
+    atomic_llong srtt_us;       // smoothed RTT, 0 = not measured
+    atomic_llong min_us;        // smallest sample in window, 0 = not measured
+} latency_slot_t;
+
+static latency_slot_t g_slots[LATENCY_MAX_FD];
+static uint32_t g_next_probe_id = 1;
+
+//==============================================================================
+// HELPERS
+//==============================================================================
+
+static int64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static latency_slot_t* slot_of(int client_fd) {
+    if (client_fd <= 0 || client_fd >= LATENCY_MAX_FD) return NULL;
+    return &g_slots[client_fd];
+}
+
+//==============================================================================
+// PUBLIC API
+//==============================================================================
+
+void latency_send_probe(int client_fd) {
+    latency_slot_t *slot = slot_of(client_fd);
+    if (!slot) return;
+
+    uint32_t id = g_next_probe_id++;
+    if (g_next_probe_id == 0) g_next_probe_id = 1;
+    slot->probe_id = id;
+    slot->sent_us = now_us();
+
+    LatencyProbe probe = { htonl(id) };
+    MessageHeader req;
+    memset(&req, 0, sizeof(req));
+    req.seq_num = id;
+    forward_response(client_fd, &req, NTF_PING, (const char*)&probe, sizeof(probe));
+}
+
+void latency_on_pong(int client_fd, const MessageHeader *req, const char *payload) {
+    latency_slot_t *slot = slot_of(client_fd);
+    if (!slot || !payload || req->length < sizeof(LatencyProbe)) return;
+
+    LatencyProbe probe;
+    memcpy(&probe, payload, sizeof(probe));
+    uint32_t id = ntohl(probe.probe_id);
+    if (id == 0 || id != slot->probe_id) return;    // stale, duplicate or forged
+    slot->probe_id = 0;
+
+    int64_t sample = now_us() - slot->sent_us;
+    if (sample > (int64_t)LATENCY_MAX_SAMPLE_MS * 1000) return;
+    if (sample < 1) sample = 1;
+
+    long long srtt = atomic_load_explicit(&slot->srtt_us, memory_order_relaxed);
+    srtt = srtt == 0 ? sample : srtt + (sample - srtt) / (1 << LATENCY_SMOOTHING_SHIFT);
+    if (srtt < 1) srtt = 1;
+    atomic_store_explicit(&slot->srtt_us, srtt, memory_order_relaxed);
+
+    // Answer credit: best case of the window (a late pong only counts once
+    // every sample of the window is late)
+    slot->window[slot->window_pos] = sample;
+    slot->window_pos = (slot->window_pos + 1) % LATENCY_WINDOW;
+    int64_t min = sample;
+    for (int i = 0; i < LATENCY_WINDOW; i++) {
+        if (slot->window[i] > 0 && slot->window[i] < min) min = slot->window[i];
+    }
+    atomic_store_explicit(&slot->min_us, min, memory_order_relaxed);
+}
+
+int latency_rtt_ms(int client_fd) {
+    latency_slot_t *slot = slot_of(client_fd);
+    if (!slot) return -1;
+    long long srtt = atomic_load_explicit(&slot->srtt_us, memory_order_relaxed);
+    return srtt == 0 ? -1 : (int)((srtt + 500) / 1000);
+}
+
+int latency_one_way_ms(int client_fd) {
+    latency_slot_t *slot = slot_of(client_fd);
+    if (!slot) return 0;
+    long long one_way = atomic_load_explicit(&slot->min_us, memory_order_relaxed) / 2000;
+    return one_way > LATENCY_MAX_CREDIT_MS ? LATENCY_MAX_CREDIT_MS : (int)one_way;
+}
+
+void latency_forget(int client_fd) {
+    latency_slot_t *slot = slot_of(client_fd);
+    if (!slot) return;
+    slot->probe_id = 0;
+    slot->sent_us = 0;
+    memset(slot->window, 0, sizeof(slot->window));
+    slot->window_pos = 0;
+    atomic_store_explicit(&slot->srtt_us, 0, memory_order_relaxed);
+    atomic_store_explicit(&slot->min_us, 0, memory_order_relaxed);
+}
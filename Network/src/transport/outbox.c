@@ -0,0 +1,218 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "transport/outbox.h"
+
+//==============================================================================
+// STATE
+// Indexed by fd. Everything in a slot is guarded by its lock.
+//==============================================================================
+
+typedef struct {
+    pthread_mutex_t lock;
+    char *buf;                  // bytes the socket did not take yet
+    size_t off;                 // first unsent byte in buf
+    size_t len;                 // unsent bytes from off
+    size_t cap;
+    bool dead;                  // overflowed and shut down, until outbox_forget
+} outbox_slot_t;
+
+static outbox_slot_t g_slots[OUTBOX_MAX_FD];
+static pthread_once_t g_once = PTHREAD_ONCE_INIT;
+static void (*g_want_write)(int fd, bool on);
+
+//==============================================================================
+// HELPERS
+//==============================================================================
+
+static void slots_init(void) {
+    for (int i = 0; i < OUTBOX_MAX_FD; i++) {
+        pthread_mutex_init(&g_slots[i].lock, NULL);
+    }
+}
+
+static outbox_slot_t* slot_of(int fd) {
+    if (fd <= 0 || fd >= OUTBOX_MAX_FD) return NULL;
+    pthread_once(&g_once, slots_init);
+    return &g_slots[fd];
+}
+
+static void want_write(int fd, bool on) {
+    if (g_want_write) g_want_write(fd, on);
+}
+
+// Write what the socket takes right now: bytes written, -1 on a send error
+static ssize_t write_iov(int fd, struct iovec *iov, int cnt) {
+    size_t total = 0;
+    while (cnt > 0) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (size_t)cnt;
+
+        ssize_t n = sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return -1;
+        }
+        total += (size_t)n;
+
+        // Partial write: skip what went out, resume with the rest
+        while (cnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            cnt--;
+        }
+        if (cnt > 0) {
+            iov->iov_base = (char*)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+    return (ssize_t)total;
+}
+
+static bool buf_reserve(outbox_slot_t *slot, size_t extra) {
+    if (slot->off > 0) {
+        memmove(slot->buf, slot->buf + slot->off, slot->len);
+        slot->off = 0;
+    }
+    if (slot->len + extra <= slot->cap) return true;
+
+    size_t cap = slot->cap ? slot->cap : 4096;
+    while (cap < slot->len + extra) cap *= 2;
+    char *buf = realloc(slot->buf, cap);
+    if (!buf) return false;
+    slot->buf = buf;
+    slot->cap = cap;
+    return true;
+}
+
+static void buf_release(outbox_slot_t *slot) {
+    free(slot->buf);
+    slot->buf = NULL;
+    slot->off = slot->len = slot->cap = 0;
+}
+
+// Slow or stuck client: its stream cannot be kept whole, so it goes
+static void slot_overflow(int fd, outbox_slot_t *slot, const char *why) {
+    printf("[OUTBOX] Dropping fd=%d (%zu bytes buffered): %s\n", fd, slot->len, why);
+    buf_release(slot);
+    slot->dead = true;
+    want_write(fd, false);
+    shutdown(fd, SHUT_RDWR);
+}
+
+//==============================================================================
+// PUBLIC API
+//==============================================================================
+
+void outbox_init(void (*hook)(int fd, bool on)) {
+    pthread_once(&g_once, slots_init);
+    g_want_write = hook;
+}
+
+bool outbox_send(int fd, const void *head, size_t head_len, const void *body, size_t body_len) {
+    outbox_slot_t *slot = slot_of(fd);
+    if (!slot) return false;
+
+    size_t total = head_len + body_len;
+    bool ok = true;
+
+    pthread_mutex_lock(&slot->lock);
+    if (slot->dead) {
+        pthread_mutex_unlock(&slot->lock);
+        return false;
+    }
+
+    // Nothing buffered: try the socket first, in a single call
+    size_t written = 0;
+    if (slot->len == 0) {
+        struct iovec iov[2];
+        int cnt = 0;
+        if (head_len > 0) iov[cnt++] = (struct iovec){ (void*)head, head_len };
+        if (body_len > 0) iov[cnt++] = (struct iovec){ (void*)body, body_len };
+
+        ssize_t n = write_iov(fd, iov, cnt);
+        if (n < 0) {
+            // Peer gone: the disconnect path cleans up
+            pthread_mutex_unlock(&slot->lock);
+            return false;
+        }
+        written = (size_t)n;
+    }
+
+    if (written < total) {
+        size_t rest = total - written;
+        if (slot->len + rest > OUTBOX_MAX_BYTES) {
+            slot_overflow(fd, slot, "outbound buffer full");
+            ok = false;
+        } else if (!buf_reserve(slot, rest)) {
+            slot_overflow(fd, slot, "out of memory");
+            ok = false;
+        } else {
+            bool was_empty = slot->len == 0;
+            char *dst = slot->buf + slot->len;
+            if (written < head_len) {
+                memcpy(dst, (const char*)head + written, head_len - written);
+                if (body_len > 0) memcpy(dst + head_len - written, body, body_len);
+            } else {
+                memcpy(dst, (const char*)body + (written - head_len), rest);
+            }
+            slot->len += rest;
+            if (was_empty) want_write(fd, true);
+        }
+    }
+
+    pthread_mutex_unlock(&slot->lock);
+    return ok;
+}
+
+bool outbox_flush(int fd) {
+    outbox_slot_t *slot = slot_of(fd);
+    if (!slot) return false;
+
+    bool ok = true;
+    pthread_mutex_lock(&slot->lock);
+    if (slot->len > 0) {
+        struct iovec iov = { slot->buf + slot->off, slot->len };
+        ssize_t n = write_iov(fd, &iov, 1);
+        if (n < 0) {
+            ok = false;
+        } else {
+            slot->off += (size_t)n;
+            slot->len -= (size_t)n;
+        }
+    }
+    if (slot->len == 0) {
+        slot->off = 0;
+        want_write(fd, false);
+    }
+    pthread_mutex_unlock(&slot->lock);
+    return ok;
+}
+
+size_t outbox_pending(int fd) {
+    outbox_slot_t *slot = slot_of(fd);
+    if (!slot) return 0;
+
+    pthread_mutex_lock(&slot->lock);
+    size_t len = slot->len;
+    pthread_mutex_unlock(&slot->lock);
+    return len;
+}
+
+void outbox_forget(int fd) {
+    outbox_slot_t *slot = slot_of(fd);
+    if (!slot) return;
+
+    pthread_mutex_lock(&slot->lock);
+    buf_release(slot);
+    slot->dead = false;
+    pthread_mutex_unlock(&slot->lock);
+}
@@ -0,0 +1,154 @@
+#include "transport/room_list.h"
+#include "transport/room_manager.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cjson/cJSON.h>
+
+//==============================================================================
+// Snapshot
+//==============================================================================
+
+typedef struct {
+    uint32_t id;
+    GameMode mode;
+    RoomVisibility visibility;
+    int free_slots;
+    char *json;             // serialized room object
+    size_t json_len;
+} RoomListEntry;
+
+static struct {
+    uint64_t version;       // room_get_version() at build time, 0 = never built
+    RoomListEntry entries[MAX_ROOMS];
+    int count;              // newest first
+} g_snapshot;
+
+static char* room_to_json(const RoomState *room) {
+    cJSON *obj = cJSON_CreateObject();
+    if (!obj) return NULL;
+
+    // Same fields the rooms_with_counts query used to return
+    cJSON_AddNumberToObject(obj, "id", room->id);
+    cJSON_AddStringToObject(obj, "name", room->name);
+    cJSON_AddStringToObject(obj, "status", "waiting");
+    cJSON_AddStringToObject(obj, "mode", room->mode == MODE_SCORING ? "scoring" : "elimination");
+    cJSON_AddNumberToObject(obj, "max_players", room->max_players);
+    cJSON_AddStringToObject(obj, "visibility", room->visibility == ROOM_PRIVATE ? "private" : "public");
+    cJSON_AddBoolToObject(obj, "wager_mode", room->wager_mode != 0);
+    cJSON_AddNumberToObject(obj, "current_players", room->player_count);
+
+    char *json = cJSON_PrintUnformatted(obj);
+    cJSON_Delete(obj);
+    return json;
+}
+
+static void snapshot_rebuild(uint64_t version) {
+    for (int i = 0; i < g_snapshot.count; i++) {
+        free(g_snapshot.entries[i].json);
+    }
+    g_snapshot.count = 0;
+
+    // room_manager keeps creation order: walk backwards for newest first
+    for (int i = room_get_count() - 1; i >= 0; i--) {
+        const RoomState *room = room_at(i);
+        if (!room || room->id == 0 || room->status != ROOM_WAITING) continue;
+
+        char *json = room_to_json(room);
+        if (!json) continue;
+
+        RoomListEntry *e = &g_snapshot.entries[g_snapshot.count++];
+        e->id = room->id;
+        e->mode = room->mode;
+        e->visibility = room->visibility;
+        e->free_slots = (int)room->max_players - (int)room->player_count;
+        e->json = json;
+        e->json_len = strlen(json);
+    }
+
+    g_snapshot.version = version;
+    printf("[ROOM_LIST] Snapshot v%llu rebuilt: %d waiting rooms\n",
+           (unsigned long long)version, g_snapshot.count);
+}
+
+static bool entry_matches(const RoomListEntry *e, const RoomListQuery *q) {
+    if (q->cursor != 0 && e->id >= q->cursor) return false;
+    if (q->mode >= 0 && (int)e->mode != q->mode) return false;
+    if (q->visibility >= 0 && (int)e->visibility != q->visibility) return false;
+    if (e->free_slots < q->min_free_slots) return false;
+    return true;
+}
+
+//==============================================================================
+// Public API
+//==============================================================================
+
+void room_list_query_init(RoomListQuery *q) {
+    if (!q) return;
+    q->cursor = 0;
+    q->limit = ROOM_LIST_DEFAULT_LIMIT;
+    q->mode = -1;
+    q->visibility = -1;
+    q->min_free_slots = 0;
+}
+
+char* room_list_page(const RoomListQuery *q, uint32_t *out_next_cursor,
+                     uint64_t *out_version, size_t *out_len) {
+    RoomListQuery defaults;
+    if (!q) {
+        room_list_query_init(&defaults);
+        q = &defaults;
+    }
+
+    uint64_t version = room_get_version();
+    if (g_snapshot.version != version) {
+        snapshot_rebuild(version);
+    }
+
+    int limit = q->limit;
+    if (limit <= 0) limit = ROOM_LIST_DEFAULT_LIMIT;
+    if (limit > ROOM_LIST_MAX_LIMIT) limit = ROOM_LIST_MAX_LIMIT;
+
+    // First pass: pick entries and size the buffer
+    int picked[ROOM_LIST_MAX_LIMIT];
+    int n = 0;
+    size_t len = 2;  // []
+    int i = 0;
+    for (; i < g_snapshot.count && n < limit; i++) {
+        const RoomListEntry *e = &g_snapshot.entries[i];
+        if (!entry_matches(e, q)) continue;
+        picked[n++] = i;
+        len += e->json_len + 1;
+    }
+
+    // More matches left? Then the last id is the next cursor
+    uint32_t next_cursor = 0;
+    if (n == limit) {
+        for (; i < g_snapshot.count; i++) {
+            if (entry_matches(&g_snapshot.entries[i], q)) {
+                next_cursor = g_snapshot.entries[picked[n - 1]].id;
+                break;
+            }
+        }
+    }
+
+    char *buf = malloc(len + 1);
+    if (!buf) return NULL;
+
+    size_t off = 0;
+    buf[off++] = '[';
+    for (int k = 0; k < n; k++) {
+        const RoomListEntry *e = &g_snapshot.entries[picked[k]];
+        if (k > 0) buf[off++] = ',';
+        memcpy(buf + off, e->json, e->json_len);
+        off += e->json_len;
+    }
+    buf[off++] = ']';
+    buf[off] = '\0';
+
+    if (out_next_cursor) *out_next_cursor = next_cursor;
+    if (out_version) *out_version = g_snapshot.version;
+    if (out_len) *out_len = off;
+    return buf;
+}
@@ -14,6 +14,7 @@
 
 static RoomState g_rooms[MAX_ROOMS];
 static int g_room_count = 0;
+static uint64_t g_rooms_version = 1;
 
 //==============================================================================
 // Internal Helpers
@@ -39,6 +40,7 @@ RoomState* room_create(void) {
     
     RoomState *room = &g_rooms[g_room_count++];
     memset(room, 0, sizeof(RoomState));
+    room_mark_changed();
     
     return room;
 }
@@ -51,6 +53,7 @@ void room_destroy(uint32_t room_id) {
                 g_rooms[j] = g_rooms[j + 1];
             }
             g_room_count--;
+            room_mark_changed();
             return;
         }
     }
@@ -91,6 +94,7 @@ int room_add_player(uint32_t room_id, uint32_t account_id, const char *name, con
     room->member_fds[room->player_count] = client_fd;
     room->player_count++;
     room->member_count++;
+    room_mark_changed();
     
     printf("[SERVER] Added player: id=%u, name='%s' to room %u\n", account_id, player->name, room_id);
     
@@ -116,6 +120,7 @@ int room_remove_player(uint32_t room_id, uint32_t account_id) {
             }
             room->player_count--;
             room->member_count--;
+            room_mark_changed();
             return 0;
         }
     }
@@ -294,6 +299,7 @@ void room_add_member(int room_id, int client_fd) {
     // Add member
     if (room->member_count < MAX_ROOM_MEMBERS) {
         room->member_fds[room->member_count++] = client_fd;
+        room_mark_changed();
         printf("[ROOM] Added fd=%d to room=%d (%d members)\\n", 
                client_fd, room_id, room->member_count);
     } else {
@@ -313,6 +319,7 @@ void room_remove_member(int room_id, int client_fd) {
                 room->member_fds[j] = room->member_fds[j + 1];
             }
             room->member_count--;
+            room_mark_changed();
             printf("[SERVER] Removed fd=%d from room=%d (%d members left)\n",
                    client_fd, room_id, room->member_count);
             
@@ -361,14 +368,8 @@ void room_broadcast(int room_id, uint16_t command, const char *payload,
         return;
     }
     
-    // Build message header
     MessageHeader header;
-    memset(&header, 0, sizeof(header));
-    header.magic = htons(MAGIC_NUMBER);
-    header.version = PROTOCOL_VERSION;
-    header.command = htons(command);
-    header.seq_num = 0; // Notifications don't need seq
-    header.length = htonl(payload_len);
+    memset(&header, 0, sizeof(header)); // Notifications don't need seq
     
     // Send to all members
     int sent_count = 0;
@@ -381,10 +382,7 @@ void room_broadcast(int room_id, uint16_t command, const char *payload,
         }
         
         // Send header + payload
-        send(fd, &header, sizeof(header), 0);
-        if (payload_len > 0 && payload) {
-            send(fd, payload, payload_len, 0);
-        }
+        forward_response(fd, &header, command, payload, payload ? payload_len : 0);
         sent_count++;
     }
     
@@ -450,6 +448,19 @@ int room_get_count(void) {
     return g_room_count;
 }
 
+const RoomState* room_at(int index) {
+    if (index < 0 || index >= g_room_count) return NULL;
+    return &g_rooms[index];
+}
+
+void room_mark_changed(void) {
+    g_rooms_version++;
+}
+
+uint64_t room_get_version(void) {
+    return g_rooms_version;
+}
+
 
 /**
  * Find room by player account ID
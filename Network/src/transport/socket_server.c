@@ -13,14 +13,21 @@
 
 
 #include "transport/socket_server.h"
+#include "transport/spectator_hub.h"
+#include "transport/latency.h"
+#include "transport/outbox.h"
 #include "protocol/protocol.h"
+#include "protocol/opcode.h"
 #include "handlers/dispatcher.h"
 #include "handlers/round1_handler.h"
 #include "handlers/round2_handler.h"
 #include "handlers/round3_handler.h"
 #include "handlers/session_manager.h"
+#include "handlers/session_context.h"
 #include "handlers/match_manager.h"
+#include "handlers/match_executor.h"
 #include "handlers/room_disconnect_handler.h"
+#include "handlers/matchmaking.h"
 
 // REMOVED: business / handler / db
 // #include "../include/handler/client_manager.h"
@@ -51,6 +58,20 @@ volatile int g_running = 1;
 // SERVER INITIALIZATION
 //==============================================================================
 
+static int64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// outbox hook: watch EPOLLOUT while fd has buffered frames (any thread)
+static void client_want_write(int fd, bool on) {
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLRDHUP | (on ? EPOLLOUT : 0);
+    ev.data.fd = fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+}
+
 // Helper to set non-blocking
 void set_nonblocking(int sockfd) {
     int flags = fcntl(sockfd, F_GETFL, 0);
@@ -124,6 +145,8 @@ void initialize_server() {
         clients[i].header_received = 0;
     }
 
+    outbox_init(client_want_write);
+
     signal(SIGPIPE, SIG_IGN);
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
@@ -144,6 +167,12 @@ void process_message(int client_idx, MessageHeader *header, char *payload) {
         const char *payload
     );
 
+    // RTT probe answers are transport-level: never dispatched
+    if (header->command == CMD_PONG) {
+        latency_on_pong(client_fd, header, payload);
+        return;
+    }
+
     dispatch_command(client_fd, header, payload);
 }
 
@@ -155,6 +184,13 @@ int get_client_index(int fd) {
     return -1;
 }
 
+// Runs on the executor shard owning the player's match
+static void match_player_disconnected(int32_t account_id) {
+    handle_round1_disconnect(account_id);
+    handle_round2_disconnect(account_id);
+    handle_round3_disconnect(account_id);
+}
+
 void handle_client_disconnect(int client_idx) {
     int fd = clients[client_idx].sockfd;
     if (fd == -1) return;
@@ -198,24 +234,39 @@ void handle_client_disconnect(int client_idx) {
         if (state == SESSION_LOBBY || state == SESSION_UNAUTHENTICATED) {
             printf("[Socket] → Calling room_handle_disconnect()\n");
             room_handle_disconnect(fd, account_id);
+            matchmaking_cancel((int32_t)account_id);
         } 
-        else if (state == SESSION_PLAYING) {
-            // Call all round disconnect handlers (they check if player is in that round)
-            printf("[Socket] → Calling round disconnect handlers [GAME]\n");
-            handle_round1_disconnect(fd);
-            handle_round2_disconnect(fd);
-            handle_round3_disconnect(fd);
-        }
         
         // Mark session disconnected (grace period for reconnect)
         printf("[Socket] Marking session as disconnected (grace period enabled)\n");
         session_mark_disconnected(session);
+        
+        if (state == SESSION_PLAYING) {
+            // Round disconnect handlers (they check if player is in that round)
+            // run on the shard owning the match, after the mark above
+            uint32_t match_id = match_find_id_by_player((int32_t)account_id);
+            if (match_id != 0) {
+                printf("[Socket] → Posting round disconnect to match %u [GAME]\n", match_id);
+                if (!match_exec_post_disconnect(match_id, (int32_t)account_id,
+                                                match_player_disconnected)) {
+                    match_player_disconnected((int32_t)account_id);
+                }
+            }
+        }
     } else {
         printf("[Socket] ⚠️  No session found for fd=%d\n", fd);
         printf("[Socket] Attempting room cleanup anyway...\n");
         room_handle_disconnect(fd, 0);
     }
     
+    // The fd number will be reused: don't let the next client inherit
+    // this binding (require_auth trusts it), nor the matches it watched
+    clear_client_session(fd);
+    dispatch_forget_client(fd);
+    spectator_hub_disconnect(fd);
+    latency_forget(fd);
+    outbox_forget(fd);
+
     // Socket cleanup
     printf("[Socket] Cleaning up socket resources...\n");
     epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
@@ -322,19 +373,22 @@ void forward_response(
     resp.seq_num = htonl(req->seq_num);
     resp.length  = htonl(payload_len);
 
-    send(client_fd, &resp, sizeof(resp), 0);
-    if (payload_len > 0)
-        send(client_fd, payload, payload_len, 0);
+    // Header and payload go out as one frame, whichever thread sends
+    outbox_send(client_fd, &resp, sizeof(resp), payload, payload_len);
 }
 //==============================================================================
 // MAIN LOOP
 //==============================================================================
 
 int main_loop() {
-    int timeout_ms = -1; // Wait indefinitely for events
+    int timeout_ms = 1000; // Wake up for the session expiry sweep
+    time_t last_sweep = time(NULL);
+    int64_t last_probe_ms = monotonic_ms();
+    int held = 0;
 
     while (g_running) {
-        int nfds = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout_ms);
+        // Commands held during startup go out soon after it serves
+        int nfds = epoll_wait(epoll_fd, events, MAX_EVENTS, held > 0 ? DISPATCH_HELD_POLL_MS : timeout_ms);
         
         if (nfds == -1) {
             if (errno == EINTR) continue;
@@ -342,6 +396,29 @@ int main_loop() {
             break;
         }
 
+        // Expire idle / abandoned sessions (writes through to the DB)
+        time_t now = time(NULL);
+        if (now - last_sweep >= SESSION_SWEEP_INTERVAL_SEC) {
+            last_sweep = now;
+            session_cleanup_dead_sessions();
+        }
+
+        // Quick-play rooms (every MATCHMAKING_TICK_MS)
+        matchmaking_tick();
+
+        held = dispatch_held_commands();
+
+        // RTT probes of logged-in clients
+        int64_t now_ms = monotonic_ms();
+        if (now_ms - last_probe_ms >= LATENCY_PROBE_INTERVAL_MS) {
+            last_probe_ms = now_ms;
+            for (int i = 0; i < MAX_CLIENTS; i++) {
+                if (clients[i].sockfd != -1 && has_client_session(clients[i].sockfd)) {
+                    latency_send_probe(clients[i].sockfd);
+                }
+            }
+        }
+
         for (int n = 0; n < nfds; ++n) {
             if (events[n].data.fd == listen_fd) {
                 // Handle new connection
@@ -394,6 +471,12 @@ int main_loop() {
                 int idx = get_client_index(fd);
                 
                 if (idx != -1) {
+                    // Buffered frames first: the socket has room again
+                    if ((events[n].events & EPOLLOUT) && !outbox_flush(fd)) {
+                        handle_client_disconnect(idx);
+                        continue;
+                    }
+
                     // Check for errors or hangup
                     if (events[n].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
                         handle_client_disconnect(idx);
@@ -0,0 +1,525 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#include "transport/spectator_hub.h"
+#include "transport/outbox.h"
+
+//==============================================================================
+// TYPES
+//==============================================================================
+
+// Header + payload, encoded once and shared by every spectator queue
+typedef struct {
+    atomic_int refs;
+    uint32_t len;
+    char data[];
+} sh_frame_t;
+
+typedef enum {
+    SH_FRAME = 0,
+    SH_SCORES,
+    SH_CLOSE
+} sh_kind_t;
+
+typedef struct sh_item {
+    struct sh_item *next;
+    sh_kind_t kind;
+    uint32_t match_id;
+    sh_frame_t *frame;      // NULL for SH_CLOSE
+} sh_item_t;
+
+typedef struct {
+    int fd;
+    int32_t account_id;
+    bool leaving;           // detach once the queue is written out
+
+    // Ring of frames waiting for room in the fd's outbox
+    sh_frame_t *queue[SPECTATOR_QUEUE_MAX_FRAMES];
+    int head;
+    int count;
+    size_t queued_bytes;
+} sh_spectator_t;
+
+typedef struct sh_channel {
+    struct sh_channel *next;
+    uint32_t match_id;
+    bool closing;
+
+    sh_spectator_t *spectators;
+    int count;
+    int cap;
+
+    // Latest score snapshot, sent once next_scores_ms is reached
+    sh_frame_t *pending_scores;
+    int64_t next_scores_ms;
+} sh_channel_t;
+
+static struct {
+    pthread_t thread;
+    atomic_int running;
+    int started;
+
+    // Inbox (FIFO): shards publish, the writer takes it all in one go
+    pthread_mutex_t inbox_lock;
+    pthread_cond_t cond;
+    sh_item_t *head;
+    sh_item_t *tail;
+    int queued;
+    bool kick;              // a subscriber's first frame is waiting
+
+    // Channels: the writer, subscribe and leave / disconnect
+    pthread_mutex_t subs_lock;
+    sh_channel_t *channels;
+
+    uint64_t frames_sent;
+    uint64_t frames_dropped;        // inbox full
+    uint64_t spectators_dropped;    // queue overflow / send error
+} g_sh;
+
+// Spectators per match_id % SPECTATOR_WATCH_SLOTS (collisions only cost a publish)
+static atomic_int g_watch[SPECTATOR_WATCH_SLOTS];
+
+//==============================================================================
+// HELPERS
+//==============================================================================
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void cond_wait_until(int64_t deadline_ms) {
+    struct timespec ts;
+    ts.tv_sec = deadline_ms / 1000;
+    ts.tv_nsec = (deadline_ms % 1000) * 1000000;
+    pthread_cond_timedwait(&g_sh.cond, &g_sh.inbox_lock, &ts);
+}
+
+static atomic_int* watch_slot(uint32_t match_id) {
+    return &g_watch[match_id % SPECTATOR_WATCH_SLOTS];
+}
+
+static sh_frame_t* frame_new(uint16_t cmd, uint32_t seq_num, const char *payload, uint32_t len) {
+    sh_frame_t *f = malloc(sizeof(*f) + sizeof(MessageHeader) + len);
+    if (!f) return NULL;
+
+    MessageHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic   = htons(MAGIC_NUMBER);
+    hdr.version = PROTOCOL_VERSION;
+    hdr.command = htons(cmd);
+    hdr.seq_num = htonl(seq_num);
+    hdr.length  = htonl(len);
+
+    atomic_init(&f->refs, 1);
+    f->len = (uint32_t)sizeof(hdr) + len;
+    memcpy(f->data, &hdr, sizeof(hdr));
+    if (len > 0) memcpy(f->data + sizeof(hdr), payload, len);
+    return f;
+}
+
+static sh_frame_t* frame_ref(sh_frame_t *f) {
+    atomic_fetch_add(&f->refs, 1);
+    return f;
+}
+
+static void frame_release(sh_frame_t *f) {
+    if (f && atomic_fetch_sub(&f->refs, 1) == 1) free(f);
+}
+
+// bounded: refuse once SPECTATOR_INBOX_MAX items are waiting
+static bool inbox_push(sh_kind_t kind, uint32_t match_id, sh_frame_t *frame, bool bounded) {
+    sh_item_t *it = malloc(sizeof(*it));
+    if (!it) return false;
+    it->next = NULL;
+    it->kind = kind;
+    it->match_id = match_id;
+    it->frame = frame;
+
+    pthread_mutex_lock(&g_sh.inbox_lock);
+    if (!atomic_load(&g_sh.running) || (bounded && g_sh.queued >= SPECTATOR_INBOX_MAX)) {
+        g_sh.frames_dropped++;
+        pthread_mutex_unlock(&g_sh.inbox_lock);
+        free(it);
+        return false;
+    }
+    if (g_sh.tail) g_sh.tail->next = it; else g_sh.head = it;
+    g_sh.tail = it;
+    g_sh.queued++;
+    pthread_cond_signal(&g_sh.cond);
+    pthread_mutex_unlock(&g_sh.inbox_lock);
+    return true;
+}
+
+static void publish(sh_kind_t kind, uint32_t match_id, uint16_t cmd, const char *payload,
+                    uint32_t len) {
+    if (!spectator_hub_watched(match_id)) return;
+
+    sh_frame_t *f = frame_new(cmd, 0, payload, len);
+    if (!f) return;
+    if (!inbox_push(kind, match_id, f, true)) frame_release(f);
+}
+
+//==============================================================================
+// CHANNELS (subs_lock held)
+//==============================================================================
+
+static sh_channel_t* channel_find(uint32_t match_id) {
+    for (sh_channel_t *ch = g_sh.channels; ch; ch = ch->next) {
+        if (ch->match_id == match_id) return ch;
+    }
+    return NULL;
+}
+
+static void channel_free(sh_channel_t *ch) {
+    frame_release(ch->pending_scores);
+    free(ch->spectators);
+    free(ch);
+}
+
+// Drop queued frames from the tail until `keep` are left
+static void queue_trim(sh_spectator_t *s, int keep) {
+    while (s->count > keep) {
+        int idx = (s->head + s->count - 1) % SPECTATOR_QUEUE_MAX_FRAMES;
+        s->queued_bytes -= s->queue[idx]->len;
+        frame_release(s->queue[idx]);
+        s->count--;
+    }
+}
+
+static void spectator_remove(sh_channel_t *ch, int idx) {
+    sh_spectator_t *s = &ch->spectators[idx];
+    queue_trim(s, 0);
+    atomic_fetch_sub(watch_slot(ch->match_id), 1);
+
+    ch->count--;
+    if (idx != ch->count) ch->spectators[idx] = ch->spectators[ch->count];
+}
+
+// Slow consumer: detach it. Frames went to the outbox whole, so the
+// client's stream stays aligned and the connection is kept.
+static void spectator_drop(sh_channel_t *ch, int idx, const char *why) {
+    sh_spectator_t *s = &ch->spectators[idx];
+    printf("[SPECTATOR] Dropping fd=%d (account %d) from match %u: %s\n",
+           s->fd, s->account_id, ch->match_id, why);
+    spectator_remove(ch, idx);
+    g_sh.spectators_dropped++;
+}
+
+// Graceful detach: what is queued here is not sent any more
+static void spectator_leave(sh_channel_t *ch, int idx) {
+    spectator_remove(ch, idx);
+}
+
+static bool spectator_enqueue(sh_spectator_t *s, sh_frame_t *f) {
+    if (s->count >= SPECTATOR_QUEUE_MAX_FRAMES ||
+        s->queued_bytes + f->len > SPECTATOR_QUEUE_MAX_BYTES) {
+        return false;
+    }
+    s->queue[(s->head + s->count) % SPECTATOR_QUEUE_MAX_FRAMES] = frame_ref(f);
+    s->count++;
+    s->queued_bytes += f->len;
+    return true;
+}
+
+static void fan_out(sh_channel_t *ch, sh_frame_t *f) {
+    for (int i = ch->count - 1; i >= 0; i--) {
+        sh_spectator_t *s = &ch->spectators[i];
+        if (s->leaving) continue;
+        if (!spectator_enqueue(s, f)) spectator_drop(ch, i, "queue full");
+    }
+}
+
+// Frames go through the fd's outbox, under the same lock as the shard's
+// and the event loop's sends, so they never interleave with a player
+// reply. Held here while the client still has SPECTATOR_OUTBOX_MAX_BYTES
+// buffered there: a slow spectator overflows its own queue, not the outbox.
+// 0 = queue handed over, 1 = client backlog, -1 = send error
+static int spectator_flush(sh_spectator_t *s) {
+    while (s->count > 0) {
+        if (outbox_pending(s->fd) >= SPECTATOR_OUTBOX_MAX_BYTES) return 1;
+
+        sh_frame_t *f = s->queue[s->head];
+        if (!outbox_send(s->fd, f->data, f->len, NULL, 0)) return -1;
+
+        s->queued_bytes -= f->len;
+        frame_release(f);
+        s->head = (s->head + 1) % SPECTATOR_QUEUE_MAX_FRAMES;
+        s->count--;
+        g_sh.frames_sent++;
+    }
+    return 0;
+}
+
+//==============================================================================
+// WRITER THREAD
+//==============================================================================
+
+static void apply_item(sh_item_t *it) {
+    sh_channel_t *ch = channel_find(it->match_id);
+    if (!ch) return;
+
+    switch (it->kind) {
+        case SH_FRAME:
+            fan_out(ch, it->frame);
+            break;
+        case SH_SCORES:
+            // Coalesce: only the latest snapshot is worth sending
+            frame_release(ch->pending_scores);
+            ch->pending_scores = frame_ref(it->frame);
+            break;
+        case SH_CLOSE:
+            ch->closing = true;
+            for (int i = 0; i < ch->count; i++) ch->spectators[i].leaving = true;
+            break;
+    }
+}
+
+// Scores that are due, then every socket; returns the next wake-up (0 = none)
+static int64_t service_channels(int64_t now) {
+    int64_t wake = 0;
+#define WAKE_AT(t) do { if (wake == 0 || (t) < wake) wake = (t); } while (0)
+
+    sh_channel_t **pp = &g_sh.channels;
+    while (*pp) {
+        sh_channel_t *ch = *pp;
+
+        if (ch->pending_scores) {
+            if (ch->closing || now >= ch->next_scores_ms) {
+                fan_out(ch, ch->pending_scores);
+                frame_release(ch->pending_scores);
+                ch->pending_scores = NULL;
+                ch->next_scores_ms = now + SPECTATOR_SCORE_INTERVAL_MS;
+            } else {
+                WAKE_AT(ch->next_scores_ms);
+            }
+        }
+
+        for (int i = ch->count - 1; i >= 0; i--) {
+            sh_spectator_t *s = &ch->spectators[i];
+            int rc = spectator_flush(s);
+            if (rc < 0) {
+                spectator_drop(ch, i, "send failed");
+            } else if (rc > 0) {
+                WAKE_AT(now + SPECTATOR_RETRY_MS);
+            } else if (s->leaving) {
+                spectator_remove(ch, i);
+            }
+        }
+
+        if (ch->count == 0 && !ch->pending_scores) {
+            *pp = ch->next;
+            channel_free(ch);
+        } else {
+            pp = &ch->next;
+        }
+    }
+#undef WAKE_AT
+    return wake;
+}
+
+static void* writer_thread(void *arg) {
+    (void)arg;
+    int64_t wake_ms = 0;
+
+    pthread_mutex_lock(&g_sh.inbox_lock);
+    for (;;) {
+        sh_item_t *batch = g_sh.head;
+        g_sh.head = g_sh.tail = NULL;
+        g_sh.queued = 0;
+        bool kicked = g_sh.kick;
+        g_sh.kick = false;
+
+        if (!batch && !kicked) {
+            if (!atomic_load(&g_sh.running)) break;
+            if (wake_ms == 0) {
+                pthread_cond_wait(&g_sh.cond, &g_sh.inbox_lock);
+                continue;
+            }
+            if (now_ms() < wake_ms) {
+                cond_wait_until(wake_ms);
+                continue;
+            }
+        }
+        pthread_mutex_unlock(&g_sh.inbox_lock);
+
+        pthread_mutex_lock(&g_sh.subs_lock);
+        while (batch) {
+            sh_item_t *next = batch->next;
+            apply_item(batch);
+            frame_release(batch->frame);
+            free(batch);
+            batch = next;
+        }
+        wake_ms = service_channels(now_ms());
+        pthread_mutex_unlock(&g_sh.subs_lock);
+
+        pthread_mutex_lock(&g_sh.inbox_lock);
+    }
+    pthread_mutex_unlock(&g_sh.inbox_lock);
+    return NULL;
+}
+
+//==============================================================================
+// PUBLIC API
+//==============================================================================
+
+int spectator_hub_init(void) {
+    if (g_sh.started) return 0;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&g_sh.inbox_lock, NULL);
+    pthread_mutex_init(&g_sh.subs_lock, NULL);
+    pthread_cond_init(&g_sh.cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    atomic_store(&g_sh.running, 1);
+    if (pthread_create(&g_sh.thread, NULL, writer_thread, NULL) != 0) {
+        printf("[SPECTATOR] Failed to start writer thread\n");
+        atomic_store(&g_sh.running, 0);
+        pthread_cond_destroy(&g_sh.cond);
+        pthread_mutex_destroy(&g_sh.subs_lock);
+        pthread_mutex_destroy(&g_sh.inbox_lock);
+        return -1;
+    }
+    g_sh.started = 1;
+    printf("[SPECTATOR] Writer started (%d spectators per match, %d queued frames each)\n",
+           SPECTATOR_MAX_PER_MATCH, SPECTATOR_QUEUE_MAX_FRAMES);
+    return 0;
+}
+
+void spectator_hub_shutdown(void) {
+    if (!g_sh.started) return;
+
+    pthread_mutex_lock(&g_sh.inbox_lock);
+    atomic_store(&g_sh.running, 0);
+    pthread_cond_signal(&g_sh.cond);
+    pthread_mutex_unlock(&g_sh.inbox_lock);
+    pthread_join(g_sh.thread, NULL);
+
+    pthread_mutex_lock(&g_sh.subs_lock);
+    sh_channel_t *ch = g_sh.channels;
+    g_sh.channels = NULL;
+    while (ch) {
+        sh_channel_t *next = ch->next;
+        while (ch->count > 0) spectator_remove(ch, ch->count - 1);
+        channel_free(ch);
+        ch = next;
+    }
+    pthread_mutex_unlock(&g_sh.subs_lock);
+
+    printf("[SPECTATOR] Writer stopped: %llu frame(s) sent, %llu dropped, %llu spectator(s) dropped\n",
+           (unsigned long long)g_sh.frames_sent, (unsigned long long)g_sh.frames_dropped,
+           (unsigned long long)g_sh.spectators_dropped);
+
+    pthread_cond_destroy(&g_sh.cond);
+    pthread_mutex_destroy(&g_sh.subs_lock);
+    pthread_mutex_destroy(&g_sh.inbox_lock);
+    g_sh.started = 0;
+}
+
+bool spectator_hub_watched(uint32_t match_id) {
+    return atomic_load_explicit(watch_slot(match_id), memory_order_relaxed) > 0;
+}
+
+bool spectator_hub_subscribe(uint32_t match_id, int client_fd, int32_t account_id,
+                             const MessageHeader *req, uint16_t cmd,
+                             const char *payload, uint32_t len) {
+    if (!g_sh.started || match_id == 0 || client_fd <= 0) return false;
+
+    sh_frame_t *first = frame_new(cmd, req ? req->seq_num : 0, payload, len);
+    if (!first) return false;
+
+    pthread_mutex_lock(&g_sh.subs_lock);
+    bool ok = false;
+    sh_channel_t *ch = NULL;
+    if (!atomic_load(&g_sh.running)) goto out;
+
+    ch = channel_find(match_id);
+    if (!ch) {
+        ch = calloc(1, sizeof(*ch));
+        if (!ch) goto out;
+        ch->match_id = match_id;
+        ch->next = g_sh.channels;
+        g_sh.channels = ch;
+    }
+    if (ch->closing || ch->count >= SPECTATOR_MAX_PER_MATCH) goto out;
+    for (int i = 0; i < ch->count; i++) {
+        if (ch->spectators[i].fd == client_fd) goto out;
+    }
+
+    if (ch->count == ch->cap) {
+        int cap = ch->cap ? ch->cap * 2 : 4;
+        if (cap > SPECTATOR_MAX_PER_MATCH) cap = SPECTATOR_MAX_PER_MATCH;
+        sh_spectator_t *grown = realloc(ch->spectators, (size_t)cap * sizeof(*grown));
+        if (!grown) goto out;
+        ch->spectators = grown;
+        ch->cap = cap;
+    }
+
+    sh_spectator_t *s = &ch->spectators[ch->count++];
+    memset(s, 0, sizeof(*s));
+    s->fd = client_fd;
+    s->account_id = account_id;
+    spectator_enqueue(s, first);
+    atomic_fetch_add(watch_slot(match_id), 1);
+    ok = true;
+
+out:
+    pthread_mutex_unlock(&g_sh.subs_lock);
+    frame_release(first);
+    if (ok) {
+        // Wake the writer for the first frame
+        pthread_mutex_lock(&g_sh.inbox_lock);
+        g_sh.kick = true;
+        pthread_cond_signal(&g_sh.cond);
+        pthread_mutex_unlock(&g_sh.inbox_lock);
+    }
+    return ok;
+}
+
+void spectator_hub_leave(uint32_t match_id, int client_fd) {
+    if (!g_sh.started) return;
+    pthread_mutex_lock(&g_sh.subs_lock);
+    for (sh_channel_t *ch = g_sh.channels; ch; ch = ch->next) {
+        if (match_id != 0 && ch->match_id != match_id) continue;
+        for (int i = ch->count - 1; i >= 0; i--) {
+            if (ch->spectators[i].fd == client_fd) spectator_leave(ch, i);
+        }
+    }
+    pthread_mutex_unlock(&g_sh.subs_lock);
+}
+
+void spectator_hub_disconnect(int client_fd) {
+    if (!g_sh.started) return;
+    pthread_mutex_lock(&g_sh.subs_lock);
+    for (sh_channel_t *ch = g_sh.channels; ch; ch = ch->next) {
+        for (int i = ch->count - 1; i >= 0; i--) {
+            if (ch->spectators[i].fd == client_fd) spectator_remove(ch, i);
+        }
+    }
+    pthread_mutex_unlock(&g_sh.subs_lock);
+}
+
+void spectator_hub_publish(uint32_t match_id, uint16_t cmd, const char *payload, uint32_t len) {
+    publish(SH_FRAME, match_id, cmd, payload, len);
+}
+
+void spectator_hub_publish_scores(uint32_t match_id, uint16_t cmd, const char *payload,
+                                  uint32_t len) {
+    publish(SH_SCORES, match_id, cmd, payload, len);
+}
+
+void spectator_hub_close(uint32_t match_id) {
+    // Nobody watching: no channel left to close
+    if (!spectator_hub_watched(match_id)) return;
+    inbox_push(SH_CLOSE, match_id, NULL, false);
+}
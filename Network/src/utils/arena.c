@@ -0,0 +1,170 @@
+#include "utils/arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define ARENA_ALIGN     _Alignof(max_align_t)
+
+struct ArenaChunk {
+    ArenaChunk *prev;       // older chunk
+    size_t size;            // payload bytes
+    size_t used;
+    size_t base;            // bytes used in all older chunks
+    _Alignas(max_align_t) unsigned char data[];
+};
+
+//==============================================================================
+// HELPERS
+//==============================================================================
+
+static size_t align_up(size_t n) {
+    return (n + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+static void note_usage(Arena *arena) {
+    size_t used = arena_used(arena);
+    if (used > arena->peak) arena->peak = used;
+}
+
+// Push a chunk with at least min_size free bytes; spares are reused first
+static ArenaChunk* push_chunk(Arena *arena, size_t min_size) {
+    ArenaChunk *chunk = NULL;
+
+    if (min_size <= arena->chunk_size && arena->spare) {
+        chunk = arena->spare;
+        arena->spare = chunk->prev;
+    } else {
+        // Oversized requests get a chunk of their own
+        size_t size = min_size > arena->chunk_size ? align_up(min_size) : arena->chunk_size;
+        if (size > SIZE_MAX - sizeof(ArenaChunk)) return NULL;
+        chunk = malloc(sizeof(ArenaChunk) + size);
+        if (!chunk) return NULL;
+        chunk->size = size;
+        arena->reserved += sizeof(ArenaChunk) + size;
+    }
+
+    chunk->used = 0;
+    chunk->base = arena->head ? arena->head->base + arena->head->used : 0;
+    chunk->prev = arena->head;
+    arena->head = chunk;
+    return chunk;
+}
+
+static void free_list(ArenaChunk *chunk) {
+    while (chunk) {
+        ArenaChunk *prev = chunk->prev;
+        free(chunk);
+        chunk = prev;
+    }
+}
+
+//==============================================================================
+// PUBLIC API
+//==============================================================================
+
+void arena_init(Arena *arena, size_t chunk_size) {
+    if (!arena) return;
+    memset(arena, 0, sizeof(*arena));
+    arena->chunk_size = align_up(chunk_size > 0 ? chunk_size : ARENA_CHUNK_SIZE);
+}
+
+void arena_destroy(Arena *arena) {
+    if (!arena) return;
+    free_list(arena->head);
+    free_list(arena->spare);
+    size_t chunk_size = arena->chunk_size;
+    memset(arena, 0, sizeof(*arena));
+    arena->chunk_size = chunk_size;
+}
+
+void* arena_alloc(Arena *arena, size_t size) {
+    if (!arena) return NULL;
+    if (arena->chunk_size == 0) arena_init(arena, 0);
+    if (size == 0) size = 1;
+
+    ArenaChunk *chunk = arena->head;
+    size_t offset = chunk ? align_up(chunk->used) : 0;
+    if (!chunk || offset > chunk->size || chunk->size - offset < size) {
+        chunk = push_chunk(arena, size);
+        if (!chunk) return NULL;
+        offset = 0;
+    }
+
+    chunk->used = offset + size;
+    note_usage(arena);
+    return chunk->data + offset;
+}
+
+char* arena_strndup(Arena *arena, const char *s, size_t len) {
+    if (!s) return NULL;
+    char *copy = arena_alloc(arena, len + 1);
+    if (!copy) return NULL;
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+char* arena_strdup(Arena *arena, const char *s) {
+    return s ? arena_strndup(arena, s, strlen(s)) : NULL;
+}
+
+char* arena_reserve(Arena *arena, size_t min_size, size_t *out_avail) {
+    if (!arena || !out_avail) return NULL;
+    if (arena->chunk_size == 0) arena_init(arena, 0);
+    if (min_size == 0) min_size = 1;
+
+    ArenaChunk *chunk = arena->head;
+    size_t offset = chunk ? align_up(chunk->used) : 0;
+    if (!chunk || offset > chunk->size || chunk->size - offset < min_size) {
+        chunk = push_chunk(arena, min_size);
+        if (!chunk) return NULL;
+        offset = 0;
+    }
+
+    // Alignment padding is committed with the write
+    chunk->used = offset;
+    *out_avail = chunk->size - offset;
+    return (char *)chunk->data + offset;
+}
+
+void arena_commit(Arena *arena, size_t size) {
+    if (!arena || !arena->head) return;
+    ArenaChunk *chunk = arena->head;
+    if (size > chunk->size - chunk->used) size = chunk->size - chunk->used;
+    chunk->used += size;
+    note_usage(arena);
+}
+
+ArenaMark arena_mark(const Arena *arena) {
+    ArenaMark mark = { NULL, 0 };
+    if (arena && arena->head) {
+        mark.chunk = arena->head;
+        mark.used = arena->head->used;
+    }
+    return mark;
+}
+
+void arena_rewind(Arena *arena, ArenaMark mark) {
+    if (!arena) return;
+
+    while (arena->head && arena->head != mark.chunk) {
+        ArenaChunk *chunk = arena->head;
+        arena->head = chunk->prev;
+        if (chunk->size == arena->chunk_size) {
+            chunk->prev = arena->spare;
+            arena->spare = chunk;
+        } else {
+            arena->reserved -= sizeof(ArenaChunk) + chunk->size;
+            free(chunk);
+        }
+    }
+    if (arena->head && mark.used <= arena->head->used) {
+        arena->head->used = mark.used;
+    }
+}
+
+size_t arena_used(const Arena *arena) {
+    if (!arena || !arena->head) return 0;
+    return arena->head->base + arena->head->used;
+}
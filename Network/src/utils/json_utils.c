@@ -1,5 +1,10 @@
 #include "utils/json_utils.h"
 #include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+
+// Smallest tail worth trying cJSON_PrintPreallocated on
+#define JSON_ARENA_MIN_RESERVE  1024
 
 /**
  * Escape JSON string: " → \", \ → \\, \n → \\n
@@ -64,3 +69,26 @@ const char* json_escape_string(const char *input) {
     *dst = '\0';
     return buffer;
 }
+
+/**
+ * Serialize item into arena memory
+ * Falls back to cJSON_PrintUnformatted + copy when the frame does not fit
+ * in one chunk.
+ */
+char* json_print_arena(cJSON *item, Arena *arena) {
+    if (!item || !arena) return NULL;
+
+    size_t avail = 0;
+    char *buf = arena_reserve(arena, JSON_ARENA_MIN_RESERVE, &avail);
+    if (buf && avail <= INT_MAX &&
+        cJSON_PrintPreallocated(item, buf, (int)avail, 0)) {
+        arena_commit(arena, strlen(buf) + 1);
+        return buf;
+    }
+
+    char *json = cJSON_PrintUnformatted(item);
+    if (!json) return NULL;
+    char *copy = arena_strdup(arena, json);
+    free(json);
+    return copy;
+}
@@ -0,0 +1,222 @@
+#include "utils/startup.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+typedef struct {
+    const char *name;
+    startup_task_fn fn;
+    startup_task_kind_t kind;
+    pthread_t thread;
+    int started;
+    int rc;
+    double ms;
+} startup_task_t;
+
+static startup_task_t g_tasks[STARTUP_MAX_TASKS];
+static int g_task_count = 0;
+
+static int (*g_db_ready_fn)(void) = NULL;
+static int g_db_ok = 0;
+
+static pthread_t g_pipeline;
+static int g_pipeline_started = 0;
+
+static pthread_mutex_t g_state_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_stop_cond = PTHREAD_COND_INITIALIZER;
+static startup_state_t g_state = STARTUP_STARTING;
+static bool g_stopping = false;     // startup_join: no more retries
+
+static struct timespec g_t0;
+
+//==============================================================================
+// HELPERS
+//==============================================================================
+
+static double ms_since(const struct timespec *t0) {
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (double)(t1.tv_sec - t0->tv_sec) * 1000.0 +
+           (double)(t1.tv_nsec - t0->tv_nsec) / 1e6;
+}
+
+static void set_state(startup_state_t state) {
+    pthread_mutex_lock(&g_state_lock);
+    g_state = state;
+    pthread_mutex_unlock(&g_state_lock);
+    printf("[STARTUP] %s after %.0fms\n", startup_state_name(state), ms_since(&g_t0));
+}
+
+static void *task_thread(void *arg) {
+    startup_task_t *t = arg;
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    t->rc = t->fn();
+    t->ms = ms_since(&t0);
+    printf("[STARTUP] Task '%s' %s in %.0fms\n", t->name, t->rc == 0 ? "done" : "FAILED", t->ms);
+    return NULL;
+}
+
+static bool is_kind(const startup_task_t *t, startup_task_kind_t kind) {
+    if (kind == STARTUP_TASK_PRELOAD) {
+        return t->kind == STARTUP_TASK_PRELOAD || t->kind == STARTUP_TASK_PRELOAD_RETRY;
+    }
+    return t->kind == kind;
+}
+
+static void start_tasks(startup_task_kind_t kind) {
+    for (int i = 0; i < g_task_count; i++) {
+        startup_task_t *t = &g_tasks[i];
+        if (!is_kind(t, kind)) continue;
+        t->started = (pthread_create(&t->thread, NULL, task_thread, t) == 0);
+        if (!t->started) {
+            // No thread: run inline rather than skip it
+            task_thread(t);
+        }
+    }
+}
+
+static void join_tasks(startup_task_kind_t kind) {
+    for (int i = 0; i < g_task_count; i++) {
+        startup_task_t *t = &g_tasks[i];
+        if (is_kind(t, kind) && t->started) {
+            pthread_join(t->thread, NULL);
+            t->started = 0;
+        }
+    }
+}
+
+// Sleep up to ms; false if startup_join asked to stop
+static bool wait_retry(int ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += ms / 1000;
+    deadline.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&g_state_lock);
+    while (!g_stopping) {
+        if (pthread_cond_timedwait(&g_stop_cond, &g_state_lock, &deadline) != 0) break;
+    }
+    bool go_on = !g_stopping;
+    pthread_mutex_unlock(&g_state_lock);
+    return go_on;
+}
+
+// Failed STARTUP_TASK_PRELOAD_RETRY tasks, inline on the pipeline thread
+static void retry_failed_tasks(void) {
+    int delay_ms = STARTUP_RETRY_FIRST_MS;
+    for (;;) {
+        int failed = 0;
+        for (int i = 0; i < g_task_count; i++) {
+            if (g_tasks[i].kind == STARTUP_TASK_PRELOAD_RETRY && g_tasks[i].rc != 0) failed++;
+        }
+        if (failed == 0) return;
+
+        printf("[STARTUP] %d task(s) failed, retrying in %dms\n", failed, delay_ms);
+        if (!wait_retry(delay_ms)) return;
+
+        for (int i = 0; i < g_task_count; i++) {
+            startup_task_t *t = &g_tasks[i];
+            if (t->kind == STARTUP_TASK_PRELOAD_RETRY && t->rc != 0) task_thread(t);
+        }
+        delay_ms = delay_ms * 2 > STARTUP_RETRY_MAX_MS ? STARTUP_RETRY_MAX_MS : delay_ms * 2;
+    }
+}
+
+//==============================================================================
+// PIPELINE
+//==============================================================================
+
+static void *pipeline_thread(void *arg) {
+    (void)arg;
+
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    g_db_ok = g_db_ready_fn ? (g_db_ready_fn() == 0) : 1;
+    printf("[STARTUP] Database %s in %.0fms\n", g_db_ok ? "connected" : "unavailable", ms_since(&t0));
+
+    // Preloads don't depend on the cleanup: start everything at once
+    start_tasks(STARTUP_TASK_REQUIRED);
+    start_tasks(STARTUP_TASK_PRELOAD);
+
+    join_tasks(STARTUP_TASK_REQUIRED);
+    set_state(STARTUP_WARMING);
+
+    join_tasks(STARTUP_TASK_PRELOAD);
+    retry_failed_tasks();
+    set_state(STARTUP_READY);
+    return NULL;
+}
+
+//==============================================================================
+// PUBLIC API
+//==============================================================================
+
+void startup_add_task(const char *name, startup_task_fn fn, startup_task_kind_t kind) {
+    if (!fn || g_pipeline_started) return;
+    if (g_task_count >= STARTUP_MAX_TASKS) {
+        printf("[STARTUP] Too many tasks, '%s' not registered\n", name ? name : "?");
+        return;
+    }
+    startup_task_t *t = &g_tasks[g_task_count++];
+    memset(t, 0, sizeof(*t));
+    t->name = name ? name : "task";
+    t->fn = fn;
+    t->kind = kind;
+}
+
+void startup_run(int (*db_ready_fn)(void)) {
+    if (g_pipeline_started) return;
+
+    clock_gettime(CLOCK_MONOTONIC, &g_t0);
+    g_db_ready_fn = db_ready_fn;
+    printf("[STARTUP] Running %d startup tasks in background\n", g_task_count);
+
+    g_pipeline_started = (pthread_create(&g_pipeline, NULL, pipeline_thread, NULL) == 0);
+    if (!g_pipeline_started) {
+        printf("[STARTUP] Failed to start pipeline thread, running inline\n");
+        pipeline_thread(NULL);
+    }
+}
+
+void startup_join(void) {
+    pthread_mutex_lock(&g_state_lock);
+    g_stopping = true;
+    pthread_cond_broadcast(&g_stop_cond);
+    pthread_mutex_unlock(&g_state_lock);
+
+    if (g_pipeline_started) {
+        pthread_join(g_pipeline, NULL);
+        g_pipeline_started = 0;
+    }
+}
+
+startup_state_t startup_state(void) {
+    pthread_mutex_lock(&g_state_lock);
+    startup_state_t s = g_state;
+    pthread_mutex_unlock(&g_state_lock);
+    return s;
+}
+
+const char *startup_state_name(startup_state_t state) {
+    switch (state) {
+        case STARTUP_STARTING: return "STARTING";
+        case STARTUP_WARMING:  return "WARMING";
+        case STARTUP_READY:    return "READY";
+    }
+    return "?";
+}
+
+bool startup_is_serving(void) {
+    return startup_state() != STARTUP_STARTING;
+}
+
+bool startup_db_available(void) {
+    return g_db_ok != 0;
+}
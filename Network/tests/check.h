@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * check.h - Support for the unit checks (make check)
+ *
+ * Every tests/test_*.c is its own program, linked with the server objects
+ * (minus main.o and socket_server.o) and check_support.c, which stands in
+ * for the socket layer: forward_response() keeps the frames it is given
+ * so a check can look at what a client would have received.
+ *
+ * CHECK() reports a failure and carries on; check_done() turns the count
+ * into the exit status. The server log goes to /dev/null unless
+ * CHECK_VERBOSE is set.
+ */
+
+#define CHECK_DEFAULT_SEED  "../Database/init/02_seed.sql"
+
+#define CHECK(cond) do {                                                        \
+    if (!(cond)) {                                                              \
+        fprintf(stderr, "  %s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        g_check_failures++;                                                     \
+    }                                                                           \
+} while (0)
+
+#define CHECK_INT(actual, expected) do {                                        \
+    long long a_ = (long long)(actual), e_ = (long long)(expected);             \
+    if (a_ != e_) {                                                             \
+        fprintf(stderr, "  %s:%d: check failed: %s == %lld, expected %lld\n",   \
+                __FILE__, __LINE__, #actual, a_, e_);                           \
+        g_check_failures++;                                                     \
+    }                                                                           \
+} while (0)
+
+extern int g_check_failures;
+
+/** Silence the server log (unless CHECK_VERBOSE) and name the program */
+void check_begin(const char *name);
+
+/** Print the verdict; returns the exit status for main() */
+int check_done(void);
+
+/** In-memory DB backend on $DB_MEM_SEED, else CHECK_DEFAULT_SEED */
+bool check_db_init(void);
+
+//==============================================================================
+// CAPTURED FRAMES
+//==============================================================================
+
+#define CHECK_FRAME_PAYLOAD 1024    // longer payloads are cut
+
+typedef struct {
+    int fd;
+    uint16_t command;
+    uint32_t length;                // as sent, may exceed what was kept
+    char payload[CHECK_FRAME_PAYLOAD];
+} check_frame_t;
+
+/** Frames sent to fd with this command since the last check_frames_clear */
+int check_frames_count(int fd, uint16_t command);
+
+/** Latest such frame, NULL if none */
+const check_frame_t* check_frames_last(int fd, uint16_t command);
+
+void check_frames_clear(void);
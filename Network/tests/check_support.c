@@ -0,0 +1,113 @@
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "check.h"
+#include "protocol/protocol.h"
+#include "db/core/db_client.h"
+#include "db/core/db_config.h"
+
+int g_check_failures = 0;
+
+static const char *g_name = "check";
+static FILE *g_out = NULL;
+
+static check_frame_t *g_frames = NULL;
+static int g_frame_count = 0;
+static int g_frame_cap = 0;
+
+//==============================================================================
+// FAKE TRANSPORT
+// Replaces transport/socket_server.c
+//==============================================================================
+
+void forward_response(
+    int client_fd,
+    MessageHeader *req,
+    uint16_t cmd,
+    const char *payload,
+    uint32_t payload_len
+) {
+    (void)req;
+    if (client_fd <= 0) return;
+    if (!payload) payload_len = 0;
+
+    if (g_frame_count == g_frame_cap) {
+        int cap = g_frame_cap ? g_frame_cap * 2 : 64;
+        check_frame_t *frames = realloc(g_frames, (size_t)cap * sizeof(*frames));
+        if (!frames) return;
+        g_frames = frames;
+        g_frame_cap = cap;
+    }
+
+    check_frame_t *f = &g_frames[g_frame_count++];
+    f->fd = client_fd;
+    f->command = cmd;
+    f->length = payload_len;
+    uint32_t keep = payload_len < CHECK_FRAME_PAYLOAD - 1 ? payload_len : CHECK_FRAME_PAYLOAD - 1;
+    if (keep > 0) memcpy(f->payload, payload, keep);
+    f->payload[keep] = '\0';
+}
+
+int check_frames_count(int fd, uint16_t command) {
+    int n = 0;
+    for (int i = 0; i < g_frame_count; i++) {
+        if (g_frames[i].fd == fd && g_frames[i].command == command) n++;
+    }
+    return n;
+}
+
+const check_frame_t* check_frames_last(int fd, uint16_t command) {
+    for (int i = g_frame_count - 1; i >= 0; i--) {
+        if (g_frames[i].fd == fd && g_frames[i].command == command) return &g_frames[i];
+    }
+    return NULL;
+}
+
+void check_frames_clear(void) {
+    g_frame_count = 0;
+}
+
+//==============================================================================
+// RUN
+//==============================================================================
+
+void check_begin(const char *name) {
+    g_name = name;
+    g_out = fdopen(dup(STDOUT_FILENO), "w");
+    if (!g_out) g_out = stderr;
+
+    if (!getenv("CHECK_VERBOSE")) {
+        int devnull = open("/dev/null", O_WRONLY);
+        if (devnull >= 0) {
+            dup2(devnull, STDOUT_FILENO);
+            close(devnull);
+        }
+    }
+}
+
+int check_done(void) {
+    fflush(stdout);
+    fprintf(g_out, "%-24s %s", g_name, g_check_failures == 0 ? "ok" : "FAILED");
+    if (g_check_failures > 0) fprintf(g_out, " (%d check(s))", g_check_failures);
+    fprintf(g_out, "\n");
+    fflush(g_out);
+
+    free(g_frames);
+    g_frames = NULL;
+    g_frame_count = g_frame_cap = 0;
+    return g_check_failures == 0 ? 0 : 1;
+}
+
+bool check_db_init(void) {
+    setenv(ENV_DB_BACKEND, DB_BACKEND_MEMORY, 1);
+    setenv(ENV_DB_MEM_SEED, CHECK_DEFAULT_SEED, 0);
+    if (db_client_init() != DB_OK) {
+        fprintf(stderr, "  %s: in-memory DB did not load (%s=%s)\n",
+                g_name, ENV_DB_MEM_SEED, getenv(ENV_DB_MEM_SEED));
+        g_check_failures++;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,156 @@
+#include <stdlib.h>
+#include <string.h>
+#include <cjson/cJSON.h>
+
+#include "check.h"
+#include "db/core/db_client.h"
+#include "db/repo/match_repo.h"
+#include "db/repo/recent_questions.h"
+
+// In-memory backend: the multi-table statements the repos send (history
+// and recent-questions JOINs, the write-behind batch) and the error for
+// statements it cannot run.
+
+#define DM_ACCOUNT      9701        // above the seed accounts
+#define DM_MATCH        9501
+#define DM_PLAYER       9601        // match_players.id
+#define DM_QUESTION     77          // questions.id in match_question.question
+
+static db_error_t run(const char *sql, cJSON **out) {
+    return db_get("test", sql, out);
+}
+
+static int select_int(const char *sql, const char *col) {
+    cJSON *rows = NULL;
+    int v = -1;
+    if (run(sql, &rows) == DB_OK && cJSON_GetArraySize(rows) == 1) {
+        const cJSON *c = cJSON_GetObjectItem(cJSON_GetArrayItem(rows, 0), col);
+        if (cJSON_IsNumber(c)) v = c->valueint;
+        else if (cJSON_IsBool(c)) v = cJSON_IsTrue(c);
+    }
+    cJSON_Delete(rows);
+    return v;
+}
+
+static void setup(void) {
+    char sql[512];
+    snprintf(sql, sizeof(sql),
+             "INSERT INTO profiles (account_id, name, points) VALUES (%d, 'dm', 20);"
+             "INSERT INTO matches (id, room_id, mode, max_players, started_at) VALUES "
+             "(%d, 1, 'scoring', 4, NOW()), (%d, 1, 'elimination', 4, NOW());"
+             "INSERT INTO match_players (id, match_id, account_id) VALUES "
+             "(%d, %d, %d), (%d, %d, %d), (%d, %d, %d);"
+             "INSERT INTO match_question (match_id, round_no, round_type, question_idx, question) "
+             "VALUES (%d, 1, 'mcq', 0, '{\"id\": %d}'::jsonb)",
+             DM_ACCOUNT,
+             DM_MATCH, DM_MATCH + 1,
+             DM_PLAYER, DM_MATCH, DM_ACCOUNT,
+             DM_PLAYER + 1, DM_MATCH, DM_ACCOUNT + 1,
+             DM_PLAYER + 2, DM_MATCH + 1, DM_ACCOUNT,
+             DM_MATCH, DM_QUESTION);
+    CHECK_INT(run(sql, NULL), DB_OK);
+}
+
+static void check_rejected(void) {
+    cJSON *out = NULL;
+    CHECK_INT(run("WITH x AS (SELECT id FROM matches) SELECT id FROM x", &out), DB_ERROR_NOT_IMPLEMENTED);
+    CHECK(out == NULL);
+    CHECK_INT(run("SELECT m.id FROM matches m LEFT JOIN match_players mp ON mp.match_id = m.id", NULL),
+              DB_ERROR_NOT_IMPLEMENTED);
+    CHECK_INT(run("SELECT id FROM no_such_table", NULL), DB_ERROR_NOT_IMPLEMENTED);
+
+    // A script is parsed whole before it runs: nothing of it is applied
+    char sql[256];
+    snprintf(sql, sizeof(sql),
+             "UPDATE profiles SET wins = 99 WHERE account_id = %d; SELECT count(*) FROM profiles",
+             DM_ACCOUNT);
+    CHECK_INT(run(sql, NULL), DB_ERROR_NOT_IMPLEMENTED);
+    snprintf(sql, sizeof(sql), "SELECT wins FROM profiles WHERE account_id = %d", DM_ACCOUNT);
+    CHECK_INT(select_int(sql, "wins"), 0);
+}
+
+static void check_history(void) {
+    HistoryRecord *recs = NULL;
+    int n = 0;
+    CHECK_INT(db_match_get_history(DM_ACCOUNT, 10, 0, &recs, &n), DB_OK);
+    CHECK_INT(n, 2);
+    if (n == 2) {
+        // Newest seat first
+        CHECK_INT(recs[0].match_id, DM_MATCH + 1);
+        CHECK_INT(recs[1].match_id, DM_MATCH);
+    }
+    free(recs);
+
+    CHECK_INT(db_match_get_history(DM_ACCOUNT, 10, 1, &recs, &n), DB_OK);
+    CHECK_INT(n, 1);
+    free(recs);
+}
+
+static void check_write_behind(void) {
+    // Same shapes as match_write_queue's batch
+    char sql[1024];
+    snprintf(sql, sizeof(sql),
+             "UPDATE match_players AS mp SET score = COALESCE(v.score, mp.score), "
+             "eliminated = COALESCE(v.eliminated, mp.eliminated), winner = COALESCE(v.winner, mp.winner) "
+             "FROM (VALUES (%d, 30::int, NULL::boolean, TRUE::boolean), (%d, NULL::int, TRUE::boolean, NULL::boolean)) "
+             "AS v(id, score, eliminated, winner) WHERE mp.id = v.id;"
+             "UPDATE profiles SET points = GREATEST(points + %d, 0), wins = wins + 1, matches = matches + 1 "
+             "WHERE account_id = %d AND EXISTS (SELECT 1 FROM matches WHERE id = %d AND ended_at IS NULL);"
+             "UPDATE matches SET ended_at = to_timestamp(1700000000.250)::timestamp WHERE id = %d",
+             DM_PLAYER, DM_PLAYER + 1, -50, DM_ACCOUNT, DM_MATCH, DM_MATCH);
+    CHECK_INT(run(sql, NULL), DB_OK);
+
+    char q[256];
+    snprintf(q, sizeof(q), "SELECT score, eliminated, winner FROM match_players WHERE id = %d", DM_PLAYER);
+    CHECK_INT(select_int(q, "score"), 30);
+    CHECK_INT(select_int(q, "eliminated"), 0);
+    CHECK_INT(select_int(q, "winner"), 1);
+    snprintf(q, sizeof(q), "SELECT score, eliminated, winner FROM match_players WHERE id = %d", DM_PLAYER + 1);
+    CHECK_INT(select_int(q, "score"), 0);
+    CHECK_INT(select_int(q, "eliminated"), 1);
+    CHECK_INT(select_int(q, "winner"), 0);
+
+    snprintf(q, sizeof(q), "SELECT points, wins, matches FROM profiles WHERE account_id = %d", DM_ACCOUNT);
+    CHECK_INT(select_int(q, "points"), 0);
+    CHECK_INT(select_int(q, "matches"), 1);
+
+    // Replayed batch: the match has ended, the profile is not paid twice
+    CHECK_INT(run(sql, NULL), DB_OK);
+    CHECK_INT(select_int(q, "matches"), 1);
+}
+
+static void check_preload(void) {
+    CHECK_INT(recent_questions_preload(), 0);
+
+    int32_t account = DM_ACCOUNT;
+    int32_t *ids = NULL;
+    int n = 0;
+    CHECK_INT(recent_questions_collect(&account, 1, RECENT_Q_MATCHES, &ids, &n), DB_OK);
+    CHECK_INT(n, 1);
+    if (n == 1) CHECK_INT(ids[0], DM_QUESTION);
+    free(ids);
+
+    // Past the preload window
+    char sql[256];
+    snprintf(sql, sizeof(sql),
+             "SELECT id FROM matches WHERE id = %d AND started_at > NOW() - INTERVAL '1 hour'", DM_MATCH);
+    CHECK_INT(select_int(sql, "id"), DM_MATCH);
+    snprintf(sql, sizeof(sql),
+             "SELECT id FROM matches WHERE id = %d AND started_at > NOW() + INTERVAL '1 hour'", DM_MATCH);
+    CHECK_INT(select_int(sql, "id"), -1);
+}
+
+int main(void) {
+    check_begin("db_mem");
+    if (!check_db_init()) return check_done();
+
+    setup();
+    check_rejected();
+    check_history();
+    check_write_behind();
+    check_preload();
+
+    recent_questions_cleanup();
+    db_client_cleanup();
+    return check_done();
+}
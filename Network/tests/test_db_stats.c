@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <string.h>
+#include <cjson/cJSON.h>
+
+#include "check.h"
+#include "db/core/db_client.h"
+#include "db/core/db_stats.h"
+
+// Statement stats: every call site is its own key, a multi-statement
+// script is not filed under its first statement, and keys past the table
+// go to "(other)" without evicting a real one.
+
+static db_stmt_stats_t g_snap[DB_STATS_MAX_STATEMENTS + 1];
+
+static const db_stmt_stats_t *find(int n, const char *prefix) {
+    for (int i = 0; i < n; i++) {
+        if (strncmp(g_snap[i].name, prefix, strlen(prefix)) == 0) return &g_snap[i];
+    }
+    return NULL;
+}
+
+static void check_call_sites(void) {
+    db_stats_reset();
+    CHECK_INT(db_get("profiles", "SELECT points FROM profiles WHERE account_id = 1", NULL), DB_OK);
+    CHECK_INT(db_get("profiles", "SELECT wins FROM profiles WHERE account_id = 1", NULL), DB_OK);
+    CHECK_INT(db_get("profiles", "UPDATE profiles SET wins = wins WHERE account_id = 1;"
+                                 "UPDATE profiles SET points = points WHERE account_id = 1", NULL), DB_OK);
+
+    int n = db_stats_snapshot(g_snap, DB_STATS_MAX_STATEMENTS + 1);
+    CHECK_INT(n, 3);
+    const db_stmt_stats_t *script = find(n, "SCRIPT profiles @test_db_stats.c:");
+    CHECK(script != NULL);
+    if (script) CHECK_INT(script->calls, 1);
+    CHECK(find(n, "UPDATE") == NULL);
+
+    int selects = 0;
+    for (int i = 0; i < n; i++) {
+        if (strncmp(g_snap[i].name, "SELECT profiles @test_db_stats.c:", 33) == 0) {
+            CHECK_INT(g_snap[i].calls, 1);
+            selects++;
+        }
+    }
+    CHECK_INT(selects, 2);
+}
+
+static void check_other(void) {
+    db_stats_reset();
+    char name[32];
+    for (int i = 0; i < DB_STATS_MAX_STATEMENTS + 10; i++) {
+        snprintf(name, sizeof(name), "SELECT t%d", i);
+        db_stats_record(name, NULL, 1.0, 1, true);
+    }
+
+    int n = db_stats_snapshot(g_snap, DB_STATS_MAX_STATEMENTS + 1);
+    CHECK_INT(n, DB_STATS_MAX_STATEMENTS + 1);
+    snprintf(name, sizeof(name), "SELECT t%d", DB_STATS_MAX_STATEMENTS - 1);
+    const db_stmt_stats_t *last = find(n, name);
+    CHECK(last != NULL);
+    if (last) CHECK_INT(last->calls, 1);
+    const db_stmt_stats_t *other = find(n, "(other)");
+    CHECK(other != NULL);
+    if (other) CHECK_INT(other->calls, 10);
+
+    db_stats_reset();
+    CHECK_INT(db_stats_snapshot(g_snap, DB_STATS_MAX_STATEMENTS + 1), 0);
+}
+
+int main(void) {
+    check_begin("db_stats");
+    if (!check_db_init()) return check_done();
+
+    check_call_sites();
+    check_other();
+
+    db_client_cleanup();
+    return check_done();
+}
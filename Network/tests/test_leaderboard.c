@@ -0,0 +1,130 @@
+#include <stdlib.h>
+#include <string.h>
+#include <cjson/cJSON.h>
+
+#include "check.h"
+#include "db/core/db_client.h"
+#include "db/repo/leaderboard.h"
+
+// Ranking after many incremental updates, checked against a plain model:
+// the pages must list every account by (points desc, account_id asc) and
+// agree with leaderboard_get
+
+#define LB_FIRST_ID     5001        // above the seed accounts
+#define LB_ACCOUNTS     600
+#define LB_UPDATES      20000
+
+static int32_t g_points[LB_ACCOUNTS];
+static int32_t g_wins[LB_ACCOUNTS];
+
+static void play_updates(void) {
+    srand(7);
+    for (int i = 0; i < LB_UPDATES; i++) {
+        int k = rand() % LB_ACCOUNTS;
+        int32_t delta = rand() % 200 - 60;     // losses clamp at 0
+        bool won = delta > 100;
+
+        int32_t points = g_points[k] + delta;
+        g_points[k] = points < 0 ? 0 : points;
+        if (won) g_wins[k]++;
+        leaderboard_record_result(LB_FIRST_ID + k, delta, won);
+    }
+}
+
+static void check_model(void) {
+    for (int k = 0; k < LB_ACCOUNTS; k++) {
+        leaderboard_entry_t e;
+        if (!leaderboard_get(LB_FIRST_ID + k, &e)) {
+            CHECK(!"account not ranked");
+            continue;
+        }
+        CHECK_INT(e.points, g_points[k]);
+        CHECK_INT(e.wins, g_wins[k]);
+    }
+}
+
+// Walk every page: ranks 1..size with no gap, ordered, matching leaderboard_get
+static void check_pages(void) {
+    int32_t size = leaderboard_size();
+    CHECK(size >= LB_ACCOUNTS);
+
+    int32_t seen = 0;
+    int32_t prev_points = 0, prev_id = 0;
+    for (int32_t offset = 0; offset < size; offset += LEADERBOARD_MAX_LIMIT) {
+        char *json = leaderboard_page(offset, LEADERBOARD_MAX_LIMIT, NULL, NULL);
+        cJSON *page = json ? cJSON_Parse(json) : NULL;
+        free(json);
+        if (!cJSON_IsArray(page)) {
+            CHECK(!"page is not a JSON array");
+            cJSON_Delete(page);
+            return;
+        }
+
+        cJSON *row = NULL;
+        cJSON_ArrayForEach(row, page) {
+            int32_t rank = (int32_t)cJSON_GetObjectItem(row, "rank")->valuedouble;
+            int32_t id = (int32_t)cJSON_GetObjectItem(row, "account_id")->valuedouble;
+            int32_t points = (int32_t)cJSON_GetObjectItem(row, "points")->valuedouble;
+
+            CHECK_INT(rank, seen + 1);
+            if (seen > 0) {
+                CHECK(points < prev_points || (points == prev_points && id > prev_id));
+            }
+
+            leaderboard_entry_t e;
+            CHECK(leaderboard_get(id, &e) && e.rank == rank && e.points == points);
+
+            prev_points = points;
+            prev_id = id;
+            seen++;
+        }
+        cJSON_Delete(page);
+    }
+    CHECK_INT(seen, size);
+
+    // Past the end
+    char *json = leaderboard_page(size, 5, NULL, NULL);
+    CHECK(json && strcmp(json, "[]") == 0);
+    free(json);
+    json = leaderboard_page(INT32_MAX, 5, NULL, NULL);
+    CHECK(json && strcmp(json, "[]") == 0);
+    free(json);
+}
+
+static void check_around(void) {
+    int32_t id = LB_FIRST_ID + LB_ACCOUNTS / 2;
+    leaderboard_entry_t e;
+    CHECK(leaderboard_get(id, &e));
+
+    char *json = leaderboard_around(id, 2, NULL, NULL);
+    cJSON *rows = json ? cJSON_Parse(json) : NULL;
+    free(json);
+    CHECK(cJSON_IsArray(rows));
+
+    bool found = false;
+    cJSON *row = NULL;
+    cJSON_ArrayForEach(row, rows) {
+        int32_t rank = (int32_t)cJSON_GetObjectItem(row, "rank")->valuedouble;
+        CHECK(rank >= e.rank - 2 && rank <= e.rank + 2);
+        if ((int32_t)cJSON_GetObjectItem(row, "account_id")->valuedouble == id) found = true;
+    }
+    CHECK(found);
+    cJSON_Delete(rows);
+}
+
+int main(void) {
+    check_begin("leaderboard");
+    if (!check_db_init()) return check_done();
+
+    CHECK_INT(leaderboard_preload(), 0);
+    CHECK(leaderboard_ready());
+
+    play_updates();
+    check_model();
+    check_pages();
+    check_around();
+
+    leaderboard_cleanup();
+    db_client_cleanup();
+    return check_done();
+}
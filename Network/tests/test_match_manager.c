@@ -0,0 +1,102 @@
+#include <stdlib.h>
+
+#include "check.h"
+#include "handlers/match_manager.h"
+
+// Routing a player to its match through the account index: a newer match
+// takes over, a match the player is still in play in comes before one it
+// was eliminated from, and ended or destroyed matches are dropped.
+// The executor is not running here, so no reap or watchdog timer fires.
+
+#define MM_ACCOUNT_A    9901
+#define MM_ACCOUNT_B    9902
+#define MM_ACCOUNT_C    9903
+#define MM_FIRST_ID     9911        // bulk accounts
+#define MM_MATCHES      600         // enough to grow every index
+#define MM_PER_MATCH    4
+
+static uint32_t create_id(const int32_t *accounts, int n) {
+    MatchState *match = match_create(0, accounts, n);
+    CHECK(match != NULL);
+    if (!match) return 0;
+    CHECK_INT(match->player_count, n);
+    for (int i = 0; i < n; i++) CHECK_INT(match->players[i].account_id, accounts[i]);
+    return match->runtime_match_id;
+}
+
+static void check_routing(void) {
+    int32_t first[] = { MM_ACCOUNT_A, MM_ACCOUNT_B };
+    uint32_t a = create_id(first, 2);
+    CHECK_INT(match_find_id_by_player(MM_ACCOUNT_A), a);
+    CHECK_INT(match_find_id_by_player(MM_ACCOUNT_B), a);
+    CHECK_INT(match_find_id_by_player(MM_ACCOUNT_C), 0);
+
+    // A is eliminated: still found in the old match until it plays another
+    match_player_out(match_get_by_id(a), MM_ACCOUNT_A);
+    CHECK_INT(match_find_id_by_player(MM_ACCOUNT_A), a);
+
+    int32_t second[] = { MM_ACCOUNT_A, MM_ACCOUNT_C };
+    uint32_t b = create_id(second, 2);
+    CHECK_INT(match_find_id_by_player(MM_ACCOUNT_A), b);
+    CHECK_INT(match_find_id_by_player(MM_ACCOUNT_B), a);
+    CHECK_INT(match_find_id_by_player(MM_ACCOUNT_C), b);
+
+    // Out of a match it is not indexed to: nothing changes
+    match_player_out(match_get_by_id(a), MM_ACCOUNT_A);
+    CHECK_INT(match_find_id_by_player(MM_ACCOUNT_A), b);
+
+    // Ended: no longer routed there, A falls back to the match it was
+    // eliminated from
+    match_set_status(match_get_by_id(b), MATCH_ENDED);
+    CHECK_INT(match_find_id_by_player(MM_ACCOUNT_C), 0);
+    CHECK_INT(match_find_id_by_player(MM_ACCOUNT_A), a);
+    CHECK(match_get_by_id(b) != NULL);
+
+    match_destroy(a);
+    CHECK_INT(match_find_id_by_player(MM_ACCOUNT_A), 0);
+    CHECK_INT(match_find_id_by_player(MM_ACCOUNT_B), 0);
+    match_destroy(b);
+    CHECK_INT(match_get_count(), 0);
+}
+
+static void check_bulk(void) {
+    static uint32_t ids[MM_MATCHES];
+    for (int m = 0; m < MM_MATCHES; m++) {
+        int32_t accounts[MM_PER_MATCH];
+        for (int i = 0; i < MM_PER_MATCH; i++) accounts[i] = MM_FIRST_ID + m * MM_PER_MATCH + i;
+        ids[m] = create_id(accounts, MM_PER_MATCH);
+    }
+    CHECK_INT(match_get_count(), MM_MATCHES);
+
+    // Every other match loses its first player
+    for (int m = 0; m < MM_MATCHES; m += 2) {
+        match_player_out(match_get_by_id(ids[m]), MM_FIRST_ID + m * MM_PER_MATCH);
+    }
+    for (int m = 0; m < MM_MATCHES; m++) {
+        for (int i = 0; i < MM_PER_MATCH; i++) {
+            CHECK_INT(match_find_id_by_player(MM_FIRST_ID + m * MM_PER_MATCH + i), ids[m]);
+        }
+    }
+
+    // Destroy in an order unlike the insertions (backward-shift deletes)
+    for (int m = MM_MATCHES - 1; m >= 0; m -= 2) match_destroy(ids[m]);
+    for (int m = 0; m < MM_MATCHES; m += 2) match_destroy(ids[m]);
+    CHECK_INT(match_get_count(), 0);
+    for (int m = 0; m < MM_MATCHES; m++) {
+        CHECK_INT(match_find_id_by_player(MM_FIRST_ID + m * MM_PER_MATCH + 1), 0);
+    }
+}
+
+int main(void) {
+    check_begin("match_manager");
+    match_manager_init();
+
+    check_routing();
+    check_bulk();
+
+    int32_t too_many[MAX_MATCH_PLAYERS + 1] = {0};
+    CHECK(match_create(0, too_many, MAX_MATCH_PLAYERS + 1) == NULL);
+
+    match_manager_cleanup();
+    return check_done();
+}
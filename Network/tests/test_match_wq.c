@@ -0,0 +1,129 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <cjson/cJSON.h>
+
+#include "check.h"
+#include "db/core/db_client.h"
+#include "db/repo/match_write_queue.h"
+#include "db/repo/replay_cache.h"
+
+// Write-behind queue: the end-of-match flush returns at once and reports
+// through its callback once the batch is in; the batch (bonus question
+// included) lands whole and the writer caches the finished match's replay.
+
+#define WQ_MATCH        9801
+#define WQ_PLAYER       9811        // match_players.id
+#define WQ_ACCOUNT      9821
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_cond = PTHREAD_COND_INITIALIZER;
+static int g_calls;
+static db_error_t g_result;
+static int g_pending_at_callback;
+
+static void on_flushed(int64_t db_match_id, db_error_t result, void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_lock);
+    CHECK_INT(db_match_id, WQ_MATCH);
+    g_calls++;
+    g_result = result;
+    g_pending_at_callback = match_wq_pending();
+    pthread_cond_broadcast(&g_cond);
+    pthread_mutex_unlock(&g_lock);
+}
+
+// Wait up to ms for the callback
+static int wait_calls(int want, int ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (long)(ms % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    pthread_mutex_lock(&g_lock);
+    while (g_calls < want) {
+        if (pthread_cond_timedwait(&g_cond, &g_lock, &ts) != 0) break;
+    }
+    int n = g_calls;
+    pthread_mutex_unlock(&g_lock);
+    return n;
+}
+
+static int select_int(const char *sql, const char *col) {
+    cJSON *rows = NULL;
+    int v = -1;
+    if (db_get("test", sql, &rows) == DB_OK && cJSON_GetArraySize(rows) == 1) {
+        const cJSON *c = cJSON_GetObjectItem(cJSON_GetArrayItem(rows, 0), col);
+        if (cJSON_IsNumber(c)) v = c->valueint;
+        else if (cJSON_IsBool(c)) v = cJSON_IsTrue(c);
+    }
+    cJSON_Delete(rows);
+    return v;
+}
+
+int main(void) {
+    check_begin("match_wq");
+    setenv(ENV_REPLAY_CACHE_PREWARM, "1", 1);
+    if (!check_db_init()) return check_done();
+
+    char sql[512];
+    snprintf(sql, sizeof(sql),
+             "INSERT INTO matches (id, room_id, mode, max_players, started_at) VALUES (%d, 1, 'scoring', 4, NOW());"
+             "INSERT INTO match_players (id, match_id, account_id) VALUES (%d, %d, %d);"
+             "INSERT INTO profiles (account_id, name) VALUES (%d, 'wq')",
+             WQ_MATCH, WQ_PLAYER, WQ_MATCH, WQ_ACCOUNT, WQ_ACCOUNT);
+    CHECK_INT(db_get("test", sql, NULL), DB_OK);
+
+    match_wq_init();
+
+    // No DB row (match started without one, player ids not fetched): counted, not queued
+    match_wq_player_update(WQ_MATCH, 0, MWQ_SET_SCORE, 10, false, false);
+    match_wq_match_ended(0, time(NULL));
+    CHECK_INT(match_wq_skipped(), 2);
+    CHECK_INT(match_wq_pending(), 0);
+
+    // Nothing queued: the callback runs on the caller, right away
+    match_wq_flush(WQ_MATCH, MATCH_WQ_FLUSH_TIMEOUT_MS, on_flushed, NULL);
+    CHECK_INT(g_calls, 1);
+    CHECK_INT(g_result, DB_OK);
+
+    for (int i = 0; i < 10; i++) {
+        match_wq_answer(WQ_MATCH, 100 + i, WQ_PLAYER, "{\"choice\": 1}", 10, 1);
+    }
+    match_wq_player_update(WQ_MATCH, WQ_PLAYER, MWQ_SET_SCORE | MWQ_SET_WINNER, 100, false, true);
+    match_wq_profile_result(WQ_MATCH, WQ_ACCOUNT, 100, true);
+    match_wq_question(WQ_MATCH, 4, "BONUS", 0, "{\"type\": \"winner_selection\"}");
+    match_wq_match_ended(WQ_MATCH, time(NULL));
+
+    // The caller is not held: the batch is still queued when flush returns
+    match_wq_flush(WQ_MATCH, MATCH_WQ_FLUSH_TIMEOUT_MS, on_flushed, NULL);
+    CHECK(match_wq_pending() > 0 || g_calls == 2);
+
+    CHECK_INT(wait_calls(2, MATCH_WQ_FLUSH_TIMEOUT_MS), 2);
+    CHECK_INT(g_result, DB_OK);
+    CHECK_INT(g_pending_at_callback, 0);
+
+    snprintf(sql, sizeof(sql), "SELECT id FROM match_answer WHERE player_id = %d AND question_id = 109", WQ_PLAYER);
+    CHECK(select_int(sql, "id") > 0);
+    snprintf(sql, sizeof(sql), "SELECT score, winner FROM match_players WHERE id = %d", WQ_PLAYER);
+    CHECK_INT(select_int(sql, "score"), 100);
+    CHECK_INT(select_int(sql, "winner"), 1);
+    snprintf(sql, sizeof(sql), "SELECT points, wins FROM profiles WHERE account_id = %d", WQ_ACCOUNT);
+    CHECK_INT(select_int(sql, "points"), 100);
+    CHECK_INT(select_int(sql, "wins"), 1);
+    snprintf(sql, sizeof(sql), "SELECT id FROM match_question WHERE match_id = %d AND round_no = 4", WQ_MATCH);
+    CHECK(select_int(sql, "id") > 0);
+
+    // Warmed by the writer when it committed the end record
+    replay_cache_stats_t stats;
+    replay_cache_stats(&stats);
+    CHECK_INT(stats.entries, 1);
+
+    match_wq_shutdown();
+    db_client_cleanup();
+    return check_done();
+}
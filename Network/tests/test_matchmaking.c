@@ -0,0 +1,170 @@
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cjson/cJSON.h>
+
+#include "check.h"
+#include "protocol/opcode.h"
+#include "db/core/db_client.h"
+#include "handlers/matchmaking.h"
+#include "handlers/session_manager.h"
+#include "handlers/session_context.h"
+#include "transport/room_manager.h"
+
+// Tickets taken out of the middle of a bucket heap (cancel, disconnect):
+// the tick must still seat the remaining players oldest first, and never
+// a player who left
+
+#define MM_FIRST_ID     8001        // above the seed accounts
+#define MM_PLAYERS      300
+
+typedef struct {
+    int fd;
+    int32_t account_id;
+    bool left;                      // cancelled or disconnected
+} mm_player_t;
+
+static mm_player_t g_players[MM_PLAYERS];
+
+static void login_all(void) {
+    for (int i = 0; i < MM_PLAYERS; i++) {
+        mm_player_t *p = &g_players[i];
+        p->fd = open("/dev/null", O_RDWR);
+        p->account_id = MM_FIRST_ID + i;
+
+        char session_id[37];
+        snprintf(session_id, sizeof(session_id), "mm-session-%d", i);
+        MessageHeader hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        CHECK(session_bind_after_login(p->fd, p->account_id, session_id, &hdr) != NULL);
+        set_client_session(p->fd, session_id, p->account_id);
+    }
+}
+
+static void queue_all(void) {
+    QuickPlayPayload data;
+    memset(&data, 0, sizeof(data));
+    data.mode = MODE_ELIMINATION;
+
+    for (int i = 0; i < MM_PLAYERS; i++) {
+        MessageHeader hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.length = sizeof(data);
+        handle_quick_play(g_players[i].fd, &hdr, (const char*)&data);
+        CHECK_INT(check_frames_count(g_players[i].fd, RES_QUEUED), 1);
+    }
+}
+
+// Half the players leave, in random order, three different ways
+static int leave_some(void) {
+    srand(11);
+    int left = 0;
+    for (int i = 0; i < MM_PLAYERS; i++) {
+        mm_player_t *p = &g_players[i];
+        if (rand() % 2) continue;
+        p->left = true;
+        left++;
+
+        MessageHeader hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        switch (rand() % 3) {
+            case 0:
+                handle_quick_play_cancel(p->fd, &hdr, NULL);
+                CHECK_INT(check_frames_count(p->fd, RES_QUEUE_LEFT), 1);
+                break;
+            case 1:
+                matchmaking_cancel(p->account_id);
+                break;
+            default:
+                // Still queued: the tick finds it is no longer eligible
+                session_mark_disconnected(session_get_by_socket(p->fd));
+                clear_client_session(p->fd);
+                break;
+        }
+    }
+    return left;
+}
+
+static uint32_t room_of(const mm_player_t *p, bool *is_host) {
+    const check_frame_t *f = check_frames_last(p->fd, NTF_MATCH_FOUND);
+    if (!f) return 0;
+
+    cJSON *obj = cJSON_Parse(f->payload);
+    cJSON *room = cJSON_GetObjectItem(obj, "roomId");
+    cJSON *host = cJSON_GetObjectItem(obj, "isHost");
+    uint32_t room_id = cJSON_IsNumber(room) ? (uint32_t)room->valuedouble : 0;
+    if (is_host) *is_host = cJSON_IsTrue(host);
+    cJSON_Delete(obj);
+    return room_id;
+}
+
+// Written by the tick's batch insert
+static bool is_member(uint32_t room_id, int32_t account_id) {
+    char sql[128];
+    snprintf(sql, sizeof(sql), "SELECT room_id FROM room_members WHERE room_id = %u AND account_id = %d",
+             room_id, account_id);
+    cJSON *rows = NULL;
+    bool found = db_get("test", sql, &rows) == DB_OK && cJSON_GetArraySize(rows) == 1;
+    cJSON_Delete(rows);
+    return found;
+}
+
+// Elimination rooms take 4: the stayers, in queue order, fill rooms of 4
+// and the last stayers (fewer than 4) keep waiting
+static void check_rooms(int stayers) {
+    int seated = 0;
+    uint32_t current = 0;
+    for (int i = 0; i < MM_PLAYERS; i++) {
+        const mm_player_t *p = &g_players[i];
+        bool is_host = false;
+        uint32_t room_id = room_of(p, &is_host);
+
+        if (p->left) {
+            CHECK(room_id == 0);
+            continue;
+        }
+        if (seated >= stayers - stayers % 4) {
+            CHECK(room_id == 0);
+            continue;
+        }
+
+        CHECK(room_id != 0);
+        if (seated % 4 == 0) {
+            CHECK(room_id != current);
+            CHECK(is_host);
+            current = room_id;
+        } else {
+            CHECK(room_id == current);
+            CHECK(!is_host);
+        }
+        CHECK_INT(check_frames_count(p->fd, NTF_MATCH_FOUND), 1);
+        CHECK(is_member(room_id, p->account_id));
+        seated++;
+    }
+
+    MatchmakingStats st;
+    matchmaking_get_stats(&st);
+    CHECK_INT(st.matched, seated);
+    CHECK_INT(st.queued, stayers % 4);
+    CHECK_INT(st.cancelled, MM_PLAYERS - stayers);
+}
+
+int main(void) {
+    check_begin("matchmaking");
+    if (!check_db_init()) return check_done();
+    session_manager_init();
+
+    login_all();
+    queue_all();
+    int stayers = MM_PLAYERS - leave_some();
+    CHECK(stayers > 8);
+
+    matchmaking_tick();
+    check_rooms(stayers);
+
+    matchmaking_cleanup();
+    for (int i = 0; i < MM_PLAYERS; i++) close(g_players[i].fd);
+    db_client_cleanup();
+    return check_done();
+}
@@ -0,0 +1,122 @@
+#include <stdlib.h>
+#include <cjson/cJSON.h>
+
+#include "check.h"
+#include "db/core/db_client.h"
+#include "db/repo/recent_questions.h"
+#include "db/repo/question_bank.h"
+#include "db/repo/question_repo.h"
+
+// Per-account rings of recent questions (look-back, eviction, union over
+// players) and the exclusion they feed into question sampling.
+// End to end (start_game -> end_game -> next start_game) is covered by the
+// match_sim run of make check (--max-repeat-pct).
+
+#define RQ_ACCOUNT_A    9101
+#define RQ_ACCOUNT_B    9102
+#define RQ_LOOK_BACK    3           // what start_game_handler asks for
+#define RQ_MATCHES      12
+#define RQ_PER_MATCH    5           // MCQ questions per match
+
+static bool contains(const int32_t *ids, int n, int32_t id) {
+    for (int i = 0; i < n; i++) {
+        if (ids[i] == id) return true;
+    }
+    return false;
+}
+
+static void check_rings(void) {
+    // A plays RECENT_Q_MATCHES + 1 matches with ids 1-5, 6-10, ...
+    for (int m = 0; m <= RECENT_Q_MATCHES; m++) {
+        int32_t ids[RQ_PER_MATCH];
+        for (int i = 0; i < RQ_PER_MATCH; i++) ids[i] = m * RQ_PER_MATCH + i + 1;
+        int32_t account = RQ_ACCOUNT_A;
+        recent_questions_record_match(&account, 1, ids, RQ_PER_MATCH);
+    }
+    int32_t last = (RECENT_Q_MATCHES + 1) * RQ_PER_MATCH;
+
+    int32_t account = RQ_ACCOUNT_A;
+    int32_t *ids = NULL;
+    int n = 0;
+    CHECK_INT(recent_questions_collect(&account, 1, RQ_LOOK_BACK, &ids, &n), DB_OK);
+    CHECK_INT(n, RQ_LOOK_BACK * RQ_PER_MATCH);
+    for (int32_t id = 1; id <= last; id++) {
+        CHECK(contains(ids, n, id) == (id > last - RQ_LOOK_BACK * RQ_PER_MATCH));
+    }
+    free(ids);
+
+    // The look-back is capped at the ring; the oldest match was evicted
+    CHECK_INT(recent_questions_collect(&account, 1, 100, &ids, &n), DB_OK);
+    CHECK_INT(n, RECENT_Q_MATCHES * RQ_PER_MATCH);
+    CHECK(!contains(ids, n, 1));
+    CHECK(contains(ids, n, RQ_PER_MATCH + 1));
+    free(ids);
+
+    // Union over players, without duplicates
+    int32_t b_ids[] = { last, last, 1000 };
+    int32_t b = RQ_ACCOUNT_B;
+    recent_questions_record_match(&b, 1, b_ids, 3);
+
+    int32_t both[] = { RQ_ACCOUNT_A, RQ_ACCOUNT_B };
+    CHECK_INT(recent_questions_collect(both, 2, 1, &ids, &n), DB_OK);
+    CHECK_INT(n, RQ_PER_MATCH + 1);
+    CHECK(contains(ids, n, last) && contains(ids, n, 1000));
+    free(ids);
+
+    // Nobody seen: no exclusion
+    int32_t nobody = 9199;
+    CHECK_INT(recent_questions_collect(&nobody, 1, RQ_LOOK_BACK, &ids, &n), DB_OK);
+    CHECK(ids == NULL && n == 0);
+}
+
+// Two players meet again and again: with the exclusion fed from the rings
+// neither of them is asked a question from its last RQ_LOOK_BACK matches
+static void check_no_repeats(void) {
+    int32_t players[] = { 9201, 9202 };
+    int32_t history[RQ_MATCHES][RQ_PER_MATCH];
+    int counts[RQ_MATCHES] = {0};
+    int repeats = 0, asked = 0;
+
+    for (int m = 0; m < RQ_MATCHES; m++) {
+        int32_t *excluded = NULL;
+        int excluded_count = 0;
+        CHECK_INT(recent_questions_collect(players, 2, RQ_LOOK_BACK, &excluded, &excluded_count), DB_OK);
+
+        cJSON *rows = NULL;
+        CHECK_INT(question_get_random("mcq", RQ_PER_MATCH, excluded, excluded_count, NULL, &rows), DB_OK);
+        free(excluded);
+
+        cJSON *row = NULL;
+        cJSON_ArrayForEach(row, rows) {
+            cJSON *id = cJSON_GetObjectItem(row, "id");
+            if (!cJSON_IsNumber(id) || counts[m] == RQ_PER_MATCH) continue;
+            int32_t qid = (int32_t)id->valuedouble;
+            for (int k = m - RQ_LOOK_BACK; k < m; k++) {
+                if (k >= 0 && contains(history[k], counts[k], qid)) repeats++;
+            }
+            history[m][counts[m]++] = qid;
+            asked++;
+        }
+        cJSON_Delete(rows);
+
+        recent_questions_record_match(players, 2, history[m], counts[m]);
+    }
+
+    CHECK_INT(asked, RQ_MATCHES * RQ_PER_MATCH);
+    CHECK_INT(repeats, 0);
+}
+
+int main(void) {
+    check_begin("recent_questions");
+    if (!check_db_init()) return check_done();
+
+    check_rings();
+
+    CHECK_INT(question_bank_init(), 0);
+    check_no_repeats();
+
+    question_bank_shutdown();
+    recent_questions_cleanup();
+    db_client_cleanup();
+    return check_done();
+}
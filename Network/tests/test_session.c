@@ -0,0 +1,107 @@
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "check.h"
+#include "handlers/session_manager.h"
+#include "handlers/session_context.h"
+
+// Session validation when the kernel hands a closed client's fd number to
+// the next connection: the old session must not answer for it
+
+static int open_client(void) {
+    // force_logout_old_socket() closes the old fd: it has to be a real one
+    return open("/dev/null", O_RDWR);
+}
+
+static UserSession* login(int fd, int32_t account_id, const char *session_id) {
+    MessageHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    UserSession *s = session_bind_after_login(fd, account_id, session_id, &hdr);
+    if (s) set_client_session(fd, session_id, account_id);
+    return s;
+}
+
+static void disconnect(int fd) {
+    // Same order as the socket layer's disconnect path
+    session_mark_disconnected(session_get_by_socket(fd));
+    clear_client_session(fd);
+}
+
+static void check_plain_login(void) {
+    int fd = open_client();
+    UserSession *s = login(fd, 101, "session-a");
+    CHECK(s != NULL);
+    CHECK(session_validate_socket(fd, "session-a"));
+    CHECK(!session_validate_socket(fd, "session-b"));
+    CHECK(!session_validate_socket(fd + 1, "session-a"));
+    CHECK(!session_validate_socket(0, "session-a"));
+
+    disconnect(fd);
+    CHECK(!session_validate_socket(fd, "session-a"));
+    CHECK(session_get_by_socket(fd) == NULL);
+    close(fd);
+}
+
+static void check_fd_reuse(void) {
+    int fd = open_client();
+    CHECK(login(fd, 201, "session-old") != NULL);
+    disconnect(fd);
+
+    // A new client gets the same fd number before the old slot is swept
+    CHECK(login(fd, 202, "session-new") != NULL);
+    CHECK(session_validate_socket(fd, "session-new"));
+    CHECK(!session_validate_socket(fd, "session-old"));
+
+    UserSession *s = session_get_by_socket(fd);
+    CHECK(s != NULL && s->account_id == 202);
+
+    UserSession *old = session_get_by_account(201);
+    CHECK(old != NULL && old->socket_fd == 0);
+
+    // The old account logs in again elsewhere: the new client keeps its fd
+    int fd2 = open_client();
+    CHECK(login(fd2, 201, "session-again") != NULL);
+    CHECK(session_validate_socket(fd2, "session-again"));
+    CHECK(session_validate_socket(fd, "session-new"));
+    CHECK(get_client_account(fd) == 202);
+
+    disconnect(fd2);
+    disconnect(fd);
+    close(fd2);
+    close(fd);
+}
+
+static void check_reuse_during_match(void) {
+    int fd = open_client();
+    UserSession *s = login(fd, 301, "session-playing");
+    session_mark_playing(s);
+    disconnect(fd);
+    CHECK(s->state == SESSION_PLAYING_DISCONNECTED);
+
+    CHECK(login(fd, 302, "session-other") != NULL);
+    CHECK(session_validate_socket(fd, "session-other"));
+    CHECK(!session_validate_socket(fd, "session-playing"));
+
+    // Reconnect of the player on a fresh fd
+    int fd2 = open_client();
+    UserSession *back = login(fd2, 301, "session-playing");
+    CHECK(back == s && s->state == SESSION_PLAYING && s->socket_fd == fd2);
+    CHECK(session_get_by_socket(fd)->account_id == 302);
+
+    disconnect(fd2);
+    disconnect(fd);
+    close(fd2);
+    close(fd);
+}
+
+int main(void) {
+    check_begin("session");
+    session_manager_init();
+
+    check_plain_login();
+    check_fd_reuse();
+    check_reuse_during_match();
+
+    return check_done();
+}
@@ -0,0 +1,126 @@
+#include <string.h>
+
+#include "check.h"
+#include "db/core/db_client.h"
+#include "db/repo/user_index.h"
+
+// Search order (exact, prefix, fuzzy), email privacy and renames
+
+#define UI_FIRST_ID     7001        // above the seed accounts
+
+static int search(const char *query, int32_t exclude, user_index_hit_t *hits) {
+    return user_index_search(query, exclude, USER_INDEX_MAX_LIMIT, hits);
+}
+
+static int find_hit(const user_index_hit_t *hits, int n, int32_t account_id) {
+    for (int i = 0; i < n; i++) {
+        if (hits[i].account_id == account_id) return i;
+    }
+    return -1;
+}
+
+static void add_user(int32_t id, const char *email, const char *name) {
+    user_index_put_account(id, email);
+    user_index_put_profile(id, name, NULL);
+}
+
+static void check_order(void) {
+    user_index_hit_t hits[USER_INDEX_MAX_LIMIT];
+
+    // Exact name first, then prefixes of the name or of one of its words
+    int n = search("quizmaster", 0, hits);
+    CHECK(n >= 3);
+    CHECK(n > 0 && hits[0].account_id == UI_FIRST_ID);
+    CHECK(find_hit(hits, n, UI_FIRST_ID + 1) > 0);
+    CHECK(find_hit(hits, n, UI_FIRST_ID + 2) > 0);
+    CHECK(find_hit(hits, n, UI_FIRST_ID + 3) < 0);
+    user_index_hits_free(hits, n);
+
+    n = search("Pham", 0, hits);
+    CHECK(find_hit(hits, n, UI_FIRST_ID + 2) >= 0);
+    user_index_hits_free(hits, n);
+
+    // Fuzzy: one swapped letter
+    n = search("quizmatser", 0, hits);
+    CHECK(find_hit(hits, n, UI_FIRST_ID) >= 0);
+    user_index_hits_free(hits, n);
+
+    // The searcher is left out
+    n = search("quizmaster", UI_FIRST_ID, hits);
+    CHECK(find_hit(hits, n, UI_FIRST_ID) < 0);
+    user_index_hits_free(hits, n);
+
+    n = search("zzzzqqqq", 0, hits);
+    CHECK_INT(n, 0);
+}
+
+static void check_email_privacy(void) {
+    user_index_hit_t hits[USER_INDEX_MAX_LIMIT];
+
+    // Part of an address finds nobody by email
+    int n = search("hidden.mailbox", 0, hits);
+    CHECK(find_hit(hits, n, UI_FIRST_ID + 3) < 0);
+    for (int i = 0; i < n; i++) CHECK(hits[i].email == NULL);
+    user_index_hits_free(hits, n);
+
+    n = search("@example.org", 0, hits);
+    CHECK(find_hit(hits, n, UI_FIRST_ID + 3) < 0);
+    user_index_hits_free(hits, n);
+
+    // The full address does, and only that hit carries it
+    n = search("Hidden.Mailbox@example.org", 0, hits);
+    int at = find_hit(hits, n, UI_FIRST_ID + 3);
+    CHECK(at == 0);
+    CHECK(at == 0 && hits[0].email && strcmp(hits[0].email, "hidden.mailbox@example.org") == 0);
+    for (int i = 1; i < n; i++) CHECK(hits[i].email == NULL);
+    user_index_hits_free(hits, n);
+
+    // Name hits never carry an email
+    n = search("quizmaster", 0, hits);
+    for (int i = 0; i < n; i++) CHECK(hits[i].email == NULL);
+    user_index_hits_free(hits, n);
+}
+
+static void check_rename(void) {
+    user_index_hit_t hits[USER_INDEX_MAX_LIMIT];
+
+    user_index_put_profile(UI_FIRST_ID + 4, "Nguyen Van Newbie", NULL);
+    int n = search("newb", 0, hits);
+    CHECK(find_hit(hits, n, UI_FIRST_ID + 4) >= 0);
+    user_index_hits_free(hits, n);
+
+    user_index_put_profile(UI_FIRST_ID + 4, "Renamed Person", NULL);
+    n = search("newbie", 0, hits);
+    CHECK(find_hit(hits, n, UI_FIRST_ID + 4) < 0);
+    user_index_hits_free(hits, n);
+
+    n = search("renam", 0, hits);
+    CHECK(n > 0 && hits[0].account_id == UI_FIRST_ID + 4);
+    user_index_hits_free(hits, n);
+
+    n = search("pers", 0, hits);
+    CHECK(find_hit(hits, n, UI_FIRST_ID + 4) >= 0);
+    user_index_hits_free(hits, n);
+}
+
+int main(void) {
+    check_begin("user_index");
+    if (!check_db_init()) return check_done();
+
+    CHECK_INT(user_index_preload(), 0);
+    CHECK(user_index_ready());
+
+    add_user(UI_FIRST_ID,     "qm@example.org", "Quizmaster");
+    add_user(UI_FIRST_ID + 1, "qm2@example.org", "Quizmaster Junior");
+    add_user(UI_FIRST_ID + 2, "qm3@example.org", "Pham Quizmaster");
+    add_user(UI_FIRST_ID + 3, "hidden.mailbox@example.org", "Someone Else");
+    add_user(UI_FIRST_ID + 4, "newbie@example.org", NULL);
+
+    check_order();
+    check_email_privacy();
+    check_rename();
+
+    user_index_cleanup();
+    db_client_cleanup();
+    return check_done();
+}
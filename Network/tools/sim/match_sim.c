@@ -0,0 +1,1072 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <endian.h>
+#include <arpa/inet.h>
+#include <cjson/cJSON.h>
+
+#include "sim.h"
+#include "protocol/opcode.h"
+#include "protocol/protocol.h"
+#include "db/core/db_client.h"
+#include "db/core/db_config.h"
+#include "db/repo/account_repo.h"
+#include "db/repo/profile_repo.h"
+#include "db/repo/match_write_queue.h"
+#include "db/repo/question_bank.h"
+#include "db/repo/recent_questions.h"
+#include "db/repo/leaderboard.h"
+#include "db/repo/replay_cache.h"
+#include "db/repo/account_cache.h"
+#include "handlers/dispatcher.h"
+#include "handlers/session_manager.h"
+#include "handlers/session_context.h"
+#include "handlers/match_manager.h"
+#include "handlers/round1_handler.h"
+#include "handlers/round2_handler.h"
+#include "handlers/round3_handler.h"
+#include "handlers/bonus_handler.h"
+#include "handlers/end_game_handler.h"
+#include "handlers/forfeit_handler.h"
+#include "transport/room_manager.h"
+#include "utils/startup.h"
+
+/**
+ * match_sim - Headless match simulator and throughput benchmark
+ *
+ * Plays synthetic matches from CMD_START_GAME to the end-game screen with
+ * bot clients, through the real dispatcher and round / bonus / end-game
+ * handlers, on the in-memory DB backend (see sim.h for the stand-ins).
+ * Round timers fire on a virtual clock and bot answers arrive after their
+ * think time on that clock (answers are timed by the server), so a run
+ * measures handler CPU, not game time. With the same seed and options two
+ * runs play the same matches and print the same outcome digest.
+ */
+
+#define SIM_DEFAULT_MATCHES     1000
+#define SIM_DEFAULT_PLAYERS     4
+#define SIM_DEFAULT_CONCURRENT  16
+#define SIM_DEFAULT_QUESTIONS   20      // synthetic questions added per round type
+#define SIM_MAX_FD              4096
+#define SIM_STALL_MS            (30 * 60 * 1000)    // virtual time before a match counts as stalled
+#define SIM_SKIP_ONE_IN         16                  // random bots let ~1/16 questions time out
+#define SIM_REPEAT_WINDOW       3                   // matches start_game excludes questions from
+#define SIM_SEEN_PER_MATCH      32
+
+typedef enum {
+    SIM_MODE_SCORING = 0,
+    SIM_MODE_ELIMINATION,
+    SIM_MODE_MIXED
+} sim_mode_t;
+
+typedef enum {
+    PH_DISPATCH = 0,        // dispatcher routing (posting to the executor)
+    PH_START,               // handle_start_game (inline on the dispatcher)
+    PH_ROUND1,
+    PH_ROUND2,
+    PH_ROUND3,
+    PH_BONUS,
+    PH_END,                 // end game, back to lobby, reap
+    PH_COUNT
+} sim_phase_t;
+
+static const char *PHASE_NAMES[PH_COUNT] = {
+    "dispatch", "start_game", "round1", "round2", "round3", "bonus", "end_game"
+};
+
+typedef struct {
+    uint64_t tasks;
+    uint64_t cpu_ns;
+    uint64_t allocs;
+    uint64_t bytes;
+} sim_phase_stats_t;
+
+typedef struct {
+    int fd;
+    int32_t account_id;
+    int seat;
+    int slot;               // owning slot
+    uint64_t rng;
+    uint32_t match_id;      // current match, 0 between matches
+    int outbox;             // commands queued, not yet dispatched
+    int pending_back;       // BACK_LOBBY sent, ack not received
+    int32_t seen[SIM_REPEAT_WINDOW][SIM_SEEN_PER_MATCH];   // questions.id, last matches (ring)
+    int seen_count[SIM_REPEAT_WINDOW];
+    int seen_pos;
+} sim_bot_t;
+
+typedef struct {
+    bool active;
+    uint32_t room_id;
+    uint32_t match_id;
+    int first_bot;
+    int64_t started_ms;     // virtual
+} sim_slot_t;
+
+typedef struct {
+    int bot;
+    uint16_t command;
+    uint32_t length;
+    int64_t due_ms;         // virtual, delayed commands only
+    char payload[16];
+} sim_cmd_t;
+
+static struct {
+    int matches;
+    int players;
+    int concurrent;
+    int questions;
+    uint64_t seed;
+    sim_mode_t mode;
+    bool scripted;
+    bool verbose;
+    double max_repeat_pct;  // < 0 = no limit
+} g_opt = {
+    SIM_DEFAULT_MATCHES, SIM_DEFAULT_PLAYERS, SIM_DEFAULT_CONCURRENT, SIM_DEFAULT_QUESTIONS,
+    1, SIM_MODE_MIXED, false, false, -1.0
+};
+
+static sim_bot_t *g_bots = NULL;
+static int g_bot_count = 0;
+static int g_bot_by_fd[SIM_MAX_FD];     // index + 1, 0 = not a bot
+
+static sim_slot_t *g_slots = NULL;
+
+static sim_cmd_t *g_outbox = NULL;      // FIFO, g_out_head..g_out_tail
+static int g_out_head = 0;
+static int g_out_tail = 0;
+static int g_out_cap = 0;
+
+static sim_cmd_t *g_later = NULL;       // delayed commands, in push order
+static int g_later_count = 0;
+static int g_later_cap = 0;
+
+static sim_phase_stats_t g_phase[PH_COUNT];
+static int g_cur_phase = -1;
+static uint64_t g_cur_cpu_ns;
+static sim_alloc_stats_t g_cur_alloc;
+
+static uint32_t g_next_room_id = 1;
+static uint32_t g_seq = 1;
+static int g_started = 0;
+static int g_completed = 0;
+static int g_stalled = 0;
+static int g_failed = 0;
+static int64_t g_virtual_total_ms = 0;
+static uint64_t g_digest = 1469598103934665603ULL;   // FNV-1a offset basis
+static uint64_t g_questions_seen = 0;       // per player, completed matches
+static uint64_t g_questions_repeated = 0;   // ... already seen in its last SIM_REPEAT_WINDOW
+
+//==============================================================================
+// HELPERS
+//==============================================================================
+
+static uint64_t cpu_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t next_rand(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+static void digest_add(int64_t v) {
+    for (int i = 0; i < 8; i++) {
+        g_digest ^= (uint64_t)(v >> (i * 8)) & 0xFF;
+        g_digest *= 1099511628211ULL;
+    }
+}
+
+static sim_bot_t* bot_by_fd(int fd) {
+    if (fd <= 0 || fd >= SIM_MAX_FD || g_bot_by_fd[fd] == 0) return NULL;
+    return &g_bots[g_bot_by_fd[fd] - 1];
+}
+
+static bool bot_eliminated(const sim_bot_t *bot) {
+    MatchState *match = match_get_by_id(bot->match_id);
+    if (!match) return true;
+    for (int i = 0; i < match->player_count; i++) {
+        if (match->players[i].account_id == bot->account_id) {
+            return match->players[i].eliminated != 0;
+        }
+    }
+    return true;
+}
+
+//==============================================================================
+// TASK ACCOUNTING
+//==============================================================================
+
+static void phase_begin(sim_phase_t phase) {
+    g_cur_phase = (int)phase;
+    sim_alloc_thread_stats(&g_cur_alloc);
+    g_cur_cpu_ns = cpu_ns(CLOCK_THREAD_CPUTIME_ID);
+}
+
+static void phase_end(void) {
+    if (g_cur_phase < 0) return;
+    uint64_t now = cpu_ns(CLOCK_THREAD_CPUTIME_ID);
+    sim_alloc_stats_t a;
+    sim_alloc_thread_stats(&a);
+
+    sim_phase_stats_t *ps = &g_phase[g_cur_phase];
+    ps->tasks++;
+    ps->cpu_ns += now - g_cur_cpu_ns;
+    ps->allocs += a.allocs - g_cur_alloc.allocs;
+    ps->bytes += a.bytes - g_cur_alloc.bytes;
+    g_cur_phase = -1;
+}
+
+// Timers and disconnects carry no handler: use the match's current phase
+static sim_phase_t phase_of_match(uint32_t match_id) {
+    MatchState *match = match_get_by_id(match_id);
+    if (!match || match->status == MATCH_ENDED) return PH_END;
+    if (is_bonus_active(match_id)) return PH_BONUS;
+
+    switch (match->rounds[match->current_round_idx].type) {
+        case ROUND_MCQ:   return PH_ROUND1;
+        case ROUND_BID:   return PH_ROUND2;
+        case ROUND_WHEEL: return PH_ROUND3;
+        default:          return PH_BONUS;
+    }
+}
+
+void sim_task_begin(uint32_t match_id, match_cmd_fn fn) {
+    sim_phase_t phase;
+    if (fn == handle_round1)        phase = PH_ROUND1;
+    else if (fn == handle_round2)   phase = PH_ROUND2;
+    else if (fn == handle_round3)   phase = PH_ROUND3;
+    else if (fn == handle_bonus)    phase = PH_BONUS;
+    else if (fn == handle_end_game) phase = PH_END;
+    else                            phase = phase_of_match(match_id);
+    phase_begin(phase);
+}
+
+void sim_task_end(void) {
+    phase_end();
+}
+
+//==============================================================================
+// BOT COMMANDS
+//==============================================================================
+
+static void outbox_push(sim_bot_t *bot, uint16_t command, const void *payload, uint32_t length) {
+    if (g_out_tail == g_out_cap) {
+        // Compact, then grow
+        if (g_out_head > 0) {
+            memmove(g_outbox, g_outbox + g_out_head,
+                    (size_t)(g_out_tail - g_out_head) * sizeof(sim_cmd_t));
+            g_out_tail -= g_out_head;
+            g_out_head = 0;
+        }
+        if (g_out_tail == g_out_cap) {
+            int cap = g_out_cap ? g_out_cap * 2 : 256;
+            sim_cmd_t *grown = realloc(g_outbox, (size_t)cap * sizeof(sim_cmd_t));
+            if (!grown) return;
+            g_outbox = grown;
+            g_out_cap = cap;
+        }
+    }
+
+    sim_cmd_t *c = &g_outbox[g_out_tail++];
+    c->bot = (int)(bot - g_bots);
+    c->command = command;
+    c->length = length;
+    if (length > 0) memcpy(c->payload, payload, length);
+    bot->outbox++;
+}
+
+// Dispatched once the virtual clock reaches now + delay_ms
+static void outbox_push_later(sim_bot_t *bot, int64_t delay_ms, uint16_t command,
+                              const void *payload, uint32_t length) {
+    if (g_later_count == g_later_cap) {
+        int cap = g_later_cap ? g_later_cap * 2 : 64;
+        sim_cmd_t *grown = realloc(g_later, (size_t)cap * sizeof(sim_cmd_t));
+        if (!grown) return;
+        g_later = grown;
+        g_later_cap = cap;
+    }
+
+    sim_cmd_t *c = &g_later[g_later_count++];
+    c->bot = (int)(bot - g_bots);
+    c->command = command;
+    c->length = length;
+    c->due_ms = sim_exec_now_ms() + delay_ms;
+    if (length > 0) memcpy(c->payload, payload, length);
+    bot->outbox++;
+}
+
+// Move delayed commands that are due to the outbox, in push order
+static void release_due(void) {
+    int64_t now = sim_exec_now_ms();
+    int kept = 0;
+    for (int i = 0; i < g_later_count; i++) {
+        sim_cmd_t c = g_later[i];
+        if (c.due_ms <= now) {
+            sim_bot_t *bot = &g_bots[c.bot];
+            bot->outbox--;
+            outbox_push(bot, c.command, c.payload, c.length);
+        } else {
+            g_later[kept++] = c;
+        }
+    }
+    g_later_count = kept;
+}
+
+static int64_t next_due_ms(void) {
+    int64_t due = -1;
+    for (int i = 0; i < g_later_count; i++) {
+        if (due < 0 || g_later[i].due_ms < due) due = g_later[i].due_ms;
+    }
+    return due;
+}
+
+static void put_u32(char *p, uint32_t v) {
+    v = htonl(v);
+    memcpy(p, &v, 4);
+}
+
+// {match_id, player_id}
+static void send_player_ready(sim_bot_t *bot, uint16_t command) {
+    char p[8];
+    put_u32(p, bot->match_id);
+    put_u32(p + 4, (uint32_t)bot->account_id);
+    outbox_push(bot, command, p, sizeof(p));
+}
+
+// {match_id}
+static void send_match_only(sim_bot_t *bot, uint16_t command) {
+    char p[4];
+    put_u32(p, bot->match_id);
+    outbox_push(bot, command, p, sizeof(p));
+}
+
+static void send_answer(sim_bot_t *bot, int q_idx) {
+    uint8_t choice;
+    uint32_t time_ms;
+    if (g_opt.scripted) {
+        choice = (uint8_t)((bot->seat + q_idx) % 4);
+        time_ms = 1000u + (uint32_t)bot->seat * 500u;
+    } else {
+        if (next_rand(&bot->rng) % SIM_SKIP_ONE_IN == 0) return;   // let it time out
+        choice = (uint8_t)(next_rand(&bot->rng) % 4);
+        time_ms = 200u + (uint32_t)(next_rand(&bot->rng) % 9000);
+    }
+
+    char p[13];
+    put_u32(p, bot->match_id);
+    put_u32(p + 4, (uint32_t)q_idx);
+    p[8] = (char)choice;
+    put_u32(p + 9, time_ms);
+    outbox_push_later(bot, time_ms, OP_C2S_ROUND1_ANSWER, p, sizeof(p));
+}
+
+static void send_bid(sim_bot_t *bot, int product_idx) {
+    int64_t bid;
+    if (g_opt.scripted) {
+        bid = 500000LL * (bot->seat + 1) + 100000LL * product_idx;
+    } else {
+        if (next_rand(&bot->rng) % SIM_SKIP_ONE_IN == 0) return;
+        bid = 10000LL + (int64_t)(next_rand(&bot->rng) % 30000000ULL);
+    }
+
+    char p[16];
+    put_u32(p, bot->match_id);
+    put_u32(p + 4, (uint32_t)product_idx);
+    uint64_t be = htobe64((uint64_t)bid);
+    memcpy(p + 8, &be, 8);
+    outbox_push(bot, OP_C2S_ROUND2_BID, p, sizeof(p));
+}
+
+static void send_decision(sim_bot_t *bot, int first_spin) {
+    uint8_t decision;
+    if (g_opt.scripted) {
+        decision = first_spin < 50 ? 1 : 0;
+    } else {
+        decision = (uint8_t)(next_rand(&bot->rng) % 2);
+    }
+
+    char p[5];
+    put_u32(p, bot->match_id);
+    p[4] = (char)decision;
+    outbox_push(bot, OP_C2S_ROUND3_DECISION, p, sizeof(p));
+}
+
+static int json_int(const cJSON *obj, const char *key, int fallback) {
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(obj, key);
+    return cJSON_IsNumber(item) ? item->valueint : fallback;
+}
+
+// React to one server frame (bots are never re-entered: commands go to the outbox)
+static void bot_on_frame(sim_bot_t *bot, const sim_frame_t *f) {
+    if (bot->match_id == 0) return;
+
+    if (f->command == OP_S2C_END_GAME_BACK_ACK) {
+        if (bot->pending_back > 0) bot->pending_back--;
+        return;
+    }
+    if (f->command == OP_S2C_END_GAME_RESULT) {
+        send_match_only(bot, OP_C2S_END_GAME_BACK_LOBBY);
+        bot->pending_back++;
+        return;
+    }
+
+    switch (f->command) {
+        case OP_S2C_ROUND1_QUESTION:
+        case OP_S2C_ROUND1_ALL_FINISHED:
+        case OP_S2C_ROUND2_PRODUCT:
+        case OP_S2C_ROUND2_ALL_FINISHED:
+        case OP_S2C_ROUND3_DECISION_ACK:
+        case OP_S2C_ROUND3_SPIN_RESULT:
+        case OP_S2C_BONUS_PARTICIPANT:
+        case OP_S2C_BONUS_TRANSITION:
+            break;
+        default:
+            return;
+    }
+    if (bot_eliminated(bot)) return;
+
+    cJSON *obj = cJSON_ParseWithLength(f->payload, f->length);
+    if (!obj) return;
+
+    switch (f->command) {
+        case OP_S2C_ROUND1_QUESTION:
+            send_answer(bot, json_int(obj, "question_idx", 0));
+            break;
+        case OP_S2C_ROUND1_ALL_FINISHED:
+            send_player_ready(bot, OP_C2S_ROUND2_PLAYER_READY);
+            break;
+        case OP_S2C_ROUND2_PRODUCT:
+            send_bid(bot, json_int(obj, "product_idx", 0));
+            break;
+        case OP_S2C_ROUND2_ALL_FINISHED:
+            send_player_ready(bot, OP_C2S_ROUND3_PLAYER_READY);
+            break;
+        case OP_S2C_ROUND3_DECISION_ACK:
+            // Spin prompts carry spin_number; decision acks do not
+            if (json_int(obj, "spin_number", 0) > 0) {
+                send_match_only(bot, OP_C2S_ROUND3_SPIN);
+            }
+            break;
+        case OP_S2C_ROUND3_SPIN_RESULT:
+            if (cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(obj, "decision_pending"))) {
+                send_decision(bot, json_int(obj, "result", 0));
+            }
+            break;
+        case OP_S2C_BONUS_PARTICIPANT:
+            send_match_only(bot, OP_C2S_BONUS_DRAW_CARD);
+            break;
+        case OP_S2C_BONUS_TRANSITION: {
+            int next_round = json_int(obj, "next_round", 0);
+            if (next_round == 2) send_player_ready(bot, OP_C2S_ROUND2_PLAYER_READY);
+            else if (next_round == 3) send_player_ready(bot, OP_C2S_ROUND3_PLAYER_READY);
+            break;
+        }
+    }
+    cJSON_Delete(obj);
+}
+
+//==============================================================================
+// DRIVER
+//==============================================================================
+
+static void dispatch_as(sim_bot_t *bot, uint16_t command, const char *payload, uint32_t length) {
+    MessageHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = MAGIC_NUMBER;
+    hdr.version = PROTOCOL_VERSION;
+    hdr.command = command;
+    hdr.seq_num = g_seq++;
+    hdr.length = length;
+
+    phase_begin(command == CMD_START_GAME ? PH_START : PH_DISPATCH);
+    dispatch_command(bot->fd, &hdr, length > 0 ? payload : NULL);
+    phase_end();
+}
+
+// Returns true if anything was dispatched
+static bool flush_outbox(void) {
+    release_due();
+    if (g_out_head == g_out_tail) return false;
+
+    // Dispatching only posts to the executor, so nothing is added meanwhile
+    int end = g_out_tail;
+    while (g_out_head < end) {
+        sim_cmd_t c = g_outbox[g_out_head++];
+        sim_bot_t *bot = &g_bots[c.bot];
+        bot->outbox--;
+        dispatch_as(bot, c.command, c.payload, c.length);
+    }
+    if (g_out_head == g_out_tail) g_out_head = g_out_tail = 0;
+    return true;
+}
+
+static void drain_frames(void) {
+    sim_frame_t *f;
+    while ((f = sim_transport_pop()) != NULL) {
+        sim_bot_t *bot = bot_by_fd(f->fd);
+        if (bot) {
+            // Bot-side parsing is not server work
+            sim_alloc_pause();
+            bot_on_frame(bot, f);
+            sim_alloc_resume();
+        }
+        sim_frame_free(f);
+    }
+}
+
+static bool start_match(int slot_idx, int match_no) {
+    sim_slot_t *slot = &g_slots[slot_idx];
+    sim_bot_t *host = &g_bots[slot->first_bot];
+
+    GameMode mode = MODE_SCORING;
+    if (g_opt.mode == SIM_MODE_ELIMINATION ||
+        (g_opt.mode == SIM_MODE_MIXED && (match_no % 2) == 1)) {
+        mode = MODE_ELIMINATION;
+    }
+
+    RoomState *room = room_create();
+    if (!room) {
+        fprintf(stderr, "[SIM] room_create failed (MAX_ROOMS=%d)\n", MAX_ROOMS);
+        return false;
+    }
+    room->id = g_next_room_id++;
+    room->host_id = (uint32_t)host->account_id;
+    room->mode = mode;
+    room->status = ROOM_WAITING;
+    room->max_players = (uint8_t)g_opt.players;
+    snprintf(room->name, sizeof(room->name), "sim-%d", match_no);
+
+    uint32_t room_id = room->id;
+    for (int i = 0; i < g_opt.players; i++) {
+        sim_bot_t *bot = &g_bots[slot->first_bot + i];
+        char name[32];
+        snprintf(name, sizeof(name), "Bot%d", bot->account_id);
+        room_add_player(room_id, (uint32_t)bot->account_id, name, NULL, bot->fd);
+
+        RoomState *r = room_get(room_id);
+        r->players[r->player_count - 1].is_ready = true;
+        r->players[r->player_count - 1].is_host = (i == 0);
+    }
+
+    char p[4];
+    put_u32(p, room_id);
+    dispatch_as(host, CMD_START_GAME, p, sizeof(p));
+
+    MatchState *match = match_get_by_room(room_id);
+    if (!match || match->status == MATCH_ENDED) {
+        fprintf(stderr, "[SIM] match %d did not start (room %u)\n", match_no, room_id);
+        // The handler may have marked the players PLAYING before failing
+        for (int i = 0; i < g_opt.players; i++) {
+            session_mark_lobby(session_get_by_account(g_bots[slot->first_bot + i].account_id));
+        }
+        room_destroy(room_id);
+        return false;
+    }
+
+    slot->active = true;
+    slot->room_id = room_id;
+    slot->match_id = match->runtime_match_id;
+    slot->started_ms = sim_exec_now_ms();
+
+    for (int i = 0; i < g_opt.players; i++) {
+        sim_bot_t *bot = &g_bots[slot->first_bot + i];
+        bot->match_id = slot->match_id;
+        bot->pending_back = 0;
+        send_player_ready(bot, OP_C2S_ROUND1_PLAYER_READY);
+    }
+    return true;
+}
+
+static void record_outcome(const MatchState *match) {
+    digest_add(match->player_count);
+    for (int i = 0; i < match->player_count; i++) {
+        const MatchPlayerState *mp = &match->players[i];
+        digest_add(mp->score);
+        digest_add(mp->eliminated);
+        digest_add(mp->eliminated_at_round);
+    }
+    for (int r = 0; r < match->round_count; r++) {
+        const RoundState *round = &match->rounds[r];
+        // The bank question: match_question row ids depend on when the
+        // write-behind writer gets to a match's bonus row
+        for (int q = 0; q < round->question_count; q++) {
+            digest_add(round->questions[q].source_id);
+        }
+    }
+}
+
+static bool bot_saw(const sim_bot_t *bot, int32_t question_id) {
+    for (int m = 0; m < SIM_REPEAT_WINDOW; m++) {
+        for (int i = 0; i < bot->seen_count[m]; i++) {
+            if (bot->seen[m][i] == question_id) return true;
+        }
+    }
+    return false;
+}
+
+// Recent-question exclusion at work: questions (questions.id) a bot is
+// asked again within SIM_REPEAT_WINDOW matches
+static void record_repeats(const sim_slot_t *slot, const MatchState *match) {
+    for (int b = 0; b < g_opt.players; b++) {
+        sim_bot_t *bot = &g_bots[slot->first_bot + b];
+        int32_t *ring = bot->seen[bot->seen_pos];
+        int count = 0;
+
+        for (int r = 0; r < match->round_count; r++) {
+            const RoundState *round = &match->rounds[r];
+            for (int q = 0; q < round->question_count; q++) {
+                int32_t id = round->questions[q].source_id;
+                if (id <= 0) continue;
+                g_questions_seen++;
+                if (bot_saw(bot, id)) g_questions_repeated++;
+                if (count < SIM_SEEN_PER_MATCH) ring[count++] = id;
+            }
+        }
+        bot->seen_count[bot->seen_pos] = count;
+        bot->seen_pos = (bot->seen_pos + 1) % SIM_REPEAT_WINDOW;
+    }
+}
+
+static double repeat_pct(void) {
+    return g_questions_seen ? 100.0 * (double)g_questions_repeated / (double)g_questions_seen : 0.0;
+}
+
+static void retire_slot(sim_slot_t *slot, bool stalled) {
+    MatchState *match = match_get_by_id(slot->match_id);
+    if (stalled) {
+        g_stalled++;
+        fprintf(stderr, "[SIM] match %u stalled (round idx %d)\n", slot->match_id,
+                match ? match->current_round_idx : -1);
+        if (match) match_destroy(slot->match_id);
+    } else {
+        g_completed++;
+        g_virtual_total_ms += sim_exec_now_ms() - slot->started_ms;
+        if (match) {
+            record_outcome(match);
+            record_repeats(slot, match);
+        }
+    }
+
+    // Bots that never got the end-game screen (eliminated) go back here
+    for (int i = 0; i < g_opt.players; i++) {
+        sim_bot_t *bot = &g_bots[slot->first_bot + i];
+        session_mark_lobby(session_get_by_account(bot->account_id));
+        bot->match_id = 0;
+        bot->pending_back = 0;
+    }
+    room_destroy(slot->room_id);
+    slot->active = false;
+}
+
+static bool slot_finished(const sim_slot_t *slot) {
+    MatchState *match = match_get_by_id(slot->match_id);
+    if (match && match->status != MATCH_ENDED) return false;
+    for (int i = 0; i < g_opt.players; i++) {
+        const sim_bot_t *bot = &g_bots[slot->first_bot + i];
+        if (bot->outbox > 0 || bot->pending_back > 0) return false;
+    }
+    return true;
+}
+
+static void fill_slots(void) {
+    for (int s = 0; s < g_opt.concurrent && g_started < g_opt.matches; s++) {
+        if (g_slots[s].active) continue;
+        int match_no = g_started++;
+        if (!start_match(s, match_no)) g_failed++;
+    }
+}
+
+static void run(void) {
+    for (;;) {
+        fill_slots();
+        drain_frames();
+        if (flush_outbox()) continue;
+
+        bool any_active = false;
+        for (int s = 0; s < g_opt.concurrent; s++) {
+            sim_slot_t *slot = &g_slots[s];
+            if (!slot->active) continue;
+            if (slot_finished(slot)) {
+                retire_slot(slot, false);
+            } else if (sim_exec_now_ms() - slot->started_ms > SIM_STALL_MS) {
+                retire_slot(slot, true);
+            } else {
+                any_active = true;
+            }
+        }
+        if (!any_active) {
+            if (g_started >= g_opt.matches) break;
+            continue;
+        }
+
+        // Idle until a bot's answer is due, if that comes before the next timer
+        int64_t due = next_due_ms();
+        int64_t timer = sim_exec_next_timer_ms();
+        if (due >= 0 && !sim_exec_has_messages() && (timer < 0 || due < timer)) {
+            sim_exec_advance_to(due);
+            continue;
+        }
+
+        if (!sim_exec_step()) {
+            // Nothing queued or armed, yet matches are live: they are stuck
+            for (int s = 0; s < g_opt.concurrent; s++) {
+                if (g_slots[s].active) retire_slot(&g_slots[s], true);
+            }
+        }
+    }
+}
+
+//==============================================================================
+// SETUP
+//==============================================================================
+
+// The seed file has few questions (one wheel): recent-question exclusion
+// would soon leave nothing to sample for bots that play back to back
+static void add_synthetic_questions(void) {
+    static const char *TYPES[] = { "mcq", "bid", "wheel" };
+
+    for (int t = 0; t < 3; t++) {
+        for (int i = 0; i < g_opt.questions; i++) {
+            char text[64];
+            snprintf(text, sizeof(text), "Sim %s question %d", TYPES[t], i + 1);
+
+            cJSON *data = cJSON_CreateObject();
+            cJSON_AddStringToObject(data, "type", "sim");
+            if (t == 0) {
+                cJSON_AddStringToObject(data, "question", text);
+                cJSON *choices = cJSON_AddArrayToObject(data, "choices");
+                for (int c = 0; c < 4; c++) {
+                    char choice[16];
+                    snprintf(choice, sizeof(choice), "%d.000", (c + 1) * 100 + i);
+                    cJSON_AddItemToArray(choices, cJSON_CreateString(choice));
+                }
+                cJSON_AddNumberToObject(data, "correct_answer", i % 4);
+            } else if (t == 1) {
+                cJSON_AddStringToObject(data, "question", text);
+                cJSON_AddNumberToObject(data, "correct_answer", 1000000 + i * 250000);
+            } else {
+                cJSON_AddStringToObject(data, "label", text);
+            }
+
+            cJSON *row = cJSON_CreateObject();
+            cJSON_AddStringToObject(row, "type", TYPES[t]);
+            cJSON_AddItemToObject(row, "data", data);
+
+            cJSON *out = NULL;
+            if (db_post("questions", row, &out) != DB_OK) {
+                fprintf(stderr, "[SIM] could not add synthetic %s question\n", TYPES[t]);
+            }
+            cJSON_Delete(out);
+            cJSON_Delete(row);
+        }
+    }
+}
+
+// Runs before the preload tasks, so the question bank sees the extra rows
+static int connect_db(void) {
+    if (db_client_init() != DB_OK) return -1;
+    add_synthetic_questions();
+    return 0;
+}
+
+static int question_bank_task(void) {
+    return question_bank_init();
+}
+
+static int recent_questions_task(void) {
+    return startup_db_available() ? recent_questions_preload() : 0;
+}
+
+static int leaderboard_task(void) {
+    return startup_db_available() ? leaderboard_preload() : 0;
+}
+
+static bool create_bots(void) {
+    g_bot_count = g_opt.concurrent * g_opt.players;
+    g_bots = calloc((size_t)g_bot_count, sizeof(sim_bot_t));
+    g_slots = calloc((size_t)g_opt.concurrent, sizeof(sim_slot_t));
+    if (!g_bots || !g_slots) return false;
+
+    for (int i = 0; i < g_bot_count; i++) {
+        sim_bot_t *bot = &g_bots[i];
+        bot->slot = i / g_opt.players;
+        bot->seat = i % g_opt.players;
+        bot->rng = (g_opt.seed ^ 0x9E3779B97F4A7C15ULL) * (uint64_t)(i + 1) | 1;
+
+        // Raw send() calls in the handlers fail on it (ENOTSOCK)
+        bot->fd = open("/dev/null", O_RDWR);
+        if (bot->fd <= 0 || bot->fd >= SIM_MAX_FD) {
+            fprintf(stderr, "[SIM] cannot open a descriptor for bot %d\n", i);
+            return false;
+        }
+        g_bot_by_fd[bot->fd] = i + 1;
+
+        char email[64];
+        snprintf(email, sizeof(email), "sim_bot_%d@sim.local", i);
+        account_t *account = NULL;
+        if (account_create(email, "sim", "user", &account) != DB_OK || !account) {
+            fprintf(stderr, "[SIM] account_create failed for %s\n", email);
+            return false;
+        }
+        bot->account_id = account->id;
+        account_free(account);
+
+        char name[32];
+        snprintf(name, sizeof(name), "Bot%d", bot->account_id);
+        profile_t *profile = NULL;
+        if (profile_create(bot->account_id, name, NULL, NULL, &profile) == DB_OK) {
+            profile_free(profile);
+        }
+        leaderboard_put_profile(bot->account_id, name, NULL);
+
+        char session_id[37];
+        snprintf(session_id, sizeof(session_id), "sim-session-%08d", i);
+        MessageHeader hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        if (!session_bind_after_login(bot->fd, bot->account_id, session_id, &hdr)) {
+            fprintf(stderr, "[SIM] session bind failed for bot %d\n", i);
+            return false;
+        }
+        set_client_session(bot->fd, session_id, bot->account_id);
+    }
+
+    for (int s = 0; s < g_opt.concurrent; s++) {
+        g_slots[s].first_bot = s * g_opt.players;
+    }
+    return true;
+}
+
+static void teardown(void) {
+    match_exec_shutdown();
+    match_manager_cleanup();
+    match_wq_shutdown();
+    question_bank_shutdown();
+    recent_questions_cleanup();
+    leaderboard_cleanup();
+    entity_cache_clear();
+    replay_cache_clear();
+    db_client_cleanup();
+
+    for (int i = 0; i < g_bot_count; i++) {
+        if (g_bots[i].fd > 0) close(g_bots[i].fd);
+    }
+    free(g_bots);
+    free(g_slots);
+    free(g_outbox);
+    free(g_later);
+}
+
+//==============================================================================
+// REPORT
+//==============================================================================
+
+static void print_report(FILE *out, double wall_s, double process_cpu_s,
+                         const sim_alloc_stats_t *process_alloc) {
+    int done = g_completed > 0 ? g_completed : 1;
+    uint64_t engine_ns = 0, engine_allocs = 0, engine_bytes = 0;
+    for (int p = 0; p < PH_COUNT; p++) {
+        engine_ns += g_phase[p].cpu_ns;
+        engine_allocs += g_phase[p].allocs;
+        engine_bytes += g_phase[p].bytes;
+    }
+
+    const char *mode = g_opt.mode == SIM_MODE_SCORING ? "scoring"
+                     : g_opt.mode == SIM_MODE_ELIMINATION ? "elimination" : "mixed";
+
+    fprintf(out, "\n=============================================\n");
+    fprintf(out, "             MATCH SIMULATOR REPORT           \n");
+    fprintf(out, "=============================================\n");
+    fprintf(out, "Config     : %d matches, %d players, %d concurrent, mode=%s, bots=%s, "
+            "+%d questions/type, seed=%llu\n",
+            g_opt.matches, g_opt.players, g_opt.concurrent, mode,
+            g_opt.scripted ? "scripted" : "random", g_opt.questions,
+            (unsigned long long)g_opt.seed);
+    fprintf(out, "Matches    : %d completed, %d stalled, %d failed to start\n",
+            g_completed, g_stalled, g_failed);
+    fprintf(out, "Wall time  : %.3f s (%.1f matches/s)\n",
+            wall_s, wall_s > 0 ? g_completed / wall_s : 0.0);
+    fprintf(out, "Engine CPU : %.3f s (%.1f matches/s of handler time), process CPU %.3f s\n",
+            engine_ns / 1e9, engine_ns > 0 ? g_completed / (engine_ns / 1e9) : 0.0, process_cpu_s);
+    fprintf(out, "Game time  : %.1f s virtual per match\n",
+            g_virtual_total_ms / 1000.0 / done);
+    fprintf(out, "Repeats    : %llu of %llu questions seen by the same player in its last %d matches (%.2f%%)\n",
+            (unsigned long long)g_questions_repeated, (unsigned long long)g_questions_seen,
+            SIM_REPEAT_WINDOW, repeat_pct());
+
+    if (sim_alloc_enabled()) {
+        fprintf(out, "Allocs     : %.1f per match (%.1f KiB), process total %llu (%.1f MiB)\n",
+                (double)engine_allocs / done, engine_bytes / 1024.0 / done,
+                (unsigned long long)process_alloc->allocs, process_alloc->bytes / 1048576.0);
+    } else {
+        fprintf(out, "Allocs     : not counted (sanitizer build or SIM_NO_ALLOC_HOOKS)\n");
+    }
+
+    fprintf(out, "\n%-11s %10s %11s %10s %12s %12s\n",
+            "phase", "tasks", "cpu ms", "us/task", "allocs/match", "KiB/match");
+    for (int p = 0; p < PH_COUNT; p++) {
+        const sim_phase_stats_t *ps = &g_phase[p];
+        fprintf(out, "%-11s %10llu %11.2f %10.2f %12.1f %12.2f\n",
+                PHASE_NAMES[p], (unsigned long long)ps->tasks, ps->cpu_ns / 1e6,
+                ps->tasks ? ps->cpu_ns / 1e3 / ps->tasks : 0.0,
+                (double)ps->allocs / done, ps->bytes / 1024.0 / done);
+    }
+    fprintf(out, "\nOutcome digest: %016llx\n", (unsigned long long)g_digest);
+}
+
+//==============================================================================
+// MAIN
+//==============================================================================
+
+static void print_usage(const char *prog_name) {
+    printf("Usage: %s [OPTIONS]\n", prog_name);
+    printf("\nOptions:\n");
+    printf("  -n <count>      Matches to play (default %d)\n", SIM_DEFAULT_MATCHES);
+    printf("  -p <count>      Players per match, 1-%d (default %d)\n", MAX_ROOM_MEMBERS, SIM_DEFAULT_PLAYERS);
+    printf("  -c <count>      Matches in flight, 1-%d (default %d)\n", MAX_ROOMS, SIM_DEFAULT_CONCURRENT);
+    printf("  -q <count>      Synthetic questions added per round type (default %d)\n", SIM_DEFAULT_QUESTIONS);
+    printf("  -s <seed>       RNG seed (default 1)\n");
+    printf("  -m <mode>       scoring | elimination | mixed (default mixed)\n");
+    printf("  --bots <kind>   random | scripted (default random)\n");
+    printf("  --max-repeat-pct <pct>  Fail (exit 3) if more questions repeat (see Repeats)\n");
+    printf("  -v              Keep the server log on stdout\n");
+    printf("  -h, --help      Show this help message\n");
+    printf("\nThe in-memory DB backend is always used (%s selects the seed file).\n", ENV_DB_MEM_SEED);
+}
+
+static bool parse_args(int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            print_usage(argv[0]);
+            exit(0);
+        } else if (strcmp(arg, "-v") == 0) {
+            g_opt.verbose = true;
+        } else if (!val) {
+            fprintf(stderr, "Missing value for %s\n", arg);
+            return false;
+        } else if (strcmp(arg, "-n") == 0) {
+            g_opt.matches = atoi(val); i++;
+        } else if (strcmp(arg, "-p") == 0) {
+            g_opt.players = atoi(val); i++;
+        } else if (strcmp(arg, "-c") == 0) {
+            g_opt.concurrent = atoi(val); i++;
+        } else if (strcmp(arg, "-q") == 0) {
+            g_opt.questions = atoi(val); i++;
+        } else if (strcmp(arg, "-s") == 0) {
+            g_opt.seed = strtoull(val, NULL, 10); i++;
+        } else if (strcmp(arg, "-m") == 0) {
+            if (strcmp(val, "scoring") == 0) g_opt.mode = SIM_MODE_SCORING;
+            else if (strcmp(val, "elimination") == 0) g_opt.mode = SIM_MODE_ELIMINATION;
+            else if (strcmp(val, "mixed") == 0) g_opt.mode = SIM_MODE_MIXED;
+            else { fprintf(stderr, "Unknown mode: %s\n", val); return false; }
+            i++;
+        } else if (strcmp(arg, "--bots") == 0) {
+            if (strcmp(val, "scripted") == 0) g_opt.scripted = true;
+            else if (strcmp(val, "random") == 0) g_opt.scripted = false;
+            else { fprintf(stderr, "Unknown bot kind: %s\n", val); return false; }
+            i++;
+        } else if (strcmp(arg, "--max-repeat-pct") == 0) {
+            g_opt.max_repeat_pct = atof(val); i++;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg);
+            return false;
+        }
+    }
+
+    if (g_opt.matches < 1 || g_opt.players < 1 || g_opt.players > MAX_ROOM_MEMBERS ||
+        g_opt.concurrent < 1 || g_opt.concurrent > MAX_ROOMS || g_opt.questions < 0) {
+        fprintf(stderr, "Invalid -n / -p / -c / -q value\n");
+        return false;
+    }
+    if (g_opt.seed == 0) g_opt.seed = 1;
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    if (!parse_args(argc, argv)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    // The server log goes to /dev/null unless -v; the report keeps stdout
+    FILE *report = fdopen(dup(STDOUT_FILENO), "w");
+    if (!report) report = stderr;
+    if (!g_opt.verbose) {
+        int devnull = open("/dev/null", O_WRONLY);
+        if (devnull >= 0) {
+            dup2(devnull, STDOUT_FILENO);
+            close(devnull);
+        }
+        setvbuf(stdout, NULL, _IOFBF, 1 << 16);
+    } else {
+        setvbuf(stdout, NULL, _IONBF, 0);
+    }
+
+    // Never a real database
+    setenv(ENV_DB_BACKEND, DB_BACKEND_MEMORY, 1);
+
+    srand((unsigned int)g_opt.seed);
+    question_bank_seed(g_opt.seed);
+
+    match_wq_init();
+    session_manager_init();
+    match_manager_init();
+    match_exec_init();
+
+    startup_add_task("question bank", question_bank_task, STARTUP_TASK_PRELOAD);
+    startup_add_task("recent questions", recent_questions_task, STARTUP_TASK_PRELOAD);
+    startup_add_task("leaderboard", leaderboard_task, STARTUP_TASK_PRELOAD);
+    startup_run(connect_db);
+    startup_join();
+
+    if (!startup_db_available() || !question_bank_ready()) {
+        fprintf(stderr, "[SIM] in-memory DB or question bank not loaded (check %s)\n", ENV_DB_MEM_SEED);
+        teardown();
+        return 1;
+    }
+    if (!create_bots()) {
+        teardown();
+        return 1;
+    }
+
+    sim_alloc_stats_t alloc0, alloc1;
+    sim_alloc_total_stats(&alloc0);
+    uint64_t wall0 = cpu_ns(CLOCK_MONOTONIC);
+    uint64_t proc0 = cpu_ns(CLOCK_PROCESS_CPUTIME_ID);
+
+    run();
+
+    uint64_t wall1 = cpu_ns(CLOCK_MONOTONIC);
+    uint64_t proc1 = cpu_ns(CLOCK_PROCESS_CPUTIME_ID);
+    sim_alloc_total_stats(&alloc1);
+    alloc1.allocs -= alloc0.allocs;
+    alloc1.bytes -= alloc0.bytes;
+
+    fflush(stdout);
+    print_report(report, (wall1 - wall0) / 1e9, (proc1 - proc0) / 1e9, &alloc1);
+    fflush(report);
+
+    teardown();
+    if (g_stalled > 0 || g_failed > 0) return 2;
+    if (g_opt.max_repeat_pct >= 0 && repeat_pct() > g_opt.max_repeat_pct) {
+        fprintf(stderr, "[SIM] %.2f%% of the questions repeated within %d matches (limit %.2f%%)\n",
+                repeat_pct(), SIM_REPEAT_WINDOW, g_opt.max_repeat_pct);
+        return 3;
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "handlers/match_executor.h"
+
+/**
+ * sim.h - Headless match simulator (make sim)
+ *
+ * match_sim links the real round / bonus / end-game handlers, the match
+ * manager and the in-memory DB backend against three stand-ins:
+ *   sim_transport.c  forward_response() queues frames for the bots
+ *   sim_executor.c   match_executor.h on one thread with a virtual clock,
+ *                    so round timers cost no wall time and runs repeat
+ *   sim_alloc.c      malloc / calloc / realloc / free counters
+ * Raw send() calls in the handlers go to /dev/null descriptors.
+ */
+
+//==============================================================================
+// Executor (sim_executor.c)
+//==============================================================================
+
+/** Virtual time in ms since match_exec_init() */
+int64_t sim_exec_now_ms(void);
+
+/** True if a command / disconnect is queued */
+bool sim_exec_has_messages(void);
+
+/** Deadline of the earliest timer (virtual ms), -1 if none is armed */
+int64_t sim_exec_next_timer_ms(void);
+
+/** Move the virtual clock forward to ms (never backwards) */
+void sim_exec_advance_to(int64_t ms);
+
+/**
+ * Run the oldest queued message; when none is queued, move the virtual
+ * clock to the earliest timer and run it
+ * @return false if nothing is queued or armed
+ */
+bool sim_exec_step(void);
+
+//==============================================================================
+// Transport (sim_transport.c)
+//==============================================================================
+
+typedef struct sim_frame {
+    struct sim_frame *next;
+    int fd;
+    uint16_t command;
+    uint32_t length;
+    char payload[];         // length bytes + NUL
+} sim_frame_t;
+
+/** Oldest frame sent by the server (caller frees with sim_frame_free), NULL if none */
+sim_frame_t* sim_transport_pop(void);
+
+void sim_frame_free(sim_frame_t *frame);
+
+//==============================================================================
+// Task accounting (match_sim.c)
+// Called by the executor around every message / timer it runs.
+//==============================================================================
+
+/** fn is the command handler, NULL for timers and disconnects */
+void sim_task_begin(uint32_t match_id, match_cmd_fn fn);
+void sim_task_end(void);
+
+//==============================================================================
+// Allocation counters (sim_alloc.c)
+//==============================================================================
+
+typedef struct {
+    uint64_t allocs;        // malloc / calloc / realloc calls that returned memory
+    uint64_t frees;
+    uint64_t bytes;         // bytes requested
+} sim_alloc_stats_t;
+
+/** False when built without the hooks (sanitizers, -DSIM_NO_ALLOC_HOOKS) */
+bool sim_alloc_enabled(void);
+
+/** Counters of the calling thread */
+void sim_alloc_thread_stats(sim_alloc_stats_t *out);
+
+/** Counters of the whole process */
+void sim_alloc_total_stats(sim_alloc_stats_t *out);
+
+/** Stop / restart counting on the calling thread (nests) */
+void sim_alloc_pause(void);
+void sim_alloc_resume(void);
+
+#endif // SIM_H
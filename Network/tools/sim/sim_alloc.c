@@ -0,0 +1,91 @@
+#include "sim.h"
+#include <string.h>
+
+//==============================================================================
+// ALLOCATION COUNTERS
+// Replaces the four glibc entry points (every other allocator call in libc
+// and in shared libraries such as cJSON goes through them) and forwards to
+// the __libc_* implementations. Thread-local counters give per-task deltas
+// on the simulator thread; the atomics cover the writer threads too.
+//==============================================================================
+
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__) || defined(SIM_NO_ALLOC_HOOKS)
+
+bool sim_alloc_enabled(void) { return false; }
+void sim_alloc_thread_stats(sim_alloc_stats_t *out) { memset(out, 0, sizeof(*out)); }
+void sim_alloc_total_stats(sim_alloc_stats_t *out) { memset(out, 0, sizeof(*out)); }
+void sim_alloc_pause(void) {}
+void sim_alloc_resume(void) {}
+
+#else
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void  __libc_free(void *ptr);
+
+static __thread uint64_t t_allocs;
+static __thread uint64_t t_frees;
+static __thread uint64_t t_bytes;
+static __thread int t_paused;
+
+static _Atomic uint64_t g_allocs;
+static _Atomic uint64_t g_frees;
+static _Atomic uint64_t g_bytes;
+
+static void count_alloc(size_t size) {
+    if (t_paused) return;
+    t_allocs++;
+    t_bytes += size;
+    __atomic_fetch_add(&g_allocs, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_bytes, size, __ATOMIC_RELAXED);
+}
+
+static void count_free(void) {
+    if (t_paused) return;
+    t_frees++;
+    __atomic_fetch_add(&g_frees, 1, __ATOMIC_RELAXED);
+}
+
+void *malloc(size_t size) {
+    void *p = __libc_malloc(size);
+    if (p) count_alloc(size);
+    return p;
+}
+
+void *calloc(size_t nmemb, size_t size) {
+    void *p = __libc_calloc(nmemb, size);
+    if (p) count_alloc(nmemb * size);
+    return p;
+}
+
+void *realloc(void *ptr, size_t size) {
+    void *p = __libc_realloc(ptr, size);
+    if (p) count_alloc(size);
+    return p;
+}
+
+void free(void *ptr) {
+    if (!ptr) return;
+    count_free();
+    __libc_free(ptr);
+}
+
+bool sim_alloc_enabled(void) { return true; }
+
+void sim_alloc_thread_stats(sim_alloc_stats_t *out) {
+    out->allocs = t_allocs;
+    out->frees = t_frees;
+    out->bytes = t_bytes;
+}
+
+void sim_alloc_total_stats(sim_alloc_stats_t *out) {
+    out->allocs = __atomic_load_n(&g_allocs, __ATOMIC_RELAXED);
+    out->frees = __atomic_load_n(&g_frees, __ATOMIC_RELAXED);
+    out->bytes = __atomic_load_n(&g_bytes, __ATOMIC_RELAXED);
+}
+
+void sim_alloc_pause(void) { t_paused++; }
+void sim_alloc_resume(void) { if (t_paused > 0) t_paused--; }
+
+#endif
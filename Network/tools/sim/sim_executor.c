@@ -0,0 +1,260 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "handlers/match_executor.h"
+#include "handlers/session_context.h"
+
+//==============================================================================
+// SIMULATED EXECUTOR
+// Same contract as handlers/match_executor.c, but every "shard" is the
+// calling thread and time is virtual: messages run in post order, and a
+// timer only fires once nothing is queued, after the clock has been moved
+// to its deadline. A whole match therefore runs in CPU time only and the
+// order of events depends on nothing but the inputs.
+//==============================================================================
+
+typedef enum {
+    SX_COMMAND = 0,
+    SX_DISCONNECT
+} sx_kind_t;
+
+typedef struct sx_msg {
+    sx_kind_t kind;
+    struct sx_msg *next;
+
+    uint32_t match_id;
+    int client_fd;
+    int32_t account_id;
+    int64_t received_ms;
+    MessageHeader req;
+    match_cmd_fn cmd_fn;
+    match_disconnect_fn disconnect_fn;
+    char payload[];
+} sx_msg_t;
+
+typedef struct sx_timer {
+    struct sx_timer *next;
+    int64_t due_ms;
+    uint32_t match_id;
+    uint64_t token;
+    match_timer_fn fn;
+} sx_timer_t;
+
+static struct {
+    int started;
+    int64_t now_ms;
+
+    sx_msg_t *head;
+    sx_msg_t *tail;
+    int queued;
+
+    sx_timer_t *timers;     // sorted by due_ms, equal deadlines in arm order
+
+    int in_task;
+    int64_t received_ms;    // command running, -1 = none
+    uint64_t processed;
+} g_sx;
+
+//==============================================================================
+// HELPERS
+//==============================================================================
+
+static void run_message(sx_msg_t *m) {
+    if (m->kind == SX_DISCONNECT) {
+        sim_task_begin(m->match_id, NULL);
+        m->disconnect_fn(m->account_id);
+        sim_task_end();
+        return;
+    }
+
+    // Same check as the real shard: the client may have left since the post
+    if (m->account_id != 0 && get_client_account(m->client_fd) != m->account_id) {
+        printf("[SIM_EXEC] Dropping cmd=0x%04x for match %u: fd=%d no longer account %d\n",
+               m->req.command, m->match_id, m->client_fd, m->account_id);
+        return;
+    }
+    sim_task_begin(m->match_id, m->cmd_fn);
+    g_sx.received_ms = m->received_ms;
+    m->cmd_fn(m->client_fd, &m->req, m->req.length > 0 ? m->payload : NULL);
+    g_sx.received_ms = -1;
+    sim_task_end();
+}
+
+static void free_all(void) {
+    while (g_sx.head) {
+        sx_msg_t *next = g_sx.head->next;
+        free(g_sx.head);
+        g_sx.head = next;
+    }
+    g_sx.tail = NULL;
+    g_sx.queued = 0;
+
+    while (g_sx.timers) {
+        sx_timer_t *next = g_sx.timers->next;
+        free(g_sx.timers);
+        g_sx.timers = next;
+    }
+}
+
+//==============================================================================
+// SIMULATOR API
+//==============================================================================
+
+int64_t sim_exec_now_ms(void) {
+    return g_sx.now_ms;
+}
+
+bool sim_exec_has_messages(void) {
+    return g_sx.head != NULL;
+}
+
+int64_t sim_exec_next_timer_ms(void) {
+    return g_sx.timers ? g_sx.timers->due_ms : -1;
+}
+
+void sim_exec_advance_to(int64_t ms) {
+    if (ms > g_sx.now_ms) g_sx.now_ms = ms;
+}
+
+bool sim_exec_step(void) {
+    if (!g_sx.started) return false;
+
+    if (g_sx.head) {
+        sx_msg_t *m = g_sx.head;
+        g_sx.head = m->next;
+        if (!g_sx.head) g_sx.tail = NULL;
+        g_sx.queued--;
+
+        g_sx.in_task = 1;
+        run_message(m);
+        g_sx.in_task = 0;
+        free(m);
+        g_sx.processed++;
+        return true;
+    }
+
+    if (g_sx.timers) {
+        sx_timer_t *t = g_sx.timers;
+        g_sx.timers = t->next;
+        if (t->due_ms > g_sx.now_ms) g_sx.now_ms = t->due_ms;
+
+        g_sx.in_task = 1;
+        sim_task_begin(t->match_id, NULL);
+        t->fn(t->match_id, t->token);
+        sim_task_end();
+        g_sx.in_task = 0;
+        free(t);
+        g_sx.processed++;
+        return true;
+    }
+    return false;
+}
+
+//==============================================================================
+// match_executor.h
+//==============================================================================
+
+int match_exec_init(void) {
+    if (g_sx.started) return 0;
+    memset(&g_sx, 0, sizeof(g_sx));
+    g_sx.received_ms = -1;
+    g_sx.started = 1;
+    printf("[SIM_EXEC] Virtual-clock executor started\n");
+    return 0;
+}
+
+void match_exec_shutdown(void) {
+    if (!g_sx.started) return;
+
+    // Run what is queued, drop pending timers (as the real shards do)
+    while (g_sx.head) sim_exec_step();
+    free_all();
+
+    printf("[SIM_EXEC] Stopped, %llu message(s) processed\n",
+           (unsigned long long)g_sx.processed);
+    g_sx.started = 0;
+}
+
+bool match_exec_post_command(uint32_t match_id, int client_fd, int32_t account_id,
+                             const MessageHeader *req, const char *payload,
+                             match_cmd_fn fn) {
+    if (!g_sx.started || !req || !fn) return false;
+    if (g_sx.queued >= MATCH_EXEC_MAX_MAILBOX) {
+        printf("[SIM_EXEC] Mailbox full, refusing cmd=0x%04x for match %u\n",
+               req->command, match_id);
+        return false;
+    }
+
+    uint32_t len = payload ? req->length : 0;
+    sx_msg_t *m = malloc(sizeof(*m) + len);
+    if (!m) return false;
+
+    m->kind = SX_COMMAND;
+    m->next = NULL;
+    m->match_id = match_id;
+    m->client_fd = client_fd;
+    m->account_id = account_id;
+    m->received_ms = g_sx.now_ms;
+    m->req = *req;
+    m->req.length = len;
+    m->cmd_fn = fn;
+    m->disconnect_fn = NULL;
+    if (len > 0) memcpy(m->payload, payload, len);
+
+    if (g_sx.tail) g_sx.tail->next = m; else g_sx.head = m;
+    g_sx.tail = m;
+    g_sx.queued++;
+    return true;
+}
+
+bool match_exec_post_timer(uint32_t match_id, int delay_ms, match_timer_fn fn, uint64_t token) {
+    if (!g_sx.started || !fn) return false;
+
+    sx_timer_t *t = calloc(1, sizeof(*t));
+    if (!t) return false;
+    t->due_ms = g_sx.now_ms + (delay_ms > 0 ? delay_ms : 0);
+    t->match_id = match_id;
+    t->token = token;
+    t->fn = fn;
+
+    sx_timer_t **pp = &g_sx.timers;
+    while (*pp && (*pp)->due_ms <= t->due_ms) pp = &(*pp)->next;
+    t->next = *pp;
+    *pp = t;
+    return true;
+}
+
+bool match_exec_post_disconnect(uint32_t match_id, int32_t account_id, match_disconnect_fn fn) {
+    if (!g_sx.started || !fn) return false;
+
+    sx_msg_t *m = calloc(1, sizeof(*m));
+    if (!m) return false;
+    m->kind = SX_DISCONNECT;
+    m->match_id = match_id;
+    m->account_id = account_id;
+    m->disconnect_fn = fn;
+
+    if (g_sx.tail) g_sx.tail->next = m; else g_sx.head = m;
+    g_sx.tail = m;
+    g_sx.queued++;
+    return true;
+}
+
+int match_exec_shard_of(uint32_t match_id) {
+    (void)match_id;
+    return g_sx.started ? 0 : -1;
+}
+
+int64_t match_exec_now_ms(void) {
+    return g_sx.now_ms;
+}
+
+int64_t match_exec_received_ms(void) {
+    return g_sx.received_ms >= 0 ? g_sx.received_ms : g_sx.now_ms;
+}
+
+bool match_exec_on_shard(void) {
+    return g_sx.in_task != 0;
+}
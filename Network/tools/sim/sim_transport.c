@@ -0,0 +1,58 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "protocol/protocol.h"
+
+//==============================================================================
+// FAKE TRANSPORT
+// Replaces transport/socket_server.c: forward_response() copies the frame
+// into one FIFO (delivery order across all clients) that the simulator
+// drains after every executor step. The copy is not counted as server
+// allocation.
+//==============================================================================
+
+static sim_frame_t *g_head = NULL;
+static sim_frame_t *g_tail = NULL;
+
+void forward_response(
+    int client_fd,
+    MessageHeader *req,
+    uint16_t cmd,
+    const char *payload,
+    uint32_t payload_len
+) {
+    (void)req;
+    if (client_fd <= 0) return;
+    if (!payload) payload_len = 0;
+
+    sim_alloc_pause();
+    sim_frame_t *f = malloc(sizeof(*f) + payload_len + 1);
+    sim_alloc_resume();
+    if (!f) return;
+
+    f->next = NULL;
+    f->fd = client_fd;
+    f->command = cmd;
+    f->length = payload_len;
+    if (payload_len > 0) memcpy(f->payload, payload, payload_len);
+    f->payload[payload_len] = '\0';
+
+    if (g_tail) g_tail->next = f; else g_head = f;
+    g_tail = f;
+}
+
+sim_frame_t* sim_transport_pop(void) {
+    sim_frame_t *f = g_head;
+    if (!f) return NULL;
+    g_head = f->next;
+    if (!g_head) g_tail = NULL;
+    f->next = NULL;
+    return f;
+}
+
+void sim_frame_free(sim_frame_t *frame) {
+    sim_alloc_pause();
+    free(frame);
+    sim_alloc_resume();
+}